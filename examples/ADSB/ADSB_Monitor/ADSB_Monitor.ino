@@ -10,6 +10,11 @@
   and then connect to from "modeslive" from the pyModeS package
   (see the script helptext for installation instructions).
 
+  Alternatively, build the native monitor in RadioLib/extras/ADSB_Monitor
+  and run it with the serial port as argument. It serves the traffic
+  in raw, SBS-1 (BaseStation) and Beast formats on ports 30002, 30003
+  and 30005, which can be used by dump1090-compatible tools.
+
   For default module settings, see the wiki page
   https://github.com/jgromes/RadioLib/wiki/Default-configuration
 
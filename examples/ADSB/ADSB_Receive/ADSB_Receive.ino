@@ -79,6 +79,10 @@ void setup() {
     while (true) { delay(10); }
   }
 
+  // LR2021 checks the CRC in hardware, other radios can pass the full
+  // 14-byte frames and have the parity checked (and single bit errors corrected)
+  // adsb.setParityCheck(true);
+
   // apply LR2021-specific settings
   Serial.print(F("[LR2021] Setting configuration ... "));
   state = radio.setRxBoostedGainMode(7);
@@ -0,0 +1,119 @@
+/*
+  RadioLib APRS Receive over LoRa Example
+
+  This example receives APRS packets
+  using SX1278's LoRa modem and decodes
+  positions, messages and telemetry.
+
+  Other modules that can be used for APRS:
+  - SX127x/RFM9x
+  - SX126x/LLCC68
+  - SX128x
+  - LR11x0
+
+  For default module settings, see the wiki page
+  https://github.com/jgromes/RadioLib/wiki/Default-configuration
+
+  For full API reference, see the GitHub Pages
+  https://jgromes.github.io/RadioLib/
+*/
+
+// include the library
+#include <RadioLib.h>
+
+// SX1278 has the following connections:
+// NSS pin:   10
+// DIO0 pin:  2
+// RESET pin: 9
+// DIO1 pin:  3
+SX1278 radio = new Module(10, 2, 9, 3);
+
+// or detect the pinout automatically using RadioBoards
+// https://github.com/radiolib-org/RadioBoards
+/*
+#define RADIO_BOARD_AUTO
+#include <RadioBoards.h>
+Radio radio = new RadioModule();
+*/
+
+// buffer for the received packets, decoded packet points into it
+uint8_t buff[256];
+
+// print text field that is not null-terminated
+void printText(const char* text, size_t len) {
+  for(size_t i = 0; i < len; i++) {
+    Serial.print(text[i]);
+  }
+}
+
+void setup() {
+  Serial.begin(9600);
+
+  // initialize SX1278 with the settings necessary for LoRa iGates
+  Serial.print(F("[SX1278] Initializing ... "));
+  // frequency:                   433.775 MHz
+  // bandwidth:                   125 kHz
+  // spreading factor:            12
+  // coding rate:                 4/5
+  int state = radio.begin(433.775, 125, 12, 5);
+  if(state == RADIOLIB_ERR_NONE) {
+    Serial.println(F("success!"));
+  } else {
+    Serial.print(F("failed, code "));
+    Serial.println(state);
+    while (true) { delay(10); }
+  }
+}
+
+void loop() {
+  int state = radio.receive(buff, sizeof(buff));
+  if(state != RADIOLIB_ERR_NONE) {
+    return;
+  }
+
+  // decode the packet, nothing is copied
+  APRSPacket_t packet;
+  state = APRSClient::decode(buff, radio.getPacketLength(), &packet);
+  Serial.print(F("[APRS] "));
+  printText(packet.src, packet.srcLen);
+  Serial.print(F(" type "));
+  Serial.print(packet.type);
+  if(state != RADIOLIB_ERR_NONE) {
+    Serial.print(F(" not decoded, code "));
+    Serial.println(state);
+    return;
+  }
+
+  if(packet.fields & RADIOLIB_APRS_FIELD_POSITION) {
+    Serial.print(F(" at "));
+    Serial.print(packet.lat, 5);
+    Serial.print(',');
+    Serial.print(packet.lon, 5);
+  }
+  if(packet.fields & RADIOLIB_APRS_FIELD_COURSE_SPEED) {
+    Serial.print(F(", course "));
+    Serial.print(packet.course);
+    Serial.print(F(" deg, speed "));
+    Serial.print(packet.speed);
+    Serial.print(F(" kn"));
+  }
+  if(packet.fields & RADIOLIB_APRS_FIELD_ALTITUDE) {
+    Serial.print(F(", altitude "));
+    Serial.print(packet.altitude);
+    Serial.print(F(" m"));
+  }
+  if(packet.fields & RADIOLIB_APRS_FIELD_MESSAGE) {
+    Serial.print(F(", message for "));
+    printText(packet.addressee, packet.addresseeLen);
+  }
+  if(packet.fields & RADIOLIB_APRS_FIELD_TELEMETRY) {
+    Serial.print(F(", telemetry"));
+    for(uint8_t i = 0; i < packet.telemNumAnalog; i++) {
+      Serial.print(' ');
+      Serial.print(packet.telemAnalog[i]);
+    }
+  }
+  Serial.print(F(": "));
+  printText(packet.text, packet.textLen);
+  Serial.println();
+}
@@ -0,0 +1,148 @@
+/*
+  RadioLib AX.25 Receive Example
+
+  This example receives AX.25 frames using
+  SX1278's FSK modem in direct mode.
+  Frames are found by their flags, NRZI-decoded,
+  unstuffed and checked by their FCS in software.
+
+  Other modules that can be used to receive AX.25:
+  - SX127x/RFM9x
+  - RF69
+  - SX1231
+  - CC1101
+  - Si443x/RFM2x
+
+  For default module settings, see the wiki page
+  https://github.com/jgromes/RadioLib/wiki/Default-configuration
+
+  For full API reference, see the GitHub Pages
+  https://jgromes.github.io/RadioLib/
+*/
+
+// include the library
+#include <RadioLib.h>
+
+// SX1278 has the following connections:
+// NSS pin:   10
+// DIO0 pin:  2
+// RESET pin: 9
+// DIO1 pin:  3
+SX1278 radio = new Module(10, 2, 9, 3);
+
+// receiving frames requires connection
+// to the module direct output pin,
+// here connected to Arduino pin 5
+// SX127x/RFM9x:  DIO2
+// RF69:          DIO2
+// SX1231:        DIO2
+// CC1101:        GDO2
+// Si443x/RFM2x:  GPIO
+const int pin = 5;
+
+// or detect the pinout automatically using RadioBoards
+// https://github.com/radiolib-org/RadioBoards
+/*
+#define RADIO_BOARD_AUTO
+#include <RadioBoards.h>
+Radio radio = new RadioModule();
+*/
+
+// create AX.25 client instance using the FSK module
+AX25Client ax25(&radio);
+
+// received frames are saved here
+AX25Frame frame("", 0, "", 0, 0);
+
+void setup() {
+  Serial.begin(9600);
+
+  // initialize SX1278
+  Serial.print(F("[SX1278] Initializing ... "));
+  // carrier frequency:           434.0 MHz
+  // bit rate:                    9.6 kbps (9600 baud G3RUH AX.25)
+  int state = radio.beginFSK(434.0, 9.6);
+
+  // when using one of the non-LoRa modules for AX.25
+  // (RF69, CC1101, Si4432 etc.), use the basic begin() method
+  // int state = radio.begin();
+
+  if(state == RADIOLIB_ERR_NONE) {
+    Serial.println(F("success!"));
+  } else {
+    Serial.print(F("failed, code "));
+    Serial.println(state);
+    while (true) { delay(10); }
+  }
+
+  // initialize AX.25 client
+  Serial.print(F("[AX.25] Initializing ... "));
+  // source station callsign:     "N7LEM"
+  state = ax25.begin("N7LEM");
+  if(state == RADIOLIB_ERR_NONE) {
+    Serial.println(F("success!"));
+  } else {
+    Serial.print(F("failed, code "));
+    Serial.println(state);
+    while (true) { delay(10); }
+  }
+
+  // 9600 baud packet radio uses G3RUH scrambling,
+  // remove this line for plain 1200 baud 2-FSK
+  ax25.setScrambler(RADIOLIB_SCRAMBLER_G3RUH_POLY, RADIOLIB_SCRAMBLER_G3RUH_INIT);
+
+  // start receiving AX.25 frames
+  Serial.print(F("[AX.25] Starting to listen ... "));
+  state = ax25.startReceive(pin);
+  if(state == RADIOLIB_ERR_NONE) {
+    Serial.println(F("success!"));
+  } else {
+    Serial.print(F("failed, code "));
+    Serial.println(state);
+    while (true) { delay(10); }
+  }
+}
+
+void loop() {
+  // decode whatever was received so far,
+  // this has to be called often enough to keep the direct mode buffer from overflowing
+  int state = ax25.readFrame(&frame);
+  if(state == RADIOLIB_ERR_RX_TIMEOUT) {
+    // no complete frame yet
+    return;
+  }
+
+  if(state == RADIOLIB_ERR_NONE) {
+    // print the addresses
+    Serial.print(F("[AX.25] "));
+    Serial.print(frame.srcCallsign);
+    Serial.print('-');
+    Serial.print(frame.srcSSID);
+    Serial.print(F(" > "));
+    Serial.print(frame.destCallsign);
+    Serial.print('-');
+    Serial.print(frame.destSSID);
+    for(uint8_t i = 0; i < frame.numRepeaters; i++) {
+      Serial.print(',');
+      Serial.print(frame.repeaterCallsigns[i]);
+      Serial.print('-');
+      Serial.print(frame.repeaterSSIDs[i] & 0x0F);
+      if(frame.repeaterSSIDs[i] & RADIOLIB_AX25_SSID_HAS_BEEN_REPEATED) {
+        Serial.print('*');
+      }
+    }
+    Serial.print(':');
+
+    // print the info field
+    for(uint16_t i = 0; i < frame.infoLen; i++) {
+      Serial.print((char)frame.info[i]);
+    }
+    Serial.println();
+
+  } else {
+    // the frame passed FCS check, but could not be parsed
+    Serial.print(F("[AX.25] Failed to parse frame, code "));
+    Serial.println(state);
+
+  }
+}
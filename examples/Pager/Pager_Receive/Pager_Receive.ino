@@ -84,6 +84,10 @@ void setup() {
     while (true) { delay(10); }
   }
 
+  // to receive 512, 1200 and 2400 bps messages at the same time,
+  // enable multi-rate reception before starting to listen
+  // pager.setMultiRate(true);
+
   // start receiving POCSAG messages
   Serial.print(F("[Pager] Starting to listen ... "));
   // address of this "pager":     1234567
@@ -121,16 +121,17 @@ void setup() {
   }
 
   // set correction factor
-  // NOTE: Due to different speeds of various platforms
-  //       supported by RadioLib (Arduino Uno, ESP32 etc),
-  //       and because SSTV is analog protocol, incorrect
-  //       timing of pulses can lead to distortions.
+  // NOTE: Tones are timed from the start of each line,
+  //       so processing speed of the platform
+  //       (Arduino Uno, ESP32 etc) no longer matters.
+  //       Because SSTV is analog protocol, inaccurate
+  //       system clock can still lead to slanted images.
   //       To compensate, correction factor can be used
   //       to adjust the length of timing pulses
   //       (lower number = shorter pulses).
-  //       The value is usually around 0.95 (95%).
+  //       The value is usually very close to 1.0.
   Serial.print(F("[SSTV] Setting correction ... "));
-  state = sstv.setCorrection(0.95);
+  state = sstv.setCorrection(1.0);
   if(state == RADIOLIB_ERR_NONE) {
     Serial.println(F("success!"));
   } else {
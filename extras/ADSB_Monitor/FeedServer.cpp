@@ -0,0 +1,185 @@
+#include "FeedServer.h"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+static bool setNonBlocking(int fd) {
+  int flags = fcntl(fd, F_GETFL, 0);
+  return((flags >= 0) && (fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0));
+}
+
+FeedServer::FeedServer(const char* name) {
+  this->name = name;
+}
+
+FeedServer::~FeedServer() {
+  this->end();
+}
+
+bool FeedServer::begin(uint16_t port) {
+  this->listenFd = socket(AF_INET, SOCK_STREAM, 0);
+  if(this->listenFd < 0) {
+    perror("socket");
+    return(false);
+  }
+
+  int yes = 1;
+  setsockopt(this->listenFd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port = htons(port);
+  if((bind(this->listenFd, (struct sockaddr*)&addr, sizeof(addr)) < 0) || (listen(this->listenFd, 16) < 0) || !setNonBlocking(this->listenFd)) {
+    fprintf(stderr, "[%s] Failed to listen on port %u: %s\n", this->name, (unsigned)port, strerror(errno));
+    close(this->listenFd);
+    this->listenFd = -1;
+    return(false);
+  }
+  printf("[%s] Listening on port %u\n", this->name, (unsigned)port);
+  return(true);
+}
+
+void FeedServer::end() {
+  for(FeedClient& client : this->clients) {
+    close(client.fd);
+  }
+  this->clients.clear();
+  if(this->listenFd >= 0) {
+    close(this->listenFd);
+    this->listenFd = -1;
+  }
+}
+
+void FeedServer::broadcast(const uint8_t* data, size_t len) {
+  for(size_t i = 0; i < this->clients.size(); i++) {
+    FeedClient* client = &this->clients[i];
+    if(client->out.size() - client->outPos + len > FEED_MAX_PENDING) {
+      this->drop(i--, "too slow");
+      continue;
+    }
+    client->out.insert(client->out.end(), data, data + len);
+  }
+}
+
+size_t FeedServer::addPollFds(std::vector<struct pollfd>* fds) {
+  if(this->listenFd < 0) {
+    return(0);
+  }
+  fds->push_back({ this->listenFd, POLLIN, 0 });
+  for(const FeedClient& client : this->clients) {
+    short events = POLLIN;
+    if(client.outPos < client.out.size()) {
+      events |= POLLOUT;
+    }
+    fds->push_back({ client.fd, events, 0 });
+  }
+  return(1 + this->clients.size());
+}
+
+void FeedServer::service(const struct pollfd* fds, size_t num) {
+  if(num == 0) {
+    return;
+  }
+
+  // walk backwards, so that dropping a client does not shift the ones not yet handled
+  for(size_t i = num - 1; i >= 1; i--) {
+    size_t idx = i - 1;
+    if((idx >= this->clients.size()) || (this->clients[idx].fd != fds[i].fd)) {
+      continue;
+    }
+    FeedClient* client = &this->clients[idx];
+
+    // clients are not expected to send anything, but reading is the only way to see that they left
+    if(fds[i].revents & (POLLIN | POLLHUP | POLLERR)) {
+      uint8_t buff[256];
+      ssize_t n = recv(client->fd, buff, sizeof(buff), 0);
+      if((n == 0) || ((n < 0) && (errno != EAGAIN) && (errno != EWOULDBLOCK))) {
+        this->drop(idx, "disconnected");
+        continue;
+      }
+    }
+
+    if((fds[i].revents & POLLOUT) && !this->send(client)) {
+      this->drop(idx, "write failed");
+    }
+  }
+
+  if(fds[0].revents & POLLIN) {
+    this->accept();
+  }
+}
+
+void FeedServer::flush() {
+  for(size_t i = 0; i < this->clients.size(); i++) {
+    if(!this->send(&this->clients[i])) {
+      this->drop(i--, "write failed");
+    }
+  }
+}
+
+size_t FeedServer::getPendingMax() const {
+  size_t pending = 0;
+  for(const FeedClient& client : this->clients) {
+    pending = std::max(pending, client.out.size() - client.outPos);
+  }
+  return(pending);
+}
+
+void FeedServer::accept() {
+  while(true) {
+    struct sockaddr_in addr;
+    socklen_t addrLen = sizeof(addr);
+    int fd = ::accept(this->listenFd, (struct sockaddr*)&addr, &addrLen);
+    if(fd < 0) {
+      return;
+    }
+    int yes = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+    if(!setNonBlocking(fd)) {
+      close(fd);
+      continue;
+    }
+    FeedClient client;
+    client.fd = fd;
+    this->clients.push_back(client);
+    printf("[%s] Client %s:%u connected\n", this->name, inet_ntoa(addr.sin_addr), (unsigned)ntohs(addr.sin_port));
+  }
+}
+
+bool FeedServer::send(FeedClient* client) {
+  while(client->outPos < client->out.size()) {
+    ssize_t n = ::send(client->fd, &client->out[client->outPos], client->out.size() - client->outPos, MSG_NOSIGNAL);
+    if(n < 0) {
+      int err = errno;
+
+      // socket is full, drop what was already sent so the queue does not keep growing
+      if(client->outPos >= FEED_HIGH_WATER) {
+        client->out.erase(client->out.begin(), client->out.begin() + client->outPos);
+        client->outPos = 0;
+      }
+      return((err == EAGAIN) || (err == EWOULDBLOCK) || (err == EINTR));
+    }
+    client->outPos += n;
+    this->bytesSent += n;
+  }
+
+  // everything was sent, reuse the buffer
+  client->out.clear();
+  client->outPos = 0;
+  return(true);
+}
+
+void FeedServer::drop(size_t idx, const char* reason) {
+  printf("[%s] Client dropped (%s)\n", this->name, reason);
+  close(this->clients[idx].fd);
+  this->clients.erase(this->clients.begin() + idx);
+}
@@ -0,0 +1,65 @@
+#ifndef FEED_SERVER_H
+#define FEED_SERVER_H
+
+#include <poll.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// output queued for a single client, above this the client is dropped (live input) or input is paused (replay)
+#define FEED_MAX_PENDING              (4UL*1024UL*1024UL)
+#define FEED_HIGH_WATER               (256UL*1024UL)
+
+// client connected to a feed
+struct FeedClient {
+  int fd = -1;
+  std::vector<uint8_t> out;
+  size_t outPos = 0;
+};
+
+// TCP server that sends the same data to all connected clients, all sockets are non-blocking
+class FeedServer {
+  public:
+    // name is only used in log messages
+    explicit FeedServer(const char* name);
+    ~FeedServer();
+
+    // start listening on all interfaces, returns false on failure
+    bool begin(uint16_t port);
+
+    // close the listening socket and all clients
+    void end();
+
+    // queue data for all clients, clients that fell too far behind are dropped
+    void broadcast(const uint8_t* data, size_t len);
+
+    // add the sockets to the poll list, returns the number of entries added
+    size_t addPollFds(std::vector<struct pollfd>* fds);
+
+    // handle poll events, fds points to the first entry added by addPollFds
+    void service(const struct pollfd* fds, size_t num);
+
+    // try to send queued data without waiting for poll
+    void flush();
+
+    // whether there is anyone to send data to
+    bool hasClients() const { return(!this->clients.empty()); }
+
+    // size of the longest client queue
+    size_t getPendingMax() const;
+
+    // total bytes sent to clients
+    uint64_t getBytesSent() const { return(this->bytesSent); }
+
+  private:
+    const char* name;
+    int listenFd = -1;
+    std::vector<FeedClient> clients;
+    uint64_t bytesSent = 0;
+
+    void accept();
+    bool send(FeedClient* client);
+    void drop(size_t idx, const char* reason);
+};
+
+#endif
@@ -0,0 +1,608 @@
+/*
+  RadioLib ADS-B monitor
+
+  Receives raw ADS-B frames, tracks the aircraft using ADSBTracker and serves
+  the traffic to local clients over TCP, in the formats used by the common
+  ADS-B tools (dump1090 and its clients, Virtual Radar Server, tar1090, pyModeS):
+    - raw AVR ("*8D4840D6202CC371C32CE0576098;"), port 30002 by default
+    - SBS-1 (BaseStation) CSV, port 30003 by default
+    - Beast binary, port 30005 by default
+
+  Frames are read from a serial port connected to a device running the
+  ADSB_Monitor example, or from a file recorded from it. Any line with 11 or 14
+  bytes of hex is accepted, so the "[ADS-B] ..." lines printed by the example,
+  raw AVR files and plain hex dumps all work. Frames with all-zero parity are
+  assumed to be checked by the radio and get their parity recalculated, others
+  are checked and corrected in software.
+
+  Files are replayed as fast as possible by default, the number of frames
+  and the CPU time spent are reported at the end, so that the decoding and
+  serving can be benchmarked on recorded traffic.
+
+  Usage: adsb-monitor [options] SOURCE
+    --baud N          serial port baudrate (default 115200)
+    --rate N          replay files at N frames per second (default 0, as fast as possible)
+    --repeat N        replay files N times (default 1)
+    --wait            wait for the first client before replaying
+    --max-errors N    number of bit errors to correct, 0 to 2 (default 1)
+    --capacity N      maximum number of tracked aircraft (default 1024)
+    --raw-port N      raw AVR port, 0 to disable (default 30002)
+    --sbs-port N      SBS-1 port, 0 to disable (default 30003)
+    --beast-port N    Beast port, 0 to disable (default 30005)
+    --quiet           do not print the aircraft table
+*/
+
+#include <RadioLib.h>
+
+#include "FeedServer.h"
+
+#include <chrono>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+// Beast timestamps are in units of 1/12 us
+#define BEAST_ESCAPE                  (0x1A)
+#define BEAST_TYPE_MODE_S_LONG        ('3')
+#define BEAST_CLOCK_MHZ               (12)
+
+// how often the aircraft table is printed and old aircraft dropped, in ms
+#define MONITOR_STATUS_PERIOD_MS      (10000UL)
+#define MONITOR_EXPIRE_PERIOD_MS      (1000UL)
+
+struct MonitorOptions {
+  const char* source = NULL;
+  uint32_t baud = 115200;
+  uint32_t rate = 0;
+  uint32_t repeat = 1;
+  bool wait = false;
+  uint8_t maxErrors = 1;
+  size_t capacity = 1024;
+  uint16_t rawPort = 30002;
+  uint16_t sbsPort = 30003;
+  uint16_t beastPort = 30005;
+  bool quiet = false;
+};
+
+struct MonitorStats {
+  uint64_t lines = 0;
+  uint64_t frames = 0;
+  uint64_t corrected = 0;
+  uint64_t parityErrors = 0;
+  uint64_t squitters = 0;
+  size_t maxAircraft = 0;
+};
+
+// radio that does nothing, frames come from the serial port or a file
+class NullRadio : public PhysicalLayer {
+  private:
+    Module* getMod() override { return(nullptr); }
+};
+
+static volatile sig_atomic_t running = 1;
+
+static void onSignal(int sig) {
+  (void)sig;
+  running = 0;
+}
+
+static void usage(const char* name) {
+  fprintf(stderr, "Usage: %s [--baud N] [--rate N] [--repeat N] [--wait] [--max-errors N] [--capacity N]\n"
+                  "       [--raw-port N] [--sbs-port N] [--beast-port N] [--quiet] SOURCE\n", name);
+}
+
+static bool parseArgs(int argc, char** argv, MonitorOptions* opts) {
+  for(int i = 1; i < argc; i++) {
+    const char* arg = argv[i];
+    bool hasValue = (i + 1 < argc);
+    if((strcmp(arg, "--baud") == 0) && hasValue) {
+      opts->baud = strtoul(argv[++i], NULL, 10);
+    } else if((strcmp(arg, "--rate") == 0) && hasValue) {
+      opts->rate = strtoul(argv[++i], NULL, 10);
+    } else if((strcmp(arg, "--repeat") == 0) && hasValue) {
+      opts->repeat = strtoul(argv[++i], NULL, 10);
+    } else if(strcmp(arg, "--wait") == 0) {
+      opts->wait = true;
+    } else if((strcmp(arg, "--max-errors") == 0) && hasValue) {
+      opts->maxErrors = strtoul(argv[++i], NULL, 10);
+    } else if((strcmp(arg, "--capacity") == 0) && hasValue) {
+      opts->capacity = strtoul(argv[++i], NULL, 10);
+    } else if((strcmp(arg, "--raw-port") == 0) && hasValue) {
+      opts->rawPort = strtoul(argv[++i], NULL, 10);
+    } else if((strcmp(arg, "--sbs-port") == 0) && hasValue) {
+      opts->sbsPort = strtoul(argv[++i], NULL, 10);
+    } else if((strcmp(arg, "--beast-port") == 0) && hasValue) {
+      opts->beastPort = strtoul(argv[++i], NULL, 10);
+    } else if(strcmp(arg, "--quiet") == 0) {
+      opts->quiet = true;
+    } else if((arg[0] != '-') && !opts->source) {
+      opts->source = arg;
+    } else {
+      return(false);
+    }
+  }
+  return(opts->source != NULL);
+}
+
+static speed_t getBaudConst(uint32_t baud) {
+  switch(baud) {
+    case(9600): return(B9600);
+    case(19200): return(B19200);
+    case(38400): return(B38400);
+    case(57600): return(B57600);
+    case(115200): return(B115200);
+    case(230400): return(B230400);
+    case(460800): return(B460800);
+    case(921600): return(B921600);
+    default: return(B0);
+  }
+}
+
+static int openSerial(const char* path, uint32_t baud) {
+  speed_t speed = getBaudConst(baud);
+  if(speed == B0) {
+    fprintf(stderr, "Unsupported baudrate %u\n", (unsigned)baud);
+    return(-1);
+  }
+  int fd = open(path, O_RDWR | O_NOCTTY | O_NONBLOCK);
+  if(fd < 0) {
+    return(-1);
+  }
+  struct termios tty;
+  if(tcgetattr(fd, &tty) != 0) {
+    close(fd);
+    return(-1);
+  }
+  cfmakeraw(&tty);
+  cfsetispeed(&tty, speed);
+  cfsetospeed(&tty, speed);
+  tty.c_cflag |= CLOCAL | CREAD;
+  if(tcsetattr(fd, TCSANOW, &tty) != 0) {
+    close(fd);
+    return(-1);
+  }
+  return(fd);
+}
+
+static int hexValue(char c) {
+  if((c >= '0') && (c <= '9')) { return(c - '0'); }
+  if((c >= 'A') && (c <= 'F')) { return(c - 'A' + 10); }
+  if((c >= 'a') && (c <= 'f')) { return(c - 'a' + 10); }
+  return(-1);
+}
+
+// finds the longest run of hex digits in the line, returns the number of bytes or 0 if it is not a frame
+static size_t parseLine(const char* line, size_t len, uint8_t frame[RADIOLIB_ADSB_FRAME_LEN_BYTES]) {
+  size_t bestPos = 0;
+  size_t bestLen = 0;
+  for(size_t i = 0; i < len;) {
+    size_t j = i;
+    while((j < len) && (hexValue(line[j]) >= 0)) {
+      j++;
+    }
+    if(j - i > bestLen) {
+      bestPos = i;
+      bestLen = j - i;
+    }
+    i = j + 1;
+  }
+  if((bestLen != 2*RADIOLIB_ADSB_FRAME_DATA_LEN_BYTES) && (bestLen != 2*RADIOLIB_ADSB_FRAME_LEN_BYTES)) {
+    return(0);
+  }
+  for(size_t i = 0; i < bestLen / 2; i++) {
+    frame[i] = (hexValue(line[bestPos + 2*i]) << 4) | hexValue(line[bestPos + 2*i + 1]);
+  }
+  return(bestLen / 2);
+}
+
+class Monitor {
+  public:
+    explicit Monitor(const MonitorOptions& opts)
+      : opts(opts), adsb(&radio), tracker(&adsb, opts.capacity), raw("RAW"), sbs("SBS"), beast("Beast") {
+      (void)this->adsb.setParityCheck(false, opts.maxErrors);
+      this->start = std::chrono::steady_clock::now();
+    }
+
+    bool begin() {
+      return(((this->opts.rawPort == 0) || this->raw.begin(this->opts.rawPort)) &&
+             ((this->opts.sbsPort == 0) || this->sbs.begin(this->opts.sbsPort)) &&
+             ((this->opts.beastPort == 0) || this->beast.begin(this->opts.beastPort)));
+    }
+
+    // milliseconds since start, used as the tracker clock
+    RadioLibTime_t millis() const {
+      return(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - this->start).count());
+    }
+
+    bool hasClients() const {
+      return(this->raw.hasClients() || this->sbs.hasClients() || this->beast.hasClients());
+    }
+
+    size_t getPendingMax() const {
+      return(std::max(this->raw.getPendingMax(), std::max(this->sbs.getPendingMax(), this->beast.getPendingMax())));
+    }
+
+    uint64_t getBytesSent() const {
+      return(this->raw.getBytesSent() + this->sbs.getBytesSent() + this->beast.getBytesSent());
+    }
+
+    // wait for socket events, extraFd is polled for input too if it is not negative
+    bool poll(int timeout, int extraFd = -1) {
+      std::vector<struct pollfd> fds;
+      size_t numRaw = this->raw.addPollFds(&fds);
+      size_t numSbs = this->sbs.addPollFds(&fds);
+      size_t numBeast = this->beast.addPollFds(&fds);
+      if(extraFd >= 0) {
+        fds.push_back({ extraFd, POLLIN, 0 });
+      }
+      if(::poll(fds.data(), fds.size(), timeout) <= 0) {
+        return(false);
+      }
+      this->raw.service(&fds[0], numRaw);
+      this->sbs.service(&fds[numRaw], numSbs);
+      this->beast.service(&fds[numRaw + numSbs], numBeast);
+      return((extraFd >= 0) && (fds.back().revents & (POLLIN | POLLHUP | POLLERR)));
+    }
+
+    void flush() {
+      this->raw.flush();
+      this->sbs.flush();
+      this->beast.flush();
+    }
+
+    void processLine(const char* line, size_t len) {
+      this->stats.lines++;
+      uint8_t frame[RADIOLIB_ADSB_FRAME_LEN_BYTES] = { 0 };
+      size_t frameLen = parseLine(line, len, frame);
+      if(frameLen == 0) {
+        return;
+      }
+      this->stats.frames++;
+
+      // all-zero parity means the radio already checked it, only the frame data was passed
+      uint32_t parity = ((uint32_t)frame[11] << 16) | ((uint32_t)frame[12] << 8) | (uint32_t)frame[13];
+      if((frameLen == RADIOLIB_ADSB_FRAME_DATA_LEN_BYTES) || (parity == 0)) {
+        parity = ADSBClient::crc24(frame, RADIOLIB_ADSB_FRAME_DATA_LEN_BYTES);
+        frame[11] = parity >> 16;
+        frame[12] = parity >> 8;
+        frame[13] = parity;
+      } else {
+        uint8_t numErrors = 0;
+        if(this->adsb.checkParity(frame, &numErrors) != RADIOLIB_ERR_NONE) {
+          this->stats.parityErrors++;
+          return;
+        }
+        this->stats.corrected += numErrors;
+      }
+
+      RadioLibTime_t now = this->millis();
+      this->sendRaw(frame);
+      this->sendBeast(frame);
+
+      // only extended squitter carries the information the tracker needs
+      uint8_t df = frame[0] >> 3;
+      if((df != RADIOLIB_ADSB_DF_EXTENDED_SQUITTER) && (df != RADIOLIB_ADSB_DF_EXTENDED_SQUITTER_NON_TRANSPONDER)) {
+        return;
+      }
+      this->stats.squitters++;
+      ADSBFrame decoded;
+      ADSBAircraft_t* ac = NULL;
+      if((this->adsb.decode(frame, &decoded) != RADIOLIB_ERR_NONE) ||
+         (this->tracker.update(&decoded, now, &ac) != RADIOLIB_ERR_NONE)) {
+        return;
+      }
+      this->stats.maxAircraft = std::max(this->stats.maxAircraft, this->tracker.getNumAircraft());
+      this->sendSbs(decoded.messageType, ac);
+
+      if(now - this->lastExpire >= MONITOR_EXPIRE_PERIOD_MS) {
+        this->tracker.expire(now);
+        this->lastExpire = now;
+      }
+    }
+
+    void printTable() {
+      printf("\n%-6s  %-8s  %6s  %9s  %10s  %5s  %5s  %6s  %6s\n", "ICAO", "Callsign", "Alt", "Lat", "Lon", "Speed", "Track", "Msgs", "Age");
+      RadioLibTime_t now = this->millis();
+      for(ADSBAircraft_t* ac = this->tracker.first(); ac; ac = this->tracker.next(ac)) {
+        char alt[16] = "";
+        char lat[16] = "";
+        char lon[16] = "";
+        char speed[16] = "";
+        char track[16] = "";
+        if(ac->altitude) {
+          snprintf(alt, sizeof(alt), "%d", ac->altitude);
+        }
+        if(ac->posValid) {
+          snprintf(lat, sizeof(lat), "%.4f", (double)ac->lat);
+          snprintf(lon, sizeof(lon), "%.4f", (double)ac->lon);
+        }
+        if(ac->velValid) {
+          snprintf(speed, sizeof(speed), "%.0f", (double)ac->speed);
+          snprintf(track, sizeof(track), "%.0f", (double)ac->heading);
+        }
+        printf("%06X  %-8s  %6s  %9s  %10s  %5s  %5s  %6u  %5.1fs\n", (unsigned)ac->icao, ac->callsign, alt, lat, lon,
+               speed, track, (unsigned)ac->numMessages, (double)(now - ac->lastSeen) / 1000.0);
+      }
+      printf("%u aircraft, %llu frames, %llu parity errors\n", (unsigned)this->tracker.getNumAircraft(),
+             (unsigned long long)this->stats.frames, (unsigned long long)this->stats.parityErrors);
+    }
+
+    const MonitorOptions& opts;
+    MonitorStats stats;
+
+  private:
+    NullRadio radio;
+    ADSBClient adsb;
+    ADSBTracker tracker;
+    FeedServer raw;
+    FeedServer sbs;
+    FeedServer beast;
+    std::chrono::steady_clock::time_point start;
+    RadioLibTime_t lastExpire = 0;
+
+    void sendRaw(const uint8_t* frame) {
+      if(!this->raw.hasClients()) {
+        return;
+      }
+      char line[2*RADIOLIB_ADSB_FRAME_LEN_BYTES + 4];
+      static const char digits[] = "0123456789ABCDEF";
+      size_t pos = 0;
+      line[pos++] = '*';
+      for(size_t i = 0; i < RADIOLIB_ADSB_FRAME_LEN_BYTES; i++) {
+        line[pos++] = digits[frame[i] >> 4];
+        line[pos++] = digits[frame[i] & 0x0F];
+      }
+      line[pos++] = ';';
+      line[pos++] = '\n';
+      this->raw.broadcast((const uint8_t*)line, pos);
+    }
+
+    void sendBeast(const uint8_t* frame) {
+      if(!this->beast.hasClients()) {
+        return;
+      }
+
+      // type, 48-bit timestamp, signal level and the frame, with the escape byte doubled everywhere but the start
+      uint64_t ts = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - this->start).count() * BEAST_CLOCK_MHZ;
+      uint8_t body[6 + 1 + RADIOLIB_ADSB_FRAME_LEN_BYTES];
+      for(int i = 0; i < 6; i++) {
+        body[i] = (ts >> (8*(5 - i))) & 0xFF;
+      }
+      body[6] = 0xFF;
+      memcpy(&body[7], frame, RADIOLIB_ADSB_FRAME_LEN_BYTES);
+
+      uint8_t msg[2 + 2*sizeof(body)];
+      size_t len = 0;
+      msg[len++] = BEAST_ESCAPE;
+      msg[len++] = BEAST_TYPE_MODE_S_LONG;
+      for(size_t i = 0; i < sizeof(body); i++) {
+        msg[len++] = body[i];
+        if(body[i] == BEAST_ESCAPE) {
+          msg[len++] = BEAST_ESCAPE;
+        }
+      }
+      this->beast.broadcast(msg, len);
+    }
+
+    void sendSbs(ADSBMessageType type, const ADSBAircraft_t* ac) {
+      if(!this->sbs.hasClients()) {
+        return;
+      }
+
+      // only identification, airborne position and airborne velocity are reported
+      char fields[128];
+      int msgType = 0;
+      switch(type) {
+        case(ADSBMessageType::AIRCRAFT_ID):
+          msgType = 1;
+          snprintf(fields, sizeof(fields), "%s,,,,,,,,,,,", ac->callsign);
+          break;
+
+        case(ADSBMessageType::AIRBORNE_POS_ALT_BARO):
+        case(ADSBMessageType::AIRBORNE_POS_ALT_GNSS): {
+          msgType = 3;
+          int alt = ac->altGnss ? (int)((float)ac->altitude*3.28084f) : ac->altitude;
+          if(ac->posValid) {
+            snprintf(fields, sizeof(fields), ",%d,,,%.5f,%.5f,,,0,0,0,0", alt, (double)ac->lat, (double)ac->lon);
+          } else {
+            snprintf(fields, sizeof(fields), ",%d,,,,,,,0,0,0,0", alt);
+          }
+        } break;
+
+        case(ADSBMessageType::AIRBORNE_VEL):
+          msgType = 4;
+          if(ac->airspeed) {
+            snprintf(fields, sizeof(fields), ",,,,,,%d,,0,0,0,0", ac->verticalRate);
+          } else {
+            snprintf(fields, sizeof(fields), ",,%.0f,%.0f,,,%d,,0,0,0,0", (double)ac->speed, (double)ac->heading, ac->verticalRate);
+          }
+          break;
+
+        default:
+          return;
+      }
+
+      // generated and logged timestamps are the same, as the frames are not timestamped by the receiver
+      struct timeval tv;
+      gettimeofday(&tv, NULL);
+      struct tm tm;
+      localtime_r(&tv.tv_sec, &tm);
+      char stamp[48];
+      snprintf(stamp, sizeof(stamp), "%04d/%02d/%02d,%02d:%02d:%02d.%03d", tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday,
+               tm.tm_hour, tm.tm_min, tm.tm_sec, (int)(tv.tv_usec / 1000));
+
+      char line[256];
+      int len = snprintf(line, sizeof(line), "MSG,%d,1,1,%06X,1,%s,%s,%s\r\n", msgType, (unsigned)ac->icao, stamp, stamp, fields);
+      this->sbs.broadcast((const uint8_t*)line, RADIOLIB_MIN(len, (int)sizeof(line) - 1));
+    }
+};
+
+// processes complete lines that were already read, up to maxLines
+static void processLines(std::vector<char>* pending, Monitor* monitor, size_t maxLines, size_t* numLines) {
+  size_t start = 0;
+  for(size_t i = 0; (i < pending->size()) && (*numLines < maxLines); i++) {
+    if(((*pending)[i] == '\n') || ((*pending)[i] == '\r')) {
+      if(i > start) {
+        monitor->processLine(&(*pending)[start], i - start);
+        (*numLines)++;
+      }
+      start = i + 1;
+    }
+  }
+  pending->erase(pending->begin(), pending->begin() + start);
+}
+
+// reads more input only when there are no complete lines left, returns false when the input ended
+static bool readLines(int fd, std::vector<char>* pending, Monitor* monitor, size_t maxLines, size_t* numLines) {
+  processLines(pending, monitor, maxLines, numLines);
+  if(*numLines >= maxLines) {
+    return(true);
+  }
+
+  char chunk[4096];
+  ssize_t n = read(fd, chunk, sizeof(chunk));
+  if(n == 0) {
+    // last line may be missing the line ending
+    pending->push_back('\n');
+    processLines(pending, monitor, SIZE_MAX, numLines);
+    return(false);
+  }
+  if(n < 0) {
+    return((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR));
+  }
+  pending->insert(pending->end(), chunk, chunk + n);
+  processLines(pending, monitor, maxLines, numLines);
+  return(true);
+}
+
+static int runSerial(Monitor* monitor, const MonitorOptions& opts) {
+  int fd = openSerial(opts.source, opts.baud);
+  if(fd < 0) {
+    fprintf(stderr, "Failed to open %s: %s\n", opts.source, strerror(errno));
+    return(1);
+  }
+  printf("Listening to serial port %s @ %u\n", opts.source, (unsigned)opts.baud);
+
+  std::vector<char> pending;
+  RadioLibTime_t lastStatus = 0;
+  while(running) {
+    if(monitor->poll(100, fd)) {
+      size_t numLines = 0;
+      if(!readLines(fd, &pending, monitor, SIZE_MAX, &numLines)) {
+        fprintf(stderr, "Serial port closed\n");
+        break;
+      }
+      monitor->flush();
+    }
+
+    RadioLibTime_t now = monitor->millis();
+    if(!opts.quiet && (now - lastStatus >= MONITOR_STATUS_PERIOD_MS)) {
+      monitor->printTable();
+      lastStatus = now;
+    }
+  }
+  close(fd);
+  return(0);
+}
+
+static int runFile(Monitor* monitor, const MonitorOptions& opts) {
+  int fd = open(opts.source, O_RDONLY);
+  if(fd < 0) {
+    fprintf(stderr, "Failed to open %s: %s\n", opts.source, strerror(errno));
+    return(1);
+  }
+
+  if(opts.wait) {
+    printf("Waiting for a client ...\n");
+    while(running && !monitor->hasClients()) {
+      monitor->poll(100);
+    }
+  }
+
+  // the replay is paused while clients catch up, so that they get everything
+  std::vector<char> pending;
+  uint32_t pass = 0;
+  uint64_t sent = 0;
+  auto startWall = std::chrono::steady_clock::now();
+  clock_t startCpu = clock();
+  while(running && (pass < opts.repeat)) {
+    if(monitor->getPendingMax() >= FEED_HIGH_WATER) {
+      monitor->poll(100);
+      continue;
+    }
+
+    // when pacing, only the lines that are due are processed
+    size_t maxLines = SIZE_MAX;
+    if(opts.rate) {
+      double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - startWall).count();
+      uint64_t due = (uint64_t)(elapsed*opts.rate);
+      if(due <= sent) {
+        monitor->poll(1);
+        continue;
+      }
+      maxLines = due - sent;
+    }
+
+    size_t numLines = 0;
+    if(!readLines(fd, &pending, monitor, maxLines, &numLines)) {
+      pending.clear();
+      lseek(fd, 0, SEEK_SET);
+      pass++;
+    }
+    sent += numLines;
+    monitor->flush();
+    monitor->poll(0);
+  }
+  double cpuTime = (double)(clock() - startCpu) / CLOCKS_PER_SEC;
+  double wallTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - startWall).count();
+  close(fd);
+
+  // let the clients get the rest
+  auto flushStart = std::chrono::steady_clock::now();
+  while(running && monitor->getPendingMax() && (std::chrono::steady_clock::now() - flushStart < std::chrono::seconds(5))) {
+    monitor->poll(100);
+  }
+
+  if(!opts.quiet) {
+    monitor->printTable();
+  }
+  const MonitorStats& stats = monitor->stats;
+  printf("\n%llu lines, %llu frames (%llu extended squitter), %llu bits corrected, %llu parity errors\n",
+         (unsigned long long)stats.lines, (unsigned long long)stats.frames, (unsigned long long)stats.squitters,
+         (unsigned long long)stats.corrected, (unsigned long long)stats.parityErrors);
+  printf("Up to %u aircraft tracked, %llu bytes sent to clients\n", (unsigned)stats.maxAircraft, (unsigned long long)monitor->getBytesSent());
+  printf("%.3f s wall time, %.3f s CPU time, %.0f frames per second\n", wallTime, cpuTime, wallTime > 0 ? (double)stats.frames / wallTime : 0.0);
+  return(0);
+}
+
+int main(int argc, char** argv) {
+  MonitorOptions opts;
+  if(!parseArgs(argc, argv, &opts) || (opts.maxErrors > 2) || (opts.capacity == 0)) {
+    usage(argv[0]);
+    return(1);
+  }
+
+  signal(SIGINT, onSignal);
+  signal(SIGTERM, onSignal);
+  signal(SIGPIPE, SIG_IGN);
+
+  Monitor monitor(opts);
+  if(!monitor.begin()) {
+    return(1);
+  }
+
+  // character devices are serial ports, everything else is a recording
+  struct stat st;
+  if((stat(opts.source, &st) == 0) && S_ISCHR(st.st_mode)) {
+    return(runSerial(&monitor, opts));
+  }
+  return(runFile(&monitor, opts));
+}
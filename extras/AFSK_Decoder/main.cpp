@@ -0,0 +1,329 @@
+/*
+  RadioLib AFSK decoder
+
+  Receives 1200 baud AX.25 packet radio from audio recordings, using
+  BellDemodulator to turn the audio into bits and AX25Client to find
+  and check the frames. Received frames are printed in the usual
+  "SRC>DEST,PATH:info" format. At the end, the number of frames and the
+  CPU time spent per second of audio are reported, so that the decoder
+  can be benchmarked on test recordings.
+
+  Test recordings can also be generated: random APRS frames are encoded
+  by AX25Client, modulated as Bell 202 AFSK and saved with added white
+  noise and twist (level difference between the two tones, as caused by
+  pre-emphasis in FM radios).
+
+  Usage: afsk-decoder [options] FILE.wav
+    --generate        generate test recording into FILE.wav instead of decoding it
+    --frames N        number of frames to generate (default 100)
+    --rate R          sample rate of the generated recording in Hz (default 22050)
+    --snr DB          signal to noise ratio in 3 kHz bandwidth in dB (default 20)
+    --twist DB        space tone level relative to mark tone in dB (default 0)
+    --seed N          random seed (default 1)
+    --quiet           do not print the received frames
+
+  Only uncompressed PCM WAV files with 8 or 16 bits per sample are supported,
+  from multi-channel files only the first channel is used.
+*/
+
+#include <RadioLib.h>
+
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+struct DecoderOptions {
+  const char* file = NULL;
+  bool generate = false;
+  uint32_t frames = 100;
+  uint32_t rate = 22050;
+  double snr = 20.0;
+  double twist = 0.0;
+  uint32_t seed = 1;
+  bool quiet = false;
+};
+
+// radio that keeps the encoded frame, so that it can be turned into audio
+class CaptureRadio : public PhysicalLayer {
+  public:
+    std::vector<uint8_t> sent;
+
+    int16_t transmit(const uint8_t* data, size_t len, uint8_t addr) override {
+      (void)addr;
+      this->sent.assign(data, data + len);
+      return(RADIOLIB_ERR_NONE);
+    }
+
+  private:
+    Module* getMod() override { return(nullptr); }
+};
+
+static void usage(const char* name) {
+  fprintf(stderr, "Usage: %s [--generate] [--frames N] [--rate R] [--snr DB] [--twist DB] [--seed N] [--quiet] FILE.wav\n", name);
+}
+
+static bool parseArgs(int argc, char** argv, DecoderOptions* opts) {
+  for(int i = 1; i < argc; i++) {
+    const char* arg = argv[i];
+    bool hasValue = (i + 1 < argc);
+    if(strcmp(arg, "--generate") == 0) {
+      opts->generate = true;
+    } else if((strcmp(arg, "--frames") == 0) && hasValue) {
+      opts->frames = strtoul(argv[++i], NULL, 10);
+    } else if((strcmp(arg, "--rate") == 0) && hasValue) {
+      opts->rate = strtoul(argv[++i], NULL, 10);
+    } else if((strcmp(arg, "--snr") == 0) && hasValue) {
+      opts->snr = atof(argv[++i]);
+    } else if((strcmp(arg, "--twist") == 0) && hasValue) {
+      opts->twist = atof(argv[++i]);
+    } else if((strcmp(arg, "--seed") == 0) && hasValue) {
+      opts->seed = strtoul(argv[++i], NULL, 10);
+    } else if(strcmp(arg, "--quiet") == 0) {
+      opts->quiet = true;
+    } else if((arg[0] != '-') && !opts->file) {
+      opts->file = arg;
+    } else {
+      return(false);
+    }
+  }
+  return(opts->file != NULL);
+}
+
+static void put16(FILE* f, uint16_t val) {
+  uint8_t b[2] = { (uint8_t)(val & 0xFF), (uint8_t)(val >> 8) };
+  fwrite(b, 1, 2, f);
+}
+
+static void put32(FILE* f, uint32_t val) {
+  put16(f, val & 0xFFFF);
+  put16(f, val >> 16);
+}
+
+static bool writeWav(const char* path, const std::vector<int16_t>& audio, uint32_t rate) {
+  FILE* f = fopen(path, "wb");
+  if(!f) {
+    return(false);
+  }
+  uint32_t dataLen = audio.size()*sizeof(int16_t);
+  fwrite("RIFF", 1, 4, f);
+  put32(f, 36 + dataLen);
+  fwrite("WAVEfmt ", 1, 8, f);
+  put32(f, 16);
+  put16(f, 1);
+  put16(f, 1);
+  put32(f, rate);
+  put32(f, rate*sizeof(int16_t));
+  put16(f, sizeof(int16_t));
+  put16(f, 16);
+  fwrite("data", 1, 4, f);
+  put32(f, dataLen);
+  for(int16_t s : audio) {
+    put16(f, (uint16_t)s);
+  }
+  fclose(f);
+  return(true);
+}
+
+static bool readWav(const char* path, std::vector<int16_t>* audio, uint32_t* rate) {
+  FILE* f = fopen(path, "rb");
+  if(!f) {
+    return(false);
+  }
+  std::vector<uint8_t> file;
+  uint8_t chunk[4096];
+  size_t n;
+  while((n = fread(chunk, 1, sizeof(chunk), f)) > 0) {
+    file.insert(file.end(), chunk, chunk + n);
+  }
+  fclose(f);
+
+  if((file.size() < 12) || (memcmp(&file[0], "RIFF", 4) != 0) || (memcmp(&file[8], "WAVE", 4) != 0)) {
+    return(false);
+  }
+
+  // walk the chunks, format has to come before data
+  uint16_t channels = 0;
+  uint16_t bits = 0;
+  size_t pos = 12;
+  while(pos + 8 <= file.size()) {
+    uint32_t len = file[pos + 4] | (file[pos + 5] << 8) | (file[pos + 6] << 16) | ((uint32_t)file[pos + 7] << 24);
+    const uint8_t* body = &file[pos + 8];
+    len = RADIOLIB_MIN(len, (uint32_t)(file.size() - pos - 8));
+    if((memcmp(&file[pos], "fmt ", 4) == 0) && (len >= 16)) {
+      uint16_t format = body[0] | (body[1] << 8);
+      channels = body[2] | (body[3] << 8);
+      *rate = body[4] | (body[5] << 8) | (body[6] << 16) | ((uint32_t)body[7] << 24);
+      bits = body[14] | (body[15] << 8);
+      if((format != 1) || (channels == 0) || ((bits != 8) && (bits != 16))) {
+        return(false);
+      }
+
+    } else if((memcmp(&file[pos], "data", 4) == 0) && channels) {
+      size_t frameLen = channels*bits/8;
+      for(size_t i = 0; i + frameLen <= len; i += frameLen) {
+        if(bits == 16) {
+          audio->push_back((int16_t)(body[i] | (body[i + 1] << 8)));
+        } else {
+          audio->push_back(((int16_t)body[i] - 128) << 8);
+        }
+      }
+      return(true);
+    }
+    pos += 8 + len + (len & 0x01);
+  }
+  return(false);
+}
+
+static double gaussian() {
+  double u1 = ((double)rand() + 1.0) / ((double)RAND_MAX + 2.0);
+  double u2 = ((double)rand() + 1.0) / ((double)RAND_MAX + 2.0);
+  return(sqrt(-2.0*log(u1))*cos(2.0*M_PI*u2));
+}
+
+static int generate(const DecoderOptions& opts) {
+  srand(opts.seed);
+  CaptureRadio radio;
+  AX25Client ax25(&radio);
+  ax25.begin("N7LEM", 0, 16);
+
+  // signal is scaled so that mark tone has amplitude of 1, noise is set relative to that in 3 kHz
+  double spaceAmp = pow(10.0, opts.twist / 20.0);
+  double noise = sqrt(0.5 / pow(10.0, opts.snr / 10.0) * (opts.rate / 2.0) / 3000.0);
+  double scale = 8000.0;
+
+  std::vector<int16_t> audio;
+  double phase = 0;
+  double t = 0;
+  auto emit = [&](uint8_t bit) {
+    double freq = bit ? Bell202.freqMark : Bell202.freqSpace;
+    double amp = bit ? 1.0 : spaceAmp;
+    t += (double)opts.rate / Bell202.baudRate;
+    while((double)audio.size() < t) {
+      double s = scale*(amp*sin(phase) + noise*gaussian());
+      audio.push_back((int16_t)RADIOLIB_MAX(RADIOLIB_MIN(s, 32767.0), -32768.0));
+      phase += 2.0*M_PI*freq / opts.rate;
+    }
+  };
+  auto silence = [&](double seconds) {
+    for(size_t i = 0; i < (size_t)(seconds*opts.rate); i++) {
+      audio.push_back((int16_t)(scale*noise*gaussian()));
+    }
+    t = audio.size();
+  };
+
+  silence(0.5);
+  for(uint32_t i = 0; i < opts.frames; i++) {
+    // APRS position with a sequence number, so that lost frames can be identified
+    char info[64];
+    snprintf(info, sizeof(info), "!%02d%02d.%02dN/%03d%02d.%02dW-Test frame %05u",
+             rand() % 90, rand() % 60, rand() % 100, rand() % 180, rand() % 60, rand() % 100, (unsigned)i);
+    AX25Frame frame("APRS", 0, "N7LEM", 0, RADIOLIB_AX25_CONTROL_UNNUMBERED_FRAME, RADIOLIB_AX25_PID_NO_LAYER_3, info);
+    ax25.sendFrame(&frame);
+    for(uint8_t b : radio.sent) {
+      for(int j = 7; j >= 0; j--) {
+        emit((b >> j) & 0x01);
+      }
+    }
+
+    // transmitter tail
+    for(int j = 0; j < 16; j++) {
+      emit(j % 2);
+    }
+    silence(0.2);
+  }
+
+  if(!writeWav(opts.file, audio, opts.rate)) {
+    fprintf(stderr, "Failed to write %s\n", opts.file);
+    return(1);
+  }
+  printf("Generated %u frames, %.1f s at %u Hz, SNR %.1f dB, twist %.1f dB\n",
+         (unsigned)opts.frames, (double)audio.size() / opts.rate, (unsigned)opts.rate, opts.snr, opts.twist);
+  return(0);
+}
+
+static void printFrame(const AX25Frame& frame) {
+  printf("%s-%d>%s-%d", frame.srcCallsign, frame.srcSSID, frame.destCallsign, frame.destSSID);
+  for(uint8_t i = 0; i < frame.numRepeaters; i++) {
+    printf(",%s-%d%s", frame.repeaterCallsigns[i], frame.repeaterSSIDs[i] & 0x0F,
+           (frame.repeaterSSIDs[i] & RADIOLIB_AX25_SSID_HAS_BEEN_REPEATED) ? "*" : "");
+  }
+  printf(":");
+  for(uint16_t i = 0; i < frame.infoLen; i++) {
+    char c = frame.info[i];
+    printf("%c", ((c >= ' ') && (c <= '~')) ? c : '.');
+  }
+  printf("\n");
+}
+
+static int decode(const DecoderOptions& opts) {
+  std::vector<int16_t> audio;
+  uint32_t rate = 0;
+  if(!readWav(opts.file, &audio, &rate)) {
+    fprintf(stderr, "Failed to read %s\n", opts.file);
+    return(1);
+  }
+
+  BellDemodulator demod;
+  int16_t state = demod.begin(Bell202, rate);
+  if(state != RADIOLIB_ERR_NONE) {
+    fprintf(stderr, "Unsupported sample rate %u Hz, code %d\n", (unsigned)rate, state);
+    return(1);
+  }
+  CaptureRadio radio;
+  AX25Client ax25(&radio);
+
+  // demodulation alone first, to see how much of the time it takes
+  auto start = std::chrono::steady_clock::now();
+  size_t pos = 0;
+  while(pos < audio.size()) {
+    pos += demod.demodulate(&audio[pos], audio.size() - pos);
+    uint8_t bits[RADIOLIB_BELL_DEMOD_BUFF_LEN];
+    (void)demod.read(bits, sizeof(bits));
+  }
+  double demodTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  // then the complete receive path
+  demod.reset();
+  uint32_t frames = 0;
+  start = std::chrono::steady_clock::now();
+  pos = 0;
+  AX25Frame frame("", 0, "", 0, 0);
+  while((pos < audio.size()) || demod.available()) {
+    pos += demod.demodulate(&audio[pos], audio.size() - pos);
+    uint8_t bits[RADIOLIB_BELL_DEMOD_BUFF_LEN];
+    size_t len = demod.read(bits, sizeof(bits));
+    size_t used = 0;
+    while(used < len) {
+      used += ax25.decode(&bits[used], len - used);
+      if(ax25.readFrame(&frame) == RADIOLIB_ERR_NONE) {
+        frames++;
+        if(!opts.quiet) {
+          printFrame(frame);
+        }
+      }
+    }
+  }
+  double totalTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  double seconds = (double)audio.size() / rate;
+  printf("\n%u frames decoded from %.1f s of audio at %u Hz\n", (unsigned)frames, seconds, (unsigned)rate);
+  printf("CPU time per second of audio: %.3f ms demodulation, %.3f ms total (%.0fx real time)\n",
+         1000.0*demodTime / seconds, 1000.0*totalTime / seconds, seconds / totalTime);
+  return(0);
+}
+
+int main(int argc, char** argv) {
+  DecoderOptions opts;
+  if(!parseArgs(argc, argv, &opts)) {
+    usage(argv[0]);
+    return(1);
+  }
+
+  if(opts.generate) {
+    return(generate(opts));
+  }
+  return(decode(opts));
+}
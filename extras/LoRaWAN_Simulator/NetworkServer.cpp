@@ -0,0 +1,709 @@
+#include "NetworkServer.h"
+
+#include <chrono>
+#include <math.h>
+#include <string.h>
+
+// LoRaWAN fields are little-endian
+static void putLE(uint8_t* buff, uint64_t val, size_t size) {
+  for(size_t i = 0; i < size; i++) {
+    buff[i] = (uint8_t)(val >> 8*i);
+  }
+}
+
+static uint64_t getLE(const uint8_t* buff, size_t size) {
+  uint64_t val = 0;
+  for(size_t i = 0; i < size; i++) {
+    val |= (uint64_t)buff[i] << 8*i;
+  }
+  return(val);
+}
+
+NetworkServer::NetworkServer(Simulator* sim, const LoRaWANBand_t* band, uint8_t subBand)
+  : sim(sim), band(band), subBand(subBand), rng(netId) {
+}
+
+void NetworkServer::addOTAA(uint64_t joinEUI, uint64_t devEUI, const uint8_t* nwkKey, const uint8_t* appKey) {
+  NsDevice dev;
+  dev.otaa = true;
+  dev.joinEUI = joinEUI;
+  dev.devEUI = devEUI;
+  memcpy(dev.appKey, appKey, RADIOLIB_AES128_KEY_SIZE);
+  if(nwkKey) {
+    dev.rev = 1;
+    memcpy(dev.nwkKey, nwkKey, RADIOLIB_AES128_KEY_SIZE);
+  }
+  this->byDevEUI[devEUI] = this->devices.size();
+  this->devices.push_back(dev);
+}
+
+void NetworkServer::addABP(uint32_t devAddr, const uint8_t* fNwkSIntKey, const uint8_t* sNwkSIntKey, const uint8_t* nwkSEncKey, const uint8_t* appSKey) {
+  NsDevice dev;
+  dev.active = true;
+  dev.devAddr = devAddr;
+  memcpy(dev.appSKey, appSKey, RADIOLIB_AES128_KEY_SIZE);
+  memcpy(dev.nwkSEncKey, nwkSEncKey, RADIOLIB_AES128_KEY_SIZE);
+  if(fNwkSIntKey && sNwkSIntKey) {
+    dev.rev = 1;
+    memcpy(dev.fNwkSIntKey, fNwkSIntKey, RADIOLIB_AES128_KEY_SIZE);
+    memcpy(dev.sNwkSIntKey, sNwkSIntKey, RADIOLIB_AES128_KEY_SIZE);
+  } else {
+    memcpy(dev.fNwkSIntKey, nwkSEncKey, RADIOLIB_AES128_KEY_SIZE);
+    memcpy(dev.sNwkSIntKey, nwkSEncKey, RADIOLIB_AES128_KEY_SIZE);
+  }
+  this->byDevAddr[devAddr] = this->devices.size();
+  this->devices.push_back(dev);
+}
+
+const NsDevice* NetworkServer::getDevice(uint32_t devAddr) const {
+  auto it = this->byDevAddr.find(devAddr);
+  if(it == this->byDevAddr.end()) {
+    return(NULL);
+  }
+  return(&this->devices[it->second]);
+}
+
+void NetworkServer::onUplink(const SimTransmission& tx, const std::vector<SimReception>& copies) {
+  auto tStart = std::chrono::steady_clock::now();
+
+  // downlinks go through the gateway that heard the uplink best
+  const SimReception* best = &copies[0];
+  for(const SimReception& copy : copies) {
+    if(copy.snr > best->snr) {
+      best = &copy;
+    }
+  }
+
+  if(tx.data.empty()) {
+    this->stats.malformed++;
+  } else {
+    switch(tx.data[0] & RADIOLIB_LORAWAN_MHDR_MTYPE_MASK) {
+      case(RADIOLIB_LORAWAN_MHDR_MTYPE_JOIN_REQUEST):
+        this->processJoinRequest(tx, *best);
+        break;
+      case(RADIOLIB_LORAWAN_MHDR_MTYPE_UNCONF_DATA_UP):
+      case(RADIOLIB_LORAWAN_MHDR_MTYPE_CONF_DATA_UP):
+        this->processDataUp(tx, *best, copies.size());
+        break;
+      default:
+        this->stats.malformed++;
+        break;
+    }
+  }
+
+  auto tEnd = std::chrono::steady_clock::now();
+  this->stats.processingNs += std::chrono::duration_cast<std::chrono::nanoseconds>(tEnd - tStart).count();
+}
+
+void NetworkServer::processJoinRequest(const SimTransmission& tx, const SimReception& best) {
+  this->stats.joinRequests++;
+  const uint8_t* msg = tx.data.data();
+  if(tx.data.size() != RADIOLIB_LORAWAN_JOIN_REQUEST_LEN) {
+    this->stats.malformed++;
+    return;
+  }
+
+  uint64_t joinEUI = getLE(&msg[RADIOLIB_LORAWAN_JOIN_REQUEST_JOIN_EUI_POS], sizeof(uint64_t));
+  uint64_t devEUI = getLE(&msg[RADIOLIB_LORAWAN_JOIN_REQUEST_DEV_EUI_POS], sizeof(uint64_t));
+  uint16_t devNonce = getLE(&msg[RADIOLIB_LORAWAN_JOIN_REQUEST_DEV_NONCE_POS], sizeof(uint16_t));
+
+  auto it = this->byDevEUI.find(devEUI);
+  if((it == this->byDevEUI.end()) || (this->devices[it->second].joinEUI != joinEUI)) {
+    this->stats.unknownDevices++;
+    return;
+  }
+  uint32_t idx = it->second;
+  NsDevice& dev = this->devices[idx];
+
+  // LoRaWAN 1.1 signs the request with NwkKey, 1.0 with AppKey
+  uint8_t* rootKey = (dev.rev == 1) ? dev.nwkKey : dev.appKey;
+  uint32_t mic = calculateMIC(rootKey, msg, RADIOLIB_LORAWAN_JOIN_REQUEST_LEN - sizeof(uint32_t));
+  if(mic != getLE(&msg[RADIOLIB_LORAWAN_JOIN_REQUEST_LEN - sizeof(uint32_t)], sizeof(uint32_t))) {
+    this->stats.micFailures++;
+    return;
+  }
+
+  // DevNonce is a counter since LoRaWAN 1.0.4, so anything not greater than the last one is a replay
+  if((dev.lastDevNonce != RADIOLIB_LORAWAN_FCNT_NONE) && (devNonce <= dev.lastDevNonce)) {
+    this->stats.duplicates++;
+    return;
+  }
+  dev.lastDevNonce = devNonce;
+
+  // start a new session with a new address
+  if(dev.active) {
+    this->byDevAddr.erase(dev.devAddr);
+  }
+  dev.joinNonce++;
+  dev.devAddr = ((this->netId & 0x7F) << 25) | (this->nextDevAddr++ & 0x01FFFFFF);
+  this->byDevAddr[dev.devAddr] = idx;
+
+  // JoinAccept without CFList, the default channels are used
+  uint8_t accept[RADIOLIB_LORAWAN_JOIN_ACCEPT_MAX_LEN] = { 0 };
+  size_t len = RADIOLIB_LORAWAN_JOIN_ACCEPT_MAX_LEN - RADIOLIB_LORAWAN_JOIN_ACCEPT_CFLIST_LEN;
+  accept[0] = RADIOLIB_LORAWAN_MHDR_MTYPE_JOIN_ACCEPT | RADIOLIB_LORAWAN_MHDR_MAJOR_R1;
+  putLE(&accept[RADIOLIB_LORAWAN_JOIN_ACCEPT_JOIN_NONCE_POS], dev.joinNonce, 3);
+  putLE(&accept[RADIOLIB_LORAWAN_JOIN_ACCEPT_HOME_NET_ID_POS], this->netId, 3);
+  putLE(&accept[RADIOLIB_LORAWAN_JOIN_ACCEPT_DEV_ADDR_POS], dev.devAddr, sizeof(uint32_t));
+  accept[RADIOLIB_LORAWAN_JOIN_ACCEPT_DL_SETTINGS_POS] = ((dev.rev == 1) ? RADIOLIB_LORAWAN_JOIN_ACCEPT_R_1_1 : RADIOLIB_LORAWAN_JOIN_ACCEPT_R_1_0) |
+                                                         (this->rx1DrOffset << 4) | this->band->rx2.dr;
+  accept[RADIOLIB_LORAWAN_JOIN_ACCEPT_RX_DELAY_POS] = RADIOLIB_LORAWAN_RECEIVE_DELAY_1_MS / 1000;
+
+  // sign it
+  if(dev.rev == 1) {
+    uint8_t ctx[RADIOLIB_AES128_BLOCK_SIZE] = { 0 };
+    uint8_t jSIntKey[RADIOLIB_AES128_KEY_SIZE];
+    putLE(&ctx[1], dev.devEUI, sizeof(uint64_t));
+    deriveKey(dev.nwkKey, RADIOLIB_LORAWAN_JOIN_ACCEPT_JS_INT_KEY, ctx, jSIntKey);
+
+    uint8_t micBuff[3*RADIOLIB_AES128_BLOCK_SIZE] = { 0 };
+    micBuff[0] = RADIOLIB_LORAWAN_JOIN_REQUEST_TYPE;
+    putLE(&micBuff[1], joinEUI, sizeof(uint64_t));
+    putLE(&micBuff[9], devNonce, sizeof(uint16_t));
+    memcpy(&micBuff[11], accept, len - sizeof(uint32_t));
+    mic = calculateMIC(jSIntKey, micBuff, 11 + len - sizeof(uint32_t));
+  } else {
+    mic = calculateMIC(dev.appKey, accept, len - sizeof(uint32_t));
+  }
+  putLE(&accept[len - sizeof(uint32_t)], mic, sizeof(uint32_t));
+
+  // derive the session keys the same way the device will
+  uint8_t ctx[RADIOLIB_AES128_BLOCK_SIZE] = { 0 };
+  putLE(&ctx[RADIOLIB_LORAWAN_JOIN_ACCEPT_AES_JOIN_NONCE_POS], dev.joinNonce, 3);
+  if(dev.rev == 1) {
+    putLE(&ctx[RADIOLIB_LORAWAN_JOIN_ACCEPT_AES_JOIN_EUI_POS], joinEUI, sizeof(uint64_t));
+    putLE(&ctx[RADIOLIB_LORAWAN_JOIN_ACCEPT_AES_DEV_NONCE_POS], devNonce, sizeof(uint16_t));
+    deriveKey(dev.appKey, RADIOLIB_LORAWAN_JOIN_ACCEPT_APP_S_KEY, ctx, dev.appSKey);
+    deriveKey(dev.nwkKey, RADIOLIB_LORAWAN_JOIN_ACCEPT_F_NWK_S_INT_KEY, ctx, dev.fNwkSIntKey);
+    deriveKey(dev.nwkKey, RADIOLIB_LORAWAN_JOIN_ACCEPT_S_NWK_S_INT_KEY, ctx, dev.sNwkSIntKey);
+    deriveKey(dev.nwkKey, RADIOLIB_LORAWAN_JOIN_ACCEPT_NWK_S_ENC_KEY, ctx, dev.nwkSEncKey);
+  } else {
+    putLE(&ctx[RADIOLIB_LORAWAN_JOIN_ACCEPT_HOME_NET_ID_POS], this->netId, 3);
+    putLE(&ctx[RADIOLIB_LORAWAN_JOIN_ACCEPT_DEV_ADDR_POS], devNonce, sizeof(uint16_t));
+    deriveKey(dev.appKey, RADIOLIB_LORAWAN_JOIN_ACCEPT_APP_S_KEY, ctx, dev.appSKey);
+    deriveKey(dev.appKey, RADIOLIB_LORAWAN_JOIN_ACCEPT_F_NWK_S_INT_KEY, ctx, dev.fNwkSIntKey);
+    memcpy(dev.sNwkSIntKey, dev.fNwkSIntKey, RADIOLIB_AES128_KEY_SIZE);
+    memcpy(dev.nwkSEncKey, dev.fNwkSIntKey, RADIOLIB_AES128_KEY_SIZE);
+  }
+
+  // the device decrypts the JoinAccept by encrypting it, so the server has to decrypt
+  uint8_t enc[RADIOLIB_LORAWAN_JOIN_ACCEPT_MAX_LEN];
+  enc[0] = accept[0];
+  RadioLibAES128Instance.init(rootKey);
+  RadioLibAES128Instance.decryptECB(&accept[1], len - 1, &enc[1]);
+
+  // reset the session state
+  dev.active = true;
+  dev.fCntUp = RADIOLIB_LORAWAN_FCNT_NONE;
+  dev.nFCntDown = 0;
+  dev.aFCntDown = 0;
+  dev.macDownLen = 0;
+  dev.snrLen = 0;
+  dev.snrPos = 0;
+  dev.dr = RADIOLIB_LORAWAN_DATA_RATE_UNUSED;
+  dev.txPower = 0;
+
+  this->stats.joinAccepts++;
+  this->sendRx1(tx, best, RADIOLIB_LORAWAN_JOIN_ACCEPT_DELAY_1_MS, enc, len);
+}
+
+void NetworkServer::processDataUp(const SimTransmission& tx, const SimReception& best, uint8_t gwCnt) {
+  const uint8_t* msg = tx.data.data();
+  size_t len = tx.data.size();
+
+  // MHDR(1) - DevAddr(4) - FCtrl(1) - FCnt(2) - FOpts - [FPort(1) - Payload] - MIC(4)
+  const size_t hdrLen = RADIOLIB_LORAWAN_FHDR_FOPTS_POS - RADIOLIB_LORAWAN_FHDR_LEN_START_OFFS;
+  uint8_t fCtrl = (len > hdrLen) ? msg[RADIOLIB_LORAWAN_FHDR_FCTRL_POS - RADIOLIB_LORAWAN_FHDR_LEN_START_OFFS] : 0;
+  uint8_t fOptsLen = fCtrl & RADIOLIB_LORAWAN_FHDR_FOPTS_LEN_MASK;
+  if(len < hdrLen + fOptsLen + sizeof(uint32_t)) {
+    this->stats.malformed++;
+    return;
+  }
+
+  uint32_t devAddr = getLE(&msg[RADIOLIB_LORAWAN_FHDR_DEV_ADDR_POS - RADIOLIB_LORAWAN_FHDR_LEN_START_OFFS], sizeof(uint32_t));
+  auto it = this->byDevAddr.find(devAddr);
+  if(it == this->byDevAddr.end()) {
+    this->stats.unknownDevices++;
+    return;
+  }
+  NsDevice& dev = this->devices[it->second];
+
+  // restore the full 32-bit frame counter
+  uint16_t fCnt16 = getLE(&msg[RADIOLIB_LORAWAN_FHDR_FCNT_POS - RADIOLIB_LORAWAN_FHDR_LEN_START_OFFS], sizeof(uint16_t));
+  uint32_t fCnt = fCnt16;
+  if(dev.fCntUp != RADIOLIB_LORAWAN_FCNT_NONE) {
+    fCnt = (dev.fCntUp & 0xFFFF0000UL) | fCnt16;
+    if(fCnt < dev.fCntUp) {
+      fCnt += 0x10000UL;
+    }
+  }
+
+  // check the MIC, the first block is prepended to the frame
+  uint8_t dr = this->getDatarate(tx.modem, tx.dr);
+  uint8_t buff[RADIOLIB_AES128_BLOCK_SIZE + 256] = { 0 };
+  size_t micLen = RADIOLIB_AES128_BLOCK_SIZE + len - sizeof(uint32_t);
+  buff[RADIOLIB_LORAWAN_BLOCK_MAGIC_POS] = RADIOLIB_LORAWAN_MIC_BLOCK_MAGIC;
+  buff[RADIOLIB_LORAWAN_BLOCK_DIR_POS] = RADIOLIB_LORAWAN_UPLINK;
+  putLE(&buff[RADIOLIB_LORAWAN_BLOCK_DEV_ADDR_POS], devAddr, sizeof(uint32_t));
+  putLE(&buff[RADIOLIB_LORAWAN_BLOCK_FCNT_POS], fCnt, sizeof(uint32_t));
+  buff[RADIOLIB_LORAWAN_MIC_BLOCK_LEN_POS] = len - sizeof(uint32_t);
+  memcpy(&buff[RADIOLIB_AES128_BLOCK_SIZE], msg, len - sizeof(uint32_t));
+  uint32_t micF = calculateMIC(dev.fNwkSIntKey, buff, micLen);
+  uint32_t mic = micF;
+  if(dev.rev == 1) {
+    // the second half is also bound to the datarate and channel, the server never sends confirmed downlinks
+    int16_t chIdx = this->getChannelIndex(tx.freq);
+    buff[RADIOLIB_LORAWAN_MIC_DATA_RATE_POS] = dr;
+    buff[RADIOLIB_LORAWAN_MIC_CH_INDEX_POS] = (chIdx < 0) ? 0 : chIdx;
+    uint32_t micS = calculateMIC(dev.sNwkSIntKey, buff, micLen);
+    mic = ((micF & 0xFFFF) << 16) | (micS & 0xFFFF);
+  }
+  if(mic != getLE(&msg[len - sizeof(uint32_t)], sizeof(uint32_t))) {
+    this->stats.micFailures++;
+    return;
+  }
+
+  // retransmissions of the same frame are acknowledged again, but not processed
+  bool dup = (dev.fCntUp != RADIOLIB_LORAWAN_FCNT_NONE) && (fCnt == dev.fCntUp);
+  if(dup) {
+    this->stats.duplicates++;
+  } else {
+    this->stats.uplinks++;
+    dev.fCntUp = fCnt;
+    dev.dr = dr;
+    dev.classB = (fCtrl & RADIOLIB_LORAWAN_FCTRL_CLASS_B) != 0;
+    dev.gateway = best.gateway;
+    dev.snrHistory[dev.snrPos] = best.snr;
+    dev.snrPos = (dev.snrPos + 1) % NS_ADR_HISTORY_LEN;
+    if(dev.snrLen < NS_ADR_HISTORY_LEN) {
+      dev.snrLen++;
+    }
+
+    // MAC commands, either piggy-backed or as payload on port 0
+    const uint8_t* fOptsPtr = &msg[hdrLen];
+    if(fOptsLen > 0) {
+      uint8_t fOpts[RADIOLIB_LORAWAN_FHDR_FOPTS_MAX_LEN];
+      if(dev.rev == 1) {
+        processAES(dev.nwkSEncKey, fOptsPtr, fOptsLen, fOpts, devAddr, fCnt, RADIOLIB_LORAWAN_UPLINK, 0x01);
+      } else {
+        memcpy(fOpts, fOptsPtr, fOptsLen);
+      }
+      this->processMacCommands(dev, fOpts, fOptsLen, best, gwCnt, tx.tEnd);
+    }
+
+    size_t payLen = len - hdrLen - fOptsLen - sizeof(uint32_t);
+    if(payLen > 1) {
+      uint8_t fPort = msg[hdrLen + fOptsLen];
+      const uint8_t* payPtr = &msg[hdrLen + fOptsLen + 1];
+      uint8_t payload[256];
+      payLen--;
+      if(fPort == RADIOLIB_LORAWAN_FPORT_MAC_COMMAND) {
+        processAES(dev.nwkSEncKey, payPtr, payLen, payload, devAddr, fCnt, RADIOLIB_LORAWAN_UPLINK, 0x00);
+        this->processMacCommands(dev, payload, payLen, best, gwCnt, tx.tEnd);
+      } else {
+        // application payload is decrypted as a real server would, then dropped
+        processAES(dev.appSKey, payPtr, payLen, payload, devAddr, fCnt, RADIOLIB_LORAWAN_UPLINK, 0x00);
+      }
+    }
+
+    if((fCtrl & RADIOLIB_LORAWAN_FCTRL_ADR_ENABLED) && this->adrEnabled) {
+      this->runAdr(dev);
+    }
+  }
+
+  // answer confirmed uplinks, ADR acknowledge requests and pending MAC commands
+  bool confirmed = (msg[0] & RADIOLIB_LORAWAN_MHDR_MTYPE_MASK) == RADIOLIB_LORAWAN_MHDR_MTYPE_CONF_DATA_UP;
+  if(confirmed || (fCtrl & RADIOLIB_LORAWAN_FCTRL_ADR_ACK_REQ) || (dev.macDownLen > 0)) {
+    this->sendDataDown(dev, tx, best, confirmed);
+  }
+}
+
+void NetworkServer::processMacCommands(NsDevice& dev, const uint8_t* cmds, size_t len, const SimReception& best, uint8_t gwCnt, uint64_t tEnd) {
+  size_t pos = 0;
+  while(pos < len) {
+    uint8_t cid = cmds[pos];
+    const LoRaWANMacCommand_t* cmd = NULL;
+    for(size_t i = 0; i < RADIOLIB_LORAWAN_NUM_MAC_COMMANDS; i++) {
+      if((MacTable[i].cid == cid) && (cid != 0)) {
+        cmd = &MacTable[i];
+        break;
+      }
+    }
+
+    // unknown or truncated command, the rest cannot be parsed
+    if(!cmd || (pos + 1 + cmd->lenUp > len)) {
+      this->stats.malformed++;
+      return;
+    }
+    const uint8_t* optIn = &cmds[pos + 1];
+    this->stats.macCommandsUp++;
+
+    switch(cid) {
+      case(RADIOLIB_LORAWAN_MAC_RESET):
+      case(RADIOLIB_LORAWAN_MAC_REKEY): {
+        // confirm with the revision of the server
+        uint8_t ver = dev.rev;
+        this->pushMac(dev, cid, &ver, 1);
+      } break;
+
+      case(RADIOLIB_LORAWAN_MAC_LINK_CHECK): {
+        uint8_t ans[2];
+        double margin = best.snr - getRequiredSnr(dev.dr < RADIOLIB_LORAWAN_CHANNEL_NUM_DATARATES ? this->band->dataRates[dev.dr].dr.lora.spreadingFactor : 12);
+        ans[0] = (uint8_t)RADIOLIB_MAX(0.0, RADIOLIB_MIN(254.0, margin));
+        ans[1] = gwCnt;
+        this->pushMac(dev, cid, ans, sizeof(ans));
+      } break;
+
+      case(RADIOLIB_LORAWAN_MAC_LINK_ADR):
+        // all of channel mask, datarate and power must be accepted
+        if((optIn[0] & 0x07) == 0x07) {
+          dev.txPower = dev.adrTxPower;
+          dev.snrLen = 0;
+          dev.snrPos = 0;
+          this->stats.adrAccepted++;
+        }
+        break;
+
+      case(RADIOLIB_LORAWAN_MAC_DEV_STATUS):
+        dev.battery = optIn[0];
+        dev.margin = (int8_t)(optIn[1] << 2) >> 2;
+        break;
+
+      case(RADIOLIB_LORAWAN_MAC_DEVICE_TIME): {
+        // seconds and 1/256 fractions at the end of the uplink, on the simulator clock
+        uint8_t ans[5];
+        putLE(ans, tEnd / 1000000, sizeof(uint32_t));
+        ans[4] = (uint8_t)(((tEnd % 1000000) * 256) / 1000000);
+        this->pushMac(dev, cid, ans, sizeof(ans));
+      } break;
+
+      case(RADIOLIB_LORAWAN_MAC_PING_SLOT_INFO):
+        // applies right away, the device switches once it gets the answer
+        dev.pingPeriodicity = optIn[0] & 0x07;
+        this->pushMac(dev, cid, optIn, 0);
+        break;
+
+      default:
+        // answers to commands the server does not send
+        break;
+    }
+
+    pos += 1 + cmd->lenUp;
+  }
+}
+
+void NetworkServer::runAdr(NsDevice& dev) {
+  if((dev.snrLen < NS_ADR_HISTORY_LEN) || (dev.dr >= RADIOLIB_LORAWAN_CHANNEL_NUM_DATARATES)) {
+    return;
+  }
+  const LoRaWANDataRate_t& rate = this->band->dataRates[dev.dr];
+  if(rate.modem != RADIOLIB_MODEM_LORA) {
+    return;
+  }
+
+  // the usual algorithm: use the best link margin of the recent uplinks, one step per 3 dB
+  float snrMax = dev.snrHistory[0];
+  for(uint8_t i = 1; i < dev.snrLen; i++) {
+    snrMax = RADIOLIB_MAX(snrMax, dev.snrHistory[i]);
+  }
+  double margin = snrMax - getRequiredSnr(rate.dr.lora.spreadingFactor) - NS_ADR_MARGIN_DB;
+  int steps = (int)floor(margin / 3.0);
+
+  uint8_t drMax = 0;
+  if(this->band->bandType == RADIOLIB_LORAWAN_BAND_DYNAMIC) {
+    drMax = this->band->txFreqs[0].drMax;
+  } else {
+    drMax = this->band->txSpans[0].drMax;
+  }
+
+  // speed up first, then lower the power, raise the power again if the margin is negative
+  uint8_t dr = dev.dr;
+  uint8_t txPower = dev.txPower;
+  while((steps > 0) && (dr < drMax) && (this->band->dataRates[dr + 1].modem == RADIOLIB_MODEM_LORA)) {
+    dr++;
+    steps--;
+  }
+  while((steps > 0) && (txPower < this->band->powerNumSteps)) {
+    txPower++;
+    steps--;
+  }
+  while((steps < 0) && (txPower > 0)) {
+    txPower--;
+    steps++;
+  }
+  if((dr == dev.dr) && (txPower == dev.txPower)) {
+    return;
+  }
+
+  // keep the channel plan the device started with
+  uint16_t chMask = 0;
+  uint8_t chMaskCntl = 0;
+  if(this->band->bandType == RADIOLIB_LORAWAN_BAND_DYNAMIC) {
+    for(uint8_t i = 0; i < 3; i++) {
+      if(this->band->txFreqs[i].freq) {
+        chMask |= (1 << this->band->txFreqs[i].idx);
+      }
+    }
+  } else if(this->subBand == 0) {
+    chMaskCntl = 6;
+    chMask = 0x00FF;
+  } else {
+    uint8_t first = (this->subBand - 1) * 8;
+    chMaskCntl = first / 16;
+    chMask = 0x00FF << (first % 16);
+  }
+
+  uint8_t req[4];
+  req[0] = (dr << 4) | txPower;
+  putLE(&req[1], chMask, sizeof(uint16_t));
+  req[3] = (chMaskCntl << 4) | 0x01;
+  if(this->pushMac(dev, RADIOLIB_LORAWAN_MAC_LINK_ADR, req, sizeof(req))) {
+    dev.adrDr = dr;
+    dev.adrTxPower = txPower;
+    this->stats.adrRequests++;
+  }
+}
+
+void NetworkServer::sendDataDown(NsDevice& dev, const SimTransmission& tx, const SimReception& best, bool ack) {
+  uint8_t buff[RADIOLIB_AES128_BLOCK_SIZE + 256] = { 0 };
+  uint8_t* frame = &buff[RADIOLIB_AES128_BLOCK_SIZE];
+
+  // there is never application payload, so this is a network frame in LoRaWAN 1.1
+  uint32_t fCnt = (dev.rev == 1) ? dev.nFCntDown : dev.aFCntDown;
+  uint8_t fCtrl = this->adrEnabled ? RADIOLIB_LORAWAN_FCTRL_ADR_ENABLED : RADIOLIB_LORAWAN_FCTRL_ADR_DISABLED;
+  if(ack) {
+    fCtrl |= RADIOLIB_LORAWAN_FCTRL_ACK;
+  }
+
+  frame[0] = RADIOLIB_LORAWAN_MHDR_MTYPE_UNCONF_DATA_DOWN | RADIOLIB_LORAWAN_MHDR_MAJOR_R1;
+  putLE(&frame[1], dev.devAddr, sizeof(uint32_t));
+  putLE(&frame[6], fCnt, sizeof(uint16_t));
+  size_t len = RADIOLIB_LORAWAN_FHDR_FOPTS_POS - RADIOLIB_LORAWAN_FHDR_LEN_START_OFFS;
+
+  // MAC commands that fit go to FOpts, otherwise they are sent as payload on port 0
+  if(dev.macDownLen <= RADIOLIB_LORAWAN_FHDR_FOPTS_MAX_LEN) {
+    fCtrl |= dev.macDownLen;
+    if(dev.rev == 1) {
+      processAES(dev.nwkSEncKey, dev.macDown, dev.macDownLen, &frame[len], dev.devAddr, fCnt, RADIOLIB_LORAWAN_DOWNLINK, 0x01);
+    } else {
+      memcpy(&frame[len], dev.macDown, dev.macDownLen);
+    }
+    len += dev.macDownLen;
+  } else {
+    frame[len++] = RADIOLIB_LORAWAN_FPORT_MAC_COMMAND;
+    processAES(dev.nwkSEncKey, dev.macDown, dev.macDownLen, &frame[len], dev.devAddr, fCnt, RADIOLIB_LORAWAN_DOWNLINK, 0x00);
+    len += dev.macDownLen;
+  }
+  frame[RADIOLIB_LORAWAN_FHDR_FCTRL_POS - RADIOLIB_LORAWAN_FHDR_LEN_START_OFFS] = fCtrl;
+  len = this->signDataDown(dev, buff, len, fCnt, ack);
+
+  if(dev.rev == 1) {
+    dev.nFCntDown++;
+  } else {
+    dev.aFCntDown++;
+  }
+  dev.macDownLen = 0;
+
+  this->sendRx1(tx, best, RADIOLIB_LORAWAN_RECEIVE_DELAY_1_MS, frame, len);
+}
+
+size_t NetworkServer::signDataDown(NsDevice& dev, uint8_t* buff, size_t len, uint32_t fCnt, bool ack) {
+  // the frame follows the first block in the buffer, in LoRaWAN 1.1 an acknowledgement is bound to the uplink counter
+  uint8_t* frame = &buff[RADIOLIB_AES128_BLOCK_SIZE];
+  memset(buff, 0, RADIOLIB_AES128_BLOCK_SIZE);
+  buff[RADIOLIB_LORAWAN_BLOCK_MAGIC_POS] = RADIOLIB_LORAWAN_MIC_BLOCK_MAGIC;
+  if(ack && (dev.rev == 1)) {
+    putLE(&buff[RADIOLIB_LORAWAN_BLOCK_CONF_FCNT_POS], dev.fCntUp, sizeof(uint16_t));
+  }
+  buff[RADIOLIB_LORAWAN_BLOCK_DIR_POS] = RADIOLIB_LORAWAN_DOWNLINK;
+  putLE(&buff[RADIOLIB_LORAWAN_BLOCK_DEV_ADDR_POS], dev.devAddr, sizeof(uint32_t));
+  putLE(&buff[RADIOLIB_LORAWAN_BLOCK_FCNT_POS], fCnt, sizeof(uint32_t));
+  buff[RADIOLIB_LORAWAN_MIC_BLOCK_LEN_POS] = len;
+  uint32_t mic = calculateMIC(dev.sNwkSIntKey, buff, RADIOLIB_AES128_BLOCK_SIZE + len);
+  putLE(&frame[len], mic, sizeof(uint32_t));
+  return(len + sizeof(uint32_t));
+}
+
+void NetworkServer::onBeacon(uint32_t gpsTime, uint64_t tPeriod) {
+  if(this->classBDownlinkPeriod == 0) {
+    return;
+  }
+
+  const uint64_t periodUs = RADIOLIB_LORAWAN_BEACON_PERIOD_MS * 1000;
+  std::uniform_real_distribution<double> jitter(0.5, 1.5);
+  for(NsDevice& dev : this->devices) {
+    if(!dev.active || !dev.classB) {
+      dev.tNextPing = 0;
+      continue;
+    }
+
+    // the application hands over downlinks at random times during the period
+    if(dev.tNextPing == 0) {
+      dev.tNextPing = tPeriod + (uint64_t)(jitter(this->rng) * (double)this->classBDownlinkPeriod * 1000000.0 / 2.0);
+    }
+    while(dev.tNextPing < tPeriod + periodUs) {
+      dev.pingQueue.push_back(dev.tNextPing);
+      dev.tNextPing += (uint64_t)(jitter(this->rng) * (double)this->classBDownlinkPeriod * 1000000.0);
+      this->stats.pingQueued++;
+    }
+
+    // each one goes out in the first ping slot after it was queued, the rest waits for the next period
+    uint16_t pingPeriod = (uint16_t)1 << (5 + dev.pingPeriodicity);
+    uint16_t pingNb = (uint16_t)1 << (7 - dev.pingPeriodicity);
+    uint16_t offset = LoRaWANNode::calculatePingOffset(gpsTime, dev.devAddr, pingPeriod);
+    for(uint16_t n = 0; (n < pingNb) && !dev.pingQueue.empty(); n++) {
+      uint64_t tSlot = tPeriod + (RADIOLIB_LORAWAN_BEACON_RESERVED_MS + (uint64_t)(offset + n*pingPeriod) * RADIOLIB_LORAWAN_PING_SLOT_LEN_MS) * 1000;
+      uint64_t tQueued = dev.pingQueue.front();
+      if(tSlot < tQueued) {
+        continue;
+      }
+      dev.pingQueue.pop_front();
+      this->sendPingSlot(dev, tSlot, gpsTime);
+      this->stats.pingLatency += tSlot - tQueued;
+      this->stats.pingLatencyMax = RADIOLIB_MAX(this->stats.pingLatencyMax, tSlot - tQueued);
+    }
+  }
+}
+
+void NetworkServer::sendPingSlot(NsDevice& dev, uint64_t tSlot, uint32_t gpsTime) {
+  uint8_t buff[RADIOLIB_AES128_BLOCK_SIZE + 256] = { 0 };
+  uint8_t* frame = &buff[RADIOLIB_AES128_BLOCK_SIZE];
+
+  // Class B downlinks carry no MAC commands, so this is always an application frame
+  uint32_t fCnt = dev.aFCntDown++;
+  frame[0] = RADIOLIB_LORAWAN_MHDR_MTYPE_UNCONF_DATA_DOWN | RADIOLIB_LORAWAN_MHDR_MAJOR_R1;
+  putLE(&frame[1], dev.devAddr, sizeof(uint32_t));
+  frame[RADIOLIB_LORAWAN_FHDR_FCTRL_POS - RADIOLIB_LORAWAN_FHDR_LEN_START_OFFS] = this->adrEnabled ? RADIOLIB_LORAWAN_FCTRL_ADR_ENABLED : RADIOLIB_LORAWAN_FCTRL_ADR_DISABLED;
+  putLE(&frame[6], fCnt, sizeof(uint16_t));
+  size_t len = RADIOLIB_LORAWAN_FHDR_FOPTS_POS - RADIOLIB_LORAWAN_FHDR_LEN_START_OFFS;
+  frame[len++] = NS_PING_FPORT;
+  uint8_t payload[NS_PING_PAYLOAD_LEN];
+  for(size_t i = 0; i < NS_PING_PAYLOAD_LEN; i++) {
+    payload[i] = (uint8_t)(fCnt + i);
+  }
+  processAES(dev.appSKey, payload, NS_PING_PAYLOAD_LEN, &frame[len], dev.devAddr, fCnt, RADIOLIB_LORAWAN_DOWNLINK, 0x00);
+  len += NS_PING_PAYLOAD_LEN;
+  len = this->signDataDown(dev, buff, len, fCnt, false);
+
+  // the ping slot channel hops with the beacon, offset by the device address
+  const LoRaWANBeacon_t& bcn = this->band->beacon;
+  uint32_t ch = (gpsTime / (RADIOLIB_LORAWAN_BEACON_PERIOD_MS / 1000) + dev.devAddr) % bcn.numChannels;
+  uint32_t freq = (bcn.freqStart + ch*bcn.freqStep) * 100;
+  const LoRaWANDataRate_t& rate = this->band->dataRates[bcn.dr];
+  this->sim->scheduleDownlink(dev.gateway, tSlot, freq, rate.modem, rate.dr, this->downlinkPower, frame, len);
+  this->stats.pingSent++;
+}
+
+void NetworkServer::sendRx1(const SimTransmission& tx, const SimReception& best, RadioLibTime_t delayMs, const uint8_t* data, size_t len) {
+  uint8_t drUp = this->getDatarate(tx.modem, tx.dr);
+  if(drUp >= RADIOLIB_LORAWAN_CHANNEL_NUM_DATARATES) {
+    return;
+  }
+  uint8_t drDown = this->band->rx1DrTable[drUp][this->rx1DrOffset];
+  if(drDown >= RADIOLIB_LORAWAN_CHANNEL_NUM_DATARATES) {
+    return;
+  }
+
+  // dynamic bands answer on the uplink channel, fixed bands on the matching downlink channel
+  uint32_t freq = tx.freq;
+  if(this->band->bandType == RADIOLIB_LORAWAN_BAND_FIXED) {
+    int16_t chIdx = this->getChannelIndex(tx.freq);
+    if(chIdx < 0) {
+      return;
+    }
+    const LoRaWANChannelSpan_t& span = this->band->rx1Span;
+    freq = (span.freqStart + (chIdx % span.numChannels) * span.freqStep) * 100;
+  }
+
+  const LoRaWANDataRate_t& rate = this->band->dataRates[drDown];
+  this->sim->scheduleDownlink(best.gateway, tx.tEnd + delayMs*1000, freq, rate.modem, rate.dr, this->downlinkPower, data, len);
+  this->stats.downlinks++;
+}
+
+bool NetworkServer::pushMac(NsDevice& dev, uint8_t cid, const uint8_t* payload, uint8_t len) {
+  if(dev.macDownLen + 1 + len > RADIOLIB_LORAWAN_MAX_PAYLOAD_SIZE) {
+    return(false);
+  }
+  dev.macDown[dev.macDownLen++] = cid;
+  memcpy(&dev.macDown[dev.macDownLen], payload, len);
+  dev.macDownLen += len;
+  this->stats.macCommandsDown++;
+  return(true);
+}
+
+uint8_t NetworkServer::getDatarate(ModemType_t modem, const DataRate_t& dr) const {
+  // uplink datarates come first, so the first match is the right one
+  for(uint8_t i = 0; i < RADIOLIB_LORAWAN_CHANNEL_NUM_DATARATES; i++) {
+    const LoRaWANDataRate_t& rate = this->band->dataRates[i];
+    if(rate.modem != modem) {
+      continue;
+    }
+    if((modem != RADIOLIB_MODEM_LORA) ||
+       ((rate.dr.lora.spreadingFactor == dr.lora.spreadingFactor) && (rate.dr.lora.bandwidth == dr.lora.bandwidth))) {
+      return(i);
+    }
+  }
+  return(RADIOLIB_LORAWAN_DATA_RATE_UNUSED);
+}
+
+int16_t NetworkServer::getChannelIndex(uint32_t freq) const {
+  if(this->band->bandType == RADIOLIB_LORAWAN_BAND_DYNAMIC) {
+    for(uint8_t i = 0; i < 3; i++) {
+      if(this->band->txFreqs[i].freq && (this->band->txFreqs[i].freq * 100 == freq)) {
+        return(this->band->txFreqs[i].idx);
+      }
+    }
+    return(-1);
+  }
+
+  int16_t base = 0;
+  for(uint8_t i = 0; i < this->band->numTxSpans; i++) {
+    const LoRaWANChannelSpan_t& span = this->band->txSpans[i];
+    uint32_t start = span.freqStart * 100;
+    uint32_t step = span.freqStep * 100;
+    if((freq >= start) && (step > 0) && ((freq - start) % step == 0) && ((freq - start) / step < span.numChannels)) {
+      return(base + (freq - start) / step);
+    }
+    base += span.numChannels;
+  }
+  return(-1);
+}
+
+uint32_t NetworkServer::calculateMIC(uint8_t* key, const uint8_t* msg, size_t len) {
+  uint8_t cmac[RADIOLIB_AES128_BLOCK_SIZE];
+  RadioLibAES128Instance.init(key);
+  RadioLibAES128Instance.generateCMAC(msg, len, cmac);
+  return(getLE(cmac, sizeof(uint32_t)));
+}
+
+void NetworkServer::processAES(uint8_t* key, const uint8_t* in, size_t len, uint8_t* out, uint32_t devAddr, uint32_t fCnt, uint8_t dir, uint8_t ctrId) {
+  uint8_t block[RADIOLIB_AES128_BLOCK_SIZE] = { 0 };
+  uint8_t stream[RADIOLIB_AES128_BLOCK_SIZE];
+  block[RADIOLIB_LORAWAN_BLOCK_MAGIC_POS] = RADIOLIB_LORAWAN_ENC_BLOCK_MAGIC;
+  block[RADIOLIB_LORAWAN_ENC_BLOCK_COUNTER_ID_POS] = ctrId;
+  block[RADIOLIB_LORAWAN_BLOCK_DIR_POS] = dir;
+  putLE(&block[RADIOLIB_LORAWAN_BLOCK_DEV_ADDR_POS], devAddr, sizeof(uint32_t));
+  putLE(&block[RADIOLIB_LORAWAN_BLOCK_FCNT_POS], fCnt, sizeof(uint32_t));
+
+  RadioLibAES128Instance.init(key);
+  for(size_t i = 0; i < len; i += RADIOLIB_AES128_BLOCK_SIZE) {
+    block[RADIOLIB_LORAWAN_ENC_BLOCK_COUNTER_POS] = i / RADIOLIB_AES128_BLOCK_SIZE + 1;
+    RadioLibAES128Instance.encryptECB(block, RADIOLIB_AES128_BLOCK_SIZE, stream);
+    for(size_t j = 0; (j < RADIOLIB_AES128_BLOCK_SIZE) && (i + j < len); j++) {
+      out[i + j] = in[i + j] ^ stream[j];
+    }
+  }
+}
+
+void NetworkServer::deriveKey(uint8_t* rootKey, uint8_t type, const uint8_t* ctx, uint8_t* out) {
+  uint8_t block[RADIOLIB_AES128_BLOCK_SIZE];
+  memcpy(block, ctx, RADIOLIB_AES128_BLOCK_SIZE);
+  block[0] = type;
+  RadioLibAES128Instance.init(rootKey);
+  RadioLibAES128Instance.encryptECB(block, RADIOLIB_AES128_BLOCK_SIZE, out);
+}
+
+double NetworkServer::getRequiredSnr(uint8_t sf) {
+  // demodulation floor, 2.5 dB per spreading factor
+  return(-2.5 * ((double)sf - 4.0));
+}
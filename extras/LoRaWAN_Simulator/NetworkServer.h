@@ -0,0 +1,159 @@
+#ifndef NETWORK_SERVER_H
+#define NETWORK_SERVER_H
+
+#include "Simulator.h"
+
+#include <stdint.h>
+#include <deque>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+// number of uplinks the ADR algorithm looks at
+#define NS_ADR_HISTORY_LEN            (20)
+
+// installation margin of the ADR algorithm in dB
+#define NS_ADR_MARGIN_DB              (10.0)
+
+// application downlinks to Class B devices
+#define NS_PING_FPORT                 (1)
+#define NS_PING_PAYLOAD_LEN           (8)
+
+// device as known by the network server
+struct NsDevice {
+  // activation, OTAA devices have EUIs and root keys
+  bool otaa = false;
+  uint64_t joinEUI = 0;
+  uint64_t devEUI = 0;
+  uint8_t nwkKey[RADIOLIB_AES128_KEY_SIZE] = { 0 };
+  uint8_t appKey[RADIOLIB_AES128_KEY_SIZE] = { 0 };
+  uint32_t lastDevNonce = RADIOLIB_LORAWAN_FCNT_NONE;
+  uint32_t joinNonce = 0;
+
+  // LoRaWAN revision 1.0 or 1.1
+  uint8_t rev = 0;
+
+  // session
+  bool active = false;
+  uint32_t devAddr = 0;
+  uint8_t appSKey[RADIOLIB_AES128_KEY_SIZE] = { 0 };
+  uint8_t fNwkSIntKey[RADIOLIB_AES128_KEY_SIZE] = { 0 };
+  uint8_t sNwkSIntKey[RADIOLIB_AES128_KEY_SIZE] = { 0 };
+  uint8_t nwkSEncKey[RADIOLIB_AES128_KEY_SIZE] = { 0 };
+  uint32_t fCntUp = RADIOLIB_LORAWAN_FCNT_NONE;
+  uint32_t nFCntDown = 0;
+  uint32_t aFCntDown = 0;
+
+  // MAC commands to send with the next downlink
+  uint8_t macDown[RADIOLIB_LORAWAN_MAX_PAYLOAD_SIZE];
+  uint8_t macDownLen = 0;
+
+  // ADR state
+  float snrHistory[NS_ADR_HISTORY_LEN];
+  uint8_t snrLen = 0;
+  uint8_t snrPos = 0;
+  uint8_t dr = RADIOLIB_LORAWAN_DATA_RATE_UNUSED;
+  uint8_t txPower = 0;
+  uint8_t adrDr = RADIOLIB_LORAWAN_DATA_RATE_UNUSED;
+  uint8_t adrTxPower = 0;
+
+  // last reported device status
+  uint8_t battery = 0;
+  int8_t margin = 0;
+
+  // Class B, as indicated by the last uplink, sent through the gateway that heard that uplink best
+  bool classB = false;
+  uint8_t pingPeriodicity = RADIOLIB_LORAWAN_PING_PERIODICITY_MAX;
+  uint32_t gateway = 0;
+
+  // application downlinks waiting for a ping slot, by the time they were queued
+  std::deque<uint64_t> pingQueue;
+  uint64_t tNextPing = 0;
+};
+
+// counters of the network server
+struct NsStats {
+  uint32_t joinRequests = 0;
+  uint32_t joinAccepts = 0;
+  uint32_t uplinks = 0;
+  uint32_t duplicates = 0;
+  uint32_t micFailures = 0;
+  uint32_t unknownDevices = 0;
+  uint32_t malformed = 0;
+  uint32_t downlinks = 0;
+  uint32_t macCommandsUp = 0;
+  uint32_t macCommandsDown = 0;
+  uint32_t adrRequests = 0;
+  uint32_t adrAccepted = 0;
+
+  // Class B application downlinks, latency is from queueing to the start of the ping slot
+  uint32_t pingQueued = 0;
+  uint32_t pingSent = 0;
+  uint64_t pingLatency = 0;
+  uint64_t pingLatencyMax = 0;
+
+  // wall-clock time spent processing uplinks, in nanoseconds
+  uint64_t processingNs = 0;
+};
+
+// minimal LoRaWAN network and join server, running in-process on the simulated channel
+// handles OTAA join, frame counters, MIC checks, MAC commands and ADR for Class A devices,
+// and sends application downlinks in the ping slots of Class B devices
+class NetworkServer : public SimBackend {
+  public:
+    NetworkServer(Simulator* sim, const LoRaWANBand_t* band, uint8_t subBand);
+
+    // register an OTAA device, nwkKey may be NULL for LoRaWAN 1.0 devices
+    void addOTAA(uint64_t joinEUI, uint64_t devEUI, const uint8_t* nwkKey, const uint8_t* appKey);
+
+    // register an ABP device, the integrity keys may be NULL for LoRaWAN 1.0 devices
+    void addABP(uint32_t devAddr, const uint8_t* fNwkSIntKey, const uint8_t* sNwkSIntKey, const uint8_t* nwkSEncKey, const uint8_t* appSKey);
+
+    // simulator callback
+    void onUplink(const SimTransmission& tx, const std::vector<SimReception>& copies) override;
+    void onBeacon(uint32_t gpsTime, uint64_t tPeriod) override;
+
+    // find device by address, returns NULL if there is none
+    const NsDevice* getDevice(uint32_t devAddr) const;
+
+    // network settings
+    uint32_t netId = 0x000013;
+    bool adrEnabled = true;
+    int8_t downlinkPower = 14;
+    uint8_t rx1DrOffset = RADIOLIB_LORAWAN_RX1_DR_OFFSET;
+
+    // average period of application downlinks to each Class B device in seconds, 0 to send none
+    uint32_t classBDownlinkPeriod = 0;
+
+    NsStats stats;
+
+  private:
+    Simulator* sim;
+    const LoRaWANBand_t* band;
+    uint8_t subBand;
+    uint32_t nextDevAddr = 1;
+    std::mt19937 rng;
+
+    std::vector<NsDevice> devices;
+    std::unordered_map<uint64_t, uint32_t> byDevEUI;
+    std::unordered_map<uint32_t, uint32_t> byDevAddr;
+
+    void processJoinRequest(const SimTransmission& tx, const SimReception& best);
+    void processDataUp(const SimTransmission& tx, const SimReception& best, uint8_t gwCnt);
+    void processMacCommands(NsDevice& dev, const uint8_t* cmds, size_t len, const SimReception& best, uint8_t gwCnt, uint64_t tEnd);
+    void runAdr(NsDevice& dev);
+    void sendDataDown(NsDevice& dev, const SimTransmission& tx, const SimReception& best, bool ack);
+    void sendRx1(const SimTransmission& tx, const SimReception& best, RadioLibTime_t delayMs, const uint8_t* data, size_t len);
+    void sendPingSlot(NsDevice& dev, uint64_t tSlot, uint32_t gpsTime);
+    size_t signDataDown(NsDevice& dev, uint8_t* buff, size_t len, uint32_t fCnt, bool ack);
+    bool pushMac(NsDevice& dev, uint8_t cid, const uint8_t* payload, uint8_t len);
+    uint8_t getDatarate(ModemType_t modem, const DataRate_t& dr) const;
+    int16_t getChannelIndex(uint32_t freq) const;
+
+    static uint32_t calculateMIC(uint8_t* key, const uint8_t* msg, size_t len);
+    static void processAES(uint8_t* key, const uint8_t* in, size_t len, uint8_t* out, uint32_t devAddr, uint32_t fCnt, uint8_t dir, uint8_t ctrId);
+    static void deriveKey(uint8_t* rootKey, uint8_t type, const uint8_t* ctx, uint8_t* out);
+    static double getRequiredSnr(uint8_t sf);
+};
+
+#endif
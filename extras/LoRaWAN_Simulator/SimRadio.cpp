@@ -0,0 +1,447 @@
+#include "SimRadio.h"
+#include "Simulator.h"
+
+#include <string.h>
+
+uint32_t SimHal::digitalRead(uint32_t pin) {
+  if((pin != SIM_HAL_IRQ_PIN) || !this->radio) {
+    return(SIM_HAL_LOW);
+  }
+  return(this->radio->getIrqPin() ? SIM_HAL_HIGH : SIM_HAL_LOW);
+}
+
+void SimHal::delay(RadioLibTime_t ms) {
+  this->sim->advance(this->sim->now() + (uint64_t)ms*1000);
+}
+
+void SimHal::delayMicroseconds(RadioLibTime_t us) {
+  this->sim->advance(this->sim->now() + us);
+}
+
+RadioLibTime_t SimHal::millis() {
+  return(this->sim->now() / 1000);
+}
+
+RadioLibTime_t SimHal::micros() {
+  return(this->sim->now());
+}
+
+void SimHal::yield() {
+  // only called from busy-wait loops, so let the time pass
+  this->sim->advance(this->sim->now() + 1000);
+}
+
+SimRadio::SimRadio(Simulator* sim, SimHal* hal, uint32_t node, uint32_t seed)
+  : node(node), sim(sim), mod(hal, RADIOLIB_NC, SIM_HAL_IRQ_PIN, RADIOLIB_NC), rng(seed) {
+  this->dataRate.lora.spreadingFactor = 7;
+  this->dataRate.lora.bandwidth = 125.0;
+  this->dataRate.lora.codingRate = 5;
+
+  // all interrupts are supported, and use the common bit positions
+  for(uint8_t i = 0; i < sizeof(this->irqMap)/sizeof(this->irqMap[0]); i++) {
+    this->irqMap[i] = (1UL << i);
+  }
+
+  this->stateSince = sim->now();
+}
+
+int16_t SimRadio::sleep() {
+  this->update();
+  this->sim->stopListening(this);
+  this->locked = false;
+  this->setState(SIM_RADIO_SLEEP);
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t SimRadio::standby() {
+  return(this->standby(0));
+}
+
+int16_t SimRadio::standby(uint8_t mode) {
+  (void)mode;
+  this->update();
+  this->sim->stopListening(this);
+  this->locked = false;
+  this->setState(SIM_RADIO_STANDBY);
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t SimRadio::finishTransmit() {
+  this->irqFlags = 0;
+  return(this->standby());
+}
+
+int16_t SimRadio::finishReceive() {
+  this->irqFlags = 0;
+  return(this->standby());
+}
+
+int16_t SimRadio::readData(uint8_t* data, size_t len) {
+  if(!data) {
+    return(RADIOLIB_ERR_NULL_POINTER);
+  }
+  if((len == 0) || (len > this->rxData.size())) {
+    len = this->rxData.size();
+  }
+  memcpy(data, this->rxData.data(), len);
+  this->irqFlags = 0;
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t SimRadio::setFrequency(float freq) {
+  // round to 100 Hz, the same resolution LoRaWAN uses
+  this->freq = (uint32_t)((double)freq * 10000.0 + 0.5) * 100;
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t SimRadio::setDataShaping(uint8_t sh) {
+  (void)sh;
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t SimRadio::setEncoding(uint8_t encoding) {
+  (void)encoding;
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t SimRadio::invertIQ(bool enable) {
+  this->iqInverted = enable;
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t SimRadio::setPacketCRC(bool enable) {
+  this->crc = enable;
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t SimRadio::setOutputPower(int8_t power) {
+  RADIOLIB_ASSERT(this->checkOutputPower(power, NULL));
+  this->power = power;
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t SimRadio::checkOutputPower(int8_t power, int8_t* clipped) {
+  const SimRadioPower& pwr = this->powerModel;
+  int8_t minPower = pwr.txPower[0];
+  int8_t maxPower = pwr.txPower[SimRadioPower::numTxPoints - 1];
+  if(clipped) {
+    *clipped = RADIOLIB_MAX(minPower, RADIOLIB_MIN(maxPower, power));
+  }
+  if((power < minPower) || (power > maxPower)) {
+    return(RADIOLIB_ERR_INVALID_OUTPUT_POWER);
+  }
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t SimRadio::setSyncWord(uint8_t* sync, size_t len) {
+  (void)sync;
+  (void)len;
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t SimRadio::setPreambleLength(size_t len) {
+  this->preambleLength = len;
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t SimRadio::implicitHeader(size_t len) {
+  (void)len;
+  this->implicit = true;
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t SimRadio::explicitHeader() {
+  this->implicit = false;
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t SimRadio::setDataRate(DataRate_t dr, ModemType_t modem) {
+  if(modem == RADIOLIB_MODEM_NONE) {
+    modem = this->modem;
+  }
+  RADIOLIB_ASSERT(this->checkDataRate(dr, modem));
+  this->modem = modem;
+  this->dataRate = dr;
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t SimRadio::checkDataRate(DataRate_t dr, ModemType_t modem) {
+  if(modem == RADIOLIB_MODEM_NONE) {
+    modem = this->modem;
+  }
+  switch(modem) {
+    case(RADIOLIB_MODEM_LORA):
+      if((dr.lora.spreadingFactor < 5) || (dr.lora.spreadingFactor > 12)) {
+        return(RADIOLIB_ERR_INVALID_SPREADING_FACTOR);
+      }
+      if((dr.lora.codingRate < 5) || (dr.lora.codingRate > 8)) {
+        return(RADIOLIB_ERR_INVALID_CODING_RATE);
+      }
+      return(RADIOLIB_ERR_NONE);
+
+    case(RADIOLIB_MODEM_FSK):
+      return(RADIOLIB_ERR_NONE);
+
+    default:
+      // LR-FHSS is not simulated
+      return(RADIOLIB_ERR_UNSUPPORTED);
+  }
+}
+
+size_t SimRadio::getPacketLength(bool update) {
+  (void)update;
+  return(this->rxData.size());
+}
+
+float SimRadio::getRSSI() {
+  return(this->rxRssi);
+}
+
+float SimRadio::getSNR() {
+  return(this->rxSnr);
+}
+
+RadioLibTime_t SimRadio::calculateTimeOnAir(ModemType_t modem, DataRate_t dr, PacketConfig_t pc, size_t len) {
+  switch(modem) {
+    case(RADIOLIB_MODEM_LORA):
+      return(rlb_toaLoRa(dr.lora.spreadingFactor, dr.lora.bandwidth, dr.lora.codingRate, pc.lora.preambleLength,
+                         pc.lora.crcEnabled, pc.lora.implicitHeader, pc.lora.ldrOptimize, len));
+    case(RADIOLIB_MODEM_FSK):
+      return(rlb_toaFSK(dr.fsk.bitRate, pc.fsk.preambleLength, pc.fsk.syncWordLength, pc.fsk.crcLength, len));
+    case(RADIOLIB_MODEM_LRFHSS):
+      return(rlb_toaLrFhss(dr.lrFhss.cr, pc.lrFhss.hdrCount, len));
+    default:
+      return(0);
+  }
+}
+
+RadioLibTime_t SimRadio::calculateRxTimeout(RadioLibTime_t timeoutUs) {
+  // the raw timeout is simply in microseconds
+  return(timeoutUs);
+}
+
+uint32_t SimRadio::getIrqFlags() {
+  this->update();
+  return(this->irqFlags);
+}
+
+int16_t SimRadio::setIrqFlags(uint32_t irq) {
+  this->irqMask = irq;
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t SimRadio::clearIrqFlags(uint32_t irq) {
+  this->irqFlags &= ~irq;
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t SimRadio::scanChannel() {
+  return(this->sim->isChannelBusy(this) ? RADIOLIB_LORA_DETECTED : RADIOLIB_CHANNEL_FREE);
+}
+
+uint8_t SimRadio::randomByte() {
+  return(this->rng() & 0xFF);
+}
+
+void SimRadio::setPacketReceivedAction(void (*func)(void)) {
+  this->rxAction = func;
+}
+
+void SimRadio::clearPacketReceivedAction() {
+  this->rxAction = nullptr;
+}
+
+int16_t SimRadio::stageMode(RadioModeType_t mode, RadioModeConfig_t* cfg) {
+  switch(mode) {
+    case(RADIOLIB_RADIO_MODE_TX):
+      if(!cfg->transmit.data && cfg->transmit.len) {
+        return(RADIOLIB_ERR_NULL_POINTER);
+      }
+      this->txData.assign(cfg->transmit.data, cfg->transmit.data + cfg->transmit.len);
+      break;
+
+    case(RADIOLIB_RADIO_MODE_RX):
+      this->rxTimeout = cfg->receive.timeout;
+      this->rxIrqMask = this->getIrqMapped(cfg->receive.irqMask);
+      break;
+
+    case(RADIOLIB_RADIO_MODE_STANDBY):
+    case(RADIOLIB_RADIO_MODE_SLEEP):
+      break;
+
+    default:
+      return(RADIOLIB_ERR_UNSUPPORTED);
+  }
+
+  this->staged = mode;
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t SimRadio::launchMode() {
+  this->update();
+  int16_t state = RADIOLIB_ERR_NONE;
+  switch(this->staged) {
+    case(RADIOLIB_RADIO_MODE_TX): {
+      RadioLibTime_t toa = this->calculateTimeOnAir(this->modem, this->dataRate, this->getPacketConfig(), this->txData.size());
+      this->sim->stopListening(this);
+      this->irqFlags = 0;
+      this->irqMask = this->getIrqMapped(1UL << RADIOLIB_IRQ_TX_DONE);
+      this->setState(SIM_RADIO_TX);
+      this->tEnd = this->sim->startTransmission(this, this->txData.data(), this->txData.size(), toa);
+      this->txAirtime += toa;
+    } break;
+
+    case(RADIOLIB_RADIO_MODE_RX):
+      this->irqFlags = 0;
+      this->irqMask = this->rxIrqMask;
+      this->locked = false;
+      this->setState(SIM_RADIO_RX);
+      if((this->rxTimeout == 0) || (this->rxTimeout == 0xFFFFFFFF)) {
+        this->tEnd = UINT64_MAX;
+      } else {
+        this->tEnd = this->sim->now() + this->rxTimeout;
+      }
+      this->sim->startListening(this);
+      break;
+
+    case(RADIOLIB_RADIO_MODE_STANDBY):
+      state = this->standby();
+      break;
+
+    case(RADIOLIB_RADIO_MODE_SLEEP):
+      state = this->sleep();
+      break;
+
+    default:
+      state = RADIOLIB_ERR_UNSUPPORTED;
+      break;
+  }
+
+  this->staged = RADIOLIB_RADIO_MODE_NONE;
+  return(state);
+}
+
+bool SimRadio::getIrqPin() {
+  this->update();
+  return((this->irqFlags & this->irqMask) != 0);
+}
+
+void SimRadio::receive(const uint8_t* data, size_t len, float rssi, float snr) {
+  this->update();
+  this->rxData.assign(data, data + len);
+  this->rxRssi = rssi;
+  this->rxSnr = snr;
+  this->irqFlags |= this->getIrqMapped((1UL << RADIOLIB_IRQ_RX_DONE) | (1UL << RADIOLIB_IRQ_HEADER_VALID));
+  this->locked = false;
+  this->sim->stopListening(this);
+  this->setState(SIM_RADIO_STANDBY);
+  if(this->rxAction) {
+    this->rxAction();
+  }
+}
+
+void SimRadio::receiveFailed() {
+  this->update();
+  this->irqFlags |= this->getIrqMapped(1UL << RADIOLIB_IRQ_CRC_ERR);
+  this->locked = false;
+  this->sim->stopListening(this);
+  this->setState(SIM_RADIO_STANDBY);
+}
+
+bool SimRadio::lock(uint64_t tEnd) {
+  this->update();
+  if((this->state != SIM_RADIO_RX) || this->locked) {
+    return(false);
+  }
+
+  // once the preamble is detected, the timeout no longer applies
+  this->locked = true;
+  this->tEnd = tEnd;
+  this->irqFlags |= this->getIrqMapped(1UL << RADIOLIB_IRQ_PREAMBLE_DETECTED);
+  return(true);
+}
+
+void SimRadio::update() {
+  uint64_t tNow = this->sim->now();
+
+  // operations that finished since the last update, these change state at their end time
+  if((this->state == SIM_RADIO_TX) && (tNow >= this->tEnd)) {
+    this->irqFlags |= this->getIrqMapped(1UL << RADIOLIB_IRQ_TX_DONE);
+    this->setState(SIM_RADIO_STANDBY, this->tEnd);
+  } else if((this->state == SIM_RADIO_RX) && !this->locked && (tNow >= this->tEnd)) {
+    this->irqFlags |= this->getIrqMapped(1UL << RADIOLIB_IRQ_TIMEOUT);
+    this->sim->stopListening(this);
+    this->setState(SIM_RADIO_STANDBY, this->tEnd);
+  }
+
+  this->setState(this->state, tNow);
+}
+
+void SimRadio::setState(SimRadioState_t newState) {
+  this->setState(newState, this->sim->now());
+}
+
+void SimRadio::setState(SimRadioState_t newState, uint64_t t) {
+  if(t > this->stateSince) {
+    uint64_t duration = t - this->stateSince;
+    double current = 0;
+    switch(this->state) {
+      case(SIM_RADIO_SLEEP):
+        current = this->powerModel.sleep_mA;
+        break;
+      case(SIM_RADIO_STANDBY):
+        current = this->powerModel.standby_mA;
+        break;
+      case(SIM_RADIO_RX):
+        current = this->powerModel.rx_mA;
+        break;
+      case(SIM_RADIO_TX):
+        current = this->getTxCurrent();
+        break;
+      default:
+        break;
+    }
+
+    // mA * V * us = nJ
+    this->energy_mJ += current * this->powerModel.voltage * (double)duration / 1e6;
+    this->timeInState[this->state] += duration;
+    this->stateSince = t;
+  }
+  this->state = newState;
+}
+
+double SimRadio::getTxCurrent() {
+  const SimRadioPower& pwr = this->powerModel;
+  if(this->power <= pwr.txPower[0]) {
+    return(pwr.tx_mA[0]);
+  }
+  for(int i = 1; i < SimRadioPower::numTxPoints; i++) {
+    if(this->power <= pwr.txPower[i]) {
+      double frac = (double)(this->power - pwr.txPower[i - 1]) / (double)(pwr.txPower[i] - pwr.txPower[i - 1]);
+      return(pwr.tx_mA[i - 1] + frac * (pwr.tx_mA[i] - pwr.tx_mA[i - 1]));
+    }
+  }
+  return(pwr.tx_mA[SimRadioPower::numTxPoints - 1]);
+}
+
+PacketConfig_t SimRadio::getPacketConfig() {
+  PacketConfig_t pc;
+  switch(this->modem) {
+    case(RADIOLIB_MODEM_LORA):
+      pc.lora.preambleLength = this->preambleLength;
+      pc.lora.implicitHeader = this->implicit;
+      // LoRaWAN uplinks have payload CRC, downlinks do not, and implicit header packets (beacons) use the configured one
+      pc.lora.crcEnabled = this->implicit ? this->crc : !this->iqInverted;
+      pc.lora.ldrOptimize = rlb_toaLoRaSymbolUs(this->dataRate.lora.spreadingFactor, this->dataRate.lora.bandwidth) >= 16000;
+      break;
+    case(RADIOLIB_MODEM_FSK):
+      pc.fsk.preambleLength = this->preambleLength;
+      pc.fsk.syncWordLength = 24;
+      pc.fsk.crcLength = 2;
+      break;
+    default:
+      pc.lrFhss.hdrCount = 3;
+      break;
+  }
+  return(pc);
+}
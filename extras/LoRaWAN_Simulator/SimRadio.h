@@ -0,0 +1,188 @@
+#ifndef SIM_RADIO_H
+#define SIM_RADIO_H
+
+// include RadioLib
+#include <RadioLib.h>
+
+#include <stdint.h>
+#include <random>
+#include <vector>
+
+#define SIM_HAL_INPUT     (0)
+#define SIM_HAL_OUTPUT    (1)
+#define SIM_HAL_LOW       (0)
+#define SIM_HAL_HIGH      (1)
+#define SIM_HAL_RISING    (0)
+#define SIM_HAL_FALLING   (1)
+
+// the only pin that means anything - the emulated radio interrupt line
+#define SIM_HAL_IRQ_PIN   (1)
+
+// emulated radio states, also used for energy accounting
+enum SimRadioState_t {
+  SIM_RADIO_SLEEP = 0,
+  SIM_RADIO_STANDBY,
+  SIM_RADIO_RX,
+  SIM_RADIO_TX,
+  SIM_RADIO_NUM_STATES,
+};
+
+class Simulator;
+class SimRadio;
+
+// hardware abstraction layer running on the simulator virtual clock
+// there is no real hardware, blocking delays advance the clock instead of waiting
+class SimHal : public RadioLibHal {
+  public:
+    explicit SimHal(Simulator* sim)
+      : RadioLibHal(SIM_HAL_INPUT, SIM_HAL_OUTPUT, SIM_HAL_LOW, SIM_HAL_HIGH, SIM_HAL_RISING, SIM_HAL_FALLING),
+      sim(sim) {
+    }
+
+    // radio whose interrupt line is read through SIM_HAL_IRQ_PIN
+    SimRadio* radio = nullptr;
+
+    void pinMode(uint32_t pin, uint32_t mode) override { (void)pin; (void)mode; }
+    void digitalWrite(uint32_t pin, uint32_t value) override { (void)pin; (void)value; }
+    uint32_t digitalRead(uint32_t pin) override;
+    void attachInterrupt(uint32_t interruptNum, void (*interruptCb)(void), uint32_t mode) override { (void)interruptNum; (void)interruptCb; (void)mode; }
+    void detachInterrupt(uint32_t interruptNum) override { (void)interruptNum; }
+    void delay(RadioLibTime_t ms) override;
+    void delayMicroseconds(RadioLibTime_t us) override;
+    RadioLibTime_t millis() override;
+    RadioLibTime_t micros() override;
+    long pulseIn(uint32_t pin, uint32_t state, RadioLibTime_t timeout) override { (void)pin; (void)state; (void)timeout; return(0); }
+    void spiBegin() override {}
+    void spiBeginTransaction() override {}
+    void spiTransfer(uint8_t* out, size_t len, uint8_t* in) override { (void)out; (void)len; (void)in; }
+    void spiEndTransaction() override {}
+    void spiEnd() override {}
+    void yield() override;
+
+  private:
+    Simulator* sim;
+};
+
+// supply currents of the emulated radio, the defaults are roughly those of SX1262 with DC-DC at 3.3 V
+struct SimRadioPower {
+  double voltage = 3.3;
+  double sleep_mA = 0.0016;
+  double standby_mA = 0.6;
+  double rx_mA = 4.6;
+
+  // transmit current, interpolated between these points
+  static constexpr int numTxPoints = 7;
+  int8_t txPower[numTxPoints] = { -9, 0, 10, 14, 17, 20, 22 };
+  double tx_mA[numTxPoints] = { 18.0, 24.0, 32.0, 45.0, 90.0, 105.0, 118.0 };
+};
+
+// emulated radio, all transmissions go to the shared simulated channel
+class SimRadio : public PhysicalLayer {
+  public:
+    SimRadio(Simulator* sim, SimHal* hal, uint32_t node, uint32_t seed);
+
+    int16_t sleep() override;
+    int16_t standby() override;
+    int16_t standby(uint8_t mode) override;
+    int16_t finishTransmit() override;
+    int16_t finishReceive() override;
+    int16_t readData(uint8_t* data, size_t len) override;
+    int16_t setFrequency(float freq) override;
+    int16_t setDataShaping(uint8_t sh) override;
+    int16_t setEncoding(uint8_t encoding) override;
+    int16_t invertIQ(bool enable) override;
+    int16_t setPacketCRC(bool enable) override;
+    int16_t setOutputPower(int8_t power) override;
+    int16_t checkOutputPower(int8_t power, int8_t* clipped) override;
+    int16_t setSyncWord(uint8_t* sync, size_t len) override;
+    int16_t setPreambleLength(size_t len) override;
+    int16_t implicitHeader(size_t len) override;
+    int16_t explicitHeader() override;
+    int16_t setDataRate(DataRate_t dr, ModemType_t modem = RADIOLIB_MODEM_NONE) override;
+    int16_t checkDataRate(DataRate_t dr, ModemType_t modem = RADIOLIB_MODEM_NONE) override;
+    size_t getPacketLength(bool update = true) override;
+    float getRSSI() override;
+    float getSNR() override;
+    RadioLibTime_t calculateTimeOnAir(ModemType_t modem, DataRate_t dr, PacketConfig_t pc, size_t len) override;
+    RadioLibTime_t calculateRxTimeout(RadioLibTime_t timeoutUs) override;
+    uint32_t getIrqFlags() override;
+    int16_t setIrqFlags(uint32_t irq) override;
+    int16_t clearIrqFlags(uint32_t irq) override;
+    int16_t scanChannel() override;
+    uint8_t randomByte() override;
+    void setPacketReceivedAction(void (*func)(void)) override;
+    void clearPacketReceivedAction() override;
+    int16_t stageMode(RadioModeType_t mode, RadioModeConfig_t* cfg) override;
+    int16_t launchMode() override;
+
+    // state of the interrupt line
+    bool getIrqPin();
+
+    // called by the simulator when a transmission this radio was locked onto ends
+    void receive(const uint8_t* data, size_t len, float rssi, float snr);
+
+    // called by the simulator when a transmission this radio was locked onto was lost
+    void receiveFailed();
+
+    // lock onto a transmission that started while listening, returns false if not listening
+    bool lock(uint64_t tEnd);
+
+    // current configuration, as used by the simulated channel
+    uint32_t freq = 0;
+    ModemType_t modem = RADIOLIB_MODEM_LORA;
+    DataRate_t dataRate;
+    bool iqInverted = false;
+    int8_t power = 14;
+    size_t preambleLength = 8;
+    bool implicit = false;
+    bool crc = true;
+
+    // energy and airtime bookkeeping
+    SimRadioPower powerModel;
+    double energy_mJ = 0;
+    uint64_t timeInState[SIM_RADIO_NUM_STATES] = { 0 };
+    uint64_t txAirtime = 0;
+
+    // index of this radio in the list of listening radios kept by the simulator, -1 if not listening
+    int32_t listenIdx = -1;
+
+    uint32_t node;
+
+    // make the energy and time counters current
+    void update();
+
+  private:
+    Simulator* sim;
+    Module mod;
+    std::mt19937 rng;
+
+    SimRadioState_t state = SIM_RADIO_SLEEP;
+    uint64_t stateSince = 0;
+    uint32_t irqFlags = 0;
+    uint32_t irqMask = 0;
+
+    // staged configuration
+    RadioModeType_t staged = RADIOLIB_RADIO_MODE_NONE;
+    std::vector<uint8_t> txData;
+    uint32_t rxTimeout = 0;
+    uint32_t rxIrqMask = 0;
+
+    // current Tx or Rx operation
+    uint64_t tEnd = 0;
+    bool locked = false;
+
+    // last received packet
+    std::vector<uint8_t> rxData;
+    float rxRssi = 0;
+    float rxSnr = 0;
+
+    void (*rxAction)(void) = nullptr;
+
+    void setState(SimRadioState_t newState);
+    void setState(SimRadioState_t newState, uint64_t t);
+    double getTxCurrent();
+    PacketConfig_t getPacketConfig();
+    Module* getMod() override { return(&this->mod); }
+};
+
+#endif
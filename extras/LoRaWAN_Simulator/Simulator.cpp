@@ -0,0 +1,793 @@
+#include "Simulator.h"
+
+#include <math.h>
+#include <string.h>
+
+// margin kept above sensitivity when picking the datarate of a node
+#define SIM_DATARATE_MARGIN_DB      (10.0)
+
+// round time up to the next millisecond, LoRaWANNode only sees the millisecond clock
+static uint64_t ceilMs(uint64_t t) {
+  return(((t + 999) / 1000) * 1000);
+}
+
+Simulator::Simulator(const LoRaWANBand_t* band, uint8_t subBand, uint32_t seed)
+  : band(band), subBand(subBand), rng(seed) {
+}
+
+Simulator::~Simulator() {
+  for(SimNode* n : this->nodes) {
+    delete n->adapt;
+    delete n->node;
+    delete n->radio;
+    delete n->hal;
+    delete n;
+  }
+}
+
+uint32_t Simulator::addGateway(SimPosition pos) {
+  SimGateway gw;
+  gw.pos = pos;
+  this->gateways.push_back(gw);
+
+  // nodes added so far need the new link as well
+  std::normal_distribution<double> shadowing(0.0, this->pathLoss.sigma);
+  for(SimNode* n : this->nodes) {
+    double loss = this->calculatePathLoss(n->pos, pos);
+    if(this->pathLoss.sigma > 0) {
+      loss += shadowing(this->rng);
+    }
+    n->loss.push_back(loss);
+  }
+
+  return(this->gateways.size() - 1);
+}
+
+uint32_t Simulator::addNode(SimPosition pos, const SimNodeConfig& cfg) {
+  uint32_t idx = this->nodes.size();
+  SimNode* n = new SimNode;
+  n->pos = pos;
+  n->cfg = cfg;
+  n->hal = new SimHal(this);
+  n->radio = new SimRadio(this, n->hal, idx, this->rng());
+  n->hal->radio = n->radio;
+  n->node = new LoRaWANNode(n->radio, this->band, this->subBand);
+  if(cfg.linkAdapt && !cfg.adr) {
+    n->adapt = new LoRaWANLinkAdapt(n->node);
+  }
+
+  // shadowing is drawn once, so that each link keeps its quality for the whole run
+  std::normal_distribution<double> shadowing(0.0, this->pathLoss.sigma);
+  for(const SimGateway& gw : this->gateways) {
+    double loss = this->calculatePathLoss(pos, gw.pos);
+    if(this->pathLoss.sigma > 0) {
+      loss += shadowing(this->rng);
+    }
+    n->loss.push_back(loss);
+  }
+
+  this->nodes.push_back(n);
+  return(idx);
+}
+
+int16_t Simulator::activateABP(uint32_t idx, uint32_t devAddr, const uint8_t* nwkSKey, const uint8_t* appSKey) {
+  SimNode* n = this->nodes[idx];
+  int16_t state = n->node->beginABP(devAddr, NULL, NULL, nwkSKey, appSKey);
+  RADIOLIB_ASSERT(state);
+
+  // there is no persistent storage, so start with a fresh set of nonces
+  (void)n->node->getBufferNonces();
+  state = n->node->activateABP();
+  if(state != RADIOLIB_LORAWAN_NEW_SESSION) {
+    return(state);
+  }
+
+  return(this->configureNode(idx));
+}
+
+int16_t Simulator::beginOTAA(uint32_t idx, uint64_t joinEUI, uint64_t devEUI, const uint8_t* nwkKey, const uint8_t* appKey) {
+  SimNode* n = this->nodes[idx];
+  int16_t state = n->node->beginOTAA(joinEUI, devEUI, nwkKey, appKey);
+  RADIOLIB_ASSERT(state);
+
+  (void)n->node->getBufferNonces();
+  n->otaa = true;
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t Simulator::configureNode(uint32_t idx) {
+  SimNode* n = this->nodes[idx];
+  n->node->setADR(n->cfg.adr);
+  n->node->setDutyCycle(n->cfg.dutyCycle);
+
+  n->dr = n->cfg.dr;
+  if(n->dr == RADIOLIB_LORAWAN_DATA_RATE_UNUSED) {
+    n->dr = this->pickDatarate(idx);
+  }
+  int16_t state = n->node->setDatarate(n->dr);
+  RADIOLIB_ASSERT(state);
+
+  return(n->node->setTxPower(n->cfg.txPower));
+}
+
+void Simulator::start(uint32_t idx) {
+  SimNode* n = this->nodes[idx];
+  std::uniform_real_distribution<double> offset(0.0, (double)n->cfg.period * 1000000.0);
+  n->running = true;
+  n->tUplink = this->tNow + (uint64_t)offset(this->rng);
+  this->wakeIdle(idx);
+}
+
+void Simulator::run(uint64_t durationUs) {
+  uint64_t tStop = this->tNow + durationUs;
+  while(!this->events.empty() && (this->events.top().t <= tStop)) {
+    SimEvent ev = this->events.top();
+    this->events.pop();
+
+    // a blocking call may have already moved the clock past this event
+    this->tNow = RADIOLIB_MAX(this->tNow, ev.t);
+    this->handle(ev);
+  }
+  this->tNow = RADIOLIB_MAX(this->tNow, tStop);
+
+  // bring the energy counters up to date
+  for(SimNode* n : this->nodes) {
+    n->radio->update();
+  }
+}
+
+void Simulator::advance(uint64_t tUs) {
+  // the channel and the other nodes keep going, but the node in the blocking call is not re-entered,
+  // and no other node may start a blocking call of its own - their events are handled once the call returns
+  while(!this->events.empty() && (this->events.top().t <= tUs)) {
+    SimEvent ev = this->events.top();
+    this->events.pop();
+    if((ev.type == SIM_EVENT_NODE) && this->isBlocked(ev.idx)) {
+      this->deferred.push_back(ev);
+      continue;
+    }
+    this->tNow = RADIOLIB_MAX(this->tNow, ev.t);
+    this->handle(ev);
+  }
+  this->tNow = RADIOLIB_MAX(this->tNow, tUs);
+}
+
+void Simulator::scheduleDownlink(uint32_t gw, uint64_t tUs, uint32_t freq, ModemType_t modem, DataRate_t dr, int8_t power, const uint8_t* data, size_t len) {
+  // LoRaWAN downlinks have inverted IQ and no payload CRC
+  SimPendingDownlink dl;
+  dl.gateway = gw;
+  dl.tx = this->makeGatewayTx(gw, tUs, freq, modem, dr, power, true, 8, false, data, len);
+
+  uint32_t id = this->downlinkId++;
+  this->pendingDownlinks[id] = dl;
+  this->push(tUs, SIM_EVENT_DOWNLINK, id);
+}
+
+void Simulator::startBeacons(uint32_t gpsEpoch, int8_t power) {
+  const uint32_t period = RADIOLIB_LORAWAN_BEACON_PERIOD_MS / 1000;
+  const uint64_t periodUs = RADIOLIB_LORAWAN_BEACON_PERIOD_MS * 1000;
+  this->beacons = true;
+  this->beaconEpoch = gpsEpoch - gpsEpoch % period;
+  this->beaconPower = power;
+
+  // the beacon itself is sent a bit after the start of the period
+  uint64_t tPeriod = ((this->tNow + periodUs - 1) / periodUs) * periodUs;
+  this->push(tPeriod + RADIOLIB_LORAWAN_BEACON_DELAY_US, SIM_EVENT_BEACON, 0);
+}
+
+SimTransmission Simulator::makeGatewayTx(uint32_t gw, uint64_t tUs, uint32_t freq, ModemType_t modem, DataRate_t dr, int8_t power,
+                                         bool iqInverted, uint16_t preamble, bool implicit, const uint8_t* data, size_t len) {
+  SimTransmission tx;
+  tx.id = 0;
+  tx.node = -1;
+  tx.gateway = gw;
+  tx.freq = freq;
+  tx.modem = modem;
+  tx.dr = dr;
+  tx.iqInverted = iqInverted;
+  tx.power = power;
+  tx.data.assign(data, data + len);
+
+  // gateway transmissions never have payload CRC
+  RadioLibTime_t toa = 0;
+  if(modem == RADIOLIB_MODEM_LORA) {
+    bool ldro = rlb_toaLoRaSymbolUs(dr.lora.spreadingFactor, dr.lora.bandwidth) >= 16000;
+    toa = rlb_toaLoRa(dr.lora.spreadingFactor, dr.lora.bandwidth, dr.lora.codingRate, preamble, false, implicit, ldro, len);
+  } else {
+    preamble = 40;
+    toa = rlb_toaFSK(dr.fsk.bitRate, preamble, 24, 2, len);
+  }
+
+  tx.tStart = tUs;
+  tx.tEnd = tUs + toa;
+  tx.tLock = tUs;
+  if(modem == RADIOLIB_MODEM_LORA) {
+    uint64_t tSym = rlb_toaLoRaSymbolUs(dr.lora.spreadingFactor, dr.lora.bandwidth);
+    if(preamble > this->reception.lockSymbols) {
+      tx.tLock += (preamble - this->reception.lockSymbols) * tSym;
+    }
+  }
+  return(tx);
+}
+
+double Simulator::getSensitivity(ModemType_t modem, const DataRate_t& dr) {
+  if(modem != RADIOLIB_MODEM_LORA) {
+    return(-108.0);
+  }
+
+  // typical SX126x values at 125 kHz, wider bandwidth costs the same amount of dB
+  static const double sens125[] = { -115.0, -118.0, -123.0, -126.0, -129.0, -132.0, -134.5, -137.0 };
+  uint8_t sf = RADIOLIB_MAX(5, RADIOLIB_MIN(12, dr.lora.spreadingFactor));
+  return(sens125[sf - 5] + 10.0*log10(dr.lora.bandwidth / 125.0));
+}
+
+double Simulator::getNoiseFloor(ModemType_t modem, const DataRate_t& dr) const {
+  return(-174.0 + 10.0*log10(getBandwidth(modem, dr)) + this->reception.noiseFigure);
+}
+
+uint64_t Simulator::startTransmission(SimRadio* radio, const uint8_t* data, size_t len, RadioLibTime_t toaUs) {
+  SimTransmission tx;
+  tx.id = this->txId++;
+  tx.node = radio->node;
+  tx.gateway = -1;
+  tx.freq = radio->freq;
+  tx.modem = radio->modem;
+  tx.dr = radio->dataRate;
+  tx.iqInverted = radio->iqInverted;
+  tx.power = radio->power;
+  tx.tStart = this->tNow;
+  tx.tEnd = this->tNow + toaUs;
+  tx.tLock = this->tNow;
+  if((tx.modem == RADIOLIB_MODEM_LORA) && (radio->preambleLength > this->reception.lockSymbols)) {
+    uint64_t tSym = rlb_toaLoRaSymbolUs(tx.dr.lora.spreadingFactor, tx.dr.lora.bandwidth);
+    tx.tLock += (radio->preambleLength - this->reception.lockSymbols) * tSym;
+  }
+  tx.data.assign(data, data + len);
+
+  this->nodes[radio->node]->stats.transmissions++;
+  this->beginTransmission(tx);
+  return(tx.tEnd);
+}
+
+void Simulator::startListening(SimRadio* radio) {
+  if(radio->listenIdx >= 0) {
+    return;
+  }
+  radio->listenIdx = this->listening.size();
+  this->listening.push_back(radio);
+}
+
+void Simulator::stopListening(SimRadio* radio) {
+  if(radio->listenIdx < 0) {
+    return;
+  }
+
+  // swap with the last one to keep removal constant-time
+  SimRadio* last = this->listening.back();
+  this->listening[radio->listenIdx] = last;
+  last->listenIdx = radio->listenIdx;
+  this->listening.pop_back();
+  radio->listenIdx = -1;
+}
+
+bool Simulator::isChannelBusy(SimRadio* radio) {
+  SimTransmission probe;
+  probe.freq = radio->freq;
+  probe.modem = radio->modem;
+  probe.dr = radio->dataRate;
+  probe.iqInverted = radio->iqInverted;
+  for(const auto& it : this->active) {
+    if(isOverlapping(probe, it.second.tx)) {
+      return(true);
+    }
+  }
+  return(false);
+}
+
+void Simulator::push(uint64_t t, uint8_t type, uint32_t idx) {
+  SimEvent ev = { .t = t, .type = type, .seq = this->seq++, .idx = idx };
+  this->events.push(ev);
+}
+
+void Simulator::wake(uint32_t node, uint64_t tUs) {
+  SimNode* n = this->nodes[node];
+  if(tUs >= n->tWake) {
+    return;
+  }
+
+  // the previous event becomes stale, the node always works out its next wake-up when stepped
+  n->tWake = tUs;
+  this->push(tUs, SIM_EVENT_NODE, node);
+}
+
+void Simulator::handle(const SimEvent& ev) {
+  this->numEvents++;
+  switch(ev.type) {
+    case(SIM_EVENT_TX_END):
+      this->endTransmission(ev.idx);
+      break;
+
+    case(SIM_EVENT_DOWNLINK): {
+      auto it = this->pendingDownlinks.find(ev.idx);
+      if(it == this->pendingDownlinks.end()) {
+        break;
+      }
+      SimPendingDownlink dl = it->second;
+      this->pendingDownlinks.erase(it);
+
+      // a gateway can only send one downlink at a time
+      if(this->gateways[dl.gateway].tBusy > this->tNow) {
+        break;
+      }
+      dl.tx.id = this->txId++;
+      this->beginTransmission(dl.tx);
+    } break;
+
+    case(SIM_EVENT_BEACON):
+      this->sendBeacon();
+      break;
+
+    case(SIM_EVENT_NODE): {
+      SimNode* n = this->nodes[ev.idx];
+      if(ev.t != n->tWake) {
+        break;
+      }
+      n->tWake = UINT64_MAX;
+      this->stepNode(ev.idx);
+    } break;
+
+    default:
+      break;
+  }
+}
+
+void Simulator::stepNode(uint32_t idx) {
+  SimNode* n = this->nodes[idx];
+  if(!n->running) {
+    return;
+  }
+
+  if(!n->inCycle) {
+    // Class B windows are served in between the uplinks
+    if(n->cfg.classB) {
+      this->stepClassB(idx);
+    }
+
+    if(this->tNow < n->tUplink) {
+      this->wakeIdle(idx);
+      return;
+    }
+
+    if(n->otaa && !n->node->isActivated()) {
+      this->joinNode(idx);
+      return;
+    }
+
+    std::uniform_int_distribution<int> byte(0, 255);
+    for(uint8_t i = 0; i < n->cfg.payloadLen; i++) {
+      n->dataUp[i] = byte(this->rng);
+    }
+    n->lenDown = 0;
+    int16_t state = n->node->startSendReceive(n->dataUp, n->cfg.payloadLen, n->cfg.fPort, n->dataDown, &n->lenDown,
+                                              n->cfg.confirmed, &n->eventUp, &n->eventDown);
+    if(state == RADIOLIB_ERR_UPLINK_UNAVAILABLE) {
+      // blocked by duty cycle, try again as soon as it allows
+      n->stats.dutyCycleBlocked++;
+      RadioLibTime_t wait = RADIOLIB_MAX(n->node->timeUntilUplink(), (RadioLibTime_t)1);
+      n->tUplink = ceilMs(this->tNow) + (uint64_t)wait*1000;
+      this->wakeIdle(idx);
+      return;
+    } else if(state != RADIOLIB_ERR_NONE) {
+      n->stats.errors++;
+      this->scheduleNextUplink(n);
+      this->wakeIdle(idx);
+      return;
+    }
+    n->stats.uplinks++;
+    n->inCycle = true;
+  }
+
+  int16_t state = n->node->process();
+  if(state == RADIOLIB_LORAWAN_CYCLE_PENDING) {
+    // check again at the deadline, or on the next millisecond tick if it has already passed
+    uint64_t t = (uint64_t)n->node->getNextDeadline() * 1000;
+    this->wake(idx, RADIOLIB_MAX(t, (this->tNow / 1000 + 1) * 1000));
+    return;
+  }
+
+  n->inCycle = false;
+  if(state > 0) {
+    n->stats.downlinks++;
+  } else if(state < 0) {
+    n->stats.errors++;
+  }
+  if(n->adapt && (n->adapt->update(state, n->cfg.payloadLen, &n->eventUp, &n->eventDown) != RADIOLIB_ERR_NONE)) {
+    n->stats.errors++;
+  }
+  n->radio->sleep();
+  this->scheduleNextUplink(n);
+  this->wakeIdle(idx);
+}
+
+void Simulator::stepClassB(uint32_t idx) {
+  SimNode* n = this->nodes[idx];
+  LoRaWANNode* node = n->node;
+  if(!node->isActivated()) {
+    return;
+  }
+
+  // start searching for the beacon, or try again some time after the last search failed
+  if(node->getNextClassBDeadline() == 0) {
+    if(this->tNow < n->tBeaconSearch) {
+      return;
+    }
+    n->stats.beaconSearches++;
+    if(node->startBeaconAcquisition() != RADIOLIB_ERR_NONE) {
+      n->stats.errors++;
+      n->tBeaconSearch = this->tNow + RADIOLIB_LORAWAN_BEACON_PERIOD_MS*1000;
+    }
+    return;
+  }
+
+  size_t lenDown = 0;
+  int16_t state = node->processClassB(n->dataDown, &lenDown, &n->eventDown);
+  if(state == RADIOLIB_LORAWAN_RX_BC) {
+    n->stats.pingDownlinks++;
+  } else if(state == RADIOLIB_ERR_DOWNLINK_MALFORMED) {
+    // most likely a downlink to another node, whose ping slot overlaps with the window
+    n->stats.pingForeign++;
+  } else if(state == RADIOLIB_ERR_NO_BEACON) {
+    // the search failed, or the beacon was lost and the node went back to Class A
+    n->stats.beaconLost++;
+    n->classB = false;
+    n->tBeaconSearch = this->tNow + RADIOLIB_LORAWAN_BEACON_PERIOD_MS*1000;
+    return;
+  } else if(state < 0) {
+    n->stats.errors++;
+  }
+
+  // switch to Class B as soon as the beacon is tracked
+  if(!n->classB && node->isBeaconLocked()) {
+    if(node->setClass(RADIOLIB_LORAWAN_CLASS_B) == RADIOLIB_ERR_NONE) {
+      n->classB = true;
+      if(n->stats.tClassB == 0) {
+        n->stats.tClassB = this->tNow;
+      }
+      if(n->cfg.pingPeriodicity != RADIOLIB_LORAWAN_PING_PERIODICITY_MAX) {
+        (void)node->setPingSlotPeriodicity(n->cfg.pingPeriodicity);
+      }
+    }
+  }
+}
+
+void Simulator::wakeIdle(uint32_t idx) {
+  SimNode* n = this->nodes[idx];
+  uint64_t t = n->tUplink;
+  if(n->cfg.classB && n->node->isActivated()) {
+    RadioLibTime_t deadline = n->node->getNextClassBDeadline();
+    uint64_t tClassB = deadline ? (uint64_t)deadline*1000 : n->tBeaconSearch;
+
+    // the node only sees the millisecond clock, so never wake it up within the same tick again
+    t = RADIOLIB_MIN(t, RADIOLIB_MAX(tClassB, (this->tNow / 1000 + 1) * 1000));
+  }
+  this->wake(idx, t);
+}
+
+void Simulator::sendBeacon() {
+  const LoRaWANBeacon_t& bcn = this->band->beacon;
+  uint64_t tPeriod = this->tNow - RADIOLIB_LORAWAN_BEACON_DELAY_US;
+  uint32_t gpsTime = this->beaconEpoch + (uint32_t)(tPeriod / 1000000);
+  this->push(tPeriod + RADIOLIB_LORAWAN_BEACON_PERIOD_MS*1000 + RADIOLIB_LORAWAN_BEACON_DELAY_US, SIM_EVENT_BEACON, 0);
+  if(bcn.freqStart == 0) {
+    return;
+  }
+
+  // the network server plans the ping slots of the new period
+  if(this->backend) {
+    this->backend->onBeacon(gpsTime, tPeriod);
+  }
+
+  // | RFU | Time | CRC | GwSpecific | RFU | CRC |, the gateway-specific field is left empty
+  uint8_t frame[RADIOLIB_LORAWAN_BEACON_MAX_LEN] = { 0 };
+  size_t len = RADIOLIB_LORAWAN_BEACON_LEN(bcn.rfu1, bcn.rfu2);
+  size_t pos = bcn.rfu1;
+  for(size_t i = 0; i < RADIOLIB_LORAWAN_BEACON_TIME_LEN; i++) {
+    frame[pos + i] = (uint8_t)(gpsTime >> 8*i);
+  }
+  RadioLibCRCInstance.size = 16;
+  RadioLibCRCInstance.poly = RADIOLIB_CRC_CCITT_POLY;
+  RadioLibCRCInstance.init = 0;
+  RadioLibCRCInstance.out = 0;
+  RadioLibCRCInstance.refIn = false;
+  RadioLibCRCInstance.refOut = false;
+  pos += RADIOLIB_LORAWAN_BEACON_TIME_LEN;
+  uint16_t crc = RadioLibCRCInstance.checksum(frame, pos);
+  frame[pos] = (uint8_t)crc;
+  frame[pos + 1] = (uint8_t)(crc >> 8);
+  pos += RADIOLIB_LORAWAN_BEACON_CRC_LEN;
+  size_t infoLen = RADIOLIB_LORAWAN_BEACON_INFO_LEN + bcn.rfu2;
+  crc = RadioLibCRCInstance.checksum(&frame[pos], infoLen);
+  frame[pos + infoLen] = (uint8_t)crc;
+  frame[pos + infoLen + 1] = (uint8_t)(crc >> 8);
+
+  // beacons have non-inverted IQ, a longer preamble and implicit header
+  uint32_t ch = (gpsTime / (RADIOLIB_LORAWAN_BEACON_PERIOD_MS / 1000)) % bcn.numChannels;
+  uint32_t freq = (bcn.freqStart + ch*bcn.freqStep) * 100;
+  const LoRaWANDataRate_t& rate = this->band->dataRates[bcn.dr];
+  for(uint32_t gw = 0; gw < this->gateways.size(); gw++) {
+    if(this->gateways[gw].tBusy > this->tNow) {
+      continue;
+    }
+    SimTransmission tx = this->makeGatewayTx(gw, this->tNow, freq, rate.modem, rate.dr, this->beaconPower,
+                                             false, RADIOLIB_LORAWAN_BEACON_PREAMBLE_LEN, true, frame, len);
+    tx.beacon = true;
+    tx.id = this->txId++;
+    this->beginTransmission(tx);
+  }
+  this->beaconsSent++;
+}
+
+void Simulator::joinNode(uint32_t idx) {
+  SimNode* n = this->nodes[idx];
+  if(n->stats.joinAttempts == 0) {
+    n->tJoinStart = this->tNow;
+  }
+
+  // the join is blocking, everything else keeps running while it waits for the JoinAccept
+  n->node->setDutyCycle(n->cfg.dutyCycle);
+  this->blockingNode = idx;
+  int16_t state = n->node->activateOTAA();
+  this->blockingNode = -1;
+  for(const SimEvent& ev : this->deferred) {
+    this->events.push(ev);
+  }
+  this->deferred.clear();
+  n->radio->sleep();
+  if(state == RADIOLIB_ERR_UPLINK_UNAVAILABLE) {
+    n->stats.dutyCycleBlocked++;
+    RadioLibTime_t wait = RADIOLIB_MAX(n->node->timeUntilUplink(), (RadioLibTime_t)1);
+    n->tUplink = ceilMs(this->tNow) + (uint64_t)wait*1000;
+    this->wake(idx, n->tUplink);
+    return;
+  }
+  n->stats.joinAttempts++;
+
+  if(state == RADIOLIB_LORAWAN_NEW_SESSION) {
+    state = this->configureNode(idx);
+  }
+  if(state != RADIOLIB_ERR_NONE) {
+    // no JoinAccept, back off for a while before the next attempt
+    std::uniform_int_distribution<uint64_t> backoff(10000000, 20000000);
+    n->tUplink = this->tNow + backoff(this->rng);
+    this->wake(idx, n->tUplink);
+    return;
+  }
+
+  n->stats.joined = true;
+  n->stats.joinLatency = this->tNow - n->tJoinStart;
+  this->scheduleNextUplink(n);
+  this->wakeIdle(idx);
+}
+
+bool Simulator::isBlocked(uint32_t idx) {
+  if(this->blockingNode < 0) {
+    return(false);
+  }
+  if((uint32_t)this->blockingNode == idx) {
+    return(true);
+  }
+
+  // a node that has yet to join would start another blocking call
+  SimNode* n = this->nodes[idx];
+  return(n->otaa && !n->inCycle && !n->node->isActivated());
+}
+
+void Simulator::scheduleNextUplink(SimNode* n) {
+  std::uniform_real_distribution<double> period(0.5, 1.5);
+  n->tUplink = this->tNow + (uint64_t)(period(this->rng) * (double)n->cfg.period * 1000000.0);
+}
+
+uint8_t Simulator::pickDatarate(uint32_t idx) {
+  SimNode* n = this->nodes[idx];
+  uint8_t drMin = 0;
+  uint8_t drMax = 0;
+  if(this->band->bandType == RADIOLIB_LORAWAN_BAND_DYNAMIC) {
+    drMin = this->band->txFreqs[0].drMin;
+    drMax = this->band->txFreqs[0].drMax;
+  } else {
+    drMin = this->band->txSpans[0].drMin;
+    drMax = this->band->txSpans[0].drMax;
+  }
+
+  // best link to any of the gateways
+  double loss = INFINITY;
+  for(double l : n->loss) {
+    loss = RADIOLIB_MIN(loss, l);
+  }
+  double rssi = (double)n->cfg.txPower - loss;
+
+  for(int dr = drMax; dr >= drMin; dr--) {
+    const LoRaWANDataRate_t& rate = this->band->dataRates[dr];
+    if((rate.modem != RADIOLIB_MODEM_LORA) || (rate.dr.lora.bandwidth != 125.0)) {
+      continue;
+    }
+    if(getSensitivity(rate.modem, rate.dr) <= rssi - SIM_DATARATE_MARGIN_DB) {
+      return(dr);
+    }
+  }
+  return(drMin);
+}
+
+void Simulator::beginTransmission(const SimTransmission& tx) {
+  SimActive& act = this->active[tx.id];
+  act.tx = tx;
+
+  // a gateway that starts transmitting loses everything it was receiving
+  if(tx.gateway >= 0) {
+    this->gateways[tx.gateway].tBusy = tx.tEnd;
+    for(auto& it : this->active) {
+      for(SimListener& l : it.second.listeners) {
+        if(l.gateway && (l.idx == (uint32_t)tx.gateway)) {
+          l.lost = true;
+        }
+      }
+    }
+  }
+
+  // transmissions already on the air interfere with this one, and the other way around
+  SimInterferer self = { .node = tx.node, .gateway = tx.gateway, .power = tx.power, .tStart = tx.tStart, .tEnd = tx.tEnd };
+  for(auto& it : this->active) {
+    if((it.first == tx.id) || !isOverlapping(tx, it.second.tx) || (tx.beacon && it.second.tx.beacon)) {
+      continue;
+    }
+    const SimTransmission& other = it.second.tx;
+    SimInterferer intf = { .node = other.node, .gateway = other.gateway, .power = other.power, .tStart = other.tStart, .tEnd = other.tEnd };
+    act.interferers.push_back(intf);
+    it.second.interferers.push_back(self);
+  }
+
+  double sensitivity = getSensitivity(tx.modem, tx.dr);
+  if(tx.node >= 0) {
+    // uplink, every gateway that is not transmitting itself and hears it tries to decode it
+    SimNode* n = this->nodes[tx.node];
+    for(uint32_t gw = 0; gw < this->gateways.size(); gw++) {
+      if(this->gateways[gw].tBusy > tx.tStart) {
+        continue;
+      }
+      double rssi = (double)tx.power - n->loss[gw];
+      if(rssi >= sensitivity) {
+        SimListener l = { .gateway = true, .idx = gw, .rssi = (float)rssi, .lost = false };
+        act.listeners.push_back(l);
+      }
+    }
+
+  } else {
+    // downlink, received by radios listening with matching settings
+    for(SimRadio* radio : this->listening) {
+      SimTransmission probe;
+      probe.freq = radio->freq;
+      probe.modem = radio->modem;
+      probe.dr = radio->dataRate;
+      probe.iqInverted = radio->iqInverted;
+      if((probe.freq != tx.freq) || !isOverlapping(probe, tx)) {
+        continue;
+      }
+      double rssi = (double)tx.power - this->nodes[radio->node]->loss[tx.gateway];
+      if((rssi >= sensitivity) && radio->lock(tx.tEnd)) {
+        SimListener l = { .gateway = false, .idx = radio->node, .rssi = (float)rssi, .lost = false };
+        act.listeners.push_back(l);
+      }
+    }
+  }
+
+  this->push(tx.tEnd, SIM_EVENT_TX_END, tx.id);
+}
+
+void Simulator::endTransmission(uint32_t id) {
+  auto it = this->active.find(id);
+  if(it == this->active.end()) {
+    return;
+  }
+  SimActive act = std::move(it->second);
+  this->active.erase(it);
+  const SimTransmission& tx = act.tx;
+
+  // a listener loses the packet if an interferer overlaps the part after the lock-on point,
+  // unless the wanted signal is strong enough to capture the receiver
+  double noise = this->getNoiseFloor(tx.modem, tx.dr);
+  std::vector<SimReception> copies;
+  for(SimListener& l : act.listeners) {
+    for(const SimInterferer& intf : act.interferers) {
+      if(l.lost) {
+        break;
+      }
+      if(intf.tEnd <= tx.tLock) {
+        continue;
+      }
+      double rssi = (double)intf.power - this->getLinkLoss(intf, l);
+      if((double)l.rssi - rssi < this->reception.captureDb) {
+        l.lost = true;
+      }
+    }
+
+    float snr = l.rssi - (float)noise;
+    if(l.gateway) {
+      if(!l.lost) {
+        SimReception rx = { .gateway = l.idx, .rssi = l.rssi, .snr = snr };
+        copies.push_back(rx);
+      }
+      continue;
+    }
+
+    // node radio, skip it if it stopped receiving in the meantime
+    SimRadio* radio = this->nodes[l.idx]->radio;
+    if(radio->listenIdx < 0) {
+      continue;
+    }
+    if(l.lost) {
+      radio->receiveFailed();
+    } else {
+      radio->receive(tx.data.data(), tx.data.size(), l.rssi, snr);
+      if(tx.beacon) {
+        this->nodes[l.idx]->stats.beacons++;
+      }
+    }
+    this->wake(l.idx, ceilMs(this->tNow));
+  }
+
+  if(tx.node >= 0) {
+    if(!copies.empty()) {
+      this->nodes[tx.node]->stats.delivered++;
+      if(this->backend) {
+        this->backend->onUplink(tx, copies);
+      }
+    }
+
+    // the sender sees TxDone on its next millisecond tick
+    this->wake(tx.node, ceilMs(this->tNow));
+  }
+}
+
+double Simulator::getLinkLoss(const SimInterferer& from, const SimListener& to) const {
+  if(from.node >= 0) {
+    if(to.gateway) {
+      return(this->nodes[from.node]->loss[to.idx]);
+    }
+    return(this->calculatePathLoss(this->nodes[from.node]->pos, this->nodes[to.idx]->pos));
+  }
+
+  if(!to.gateway) {
+    return(this->nodes[to.idx]->loss[from.gateway]);
+  }
+  return(this->calculatePathLoss(this->gateways[from.gateway].pos, this->gateways[to.idx].pos));
+}
+
+double Simulator::calculatePathLoss(const SimPosition& a, const SimPosition& b) const {
+  double d = sqrt((a.x - b.x)*(a.x - b.x) + (a.y - b.y)*(a.y - b.y));
+  d = RADIOLIB_MAX(d, this->pathLoss.d0);
+  return(this->pathLoss.pl0 + 10.0*this->pathLoss.gamma*log10(d / this->pathLoss.d0));
+}
+
+bool Simulator::isOverlapping(const SimTransmission& a, const SimTransmission& b) {
+  if((a.modem != b.modem) || (a.iqInverted != b.iqInverted)) {
+    return(false);
+  }
+
+  // different spreading factors and bandwidths are treated as orthogonal
+  if((a.modem == RADIOLIB_MODEM_LORA) &&
+     ((a.dr.lora.spreadingFactor != b.dr.lora.spreadingFactor) || (a.dr.lora.bandwidth != b.dr.lora.bandwidth))) {
+    return(false);
+  }
+
+  double df = fabs((double)a.freq - (double)b.freq);
+  return(df < (getBandwidth(a.modem, a.dr) + getBandwidth(b.modem, b.dr)) / 2.0);
+}
+
+double Simulator::getBandwidth(ModemType_t modem, const DataRate_t& dr) {
+  if(modem == RADIOLIB_MODEM_LORA) {
+    return((double)dr.lora.bandwidth * 1000.0);
+  }
+
+  // Carson bandwidth of the FSK signal
+  return(2.0 * ((double)dr.fsk.freqDev + (double)dr.fsk.bitRate / 2.0) * 1000.0);
+}
@@ -0,0 +1,340 @@
+#ifndef SIMULATOR_H
+#define SIMULATOR_H
+
+#include "SimRadio.h"
+
+#include <stdint.h>
+#include <queue>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+// position in meters
+struct SimPosition {
+  double x;
+  double y;
+};
+
+// log-distance path loss model, with optional log-normal shadowing drawn once per link
+struct SimPathLoss {
+  double d0 = 1.0;
+  double pl0 = 31.2;
+  double gamma = 2.9;
+  double sigma = 0.0;
+};
+
+// reception model
+struct SimReceptionModel {
+  // a packet survives an overlapping one on the same channel and spreading factor if it is stronger by this much
+  double captureDb = 6.0;
+
+  // overlaps that end before this many preamble symbols are left do not destroy the packet
+  uint8_t lockSymbols = 5;
+
+  // noise figure of all receivers
+  double noiseFigure = 6.0;
+};
+
+// one transmission on the shared channel
+struct SimTransmission {
+  uint32_t id;
+
+  // sender, exactly one of these is set
+  int32_t node;
+  int32_t gateway;
+
+  uint32_t freq;
+  ModemType_t modem;
+  DataRate_t dr;
+  bool iqInverted;
+  int8_t power;
+
+  // Class B beacons from all gateways are identical and synchronized, so they do not interfere with each other
+  bool beacon = false;
+
+  // start, end of the part of preamble that can be lost, and end (all in microseconds)
+  uint64_t tStart;
+  uint64_t tLock;
+  uint64_t tEnd;
+
+  std::vector<uint8_t> data;
+};
+
+// copy of a transmission received by one of the gateways
+struct SimReception {
+  uint32_t gateway;
+  float rssi;
+  float snr;
+};
+
+// traffic of a single node
+struct SimNodeConfig {
+  // average uplink period in seconds, actual period is randomized by +-50 %
+  uint32_t period = 600;
+  uint8_t payloadLen = 20;
+  uint8_t fPort = 1;
+  bool confirmed = false;
+
+  // uplink datarate, RADIOLIB_LORAWAN_DATA_RATE_UNUSED to pick the fastest one the link budget allows
+  uint8_t dr = RADIOLIB_LORAWAN_DATA_RATE_UNUSED;
+  int8_t txPower = 14;
+  bool adr = false;
+  bool dutyCycle = false;
+
+  // pick datarate and power on the device using LoRaWANLinkAdapt, only used when ADR is disabled
+  bool linkAdapt = false;
+
+  // track the beacon after activation and switch to Class B with the given ping slot periodicity
+  bool classB = false;
+  uint8_t pingPeriodicity = RADIOLIB_LORAWAN_PING_PERIODICITY_MAX;
+};
+
+// counters of a single node
+struct SimNodeStats {
+  uint32_t uplinks = 0;
+  uint32_t transmissions = 0;
+  uint32_t delivered = 0;
+  uint32_t downlinks = 0;
+  uint32_t dutyCycleBlocked = 0;
+  uint32_t errors = 0;
+
+  // OTAA only, latency is counted from the first JoinRequest to the accepted JoinAccept
+  uint32_t joinAttempts = 0;
+  bool joined = false;
+  uint64_t joinLatency = 0;
+
+  // Class B only, time spent in Class B is counted from the first beacon that was acquired
+  uint32_t beacons = 0;
+  uint32_t beaconSearches = 0;
+  uint32_t beaconLost = 0;
+  uint32_t pingDownlinks = 0;
+  uint32_t pingForeign = 0;
+  uint64_t tClassB = 0;
+};
+
+// network side, receives uplinks decoded by the gateways and may schedule downlinks
+class SimBackend {
+  public:
+    virtual ~SimBackend() = default;
+
+    // called at the end of each uplink that was decoded by at least one gateway
+    // copies lists the gateways that decoded it, and the signal quality at each of them
+    virtual void onUplink(const SimTransmission& tx, const std::vector<SimReception>& copies) = 0;
+
+    // called at the start of each beacon period, if beacons are enabled
+    virtual void onBeacon(uint32_t gpsTime, uint64_t tPeriod) { (void)gpsTime; (void)tPeriod; }
+};
+
+// simulation of LoRaWAN nodes, gateways and the shared radio channel on a virtual clock
+class Simulator {
+  public:
+    Simulator(const LoRaWANBand_t* band, uint8_t subBand, uint32_t seed);
+    ~Simulator();
+
+    // add a gateway, returns its index
+    uint32_t addGateway(SimPosition pos);
+
+    // add a node, returns its index
+    // the LoRaWAN node is created, but not activated
+    uint32_t addNode(SimPosition pos, const SimNodeConfig& cfg);
+
+    // activate node as ABP device and pick the datarate, returns status code from activateABP
+    int16_t activateABP(uint32_t idx, uint32_t devAddr, const uint8_t* nwkSKey, const uint8_t* appSKey);
+
+    // set up node as OTAA device, it joins once started, returns status code from beginOTAA
+    int16_t beginOTAA(uint32_t idx, uint64_t joinEUI, uint64_t devEUI, const uint8_t* nwkKey, const uint8_t* appKey);
+
+    // start sending uplinks from an activated node, the first one at a random time within one period
+    void start(uint32_t idx);
+
+    // run the simulation for the given time
+    void run(uint64_t durationUs);
+
+    // advance the clock from a blocking call, other nodes are stepped unless they would block as well
+    void advance(uint64_t tUs);
+
+    // transmit a downlink from a gateway at the given time
+    void scheduleDownlink(uint32_t gw, uint64_t tUs, uint32_t freq, ModemType_t modem, DataRate_t dr, int8_t power, const uint8_t* data, size_t len);
+
+    // let all gateways transmit the Class B beacon, from the next period boundary of the simulator clock on
+    // gpsEpoch is the GPS time at simulator time 0, rounded down to a whole beacon period
+    void startBeacons(uint32_t gpsEpoch, int8_t power);
+
+    void setBackend(SimBackend* backend) { this->backend = backend; }
+
+    uint64_t now() const { return(this->tNow); }
+    size_t getNumNodes() const { return(this->nodes.size()); }
+    size_t getNumGateways() const { return(this->gateways.size()); }
+    LoRaWANNode* getNode(uint32_t idx) { return(this->nodes[idx]->node); }
+    SimRadio* getRadio(uint32_t idx) { return(this->nodes[idx]->radio); }
+    const SimNodeStats& getStats(uint32_t idx) const { return(this->nodes[idx]->stats); }
+    SimPosition getPosition(uint32_t idx) const { return(this->nodes[idx]->pos); }
+    uint8_t getDatarate(uint32_t idx) const { return(this->nodes[idx]->dr); }
+
+    // path loss from a node to a gateway in dB
+    double getPathLoss(uint32_t node, uint32_t gw) const { return(this->nodes[node]->loss[gw]); }
+
+    // sensitivity and noise floor of the receivers in dBm
+    static double getSensitivity(ModemType_t modem, const DataRate_t& dr);
+    double getNoiseFloor(ModemType_t modem, const DataRate_t& dr) const;
+
+    SimPathLoss pathLoss;
+    SimReceptionModel reception;
+
+    // total number of processed events
+    uint64_t numEvents = 0;
+
+    // number of beacon periods in which the gateways transmitted
+    uint32_t beaconsSent = 0;
+
+    // interface for the emulated radios
+    uint64_t startTransmission(SimRadio* radio, const uint8_t* data, size_t len, RadioLibTime_t toaUs);
+    void startListening(SimRadio* radio);
+    void stopListening(SimRadio* radio);
+    bool isChannelBusy(SimRadio* radio);
+
+  private:
+    // event types, in order of priority at the same time
+    enum SimEventType_t {
+      SIM_EVENT_TX_END = 0,
+      SIM_EVENT_DOWNLINK,
+      SIM_EVENT_BEACON,
+      SIM_EVENT_NODE,
+    };
+
+    struct SimEvent {
+      uint64_t t;
+      uint8_t type;
+      uint64_t seq;
+      uint32_t idx;
+
+      bool operator>(const SimEvent& other) const {
+        if(this->t != other.t) {
+          return(this->t > other.t);
+        }
+        if(this->type != other.type) {
+          return(this->type > other.type);
+        }
+        return(this->seq > other.seq);
+      }
+    };
+
+    struct SimNode {
+      SimPosition pos;
+      SimNodeConfig cfg;
+      SimNodeStats stats;
+      SimHal* hal;
+      SimRadio* radio;
+      LoRaWANNode* node;
+      LoRaWANLinkAdapt* adapt = NULL;
+
+      // path loss to each of the gateways
+      std::vector<double> loss;
+
+      // datarate picked at activation
+      uint8_t dr = RADIOLIB_LORAWAN_DATA_RATE_UNUSED;
+
+      // OTAA device, and time of its first JoinRequest
+      bool otaa = false;
+      uint64_t tJoinStart = 0;
+
+      // the node is only stepped by the event with this time, older events for the node are stale
+      uint64_t tWake = UINT64_MAX;
+      uint64_t tUplink = 0;
+      bool running = false;
+      bool inCycle = false;
+
+      // Class B, time of the next beacon search and whether the node switched to Class B
+      uint64_t tBeaconSearch = 0;
+      bool classB = false;
+
+      uint8_t dataUp[256];
+      uint8_t dataDown[256];
+      size_t lenDown = 0;
+      LoRaWANEvent_t eventUp;
+      LoRaWANEvent_t eventDown;
+    };
+
+    struct SimGateway {
+      SimPosition pos;
+      uint64_t tBusy = 0;
+    };
+
+    // interferer of an active transmission, at each of its receivers
+    struct SimInterferer {
+      int32_t node;
+      int32_t gateway;
+      int8_t power;
+      uint64_t tStart;
+      uint64_t tEnd;
+    };
+
+    // receiver that is decoding an active transmission
+    struct SimListener {
+      bool gateway;
+      uint32_t idx;
+      float rssi;
+      bool lost;
+    };
+
+    struct SimActive {
+      SimTransmission tx;
+      std::vector<SimInterferer> interferers;
+      std::vector<SimListener> listeners;
+    };
+
+    struct SimPendingDownlink {
+      uint32_t gateway;
+      SimTransmission tx;
+    };
+
+    const LoRaWANBand_t* band;
+    uint8_t subBand;
+    std::mt19937 rng;
+    uint64_t tNow = 0;
+    uint64_t seq = 0;
+    uint32_t txId = 0;
+    uint32_t downlinkId = 0;
+    SimBackend* backend = nullptr;
+
+    // beacon source
+    bool beacons = false;
+    uint32_t beaconEpoch = 0;
+    int8_t beaconPower = 14;
+
+    // node that is in a blocking call, -1 if none
+    int32_t blockingNode = -1;
+
+    // node events that came up during the blocking call
+    std::vector<SimEvent> deferred;
+
+    std::vector<SimNode*> nodes;
+    std::vector<SimGateway> gateways;
+    std::vector<SimRadio*> listening;
+    std::unordered_map<uint32_t, SimActive> active;
+    std::unordered_map<uint32_t, SimPendingDownlink> pendingDownlinks;
+    std::priority_queue<SimEvent, std::vector<SimEvent>, std::greater<SimEvent>> events;
+
+    void push(uint64_t t, uint8_t type, uint32_t idx);
+    void wake(uint32_t node, uint64_t tUs);
+    void handle(const SimEvent& ev);
+    void stepNode(uint32_t idx);
+    void stepClassB(uint32_t idx);
+    void wakeIdle(uint32_t idx);
+    void sendBeacon();
+    void joinNode(uint32_t idx);
+    int16_t configureNode(uint32_t idx);
+    bool isBlocked(uint32_t idx);
+    void scheduleNextUplink(SimNode* n);
+    uint8_t pickDatarate(uint32_t idx);
+    void beginTransmission(const SimTransmission& tx);
+    void endTransmission(uint32_t id);
+    SimTransmission makeGatewayTx(uint32_t gw, uint64_t tUs, uint32_t freq, ModemType_t modem, DataRate_t dr, int8_t power,
+                                  bool iqInverted, uint16_t preamble, bool implicit, const uint8_t* data, size_t len);
+    double getLinkLoss(const SimInterferer& from, const SimListener& to) const;
+    double calculatePathLoss(const SimPosition& a, const SimPosition& b) const;
+    static bool isOverlapping(const SimTransmission& a, const SimTransmission& b);
+    static double getBandwidth(ModemType_t modem, const DataRate_t& dr);
+};
+
+#endif
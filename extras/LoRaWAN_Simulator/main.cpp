@@ -0,0 +1,351 @@
+/*
+  RadioLib LoRaWAN network simulator
+
+  Runs many LoRaWANNode instances on emulated radios against a shared
+  simulated channel, on a virtual clock. Nodes are activated as ABP devices,
+  or join over the air, and send uplinks using the non-blocking Class A cycle.
+  The channel models path loss, collisions on the same channel and spreading
+  factor, and the capture effect. Uplinks decoded by the gateways go to an
+  in-process network server, which checks them, answers MAC commands, runs ADR
+  and sends downlinks back through the simulated channel. With Class B enabled,
+  the gateways also send beacons, the nodes track them and the network server
+  sends application downlinks in their ping slots. At the end, packet
+  delivery ratio, airtime and energy are reported for the whole network,
+  and optionally per node, along with join latency and network server load.
+
+  Usage: lorawan-sim [options]
+    --nodes N         number of nodes (default 100)
+    --gateways N      number of gateways (default 1)
+    --hours H         simulated time in hours (default 1)
+    --period S        average uplink period in seconds (default 600)
+    --payload N       application payload length in bytes (default 20)
+    --radius M        radius of the deployment area in meters (default 2000)
+    --band NAME       EU868 or US915 (default EU868)
+    --dr N            fixed uplink datarate, by default picked from link budget
+    --duty-cycle      enforce regulatory duty cycle
+    --otaa            join over the air instead of ABP activation
+    --lw11            use LoRaWAN 1.1 keys when joining (only with --otaa)
+    --adr             enable adaptive datarate
+    --link-adapt      pick datarate and power on the device instead (ignored with --adr)
+    --confirmed       send confirmed uplinks
+    --class-b         track beacons and switch to Class B after activation
+    --ping-periodicity N  ping slot periodicity 0 - 7 (default 7, every 128 s)
+    --ping-period S   average period of Class B downlinks to each node in seconds (default 300)
+    --gamma G         path loss exponent (default 2.9)
+    --sigma S         shadowing standard deviation in dB (default 0)
+    --seed N          random seed (default 1)
+    --csv FILE        write per-node results to a CSV file
+*/
+
+#include "Simulator.h"
+#include "NetworkServer.h"
+
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct SimOptions {
+  uint32_t nodes = 100;
+  uint32_t gateways = 1;
+  double hours = 1.0;
+  uint32_t period = 600;
+  uint8_t payload = 20;
+  double radius = 2000.0;
+  const LoRaWANBand_t* band = &EU868;
+  uint8_t subBand = 0;
+  uint8_t dr = RADIOLIB_LORAWAN_DATA_RATE_UNUSED;
+  bool dutyCycle = false;
+  bool otaa = false;
+  bool lw11 = false;
+  bool adr = false;
+  bool linkAdapt = false;
+  bool confirmed = false;
+  bool classB = false;
+  uint8_t pingPeriodicity = RADIOLIB_LORAWAN_PING_PERIODICITY_MAX;
+  uint32_t pingPeriod = 300;
+  double gamma = 2.9;
+  double sigma = 0.0;
+  uint32_t seed = 1;
+  const char* csv = NULL;
+};
+
+static void usage(const char* name) {
+  fprintf(stderr, "Usage: %s [--nodes N] [--gateways N] [--hours H] [--period S] [--payload N] [--radius M]\n", name);
+  fprintf(stderr, "       [--band EU868|US915] [--dr N] [--duty-cycle] [--otaa] [--lw11] [--adr] [--link-adapt] [--confirmed]\n");
+  fprintf(stderr, "       [--class-b] [--ping-periodicity N] [--ping-period S]\n");
+  fprintf(stderr, "       [--gamma G] [--sigma S] [--seed N] [--csv FILE]\n");
+}
+
+static bool parseArgs(int argc, char** argv, SimOptions& opt) {
+  for(int i = 1; i < argc; i++) {
+    const char* arg = argv[i];
+    if(strcmp(arg, "--duty-cycle") == 0) {
+      opt.dutyCycle = true;
+      continue;
+    } else if(strcmp(arg, "--otaa") == 0) {
+      opt.otaa = true;
+      continue;
+    } else if(strcmp(arg, "--lw11") == 0) {
+      opt.lw11 = true;
+      continue;
+    } else if(strcmp(arg, "--adr") == 0) {
+      opt.adr = true;
+      continue;
+    } else if(strcmp(arg, "--link-adapt") == 0) {
+      opt.linkAdapt = true;
+      continue;
+    } else if(strcmp(arg, "--confirmed") == 0) {
+      opt.confirmed = true;
+      continue;
+    } else if(strcmp(arg, "--class-b") == 0) {
+      opt.classB = true;
+      continue;
+    }
+
+    // everything else takes a value
+    if(i + 1 >= argc) {
+      return(false);
+    }
+    const char* val = argv[++i];
+    if(strcmp(arg, "--nodes") == 0) {
+      opt.nodes = strtoul(val, NULL, 0);
+    } else if(strcmp(arg, "--gateways") == 0) {
+      opt.gateways = strtoul(val, NULL, 0);
+    } else if(strcmp(arg, "--hours") == 0) {
+      opt.hours = strtod(val, NULL);
+    } else if(strcmp(arg, "--period") == 0) {
+      opt.period = strtoul(val, NULL, 0);
+    } else if(strcmp(arg, "--payload") == 0) {
+      opt.payload = strtoul(val, NULL, 0);
+    } else if(strcmp(arg, "--radius") == 0) {
+      opt.radius = strtod(val, NULL);
+    } else if(strcmp(arg, "--band") == 0) {
+      if(strcmp(val, "EU868") == 0) {
+        opt.band = &EU868;
+        opt.subBand = 0;
+      } else if(strcmp(val, "US915") == 0) {
+        opt.band = &US915;
+        opt.subBand = 2;
+      } else {
+        return(false);
+      }
+    } else if(strcmp(arg, "--dr") == 0) {
+      opt.dr = strtoul(val, NULL, 0);
+    } else if(strcmp(arg, "--gamma") == 0) {
+      opt.gamma = strtod(val, NULL);
+    } else if(strcmp(arg, "--sigma") == 0) {
+      opt.sigma = strtod(val, NULL);
+    } else if(strcmp(arg, "--seed") == 0) {
+      opt.seed = strtoul(val, NULL, 0);
+    } else if(strcmp(arg, "--ping-periodicity") == 0) {
+      opt.pingPeriodicity = strtoul(val, NULL, 0);
+    } else if(strcmp(arg, "--ping-period") == 0) {
+      opt.pingPeriod = strtoul(val, NULL, 0);
+    } else if(strcmp(arg, "--csv") == 0) {
+      opt.csv = val;
+    } else {
+      return(false);
+    }
+  }
+
+  return((opt.nodes > 0) && (opt.gateways > 0) && (opt.period > 0) && (opt.payload > 0) &&
+         (opt.pingPeriodicity <= RADIOLIB_LORAWAN_PING_PERIODICITY_MAX));
+}
+
+// uniformly distributed point in a disc
+static SimPosition randomPosition(std::mt19937& rng, double radius) {
+  std::uniform_real_distribution<double> uni(0.0, 1.0);
+  double r = radius * sqrt(uni(rng));
+  double phi = 2.0 * M_PI * uni(rng);
+  SimPosition pos = { r * cos(phi), r * sin(phi) };
+  return(pos);
+}
+
+int main(int argc, char** argv) {
+  SimOptions opt;
+  if(!parseArgs(argc, argv, opt)) {
+    usage(argv[0]);
+    return(1);
+  }
+
+  // LoRaWANNode uses rand() for retransmission backoff
+  srand(opt.seed);
+  std::mt19937 rng(opt.seed);
+
+  Simulator sim(opt.band, opt.subBand, opt.seed);
+  sim.pathLoss.gamma = opt.gamma;
+  sim.pathLoss.sigma = opt.sigma;
+
+  NetworkServer server(&sim, opt.band, opt.subBand);
+  server.adrEnabled = opt.adr;
+  sim.setBackend(&server);
+  if(opt.classB) {
+    if(opt.band->beacon.freqStart == 0) {
+      fprintf(stderr, "Class B is not supported in this band\n");
+      return(1);
+    }
+    server.classBDownlinkPeriod = opt.pingPeriod;
+  }
+
+  // first gateway in the middle, the rest spread around
+  for(uint32_t i = 0; i < opt.gateways; i++) {
+    SimPosition pos = { 0, 0 };
+    if(i > 0) {
+      pos = randomPosition(rng, opt.radius);
+    }
+    sim.addGateway(pos);
+  }
+
+  SimNodeConfig cfg;
+  cfg.period = opt.period;
+  cfg.payloadLen = opt.payload;
+  cfg.dr = opt.dr;
+  cfg.dutyCycle = opt.dutyCycle;
+  cfg.adr = opt.adr;
+  cfg.linkAdapt = opt.linkAdapt;
+  cfg.confirmed = opt.confirmed;
+  cfg.classB = opt.classB;
+  cfg.pingPeriodicity = opt.pingPeriodicity;
+  for(uint32_t i = 0; i < opt.nodes; i++) {
+    uint32_t idx = sim.addNode(randomPosition(rng, opt.radius), cfg);
+
+    // keys only have to be unique, the same ones are given to the network server
+    uint8_t key0[16];
+    uint8_t key1[16];
+    for(uint8_t j = 0; j < 16; j++) {
+      key0[j] = (uint8_t)(idx >> (8 * (j % 4))) ^ j;
+      key1[j] = key0[j] ^ 0xA5;
+    }
+
+    int16_t state = RADIOLIB_ERR_NONE;
+    if(opt.otaa) {
+      uint64_t joinEUI = 0x0000000000000001ULL;
+      uint64_t devEUI = 0x70B3D57ED0000000ULL + idx;
+      const uint8_t* nwkKey = opt.lw11 ? key0 : NULL;
+      const uint8_t* appKey = opt.lw11 ? key1 : key0;
+      server.addOTAA(joinEUI, devEUI, nwkKey, appKey);
+      state = sim.beginOTAA(idx, joinEUI, devEUI, nwkKey, appKey);
+    } else {
+      uint32_t devAddr = 0x26000000UL + idx;
+      server.addABP(devAddr, NULL, NULL, key0, key1);
+      state = sim.activateABP(idx, devAddr, key0, key1);
+    }
+    if(state != RADIOLIB_ERR_NONE) {
+      fprintf(stderr, "Node %lu failed to activate, code %d\n", (unsigned long)idx, state);
+      return(1);
+    }
+    sim.start(idx);
+  }
+
+  // GPS time of the first beacon, any multiple of the beacon period will do
+  if(opt.classB) {
+    sim.startBeacons(1400000000UL, opt.band->powerMax);
+  }
+
+  printf("Simulating %lu nodes, %lu gateways for %.2f h\n", (unsigned long)opt.nodes, (unsigned long)opt.gateways, opt.hours);
+  auto tStart = std::chrono::steady_clock::now();
+  uint64_t duration = (uint64_t)(opt.hours * 3600.0 * 1000000.0);
+  sim.run(duration);
+  double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - tStart).count();
+
+  FILE* csv = NULL;
+  if(opt.csv) {
+    csv = fopen(opt.csv, "w");
+    if(!csv) {
+      fprintf(stderr, "Failed to open %s\n", opt.csv);
+      return(1);
+    }
+    fprintf(csv, "node,x,y,dr,uplinks,transmissions,delivered,pdr,downlinks,duty_cycle_blocked,errors,join_attempts,join_latency_ms,beacons,ping_downlinks,airtime_ms,energy_mJ\n");
+  }
+
+  uint64_t uplinks = 0, transmissions = 0, delivered = 0, downlinks = 0, blocked = 0, errors = 0, airtime = 0;
+  uint64_t joined = 0, joinAttempts = 0, joinLatency = 0, joinLatencyMax = 0;
+  uint64_t beacons = 0, beaconSearches = 0, beaconLost = 0, pingDownlinks = 0, pingForeign = 0, classBNodes = 0;
+  double energy = 0;
+  for(uint32_t i = 0; i < sim.getNumNodes(); i++) {
+    const SimNodeStats& st = sim.getStats(i);
+    SimRadio* radio = sim.getRadio(i);
+    uplinks += st.uplinks;
+    transmissions += st.transmissions;
+    delivered += st.delivered;
+    downlinks += st.downlinks;
+    blocked += st.dutyCycleBlocked;
+    errors += st.errors;
+    airtime += radio->txAirtime;
+    energy += radio->energy_mJ;
+    joinAttempts += st.joinAttempts;
+    if(st.joined) {
+      joined++;
+      joinLatency += st.joinLatency;
+      joinLatencyMax = RADIOLIB_MAX(joinLatencyMax, st.joinLatency);
+    }
+    beacons += st.beacons;
+    beaconSearches += st.beaconSearches;
+    beaconLost += st.beaconLost;
+    pingDownlinks += st.pingDownlinks;
+    pingForeign += st.pingForeign;
+    if(st.tClassB) {
+      classBNodes++;
+    }
+
+    if(csv) {
+      SimPosition pos = sim.getPosition(i);
+      double pdr = st.transmissions ? (double)st.delivered / (double)st.transmissions : 0;
+      fprintf(csv, "%lu,%.1f,%.1f,%u,%lu,%lu,%lu,%.4f,%lu,%lu,%lu,%lu,%.3f,%lu,%lu,%.3f,%.3f\n",
+              (unsigned long)i, pos.x, pos.y, sim.getDatarate(i),
+              (unsigned long)st.uplinks, (unsigned long)st.transmissions, (unsigned long)st.delivered, pdr,
+              (unsigned long)st.downlinks, (unsigned long)st.dutyCycleBlocked, (unsigned long)st.errors,
+              (unsigned long)st.joinAttempts, st.joined ? (double)st.joinLatency / 1000.0 : 0.0,
+              (unsigned long)st.beacons, (unsigned long)st.pingDownlinks,
+              (double)radio->txAirtime / 1000.0, radio->energy_mJ);
+    }
+  }
+  if(csv) {
+    fclose(csv);
+  }
+
+  double simTime = (double)duration / 1000000.0;
+  printf("Uplinks:        %llu (%llu transmissions)\n", (unsigned long long)uplinks, (unsigned long long)transmissions);
+  printf("Delivered:      %llu\n", (unsigned long long)delivered);
+  printf("PDR:            %.2f %%\n", transmissions ? 100.0 * (double)delivered / (double)transmissions : 0.0);
+  printf("Downlinks:      %llu received by nodes\n", (unsigned long long)downlinks);
+  printf("Blocked by DC:  %llu\n", (unsigned long long)blocked);
+  printf("Errors:         %llu\n", (unsigned long long)errors);
+  printf("Airtime:        %.3f s total, %.3f %% channel load per node\n", (double)airtime / 1000000.0,
+         100.0 * (double)airtime / 1000000.0 / simTime / (double)sim.getNumNodes());
+  printf("Energy:         %.3f J total, %.3f mJ per node\n", energy / 1000.0, energy / (double)sim.getNumNodes());
+  if(opt.otaa) {
+    printf("Joined:         %llu of %lu (%llu attempts)\n", (unsigned long long)joined, (unsigned long)opt.nodes, (unsigned long long)joinAttempts);
+    printf("Join latency:   %.3f s average, %.3f s max\n", joined ? (double)joinLatency / (double)joined / 1000000.0 : 0.0,
+           (double)joinLatencyMax / 1000000.0);
+  }
+  if(opt.classB) {
+    printf("Beacons:        %lu sent, %llu received, %llu searches, %llu lost\n", (unsigned long)sim.beaconsSent,
+           (unsigned long long)beacons, (unsigned long long)beaconSearches, (unsigned long long)beaconLost);
+    printf("Class B:        %llu of %lu nodes, %llu ping slot downlinks received, %llu for other nodes\n", (unsigned long long)classBNodes,
+           (unsigned long)opt.nodes, (unsigned long long)pingDownlinks, (unsigned long long)pingForeign);
+  }
+
+  const NsStats& ns = server.stats;
+  uint32_t frames = ns.joinRequests + ns.uplinks + ns.duplicates + ns.micFailures + ns.unknownDevices + ns.malformed;
+  printf("Server:         %lu uplinks, %lu joins accepted, %lu duplicates, %lu MIC failures, %lu unknown, %lu malformed\n",
+         (unsigned long)ns.uplinks, (unsigned long)ns.joinAccepts, (unsigned long)ns.duplicates,
+         (unsigned long)ns.micFailures, (unsigned long)ns.unknownDevices, (unsigned long)ns.malformed);
+  printf("Server MAC:     %lu commands up, %lu down, %lu ADR requests (%lu accepted), %lu downlinks sent\n",
+         (unsigned long)ns.macCommandsUp, (unsigned long)ns.macCommandsDown, (unsigned long)ns.adrRequests,
+         (unsigned long)ns.adrAccepted, (unsigned long)ns.downlinks);
+  if(opt.classB) {
+    printf("Server Class B: %lu downlinks queued, %lu sent, %.3f s average latency, %.3f s max\n",
+           (unsigned long)ns.pingQueued, (unsigned long)ns.pingSent,
+           ns.pingSent ? (double)ns.pingLatency / (double)ns.pingSent / 1000000.0 : 0.0, (double)ns.pingLatencyMax / 1000000.0);
+  }
+  printf("Server load:    %.3f uplinks/s simulated, %.3f us per frame, %.0f frames/s capacity\n",
+         (double)ns.uplinks / simTime, frames ? (double)ns.processingNs / (double)frames / 1000.0 : 0.0,
+         ns.processingNs ? (double)frames * 1e9 / (double)ns.processingNs : 0.0);
+  printf("Events:         %llu\n", (unsigned long long)sim.numEvents);
+  printf("Wall time:      %.3f s (%.0fx real time)\n", wall, wall > 0 ? simTime / wall : 0.0);
+
+  return(0);
+}
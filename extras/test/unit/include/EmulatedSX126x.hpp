@@ -0,0 +1,136 @@
+#ifndef EMULATED_SX126X_HPP
+#define EMULATED_SX126X_HPP
+
+#include <map>
+#include <string.h>
+#include <vector>
+
+#include <RadioLib.h>
+
+#include "HardwareEmulation.hpp"
+
+// status byte returned by the emulated SX126x, STDBY_RC mode and command processed
+#define EMULATED_SX126X_STATUS    (0x24)
+
+// SX126x with register memory, that remembers the last parameters of each SPI command
+// command execution is not emulated, except for the few commands needed to read the state back
+class EmulatedSX126x : public EmulatedRadio {
+  public:
+    // register memory, indexed by 16-bit address
+    std::vector<uint8_t> regs;
+
+    // parameters of the last transaction of each command
+    std::map<uint8_t, std::vector<uint8_t>> cmds;
+
+    // value reported by GetPacketType
+    uint8_t packetType = 0;
+
+    // interrupt flags, the IRQ pin is high while any of them is set
+    uint16_t irqStatus = 0;
+
+    // result of SetCad: whether activity is detected, and whether the CAD finishes at all
+    bool cadDetected = false;
+    bool cadHangs = false;
+
+    // opcode of the last transaction
+    uint8_t lastOpcode = 0;
+
+    EmulatedSX126x() : regs(0x10000, 0x00) {
+      this->powerUp();
+    }
+
+    // lose all configuration, as when waking up from a cold sleep
+    void powerUp() {
+      std::fill(this->regs.begin(), this->regs.end(), 0x00);
+      memcpy(&this->regs[RADIOLIB_SX126X_REG_VERSION_STRING], "SX1261 V2D 2D02", 16);
+      this->cmds.clear();
+      this->packetType = 0;
+      this->irqStatus = 0;
+      this->lastOpcode = 0;
+      if(this->irq) {
+        this->irq->value = 0;
+      }
+    }
+
+    uint8_t HandleSPI(uint8_t b) override {
+      uint8_t out = EMULATED_SX126X_STATUS;
+      if(this->pos == 0) {
+        this->opcode = b;
+      } else {
+        this->params.push_back(b);
+        switch(this->opcode) {
+          case(RADIOLIB_SX126X_CMD_WRITE_REGISTER):
+            if(this->pos >= 3) {
+              this->regs[this->getAddr() + this->pos - 3] = b;
+            }
+            break;
+          case(RADIOLIB_SX126X_CMD_READ_REGISTER):
+            if(this->pos >= 4) {
+              out = this->regs[this->getAddr() + this->pos - 4];
+            }
+            break;
+          case(RADIOLIB_SX126X_CMD_GET_PACKET_TYPE):
+            if(this->pos == 2) {
+              out = this->packetType;
+            }
+            break;
+          case(RADIOLIB_SX126X_CMD_GET_IRQ_STATUS):
+            if(this->pos == 2) {
+              out = (uint8_t)(this->irqStatus >> 8);
+            } else if(this->pos == 3) {
+              out = (uint8_t)this->irqStatus;
+            }
+            break;
+          default:
+            break;
+        }
+      }
+      this->pos++;
+      return(out);
+    }
+
+    void HandleGPIO() override {
+      if(!this->cs->event) {
+        return;
+      }
+
+      // new transaction on falling edge, execute it on rising edge
+      if(this->cs->value == 0) {
+        this->pos = 0;
+        this->params.clear();
+        return;
+      }
+      if(this->pos == 0) {
+        return;
+      }
+      this->cmds[this->opcode] = this->params;
+      this->lastOpcode = this->opcode;
+      switch(this->opcode) {
+        case(RADIOLIB_SX126X_CMD_SET_PACKET_TYPE):
+          this->packetType = this->params[0];
+          break;
+        case(RADIOLIB_SX126X_CMD_CLEAR_IRQ_STATUS):
+          this->irqStatus &= ~(((uint16_t)this->params[0] << 8) | this->params[1]);
+          break;
+        case(RADIOLIB_SX126X_CMD_SET_CAD):
+          if(!this->cadHangs) {
+            this->irqStatus |= RADIOLIB_SX126X_IRQ_CAD_DONE | (this->cadDetected ? RADIOLIB_SX126X_IRQ_CAD_DETECTED : 0);
+          }
+          break;
+        default:
+          break;
+      }
+      this->irq->value = (this->irqStatus != 0);
+    }
+
+  private:
+    size_t pos = 0;
+    uint8_t opcode = 0;
+    std::vector<uint8_t> params;
+
+    uint16_t getAddr() const {
+      return(((uint16_t)this->params[0] << 8) | this->params[1]);
+    }
+};
+
+#endif
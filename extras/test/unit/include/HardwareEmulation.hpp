@@ -62,10 +62,10 @@ class EmulatedRadio {
   protected:
     // pointers to emulated GPIO pins
     // this is done via pointers so that the same GPIO entity is shared, like with a real hardware
-    EmulatedPin_t* cs;
-    EmulatedPin_t* irq;
-    EmulatedPin_t* rst;
-    EmulatedPin_t* gpio;
+    EmulatedPin_t* cs = nullptr;
+    EmulatedPin_t* irq = nullptr;
+    EmulatedPin_t* rst = nullptr;
+    EmulatedPin_t* gpio = nullptr;
 };
 
 #endif
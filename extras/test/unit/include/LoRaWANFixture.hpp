@@ -0,0 +1,21 @@
+#ifndef LORAWAN_FIXTURE_HPP
+#define LORAWAN_FIXTURE_HPP
+
+#include <RadioLib.h>
+
+#include "StubRadio.hpp"
+
+// ABP session used by the LoRaWAN tests
+#define LORAWAN_FIXTURE_DEV_ADDR    (0x26011234UL)
+
+static const uint8_t nwkSKey[16] = { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0x10 };
+static const uint8_t appSKey[16] = { 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20 };
+
+// start a new ABP session on a node
+static inline int16_t activateFixture(LoRaWANNode& node) {
+  node.beginABP(LORAWAN_FIXTURE_DEV_ADDR, NULL, NULL, nwkSKey, appSKey);
+  (void)node.getBufferNonces();
+  return(node.activateABP());
+}
+
+#endif
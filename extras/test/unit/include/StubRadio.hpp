@@ -0,0 +1,35 @@
+#ifndef STUB_RADIO_HPP
+#define STUB_RADIO_HPP
+
+#include <RadioLib.h>
+
+#include <vector>
+
+// radio without any hardware behind it, for protocol code that only needs the PhysicalLayer interface
+// it accepts any configuration, and keeps whatever it was asked to transmit so that it can be fed back to a receiver
+class StubRadio : public PhysicalLayer {
+  public:
+    std::vector<uint8_t> sent;
+
+    int16_t transmit(const uint8_t* data, size_t len, uint8_t addr) override {
+      (void)addr;
+      this->sent.assign(data, data + len);
+      return(RADIOLIB_ERR_NONE);
+    }
+
+    int16_t setEncoding(uint8_t encoding) override { (void)encoding; return(RADIOLIB_ERR_NONE); }
+    int16_t setDataShaping(uint8_t sh) override { (void)sh; return(RADIOLIB_ERR_NONE); }
+    int16_t setFrequencyDeviation(float freqDev) override { (void)freqDev; return(RADIOLIB_ERR_NONE); }
+    int16_t checkDataRate(DataRate_t dr, ModemType_t modem) override { (void)dr; (void)modem; return(RADIOLIB_ERR_NONE); }
+    int16_t checkOutputPower(int8_t power, int8_t* clipped) override {
+      if(clipped) {
+        *clipped = power;
+      }
+      return(RADIOLIB_ERR_NONE);
+    }
+
+  private:
+    Module* getMod() override { return(nullptr); }
+};
+
+#endif
@@ -247,6 +247,12 @@ class TestHal : public RadioLibHal {
       this->spiLogPtr = this->spiLog;
     }
 
+    // method to read back the level the library drove an output pin to
+    uint32_t outputValue(uint32_t pin) const {
+      BOOST_ASSERT_MSG(pin < TEST_HAL_NUM_GPIO_PINS, "Pin number out of range");
+      return(this->gpio[pin].value);
+    }
+
     // method that "connects" the emualted radio hardware to this HAL
     void connectRadio(EmulatedRadio* r) {
       this->radio = r;
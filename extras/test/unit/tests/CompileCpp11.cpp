@@ -0,0 +1,35 @@
+// not a test case, only checks that the library headers and the way the examples
+// declare radio instances still compile with C++11, as used by many Arduino cores
+#include <RadioLib.h>
+
+// HAL that does nothing, TestHal needs a newer standard
+class Cpp11Hal : public RadioLibHal {
+  public:
+    Cpp11Hal() : RadioLibHal(0, 1, 0, 1, 1, 2) {}
+
+    void pinMode(uint32_t pin, uint32_t mode) override { (void)pin; (void)mode; }
+    void digitalWrite(uint32_t pin, uint32_t value) override { (void)pin; (void)value; }
+    uint32_t digitalRead(uint32_t pin) override { (void)pin; return(0); }
+    void attachInterrupt(uint32_t interruptNum, void (*interruptCb)(void), uint32_t mode) override { (void)interruptNum; (void)interruptCb; (void)mode; }
+    void detachInterrupt(uint32_t interruptNum) override { (void)interruptNum; }
+    void delay(RadioLibTime_t ms) override { (void)ms; }
+    void delayMicroseconds(RadioLibTime_t us) override { (void)us; }
+    RadioLibTime_t millis() override { return(0); }
+    RadioLibTime_t micros() override { return(0); }
+    long pulseIn(uint32_t pin, uint32_t state, RadioLibTime_t timeout) override { (void)pin; (void)state; (void)timeout; return(0); }
+    void spiBegin() override {}
+    void spiBeginTransaction() override {}
+    void spiTransfer(uint8_t* out, size_t len, uint8_t* in) override { (void)out; (void)len; (void)in; }
+    void spiEndTransaction() override {}
+    void spiEnd() override {}
+};
+
+static Cpp11Hal hal;
+
+// copy-initialization from a Module pointer, as in the examples and the README
+SX1262 sx1262 = new Module(&hal, 10, 2, 3, 9);
+SX1278 sx1278 = new Module(&hal, 10, 2, 9, 3);
+SX1280 sx1280 = new Module(&hal, 10, 2, 3, 9);
+LR1110 lr1110 = new Module(&hal, 10, 2, 3, 9);
+CC1101 cc1101 = new Module(&hal, 10, 2, RADIOLIB_NC, 3);
+RF69 rf69 = new Module(&hal, 10, 2, 3);
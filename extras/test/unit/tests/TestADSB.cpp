@@ -0,0 +1,264 @@
+// boost test header
+#include <boost/test/unit_test.hpp>
+
+// the ADS-B header
+#include "protocols/ADSB/ADSB.h"
+#include "protocols/ADSB/ADSBTracker.h"
+#include "StubRadio.hpp"
+
+#include <string.h>
+#include <vector>
+
+// aircraft identification "KLM1023"
+static const uint8_t frameId[RADIOLIB_ADSB_FRAME_LEN_BYTES] = {
+  0x8D, 0x48, 0x40, 0xD6, 0x20, 0x2C, 0xC3, 0x71, 0xC3, 0x2C, 0xE0, 0x57, 0x60, 0x98
+};
+
+// airborne position, even frame
+static const uint8_t framePos[RADIOLIB_ADSB_FRAME_LEN_BYTES] = {
+  0x8D, 0x40, 0x62, 0x1D, 0x58, 0xC3, 0x82, 0xD6, 0x90, 0xC8, 0xAC, 0x28, 0x63, 0xA7
+};
+
+// airborne position, odd frame of the same aircraft
+static const uint8_t framePosOdd[RADIOLIB_ADSB_FRAME_LEN_BYTES] = {
+  0x8D, 0x40, 0x62, 0x1D, 0x58, 0xC3, 0x86, 0x43, 0x5C, 0xC4, 0x12, 0x69, 0x2A, 0xD6
+};
+
+// airborne velocity, ground speed
+static const uint8_t frameVelGnd[RADIOLIB_ADSB_FRAME_LEN_BYTES] = {
+  0x8D, 0x48, 0x50, 0x20, 0x99, 0x44, 0x09, 0x94, 0x08, 0x38, 0x17, 0x5B, 0x28, 0x4F
+};
+
+// airborne velocity, airspeed
+static const uint8_t frameVelAir[RADIOLIB_ADSB_FRAME_LEN_BYTES] = {
+  0x8D, 0xA0, 0x5F, 0x21, 0x9B, 0x06, 0xB6, 0xAF, 0x18, 0x94, 0x00, 0xCB, 0xC3, 0x3F
+};
+
+static void flipBit(uint8_t* frame, int pos) {
+  frame[pos / 8] ^= 0x80 >> (pos % 8);
+}
+
+BOOST_AUTO_TEST_SUITE(suite_ADSB)
+
+BOOST_AUTO_TEST_CASE(ADSB_Parity) {
+  BOOST_TEST_MESSAGE("--- Test ADS-B CRC-24 check and correction ---");
+
+  StubRadio radio;
+  ADSBClient adsb(&radio);
+
+  // parity field is the CRC of the rest of the frame
+  BOOST_TEST(ADSBClient::crc24(frameId, RADIOLIB_ADSB_FRAME_DATA_LEN_BYTES) == 0x576098UL);
+  BOOST_TEST(ADSBClient::crc24(framePos, RADIOLIB_ADSB_FRAME_DATA_LEN_BYTES) == 0x2863A7UL);
+
+  BOOST_TEST(adsb.setParityCheck(true, 3) == RADIOLIB_ERR_INVALID_CRC_CONFIGURATION);
+  BOOST_TEST(adsb.setParityCheck(true, 1) == RADIOLIB_ERR_NONE);
+  uint8_t frame[RADIOLIB_ADSB_FRAME_LEN_BYTES];
+  uint8_t numErrors = 0xFF;
+  memcpy(frame, frameId, sizeof(frame));
+  BOOST_TEST(adsb.checkParity(frame, &numErrors) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(numErrors == 0);
+
+  // every single bit error outside of the downlink format is corrected
+  for(int i = 0; i < RADIOLIB_ADSB_FRAME_LEN_BITS; i++) {
+    memcpy(frame, frameId, sizeof(frame));
+    flipBit(frame, i);
+    int16_t state = adsb.checkParity(frame, &numErrors);
+    if(i < 5) {
+      BOOST_TEST(state == RADIOLIB_ERR_CRC_MISMATCH);
+    } else {
+      BOOST_TEST(state == RADIOLIB_ERR_NONE);
+      BOOST_TEST(numErrors == 1);
+      BOOST_TEST(memcmp(frame, frameId, sizeof(frame)) == 0);
+    }
+  }
+
+  // double errors are only corrected when enabled
+  memcpy(frame, framePos, sizeof(frame));
+  flipBit(frame, 20);
+  flipBit(frame, 100);
+  BOOST_TEST(adsb.checkParity(frame) == RADIOLIB_ERR_CRC_MISMATCH);
+  BOOST_TEST(adsb.setParityCheck(true, 2) == RADIOLIB_ERR_NONE);
+  for(int i = 5; i < RADIOLIB_ADSB_FRAME_LEN_BITS; i += 3) {
+    for(int j = i + 1; j < RADIOLIB_ADSB_FRAME_LEN_BITS; j += 7) {
+      memcpy(frame, framePos, sizeof(frame));
+      flipBit(frame, i);
+      flipBit(frame, j);
+      BOOST_TEST(adsb.checkParity(frame, &numErrors) == RADIOLIB_ERR_NONE);
+      BOOST_TEST(numErrors == 2);
+      BOOST_TEST(memcmp(frame, framePos, sizeof(frame)) == 0);
+    }
+  }
+
+  // frames other than extended squitter are only checked
+  memcpy(frame, frameId, sizeof(frame));
+  frame[0] = (11 << 3);
+  frame[5] ^= 0x01;
+  BOOST_TEST(adsb.checkParity(frame) == RADIOLIB_ERR_CRC_MISMATCH);
+}
+
+BOOST_AUTO_TEST_CASE(ADSB_Bulk) {
+  BOOST_TEST_MESSAGE("--- Test ADS-B bulk decoding ---");
+
+  StubRadio radio;
+  ADSBClient adsb(&radio);
+
+  // valid, corrupted beyond repair, single error
+  std::vector<uint8_t> raw(frameId, frameId + RADIOLIB_ADSB_FRAME_LEN_BYTES);
+  raw.insert(raw.end(), framePos, framePos + RADIOLIB_ADSB_FRAME_LEN_BYTES);
+  raw.insert(raw.end(), framePos, framePos + RADIOLIB_ADSB_FRAME_LEN_BYTES);
+  flipBit(&raw[RADIOLIB_ADSB_FRAME_LEN_BYTES], 40);
+  flipBit(&raw[RADIOLIB_ADSB_FRAME_LEN_BYTES], 41);
+  flipBit(&raw[RADIOLIB_ADSB_FRAME_LEN_BYTES], 90);
+  flipBit(&raw[2*RADIOLIB_ADSB_FRAME_LEN_BYTES], 60);
+
+  // without parity check, everything is passed through as before
+  ADSBFrame frames[3];
+  BOOST_TEST(adsb.decode(raw.data(), 3, frames) == 3);
+
+  BOOST_TEST(adsb.setParityCheck(true) == RADIOLIB_ERR_NONE);
+  BOOST_REQUIRE(adsb.decode(raw.data(), 3, frames) == 2);
+  char id[RADIOLIB_ADSB_HEX_ID_LEN];
+  char callsign[RADIOLIB_ADSB_CALLSIGN_LEN];
+  BOOST_TEST(frames[0].numErrors == 0);
+  BOOST_TEST(adsb.parseHexId(&frames[0], id) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(strcmp(id, "4840D6") == 0);
+  BOOST_TEST(adsb.parseCallsign(&frames[0], callsign) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(strncmp(callsign, "KLM1023", 7) == 0);
+  BOOST_TEST(frames[1].numErrors == 1);
+  BOOST_TEST((frames[1].messageType == ADSBMessageType::AIRBORNE_POS_ALT_BARO));
+  BOOST_TEST(memcmp(frames[1].message, &framePos[RADIOLIB_ADSB_FRAME_MESSAGE_POS], RADIOLIB_ADSB_FRAME_MESSAGE_LEN_BYTES) == 0);
+}
+
+BOOST_AUTO_TEST_CASE(ADSB_Velocity) {
+  BOOST_TEST_MESSAGE("--- Test ADS-B velocity and CPR decoding ---");
+
+  StubRadio radio;
+  ADSBClient adsb(&radio);
+  ADSBFrame frame;
+  float speed = 0;
+  float heading = 0;
+  int verticalRate = 0;
+  bool airspeed = true;
+
+  BOOST_REQUIRE(adsb.decode(frameVelGnd, &frame) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(adsb.parseAirborneVelocity(&frame, &speed, &heading, &verticalRate, &airspeed) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(speed == 159.20f, boost::test_tools::tolerance(0.001f));
+  BOOST_TEST(heading == 182.88f, boost::test_tools::tolerance(0.001f));
+  BOOST_TEST(verticalRate == -832);
+  BOOST_TEST(!airspeed);
+
+  BOOST_REQUIRE(adsb.decode(frameVelAir, &frame) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(adsb.parseAirborneVelocity(&frame, &speed, &heading, &verticalRate, &airspeed) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(speed == 375.0f);
+  BOOST_TEST(heading == 243.98f, boost::test_tools::tolerance(0.001f));
+  BOOST_TEST(verticalRate == -2304);
+  BOOST_TEST(airspeed);
+
+  // position frames are not velocity frames
+  BOOST_REQUIRE(adsb.decode(framePos, &frame) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(adsb.parseAirborneVelocity(&frame, &speed, NULL, NULL) == RADIOLIB_ERR_ADSB_INVALID_MSG_TYPE);
+
+  // global position from an even and odd pair, calculated for the even one as it is the more recent one
+  uint32_t latCpr[2];
+  uint32_t lonCpr[2];
+  bool odd = true;
+  BOOST_TEST(ADSBClient::parseCpr(&frame, &latCpr[0], &lonCpr[0], &odd) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(!odd);
+  BOOST_REQUIRE(adsb.decode(framePosOdd, &frame) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(ADSBClient::parseCpr(&frame, &latCpr[1], &lonCpr[1], &odd) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(odd);
+  float lat = 0;
+  float lon = 0;
+  BOOST_TEST(ADSBClient::decodeCprGlobal(latCpr, lonCpr, false, &lat, &lon) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(lat == 52.2572f, boost::test_tools::tolerance(0.0001f));
+  BOOST_TEST(lon == 3.91937f, boost::test_tools::tolerance(0.0001f));
+
+  // the same position locally, relative to a point nearby
+  float latLocal = 0;
+  float lonLocal = 0;
+  ADSBClient::decodeCprLocal(52.0f, 4.0f, latCpr[0], lonCpr[0], false, &latLocal, &lonLocal);
+  BOOST_TEST(latLocal == lat, boost::test_tools::tolerance(0.0001f));
+  BOOST_TEST(lonLocal == lon, boost::test_tools::tolerance(0.0001f));
+  BOOST_TEST(ADSBClient::getLonZones(0.0f) == 59);
+  BOOST_TEST(ADSBClient::getLonZones(52.2572f) == 36);
+  BOOST_TEST(ADSBClient::getLonZones(-88.0f) == 1);
+}
+
+BOOST_AUTO_TEST_CASE(ADSB_Tracker) {
+  BOOST_TEST_MESSAGE("--- Test ADS-B aircraft tracker ---");
+
+  StubRadio radio;
+  ADSBClient adsb(&radio);
+  ADSBTracker tracker(&adsb, 4);
+  ADSBFrame frame;
+  ADSBAircraft_t* ac = NULL;
+
+  // identification, then the position pair
+  BOOST_REQUIRE(adsb.decode(frameId, &frame) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(tracker.update(&frame, 1000, &ac) == RADIOLIB_ERR_NONE);
+  BOOST_REQUIRE(ac != nullptr);
+  BOOST_TEST(ac->icao == 0x4840D6UL);
+  BOOST_TEST(strcmp(ac->callsign, "KLM1023 ") == 0);
+
+  BOOST_REQUIRE(adsb.decode(framePosOdd, &frame) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(tracker.update(&frame, 1000, &ac) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(ac->icao == 0x40621DUL);
+  BOOST_TEST(!ac->posValid);
+  BOOST_TEST(ac->altitude == 38000);
+  BOOST_REQUIRE(adsb.decode(framePos, &frame) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(tracker.update(&frame, 3000, &ac) == RADIOLIB_ERR_NONE);
+  BOOST_REQUIRE(ac->posValid);
+  BOOST_TEST(ac->lat == 52.2572f, boost::test_tools::tolerance(0.0001f));
+  BOOST_TEST(ac->lon == 3.91937f, boost::test_tools::tolerance(0.0001f));
+
+  // once the position is known, a single frame is enough
+  BOOST_REQUIRE(adsb.decode(framePosOdd, &frame) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(tracker.update(&frame, 30000, &ac) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(ac->posTime == 30000UL);
+  BOOST_TEST(ac->lat == 52.2658f, boost::test_tools::tolerance(0.0001f));
+  BOOST_TEST(ac->numMessages == 3);
+  BOOST_TEST(tracker.getNumAircraft() == 2);
+
+  // ordered from the most recently seen
+  BOOST_TEST(tracker.first()->icao == 0x40621DUL);
+  BOOST_TEST(tracker.next(tracker.first())->icao == 0x4840D6UL);
+  BOOST_TEST(tracker.next(tracker.next(tracker.first())) == nullptr);
+
+  // many aircraft with the same velocity, only the last 4 are kept
+  BOOST_REQUIRE(adsb.decode(frameVelGnd, &frame) == RADIOLIB_ERR_NONE);
+  for(uint32_t i = 0; i < 100; i++) {
+    frame.icao[0] = i >> 16;
+    frame.icao[1] = i >> 8;
+    frame.icao[2] = i;
+    BOOST_TEST(tracker.update(&frame, 40000 + i) == RADIOLIB_ERR_NONE);
+    BOOST_TEST(tracker.getNumAircraft() == RADIOLIB_MIN(i + 3, 4U));
+  }
+  BOOST_TEST(tracker.find(0x40621DUL) == nullptr);
+  for(uint32_t i = 96; i < 100; i++) {
+    ac = tracker.find(i);
+    BOOST_REQUIRE(ac != nullptr);
+    BOOST_TEST(ac->velValid);
+    BOOST_TEST(ac->verticalRate == -832);
+  }
+
+  // copies are independent of the original
+  ADSBTracker copy(tracker);
+  ADSBTracker assigned(&adsb, 16);
+  assigned = copy;
+  BOOST_TEST(copy.getNumAircraft() == 4);
+  BOOST_TEST(assigned.find(99) != nullptr);
+  BOOST_TEST(assigned.find(99) != tracker.find(99));
+  BOOST_TEST(assigned.next(assigned.first())->icao == 98);
+  BOOST_TEST(copy.expire(110000) == 4);
+  BOOST_TEST(tracker.getNumAircraft() == 4);
+
+  // expiry drops the ones that were not heard for long enough
+  BOOST_TEST(tracker.expire(40098 + 1000, 1000) == 2);
+  BOOST_TEST(tracker.getNumAircraft() == 2);
+  BOOST_TEST(tracker.find(97) == nullptr);
+  BOOST_TEST(tracker.find(98) != nullptr);
+  BOOST_TEST(tracker.expire(110000) == 2);
+  BOOST_TEST(tracker.first() == nullptr);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
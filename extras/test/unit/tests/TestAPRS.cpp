@@ -0,0 +1,164 @@
+// boost test header
+#include <boost/test/unit_test.hpp>
+
+// the APRS header
+#include "protocols/APRS/APRS.h"
+#include "StubRadio.hpp"
+
+#include <string.h>
+#include <string>
+#include <vector>
+
+static int16_t decodeText(const char* dest, const char* info, APRSPacket_t* packet) {
+  AX25Frame frame(dest, 0, "N7LEM", 0, RADIOLIB_AX25_CONTROL_UNNUMBERED_FRAME, RADIOLIB_AX25_PID_NO_LAYER_3, info);
+  int16_t state = APRSClient::decode(&frame, packet);
+
+  // the frame goes away, so only keep the length of the text
+  packet->text = NULL;
+  return(state);
+}
+
+BOOST_AUTO_TEST_SUITE(suite_APRS)
+
+BOOST_AUTO_TEST_CASE(APRS_Position) {
+  BOOST_TEST_MESSAGE("--- Test APRS position decoding ---");
+  APRSPacket_t pkt;
+
+  // uncompressed, no timestamp
+  BOOST_TEST(decodeText("APRS", "!4903.50N/07201.75W-Test 001234", &pkt) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(pkt.fields == RADIOLIB_APRS_FIELD_POSITION);
+  BOOST_TEST(pkt.lat == 49.0583f, boost::test_tools::tolerance(0.0001f));
+  BOOST_TEST(pkt.lon == -72.0292f, boost::test_tools::tolerance(0.0001f));
+  BOOST_TEST(pkt.table == '/');
+  BOOST_TEST(pkt.symbol == '-');
+  BOOST_TEST(!pkt.messaging);
+  BOOST_TEST(pkt.textLen == strlen("Test 001234"));
+
+  // uncompressed with timestamp, course/speed and altitude in the comment
+  BOOST_TEST(decodeText("APRS", "@092345z4903.50N/07201.75W>088/036/A=001234", &pkt) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(pkt.fields == (RADIOLIB_APRS_FIELD_POSITION | RADIOLIB_APRS_FIELD_TIMESTAMP | RADIOLIB_APRS_FIELD_COURSE_SPEED | RADIOLIB_APRS_FIELD_ALTITUDE));
+  BOOST_TEST(pkt.messaging);
+  BOOST_TEST(pkt.course == 88);
+  BOOST_TEST(pkt.speed == 36.0f);
+  BOOST_TEST(pkt.altitude == 376);
+
+  // ambiguous position
+  BOOST_TEST(decodeText("APRS", "!4903.  N/07201.  W-", &pkt) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(pkt.lat == 49.05f, boost::test_tools::tolerance(0.0001f));
+
+  // compressed, with course and speed
+  BOOST_TEST(decodeText("APRS", "=/5L!!<*e7>7P[", &pkt) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(pkt.fields == (RADIOLIB_APRS_FIELD_POSITION | RADIOLIB_APRS_FIELD_COURSE_SPEED));
+  BOOST_TEST(pkt.lat == 49.5f, boost::test_tools::tolerance(0.0001f));
+  BOOST_TEST(pkt.lon == -72.75f, boost::test_tools::tolerance(0.0001f));
+  BOOST_TEST(pkt.symbol == '>');
+  BOOST_TEST(pkt.course == 88);
+  BOOST_TEST(pkt.speed == 36.2f, boost::test_tools::tolerance(0.01f));
+
+  // compressed, with altitude
+  BOOST_TEST(decodeText("APRS", "!/5L!!<*e7OS]S", &pkt) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(pkt.fields == (RADIOLIB_APRS_FIELD_POSITION | RADIOLIB_APRS_FIELD_ALTITUDE));
+  BOOST_TEST(pkt.altitude == 3049);
+
+  BOOST_TEST(decodeText("APRS", "!4903.50N/0720", &pkt) == RADIOLIB_ERR_APRS_MALFORMED_PACKET);
+}
+
+BOOST_AUTO_TEST_CASE(APRS_MicE) {
+  BOOST_TEST_MESSAGE("--- Test APRS Mic-E round trip ---");
+
+  StubRadio radio;
+  AX25Client ax25(&radio);
+  (void)ax25.begin("N7LEM");
+  APRSClient aprs(&ax25);
+  (void)aprs.begin('>');
+
+  // values that hit the less common branches of the encoding tables
+  const struct {
+    float lat;
+    float lon;
+    uint16_t heading;
+    uint16_t speed;
+    uint8_t type;
+    int32_t alt;
+  } cases[] = {
+    { 49.5f, -5.25f, 251, 34, RADIOLIB_APRS_MIC_E_TYPE_EN_ROUTE, 1234 },
+    { -33.4f, 112.13f, 90, 250, RADIOLIB_APRS_MIC_E_TYPE_EMERGENCY, RADIOLIB_APRS_MIC_E_ALTITUDE_UNUSED },
+    { 0.5f, 179.9f, 359, 0, RADIOLIB_APRS_MIC_E_TYPE_OFF_DUTY, -50 },
+  };
+
+  for(const auto& c : cases) {
+    BOOST_TEST(aprs.sendMicE(c.lat, c.lon, c.heading, c.speed, c.type, NULL, 0, NULL, "hi", c.alt) == RADIOLIB_ERR_NONE);
+    AX25Frame frame("", 0, "", 0, 0);
+    (void)ax25.decode(radio.sent.data(), radio.sent.size());
+    BOOST_REQUIRE(ax25.readFrame(&frame) == RADIOLIB_ERR_NONE);
+
+    APRSPacket_t pkt;
+    BOOST_TEST(APRSClient::decode(&frame, &pkt) == RADIOLIB_ERR_NONE);
+    BOOST_TEST((pkt.fields & RADIOLIB_APRS_FIELD_MIC_E));
+    BOOST_TEST(pkt.lat == c.lat, boost::test_tools::tolerance(0.001f));
+    BOOST_TEST(pkt.lon == c.lon, boost::test_tools::tolerance(0.001f));
+    BOOST_TEST(pkt.course == c.heading);
+    BOOST_TEST(pkt.speed == (float)c.speed);
+    BOOST_TEST(pkt.micEType == c.type);
+    BOOST_TEST(pkt.symbol == '>');
+    BOOST_TEST(pkt.table == '/');
+    BOOST_TEST(((pkt.fields & RADIOLIB_APRS_FIELD_ALTITUDE) != 0) == (c.alt != RADIOLIB_APRS_MIC_E_ALTITUDE_UNUSED));
+    if(c.alt != RADIOLIB_APRS_MIC_E_ALTITUDE_UNUSED) {
+      BOOST_TEST(pkt.altitude == c.alt);
+    }
+    BOOST_TEST(std::string(pkt.text, pkt.textLen) == " hi");
+  }
+
+  // telemetry
+  const uint8_t telem[] = { 0x12, 0xAB, 0x00, 0xFF, 0x7F };
+  BOOST_TEST(aprs.sendMicE(10.0f, 20.0f, 0, 0, RADIOLIB_APRS_MIC_E_TYPE_COMMITTED, telem, 5) == RADIOLIB_ERR_NONE);
+  AX25Frame frame("", 0, "", 0, 0);
+  (void)ax25.decode(radio.sent.data(), radio.sent.size());
+  BOOST_REQUIRE(ax25.readFrame(&frame) == RADIOLIB_ERR_NONE);
+  APRSPacket_t pkt;
+  BOOST_TEST(APRSClient::decode(&frame, &pkt) == RADIOLIB_ERR_NONE);
+  BOOST_TEST((pkt.fields & RADIOLIB_APRS_FIELD_TELEMETRY));
+  BOOST_REQUIRE(pkt.telemNumAnalog == 5);
+  for(int i = 0; i < 5; i++) {
+    BOOST_TEST(pkt.telemAnalog[i] == (float)telem[i]);
+  }
+  BOOST_TEST(pkt.textLen == 0);
+}
+
+BOOST_AUTO_TEST_CASE(APRS_MessageTelemetry) {
+  BOOST_TEST_MESSAGE("--- Test APRS message, telemetry and status decoding ---");
+  APRSPacket_t pkt;
+
+  AX25Frame msg("APRS", 0, "N7LEM", 0, RADIOLIB_AX25_CONTROL_UNNUMBERED_FRAME, RADIOLIB_AX25_PID_NO_LAYER_3, ":NJ7P     :Hello there{42");
+  BOOST_TEST(APRSClient::decode(&msg, &pkt) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(pkt.fields == RADIOLIB_APRS_FIELD_MESSAGE);
+  BOOST_TEST(std::string(pkt.addressee, pkt.addresseeLen) == "NJ7P");
+  BOOST_TEST(std::string(pkt.text, pkt.textLen) == "Hello there");
+  BOOST_TEST(std::string(pkt.msgId, pkt.msgIdLen) == "42");
+
+  AX25Frame tlm("APRS", 0, "N7LEM", 0, RADIOLIB_AX25_CONTROL_UNNUMBERED_FRAME, RADIOLIB_AX25_PID_NO_LAYER_3, "T#005,199,000,-2.5,073,123,01101001 battery");
+  BOOST_TEST(APRSClient::decode(&tlm, &pkt) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(pkt.fields == RADIOLIB_APRS_FIELD_TELEMETRY);
+  BOOST_TEST(pkt.telemSeq == 5);
+  BOOST_REQUIRE(pkt.telemNumAnalog == 5);
+  BOOST_TEST(pkt.telemAnalog[0] == 199.0f);
+  BOOST_TEST(pkt.telemAnalog[2] == -2.5f);
+  BOOST_TEST(pkt.telemDigital == 0x69);
+  BOOST_TEST(std::string(pkt.text, pkt.textLen) == " battery");
+
+  AX25Frame bad("APRS", 0, "N7LEM", 0, RADIOLIB_AX25_CONTROL_UNNUMBERED_FRAME, RADIOLIB_AX25_PID_NO_LAYER_3, "T#005,1x9");
+  BOOST_TEST(APRSClient::decode(&bad, &pkt) == RADIOLIB_ERR_APRS_MALFORMED_PACKET);
+
+  // APRS over LoRa carries the addresses as text
+  const char lora[] = RADIOLIB_APRS_LORA_HEADER "N7LEM-1>APRS,WIDE1-1:>status text";
+  BOOST_TEST(APRSClient::decode(reinterpret_cast<const uint8_t*>(lora), strlen(lora), &pkt) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(pkt.type == '>');
+  BOOST_TEST(std::string(pkt.src, pkt.srcLen) == "N7LEM-1");
+  BOOST_TEST(std::string(pkt.text, pkt.textLen) == "status text");
+
+  AX25Frame unknown("APRS", 0, "N7LEM", 0, RADIOLIB_AX25_CONTROL_UNNUMBERED_FRAME, RADIOLIB_AX25_PID_NO_LAYER_3, "{user");
+  BOOST_TEST(APRSClient::decode(&unknown, &pkt) == RADIOLIB_ERR_APRS_UNSUPPORTED_TYPE);
+  BOOST_TEST(pkt.type == '{');
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,108 @@
+// boost test header
+#include <boost/test/unit_test.hpp>
+
+// the AX.25 header
+#include "protocols/AX25/AX25.h"
+#include "StubRadio.hpp"
+
+#include <string.h>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(suite_AX25)
+
+BOOST_AUTO_TEST_CASE(AX25_Loopback) {
+  BOOST_TEST_MESSAGE("--- Test AX.25 HDLC receiver ---");
+
+  StubRadio radio;
+  AX25Client ax25(&radio);
+  (void)ax25.begin("N7LEM", 3);
+
+  // UI frame with two repeaters, the first one already repeated the frame
+  const char* info = "Hello World! ~~~ \x7F\xFF";
+  AX25Frame tx("NJ7P", 1, "N7LEM", 3, RADIOLIB_AX25_CONTROL_UNNUMBERED_FRAME, RADIOLIB_AX25_PID_NO_LAYER_3, info);
+  char rpt0[] = "WIDE1";
+  char rpt1[] = "WIDE2";
+  char* rpts[] = { rpt0, rpt1 };
+  uint8_t rptSSIDs[] = { 1 | RADIOLIB_AX25_SSID_HAS_BEEN_REPEATED, 2 };
+  BOOST_TEST(tx.setRepeaters(rpts, rptSSIDs, 2) == RADIOLIB_ERR_NONE);
+
+  for(int scrambled = 0; scrambled < 2; scrambled++) {
+    ax25.setScrambler(scrambled ? RADIOLIB_SCRAMBLER_G3RUH_POLY : 0, RADIOLIB_SCRAMBLER_G3RUH_INIT);
+    BOOST_TEST(ax25.sendFrame(&tx) == RADIOLIB_ERR_NONE);
+    std::vector<uint8_t> air = radio.sent;
+
+    // the receiver is fed one byte at a time, with some idle line before and after
+    std::vector<uint8_t> line(4, scrambled ? 0x5A : 0x00);
+    line.insert(line.end(), air.begin(), air.end());
+    line.insert(line.end(), 4, 0x00);
+    AX25Frame rx("", 0, "", 0, 0);
+    int16_t state = RADIOLIB_ERR_RX_TIMEOUT;
+    for(size_t i = 0; (i < line.size()) && (state == RADIOLIB_ERR_RX_TIMEOUT); i++) {
+      BOOST_TEST(ax25.decode(&line[i], 1) == 1);
+      state = ax25.readFrame(&rx);
+    }
+    BOOST_REQUIRE(state == RADIOLIB_ERR_NONE);
+    BOOST_TEST(strcmp(rx.destCallsign, "NJ7P") == 0);
+    BOOST_TEST(rx.destSSID == 1);
+    BOOST_TEST(strcmp(rx.srcCallsign, "N7LEM") == 0);
+    BOOST_TEST(rx.srcSSID == 3);
+    BOOST_TEST(rx.control == RADIOLIB_AX25_CONTROL_UNNUMBERED_FRAME);
+    BOOST_TEST(rx.protocolID == RADIOLIB_AX25_PID_NO_LAYER_3);
+    BOOST_REQUIRE(rx.infoLen == strlen(info));
+    BOOST_TEST(memcmp(rx.info, info, rx.infoLen) == 0);
+    BOOST_REQUIRE(rx.numRepeaters == 2);
+    BOOST_TEST(strcmp(rx.repeaterCallsigns[0], "WIDE1") == 0);
+    BOOST_TEST(rx.repeaterSSIDs[0] == (1 | RADIOLIB_AX25_SSID_HAS_BEEN_REPEATED));
+    BOOST_TEST(strcmp(rx.repeaterCallsigns[1], "WIDE2") == 0);
+    BOOST_TEST(rx.repeaterSSIDs[1] == 2);
+    BOOST_TEST(ax25.readFrame(&rx) == RADIOLIB_ERR_RX_TIMEOUT);
+  }
+
+  // a single flipped bit anywhere in the frame fails the FCS
+  ax25.setScrambler(0);
+  BOOST_TEST(ax25.sendFrame(&tx) == RADIOLIB_ERR_NONE);
+  std::vector<uint8_t> air = radio.sent;
+  air[air.size() / 2] ^= 0x08;
+  AX25Frame rx("", 0, "", 0, 0);
+  BOOST_TEST(ax25.decode(air.data(), air.size()) == air.size());
+  BOOST_TEST(ax25.readFrame(&rx) == RADIOLIB_ERR_RX_TIMEOUT);
+}
+
+BOOST_AUTO_TEST_CASE(AX25_Sequence) {
+  BOOST_TEST_MESSAGE("--- Test AX.25 receiver on back-to-back frames ---");
+
+  StubRadio radio;
+  AX25Client ax25(&radio);
+  (void)ax25.begin("N7LEM", 0, 2);
+
+  // information frame with sequence numbers, then a supervisory frame without info field
+  AX25Frame iFrame("NJ7P", 0, "N7LEM", 0, RADIOLIB_AX25_CONTROL_INFORMATION_FRAME | RADIOLIB_AX25_CONTROL_POLL_FINAL_ENABLED, RADIOLIB_AX25_PID_NO_LAYER_3, "abc");
+  iFrame.setRecvSequence(5);
+  iFrame.setSendSequence(2);
+  AX25Frame sFrame("NJ7P", 0, "N7LEM", 0, RADIOLIB_AX25_CONTROL_SUPERVISORY_FRAME | RADIOLIB_AX25_CONTROL_S_RECEIVE_READY);
+  sFrame.setRecvSequence(6);
+
+  BOOST_TEST(ax25.sendFrame(&iFrame) == RADIOLIB_ERR_NONE);
+  std::vector<uint8_t> line = radio.sent;
+  BOOST_TEST(ax25.sendFrame(&sFrame) == RADIOLIB_ERR_NONE);
+  line.insert(line.end(), radio.sent.begin(), radio.sent.end());
+
+  // decoding stops after each frame until it is read
+  AX25Frame rx("", 0, "", 0, 0);
+  size_t pos = ax25.decode(line.data(), line.size());
+  BOOST_TEST(pos < line.size());
+  BOOST_REQUIRE(ax25.readFrame(&rx) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(rx.control == (RADIOLIB_AX25_CONTROL_INFORMATION_FRAME | RADIOLIB_AX25_CONTROL_POLL_FINAL_ENABLED));
+  BOOST_TEST(rx.rcvSeqNumber == 5);
+  BOOST_TEST(rx.sendSeqNumber == 2);
+  BOOST_TEST(rx.infoLen == 3);
+
+  pos += ax25.decode(&line[pos], line.size() - pos);
+  BOOST_REQUIRE(ax25.readFrame(&rx) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(rx.control == (RADIOLIB_AX25_CONTROL_SUPERVISORY_FRAME | RADIOLIB_AX25_CONTROL_S_RECEIVE_READY));
+  BOOST_TEST(rx.rcvSeqNumber == 6);
+  BOOST_TEST(rx.protocolID == 0);
+  BOOST_TEST(rx.infoLen == 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
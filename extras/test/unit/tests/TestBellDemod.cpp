@@ -0,0 +1,119 @@
+// boost test header
+#include <boost/test/unit_test.hpp>
+
+// the Bell modem and AX.25 headers
+#include "protocols/BellModem/BellDemodulator.h"
+#include "protocols/AX25/AX25.h"
+#include "StubRadio.hpp"
+
+#include <math.h>
+#include <string.h>
+#include <vector>
+
+// phase-continuous AFSK, MSB first, with some uniform noise
+static std::vector<int16_t> synthesize(const std::vector<uint8_t>& data, const BellModem_t& modem, uint32_t rate, float noise) {
+  std::vector<int16_t> audio;
+  double phase = 0;
+  double t = 0;
+  uint32_t seed = 1;
+  for(uint8_t b : data) {
+    for(int i = 7; i >= 0; i--) {
+      double freq = ((b >> i) & 0x01) ? modem.freqMark : modem.freqSpace;
+      t += (double)rate / modem.baudRate;
+      while((double)audio.size() < t) {
+        seed = seed*1103515245UL + 12345UL;
+        float n = noise * (((float)((seed >> 8) & 0xFFFF) / 32768.0f) - 1.0f);
+        audio.push_back((int16_t)(10000.0 * sin(phase) + 10000.0f*n));
+        phase += 2.0*M_PI*freq / rate;
+      }
+    }
+  }
+  return(audio);
+}
+
+static int16_t receive(BellDemodulator& demod, AX25Client& ax25, const std::vector<int16_t>& audio, AX25Frame* frame) {
+  // small blocks to exercise the output buffer
+  int16_t state = RADIOLIB_ERR_RX_TIMEOUT;
+  size_t pos = 0;
+  while(((pos < audio.size()) || (demod.available() > 0)) && (state == RADIOLIB_ERR_RX_TIMEOUT)) {
+    pos += demod.demodulate(&audio[pos], RADIOLIB_MIN(audio.size() - pos, (size_t)1000));
+    uint8_t bits[8];
+    size_t len = demod.read(bits, sizeof(bits));
+    for(size_t i = 0; (i < len) && (state == RADIOLIB_ERR_RX_TIMEOUT); i++) {
+      (void)ax25.decode(&bits[i], 1);
+      state = ax25.readFrame(frame);
+    }
+  }
+  return(state);
+}
+
+BOOST_AUTO_TEST_SUITE(suite_BellDemod)
+
+BOOST_AUTO_TEST_CASE(BellDemod_Begin) {
+  BOOST_TEST_MESSAGE("--- Test Bell demodulator configuration ---");
+
+  BellDemodulator demod;
+  BOOST_TEST(demod.begin(Bell202, 4000) == RADIOLIB_ERR_INVALID_FREQUENCY);
+  BOOST_TEST(demod.begin(Bell103, 8000, true) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(demod.windowLen == 27);
+  BOOST_TEST(demod.begin(Bell202, 44100) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(demod.windowLen == 37);
+  BOOST_TEST(demod.available() == 0);
+
+  // copies carry on from the same state, in their own window
+  std::vector<int16_t> audio = synthesize({ 0x55, 0xAA, 0x0F, 0xF0 }, Bell202, 44100, 0.0f);
+  size_t half = audio.size() / 2;
+  BOOST_REQUIRE(demod.demodulate(audio.data(), half) == half);
+  BellDemodulator copy(demod);
+  BellDemodulator assigned;
+  assigned = copy;
+  BOOST_TEST(copy.window != demod.window);
+  BOOST_TEST(assigned.window != copy.window);
+  BOOST_REQUIRE(demod.demodulate(&audio[half], audio.size() - half) == audio.size() - half);
+  BOOST_REQUIRE(assigned.demodulate(&audio[half], audio.size() - half) == audio.size() - half);
+  uint8_t bits[8] = { 0 };
+  uint8_t bitsCopy[8] = { 0 };
+  size_t len = demod.read(bits, sizeof(bits));
+  BOOST_TEST(len > 0);
+  BOOST_REQUIRE(assigned.read(bitsCopy, sizeof(bitsCopy)) == len);
+  BOOST_TEST(memcmp(bits, bitsCopy, len) == 0);
+}
+
+BOOST_AUTO_TEST_CASE(BellDemod_AX25) {
+  BOOST_TEST_MESSAGE("--- Test Bell demodulator with AX.25 ---");
+
+  StubRadio radio;
+  AX25Client ax25(&radio);
+  (void)ax25.begin("N7LEM", 0, 16);
+  AX25Frame tx("APRS", 0, "N7LEM", 0, RADIOLIB_AX25_CONTROL_UNNUMBERED_FRAME, RADIOLIB_AX25_PID_NO_LAYER_3, "!4903.50N/07201.75W-Test 001234");
+  BOOST_TEST(ax25.sendFrame(&tx) == RADIOLIB_ERR_NONE);
+  std::vector<uint8_t> air = radio.sent;
+
+  // the demodulator lags behind by a bit or two, so the transmitter is kept on for a while after the frame
+  air.insert(air.end(), 4, 0x00);
+
+  const struct {
+    const BellModem_t* modem;
+    uint32_t rate;
+    float noise;
+  } cases[] = {
+    { &Bell202, 9600, 0.0f },
+    { &Bell202, 22050, 0.5f },
+    { &Bell202, 44100, 0.8f },
+    { &Bell103, 8000, 0.8f },
+  };
+
+  for(const auto& c : cases) {
+    BellDemodulator demod;
+    BOOST_REQUIRE(demod.begin(*c.modem, c.rate) == RADIOLIB_ERR_NONE);
+    std::vector<int16_t> audio = synthesize(air, *c.modem, c.rate, c.noise);
+
+    AX25Frame rx("", 0, "", 0, 0);
+    BOOST_REQUIRE(receive(demod, ax25, audio, &rx) == RADIOLIB_ERR_NONE);
+    BOOST_TEST(strcmp(rx.srcCallsign, "N7LEM") == 0);
+    BOOST_REQUIRE(rx.infoLen == tx.infoLen);
+    BOOST_TEST(memcmp(rx.info, tx.info, tx.infoLen) == 0);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
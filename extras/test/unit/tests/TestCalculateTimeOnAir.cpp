@@ -68,4 +68,19 @@ BOOST_AUTO_TEST_CASE(TimeOnAir_AllRadios) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(TimeOnAir_CompileTime) {
+    // the shared core must be usable in constant expressions
+    constexpr RadioLibTime_t toaLoRa = rlb_toaLoRa(7, 125, 5, 8, true, false, true, 10);
+    constexpr RadioLibTime_t toaFSK = rlb_toaFSK(100, 16, 16, 2, 16);
+    constexpr RadioLibTime_t toaLrFhss = rlb_toaLrFhss(RADIOLIB_SX126X_LR_FHSS_CR_2_3, 2, 20);
+    static_assert(toaLoRa == 46336, "LoRa time-on-air mismatch");
+    static_assert(toaFSK == 1760, "FSK time-on-air mismatch");
+    BOOST_CHECK_EQUAL(toaLrFhss, 4259832);
+
+    // the longest LR-FHSS packet does not overflow (1253 bits in total)
+    constexpr RadioLibTime_t toaLrFhssMax = rlb_toaLrFhss(RADIOLIB_SX126X_LR_FHSS_CR_1_3, 4, 255);
+    BOOST_TEST(toaLrFhssMax > 20529000UL);
+    BOOST_TEST(toaLrFhssMax < 20530000UL);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
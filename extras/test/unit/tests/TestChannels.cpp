@@ -0,0 +1,67 @@
+// boost test header
+#include <boost/test/unit_test.hpp>
+
+// the LoRaWAN header
+#include "protocols/LoRaWAN/LoRaWAN.h"
+#include "LoRaWANFixture.hpp"
+
+#include <set>
+
+BOOST_AUTO_TEST_SUITE(suite_Channels)
+
+BOOST_AUTO_TEST_CASE(Channels_SelectRandom) {
+  BOOST_TEST_MESSAGE("--- Test LoRaWANNode::selectRandomChannel ---");
+
+  uint16_t mask[RADIOLIB_LORAWAN_MAX_NUM_FIXED_CHANNELS / 16] = { 0 };
+  uint8_t idx = 0;
+  BOOST_TEST(!LoRaWANNode::selectRandomChannel(mask, &idx));
+
+  // every enabled channel gets picked eventually, and nothing else does
+  mask[0] = (0x0001 << 3);
+  mask[1] = (0x0001 << (20 - 16)) | (0x0001 << 15);
+  mask[4] = (0x0001 << (70 - 64));
+  std::set<uint8_t> picked;
+  for(int i = 0; i < 200; i++) {
+    BOOST_TEST(LoRaWANNode::selectRandomChannel(mask, &idx));
+    picked.insert(idx);
+  }
+  BOOST_TEST((picked == std::set<uint8_t>{ 3, 20, 31, 70 }));
+}
+
+BOOST_AUTO_TEST_CASE(Channels_FixedBand) {
+  BOOST_TEST_MESSAGE("--- Test LoRaWAN channel flags in US915 ---");
+
+  StubRadio radio;
+  LoRaWANNode node(&radio, &US915, 2);
+  BOOST_TEST(activateFixture(node) == RADIOLIB_LORAWAN_NEW_SESSION);
+
+  // 125 kHz channels allow DR0 - DR3, 500 kHz channels DR4
+  BOOST_TEST(node.channelDrMasks[3][0] == 0xFFFF);
+  BOOST_TEST(node.channelDrMasks[3][4] == 0x0000);
+  BOOST_TEST(node.channelDrMasks[4][0] == 0x0000);
+  BOOST_TEST(node.channelDrMasks[4][4] == 0x00FF);
+
+  // sub-band 2 is channels 8 - 15 and 65
+  node.channels[RADIOLIB_LORAWAN_UPLINK].dr = 3;
+  BOOST_TEST(node.calculateChannelFlags());
+  BOOST_TEST(node.channelFlags[0] == 0xFF00);
+  BOOST_TEST(node.channelFlags[4] == 0x0000);
+  node.channels[RADIOLIB_LORAWAN_UPLINK].dr = 4;
+  BOOST_TEST(node.calculateChannelFlags());
+  BOOST_TEST(node.channelFlags[0] == 0x0000);
+  BOOST_TEST(node.channelFlags[4] == 0x0002);
+
+  // all 125 kHz channels of the sub-band are used before any is repeated
+  node.channels[RADIOLIB_LORAWAN_UPLINK].dr = 3;
+  (void)node.calculateChannelFlags();
+  std::set<uint8_t> picked;
+  for(int i = 0; i < 8; i++) {
+    BOOST_TEST(node.selectChannels() == RADIOLIB_ERR_NONE);
+    picked.insert(node.channels[RADIOLIB_LORAWAN_UPLINK].idx);
+  }
+  BOOST_TEST(picked.size() == 8);
+  BOOST_TEST(*picked.begin() == 8);
+  BOOST_TEST(*picked.rbegin() == 15);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
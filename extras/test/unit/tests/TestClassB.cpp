@@ -0,0 +1,103 @@
+// boost test header
+#include <boost/test/unit_test.hpp>
+
+// the LoRaWAN header
+#include "protocols/LoRaWAN/LoRaWAN.h"
+#include "StubRadio.hpp"
+
+#include <set>
+
+BOOST_AUTO_TEST_SUITE(suite_ClassB)
+
+BOOST_AUTO_TEST_CASE(ClassB_PingOffset) {
+  BOOST_TEST_MESSAGE("--- Test LoRaWANNode::calculatePingOffset ---");
+
+  // Rand = aes128_encrypt(16 x 0x00, Beacon_Time | DevAddr | pad16), offset = (Rand[0] + Rand[1]*256) mod pingPeriod
+  // reference values from an independent AES implementation (OpenSSL), Rand[0..1] = 0x5F 0xEB
+  const uint32_t beaconTime = 1400000000UL;
+  const uint32_t devAddr = 0x26011BDA;
+  const uint16_t expected[RADIOLIB_LORAWAN_PING_PERIODICITY_MAX + 1] = { 31, 31, 95, 95, 351, 863, 863, 2911 };
+  for(uint8_t periodicity = 0; periodicity <= RADIOLIB_LORAWAN_PING_PERIODICITY_MAX; periodicity++) {
+    uint16_t pingPeriod = (uint16_t)1 << (5 + periodicity);
+    BOOST_TEST(LoRaWANNode::calculatePingOffset(beaconTime, devAddr, pingPeriod) == expected[periodicity]);
+  }
+
+  // the offset has to spread devices and beacon periods over the slots
+  std::set<uint16_t> byAddr;
+  std::set<uint16_t> byTime;
+  for(uint32_t i = 0; i < 16; i++) {
+    byAddr.insert(LoRaWANNode::calculatePingOffset(beaconTime, devAddr + i, RADIOLIB_LORAWAN_PING_SLOTS));
+    byTime.insert(LoRaWANNode::calculatePingOffset(beaconTime + i*128, devAddr, RADIOLIB_LORAWAN_PING_SLOTS));
+  }
+  BOOST_TEST(byAddr.size() > 8);
+  BOOST_TEST(byTime.size() > 8);
+}
+
+BOOST_AUTO_TEST_CASE(ClassB_MacCommands) {
+  BOOST_TEST_MESSAGE("--- Test Class B MAC commands ---");
+
+  const LoRaWANMacCommand_t* cmd = LoRaWANNode::findMacCommand(RADIOLIB_LORAWAN_MAC_PING_SLOT_INFO);
+  BOOST_REQUIRE(cmd != nullptr);
+  BOOST_TEST(cmd->lenDn == 0);
+  BOOST_TEST(cmd->lenUp == 1);
+
+  cmd = LoRaWANNode::findMacCommand(RADIOLIB_LORAWAN_MAC_PING_SLOT_CHANNEL);
+  BOOST_REQUIRE(cmd != nullptr);
+  BOOST_TEST(cmd->lenDn == 4);
+  BOOST_TEST(cmd->lenUp == 1);
+
+  cmd = LoRaWANNode::findMacCommand(RADIOLIB_LORAWAN_MAC_BEACON_FREQ);
+  BOOST_REQUIRE(cmd != nullptr);
+  BOOST_TEST(cmd->lenDn == 3);
+  BOOST_TEST(cmd->lenUp == 1);
+}
+
+// radio that cannot use the fastest LoRa data rates
+class SlowRadio : public StubRadio {
+  public:
+    int16_t checkDataRate(DataRate_t dr, ModemType_t modem) override {
+      if((modem == RADIOLIB_MODEM_LORA) && (dr.lora.spreadingFactor < 9)) {
+        return(RADIOLIB_ERR_INVALID_SPREADING_FACTOR);
+      }
+      return(RADIOLIB_ERR_NONE);
+    }
+};
+
+BOOST_AUTO_TEST_CASE(ClassB_PingSlotChannel) {
+  BOOST_TEST_MESSAGE("--- Test PingSlotChannelReq data rate checks ---");
+
+  SlowRadio radio;
+  LoRaWANNode node(&radio, &EU868);
+  const uint8_t drDefault = node.pingDr;
+
+  // Frequency (869.525 MHz) | DR, answer is DR ACK | Channel frequency ACK << 1
+  uint8_t req[4] = { 0xD2, 0xAD, 0x84, 0x00 };
+  uint8_t ans = 0;
+
+  // DR 15 is past the end of the data rate table
+  req[3] = 0x0F;
+  BOOST_TEST(node.execMacCommand(RADIOLIB_LORAWAN_MAC_PING_SLOT_CHANNEL, req, sizeof(req), &ans));
+  BOOST_TEST(ans == 0x02);
+  BOOST_TEST(node.pingDr == drDefault);
+
+  // DR 8 is not a downlink data rate in EU868
+  req[3] = 0x08;
+  BOOST_TEST(node.execMacCommand(RADIOLIB_LORAWAN_MAC_PING_SLOT_CHANNEL, req, sizeof(req), &ans));
+  BOOST_TEST(ans == 0x02);
+  BOOST_TEST(node.pingDr == drDefault);
+
+  // DR 5 (SF7) is in the band, but the radio cannot do it
+  req[3] = 0x05;
+  BOOST_TEST(node.execMacCommand(RADIOLIB_LORAWAN_MAC_PING_SLOT_CHANNEL, req, sizeof(req), &ans));
+  BOOST_TEST(ans == 0x02);
+  BOOST_TEST(node.pingDr == drDefault);
+
+  // DR 3 (SF9) is fine
+  req[3] = 0x03;
+  BOOST_TEST(node.execMacCommand(RADIOLIB_LORAWAN_MAC_PING_SLOT_CHANNEL, req, sizeof(req), &ans));
+  BOOST_TEST(ans == 0x03);
+  BOOST_TEST(node.pingDr == 3);
+  BOOST_TEST(node.pingFreq == 8695250UL);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,191 @@
+// boost test header
+#include <boost/test/unit_test.hpp>
+
+// the LoRaWAN header
+#include "protocols/LoRaWAN/LoRaWAN.h"
+#include "LoRaWANFixture.hpp"
+
+#define CYCLE_HAL_IRQ_PIN   (1)
+
+// HAL with a clock that only moves when told to, and an IRQ pin driven by the test
+class ClockHal : public RadioLibHal {
+  public:
+    RadioLibTime_t now = 1000;
+    bool irq = false;
+
+    ClockHal() : RadioLibHal(0, 1, 0, 1, 1, 2) {}
+
+    void pinMode(uint32_t pin, uint32_t mode) override { (void)pin; (void)mode; }
+    void digitalWrite(uint32_t pin, uint32_t value) override { (void)pin; (void)value; }
+    uint32_t digitalRead(uint32_t pin) override { return((pin == CYCLE_HAL_IRQ_PIN) && this->irq); }
+    void attachInterrupt(uint32_t interruptNum, void (*interruptCb)(void), uint32_t mode) override { (void)interruptNum; (void)interruptCb; (void)mode; }
+    void detachInterrupt(uint32_t interruptNum) override { (void)interruptNum; }
+    void delay(RadioLibTime_t ms) override { this->now += ms; }
+    void delayMicroseconds(RadioLibTime_t us) override { this->now += us / 1000; }
+    RadioLibTime_t millis() override { return(this->now); }
+    RadioLibTime_t micros() override { return(this->now * 1000); }
+    long pulseIn(uint32_t pin, uint32_t state, RadioLibTime_t timeout) override { (void)pin; (void)state; (void)timeout; return(0); }
+    void spiBegin() override {}
+    void spiBeginTransaction() override {}
+    void spiTransfer(uint8_t* out, size_t len, uint8_t* in) override { (void)out; (void)len; (void)in; }
+    void spiEndTransaction() override {}
+    void spiEnd() override {}
+};
+
+// radio that accepts every mode change, and raises the interrupt flags it is told to
+class CycleRadio : public StubRadio {
+  public:
+    Module mod;
+    RadioModeType_t staged = RADIOLIB_RADIO_MODE_NONE;
+    RadioModeType_t active = RADIOLIB_RADIO_MODE_NONE;
+    uint32_t irqFlags = 0;
+
+    explicit CycleRadio(ClockHal* hal) : mod(hal, RADIOLIB_NC, CYCLE_HAL_IRQ_PIN, RADIOLIB_NC) {
+      for(uint8_t i = 0; i < sizeof(this->irqMap)/sizeof(this->irqMap[0]); i++) {
+        this->irqMap[i] = (1UL << i);
+      }
+    }
+
+    int16_t standby() override { this->active = RADIOLIB_RADIO_MODE_STANDBY; return(RADIOLIB_ERR_NONE); }
+    int16_t sleep() override { this->active = RADIOLIB_RADIO_MODE_SLEEP; return(RADIOLIB_ERR_NONE); }
+    int16_t finishTransmit() override { return(this->standby()); }
+    int16_t setFrequency(float freq) override { (void)freq; return(RADIOLIB_ERR_NONE); }
+    int16_t setOutputPower(int8_t power) override { (void)power; return(RADIOLIB_ERR_NONE); }
+    int16_t invertIQ(bool enable) override { (void)enable; return(RADIOLIB_ERR_NONE); }
+    int16_t setSyncWord(uint8_t* sync, size_t len) override { (void)sync; (void)len; return(RADIOLIB_ERR_NONE); }
+    int16_t setPreambleLength(size_t len) override { (void)len; return(RADIOLIB_ERR_NONE); }
+    int16_t setDataRate(DataRate_t dr, ModemType_t modem) override { (void)dr; (void)modem; return(RADIOLIB_ERR_NONE); }
+    RadioLibTime_t calculateTimeOnAir(ModemType_t modem, DataRate_t dr, PacketConfig_t pc, size_t len) override {
+      (void)modem; (void)dr; (void)pc;
+      return((RadioLibTime_t)len * 1000UL);
+    }
+    RadioLibTime_t calculateRxTimeout(RadioLibTime_t timeoutUs) override { return(timeoutUs); }
+    uint32_t getIrqFlags() override { return(this->irqFlags); }
+    int16_t clearIrqFlags(uint32_t irq) override { this->irqFlags &= ~irq; return(RADIOLIB_ERR_NONE); }
+    int16_t stageMode(RadioModeType_t mode, RadioModeConfig_t* cfg) override { (void)cfg; this->staged = mode; return(RADIOLIB_ERR_NONE); }
+    int16_t launchMode() override { this->active = this->staged; return(RADIOLIB_ERR_NONE); }
+
+  private:
+    Module* getMod() override { return(&this->mod); }
+};
+
+// node with an ABP session on a radio and clock controlled by the test
+class CycleFixture {
+  public:
+    ClockHal hal;
+    CycleRadio radio;
+    LoRaWANNode node;
+    uint8_t dataUp[4] = { 0x01, 0x02, 0x03, 0x04 };
+    uint8_t dataDown[RADIOLIB_LORAWAN_MAX_PAYLOAD_SIZE] = { 0 };
+    size_t lenDown = 0;
+
+    CycleFixture() : radio(&hal), node(&radio, &EU868) {
+      BOOST_REQUIRE(activateFixture(node) == RADIOLIB_LORAWAN_NEW_SESSION);
+    }
+
+    // call process() at the next deadline
+    int16_t step() {
+      if(this->hal.now < this->node.getNextDeadline()) {
+        this->hal.now = this->node.getNextDeadline();
+      }
+      return(this->node.process());
+    }
+
+    // let the receive window time out
+    int16_t timeoutWindow() {
+      this->radio.irqFlags |= (1UL << RADIOLIB_IRQ_TIMEOUT);
+      this->hal.now = this->node.getNextDeadline() + 1;
+      return(this->node.process());
+    }
+};
+
+BOOST_AUTO_TEST_SUITE(suite_Cycle)
+
+BOOST_FIXTURE_TEST_CASE(Cycle_NoDownlink, CycleFixture) {
+  BOOST_TEST_MESSAGE("--- Test non-blocking uplink without downlink ---");
+
+  uint32_t fCnt = node.fCntUp;
+  BOOST_REQUIRE(node.startSendReceive(dataUp, sizeof(dataUp), 1, dataDown, &lenDown) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(node.cycleState == RADIOLIB_LORAWAN_CYCLE_TX_PENDING);
+  BOOST_TEST(node.cycleMsg != nullptr);
+
+  // only one cycle at a time
+  BOOST_TEST(node.startSendReceive(dataUp, sizeof(dataUp), 1, dataDown, &lenDown) == RADIOLIB_ERR_UPLINK_UNAVAILABLE);
+
+  // a pending cycle is not an error
+  BOOST_TEST(RADIOLIB_LORAWAN_CYCLE_PENDING > RADIOLIB_ERR_NONE);
+
+  // uplink is started at the deadline, and finished once the IRQ pin goes high
+  BOOST_TEST(step() == RADIOLIB_LORAWAN_CYCLE_PENDING);
+  BOOST_TEST(radio.active == RADIOLIB_RADIO_MODE_TX);
+  BOOST_TEST(node.process() == RADIOLIB_LORAWAN_CYCLE_PENDING);
+  BOOST_TEST(node.cycleState == RADIOLIB_LORAWAN_CYCLE_TX_ACTIVE);
+  hal.irq = true;
+  BOOST_TEST(node.process() == RADIOLIB_LORAWAN_CYCLE_PENDING);
+  hal.irq = false;
+  BOOST_TEST(node.cycleState == RADIOLIB_LORAWAN_CYCLE_RX1_PENDING);
+
+  // Rx1 opens one second after the uplink
+  RadioLibTime_t tUplinkEnd = hal.now;
+  BOOST_TEST(node.getNextDeadline() <= tUplinkEnd + RADIOLIB_LORAWAN_RECEIVE_DELAY_1_MS);
+  BOOST_TEST(node.getNextDeadline() + node.scanGuard >= tUplinkEnd + RADIOLIB_LORAWAN_RECEIVE_DELAY_1_MS);
+  BOOST_TEST(step() == RADIOLIB_LORAWAN_CYCLE_PENDING);
+  BOOST_TEST(radio.active == RADIOLIB_RADIO_MODE_RX);
+  BOOST_TEST(node.cycleState == RADIOLIB_LORAWAN_CYCLE_RX1_ACTIVE);
+
+  // nothing in Rx1, so it goes on to Rx2
+  BOOST_TEST(timeoutWindow() == RADIOLIB_LORAWAN_CYCLE_PENDING);
+  BOOST_TEST(node.cycleState == RADIOLIB_LORAWAN_CYCLE_RX2_PENDING);
+  BOOST_TEST(step() == RADIOLIB_LORAWAN_CYCLE_PENDING);
+  BOOST_TEST(node.cycleState == RADIOLIB_LORAWAN_CYCLE_RX2_ACTIVE);
+
+  // nothing in Rx2 either, the cycle is done
+  BOOST_TEST(timeoutWindow() == 0);
+  BOOST_TEST(node.cycleState == RADIOLIB_LORAWAN_CYCLE_IDLE);
+  BOOST_TEST(node.cycleMsg == nullptr);
+  BOOST_TEST(node.getNextDeadline() == 0);
+  BOOST_TEST(node.fCntUp == fCnt + 1);
+  BOOST_TEST(node.process() == RADIOLIB_ERR_NONE);
+}
+
+BOOST_FIXTURE_TEST_CASE(Cycle_Cancel, CycleFixture) {
+  BOOST_TEST_MESSAGE("--- Test cancelling the non-blocking uplink ---");
+
+  // nothing was sent yet, so the frame counter can be used again
+  uint32_t fCnt = node.fCntUp;
+  BOOST_REQUIRE(node.startSendReceive(dataUp, sizeof(dataUp), 1, dataDown, &lenDown) == RADIOLIB_ERR_NONE);
+  node.cancelSendReceive();
+  BOOST_TEST(node.cycleState == RADIOLIB_LORAWAN_CYCLE_IDLE);
+  BOOST_TEST(node.cycleMsg == nullptr);
+  BOOST_TEST(node.fCntUp == fCnt);
+
+  // cancelled while listening, the radio is stopped and the frame counter is not reused
+  BOOST_REQUIRE(node.startSendReceive(dataUp, sizeof(dataUp), 1, dataDown, &lenDown) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(step() == RADIOLIB_LORAWAN_CYCLE_PENDING);
+  hal.irq = true;
+  BOOST_TEST(node.process() == RADIOLIB_LORAWAN_CYCLE_PENDING);
+  hal.irq = false;
+  BOOST_TEST(step() == RADIOLIB_LORAWAN_CYCLE_PENDING);
+  BOOST_TEST(radio.active == RADIOLIB_RADIO_MODE_RX);
+  node.cancelSendReceive();
+  BOOST_TEST(radio.active == RADIOLIB_RADIO_MODE_STANDBY);
+  BOOST_TEST(node.cycleState == RADIOLIB_LORAWAN_CYCLE_IDLE);
+  BOOST_TEST(node.cycleMsg == nullptr);
+  BOOST_TEST(node.fCntUp == fCnt + 1);
+
+  // a new cycle can be started right away, and cancelling twice does nothing
+  BOOST_TEST(node.startSendReceive(dataUp, sizeof(dataUp), 1, dataDown, &lenDown) == RADIOLIB_ERR_NONE);
+  node.cancelSendReceive();
+  node.cancelSendReceive();
+  BOOST_TEST(node.fCntUp == fCnt + 1);
+}
+
+BOOST_FIXTURE_TEST_CASE(Cycle_ClassC, CycleFixture) {
+  BOOST_TEST_MESSAGE("--- Test non-blocking uplink in Class C ---");
+
+  node.lwClass = RADIOLIB_LORAWAN_CLASS_C;
+  BOOST_TEST(node.startSendReceive(dataUp, sizeof(dataUp), 1, dataDown, &lenDown) == RADIOLIB_ERR_INVALID_MODE);
+  BOOST_TEST(node.cycleState == RADIOLIB_LORAWAN_CYCLE_IDLE);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
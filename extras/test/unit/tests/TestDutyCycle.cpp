@@ -0,0 +1,105 @@
+// boost test header
+#include <boost/test/unit_test.hpp>
+
+// the LoRaWAN header
+#include "protocols/LoRaWAN/LoRaWAN.h"
+#include "LoRaWANFixture.hpp"
+
+BOOST_AUTO_TEST_SUITE(suite_DutyCycle)
+
+BOOST_AUTO_TEST_CASE(DutyCycle_SubBands) {
+  BOOST_TEST_MESSAGE("--- Test LoRaWAN duty cycle per sub-band ---");
+
+  StubRadio radio;
+  LoRaWANNode node(&radio, &EU868);
+  BOOST_TEST(activateFixture(node) == RADIOLIB_LORAWAN_NEW_SESSION);
+
+  // new sessions default to DutyCycleReq = 7, the aggregate 1 % limit of EU868
+  BOOST_TEST(node.bufferSession[RADIOLIB_LORAWAN_SESSION_DUTY_CYCLE] == 7);
+  BOOST_TEST(node.dutyCycle == 3600000UL / 128);
+  node.setDutyCycle(true);
+  BOOST_TEST(node.isDutyCyclePerBand());
+
+  // default channels are all in the 1 % sub-band
+  const uint32_t g1 = 8681000;
+  const uint32_t g3 = 8695250;
+  BOOST_TEST(node.getDutyCycleBand(g1) == 2);
+  BOOST_TEST(node.getDutyCycleBand(g3) == 4);
+  BOOST_TEST(node.getDutyCycleBand(8692500) == RADIOLIB_LORAWAN_DC_BAND_OTHER);
+
+  // sub-bands that touch do not overlap
+  BOOST_TEST(node.getDutyCycleBand(8650000) == 1);
+  BOOST_TEST(node.getDutyCycleBand(8680000) == 2);
+  BOOST_TEST(node.getDutyCycleBand(8700000) == RADIOLIB_LORAWAN_DC_BAND_OTHER);
+
+  // 36 one second uplinks, 2 seconds apart, use up the 36 s budget
+  // the history only keeps 8 entries, so the oldest 29 are merged and leave the window together
+  for(uint32_t i = 0; i < 36; i++) {
+    node.recordDutyCycle(g1, 1000 + i*2000, 1000);
+  }
+  BOOST_TEST(!node.isChannelFree(g1, 80000));
+  BOOST_TEST(node.dcFree[2] == 57000 + RADIOLIB_LORAWAN_DC_WINDOW_MS);
+  BOOST_TEST(node.isChannelFree(g1, 57000 + RADIOLIB_LORAWAN_DC_WINDOW_MS));
+  BOOST_TEST(node.isChannelFree(g3, 80000));
+  BOOST_TEST(node.getNextUplinkTime() == 57000 + RADIOLIB_LORAWAN_DC_WINDOW_MS);
+
+  // uplinks in the 10 % sub-band are available right away once a channel is enabled there
+  node.dynamicChannels[RADIOLIB_LORAWAN_UPLINK][3] = { .idx = 3, .freq = g3, .drMin = 0, .drMax = 5, .dr = 3 };
+  node.updateChannelDrMask(3);
+  node.channelMasks[0] |= (0x0001 << 3);
+  BOOST_TEST(node.getNextUplinkTime() == 0);
+
+  // an hour after the last one, all previous uplinks have left the window
+  node.recordDutyCycle(g1, 72000 + RADIOLIB_LORAWAN_DC_WINDOW_MS, 1000);
+  BOOST_TEST(node.dcLen[2] == 1);
+  BOOST_TEST(node.dcFree[2] == 0);
+
+  // stricter limit from the network applies to all sub-bands together, and the sub-bands still apply on top
+  node.setDutyCycle(true, 3600);
+  BOOST_TEST(node.isDutyCyclePerBand());
+  node.tUplinkEnd = 100000;
+  node.lastToA = 1000;
+  BOOST_TEST(node.getNextUplinkTime() == 100000 + node.dutyCycleInterval(3600, 1000));
+  node.channelMasks[0] = (0x0001 << 3);
+  for(uint32_t i = 0; i < 360; i++) {
+    node.recordDutyCycle(g3, 100000 + i*1000, 1000);
+  }
+  BOOST_TEST(node.getNextUplinkTime() > 100000 + node.dutyCycleInterval(3600, 1000));
+}
+
+BOOST_AUTO_TEST_CASE(DutyCycle_OutsideSubBands) {
+  BOOST_TEST_MESSAGE("--- Test LoRaWAN duty cycle outside of all sub-bands ---");
+
+  StubRadio radio;
+  LoRaWANNode node(&radio, &EU868);
+  BOOST_TEST(activateFixture(node) == RADIOLIB_LORAWAN_NEW_SESSION);
+  node.setDutyCycle(true);
+
+  // channel in the gap between two sub-bands, as the only enabled channel
+  const uint32_t gap = 8692500;
+  node.dynamicChannels[RADIOLIB_LORAWAN_UPLINK][3] = { .idx = 3, .freq = gap, .drMin = 0, .drMax = 5, .dr = 3 };
+  node.updateChannelDrMask(3);
+  BOOST_TEST(node.dcChannels[RADIOLIB_LORAWAN_DC_BAND_OTHER] == (0x0001 << 3));
+  node.channelMasks[0] = (0x0001 << 3);
+
+  // it is tracked against the band-wide 1 % limit, so 36 one second uplinks use up the budget
+  for(uint32_t i = 0; i < 36; i++) {
+    node.recordDutyCycle(gap, 1000 + i*2000, 1000);
+  }
+  BOOST_TEST(node.dcLen[RADIOLIB_LORAWAN_DC_BAND_OTHER] > 0);
+  BOOST_TEST(!node.isChannelFree(gap, 80000));
+  BOOST_TEST(node.getFreeChannelMask(80000) == (uint16_t)~(0x0001 << 3));
+  BOOST_TEST(node.getNextUplinkTime() == 57000 + RADIOLIB_LORAWAN_DC_WINDOW_MS);
+
+  // moving the channel into a sub-band takes it out of the band-wide entry
+  node.dynamicChannels[RADIOLIB_LORAWAN_UPLINK][3].freq = 8695250;
+  node.updateChannelDrMask(3);
+  BOOST_TEST(node.dcChannels[RADIOLIB_LORAWAN_DC_BAND_OTHER] == 0);
+  BOOST_TEST(node.getNextUplinkTime() == 0);
+
+  // bands without sub-bands are not tracked per sub-band at all
+  LoRaWANNode us(&radio, &US915);
+  BOOST_TEST(us.getDutyCycleBand(9023000) == -1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,168 @@
+// boost test header
+#include <boost/test/unit_test.hpp>
+
+// the fragmentation header
+#include "protocols/LoRaWAN/LoRaWANFragmentation.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+// file-backed storage
+class FileStorage : public LoRaWANFragStorage {
+  public:
+    FileStorage() { this->fp = tmpfile(); }
+    ~FileStorage() { fclose(this->fp); }
+
+    int16_t read(uint32_t addr, uint8_t* data, size_t len) override {
+      memset(data, 0, len);
+      fseek(this->fp, addr, SEEK_SET);
+      (void)fread(data, 1, len, this->fp);
+      return(RADIOLIB_ERR_NONE);
+    }
+
+    int16_t write(uint32_t addr, const uint8_t* data, size_t len) override {
+      fseek(this->fp, addr, SEEK_SET);
+      return(fwrite(data, 1, len, this->fp) == len ? RADIOLIB_ERR_NONE : RADIOLIB_ERR_UNKNOWN);
+    }
+
+  private:
+    FILE* fp;
+};
+
+// generate fragment n (starting from 1) of the image, coded if n > m
+static void encodeFragment(const std::vector<uint8_t>& image, uint16_t m, uint8_t size, uint16_t n, uint8_t* out) {
+  if(n <= m) {
+    memcpy(out, &image[(n - 1) * size], size);
+    return;
+  }
+
+  uint8_t row[(RADIOLIB_LORAWAN_FRAG_MAX_NB + 7) / 8];
+  LoRaWANFragmentation::getParityRow(n - m, m, row);
+  memset(out, 0, size);
+  for(uint16_t i = 0; i < m; i++) {
+    if(TEST_BIT_IN_ARRAY_MSB(row, i)) {
+      for(uint8_t j = 0; j < size; j++) {
+        out[j] ^= image[i * size + j];
+      }
+    }
+  }
+}
+
+static bool checkImage(FileStorage& storage, const std::vector<uint8_t>& image) {
+  std::vector<uint8_t> readBack(image.size());
+  storage.read(0, readBack.data(), readBack.size());
+  return(readBack == image);
+}
+
+BOOST_AUTO_TEST_SUITE(suite_Fragmentation)
+
+BOOST_AUTO_TEST_CASE(Fragmentation_ParityRow) {
+  BOOST_TEST_MESSAGE("--- Test Fragmentation::getParityRow ---");
+
+  // every line has at most m/2 coefficients, and lines differ from each other
+  const uint16_t m = 64;
+  uint8_t row1[m / 8];
+  uint8_t row2[m / 8];
+  LoRaWANFragmentation::getParityRow(1, m, row1);
+  LoRaWANFragmentation::getParityRow(2, m, row2);
+  size_t weight = 0;
+  for(size_t i = 0; i < sizeof(row1); i++) {
+    weight += rlb_popcount(row1[i]);
+  }
+  BOOST_TEST(weight > 0);
+  BOOST_TEST(weight <= m / 2);
+  BOOST_TEST(memcmp(row1, row2, sizeof(row1)) != 0);
+}
+
+BOOST_AUTO_TEST_CASE(Fragmentation_LossyImage) {
+  BOOST_TEST_MESSAGE("--- Test Fragmentation 120 kB image with 10 % loss ---");
+
+  const uint16_t m = 1000;
+  const uint8_t size = 120;
+  const uint8_t padding = 7;
+  std::vector<uint8_t> image(m * size);
+  srand(1234);
+  for(size_t i = 0; i < image.size(); i++) {
+    image[i] = rand() & 0xFF;
+  }
+
+  FileStorage storage;
+  LoRaWANFragmentation frag(&storage);
+  BOOST_TEST(frag.beginSession(m, size, padding) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(frag.getSize() == (size_t)m * size - padding);
+
+  // send uncoded fragments followed by 30 % redundancy, dropping 10 % of all fragments
+  uint8_t buff[size];
+  uint16_t n = 1;
+  for(; (n <= m * 13 / 10) && !frag.isComplete(); n++) {
+    if((rand() % 10) == 0) {
+      continue;
+    }
+    encodeFragment(image, m, size, n, buff);
+    BOOST_TEST(frag.addFragment(n, buff) == RADIOLIB_ERR_NONE);
+  }
+  BOOST_TEST(frag.isComplete());
+  BOOST_TEST(frag.getMissing() == 0);
+  BOOST_TEST(checkImage(storage, image));
+  BOOST_TEST_MESSAGE("Finished after " << n - 1 << " fragments");
+}
+
+BOOST_AUTO_TEST_CASE(Fragmentation_Downlink) {
+  BOOST_TEST_MESSAGE("--- Test Fragmentation::handleDownlink ---");
+
+  const uint16_t m = 20;
+  const uint8_t size = 16;
+  std::vector<uint8_t> image(m * size);
+  for(size_t i = 0; i < image.size(); i++) {
+    image[i] = i * 7;
+  }
+
+  FileStorage storage;
+  LoRaWANFragmentation frag(&storage);
+  uint8_t ans[RADIOLIB_LORAWAN_FRAG_MAX_ANS_LEN];
+  size_t ansLen = 0;
+
+  // PackageVersionReq
+  uint8_t versionReq[] = { RADIOLIB_LORAWAN_FRAG_CMD_PACKAGE_VERSION };
+  BOOST_TEST(frag.handleDownlink(versionReq, sizeof(versionReq)) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(frag.getUplink(ans, &ansLen) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(ansLen == 3);
+  BOOST_TEST(ans[1] == RADIOLIB_LORAWAN_FRAG_PACKAGE_ID);
+  BOOST_TEST(ans[2] == RADIOLIB_LORAWAN_FRAG_PACKAGE_VERSION);
+
+  // FragSessionSetupReq for index 1, followed by FragSessionStatusReq in the same frame
+  uint8_t setupReq[] = { RADIOLIB_LORAWAN_FRAG_CMD_SESSION_SETUP, 0x10 | 0x01, m, 0x00, size, 0x00, 0x00, 0x78, 0x56, 0x34, 0x12,
+                         RADIOLIB_LORAWAN_FRAG_CMD_SESSION_STATUS, (0x01 << 1) | 0x01 };
+  BOOST_TEST(frag.handleDownlink(setupReq, sizeof(setupReq)) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(frag.getUplink(ans, &ansLen) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(ansLen == 7);
+  BOOST_TEST(ans[1] == (0x01 << 6));
+  BOOST_TEST(ans[5] == m);
+  BOOST_TEST(frag.getDescriptor() == 0x12345678);
+
+  // DataFragment, skip the first two and recover them from coded ones
+  uint8_t dataFrag[RADIOLIB_LORAWAN_FRAG_DATA_FRAGMENT_HDR_LEN + 1 + size];
+  dataFrag[0] = RADIOLIB_LORAWAN_FRAG_CMD_DATA_FRAGMENT;
+  for(uint16_t n = 3; (n <= 2*m) && !frag.isComplete(); n++) {
+    uint16_t indexAndN = (0x01 << 14) | n;
+    dataFrag[1] = indexAndN & 0xFF;
+    dataFrag[2] = indexAndN >> 8;
+    encodeFragment(image, m, size, n, &dataFrag[3]);
+    BOOST_TEST(frag.handleDownlink(dataFrag, sizeof(dataFrag)) == RADIOLIB_ERR_NONE);
+  }
+  BOOST_TEST(frag.isComplete());
+  BOOST_TEST(checkImage(storage, image));
+
+  // FragSessionDeleteReq, second one should fail
+  uint8_t deleteReq[] = { RADIOLIB_LORAWAN_FRAG_CMD_SESSION_DELETE, 0x01 };
+  BOOST_TEST(frag.handleDownlink(deleteReq, sizeof(deleteReq)) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(frag.handleDownlink(deleteReq, sizeof(deleteReq)) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(frag.getUplink(ans, &ansLen) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(ansLen == 4);
+  BOOST_TEST(ans[1] == 0x01);
+  BOOST_TEST(ans[3] == (0x01 | RADIOLIB_LORAWAN_FRAG_DELETE_NO_SESSION));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
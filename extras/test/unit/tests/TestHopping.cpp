@@ -0,0 +1,132 @@
+// boost test header
+#include <boost/test/unit_test.hpp>
+
+// the radio headers and the emulated hardware
+#include <RadioLib.h>
+#include "TestHal.hpp"
+#include "EmulatedSX126x.hpp"
+
+// SX1262 connected to emulated hardware
+class HoppingFixture {
+  public:
+    TestHal hal;
+    EmulatedSX126x chip;
+    Module mod;
+    SX1262 radio;
+
+    HoppingFixture() : mod(&hal, EMULATED_RADIO_NSS_PIN, EMULATED_RADIO_IRQ_PIN, EMULATED_RADIO_RST_PIN, EMULATED_RADIO_GPIO_PIN), radio(&mod) {
+      hal.connectRadio(&chip);
+      hal.spiLogEnabled = false;
+    }
+
+    // raw frequency word from the last SetRfFrequency command
+    uint32_t lastWord() {
+      const std::vector<uint8_t>& p = this->chip.cmds.at(RADIOLIB_SX126X_CMD_SET_RF_FREQUENCY);
+      return(((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3]);
+    }
+};
+
+// check the frequency and get the word without any SPI traffic
+static void checkWord(PhysicalLayer& phy, TestHal& hal, float freq, uint32_t expected, float outOfRange) {
+  uint32_t word = 0;
+  hal.spiLogWipe();
+  BOOST_TEST(phy.checkFrequency(freq) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(phy.checkFrequency(outOfRange) == RADIOLIB_ERR_INVALID_FREQUENCY);
+  BOOST_TEST(phy.calculateFrequencyWord(freq, &word) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(word == expected);
+  BOOST_TEST(phy.calculateFrequencyWord(freq, NULL) == RADIOLIB_ERR_NULL_POINTER);
+
+  const uint8_t none[16] = { 0 };
+  BOOST_TEST(hal.spiLogMemcmp(none, sizeof(none)) == 0);
+}
+
+BOOST_AUTO_TEST_SUITE(suite_Hopping)
+
+BOOST_AUTO_TEST_CASE(Hopping_FrequencyWords) {
+  BOOST_TEST_MESSAGE("--- Test per-module frequency checks and words ---");
+
+  TestHal hal;
+  EmulatedRadio bare;
+  hal.connectRadio(&bare);
+  Module mod(&hal, EMULATED_RADIO_NSS_PIN, EMULATED_RADIO_IRQ_PIN, EMULATED_RADIO_RST_PIN, EMULATED_RADIO_GPIO_PIN);
+
+  // each module uses its own synthesizer formula
+  SX1262 sx1262(&mod);
+  checkWord(sx1262, hal, 868.0f, 0x36400000UL, 961.0f);
+  SX1268 sx1268(&mod);
+  checkWord(sx1268, hal, 433.0f, 0x1B100000UL, 868.0f);
+  SX1278 sx1278(&mod);
+  checkWord(sx1278, hal, 434.0f, 0x6C8000UL, 868.0f);
+  SX1272 sx1272(&mod);
+  checkWord(sx1272, hal, 915.0f, 0xE4C000UL, 434.0f);
+  SX1280 sx1280(&mod);
+  checkWord(sx1280, hal, 2450.0f, 12351015UL, 2399.0f);
+  RF69 rf69(&mod);
+  checkWord(rf69, hal, 915.0f, 0xE4C000UL, 700.0f);
+  CC1101 cc1101(&mod);
+  checkWord(cc1101, hal, 868.0f, 2187894UL, 700.0f);
+  LR1110 lr1110(&mod);
+  checkWord(lr1110, hal, 868.0f, 868000000UL, 2450.0f);
+  LR1120 lr1120(&mod);
+  checkWord(lr1120, hal, 2400.0f, 2400000000UL, 1000.0f);
+}
+
+BOOST_FIXTURE_TEST_CASE(Hopping_Sequence, HoppingFixture) {
+  BOOST_TEST_MESSAGE("--- Test hopping sequence setup ---");
+
+  BOOST_REQUIRE(radio.begin(868.0) == RADIOLIB_ERR_NONE);
+
+  // an invalid channel is rejected before the radio is touched
+  const float bad[] = { 868.1f, 1000.0f };
+  uint32_t words[3] = { 0 };
+  chip.cmds.clear();
+  BOOST_TEST(radio.setHoppingSequence(bad, words, 2) == RADIOLIB_ERR_INVALID_FREQUENCY);
+  BOOST_TEST(chip.cmds.empty());
+
+  // the radio is only retuned once, to the first channel of the sequence
+  const float channels[] = { 868.1f, 868.3f, 868.5f };
+  const uint8_t sequence[] = { 2, 0, 1 };
+  BOOST_REQUIRE(radio.setHoppingSequence(channels, words, 3, sequence, 3) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(chip.cmds.count(RADIOLIB_SX126X_CMD_CALIBRATE_IMAGE) == 0);
+  BOOST_TEST(radio.getHoppingChannel() == 2);
+  BOOST_TEST(lastWord() == words[2]);
+
+  BOOST_TEST(radio.hopFrequency() == RADIOLIB_ERR_NONE);
+  BOOST_TEST(radio.getHoppingChannel() == 0);
+  BOOST_TEST(lastWord() == words[0]);
+
+  // the words are the same as the ones written by setFrequency
+  for(size_t i = 0; i < 3; i++) {
+    BOOST_TEST_CONTEXT("channel " << i) {
+      BOOST_REQUIRE(radio.setFrequency(channels[i], true) == RADIOLIB_ERR_NONE);
+      BOOST_TEST(lastWord() == words[i]);
+    }
+  }
+}
+
+BOOST_FIXTURE_TEST_CASE(Hopping_SaveRestore, HoppingFixture) {
+  BOOST_TEST_MESSAGE("--- Test configuration snapshot after a hop ---");
+
+  BOOST_REQUIRE(radio.begin(868.0) == RADIOLIB_ERR_NONE);
+  const float channels[] = { 868.1f, 868.3f, 868.5f };
+  uint32_t words[3] = { 0 };
+  BOOST_REQUIRE(radio.setHoppingSequence(channels, words, 3) == RADIOLIB_ERR_NONE);
+  BOOST_REQUIRE(radio.hopFrequency() == RADIOLIB_ERR_NONE);
+  BOOST_REQUIRE(radio.getHoppingChannel() == 1);
+
+  // the cached frequency follows the hop
+  BOOST_TEST(radio.freqMHz == channels[1], boost::test_tools::tolerance(0.0001f));
+
+  // retune and lose the configuration in cold sleep
+  uint8_t config[RADIOLIB_SX126X_CONFIG_BUF_SIZE];
+  BOOST_REQUIRE(radio.saveConfig(config) == RADIOLIB_ERR_NONE);
+  BOOST_REQUIRE(radio.setFrequency(869.0) == RADIOLIB_ERR_NONE);
+  chip.powerUp();
+
+  // the radio comes back on the channel it hopped to
+  BOOST_REQUIRE(radio.restoreConfig(config) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(lastWord() == words[1]);
+  BOOST_TEST(radio.freqMHz == channels[1], boost::test_tools::tolerance(0.0001f));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
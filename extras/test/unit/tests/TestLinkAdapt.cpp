@@ -0,0 +1,98 @@
+// boost test header
+#include <boost/test/unit_test.hpp>
+
+// the LoRaWAN headers
+#include "protocols/LoRaWAN/LoRaWAN.h"
+#include "protocols/LoRaWAN/LoRaWANLinkAdapt.h"
+#include "LoRaWANFixture.hpp"
+
+BOOST_AUTO_TEST_SUITE(suite_LinkAdapt)
+
+BOOST_AUTO_TEST_CASE(LinkAdapt_Estimate) {
+  BOOST_TEST_MESSAGE("--- Test LoRaWANLinkAdapt statistics ---");
+
+  StubRadio radio;
+  LoRaWANNode node(&radio, &EU868);
+  LoRaWANLinkAdapt adapt(&node);
+
+  // 90 % is 1.28 standard deviations
+  BOOST_TEST(adapt.zTarget == 1.2816f, boost::test_tools::tolerance(0.01f));
+  adapt.setTarget(0.99f);
+  BOOST_TEST(adapt.zTarget == 2.3263f, boost::test_tools::tolerance(0.01f));
+
+  // samples are normalized to 0 dBm, and only the last window is kept
+  float mean = 0;
+  float dev = 0;
+  BOOST_TEST(adapt.getEstimate(&mean, &dev) == 0);
+  for(int i = 0; i < RADIOLIB_LORAWAN_LINK_ADAPT_WINDOW + 4; i++) {
+    adapt.addSample((i % 2) ? -1.0f : -3.0f, 14);
+  }
+  BOOST_TEST(adapt.getEstimate(&mean, &dev) == RADIOLIB_LORAWAN_LINK_ADAPT_WINDOW);
+  BOOST_TEST(mean == -16.0f, boost::test_tools::tolerance(0.001f));
+  BOOST_TEST(dev > 0.9f);
+  BOOST_TEST(dev < 1.2f);
+
+  adapt.reset();
+  BOOST_TEST(adapt.getEstimate(NULL, NULL) == 0);
+
+  // SF12 and SF7
+  BOOST_TEST(LoRaWANLinkAdapt::getRequiredSnr(0, &EU868) == -20.0f);
+  BOOST_TEST(LoRaWANLinkAdapt::getRequiredSnr(5, &EU868) == -7.5f);
+}
+
+BOOST_AUTO_TEST_CASE(LinkAdapt_Select) {
+  BOOST_TEST_MESSAGE("--- Test LoRaWANLinkAdapt datarate and power selection ---");
+
+  StubRadio radio;
+  LoRaWANNode node(&radio, &EU868);
+  BOOST_TEST(activateFixture(node) == RADIOLIB_LORAWAN_NEW_SESSION);
+
+  BOOST_TEST(node.setDatarate(3) == RADIOLIB_ERR_NONE);
+
+  LoRaWANLinkAdapt adapt(&node);
+  LoRaWANEvent_t eventUp = { };
+  eventUp.datarate = 3;
+  eventUp.power = node.txPowerMax;
+
+  // the network is in charge unless ADR is disabled
+  BOOST_TEST(adapt.update(0, 10, &eventUp, NULL) == RADIOLIB_ERR_INVALID_MODE);
+  node.setADR(false);
+
+  // strong link: fastest LoRa datarate, with some power to spare
+  for(int i = 0; i < RADIOLIB_LORAWAN_LINK_ADAPT_MIN_SAMPLES; i++) {
+    adapt.addSample(10.0f, 16);
+  }
+  BOOST_TEST(adapt.adapt(10) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(node.channels[RADIOLIB_LORAWAN_UPLINK].dr == 5);
+  BOOST_TEST(node.txPowerSteps > 0);
+
+  // weak link: slowest datarate at full power
+  adapt.reset();
+  for(int i = 0; i < RADIOLIB_LORAWAN_LINK_ADAPT_MIN_SAMPLES; i++) {
+    adapt.addSample(-20.0f, 16);
+  }
+  BOOST_TEST(adapt.adapt(10) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(node.channels[RADIOLIB_LORAWAN_UPLINK].dr == 0);
+  BOOST_TEST(node.txPowerSteps == 0);
+
+  // limits set by the application are respected
+  BOOST_TEST(adapt.setDatarateLimits(3, 2) == RADIOLIB_ERR_INVALID_DATA_RATE);
+  BOOST_TEST(adapt.setDatarateLimits(2, 4) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(adapt.adapt(10) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(node.channels[RADIOLIB_LORAWAN_UPLINK].dr == 2);
+
+  // uplinks without any downlink back off towards full power and slower datarates
+  node.txPowerSteps = 2;
+  adapt.setLinkCheckPeriod(2);
+  for(int i = 0; i < 4; i++) {
+    BOOST_TEST(adapt.update(0, 10, &eventUp, NULL) == RADIOLIB_ERR_NONE);
+  }
+  BOOST_TEST(node.txPowerSteps == 0);
+  BOOST_TEST(node.channels[RADIOLIB_LORAWAN_UPLINK].dr == 2);
+  for(int i = 0; i < 4; i++) {
+    BOOST_TEST(adapt.update(0, 10, &eventUp, NULL) == RADIOLIB_ERR_NONE);
+  }
+  BOOST_TEST(node.channels[RADIOLIB_LORAWAN_UPLINK].dr == 2);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,188 @@
+// boost test header
+#include <boost/test/unit_test.hpp>
+
+// the LoRaWAN header
+#include "protocols/LoRaWAN/LoRaWAN.h"
+#include "LoRaWANFixture.hpp"
+#include "TestHal.hpp"
+
+#include <vector>
+
+// radio that hands a prepared downlink to the node, and keeps the uplink it was asked to stage
+// the uplink itself is refused, so that sending never blocks on the IRQ pin
+class MacRadio : public StubRadio {
+  public:
+    TestHal hal;
+    Module mod;
+    std::vector<uint8_t> downlink;
+
+    MacRadio() : mod(&hal, RADIOLIB_NC, RADIOLIB_NC, RADIOLIB_NC) {
+      hal.init();
+    }
+
+    int16_t setFrequency(float freq) override { (void)freq; return(RADIOLIB_ERR_NONE); }
+    int16_t setOutputPower(int8_t power) override { (void)power; return(RADIOLIB_ERR_NONE); }
+    int16_t invertIQ(bool enable) override { (void)enable; return(RADIOLIB_ERR_NONE); }
+    int16_t setSyncWord(uint8_t* sync, size_t len) override { (void)sync; (void)len; return(RADIOLIB_ERR_NONE); }
+    int16_t setPreambleLength(size_t len) override { (void)len; return(RADIOLIB_ERR_NONE); }
+    int16_t setDataRate(DataRate_t dr, ModemType_t modem) override { (void)dr; (void)modem; return(RADIOLIB_ERR_NONE); }
+    float getSNR() override { return(5); }
+    size_t getPacketLength(bool update) override { (void)update; return(this->downlink.size()); }
+    int16_t readData(uint8_t* data, size_t len) override {
+      memcpy(data, this->downlink.data(), len);
+      return(RADIOLIB_ERR_NONE);
+    }
+    int16_t stageMode(RadioModeType_t mode, RadioModeConfig_t* cfg) override {
+      if(mode == RADIOLIB_RADIO_MODE_TX) {
+        this->sent.assign(cfg->transmit.data, cfg->transmit.data + cfg->transmit.len);
+      }
+      return(RADIOLIB_ERR_TX_TIMEOUT);
+    }
+
+  private:
+    Module* getMod() override { return(&this->mod); }
+};
+
+// build an unconfirmed downlink for the fixture session, with MAC commands either in FOpts or in the FPort 0 payload
+static std::vector<uint8_t> buildMacDownlink(LoRaWANNode& node, uint16_t fCnt, const uint8_t* cmds, uint8_t len, bool piggyBack) {
+  std::vector<uint8_t> msg(RADIOLIB_AES128_BLOCK_SIZE + RADIOLIB_LORAWAN_FHDR_FOPTS_POS - RADIOLIB_LORAWAN_FHDR_LEN_START_OFFS, 0);
+  uint8_t* frame = &msg[RADIOLIB_AES128_BLOCK_SIZE];
+  frame[0] = RADIOLIB_LORAWAN_MHDR_MTYPE_UNCONF_DATA_DOWN | RADIOLIB_LORAWAN_MHDR_MAJOR_R1;
+  LoRaWANNode::hton<uint32_t>(&frame[1], LORAWAN_FIXTURE_DEV_ADDR);
+  LoRaWANNode::hton<uint16_t>(&frame[6], fCnt);
+  if(piggyBack) {
+    // LoRaWAN v1.0 FOpts are not encrypted
+    frame[5] = len;
+    msg.insert(msg.end(), cmds, cmds + len);
+  } else {
+    msg.push_back(RADIOLIB_LORAWAN_FPORT_MAC_COMMAND);
+    msg.resize(msg.size() + len);
+    node.processAES(cmds, len, node.nwkSEncKey, &msg[msg.size() - len], LORAWAN_FIXTURE_DEV_ADDR, fCnt, RADIOLIB_LORAWAN_DOWNLINK, 0x00, true);
+  }
+
+  // MIC calculation block in front of the frame
+  size_t frameLen = msg.size() - RADIOLIB_AES128_BLOCK_SIZE;
+  msg[RADIOLIB_LORAWAN_BLOCK_MAGIC_POS] = RADIOLIB_LORAWAN_MIC_BLOCK_MAGIC;
+  msg[RADIOLIB_LORAWAN_BLOCK_DIR_POS] = RADIOLIB_LORAWAN_DOWNLINK;
+  LoRaWANNode::hton<uint32_t>(&msg[RADIOLIB_LORAWAN_BLOCK_DEV_ADDR_POS], LORAWAN_FIXTURE_DEV_ADDR);
+  LoRaWANNode::hton<uint32_t>(&msg[RADIOLIB_LORAWAN_BLOCK_FCNT_POS], fCnt);
+  msg[RADIOLIB_LORAWAN_MIC_BLOCK_LEN_POS] = frameLen;
+  uint32_t mic = node.generateMIC(msg.data(), msg.size(), node.sNwkSIntKey);
+  msg.resize(msg.size() + sizeof(uint32_t));
+  LoRaWANNode::hton<uint32_t>(&msg[msg.size() - sizeof(uint32_t)], mic);
+
+  return(std::vector<uint8_t>(msg.begin() + RADIOLIB_AES128_BLOCK_SIZE, msg.end()));
+}
+
+BOOST_AUTO_TEST_SUITE(suite_MacCommands)
+
+BOOST_AUTO_TEST_CASE(MacCommands_Lookup) {
+  BOOST_TEST_MESSAGE("--- Test LoRaWANNode::findMacCommand ---");
+
+  // every command in the table is found at its CID, and nothing else is
+  for(size_t i = 0; i < RADIOLIB_LORAWAN_NUM_MAC_COMMANDS; i++) {
+    if(MacTable[i].cid == 0) {
+      continue;
+    }
+    const LoRaWANMacCommand_t* cmd = LoRaWANNode::findMacCommand(MacTable[i].cid);
+    BOOST_REQUIRE(cmd != nullptr);
+    BOOST_TEST(cmd->cid == MacTable[i].cid);
+  }
+  BOOST_TEST(LoRaWANNode::findMacCommand(0x00) == nullptr);
+  BOOST_TEST(LoRaWANNode::findMacCommand(0x12) == nullptr);
+  BOOST_TEST(LoRaWANNode::findMacCommand(0x81) == nullptr);
+
+  StubRadio radio;
+  LoRaWANNode node(&radio, &EU868);
+  uint8_t len = 0;
+  BOOST_TEST(node.getMacLen(RADIOLIB_LORAWAN_MAC_LINK_ADR, &len, RADIOLIB_LORAWAN_DOWNLINK, true) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(len == 5);
+  BOOST_TEST(node.getMacLen(RADIOLIB_LORAWAN_MAC_DEV_STATUS, &len, RADIOLIB_LORAWAN_UPLINK) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(len == 2);
+  BOOST_TEST(node.getMacLen(0x12, &len, RADIOLIB_LORAWAN_UPLINK) == RADIOLIB_ERR_INVALID_CID);
+}
+
+BOOST_AUTO_TEST_CASE(MacCommands_Queue) {
+  BOOST_TEST_MESSAGE("--- Test LoRaWAN MAC command queue ---");
+
+  StubRadio radio;
+  LoRaWANNode node(&radio, &EU868);
+  uint8_t queue[RADIOLIB_LORAWAN_FHDR_FOPTS_MAX_LEN] = { 0 };
+  uint8_t len = 0;
+
+  // LinkCheckReq, RxParamSetupAns (persistent), DevStatusAns, RxTimingSetupAns (persistent), DutyCycleAns
+  uint8_t rxParam = 0x07;
+  uint8_t devStatus[2] = { 0xFF, 0x12 };
+  BOOST_TEST(node.pushMacCommand(RADIOLIB_LORAWAN_MAC_LINK_CHECK, NULL, queue, &len, RADIOLIB_LORAWAN_UPLINK) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(node.pushMacCommand(RADIOLIB_LORAWAN_MAC_RX_PARAM_SETUP, &rxParam, queue, &len, RADIOLIB_LORAWAN_UPLINK) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(node.pushMacCommand(RADIOLIB_LORAWAN_MAC_DEV_STATUS, devStatus, queue, &len, RADIOLIB_LORAWAN_UPLINK) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(node.pushMacCommand(RADIOLIB_LORAWAN_MAC_RX_TIMING_SETUP, NULL, queue, &len, RADIOLIB_LORAWAN_UPLINK) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(node.pushMacCommand(RADIOLIB_LORAWAN_MAC_DUTY_CYCLE, NULL, queue, &len, RADIOLIB_LORAWAN_UPLINK) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(len == 1 + 2 + 3 + 1 + 1);
+
+  uint8_t payload[2] = { 0 };
+  BOOST_TEST(node.getMacPayload(RADIOLIB_LORAWAN_MAC_DEV_STATUS, queue, len, payload, RADIOLIB_LORAWAN_UPLINK) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(payload[1] == 0x12);
+
+  // adjacent non-persistent commands are all removed, persistent ones keep their payload
+  node.clearMacCommands(queue, &len, RADIOLIB_LORAWAN_UPLINK);
+  const uint8_t expected[] = { RADIOLIB_LORAWAN_MAC_RX_PARAM_SETUP, 0x07, RADIOLIB_LORAWAN_MAC_RX_TIMING_SETUP };
+  BOOST_REQUIRE(len == sizeof(expected));
+  BOOST_TEST(memcmp(queue, expected, sizeof(expected)) == 0);
+  BOOST_TEST(queue[len] == 0);
+
+  // deleting from the front keeps the rest intact
+  BOOST_TEST(node.deleteMacCommand(RADIOLIB_LORAWAN_MAC_RX_PARAM_SETUP, queue, &len, RADIOLIB_LORAWAN_UPLINK) == RADIOLIB_ERR_NONE);
+  BOOST_REQUIRE(len == 1);
+  BOOST_TEST(queue[0] == RADIOLIB_LORAWAN_MAC_RX_TIMING_SETUP);
+  BOOST_TEST(queue[1] == 0);
+  BOOST_TEST(node.deleteMacCommand(RADIOLIB_LORAWAN_MAC_RX_PARAM_SETUP, queue, &len, RADIOLIB_LORAWAN_UPLINK) == RADIOLIB_ERR_COMMAND_QUEUE_ITEM_NOT_FOUND);
+}
+
+BOOST_AUTO_TEST_CASE(MacCommands_ParseDownlinkAnswers) {
+  BOOST_TEST_MESSAGE("--- Test LoRaWAN MAC answers in FOpts and in a MAC-only uplink ---");
+
+  MacRadio radio;
+  LoRaWANNode node(&radio, &EU868);
+  BOOST_REQUIRE(activateFixture(node) == RADIOLIB_LORAWAN_NEW_SESSION);
+  node.setDeviceStatus(0x42);
+  uint8_t data[RADIOLIB_LORAWAN_MAX_PAYLOAD_SIZE] = { 0 };
+  size_t len = 0;
+
+  // three DevStatusReq in FOpts, the answers are written straight into the uplink queue
+  uint8_t cmds[8];
+  memset(cmds, RADIOLIB_LORAWAN_MAC_DEV_STATUS, sizeof(cmds));
+  radio.downlink = buildMacDownlink(node, 1, cmds, 3, true);
+  BOOST_REQUIRE(node.parseDownlink(data, &len, RADIOLIB_LORAWAN_RX1) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(len == 0);
+  const uint8_t ans[] = { RADIOLIB_LORAWAN_MAC_DEV_STATUS, 0x42, 0x05 };
+  BOOST_REQUIRE(node.fOptsUpLen == 3*sizeof(ans));
+  for(size_t i = 0; i < 3; i++) {
+    BOOST_TEST(memcmp(&node.fOptsUp[i*sizeof(ans)], ans, sizeof(ans)) == 0);
+  }
+  BOOST_TEST(!node.isMACPayload);
+  BOOST_TEST(radio.sent.empty());
+
+  // eight DevStatusReq in the payload do not fit into FOpts, so they go out in a MAC-only uplink
+  radio.downlink = buildMacDownlink(node, 2, cmds, sizeof(cmds), false);
+  BOOST_REQUIRE(node.parseDownlink(data, &len, RADIOLIB_LORAWAN_RX1) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(len == 0);
+  BOOST_TEST(node.fOptsUpLen == 0);
+
+  // the uplink has no FOpts, and all the answers in the FPort 0 payload
+  const size_t macLen = sizeof(cmds)*sizeof(ans);
+  BOOST_REQUIRE(radio.sent.size() == RADIOLIB_LORAWAN_FRAME_LEN(macLen, 0) - RADIOLIB_LORAWAN_FHDR_LEN_START_OFFS);
+  const uint8_t* frame = radio.sent.data();
+  BOOST_TEST((frame[5] & RADIOLIB_LORAWAN_FHDR_FOPTS_LEN_MASK) == 0);
+  BOOST_TEST(frame[8] == RADIOLIB_LORAWAN_FPORT_MAC_COMMAND);
+  uint8_t macUp[macLen];
+  uint16_t fCntUp = LoRaWANNode::ntoh<uint16_t>(&frame[6]);
+  node.processAES(&frame[9], macLen, node.nwkSEncKey, macUp, LORAWAN_FIXTURE_DEV_ADDR, fCntUp, RADIOLIB_LORAWAN_UPLINK, 0x00, true);
+  for(size_t i = 0; i < sizeof(cmds); i++) {
+    BOOST_TEST_CONTEXT("answer " << i) {
+      BOOST_TEST(memcmp(&macUp[i*sizeof(ans)], ans, sizeof(ans)) == 0);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
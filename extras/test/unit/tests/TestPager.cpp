@@ -0,0 +1,303 @@
+// boost test header
+#include <boost/test/unit_test.hpp>
+
+// the Pager header
+#include "protocols/Pager/Pager.h"
+#include "StubRadio.hpp"
+
+#include <string.h>
+#include <vector>
+
+// radio with FSK frequency step, received bits are pushed to its direct mode buffer by the test
+class PagerRadio : public StubRadio {
+  public:
+    PagerRadio() { this->freqStep = 61.0f; }
+
+    // POCSAG high frequency is logic 0, so the module sees inverted bits
+    void receive(const std::vector<uint32_t>& cws) {
+      for(uint32_t cw : cws) {
+        for(int i = 31; i >= 0; i--) {
+          this->updateDirectBuffer(((~cw) >> i) & 0x01);
+        }
+      }
+    }
+};
+
+// address code word for the given pager address
+static uint32_t addressCodeWord(uint32_t addr, uint8_t function) {
+  return(RadioLibBCHInstance.encode(((addr >> 3) << RADIOLIB_PAGER_ADDRESS_POS) | ((uint32_t)function << RADIOLIB_PAGER_FUNC_BITS_POS)));
+}
+
+// message code words, symbols are sent LSB first and split across code words
+static std::vector<uint32_t> messageCodeWords(const std::vector<uint8_t>& symbols, uint8_t symbolLength) {
+  std::vector<uint8_t> bits;
+  for(uint8_t sym : symbols) {
+    for(uint8_t i = 0; i < symbolLength; i++) {
+      bits.push_back((sym >> i) & 0x01);
+    }
+  }
+  while(bits.size() % RADIOLIB_PAGER_MESSAGE_BITS_LENGTH) {
+    bits.push_back(0);
+  }
+
+  std::vector<uint32_t> cws;
+  for(size_t i = 0; i < bits.size(); i += RADIOLIB_PAGER_MESSAGE_BITS_LENGTH) {
+    uint32_t cw = RADIOLIB_PAGER_MESSAGE_CODE_WORD << (RADIOLIB_PAGER_CODE_WORD_LEN - 1);
+    for(uint8_t j = 0; j < RADIOLIB_PAGER_MESSAGE_BITS_LENGTH; j++) {
+      cw |= (uint32_t)bits[i + j] << (RADIOLIB_PAGER_CODE_WORD_LEN - 2 - j);
+    }
+    cws.push_back(RadioLibBCHInstance.encode(cw));
+  }
+  return(cws);
+}
+
+// preamble and two batches with a numeric message for the given address
+static std::vector<uint32_t> pagerTransmission(uint32_t addr, const std::vector<uint8_t>& digits) {
+  std::vector<uint32_t> line(8, RADIOLIB_PAGER_PREAMBLE_CODE_WORD);
+  std::vector<uint32_t> batches(2*(RADIOLIB_PAGER_BATCH_LEN + 1), RADIOLIB_PAGER_IDLE_CODE_WORD);
+  batches[0] = RADIOLIB_PAGER_FRAME_SYNC_CODE_WORD;
+  batches[RADIOLIB_PAGER_BATCH_LEN + 1] = RADIOLIB_PAGER_FRAME_SYNC_CODE_WORD;
+  size_t pos = 1 + 2*(addr & 0x07);
+  batches[pos++] = addressCodeWord(addr, RADIOLIB_PAGER_FUNC_BITS_NUMERIC);
+  for(uint32_t cw : messageCodeWords(digits, 4)) {
+    if((pos % (RADIOLIB_PAGER_BATCH_LEN + 1)) == 0) {
+      pos++;
+    }
+    batches[pos++] = cw;
+  }
+  line.insert(line.end(), batches.begin(), batches.end());
+  return(line);
+}
+
+// the module samples the signal at a fixed rate, the transmitter clock may be a bit off
+static void sampleTransmission(PagerRadio& radio, PagerClient& pager, const std::vector<uint32_t>& cws, uint16_t speed, double clockError) {
+  size_t numBits = cws.size()*32;
+  for(size_t n = 0; ; n++) {
+    size_t bit = (size_t)((n + 0.5) * speed * (1.0 + clockError) / RADIOLIB_PAGER_MULTI_RATE_SAMPLE_RATE);
+    if(bit >= numBits) {
+      break;
+    }
+    uint8_t level = (cws[bit / 32] >> (31 - (bit % 32))) & 0x01;
+    radio.updateDirectBuffer(level ^ 0x01);
+
+    // processed often enough to keep the direct mode buffer from overflowing
+    if((n % 64) == 0) {
+      (void)pager.available();
+    }
+  }
+}
+
+BOOST_AUTO_TEST_SUITE(suite_Pager)
+
+BOOST_AUTO_TEST_CASE(Pager_BCH) {
+  BOOST_TEST_MESSAGE("--- Test BCH(31, 21) code word correction ---");
+  RadioLibBCHInstance.begin(RADIOLIB_PAGER_BCH_N, RADIOLIB_PAGER_BCH_K, RADIOLIB_PAGER_BCH_PRIMITIVE_POLY);
+
+  const uint32_t data[] = { 0x00000000UL, 0x7FFFF800UL, 0x12345800UL, 0xABCDE000UL };
+  for(uint32_t d : data) {
+    uint32_t cw = RadioLibBCHInstance.encode(d);
+    uint32_t rx = cw;
+    BOOST_TEST(RadioLibBCHInstance.decode(&rx) == 0);
+    BOOST_TEST(rx == cw);
+
+    // every single and double error is corrected, including the parity bit
+    for(int i = 0; i < 32; i++) {
+      for(int j = i; j < 32; j++) {
+        rx = cw ^ ((uint32_t)1 << i) ^ ((i == j) ? 0 : ((uint32_t)1 << j));
+        BOOST_TEST(RadioLibBCHInstance.decode(&rx) == ((i == j) ? 1 : 2));
+        BOOST_TEST(rx == cw);
+      }
+    }
+
+    // triple errors are detected thanks to the parity bit
+    rx = cw ^ 0x80000401UL;
+    BOOST_TEST(RadioLibBCHInstance.decode(&rx) == -1);
+  }
+
+  // protocol code words are valid as well
+  uint32_t cw = RADIOLIB_PAGER_FRAME_SYNC_CODE_WORD;
+  BOOST_TEST(RadioLibBCHInstance.decode(&cw) == 0);
+  cw = RADIOLIB_PAGER_IDLE_CODE_WORD;
+  BOOST_TEST(RadioLibBCHInstance.decode(&cw) == 0);
+}
+
+BOOST_AUTO_TEST_CASE(Pager_Filter) {
+  BOOST_TEST_MESSAGE("--- Test hashed address filter ---");
+
+  PagerRadio radio;
+  PagerClient pager(&radio);
+
+  // many exact capcodes, and two groups of addresses matched by mask
+  std::vector<uint32_t> addrs;
+  std::vector<uint32_t> masks;
+  for(uint32_t i = 0; i < 3000; i++) {
+    addrs.push_back((i * 697) % RADIOLIB_PAGER_ADDRESS_MAX);
+    masks.push_back(RADIOLIB_PAGER_ADDRESS_MAX);
+  }
+  addrs.push_back(0x150000);
+  masks.push_back(0x1F0000);
+  addrs.push_back(0x000123);
+  masks.push_back(0x000FFF);
+
+  pager.filterAddresses = addrs.data();
+  pager.filterMasks = masks.data();
+  pager.filterNumAddresses = addrs.size();
+  pager.buildFilter();
+  BOOST_REQUIRE(pager.filterTableBits > 0);
+  BOOST_TEST(pager.filterTableNumMasks == 3);
+
+  // same result as matching the filters one by one
+  uint32_t matched = 0;
+  for(uint32_t addr = 0; addr < RADIOLIB_PAGER_ADDRESS_MAX; addr += 7) {
+    bool expected = false;
+    for(size_t i = 0; i < addrs.size(); i++) {
+      if((addrs[i] & masks[i]) == (addr & masks[i])) {
+        expected = true;
+        break;
+      }
+    }
+    BOOST_TEST(pager.addressMatched(addr) == expected);
+    matched += expected;
+  }
+  BOOST_TEST(matched > 0);
+  BOOST_TEST(pager.addressMatched(697*5));
+  BOOST_TEST(pager.addressMatched(0x15ABCD));
+  BOOST_TEST(pager.addressMatched(0x1AB123));
+  BOOST_TEST(!pager.addressMatched(697*5 + 1));
+
+  // copies get their own lookup table
+  PagerClient copy(pager);
+  BOOST_TEST(copy.filterTable != pager.filterTable);
+  BOOST_TEST(copy.addressMatched(0x15ABCD));
+  PagerClient assigned(&radio);
+  assigned = copy;
+  BOOST_TEST(assigned.filterTable != copy.filterTable);
+  BOOST_TEST(assigned.addressMatched(697*5));
+  BOOST_TEST(!assigned.addressMatched(697*5 + 1));
+}
+
+BOOST_AUTO_TEST_CASE(Pager_Batch) {
+  BOOST_TEST_MESSAGE("--- Test POCSAG batch reception ---");
+
+  PagerRadio radio;
+  PagerClient pager(&radio);
+  BOOST_REQUIRE(pager.begin(434.0, 1200) == RADIOLIB_ERR_NONE);
+  radio.setDirectSyncWord(~RADIOLIB_PAGER_FRAME_SYNC_CODE_WORD, 32);
+
+  uint32_t addrs[] = { 1234567, 1234000 };
+  uint32_t masks[] = { RADIOLIB_PAGER_ADDRESS_MAX, RADIOLIB_PAGER_ADDRESS_MAX };
+  pager.filterAddresses = addrs;
+  pager.filterMasks = masks;
+  pager.filterNumAddresses = 2;
+  pager.buildFilter();
+
+  // numeric message in frame 7 of the first batch that continues into the second,
+  // then an alphanumeric message in frame 0 of the second batch
+  std::vector<uint32_t> batches(2*RADIOLIB_PAGER_BATCH_LEN + 1, RADIOLIB_PAGER_IDLE_CODE_WORD);
+  batches[RADIOLIB_PAGER_BATCH_LEN] = RADIOLIB_PAGER_FRAME_SYNC_CODE_WORD;
+  batches[14] = addressCodeWord(1234567, RADIOLIB_PAGER_FUNC_BITS_NUMERIC);
+  std::vector<uint32_t> num = messageCodeWords({ 0x01, 0x02, 0x03, 0x0C, 0x0A, 0x04, 0x05, 0x06, 0x0D, 0x07 }, 4);
+  batches[15] = num[0];
+  batches[17] = num[1];
+  batches[18] = addressCodeWord(1234000, RADIOLIB_PAGER_FUNC_BITS_ALPHA);
+  std::vector<uint32_t> alpha = messageCodeWords({ 'H', 'e', 'l', 'l', 'o', '!' }, 7);
+  for(size_t i = 0; i < alpha.size(); i++) {
+    batches[19 + i] = alpha[i];
+  }
+
+  // a message for some other pager
+  batches[24] = addressCodeWord(999, RADIOLIB_PAGER_FUNC_BITS_NUMERIC);
+  batches[25] = num[0];
+
+  // some bit errors
+  batches[14] ^= 0x00100002UL;
+  batches[17] ^= 0x40000000UL;
+  batches[20] ^= 0x00000801UL;
+
+  std::vector<uint32_t> line(4, RADIOLIB_PAGER_PREAMBLE_CODE_WORD);
+  line.push_back(RADIOLIB_PAGER_FRAME_SYNC_CODE_WORD);
+  line.insert(line.end(), batches.begin(), batches.end());
+  radio.receive(line);
+  BOOST_REQUIRE(pager.available() == 2);
+
+  PagerMessage_t msgs[4];
+  size_t numMsgs = 4;
+  uint8_t data[64];
+  BOOST_REQUIRE(pager.readBatch(msgs, &numMsgs, data, sizeof(data)) == RADIOLIB_ERR_NONE);
+  BOOST_REQUIRE(numMsgs == 2);
+
+  BOOST_TEST(msgs[0].addr == 1234567);
+  BOOST_TEST(msgs[0].function == RADIOLIB_PAGER_FUNC_BITS_NUMERIC);
+  BOOST_REQUIRE(msgs[0].len == 10);
+  BOOST_TEST(memcmp(msgs[0].data, "123 *456-7", 10) == 0);
+  BOOST_TEST(msgs[0].errors == 3);
+  BOOST_TEST(msgs[0].uncorrectable == 0);
+
+  BOOST_TEST(msgs[1].addr == 1234000);
+  BOOST_TEST(msgs[1].function == RADIOLIB_PAGER_FUNC_BITS_ALPHA);
+  BOOST_REQUIRE(msgs[1].len >= 6);
+  BOOST_TEST(memcmp(msgs[1].data, "Hello!", 6) == 0);
+  BOOST_TEST(msgs[1].errors == 2);
+  BOOST_TEST(pager.available() == 0);
+
+  // the same transmission read one message at a time
+  radio.setDirectSyncWord(~RADIOLIB_PAGER_FRAME_SYNC_CODE_WORD, 32);
+  radio.receive(line);
+  uint32_t addr = 0;
+  size_t len = 0;
+  BOOST_REQUIRE(pager.readData(data, &len, &addr) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(addr == 1234567);
+  BOOST_REQUIRE(len == 10);
+  BOOST_TEST(memcmp(data, "123 *456-7", 10) == 0);
+}
+
+BOOST_AUTO_TEST_CASE(Pager_MultiRate) {
+  BOOST_TEST_MESSAGE("--- Test multi-rate POCSAG reception ---");
+
+  PagerRadio radio;
+  PagerClient pager(&radio);
+  BOOST_REQUIRE(pager.begin(434.0, 1200) == RADIOLIB_ERR_NONE);
+  BOOST_REQUIRE(pager.setMultiRate(true) == RADIOLIB_ERR_NONE);
+  radio.setDirectSyncWord(0, 0);
+  pager.filterAddr = 0;
+  pager.filterMask = 0;
+
+  // the same pager receives a message at every rate, with the transmitter clock off by up to 0.5 %
+  const uint16_t speeds[] = { 512, 2400, 1200 };
+  const double clockErrors[] = { 0.005, -0.003, 0.002 };
+  std::vector<uint8_t> digits = { 0x05, 0x05, 0x05, 0x0D, 0x01, 0x02, 0x03, 0x04, 0x0C, 0x09, 0x08, 0x07 };
+  for(int i = 0; i < 3; i++) {
+    uint32_t addr = 1234560 + i;
+    sampleTransmission(radio, pager, pagerTransmission(addr, digits), speeds[i], clockErrors[i]);
+    sampleTransmission(radio, pager, std::vector<uint32_t>(2, 0x5A5A5A5A), 2400, 0.0);
+    BOOST_REQUIRE(pager.available() == 2);
+
+    PagerMessage_t msgs[2];
+    size_t numMsgs = 2;
+    uint8_t data[32];
+    BOOST_REQUIRE(pager.readBatch(msgs, &numMsgs, data, sizeof(data)) == RADIOLIB_ERR_NONE);
+    BOOST_REQUIRE(numMsgs == 1);
+    BOOST_TEST(msgs[0].addr == addr);
+    BOOST_TEST(msgs[0].speed == speeds[i]);
+    BOOST_TEST(msgs[0].errors == 0);
+    BOOST_REQUIRE(msgs[0].len >= 12);
+    BOOST_TEST(memcmp(msgs[0].data, "555-1234 987", 12) == 0);
+  }
+
+  // back-to-back transmissions at different rates are not lost while the rate changes
+  sampleTransmission(radio, pager, pagerTransmission(1111111, digits), 1200, 0.0);
+  sampleTransmission(radio, pager, pagerTransmission(2222222 & RADIOLIB_PAGER_ADDRESS_MAX, digits), 2400, 0.0);
+  sampleTransmission(radio, pager, std::vector<uint32_t>(2, 0x5A5A5A5A), 2400, 0.0);
+  BOOST_REQUIRE(pager.available() == 4);
+  PagerMessage_t msgs[4];
+  size_t numMsgs = 4;
+  uint8_t data[64];
+  BOOST_REQUIRE(pager.readBatch(msgs, &numMsgs, data, sizeof(data)) == RADIOLIB_ERR_NONE);
+  BOOST_REQUIRE(numMsgs == 2);
+  BOOST_TEST(msgs[0].addr == 1111111);
+  BOOST_TEST(msgs[0].speed == 1200);
+  BOOST_TEST(msgs[1].addr == (2222222 & RADIOLIB_PAGER_ADDRESS_MAX));
+  BOOST_TEST(msgs[1].speed == 2400);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
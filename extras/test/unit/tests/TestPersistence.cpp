@@ -0,0 +1,116 @@
+// boost test header
+#include <boost/test/unit_test.hpp>
+
+// the persistence header
+#include "protocols/LoRaWAN/LoRaWANPersistence.h"
+#include "LoRaWANFixture.hpp"
+
+#include <string.h>
+#include <vector>
+
+// RAM storage that behaves like flash, and counts writes and erases
+class FlashStorage : public LoRaWANSessionStorage {
+  public:
+    std::vector<uint8_t> mem;
+    size_t bytesWritten = 0;
+    size_t erases = 0;
+    bool overwrite = false;
+
+    explicit FlashStorage(size_t size) : mem(size, 0xFF) {}
+
+    int16_t read(uint32_t addr, uint8_t* data, size_t len) override {
+      memcpy(data, &mem[addr], len);
+      return(RADIOLIB_ERR_NONE);
+    }
+
+    int16_t write(uint32_t addr, const uint8_t* data, size_t len) override {
+      for(size_t i = 0; i < len; i++) {
+        // flash can only be written after erase
+        if(mem[addr + i] != 0xFF) {
+          overwrite = true;
+        }
+        mem[addr + i] = data[i];
+      }
+      bytesWritten += len;
+      return(RADIOLIB_ERR_NONE);
+    }
+
+    int16_t erase(uint32_t addr, size_t len) override {
+      memset(&mem[addr], 0xFF, len);
+      erases++;
+      return(RADIOLIB_ERR_NONE);
+    }
+};
+
+BOOST_AUTO_TEST_SUITE(suite_Persistence)
+
+BOOST_AUTO_TEST_CASE(Persistence_SaveRestore) {
+  BOOST_TEST_MESSAGE("--- Test Persistence save/restore ---");
+
+  const uint32_t pageSize = 256;
+  const uint32_t logSize = 4*pageSize;
+  StubRadio radio;
+  LoRaWANNode node(&radio, &EU868);
+  node.beginABP(LORAWAN_FIXTURE_DEV_ADDR, NULL, NULL, nwkSKey, appSKey);
+
+  // Nonces buffer is finalized before activation, the same as it is when restoring from empty storage
+  (void)node.getBufferNonces();
+  BOOST_TEST(node.activateABP() == RADIOLIB_LORAWAN_NEW_SESSION);
+
+  // snapshot does not fit into a single page, so each slot takes two
+  FlashStorage storage(4*pageSize + logSize);
+  LoRaWANPersistence persist(&node, &storage, pageSize, logSize);
+  BOOST_TEST(persist.getStorageSize() == storage.mem.size());
+
+  // first save creates the snapshot, then 100 uplinks only append counters
+  BOOST_TEST(persist.save() == RADIOLIB_ERR_NONE);
+  size_t snapshotBytes = storage.bytesWritten;
+  const uint32_t uplinks = 100;
+  for(uint32_t i = 1; i <= uplinks; i++) {
+    node.fCntUp = i;
+    BOOST_TEST(persist.save() == RADIOLIB_ERR_NONE);
+  }
+  BOOST_TEST(!storage.overwrite);
+
+  // 32 records fit into the log, so there are three compactions, each erasing both the slot and the log
+  BOOST_TEST(storage.erases == 1 + 3*2);
+  BOOST_TEST(storage.bytesWritten * 5 < (uplinks + 1) * snapshotBytes);
+
+  // change to something other than the counters needs a new snapshot
+  size_t erases = storage.erases;
+  node.lwClass = RADIOLIB_LORAWAN_CLASS_C;
+  BOOST_TEST(persist.save() == RADIOLIB_ERR_NONE);
+  BOOST_TEST(storage.erases > erases);
+  node.lwClass = RADIOLIB_LORAWAN_CLASS_A;
+  node.fCntUp = uplinks + 1;
+  BOOST_TEST(persist.save() == RADIOLIB_ERR_NONE);
+  node.fCntUp = uplinks + 2;
+  BOOST_TEST(persist.save() == RADIOLIB_ERR_NONE);
+  BOOST_TEST(!storage.overwrite);
+
+  // restore into a fresh node
+  StubRadio radio2;
+  LoRaWANNode node2(&radio2, &EU868);
+  node2.beginABP(LORAWAN_FIXTURE_DEV_ADDR, NULL, NULL, nwkSKey, appSKey);
+  LoRaWANPersistence persist2(&node2, &storage, pageSize, logSize);
+  BOOST_TEST(persist2.restore() == RADIOLIB_ERR_NONE);
+  BOOST_TEST(node2.fCntUp == uplinks + 2);
+  BOOST_TEST(node2.activateABP() == RADIOLIB_LORAWAN_SESSION_RESTORED);
+
+  // interrupted record write, previous record is used instead
+  uint32_t last = 4*pageSize + (persist.logHead - 1)*RADIOLIB_LORAWAN_PERSIST_RECORD_LEN;
+  storage.mem[last + RADIOLIB_LORAWAN_PERSIST_RECORD_CRC] ^= 0x01;
+  StubRadio radio3;
+  LoRaWANNode node3(&radio3, &EU868);
+  node3.beginABP(LORAWAN_FIXTURE_DEV_ADDR, NULL, NULL, nwkSKey, appSKey);
+  LoRaWANPersistence persist3(&node3, &storage, pageSize, logSize);
+  BOOST_TEST(persist3.restore() == RADIOLIB_ERR_NONE);
+  BOOST_TEST(node3.fCntUp == uplinks + 1);
+
+  // empty storage
+  FlashStorage empty(4*pageSize + logSize);
+  LoRaWANPersistence persist4(&node3, &empty, pageSize, logSize);
+  BOOST_TEST(persist4.restore() == RADIOLIB_ERR_NETWORK_NOT_JOINED);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,173 @@
+// boost test header
+#include <boost/test/unit_test.hpp>
+
+// the SSTV header and the emulated HAL for timing
+#include "protocols/SSTV/SSTV.h"
+#include "TestHal.hpp"
+#include "StubRadio.hpp"
+
+#include <vector>
+
+// HAL whose clock can be made to advance by a fixed step on every read, like a platform that is slow to respond
+class SteppingHal : public TestHal {
+  public:
+    unsigned long step = 0;
+
+    unsigned long micros() override {
+      if(this->step == 0) {
+        return(TestHal::micros());
+      }
+      this->now += this->step;
+      return(this->now);
+    }
+
+  private:
+    unsigned long now = 0;
+};
+
+// radio with 1 Hz frequency step, records when each frequency was set
+class ToneRadio : public StubRadio {
+  public:
+    SteppingHal hal;
+    Module mod;
+    std::vector<std::pair<RadioLibTime_t, uint32_t>> tones;
+
+    ToneRadio() : mod(&hal, 0, 0, 0) {
+      this->freqStep = 1.0f;
+      this->hal.init();
+    }
+
+    int16_t transmitDirect(uint32_t frf) override {
+      if(frf) {
+        this->tones.push_back({ this->hal.micros(), frf });
+      }
+      return(RADIOLIB_ERR_NONE);
+    }
+
+  private:
+    Module* getMod() override { return(&this->mod); }
+};
+
+static uint32_t lineLength(const SSTVClient& sstv, size_t num) {
+  uint32_t len = 0;
+  for(size_t i = 0; i < num; i++) {
+    len += sstv.lineTones[i].len;
+  }
+  return(len);
+}
+
+BOOST_AUTO_TEST_SUITE(suite_SSTV)
+
+BOOST_AUTO_TEST_CASE(SSTV_Render) {
+  BOOST_TEST_MESSAGE("--- Test SSTV line rendering ---");
+
+  ToneRadio radio;
+  SSTVClient sstv(&radio);
+  std::vector<uint32_t> line(640, 0xFF0000);
+
+  // brightness table spans the whole range, base frequency is 0
+  BOOST_REQUIRE(sstv.begin(0, Scottie1) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(sstv.brightnessLut[0] == RADIOLIB_SSTV_TONE_BRIGHTNESS_MIN);
+  BOOST_TEST(sstv.brightnessLut[128] == 1902);
+  BOOST_TEST(sstv.brightnessLut[255] == RADIOLIB_SSTV_TONE_BRIGHTNESS_MAX);
+
+  // Scottie starts with extra sync tone, then green, blue and red scans
+  size_t num = sstv.renderLine(line.data());
+  BOOST_REQUIRE(num == 1 + 7 - 3 + 3*320);
+  BOOST_TEST(lineLength(sstv, num) == 9000 + 3*1500 + 9000 + 3*320*432);
+  BOOST_TEST(sstv.lineTones[0].word == RADIOLIB_SSTV_TONE_BREAK);
+  BOOST_TEST(sstv.lineTones[2].word == RADIOLIB_SSTV_TONE_BRIGHTNESS_MIN);
+  BOOST_TEST(sstv.lineTones[num - 1].word == RADIOLIB_SSTV_TONE_BRIGHTNESS_MAX);
+  sstv.lineCount++;
+  BOOST_TEST(sstv.renderLine(line.data()) == num - 1);
+
+  // correction is kept with sub-microsecond precision, so many lines add up exactly
+  BOOST_REQUIRE(sstv.begin(0, Martin1) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(sstv.setCorrection(0.999f) == RADIOLIB_ERR_NONE);
+  uint64_t total = 0;
+  for(int i = 0; i < 100; i++) {
+    total += lineLength(sstv, sstv.renderLine(line.data()));
+    sstv.lineCount++;
+  }
+  uint64_t expected = 0;
+  for(uint8_t i = 0; i < sstv.txMode.numTones; i++) {
+    expected += (sstv.txMode.tones[i].type == tone_t::GENERIC) ? ((uint64_t)sstv.txMode.tones[i].len << 8) : (uint64_t)Martin1.width*sstv.pixelLen;
+  }
+  BOOST_TEST(total == ((100*expected) >> 8));
+  BOOST_TEST(sstv.pixelLen == (uint32_t)(458*256*0.999f));
+
+  // Robot36 in YCbCr, chrominance at half the length and alternating between Cr and Cb
+  BOOST_REQUIRE(sstv.begin(0, Robot36) == RADIOLIB_ERR_NONE);
+  num = sstv.renderLine(line.data());
+  BOOST_REQUIRE(num == 4 + 2*320);
+  BOOST_TEST(lineLength(sstv, num) == 9000 + 3000 + 4500 + 1500 + 320*275 + 320*275/2);
+  BOOST_TEST(sstv.lineTones[2].word == sstv.brightnessLut[82]);
+  BOOST_TEST(sstv.lineTones[num - 1].word == sstv.brightnessLut[240]);
+  BOOST_TEST(sstv.lineTones[2 + 320].word == 1500);
+  sstv.lineCount++;
+  num = sstv.renderLine(line.data());
+  BOOST_TEST(sstv.lineTones[2 + 320].word == 2300);
+  BOOST_TEST(sstv.lineTones[num - 1].word == sstv.brightnessLut[90]);
+
+  // black and white
+  line.assign(640, 0xFFFFFF);
+  num = sstv.renderLine(line.data());
+  BOOST_TEST(sstv.lineTones[2].word == sstv.brightnessLut[235]);
+  BOOST_TEST(sstv.lineTones[num - 1].word == sstv.brightnessLut[128]);
+  line.assign(640, 0x000000);
+  num = sstv.renderLine(line.data());
+  BOOST_TEST(sstv.lineTones[2].word == sstv.brightnessLut[16]);
+  BOOST_TEST(sstv.lineTones[num - 1].word == sstv.brightnessLut[128]);
+
+  // copies render into their own buffer
+  SSTVClient copy(sstv);
+  SSTVClient assigned(&radio);
+  assigned = copy;
+  BOOST_TEST(copy.lineTones != sstv.lineTones);
+  BOOST_TEST(assigned.lineTones != copy.lineTones);
+  line.assign(640, 0xFFFFFF);
+  BOOST_TEST(assigned.renderLine(line.data()) == num);
+  BOOST_TEST(assigned.lineTones[2].word == sstv.brightnessLut[235]);
+  BOOST_TEST(sstv.lineTones[2].word == sstv.brightnessLut[16]);
+}
+
+BOOST_AUTO_TEST_CASE(SSTV_Timing) {
+  BOOST_TEST_MESSAGE("--- Test SSTV line timing ---");
+
+  ToneRadio radio;
+  radio.hal.step = 20;
+  SSTVClient sstv(&radio);
+  std::vector<uint32_t> line(320);
+  for(size_t i = 0; i < line.size(); i++) {
+    line[i] = i*0x010101;
+  }
+  BOOST_REQUIRE(sstv.begin(0, Robot36) == RADIOLIB_ERR_NONE);
+
+  // every tone starts when all the previous ones should have ended, regardless of how long each call took
+  radio.tones.clear();
+  sstv.startTimer();
+  RadioLibTime_t start = sstv.timerStart;
+  std::vector<uint16_t> lens;
+  for(int i = 0; i < 2; i++) {
+    sstv.sendLine(line.data());
+    for(size_t j = 0; j < 4 + 2*320; j++) {
+      lens.push_back(sstv.lineTones[j].len);
+    }
+  }
+  BOOST_REQUIRE(radio.tones.size() == lens.size());
+  RadioLibTime_t expected = 0;
+  RadioLibTime_t lateMax = 0;
+  for(size_t i = 0; i < radio.tones.size(); i++) {
+    RadioLibTime_t at = radio.tones[i].first - start;
+    BOOST_REQUIRE(at >= expected);
+    lateMax = RADIOLIB_MAX(lateMax, at - expected);
+    expected += lens[i];
+  }
+  // no tone is late by as much as the shortest pixel, Robot36 chrominance
+  BOOST_TEST(lateMax < Robot36.scanPixelLen/2UL);
+
+  // the second line started right where the first one ended
+  BOOST_TEST(expected == 2*(9000 + 3000 + 4500 + 1500 + 320*275 + 320*275/2));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
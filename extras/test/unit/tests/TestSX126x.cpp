@@ -0,0 +1,170 @@
+// boost test header
+#include <boost/test/unit_test.hpp>
+
+// the SX126x header and the emulated hardware
+#include "modules/SX126x/SX1262.h"
+#include "TestHal.hpp"
+#include "EmulatedSX126x.hpp"
+
+// SX1262 connected to emulated hardware
+class SX126xFixture {
+  public:
+    TestHal hal;
+    EmulatedSX126x chip;
+    Module mod;
+    SX1262 radio;
+
+    SX126xFixture() : mod(&hal, EMULATED_RADIO_NSS_PIN, EMULATED_RADIO_IRQ_PIN, EMULATED_RADIO_RST_PIN, EMULATED_RADIO_GPIO_PIN), radio(&mod) {
+      hal.connectRadio(&chip);
+      hal.spiLogEnabled = false;
+    }
+};
+
+BOOST_AUTO_TEST_SUITE(suite_SX126x)
+
+BOOST_FIXTURE_TEST_CASE(SX126x_ConfigRoundTrip, SX126xFixture) {
+  BOOST_TEST_MESSAGE("--- Test SX126x configuration snapshot ---");
+
+  // BPSK packet parameters are split between a command and a register
+  BOOST_REQUIRE(radio.beginBPSK(868.0, 0.6, 10, 0) == RADIOLIB_ERR_NONE);
+  BOOST_REQUIRE(radio.setPacketParamsBPSK(16, 0x1234, 0x5678, 8*16) == RADIOLIB_ERR_NONE);
+  const std::vector<uint8_t> bpskReg(&chip.regs[RADIOLIB_SX126X_REG_BPSK_PACKET_PARAMS], &chip.regs[RADIOLIB_SX126X_REG_BPSK_PACKET_PARAMS + 6]);
+  const std::map<uint8_t, std::vector<uint8_t>> cmds = chip.cmds;
+
+  uint8_t config[RADIOLIB_SX126X_CONFIG_BUF_SIZE];
+  BOOST_REQUIRE(radio.saveConfig(config) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(config[RADIOLIB_SX126X_CONFIG_PACKET_TYPE] == RADIOLIB_SX126X_PACKET_TYPE_BPSK);
+  BOOST_TEST(config[RADIOLIB_SX126X_CONFIG_PKT_PARAMS] == 16);
+  BOOST_TEST(config[RADIOLIB_SX126X_CONFIG_PKT_PARAMS + 1] == 0x12);
+
+  // a failed command does not change the cached parameters
+  mod.spiConfig.parseStatusCb = [](uint8_t in) -> int16_t { (void)in; return(RADIOLIB_ERR_SPI_CMD_FAILED); };
+  BOOST_TEST(radio.setModulationParamsBPSK(0x123456) == RADIOLIB_ERR_SPI_CMD_FAILED);
+  BOOST_TEST(radio.setPacketParamsBPSK(32, 0, 0, 8*32) == RADIOLIB_ERR_SPI_CMD_FAILED);
+  mod.spiConfig.parseStatusCb = SX126x::SPIparseStatus;
+  uint8_t again[RADIOLIB_SX126X_CONFIG_BUF_SIZE];
+  BOOST_REQUIRE(radio.saveConfig(again) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(memcmp(config, again, RADIOLIB_SX126X_CONFIG_BUF_SIZE) == 0);
+
+  // change the configuration, then lose it all in cold sleep
+  BOOST_REQUIRE(radio.setBitRate(0.1) == RADIOLIB_ERR_NONE);
+  BOOST_REQUIRE(radio.setFrequency(915.0) == RADIOLIB_ERR_NONE);
+  BOOST_REQUIRE(radio.setPacketParamsBPSK(32, 0, 0, 8*32) == RADIOLIB_ERR_NONE);
+  chip.powerUp();
+
+  // the chip ends up in the same state as it was when the snapshot was taken
+  BOOST_REQUIRE(radio.restoreConfig(config) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(chip.packetType == RADIOLIB_SX126X_PACKET_TYPE_BPSK);
+  const uint8_t restoredCmds[] = {
+    RADIOLIB_SX126X_CMD_SET_RF_FREQUENCY,
+    RADIOLIB_SX126X_CMD_SET_PA_CONFIG,
+    RADIOLIB_SX126X_CMD_SET_TX_PARAMS,
+    RADIOLIB_SX126X_CMD_SET_MODULATION_PARAMS,
+    RADIOLIB_SX126X_CMD_SET_PACKET_PARAMS,
+  };
+  for(uint8_t cmd : restoredCmds) {
+    BOOST_TEST_CONTEXT("command " << (int)cmd) {
+      BOOST_REQUIRE(chip.cmds.count(cmd));
+      BOOST_TEST(chip.cmds[cmd] == cmds.at(cmd));
+    }
+  }
+  BOOST_TEST(std::vector<uint8_t>(&chip.regs[RADIOLIB_SX126X_REG_BPSK_PACKET_PARAMS], &chip.regs[RADIOLIB_SX126X_REG_BPSK_PACKET_PARAMS + 6]) == bpskReg);
+}
+
+BOOST_FIXTURE_TEST_CASE(SX126x_ConfigFrequencyWord, SX126xFixture) {
+  BOOST_TEST_MESSAGE("--- Test SX126x configuration snapshot frequency ---");
+
+  // one synthesizer step above 868 MHz, which is lost when converted to a float frequency
+  BOOST_REQUIRE(radio.begin(868.0) == RADIOLIB_ERR_NONE);
+  BOOST_REQUIRE(radio.setFrequencyWord(0x36400001) == RADIOLIB_ERR_NONE);
+
+  // the snapshot holds the exact word that was programmed
+  uint8_t config[RADIOLIB_SX126X_CONFIG_BUF_SIZE];
+  BOOST_REQUIRE(radio.saveConfig(config) == RADIOLIB_ERR_NONE);
+  const uint8_t expected[] = { 0x36, 0x40, 0x00, 0x01 };
+  BOOST_TEST(memcmp(&config[RADIOLIB_SX126X_CONFIG_RF_FREQ], expected, sizeof(expected)) == 0);
+
+  // a failed command does not change the cached word
+  mod.spiConfig.parseStatusCb = [](uint8_t in) -> int16_t { (void)in; return(RADIOLIB_ERR_SPI_CMD_FAILED); };
+  BOOST_TEST(radio.setFrequencyWord(0x36500000) == RADIOLIB_ERR_SPI_CMD_FAILED);
+  mod.spiConfig.parseStatusCb = SX126x::SPIparseStatus;
+  uint8_t again[RADIOLIB_SX126X_CONFIG_BUF_SIZE];
+  BOOST_REQUIRE(radio.saveConfig(again) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(memcmp(config, again, RADIOLIB_SX126X_CONFIG_BUF_SIZE) == 0);
+}
+
+BOOST_FIXTURE_TEST_CASE(SX126x_ScanChannels, SX126xFixture) {
+  BOOST_TEST_MESSAGE("--- Test SX126x multi-channel CAD ---");
+
+  // RF switch on spare pins, so that it can be checked it was released
+  const uint32_t rxEn = EMULATED_RADIO_GPIO_PIN + 1;
+  const uint32_t txEn = EMULATED_RADIO_GPIO_PIN + 2;
+  const uint32_t rfSwitchPins[Module::RFSWITCH_MAX_PINS] = { rxEn, txEn, txEn + 1, txEn + 2, txEn + 3 };
+  static const Module::RfSwitchMode_t rfSwitchTable[] = {
+    { Module::MODE_IDLE,  { TEST_HAL_LOW,  TEST_HAL_LOW,  TEST_HAL_LOW, TEST_HAL_LOW, TEST_HAL_LOW } },
+    { Module::MODE_RX,    { TEST_HAL_HIGH, TEST_HAL_LOW,  TEST_HAL_LOW, TEST_HAL_LOW, TEST_HAL_LOW } },
+    { Module::MODE_TX,    { TEST_HAL_LOW,  TEST_HAL_HIGH, TEST_HAL_LOW, TEST_HAL_LOW, TEST_HAL_LOW } },
+    END_OF_MODE_TABLE,
+  };
+  BOOST_REQUIRE(radio.begin(868.0) == RADIOLIB_ERR_NONE);
+  radio.setRfSwitchTable(rfSwitchPins, rfSwitchTable);
+
+  const uint32_t words[] = { 0x36419999, 0x3644CCCC };
+  const size_t numChannels = sizeof(words) / sizeof(words[0]);
+  int16_t results[numChannels] = { 0 };
+  ChannelScanConfig_t cfg = {
+    .cad = {
+      .symNum = RADIOLIB_SX126X_CAD_PARAM_DEFAULT,
+      .detPeak = RADIOLIB_SX126X_CAD_PARAM_DEFAULT,
+      .detMin = RADIOLIB_SX126X_CAD_PARAM_DEFAULT,
+      .exitMode = RADIOLIB_SX126X_CAD_PARAM_DEFAULT,
+      .timeout = 0,
+      .irqFlags = RADIOLIB_IRQ_CAD_DEFAULT_FLAGS,
+      .irqMask = RADIOLIB_IRQ_CAD_DEFAULT_MASK,
+    },
+  };
+
+  // nothing on air
+  BOOST_TEST(radio.scanChannels(words, numChannels, cfg, results) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(results[0] == RADIOLIB_CHANNEL_FREE);
+  BOOST_TEST(results[1] == RADIOLIB_CHANNEL_FREE);
+  BOOST_TEST(chip.irqStatus == 0);
+
+  // activity on all channels
+  chip.cadDetected = true;
+  BOOST_TEST(radio.scanChannels(words, numChannels, cfg, results) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(results[0] == RADIOLIB_LORA_DETECTED);
+  BOOST_TEST(results[1] == RADIOLIB_LORA_DETECTED);
+
+  // CAD that never finishes is abandoned after a bounded time, with the radio back in standby
+  chip.cadHangs = true;
+  RadioLibTime_t start = hal.millis();
+  BOOST_TEST(radio.scanChannels(words, numChannels, cfg, results) == RADIOLIB_ERR_RX_TIMEOUT);
+  BOOST_TEST(hal.millis() - start < 1000);
+  BOOST_TEST(chip.cmds[RADIOLIB_SX126X_CMD_SET_RF_FREQUENCY] == std::vector<uint8_t>({ 0x36, 0x41, 0x99, 0x99 }));
+  BOOST_TEST(chip.lastOpcode == RADIOLIB_SX126X_CMD_SET_STANDBY);
+  BOOST_TEST(hal.outputValue(rxEn) == TEST_HAL_LOW);
+  BOOST_TEST(hal.outputValue(txEn) == TEST_HAL_LOW);
+}
+
+BOOST_FIXTURE_TEST_CASE(SX126x_ScanChannelsFSK, SX126xFixture) {
+  BOOST_TEST_MESSAGE("--- Test SX126x multi-channel scan without LoRa ---");
+
+  BOOST_REQUIRE(radio.beginFSK(868.0) == RADIOLIB_ERR_NONE);
+  const uint32_t words[] = { 0x36419999, 0x3644CCCC };
+  const size_t numChannels = sizeof(words) / sizeof(words[0]);
+  int16_t results[numChannels] = { 0 };
+  ChannelScanConfig_t cfg = {
+    .rssi = {
+      .limit = -100.0f,
+    },
+  };
+
+  // the generic scan visits every channel and reports the result of each one
+  BOOST_TEST(radio.scanChannels(words, numChannels, cfg, results) == RADIOLIB_ERR_NONE);
+  BOOST_TEST(results[0] == RADIOLIB_ERR_WRONG_MODEM);
+  BOOST_TEST(results[1] == RADIOLIB_ERR_WRONG_MODEM);
+  BOOST_TEST(chip.cmds[RADIOLIB_SX126X_CMD_SET_RF_FREQUENCY] == std::vector<uint8_t>({ 0x36, 0x44, 0xCC, 0xCC }));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -118,8 +118,13 @@
 #include "protocols/ExternalRadio/ExternalRadio.h"
 #include "protocols/Print/Print.h"
 #include "protocols/BellModem/BellModem.h"
+#include "protocols/BellModem/BellDemodulator.h"
 #include "protocols/LoRaWAN/LoRaWAN.h"
+#include "protocols/LoRaWAN/LoRaWANFragmentation.h"
+#include "protocols/LoRaWAN/LoRaWANPersistence.h"
+#include "protocols/LoRaWAN/LoRaWANLinkAdapt.h"
 #include "protocols/ADSB/ADSB.h"
+#include "protocols/ADSB/ADSBTracker.h"
 
 // utilities
 #include "utils/CRC.h"
@@ -334,6 +334,16 @@
 */
 #define RADIOLIB_ERR_MIC_E_TELEMETRY_STATUS                    (-204)
 
+/*!
+  \brief Received APRS packet is of a type that can not be decoded.
+*/
+#define RADIOLIB_ERR_APRS_UNSUPPORTED_TYPE                     (-205)
+
+/*!
+  \brief Received APRS packet is malformed.
+*/
+#define RADIOLIB_ERR_APRS_MALFORMED_PACKET                     (-206)
+
 // SSDV status codes
 
 /*!
@@ -593,6 +603,12 @@
 */
 #define RADIOLIB_LORAWAN_NEW_SESSION                            (-1118)
 
+/*!
+  \brief The non-blocking LoRaWAN uplink/downlink cycle is still in progress, LoRaWANNode::process must be called again.
+  This is not an error, so it is positive; it is also larger than any downlink window number.
+*/
+#define RADIOLIB_LORAWAN_CYCLE_PENDING                          (1122)
+
 /*!
   \brief The supplied Nonces buffer is discarded as its activation information is invalid.
 */
@@ -608,6 +624,11 @@
 */
 #define RADIOLIB_ERR_INVALID_MODE                               (-1121)
 
+/*!
+  \brief No Class B beacon was received, or the beacon was lost and the device reverted to Class A.
+*/
+#define RADIOLIB_ERR_NO_BEACON                                  (-1123)
+
 // LR11x0-specific status codes
 
 /*!
@@ -658,6 +679,11 @@
 */
 #define RADIOLIB_ERR_ADSB_INVALID_CATEGORY                      (-1401)
 
+/*!
+  \brief The requested information is not available in the received frame.
+*/
+#define RADIOLIB_ERR_ADSB_NOT_AVAILABLE                         (-1402)
+
 /*!
   \}
 */
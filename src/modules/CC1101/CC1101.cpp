@@ -448,21 +448,16 @@ int16_t CC1101::finishReceive() {
 
 int16_t CC1101::setFrequency(float freq) {
   // check allowed frequency range
-  #if RADIOLIB_CHECK_PARAMS
-  if(!(((freq >= 300.0f) && (freq <= 348.0f)) ||
-       ((freq >= 387.0f) && (freq <= 464.0f)) ||
-       ((freq >= 779.0f) && (freq <= 928.0f)))) {
-    return(RADIOLIB_ERR_INVALID_FREQUENCY);
-  }
-  #endif
+  int16_t state = checkFrequency(freq);
+  RADIOLIB_ASSERT(state);
 
   // set mode to standby
   SPIsendCommand(RADIOLIB_CC1101_CMD_IDLE);
 
   //set carrier frequency
-  uint32_t base = 1;
-  uint32_t FRF = (freq * (base << 16)) / 26.0f;
-  int16_t state = SPIsetRegValue(RADIOLIB_CC1101_REG_FREQ2, (FRF & 0xFF0000) >> 16, 7, 0);
+  uint32_t FRF = 0;
+  calculateFrequencyWord(freq, &FRF);
+  state = SPIsetRegValue(RADIOLIB_CC1101_REG_FREQ2, (FRF & 0xFF0000) >> 16, 7, 0);
   state |= SPIsetRegValue(RADIOLIB_CC1101_REG_FREQ1, (FRF & 0x00FF00) >> 8, 7, 0);
   state |= SPIsetRegValue(RADIOLIB_CC1101_REG_FREQ0, FRF & 0x0000FF, 7, 0);
 
@@ -542,6 +537,41 @@ int16_t CC1101::autoSetRxBandwidth() {
   return(RADIOLIB_ERR_UNKNOWN);
 }
 
+int16_t CC1101::checkFrequency(float freq) {
+  #if RADIOLIB_CHECK_PARAMS
+  if(!(((freq >= 300.0f) && (freq <= 348.0f)) ||
+       ((freq >= 387.0f) && (freq <= 464.0f)) ||
+       ((freq >= 779.0f) && (freq <= 928.0f)))) {
+    return(RADIOLIB_ERR_INVALID_FREQUENCY);
+  }
+  #else
+  (void)freq;
+  #endif
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t CC1101::calculateFrequencyWord(float freq, uint32_t* word) {
+  if(!word) {
+    return(RADIOLIB_ERR_NULL_POINTER);
+  }
+  uint32_t base = 1;
+  *word = (freq * (base << 16)) / 26.0f;
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t CC1101::setFrequencyWord(uint32_t word) {
+  // frequency can only be changed in idle
+  SPIsendCommand(RADIOLIB_CC1101_CMD_IDLE);
+
+  // frequency registers are adjacent, so all three can be written in a single burst
+  const uint8_t frf[] = { (uint8_t)((word & 0xFF0000) >> 16), (uint8_t)((word & 0x00FF00) >> 8), (uint8_t)(word & 0x0000FF) };
+  SPIwriteRegisterBurst(RADIOLIB_CC1101_REG_FREQ2, frf, 3);
+
+  // recalibrate the synthesizer for the new frequency
+  SPIsendCommand(RADIOLIB_CC1101_CMD_CAL);
+  return(RADIOLIB_ERR_NONE);
+}
+
 int16_t CC1101::setFrequencyDeviation(float freqDev) {
   // set frequency deviation to lowest available setting (required for digimodes)
   float newFreqDev = freqDev;
@@ -765,6 +765,27 @@ class CC1101: public PhysicalLayer {
     */
     int16_t setFrequency(float freq) override;
 
+    /*!
+      \brief Check the carrier frequency is allowed. Allowed values range from 300.0 MHz to 348.0 MHz,
+      387.0 MHz to 464.0 MHz and 779.0 MHz to 928.0 MHz.
+      \param freq Carrier frequency in MHz.
+      \returns \ref status_codes
+    */
+    int16_t checkFrequency(float freq) override;
+
+    /*! \copydoc PhysicalLayer::calculateFrequencyWord */
+    int16_t calculateFrequencyWord(float freq, uint32_t* word) override;
+
+    /*!
+      \brief Sets carrier frequency from a raw frequency word, as calculated by calculateFrequencyWord.
+      The radio is put to idle and the synthesizer is recalibrated, as that is the only state in which
+      the frequency can be changed. PA table is not updated, so all words used this way should be
+      in the band that was last configured by setFrequency.
+      \param word Raw frequency word.
+      \returns \ref status_codes
+    */
+    int16_t setFrequencyWord(uint32_t word) override;
+
     /*!
       \brief Sets bit rate. Allowed values range from 0.025 to 600.0 kbps.
       \param br Bit rate to be set in kbps.
@@ -51,22 +51,29 @@ int16_t LR1110::setFrequency(float freq) {
 }
 
 int16_t LR1110::setFrequency(float freq, bool skipCalibration, float band) {
-  RADIOLIB_CHECK_RANGE(freq, 150.0f, 960.0f, RADIOLIB_ERR_INVALID_FREQUENCY);
+  int16_t state = checkFrequency(freq);
+  RADIOLIB_ASSERT(state);
   
   // check if we need to recalibrate image
-  int16_t state;
   if(!skipCalibration && (fabsf(freq - this->freqMHz) >= RADIOLIB_LR11X0_CAL_IMG_FREQ_TRIG_MHZ)) {
     state = LR11x0::calibrateImageRejection(freq - band, freq + band);
     RADIOLIB_ASSERT(state);
   }
 
   // set frequency
-  state = LR11x0::setRfFrequency((uint32_t)(freq*1000000.0f));
+  uint32_t frf = 0;
+  LR11x0::calculateFrequencyWord(freq, &frf);
+  state = LR11x0::setRfFrequency(frf);
   RADIOLIB_ASSERT(state);
   this->freqMHz = freq;
   return(state);
 }
 
+int16_t LR1110::checkFrequency(float freq) {
+  RADIOLIB_CHECK_RANGE(freq, 150.0f, 960.0f, RADIOLIB_ERR_INVALID_FREQUENCY);
+  return(RADIOLIB_ERR_NONE);
+}
+
 int16_t LR1110::setOutputPower(int8_t power) {
   return(this->setOutputPower(power, false));
 }
@@ -91,6 +91,13 @@ class LR1110: public LR11x0 {
       \returns \ref status_codes
     */
     int16_t setFrequency(float freq, bool skipCalibration, float band = 4);
+
+    /*!
+      \brief Check the carrier frequency is in range from 150.0 to 960.0 MHz.
+      \param freq Carrier frequency in MHz.
+      \returns \ref status_codes
+    */
+    int16_t checkFrequency(float freq) override;
     
     /*!
       \brief Sets output power. Allowed values are in range from -9 to 22 dBm (high-power PA) or -17 to 14 dBm (low-power PA).
@@ -51,23 +51,19 @@ int16_t LR1120::setFrequency(float freq) {
 }
 
 int16_t LR1120::setFrequency(float freq, bool skipCalibration, float band) {
-  #if RADIOLIB_CHECK_PARAMS
-  if(!(((freq >= 150.0f) && (freq <= 960.0f)) ||
-    ((freq >= 1900.0f) && (freq <= 2200.0f)) ||
-    ((freq >= 2400.0f) && (freq <= 2500.0f)))) {
-      return(RADIOLIB_ERR_INVALID_FREQUENCY);
-  }
-  #endif
+  int16_t state = checkFrequency(freq);
+  RADIOLIB_ASSERT(state);
 
   // check if we need to recalibrate image
-  int16_t state;
   if(!skipCalibration && (fabsf(freq - this->freqMHz) >= RADIOLIB_LR11X0_CAL_IMG_FREQ_TRIG_MHZ)) {
     state = LR11x0::calibrateImageRejection(freq - band, freq + band);
     RADIOLIB_ASSERT(state);
   }
 
   // set frequency
-  state = LR11x0::setRfFrequency((uint32_t)(freq*1000000.0f));
+  uint32_t frf = 0;
+  LR11x0::calculateFrequencyWord(freq, &frf);
+  state = LR11x0::setRfFrequency(frf);
   RADIOLIB_ASSERT(state);
   this->freqMHz = freq;
   this->highFreq = (freq > 1000.0f);
@@ -76,6 +72,19 @@ int16_t LR1120::setFrequency(float freq, bool skipCalibration, float band) {
   return(workaroundGFSK());
 }
 
+int16_t LR1120::checkFrequency(float freq) {
+  #if RADIOLIB_CHECK_PARAMS
+  if(!(((freq >= 150.0f) && (freq <= 960.0f)) ||
+    ((freq >= 1900.0f) && (freq <= 2200.0f)) ||
+    ((freq >= 2400.0f) && (freq <= 2500.0f)))) {
+      return(RADIOLIB_ERR_INVALID_FREQUENCY);
+  }
+  #else
+  (void)freq;
+  #endif
+  return(RADIOLIB_ERR_NONE);
+}
+
 int16_t LR1120::setOutputPower(int8_t power) {
   return(this->setOutputPower(power, false));
 }
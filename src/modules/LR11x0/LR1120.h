@@ -98,6 +98,14 @@ class LR1120: public LR11x0 {
     */
     int16_t setFrequency(float freq, bool skipCalibration, float band = 4);
 
+    /*!
+      \brief Check the carrier frequency is allowed. Allowed values are in range from 150.0 to 960.0 MHz,
+      1900 - 2200 MHz and 2400 - 2500 MHz.
+      \param freq Carrier frequency in MHz.
+      \returns \ref status_codes
+    */
+    int16_t checkFrequency(float freq) override;
+
     /*!
       \brief Sets output power. Allowed values are in range from -9 to 22 dBm (high-power PA) or -17 to 14 dBm (low-power PA).
       \param power Output power to be set in dBm, output PA is determined automatically preferring the low-power PA.
@@ -643,6 +643,18 @@ int16_t LR11x0::setBitRate(float br) {
   return(workaroundGFSK());
 }
 
+int16_t LR11x0::calculateFrequencyWord(float freq, uint32_t* word) {
+  if(!word) {
+    return(RADIOLIB_ERR_NULL_POINTER);
+  }
+  *word = (uint32_t)(freq*1000000.0f);
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t LR11x0::setFrequencyWord(uint32_t word) {
+  return(setRfFrequency(word));
+}
+
 int16_t LR11x0::setFrequencyDeviation(float freqDev) {
   // check active modem
   uint8_t type = RADIOLIB_LR11X0_PACKET_TYPE_NONE;
@@ -1092,6 +1104,10 @@ int16_t LR11x0::invertIQ(bool enable) {
   return(setPacketParamsLoRa(this->preambleLengthLoRa, this->headerType, this->implicitLen, this->crcTypeLoRa, (uint8_t)this->invertIQEnabled));
 }
 
+int16_t LR11x0::setPacketCRC(bool enable) {
+  return(this->setCRC(enable ? 2 : 0));
+}
+
 float LR11x0::getRSSI() {
   float val = 0;
 
@@ -295,6 +295,12 @@ class LR11x0: public LRxxxx {
     */
     int16_t setFrequencyDeviation(float freqDev) override;
 
+    /*! \copydoc PhysicalLayer::calculateFrequencyWord */
+    int16_t calculateFrequencyWord(float freq, uint32_t* word) override;
+
+    /*! \copydoc PhysicalLayer::setFrequencyWord */
+    int16_t setFrequencyWord(uint32_t word) override;
+
     /*!
       \brief Sets GFSK receiver bandwidth. Allowed values are 4.8, 5.8, 7.3, 9.7, 11.7, 14.6, 19.5,
       23.4, 29.3, 39.0, 46.9, 58.6, 78.2, 93.8, 117.3, 156.2, 187.2, 234.3, 312.0, 373.6 and 467.0 kHz.
@@ -423,6 +429,13 @@ class LR11x0: public LRxxxx {
     */
     int16_t invertIQ(bool enable) override;
 
+    /*!
+      \brief Enable/disable the packet CRC, with the default CRC length of the active modem.
+      \param enable CRC enabled (true) or disabled (false).
+      \returns \ref status_codes
+    */
+    int16_t setPacketCRC(bool enable) override;
+
     /*!
       \brief Gets RSSI (Received Signal Strength Indicator) of the last received packet. Only available for LoRa or GFSK modem.
       \returns RSSI of the last received packet in dBm.
@@ -511,13 +524,13 @@ class LR11x0: public LRxxxx {
       \param len Payload length in bytes.
       \returns \ref status_codes
     */
-    int16_t implicitHeader(size_t len);
+    int16_t implicitHeader(size_t len) override;
 
     /*!
       \brief Set explicit header mode for future reception/transmission.
       \returns \ref status_codes
     */
-    int16_t explicitHeader();
+    int16_t explicitHeader() override;
 
     /*!
       \brief Set regulator mode to LDO.
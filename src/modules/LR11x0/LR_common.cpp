@@ -97,69 +97,19 @@ RadioLibTime_t LRxxxx::getTimeOnAir(size_t len, ModemType_t modem) {
 }
 
 RadioLibTime_t LRxxxx::calculateTimeOnAir(ModemType_t modem, DataRate_t dr, PacketConfig_t pc, size_t len) {
-  // check active modem
+  // check active modem, the actual calculation is done by the shared time-on-air core
   if (modem == ModemType_t::RADIOLIB_MODEM_LORA) {  
-    uint32_t symbolLength_us = ((uint32_t)(1000 * 10) << dr.lora.spreadingFactor) / (dr.lora.bandwidth * 10) ;
-    uint8_t sfCoeff1_x4 = 17; // (4.25 * 4)
-    uint8_t sfCoeff2 = 8;
-    if(dr.lora.spreadingFactor == 5 || dr.lora.spreadingFactor == 6) {
-      sfCoeff1_x4 = 25; // 6.25 * 4
-      sfCoeff2 = 0;
-    }
-    uint8_t sfDivisor = 4*dr.lora.spreadingFactor;
-    if(pc.lora.ldrOptimize) {
-      sfDivisor = 4*(dr.lora.spreadingFactor - 2);
-    }
-    const int8_t bitsPerCrc = 16;
-    const int8_t N_symbol_header = pc.lora.implicitHeader ? 0 : 20;
-
-    // numerator of equation in section 6.1.4 of SX1268 datasheet v1.1 (might not actually be bitcount, but it has len * 8)
-    int16_t bitCount = (int16_t) 8 * len + pc.lora.crcEnabled * bitsPerCrc - 4 * dr.lora.spreadingFactor  + sfCoeff2 + N_symbol_header;
-    if(bitCount < 0) {
-      bitCount = 0;
-    }
-    // add (sfDivisor) - 1 to the numerator to give integer CEIL(...)
-    uint16_t nPreCodedSymbols = (bitCount + (sfDivisor - 1)) / (sfDivisor);
-
-    // preamble can be 65k, therefore nSymbol_x4 needs to be 32 bit
-    uint32_t nSymbol_x4 = (pc.lora.preambleLength + 8) * 4 + sfCoeff1_x4 + nPreCodedSymbols * dr.lora.codingRate * 4;
-
-    // get time-on-air in us
-    return((symbolLength_us * nSymbol_x4) / 4);
+    return(rlb_toaLoRa(dr.lora.spreadingFactor, dr.lora.bandwidth, dr.lora.codingRate,
+      pc.lora.preambleLength, pc.lora.crcEnabled, pc.lora.implicitHeader, pc.lora.ldrOptimize, len));
 
   } else if(modem == ModemType_t::RADIOLIB_MODEM_FSK) {
-    return((((float)(pc.fsk.crcLength * 8) + pc.fsk.syncWordLength + pc.fsk.preambleLength + (uint32_t)len * 8) / (dr.fsk.bitRate / 1000.0f)));
+    return(rlb_toaFSK(dr.fsk.bitRate, pc.fsk.preambleLength, pc.fsk.syncWordLength, pc.fsk.crcLength, len));
 
   } else if(modem == ModemType_t::RADIOLIB_MODEM_LRFHSS) {
-    // calculate the number of bits based on coding rate
-    uint16_t N_bits;
-    switch(dr.lrFhss.cr) {
-      case RADIOLIB_LRXXXX_LR_FHSS_CR_5_6:
-        N_bits = ((len * 6) + 4) / 5; // this is from the official LR11xx driver, but why the extra +4?
-        break;
-      case RADIOLIB_LRXXXX_LR_FHSS_CR_2_3:
-        N_bits = (len * 3) / 2;
-        break;
-      case RADIOLIB_LRXXXX_LR_FHSS_CR_1_2:
-        N_bits = len * 2;
-        break;
-      case RADIOLIB_LRXXXX_LR_FHSS_CR_1_3:
-        N_bits = len * 3;
-        break;
-      default:
-        return(RADIOLIB_ERR_INVALID_CODING_RATE);
-    }
-
-    // calculate number of bits when accounting for unaligned last block
-    uint16_t N_payBits = (N_bits / RADIOLIB_LRXXXX_LR_FHSS_FRAG_BITS) * RADIOLIB_LRXXXX_LR_FHSS_BLOCK_BITS;
-    uint16_t N_lastBlockBits = N_bits % RADIOLIB_LRXXXX_LR_FHSS_FRAG_BITS;
-    if(N_lastBlockBits) {
-      N_payBits += N_lastBlockBits + 2;
+    if(dr.lrFhss.cr > RADIOLIB_LRXXXX_LR_FHSS_CR_1_3) {
+      return(RADIOLIB_ERR_INVALID_CODING_RATE);
     }
-
-    // add header bits
-    uint16_t N_totalBits = (RADIOLIB_LRXXXX_LR_FHSS_HEADER_BITS * pc.lrFhss.hdrCount) + N_payBits;
-    return(((uint32_t)N_totalBits * 8 * 1000000UL) / RADIOLIB_LRXXXX_LR_FHSS_BIT_RATE);
+    return(rlb_toaLrFhss(dr.lrFhss.cr, pc.lrFhss.hdrCount, len));
   
   } else {
     return(RADIOLIB_ERR_WRONG_MODEM);
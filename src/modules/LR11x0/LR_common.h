@@ -3,6 +3,7 @@
 
 #include "../../Module.h"
 #include "../../protocols/PhysicalLayer/PhysicalLayer.h"
+#include "../../utils/TimeOnAir.h"
 
 #define RADIOLIB_LRXXXX_CMD_NOP                                 (0x0000)
 #define RADIOLIB_LRXXXX_SPI_MAX_READ_WRITE_LEN                  (128) // intentionally limited to the length supported by LR2021
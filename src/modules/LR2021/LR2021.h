@@ -441,6 +441,13 @@ class LR2021: public LRxxxx {
     */
     int16_t invertIQ(bool enable) override;
 
+    /*!
+      \brief Enable/disable the packet CRC, with the default CRC length of the active modem.
+      \param enable CRC enabled (true) or disabled (false).
+      \returns \ref status_codes
+    */
+    int16_t setPacketCRC(bool enable) override;
+
     /*!
       \brief Sets GFSK bit rate. Allowed values range from 0.5 to 2000.0 kbps.
       \param br FSK bit rate to be set in kbps.
@@ -430,6 +430,10 @@ int16_t LR2021::invertIQ(bool enable) {
   return(setLoRaPacketParams(this->preambleLengthLoRa, this->headerType, this->implicitLen, this->crcTypeLoRa, (uint8_t)this->invertIQEnabled));
 }
 
+int16_t LR2021::setPacketCRC(bool enable) {
+  return(this->setCRC(enable ? 2 : 0));
+}
+
 int16_t LR2021::setBitRate(float br) {
   // check active modem
   uint8_t type = RADIOLIB_LR2021_PACKET_TYPE_NONE;
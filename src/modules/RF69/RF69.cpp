@@ -529,18 +529,15 @@ int16_t RF69::setOokPeakThresholdDecrement(uint8_t value) {
 
 int16_t RF69::setFrequency(float freq) {
   // check allowed frequency range
-  if(!(((freq > 290.0f) && (freq < 340.0f)) ||
-       ((freq > 431.0f) && (freq < 510.0f)) ||
-       ((freq > 862.0f) && (freq < 1020.0f)))) {
-    return(RADIOLIB_ERR_INVALID_FREQUENCY);
-  }
+  int16_t state = checkFrequency(freq);
+  RADIOLIB_ASSERT(state);
 
   // set mode to standby
   setMode(RADIOLIB_RF69_STANDBY);
 
   //set carrier frequency
-  //FRF(23:0) = freq / Fstep = freq * (1 / Fstep) = freq * (2^19 / 32.0) (pag. 17 of datasheet) 
-  uint32_t FRF = (freq * (uint32_t(1) << RADIOLIB_RF69_DIV_EXPONENT)) / RADIOLIB_RF69_CRYSTAL_FREQ;
+  uint32_t FRF = 0;
+  calculateFrequencyWord(freq, &FRF);
   this->mod->SPIwriteRegister(RADIOLIB_RF69_REG_FRF_MSB, (FRF & 0xFF0000) >> 16);
   this->mod->SPIwriteRegister(RADIOLIB_RF69_REG_FRF_MID, (FRF & 0x00FF00) >> 8);
   this->mod->SPIwriteRegister(RADIOLIB_RF69_REG_FRF_LSB, FRF & 0x0000FF);
@@ -548,6 +545,31 @@ int16_t RF69::setFrequency(float freq) {
   return(RADIOLIB_ERR_NONE);
 }
 
+int16_t RF69::checkFrequency(float freq) {
+  if(!(((freq > 290.0f) && (freq < 340.0f)) ||
+       ((freq > 431.0f) && (freq < 510.0f)) ||
+       ((freq > 862.0f) && (freq < 1020.0f)))) {
+    return(RADIOLIB_ERR_INVALID_FREQUENCY);
+  }
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t RF69::calculateFrequencyWord(float freq, uint32_t* word) {
+  if(!word) {
+    return(RADIOLIB_ERR_NULL_POINTER);
+  }
+  //FRF(23:0) = freq / Fstep = freq * (1 / Fstep) = freq * (2^19 / 32.0) (pag. 17 of datasheet) 
+  *word = (freq * (uint32_t(1) << RADIOLIB_RF69_DIV_EXPONENT)) / RADIOLIB_RF69_CRYSTAL_FREQ;
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t RF69::setFrequencyWord(uint32_t word) {
+  // frequency is updated once LSB is written, which is the last register of the burst
+  const uint8_t frf[] = { (uint8_t)((word & 0xFF0000) >> 16), (uint8_t)((word & 0x00FF00) >> 8), (uint8_t)(word & 0x0000FF) };
+  this->mod->SPIwriteRegisterBurst(RADIOLIB_RF69_REG_FRF_MSB, frf, 3);
+  return(RADIOLIB_ERR_NONE);
+}
+
 int16_t RF69::getFrequency(float *freq) {
   uint32_t FRF = 0;
 
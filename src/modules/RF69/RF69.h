@@ -745,6 +745,20 @@ class RF69: public PhysicalLayer {
     */
     int16_t setFrequency(float freq) override;
 
+    /*!
+      \brief Check the carrier frequency is allowed. Allowed values range from 290.0 MHz to 340.0 MHz,
+      431.0 MHz to 510.0 MHz and 862.0 MHz to 1020.0 MHz.
+      \param freq Carrier frequency in MHz.
+      \returns \ref status_codes
+    */
+    int16_t checkFrequency(float freq) override;
+
+    /*! \copydoc PhysicalLayer::calculateFrequencyWord */
+    int16_t calculateFrequencyWord(float freq, uint32_t* word) override;
+
+    /*! \copydoc PhysicalLayer::setFrequencyWord */
+    int16_t setFrequencyWord(uint32_t word) override;
+
     /*!
       \brief Gets carrier frequency.
       \param[out] freq Variable to write carrier frequency currently set, in MHz.
@@ -129,11 +129,12 @@ int16_t SX1262::setFrequency(float freq) {
 }
 
 int16_t SX1262::setFrequency(float freq, bool skipCalibration) {
-  RADIOLIB_CHECK_RANGE(freq, 150.0f, 960.0f, RADIOLIB_ERR_INVALID_FREQUENCY);
+  int16_t state = checkFrequency(freq);
+  RADIOLIB_ASSERT(state);
 
   // check if we need to recalibrate image
   if(!skipCalibration && (fabsf(freq - this->freqMHz) >= RADIOLIB_SX126X_CAL_IMG_FREQ_TRIG_MHZ)) {
-    int16_t state = this->calibrateImage(freq);
+    state = this->calibrateImage(freq);
     RADIOLIB_ASSERT(state);
   }
 
@@ -141,6 +142,11 @@ int16_t SX1262::setFrequency(float freq, bool skipCalibration) {
   return(SX126x::setFrequencyRaw(freq));
 }
 
+int16_t SX1262::checkFrequency(float freq) {
+  RADIOLIB_CHECK_RANGE(freq, 150.0f, 960.0f, RADIOLIB_ERR_INVALID_FREQUENCY);
+  return(RADIOLIB_ERR_NONE);
+}
+
 int16_t SX1262::setOutputPower(int8_t power) {
   return(setOutputPower(power, true));
 }
@@ -113,6 +113,13 @@ class SX1262: public SX126x {
     */
     int16_t setFrequency(float freq, bool skipCalibration);
 
+    /*!
+      \brief Check the carrier frequency is in range from 150.0 to 960.0 MHz.
+      \param freq Carrier frequency in MHz.
+      \returns \ref status_codes
+    */
+    int16_t checkFrequency(float freq) override;
+
     /*!
       \brief Sets output power. Allowed values are in range from -9 to 22 dBm.
       This method is virtual to allow override from the SX1261 class.
@@ -112,6 +112,13 @@ class SX1268: public SX126x {
     */
     int16_t setFrequency(float freq, bool skipCalibration);
 
+    /*!
+      \brief Check the carrier frequency is in range from 410.0 to 810.0 MHz.
+      \param freq Carrier frequency in MHz.
+      \returns \ref status_codes
+    */
+    int16_t checkFrequency(float freq) override;
+
     /*!
       \brief Sets output power. Allowed values are in range from -9 to 22 dBm.
       \param power Output power to be set in dBm.
@@ -438,6 +438,94 @@ int16_t SX126x::scanChannel(const ChannelScanConfig_t &config) {
   return(getChannelScanResult());
 }
 
+int16_t SX126x::scanChannels(const uint32_t* words, size_t numChannels, const ChannelScanConfig_t &config, int16_t* results) {
+  if(!words || !results) {
+    return(RADIOLIB_ERR_NULL_POINTER);
+  }
+
+  // only LoRa has CAD, other modems are scanned one channel at a time
+  if(getPacketType() != RADIOLIB_SX126X_PACKET_TYPE_LORA) {
+    return(PhysicalLayer::scanChannels(words, numChannels, config, results));
+  }
+
+  // set mode to standby
+  int16_t state = standby();
+  RADIOLIB_ASSERT(state);
+
+  // DIO mapping and CAD parameters are the same for all channels
+  state = setDioIrqParams(getIrqMapped(config.cad.irqFlags), getIrqMapped(config.cad.irqMask));
+  RADIOLIB_ASSERT(state);
+
+  state = setCadParams(config.cad.symNum, config.cad.detPeak, config.cad.detMin, config.cad.exitMode, config.cad.timeout);
+  RADIOLIB_ASSERT(state);
+
+  // calculate timeout in ms (5ms + 500 % of expected CAD duration)
+  uint8_t symNum = (config.cad.symNum == RADIOLIB_SX126X_CAD_PARAM_DEFAULT) ? RADIOLIB_SX126X_CAD_ON_4_SYMB : config.cad.symNum;
+  symNum = RADIOLIB_MIN(symNum, RADIOLIB_SX126X_CAD_ON_16_SYMB);
+  RadioLibTime_t timeout = 5 + (RadioLibTime_t)(5.0f * (float)((uint32_t)1 << (this->spreadingFactor + symNum)) / this->bandwidthKhz);
+  RADIOLIB_DEBUG_BASIC_PRINTLN("Timeout in %lu ms", timeout);
+
+  // set RF switch (if present)
+  this->mod->setRfSwitchState(Module::MODE_RX);
+
+  for(size_t i = 0; i < numChannels; i++) {
+    // the frequency can only be changed while in standby, so it cannot overlap with the previous CAD
+    state = setRfFrequency(words[i]);
+    if(state != RADIOLIB_ERR_NONE) {
+      break;
+    }
+
+    state = clearIrqStatus();
+    if(state != RADIOLIB_ERR_NONE) {
+      break;
+    }
+
+    state = this->mod->SPIwriteStream(RADIOLIB_SX126X_CMD_SET_CAD, NULL, 0);
+    if(state != RADIOLIB_ERR_NONE) {
+      break;
+    }
+
+    // wait for channel activity detected or timeout
+    RadioLibTime_t start = this->mod->hal->millis();
+    while(!this->mod->hal->digitalRead(this->mod->getIrq())) {
+      this->mod->hal->yield();
+      if(this->mod->hal->millis() - start > timeout) {
+        state = RADIOLIB_ERR_RX_TIMEOUT;
+        break;
+      }
+    }
+    if(state != RADIOLIB_ERR_NONE) {
+      break;
+    }
+
+    // check CAD result
+    uint16_t cadResult = getIrqFlags();
+    if(cadResult & RADIOLIB_SX126X_IRQ_CAD_DETECTED) {
+      results[i] = RADIOLIB_LORA_DETECTED;
+
+      // exit mode may have started reception, get back to standby for the next channel
+      state = standby();
+      if(state != RADIOLIB_ERR_NONE) {
+        break;
+      }
+      this->mod->setRfSwitchState(Module::MODE_RX);
+
+    } else if(cadResult & RADIOLIB_SX126X_IRQ_CAD_DONE) {
+      results[i] = RADIOLIB_CHANNEL_FREE;
+
+    } else {
+      results[i] = RADIOLIB_ERR_UNKNOWN;
+
+    }
+  }
+
+  // always leave the radio in standby with the RF switch released, even if the scan failed
+  int16_t stateStandby = standby();
+  RADIOLIB_ASSERT(state);
+  RADIOLIB_ASSERT(stateStandby);
+  return(clearIrqStatus());
+}
+
 int16_t SX126x::hopLRFHSS() {
   if(!(this->getIrqFlags() & RADIOLIB_SX126X_IRQ_LR_FHSS_HOP)) {
     return(RADIOLIB_ERR_TX_TIMEOUT);
@@ -786,71 +874,18 @@ int16_t SX126x::getLoRaRxHeaderInfo(uint8_t* cr, bool* hasCRC) {
 }
 
 RadioLibTime_t SX126x::calculateTimeOnAir(ModemType_t modem, DataRate_t dr, PacketConfig_t pc, size_t len) {
-  // everything is in microseconds to allow integer arithmetic
-  // some constants have .25, these are multiplied by 4, and have _x4 postfix to indicate that fact
+  // the actual calculation is done by the shared time-on-air core
   switch (modem) {
-    case RADIOLIB_MODEM_LORA: {
-      uint32_t symbolLength_us = ((uint32_t)(1000 * 10) << dr.lora.spreadingFactor) / (dr.lora.bandwidth * 10) ;
-      uint8_t sfCoeff1_x4 = 17; // (4.25 * 4)
-      uint8_t sfCoeff2 = 8;
-      if(dr.lora.spreadingFactor == 5 || dr.lora.spreadingFactor == 6) {
-        sfCoeff1_x4 = 25; // 6.25 * 4
-        sfCoeff2 = 0;
-      }
-      uint8_t sfDivisor = 4*dr.lora.spreadingFactor;
-      if(pc.lora.ldrOptimize) {
-        sfDivisor = 4*(dr.lora.spreadingFactor - 2);
+    case RADIOLIB_MODEM_LORA:
+      return(rlb_toaLoRa(dr.lora.spreadingFactor, dr.lora.bandwidth, dr.lora.codingRate,
+        pc.lora.preambleLength, pc.lora.crcEnabled, pc.lora.implicitHeader, pc.lora.ldrOptimize, len));
+    case RADIOLIB_MODEM_FSK:
+      return(rlb_toaFSK(dr.fsk.bitRate, pc.fsk.preambleLength, pc.fsk.syncWordLength, pc.fsk.crcLength, len));
+    case RADIOLIB_MODEM_LRFHSS:
+      if(dr.lrFhss.cr > RADIOLIB_SX126X_LR_FHSS_CR_1_3) {
+        return(RADIOLIB_ERR_INVALID_CODING_RATE);
       }
-      const int8_t bitsPerCrc = 16;
-      const int8_t N_symbol_header = pc.lora.implicitHeader ? 0 : 20;
-
-      // numerator of equation in section 6.1.4 of SX1268 datasheet v1.1 (might not actually be bitcount, but it has len * 8)
-      int16_t bitCount = (int16_t) 8 * len + pc.lora.crcEnabled * bitsPerCrc - 4 * dr.lora.spreadingFactor  + sfCoeff2 + N_symbol_header;
-      if(bitCount < 0) {
-        bitCount = 0;
-      }
-      // add (sfDivisor) - 1 to the numerator to give integer CEIL(...)
-      uint16_t nPreCodedSymbols = (bitCount + (sfDivisor - 1)) / (sfDivisor);
-
-      // preamble can be 65k, therefore nSymbol_x4 needs to be 32 bit
-      uint32_t nSymbol_x4 = (pc.lora.preambleLength + 8) * 4 + sfCoeff1_x4 + nPreCodedSymbols * dr.lora.codingRate * 4;
-
-      return((symbolLength_us * nSymbol_x4) / 4);
-    }
-    case RADIOLIB_MODEM_FSK: {
-       return((((float)(pc.fsk.crcLength * 8) + pc.fsk.syncWordLength + pc.fsk.preambleLength + (uint32_t)len * 8) / (dr.fsk.bitRate / 1000.0f)));
-    }
-    case RADIOLIB_MODEM_LRFHSS: {
-      // calculate the number of bits based on coding rate
-      uint16_t N_bits;
-      switch(dr.lrFhss.cr) {
-        case RADIOLIB_SX126X_LR_FHSS_CR_5_6:
-          N_bits = ((len * 6) + 4) / 5; // this is from the official LR11xx driver, but why the extra +4?
-          break;
-        case RADIOLIB_SX126X_LR_FHSS_CR_2_3:
-          N_bits = (len * 3) / 2;
-          break;
-        case RADIOLIB_SX126X_LR_FHSS_CR_1_2:
-          N_bits = len * 2;
-          break;
-        case RADIOLIB_SX126X_LR_FHSS_CR_1_3:
-          N_bits = len * 3;
-          break;
-        default:
-          return(RADIOLIB_ERR_INVALID_CODING_RATE);
-      }
-
-      // calculate number of bits when accounting for unaligned last block
-      uint16_t N_payBits = (N_bits / RADIOLIB_SX126X_LR_FHSS_FRAG_BITS) * RADIOLIB_SX126X_LR_FHSS_BLOCK_BITS;
-      uint16_t N_lastBlockBits = N_bits % RADIOLIB_SX126X_LR_FHSS_FRAG_BITS;
-      if(N_lastBlockBits) {
-        N_payBits += N_lastBlockBits + 2;
-      }
-
-      // add header bits
-      uint16_t N_totalBits = (RADIOLIB_SX126X_LR_FHSS_HEADER_BITS * pc.lrFhss.hdrCount) + N_payBits;
-      return(((uint32_t)N_totalBits * 8 * 1000000UL) / 488.28215f);
-    }
+      return(rlb_toaLrFhss(dr.lrFhss.cr, pc.lrFhss.hdrCount, len));
     default:
       return(RADIOLIB_ERR_WRONG_MODEM);
   }
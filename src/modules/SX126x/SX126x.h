@@ -10,6 +10,7 @@
 #include "../../protocols/PhysicalLayer/PhysicalLayer.h"
 #include "../../utils/FEC.h"
 #include "../../utils/CRC.h"
+#include "../../utils/TimeOnAir.h"
 
 #include "SX126x_commands.h"
 #include "SX126x_registers.h"
@@ -29,6 +30,39 @@
 #define RADIOLIB_SX126X_LR_FHSS_BLOCK_PREAMBLE_BITS             (2)
 #define RADIOLIB_SX126X_LR_FHSS_BLOCK_BITS                      (RADIOLIB_SX126X_LR_FHSS_FRAG_BITS + RADIOLIB_SX126X_LR_FHSS_BLOCK_PREAMBLE_BITS)
 
+// configuration snapshot flags
+#define RADIOLIB_SX126X_CONFIG_FLAG_TCXO                        (0x01 << 0)
+#define RADIOLIB_SX126X_CONFIG_FLAG_DIO2_RF_SWITCH              (0x01 << 1)
+#define RADIOLIB_SX126X_CONFIG_FLAG_IMAGE_CAL                   (0x01 << 2)
+
+/*!
+  \enum SX126xSchemeConfig_t
+  \brief Layout of the configuration snapshot buffer used by SX126x::saveConfig and SX126x::restoreConfig.
+*/
+enum SX126xSchemeConfig_t {
+  RADIOLIB_SX126X_CONFIG_START              = 0x00,
+  RADIOLIB_SX126X_CONFIG_PACKET_TYPE        = RADIOLIB_SX126X_CONFIG_START,               // 1 byte
+  RADIOLIB_SX126X_CONFIG_FLAGS              = RADIOLIB_SX126X_CONFIG_PACKET_TYPE + 1,     // 1 byte
+  RADIOLIB_SX126X_CONFIG_REGULATOR          = RADIOLIB_SX126X_CONFIG_FLAGS + 1,           // 1 byte
+  RADIOLIB_SX126X_CONFIG_FALLBACK           = RADIOLIB_SX126X_CONFIG_REGULATOR + 1,       // 1 byte
+  RADIOLIB_SX126X_CONFIG_TCXO               = RADIOLIB_SX126X_CONFIG_FALLBACK + 1,        // 4 bytes
+  RADIOLIB_SX126X_CONFIG_IMAGE_CAL          = RADIOLIB_SX126X_CONFIG_TCXO + 4,            // 2 bytes
+  RADIOLIB_SX126X_CONFIG_RF_FREQ            = RADIOLIB_SX126X_CONFIG_IMAGE_CAL + 2,       // 4 bytes
+  RADIOLIB_SX126X_CONFIG_PA_CONFIG          = RADIOLIB_SX126X_CONFIG_RF_FREQ + 4,         // 4 bytes
+  RADIOLIB_SX126X_CONFIG_TX_PARAMS          = RADIOLIB_SX126X_CONFIG_PA_CONFIG + 4,       // 2 bytes
+  RADIOLIB_SX126X_CONFIG_MOD_PARAMS         = RADIOLIB_SX126X_CONFIG_TX_PARAMS + 2,       // 8 bytes
+  RADIOLIB_SX126X_CONFIG_PKT_PARAMS         = RADIOLIB_SX126X_CONFIG_MOD_PARAMS + 8,      // 9 bytes (BPSK: 1 byte command, 6 bytes register)
+  RADIOLIB_SX126X_CONFIG_REG_WHITENING      = RADIOLIB_SX126X_CONFIG_PKT_PARAMS + 9,      // 2 bytes
+  RADIOLIB_SX126X_CONFIG_REG_CRC_SYNC       = RADIOLIB_SX126X_CONFIG_REG_WHITENING + 2,   // 12 bytes
+  RADIOLIB_SX126X_CONFIG_REG_LORA_SYNC      = RADIOLIB_SX126X_CONFIG_REG_CRC_SYNC + 12,   // 2 bytes
+  RADIOLIB_SX126X_CONFIG_REG_IQ             = RADIOLIB_SX126X_CONFIG_REG_LORA_SYNC + 2,   // 1 byte
+  RADIOLIB_SX126X_CONFIG_REG_SENSITIVITY    = RADIOLIB_SX126X_CONFIG_REG_IQ + 1,          // 1 byte
+  RADIOLIB_SX126X_CONFIG_REG_RX_GAIN        = RADIOLIB_SX126X_CONFIG_REG_SENSITIVITY + 1, // 1 byte
+  RADIOLIB_SX126X_CONFIG_REG_TX_CLAMP       = RADIOLIB_SX126X_CONFIG_REG_RX_GAIN + 1,     // 1 byte
+  RADIOLIB_SX126X_CONFIG_REG_OCP            = RADIOLIB_SX126X_CONFIG_REG_TX_CLAMP + 1,    // 1 byte
+  RADIOLIB_SX126X_CONFIG_BUF_SIZE           = RADIOLIB_SX126X_CONFIG_REG_OCP + 1          // Configuration buffer size
+};
+
 /*!
   \class SX126x
   \brief Base class for %SX126x series. All derived classes for %SX126x (e.g. SX1262 or SX1268) inherit from this base class.
@@ -184,6 +218,19 @@ class SX126x: public PhysicalLayer {
     */
     int16_t scanChannel(const ChannelScanConfig_t &config) override;
 
+    /*!
+      \brief Performs scan for LoRa transmission on multiple channels. CAD and IRQ configuration is only done once,
+      so each channel only costs frequency change, IRQ clear and CAD start. For modems other than LoRa,
+      the generic PhysicalLayer::scanChannels is used instead.
+      \param words Array of raw frequency words of the channels to scan, as calculated by calculateFrequencyWord.
+      \param numChannels Number of channels to scan.
+      \param config CAD configuration structure.
+      \param results Array to save per-channel results into, must be numChannels long.
+      \returns \ref status_codes, RADIOLIB_ERR_RX_TIMEOUT if the CAD on a channel did not finish in time.
+      The radio is left in standby in all cases.
+    */
+    int16_t scanChannels(const uint32_t* words, size_t numChannels, const ChannelScanConfig_t &config, int16_t* results) override;
+
     /*!
       \brief Reset the AGC gain state by performing a warm sleep, recalibration, and
       image rejection calibration cycle. Re-applies DIO2 RF switch and RX boosted gain
@@ -442,6 +489,12 @@ class SX126x: public PhysicalLayer {
     */
     int16_t setFrequencyDeviation(float freqDev) override;
 
+    /*! \copydoc PhysicalLayer::calculateFrequencyWord */
+    int16_t calculateFrequencyWord(float freq, uint32_t* word) override;
+
+    /*! \copydoc PhysicalLayer::setFrequencyWord */
+    int16_t setFrequencyWord(uint32_t word) override;
+
     /*!
       \brief Sets FSK bit rate. Allowed values range from 0.6 to 300.0 kbps.
       \param br FSK bit rate to be set in kbps.
@@ -658,13 +711,13 @@ class SX126x: public PhysicalLayer {
       \param len Payload length in bytes.
       \returns \ref status_codes
     */
-    int16_t implicitHeader(size_t len);
+    int16_t implicitHeader(size_t len) override;
 
     /*!
       \brief Set explicit header mode for future reception/transmission.
       \returns \ref status_codes
     */
-    int16_t explicitHeader();
+    int16_t explicitHeader() override;
 
     /*!
       \brief Set regulator mode to LDO.
@@ -722,6 +775,13 @@ class SX126x: public PhysicalLayer {
     */
     int16_t invertIQ(bool enable) override;
 
+    /*!
+      \brief Enable/disable the packet CRC, with the default CRC length of the active modem.
+      \param enable CRC enabled (true) or disabled (false).
+      \returns \ref status_codes
+    */
+    int16_t setPacketCRC(bool enable) override;
+
     /*!
       \brief Get modem currently in use by the radio.
       \param modem Pointer to a variable to save the retrieved configuration into.
@@ -839,6 +899,24 @@ class SX126x: public PhysicalLayer {
     */
     int16_t setOutputPower(int8_t power, uint8_t paDutyCycle, uint8_t hpMax, uint8_t deviceSel);
 
+    /*!
+      \brief Save the current radio configuration into a compact buffer. Together with restoreConfig,
+      this allows to quickly bring the radio back to its configured state after a cold sleep,
+      without replaying all the configuration methods.
+      \param buff Buffer to save the configuration to, must be at least RADIOLIB_SX126X_CONFIG_BUF_SIZE bytes long.
+      \returns \ref status_codes
+    */
+    int16_t saveConfig(uint8_t* buff);
+
+    /*!
+      \brief Restore radio configuration previously saved by saveConfig. Intended to be called after
+      waking up from a cold sleep, i.e. after calling sleep(false). Only the radio is reconfigured,
+      the driver is expected to still hold the configuration cached at the time of saveConfig.
+      \param buff Buffer with configuration snapshot, RADIOLIB_SX126X_CONFIG_BUF_SIZE bytes long.
+      \returns \ref status_codes
+    */
+    int16_t restoreConfig(const uint8_t* buff);
+
 #if !RADIOLIB_GODMODE && !RADIOLIB_LOW_LEVEL
   protected:
 #endif
@@ -849,6 +927,7 @@ class SX126x: public PhysicalLayer {
     int16_t setTx(uint32_t timeout = 0);
     int16_t setRx(uint32_t timeout);
     int16_t setCad(uint8_t symbolNum, uint8_t detPeak, uint8_t detMin, uint8_t exitMode, RadioLibTime_t timeout);
+    int16_t setCadParams(uint8_t symbolNum, uint8_t detPeak, uint8_t detMin, uint8_t exitMode, RadioLibTime_t timeout);
     int16_t writeRegister(uint16_t addr, const uint8_t* data, uint8_t numBytes);
     int16_t readRegister(uint16_t addr, uint8_t* data, uint8_t numBytes);
     int16_t writeBuffer(const uint8_t* data, uint8_t numBytes, uint8_t offset = 0x00);
@@ -904,7 +983,18 @@ class SX126x: public PhysicalLayer {
     float rxBandwidthKhz = 0;
 
     uint32_t tcxoDelay = 0;
+    uint8_t tcxoVoltage = 0;
+    bool tcxoEnabled = false;
+    uint8_t regulatorMode = 0;
+    uint8_t imageCal[2] = { 0, 0 };
+    uint8_t paConfig[4] = { 0, 0, 0, 0 };
+    uint8_t rfFreq[4] = { 0, 0, 0, 0 };
     uint8_t pwr = 0;
+    uint8_t paRampTime = RADIOLIB_SX126X_PA_RAMP_200U;
+
+    // raw parameters of the last modulation and packet parameter commands, only updated when the command succeeded
+    uint8_t modParams[8] = { 0 };
+    uint8_t pktParams[9] = { 0 };
     bool dio2RfSwitch = false;
     bool rxBoostedGainMode = false;
 
@@ -1,4 +1,5 @@
 #include "SX126x.h"
+#include <string.h>
 
 // this file contains implementation of all commands
 // supported by the SX126x SPI interface
@@ -102,6 +103,15 @@ int16_t SX126x::setRx(uint32_t timeout) {
 }
 
 int16_t SX126x::setCad(uint8_t symbolNum, uint8_t detPeak, uint8_t detMin, uint8_t exitMode, RadioLibTime_t timeout) {
+  // configure parameters
+  int16_t state = setCadParams(symbolNum, detPeak, detMin, exitMode, timeout);
+  RADIOLIB_ASSERT(state);
+
+  // start CAD
+  return(this->mod->SPIwriteStream(RADIOLIB_SX126X_CMD_SET_CAD, NULL, 0));
+}
+
+int16_t SX126x::setCadParams(uint8_t symbolNum, uint8_t detPeak, uint8_t detMin, uint8_t exitMode, RadioLibTime_t timeout) {
   // default CAD parameters are selected according to recommendations on Semtech DS.SX1261-2.W.APP rev. 1.1, page 92.
 
   // build the packet with default configuration
@@ -133,16 +143,16 @@ int16_t SX126x::setCad(uint8_t symbolNum, uint8_t detPeak, uint8_t detMin, uint8
   }
 
   // configure parameters
-  int16_t state = this->mod->SPIwriteStream(RADIOLIB_SX126X_CMD_SET_CAD_PARAMS, data, 7);
-  RADIOLIB_ASSERT(state);
-
-  // start CAD
-  return(this->mod->SPIwriteStream(RADIOLIB_SX126X_CMD_SET_CAD, NULL, 0));
+  return(this->mod->SPIwriteStream(RADIOLIB_SX126X_CMD_SET_CAD_PARAMS, data, 7));
 }
 
 int16_t SX126x::setPaConfig(uint8_t paDutyCycle, uint8_t deviceSel, uint8_t hpMax, uint8_t paLut) {
   const uint8_t data[] = { paDutyCycle, hpMax, deviceSel, paLut };
-  return(this->mod->SPIwriteStream(RADIOLIB_SX126X_CMD_SET_PA_CONFIG, data, 4));
+  int16_t state = this->mod->SPIwriteStream(RADIOLIB_SX126X_CMD_SET_PA_CONFIG, data, 4);
+  if(state == RADIOLIB_ERR_NONE) {
+    memcpy(this->paConfig, data, sizeof(data));
+  }
+  return(state);
 }
 
 int16_t SX126x::writeRegister(uint16_t addr, const uint8_t* data, uint8_t numBytes) {
@@ -184,11 +194,18 @@ int16_t SX126x::clearIrqStatus(uint16_t clearIrqParams) {
 
 int16_t SX126x::setRfFrequency(uint32_t frf) {
   const uint8_t data[] = { (uint8_t)((frf >> 24) & 0xFF), (uint8_t)((frf >> 16) & 0xFF), (uint8_t)((frf >> 8) & 0xFF), (uint8_t)(frf & 0xFF) };
-  return(this->mod->SPIwriteStream(RADIOLIB_SX126X_CMD_SET_RF_FREQUENCY, data, 4));
+  int16_t state = this->mod->SPIwriteStream(RADIOLIB_SX126X_CMD_SET_RF_FREQUENCY, data, 4);
+  if(state == RADIOLIB_ERR_NONE) {
+    memcpy(this->rfFreq, data, sizeof(data));
+  }
+  return(state);
 }
 
 int16_t SX126x::calibrateImage(const uint8_t* data) {
   int16_t state = this->mod->SPIwriteStream(RADIOLIB_SX126X_CMD_CALIBRATE_IMAGE, data, 2);
+  if(state == RADIOLIB_ERR_NONE) {
+    memcpy(this->imageCal, data, sizeof(this->imageCal));
+  }
 
   // if something failed, show the device errors
   #if RADIOLIB_DEBUG_BASIC
@@ -213,6 +230,7 @@ int16_t SX126x::setTxParams(uint8_t pwr, uint8_t rampTime) {
   int16_t state = this->mod->SPIwriteStream(RADIOLIB_SX126X_CMD_SET_TX_PARAMS, data, 2);
   if(state == RADIOLIB_ERR_NONE) {
     this->pwr = pwr;
+    this->paRampTime = rampTime;
   }
   return(state);
 }
@@ -232,33 +250,48 @@ int16_t SX126x::setModulationParams(uint8_t sf, uint8_t bw, uint8_t cr, uint8_t
   // 500/9/8  - 0x09 0x04 0x03 0x00 - SF9, BW125, 4/8
   // 500/11/8 - 0x0B 0x04 0x03 0x00 - SF11 BW125, 4/7
   const uint8_t data[4] = {sf, bw, cr, this->ldrOptimize};
-  return(this->mod->SPIwriteStream(RADIOLIB_SX126X_CMD_SET_MODULATION_PARAMS, data, 4));
+  int16_t state = this->mod->SPIwriteStream(RADIOLIB_SX126X_CMD_SET_MODULATION_PARAMS, data, 4);
+  RADIOLIB_ASSERT(state);
+  memcpy(this->modParams, data, sizeof(data));
+  return(state);
 }
 
 int16_t SX126x::setModulationParamsFSK(uint32_t br, uint8_t sh, uint8_t rxBw, uint32_t freqDev) {
   const uint8_t data[8] = {(uint8_t)((br >> 16) & 0xFF), (uint8_t)((br >> 8) & 0xFF), (uint8_t)(br & 0xFF),
                      sh, rxBw,
                      (uint8_t)((freqDev >> 16) & 0xFF), (uint8_t)((freqDev >> 8) & 0xFF), (uint8_t)(freqDev & 0xFF)};
-  return(this->mod->SPIwriteStream(RADIOLIB_SX126X_CMD_SET_MODULATION_PARAMS, data, 8));
+  int16_t state = this->mod->SPIwriteStream(RADIOLIB_SX126X_CMD_SET_MODULATION_PARAMS, data, 8);
+  RADIOLIB_ASSERT(state);
+  memcpy(this->modParams, data, sizeof(data));
+  return(state);
 }
 
 int16_t SX126x::setModulationParamsBPSK(uint32_t br, uint8_t sh) {
   const uint8_t data[] = {(uint8_t)((br >> 16) & 0xFF), (uint8_t)((br >> 8) & 0xFF), (uint8_t)(br & 0xFF), sh};
-  return(this->mod->SPIwriteStream(RADIOLIB_SX126X_CMD_SET_MODULATION_PARAMS, data, sizeof(data)));
+  int16_t state = this->mod->SPIwriteStream(RADIOLIB_SX126X_CMD_SET_MODULATION_PARAMS, data, sizeof(data));
+  RADIOLIB_ASSERT(state);
+  memcpy(this->modParams, data, sizeof(data));
+  return(state);
 }
 
 int16_t SX126x::setPacketParams(uint16_t preambleLen, uint8_t crcType, uint8_t payloadLen, uint8_t hdrType, uint8_t invertIQ) {
   int16_t state = fixInvertedIQ(invertIQ);
   RADIOLIB_ASSERT(state);
   const uint8_t data[6] = {(uint8_t)((preambleLen >> 8) & 0xFF), (uint8_t)(preambleLen & 0xFF), hdrType, payloadLen, crcType, invertIQ};
-  return(this->mod->SPIwriteStream(RADIOLIB_SX126X_CMD_SET_PACKET_PARAMS, data, 6));
+  state = this->mod->SPIwriteStream(RADIOLIB_SX126X_CMD_SET_PACKET_PARAMS, data, 6);
+  RADIOLIB_ASSERT(state);
+  memcpy(this->pktParams, data, sizeof(data));
+  return(state);
 }
 
 int16_t SX126x::setPacketParamsFSK(uint16_t preambleLen, uint8_t preambleDetectorLen, uint8_t crcType, uint8_t syncWordLen, uint8_t addrCmp, uint8_t whiten, uint8_t packType, uint8_t payloadLen) {
   const uint8_t data[9] = {(uint8_t)((preambleLen >> 8) & 0xFF), (uint8_t)(preambleLen & 0xFF),
                      preambleDetectorLen, syncWordLen, addrCmp,
                      packType, payloadLen, crcType, whiten};
-  return(this->mod->SPIwriteStream(RADIOLIB_SX126X_CMD_SET_PACKET_PARAMS, data, 9));
+  int16_t state = this->mod->SPIwriteStream(RADIOLIB_SX126X_CMD_SET_PACKET_PARAMS, data, 9);
+  RADIOLIB_ASSERT(state);
+  memcpy(this->pktParams, data, sizeof(data));
+  return(state);
 }
 
 int16_t SX126x::setPacketParamsBPSK(uint8_t payloadLen, uint16_t rampUpDelay, uint16_t rampDownDelay, uint16_t payloadLenBits) {
@@ -271,7 +304,10 @@ int16_t SX126x::setPacketParamsBPSK(uint8_t payloadLen, uint16_t rampUpDelay, ui
   // this one is a bit different, it seems to be split into command transaction and then a register write
   int16_t state = this->mod->SPIwriteStream(RADIOLIB_SX126X_CMD_SET_PACKET_PARAMS, data, sizeof(uint8_t));
   RADIOLIB_ASSERT(state);
-  return(this->writeRegister(RADIOLIB_SX126X_REG_BPSK_PACKET_PARAMS, &data[1], sizeof(data) - sizeof(uint8_t)));
+  state = this->writeRegister(RADIOLIB_SX126X_REG_BPSK_PACKET_PARAMS, &data[1], sizeof(data) - sizeof(uint8_t));
+  RADIOLIB_ASSERT(state);
+  memcpy(this->pktParams, data, sizeof(data));
+  return(state);
 }
 
 int16_t SX126x::setBufferBaseAddress(uint8_t txBaseAddress, uint8_t rxBaseAddress) {
@@ -281,7 +317,11 @@ int16_t SX126x::setBufferBaseAddress(uint8_t txBaseAddress, uint8_t rxBaseAddres
 
 int16_t SX126x::setRegulatorMode(uint8_t mode) {
   const uint8_t data[1] = {mode};
-  return(this->mod->SPIwriteStream(RADIOLIB_SX126X_CMD_SET_REGULATOR_MODE, data, 1));
+  int16_t state = this->mod->SPIwriteStream(RADIOLIB_SX126X_CMD_SET_REGULATOR_MODE, data, 1);
+  if(state == RADIOLIB_ERR_NONE) {
+    this->regulatorMode = mode;
+  }
+  return(state);
 }
 
 uint8_t SX126x::getStatus() {
@@ -656,6 +656,10 @@ int16_t SX126x::invertIQ(bool enable) {
   return(setPacketParams(this->preambleLengthLoRa, this->crcTypeLoRa, this->implicitLen, this->headerType, this->invertIQEnabled));
 }
 
+int16_t SX126x::setPacketCRC(bool enable) {
+  return(this->setCRC(enable ? 2 : 0));
+}
+
 int16_t SX126x::setTCXO(float voltage, uint32_t delay) {
   // check if TCXO is enabled at all
   if(this->XTAL) {
@@ -672,6 +676,7 @@ int16_t SX126x::setTCXO(float voltage, uint32_t delay) {
 
   // check 0 V disable
   if(fabsf(voltage - 0.0f) <= 0.001f) {
+    this->tcxoEnabled = false;
     return(reset(true));
   }
 
@@ -703,10 +708,14 @@ int16_t SX126x::setTCXO(float voltage, uint32_t delay) {
   data[2] = (uint8_t)((delayValue >> 8) & 0xFF);
   data[3] = (uint8_t)(delayValue & 0xFF);
 
-  this->tcxoDelay = delay;
-
   // enable TCXO control on DIO3
-  return(this->mod->SPIwriteStream(RADIOLIB_SX126X_CMD_SET_DIO3_AS_TCXO_CTRL, data, 4));
+  int16_t state = this->mod->SPIwriteStream(RADIOLIB_SX126X_CMD_SET_DIO3_AS_TCXO_CTRL, data, 4);
+  RADIOLIB_ASSERT(state);
+
+  this->tcxoDelay = delay;
+  this->tcxoVoltage = data[0];
+  this->tcxoEnabled = true;
+  return(state);
 }
 
 int16_t SX126x::setDio2AsRfSwitch(bool enable) {
@@ -737,6 +746,162 @@ int16_t SX126x::setOutputPower(int8_t power, uint8_t paDutyCycle, uint8_t hpMax,
   return(writeRegister(RADIOLIB_SX126X_REG_OCP_CONFIGURATION, &ocp, 1));
 }
 
+int16_t SX126x::saveConfig(uint8_t* buff) {
+  if(!buff) {
+    return(RADIOLIB_ERR_NULL_POINTER);
+  }
+  memset(buff, 0, RADIOLIB_SX126X_CONFIG_BUF_SIZE);
+
+  // modem and oscillator configuration
+  buff[RADIOLIB_SX126X_CONFIG_PACKET_TYPE] = getPacketType();
+  if(buff[RADIOLIB_SX126X_CONFIG_PACKET_TYPE] > RADIOLIB_SX126X_PACKET_TYPE_LR_FHSS) {
+    return(RADIOLIB_ERR_WRONG_MODEM);
+  }
+  buff[RADIOLIB_SX126X_CONFIG_FLAGS] = (this->tcxoEnabled ? RADIOLIB_SX126X_CONFIG_FLAG_TCXO : 0) |
+                                       (this->dio2RfSwitch ? RADIOLIB_SX126X_CONFIG_FLAG_DIO2_RF_SWITCH : 0) |
+                                       (this->imageCal[0] ? RADIOLIB_SX126X_CONFIG_FLAG_IMAGE_CAL : 0);
+  buff[RADIOLIB_SX126X_CONFIG_REGULATOR] = this->regulatorMode;
+  buff[RADIOLIB_SX126X_CONFIG_FALLBACK] = this->standbyXOSC ? RADIOLIB_SX126X_RX_TX_FALLBACK_MODE_STDBY_XOSC : RADIOLIB_SX126X_RX_TX_FALLBACK_MODE_STDBY_RC;
+  uint32_t delayValue = (float)this->tcxoDelay / 15.625f;
+  buff[RADIOLIB_SX126X_CONFIG_TCXO] = this->tcxoVoltage;
+  buff[RADIOLIB_SX126X_CONFIG_TCXO + 1] = (uint8_t)((delayValue >> 16) & 0xFF);
+  buff[RADIOLIB_SX126X_CONFIG_TCXO + 2] = (uint8_t)((delayValue >> 8) & 0xFF);
+  buff[RADIOLIB_SX126X_CONFIG_TCXO + 3] = (uint8_t)(delayValue & 0xFF);
+  memcpy(&buff[RADIOLIB_SX126X_CONFIG_IMAGE_CAL], this->imageCal, sizeof(this->imageCal));
+
+  // RF parameters, all of these are cached by the driver
+  // the frequency is taken from the last programmed word, re-calculating it from MHz might not give the same value
+  memcpy(&buff[RADIOLIB_SX126X_CONFIG_RF_FREQ], this->rfFreq, sizeof(this->rfFreq));
+  memcpy(&buff[RADIOLIB_SX126X_CONFIG_PA_CONFIG], this->paConfig, sizeof(this->paConfig));
+  buff[RADIOLIB_SX126X_CONFIG_TX_PARAMS] = this->pwr;
+  buff[RADIOLIB_SX126X_CONFIG_TX_PARAMS + 1] = this->paRampTime;
+  memcpy(&buff[RADIOLIB_SX126X_CONFIG_MOD_PARAMS], this->modParams, sizeof(this->modParams));
+  memcpy(&buff[RADIOLIB_SX126X_CONFIG_PKT_PARAMS], this->pktParams, sizeof(this->pktParams));
+
+  // registers that are not cached have to be read back
+  // whitening, CRC and sync word registers are adjacent, so they can be read in bursts
+  int16_t state = readRegister(RADIOLIB_SX126X_REG_WHITENING_INITIAL_MSB, &buff[RADIOLIB_SX126X_CONFIG_REG_WHITENING], 2);
+  RADIOLIB_ASSERT(state);
+  state = readRegister(RADIOLIB_SX126X_REG_CRC_INITIAL_MSB, &buff[RADIOLIB_SX126X_CONFIG_REG_CRC_SYNC], 12);
+  RADIOLIB_ASSERT(state);
+  state = readRegister(RADIOLIB_SX126X_REG_LORA_SYNC_WORD_MSB, &buff[RADIOLIB_SX126X_CONFIG_REG_LORA_SYNC], 2);
+  RADIOLIB_ASSERT(state);
+  state = readRegister(RADIOLIB_SX126X_REG_IQ_CONFIG, &buff[RADIOLIB_SX126X_CONFIG_REG_IQ], 1);
+  RADIOLIB_ASSERT(state);
+  state = readRegister(RADIOLIB_SX126X_REG_SENSITIVITY_CONFIG, &buff[RADIOLIB_SX126X_CONFIG_REG_SENSITIVITY], 1);
+  RADIOLIB_ASSERT(state);
+  state = readRegister(RADIOLIB_SX126X_REG_RX_GAIN, &buff[RADIOLIB_SX126X_CONFIG_REG_RX_GAIN], 1);
+  RADIOLIB_ASSERT(state);
+  state = readRegister(RADIOLIB_SX126X_REG_TX_CLAMP_CONFIG, &buff[RADIOLIB_SX126X_CONFIG_REG_TX_CLAMP], 1);
+  RADIOLIB_ASSERT(state);
+  return(readRegister(RADIOLIB_SX126X_REG_OCP_CONFIGURATION, &buff[RADIOLIB_SX126X_CONFIG_REG_OCP], 1));
+}
+
+int16_t SX126x::restoreConfig(const uint8_t* buff) {
+  if(!buff) {
+    return(RADIOLIB_ERR_NULL_POINTER);
+  }
+
+  uint8_t modem = buff[RADIOLIB_SX126X_CONFIG_PACKET_TYPE];
+  if(modem > RADIOLIB_SX126X_PACKET_TYPE_LR_FHSS) {
+    return(RADIOLIB_ERR_WRONG_MODEM);
+  }
+  uint8_t flags = buff[RADIOLIB_SX126X_CONFIG_FLAGS];
+
+  // wake up to RC standby, everything else depends on the oscillator being set up
+  int16_t state = standby(RADIOLIB_SX126X_STANDBY_RC, true);
+  RADIOLIB_ASSERT(state);
+
+  if(flags & RADIOLIB_SX126X_CONFIG_FLAG_TCXO) {
+    state = this->mod->SPIwriteStream(RADIOLIB_SX126X_CMD_SET_DIO3_AS_TCXO_CTRL, &buff[RADIOLIB_SX126X_CONFIG_TCXO], 4);
+    RADIOLIB_ASSERT(state);
+
+    // the automatic calibration after wakeup was done without TCXO, so it has to be repeated
+    state = calibrate(RADIOLIB_SX126X_CALIBRATE_ALL);
+    RADIOLIB_ASSERT(state);
+    this->mod->hal->delay(5);
+    while(this->mod->hal->digitalRead(this->mod->getGpio())) {
+      this->mod->hal->yield();
+    }
+    state = this->mod->SPIcheckStream();
+    RADIOLIB_ASSERT(state);
+  }
+
+  state = setRegulatorMode(buff[RADIOLIB_SX126X_CONFIG_REGULATOR]);
+  RADIOLIB_ASSERT(state);
+
+  state = this->mod->SPIwriteStream(RADIOLIB_SX126X_CMD_SET_PACKET_TYPE, &buff[RADIOLIB_SX126X_CONFIG_PACKET_TYPE], 1);
+  RADIOLIB_ASSERT(state);
+
+  state = this->mod->SPIwriteStream(RADIOLIB_SX126X_CMD_SET_RX_TX_FALLBACK_MODE, &buff[RADIOLIB_SX126X_CONFIG_FALLBACK], 1);
+  RADIOLIB_ASSERT(state);
+
+  state = setBufferBaseAddress();
+  RADIOLIB_ASSERT(state);
+
+  if(flags & RADIOLIB_SX126X_CONFIG_FLAG_DIO2_RF_SWITCH) {
+    state = setDio2AsRfSwitch(true);
+    RADIOLIB_ASSERT(state);
+  }
+
+  if(flags & RADIOLIB_SX126X_CONFIG_FLAG_IMAGE_CAL) {
+    state = SX126x::calibrateImage(&buff[RADIOLIB_SX126X_CONFIG_IMAGE_CAL]);
+    RADIOLIB_ASSERT(state);
+  }
+
+  state = this->mod->SPIwriteStream(RADIOLIB_SX126X_CMD_SET_RF_FREQUENCY, &buff[RADIOLIB_SX126X_CONFIG_RF_FREQ], 4);
+  RADIOLIB_ASSERT(state);
+  memcpy(this->rfFreq, &buff[RADIOLIB_SX126X_CONFIG_RF_FREQ], sizeof(this->rfFreq));
+  uint32_t frf = ((uint32_t)this->rfFreq[0] << 24) | ((uint32_t)this->rfFreq[1] << 16) | ((uint32_t)this->rfFreq[2] << 8) | (uint32_t)this->rfFreq[3];
+  this->freqMHz = ((float)frf * RADIOLIB_SX126X_CRYSTAL_FREQ) / (float)(uint32_t(1) << RADIOLIB_SX126X_DIV_EXPONENT);
+
+  // PA configuration resets the OCP, so the OCP register is written later
+  state = this->mod->SPIwriteStream(RADIOLIB_SX126X_CMD_SET_PA_CONFIG, &buff[RADIOLIB_SX126X_CONFIG_PA_CONFIG], 4);
+  RADIOLIB_ASSERT(state);
+
+  state = this->mod->SPIwriteStream(RADIOLIB_SX126X_CMD_SET_TX_PARAMS, &buff[RADIOLIB_SX126X_CONFIG_TX_PARAMS], 2);
+  RADIOLIB_ASSERT(state);
+
+  // modulation and packet parameters have different length for each modem
+  size_t modLen = 8;
+  size_t pktLen = 9;
+  if(modem == RADIOLIB_SX126X_PACKET_TYPE_LORA) {
+    modLen = 4;
+    pktLen = 6;
+  } else if(modem == RADIOLIB_SX126X_PACKET_TYPE_BPSK) {
+    // BPSK packet parameters are split into one command byte and the ramp and length register
+    modLen = 4;
+    pktLen = 1;
+  }
+  state = this->mod->SPIwriteStream(RADIOLIB_SX126X_CMD_SET_MODULATION_PARAMS, &buff[RADIOLIB_SX126X_CONFIG_MOD_PARAMS], modLen);
+  RADIOLIB_ASSERT(state);
+
+  // registers go before packet parameters, as packet parameters will overwrite the payload length register
+  state = writeRegister(RADIOLIB_SX126X_REG_WHITENING_INITIAL_MSB, &buff[RADIOLIB_SX126X_CONFIG_REG_WHITENING], 2);
+  RADIOLIB_ASSERT(state);
+  state = writeRegister(RADIOLIB_SX126X_REG_CRC_INITIAL_MSB, &buff[RADIOLIB_SX126X_CONFIG_REG_CRC_SYNC], 12);
+  RADIOLIB_ASSERT(state);
+  state = writeRegister(RADIOLIB_SX126X_REG_LORA_SYNC_WORD_MSB, &buff[RADIOLIB_SX126X_CONFIG_REG_LORA_SYNC], 2);
+  RADIOLIB_ASSERT(state);
+  state = writeRegister(RADIOLIB_SX126X_REG_IQ_CONFIG, &buff[RADIOLIB_SX126X_CONFIG_REG_IQ], 1);
+  RADIOLIB_ASSERT(state);
+  state = writeRegister(RADIOLIB_SX126X_REG_SENSITIVITY_CONFIG, &buff[RADIOLIB_SX126X_CONFIG_REG_SENSITIVITY], 1);
+  RADIOLIB_ASSERT(state);
+  state = writeRegister(RADIOLIB_SX126X_REG_RX_GAIN, &buff[RADIOLIB_SX126X_CONFIG_REG_RX_GAIN], 1);
+  RADIOLIB_ASSERT(state);
+  state = writeRegister(RADIOLIB_SX126X_REG_TX_CLAMP_CONFIG, &buff[RADIOLIB_SX126X_CONFIG_REG_TX_CLAMP], 1);
+  RADIOLIB_ASSERT(state);
+  state = writeRegister(RADIOLIB_SX126X_REG_OCP_CONFIGURATION, &buff[RADIOLIB_SX126X_CONFIG_REG_OCP], 1);
+  RADIOLIB_ASSERT(state);
+
+  state = this->mod->SPIwriteStream(RADIOLIB_SX126X_CMD_SET_PACKET_PARAMS, &buff[RADIOLIB_SX126X_CONFIG_PKT_PARAMS], pktLen);
+  RADIOLIB_ASSERT(state);
+  if(modem == RADIOLIB_SX126X_PACKET_TYPE_BPSK) {
+    state = writeRegister(RADIOLIB_SX126X_REG_BPSK_PACKET_PARAMS, &buff[RADIOLIB_SX126X_CONFIG_PKT_PARAMS + 1], 6);
+  }
+  return(state);
+}
+
 int16_t SX126x::setPacketMode(uint8_t mode, uint8_t len) {
   // check active modem
   if(getPacketType() != RADIOLIB_SX126X_PACKET_TYPE_GFSK) {
@@ -769,10 +934,28 @@ int16_t SX126x::setHeaderType(uint8_t hdrType, size_t len) {
   return(state);
 }
 
+int16_t SX126x::calculateFrequencyWord(float freq, uint32_t* word) {
+  if(!word) {
+    return(RADIOLIB_ERR_NULL_POINTER);
+  }
+  *word = (freq * (uint32_t(1) << RADIOLIB_SX126X_DIV_EXPONENT)) / RADIOLIB_SX126X_CRYSTAL_FREQ;
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t SX126x::setFrequencyWord(uint32_t word) {
+  int16_t state = setRfFrequency(word);
+  RADIOLIB_ASSERT(state);
+
+  // keep the cached frequency in sync, it is used for image calibration and by the protocols
+  this->freqMHz = ((float)word * RADIOLIB_SX126X_CRYSTAL_FREQ) / (float)(uint32_t(1) << RADIOLIB_SX126X_DIV_EXPONENT);
+  return(state);
+}
+
 int16_t SX126x::setFrequencyRaw(float freq) {
   // calculate raw value
   this->freqMHz = freq;
-  uint32_t frf = (this->freqMHz * (uint32_t(1) << RADIOLIB_SX126X_DIV_EXPONENT)) / RADIOLIB_SX126X_CRYSTAL_FREQ;
+  uint32_t frf = 0;
+  calculateFrequencyWord(freq, &frf);
   return(setRfFrequency(frf));
 }
 
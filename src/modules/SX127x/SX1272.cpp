@@ -83,16 +83,22 @@ void SX1272::reset() {
 }
 
 int16_t SX1272::setFrequency(float freq) {
-  RADIOLIB_CHECK_RANGE(freq, 860.0f, 1020.0f, RADIOLIB_ERR_INVALID_FREQUENCY);
+  int16_t state = checkFrequency(freq);
+  RADIOLIB_ASSERT(state);
 
   // set frequency and if successful, save the new setting
-  int16_t state = SX127x::setFrequencyRaw(freq);
+  state = SX127x::setFrequencyRaw(freq);
   if(state == RADIOLIB_ERR_NONE) {
     SX127x::frequency = freq;
   }
   return(state);
 }
 
+int16_t SX1272::checkFrequency(float freq) {
+  RADIOLIB_CHECK_RANGE(freq, 860.0f, 1020.0f, RADIOLIB_ERR_INVALID_FREQUENCY);
+  return(RADIOLIB_ERR_NONE);
+}
+
 int16_t SX1272::setBandwidth(float bw) {
   // check active modem
   if(getActiveModem() != RADIOLIB_SX127X_LORA) {
@@ -498,6 +504,10 @@ int16_t SX1272::setCRC(bool enable, bool mode) {
   }
 }
 
+int16_t SX1272::setPacketCRC(bool enable) {
+  return(this->setCRC(enable));
+}
+
 int16_t SX1272::forceLDRO(bool enable) {
   if(getActiveModem() != RADIOLIB_SX127X_LORA) {
     return(RADIOLIB_ERR_WRONG_MODEM);
@@ -150,6 +150,13 @@ class SX1272: public SX127x {
     */
     int16_t setFrequency(float freq) override;
 
+    /*!
+      \brief Check the carrier frequency is allowed. Allowed values range from 860.0 MHz to 1020.0 MHz.
+      \param freq Carrier frequency in MHz.
+      \returns \ref status_codes
+    */
+    int16_t checkFrequency(float freq) override;
+
     /*!
       \brief Sets %LoRa link bandwidth. Allowed values are 125, 250 and 500 kHz. Only available in %LoRa mode.
       \param bw %LoRa link bandwidth to be set in kHz.
@@ -282,6 +289,13 @@ class SX1272: public SX127x {
     */
     int16_t setCRC(bool enable, bool mode = false);
 
+    /*!
+      \brief Enable/disable the packet CRC, with the default CRC length of the active modem.
+      \param enable CRC enabled (true) or disabled (false).
+      \returns \ref status_codes
+    */
+    int16_t setPacketCRC(bool enable) override;
+
     /*!
       \brief Forces LoRa low data rate optimization. Only available in LoRa mode. After calling this method, LDRO will always be set to
       the provided value, regardless of symbol length. To re-enable automatic LDRO configuration, call SX1278::autoLDRO()
@@ -302,13 +316,13 @@ class SX1272: public SX127x {
       \param len Payload length in bytes.
       \returns \ref status_codes
     */
-    int16_t implicitHeader(size_t len);
+    int16_t implicitHeader(size_t len) override;
 
     /*!
       \brief Set explicit header mode for future reception/transmission.
       \returns \ref status_codes
     */
-    int16_t explicitHeader();
+    int16_t explicitHeader() override;
     
     /*!
       \brief Set modem for the radio to use. Will perform full reset and reconfigure the radio
@@ -64,6 +64,13 @@ class SX1277: public SX1278 {
     */
     int16_t setFrequency(float freq) override;
 
+    /*!
+      \brief Check the carrier frequency is allowed. Allowed values range from 137.0 MHz to 175.0 MHz, 395.0 to 525.0 MHz (datasheet minimum is 410.0 MHz, hardware works lower) and 862.0 to 1020 MHz.
+      \param freq Carrier frequency in MHz.
+      \returns \ref status_codes
+    */
+    int16_t checkFrequency(float freq) override;
+
     /*!
       \brief Sets %LoRa link spreading factor. Allowed values range from 6 to 9. Only available in %LoRa mode.
       \param sf %LoRa link spreading factor to be set.
@@ -83,6 +83,18 @@ void SX1278::reset() {
 }
 
 int16_t SX1278::setFrequency(float freq) {
+  int16_t state = checkFrequency(freq);
+  RADIOLIB_ASSERT(state);
+
+  // set frequency and if successful, save the new setting
+  state = SX127x::setFrequencyRaw(freq);
+  if(state == RADIOLIB_ERR_NONE) {
+    SX127x::frequency = freq;
+  }
+  return(state);
+}
+
+int16_t SX1278::checkFrequency(float freq) {
   // NOTE: The datasheet specifies Band 2 as 410-525 MHz, but the hardware has been
   // verified to work down to ~395 MHz. The lower bound is set here to 395 MHz to
   // accommodate real-world use cases (e.g. TinyGS satellites, radiosondes) while
@@ -91,13 +103,7 @@ int16_t SX1278::setFrequency(float freq) {
        ((freq >= 395.0f) && (freq <= 525.0f)))) {
     return(RADIOLIB_ERR_INVALID_FREQUENCY);
   }
-
-  // set frequency and if successful, save the new setting
-  int16_t state = SX127x::setFrequencyRaw(freq);
-  if(state == RADIOLIB_ERR_NONE) {
-    SX127x::frequency = freq;
-  }
-  return(state);
+  return(RADIOLIB_ERR_NONE);
 }
 
 int16_t SX1278::setBandwidth(float bw) {
@@ -543,6 +549,10 @@ int16_t SX1278::setCRC(bool enable, bool mode) {
   }
 }
 
+int16_t SX1278::setPacketCRC(bool enable) {
+  return(this->setCRC(enable));
+}
+
 int16_t SX1278::forceLDRO(bool enable) {
   if(getActiveModem() != RADIOLIB_SX127X_LORA) {
     return(RADIOLIB_ERR_WRONG_MODEM);
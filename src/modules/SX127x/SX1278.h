@@ -161,6 +161,13 @@ class SX1278: public SX127x {
     */
     int16_t setFrequency(float freq) override;
 
+    /*!
+      \brief Check the carrier frequency is allowed. Allowed values range from 137.0 MHz to 175.0 MHz and 395.0 to 525.0 MHz (datasheet minimum is 410.0 MHz, hardware works lower).
+      \param freq Carrier frequency in MHz.
+      \returns \ref status_codes
+    */
+    int16_t checkFrequency(float freq) override;
+
     /*!
       \brief Sets %LoRa link bandwidth. Allowed values are 7.8, 10.4, 15.6, 20.8, 31.25, 41.7, 62.5, 125, 250 and 500 kHz. Only available in %LoRa mode.
       \param bw %LoRa link bandwidth to be set in kHz.
@@ -293,6 +300,13 @@ class SX1278: public SX127x {
     */
     int16_t setCRC(bool enable, bool mode = false);
 
+    /*!
+      \brief Enable/disable the packet CRC, with the default CRC length of the active modem.
+      \param enable CRC enabled (true) or disabled (false).
+      \returns \ref status_codes
+    */
+    int16_t setPacketCRC(bool enable) override;
+
     /*!
       \brief Forces LoRa low data rate optimization. Only available in LoRa mode. After calling this method,
       LDRO will always be set to the provided value, regardless of symbol length.
@@ -314,13 +328,13 @@ class SX1278: public SX127x {
       \param len Payload length in bytes.
       \returns \ref status_codes
     */
-    int16_t implicitHeader(size_t len);
+    int16_t implicitHeader(size_t len) override;
 
     /*!
       \brief Set explicit header mode for future reception/transmission.
       \returns \ref status_codes
     */
-    int16_t explicitHeader();
+    int16_t explicitHeader() override;
     
     /*!
       \brief Set modem for the radio to use. Will perform full reset and reconfigure the radio
@@ -69,6 +69,18 @@ int16_t SX1279::beginFSK(float freq, float br, float freqDev, float rxBw, int8_t
 }
 
 int16_t SX1279::setFrequency(float freq) {
+  int16_t state = checkFrequency(freq);
+  RADIOLIB_ASSERT(state);
+
+  // set frequency and if successful, save the new setting
+  state = SX127x::setFrequencyRaw(freq);
+  if(state == RADIOLIB_ERR_NONE) {
+    SX127x::frequency = freq;
+  }
+  return(state);
+}
+
+int16_t SX1279::checkFrequency(float freq) {
   // NOTE: The datasheet specifies Band 2 as 410-480 MHz, but the hardware has been
   // verified to work down to ~395 MHz. The lower bound is set here to 395 MHz to
   // accommodate real-world use cases (e.g. TinyGS satellites, radiosondes) while
@@ -78,13 +90,7 @@ int16_t SX1279::setFrequency(float freq) {
        ((freq >= 779.0f) && (freq <= 960.0f)))) {
     return(RADIOLIB_ERR_INVALID_FREQUENCY);
   }
-
-  // set frequency and if successful, save the new setting
-  int16_t state = SX127x::setFrequencyRaw(freq);
-  if(state == RADIOLIB_ERR_NONE) {
-    SX127x::frequency = freq;
-  }
-  return(state);
+  return(RADIOLIB_ERR_NONE);
 }
 
 int16_t SX1279::setModem(ModemType_t modem) {
@@ -63,6 +63,13 @@ class SX1279: public SX1278 {
       \returns \ref status_codes
     */
     int16_t setFrequency(float freq) override;
+
+    /*!
+      \brief Check the carrier frequency is allowed. Allowed values range from 137.0 MHz to 160.0 MHz, 395.0 to 480.0 MHz (datasheet minimum is 410.0 MHz, hardware works lower) and 779.0 to 960 MHz.
+      \param freq Carrier frequency in MHz.
+      \returns \ref status_codes
+    */
+    int16_t checkFrequency(float freq) override;
     
     /*!
       \brief Set modem for the radio to use. Will perform full reset and reconfigure the radio
@@ -1070,6 +1070,21 @@ int16_t SX127x::setOOK(bool enableOOK) {
   return(state);
 }
 
+int16_t SX127x::calculateFrequencyWord(float freq, uint32_t* word) {
+  if(!word) {
+    return(RADIOLIB_ERR_NULL_POINTER);
+  }
+  *word = (freq * (uint32_t(1) << RADIOLIB_SX127X_DIV_EXPONENT)) / RADIOLIB_SX127X_CRYSTAL_FREQ;
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t SX127x::setFrequencyWord(uint32_t word) {
+  // frequency is updated once LSB is written, which is the last register of the burst
+  const uint8_t frf[] = { (uint8_t)((word & 0xFF0000) >> 16), (uint8_t)((word & 0x00FF00) >> 8), (uint8_t)(word & 0x0000FF) };
+  this->mod->SPIwriteRegisterBurst(RADIOLIB_SX127X_REG_FRF_MSB, frf, 3);
+  return(RADIOLIB_ERR_NONE);
+}
+
 int16_t SX127x::setFrequencyRaw(float newFreq) {
   int16_t state = RADIOLIB_ERR_NONE;
 
@@ -1079,7 +1094,8 @@ int16_t SX127x::setFrequencyRaw(float newFreq) {
   }
 
   // calculate register values
-  uint32_t FRF = (newFreq * (uint32_t(1) << RADIOLIB_SX127X_DIV_EXPONENT)) / RADIOLIB_SX127X_CRYSTAL_FREQ;
+  uint32_t FRF = 0;
+  calculateFrequencyWord(newFreq, &FRF);
 
   // write registers
   // lsb needs to be written no matter what in order for the module to update the frequency
@@ -1171,9 +1187,8 @@ RadioLibTime_t SX127x::calculateTimeOnAir(ModemType_t modem, DataRate_t dr, Pack
     return ceil((double)symbolLength * (double)n_sym) * 1000;
 
   } else if(modem == RADIOLIB_MODEM_FSK) {
-    
-    // calculate time-on-air in us {[(length in bytes) * (8 bits / 1 byte)] / [(Bit Rate in kbps) * (1000 bps / 1 kbps)]} * (1000000 us in 1 sec)
-    return((uint32_t) ((((float)(pc.fsk.crcLength * 8) + pc.fsk.syncWordLength + pc.fsk.preambleLength + (float) (len * 8)) / (dr.fsk.bitRate * 1000.0f)) * 1000000.0f));
+    // calculate time-on-air in us using the shared time-on-air core
+    return(rlb_toaFSK(dr.fsk.bitRate, pc.fsk.preambleLength, pc.fsk.syncWordLength, pc.fsk.crcLength, len));
   } else {
     return(RADIOLIB_ERR_WRONG_MODEM);
   }
@@ -8,6 +8,7 @@
 #include "../../Module.h"
 
 #include "../../protocols/PhysicalLayer/PhysicalLayer.h"
+#include "../../utils/TimeOnAir.h"
 
 // SX127x physical layer properties
 #define RADIOLIB_SX127X_FREQUENCY_STEP_SIZE                     61.03515625
@@ -914,6 +915,12 @@ class SX127x: public PhysicalLayer {
     */
     int16_t setFrequencyDeviation(float freqDev) override;
 
+    /*! \copydoc PhysicalLayer::calculateFrequencyWord */
+    int16_t calculateFrequencyWord(float freq, uint32_t* word) override;
+
+    /*! \copydoc PhysicalLayer::setFrequencyWord */
+    int16_t setFrequencyWord(uint32_t word) override;
+
     /*!
       \brief Sets FSK receiver bandwidth. Allowed values range from 2.6 to 250 kHz. Only available in FSK mode.
       \param rxBw Receiver bandwidth to be set (in kHz).
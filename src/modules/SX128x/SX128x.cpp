@@ -571,13 +571,28 @@ int16_t SX128x::getChannelScanResult() {
 }
 
 int16_t SX128x::setFrequency(float freq) {
-  RADIOLIB_CHECK_RANGE(freq, 2400.0f, 2500.0f, RADIOLIB_ERR_INVALID_FREQUENCY);
+  int16_t state = checkFrequency(freq);
+  RADIOLIB_ASSERT(state);
 
   // calculate raw value
-  uint32_t frf = (freq * (uint32_t(1) << RADIOLIB_SX128X_DIV_EXPONENT)) / RADIOLIB_SX128X_CRYSTAL_FREQ;
+  uint32_t frf = 0;
+  calculateFrequencyWord(freq, &frf);
   return(setRfFrequency(frf));
 }
 
+int16_t SX128x::checkFrequency(float freq) {
+  RADIOLIB_CHECK_RANGE(freq, 2400.0f, 2500.0f, RADIOLIB_ERR_INVALID_FREQUENCY);
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t SX128x::calculateFrequencyWord(float freq, uint32_t* word) {
+  if(!word) {
+    return(RADIOLIB_ERR_NULL_POINTER);
+  }
+  *word = (freq * (uint32_t(1) << RADIOLIB_SX128X_DIV_EXPONENT)) / RADIOLIB_SX128X_CRYSTAL_FREQ;
+  return(RADIOLIB_ERR_NONE);
+}
+
 int16_t SX128x::setBandwidth(float bw) {
   // check active modem
   uint8_t modem = getPacketType();
@@ -900,6 +915,10 @@ int16_t SX128x::setBitRate(float br) {
   return(RADIOLIB_ERR_WRONG_MODEM);
 }
 
+int16_t SX128x::setFrequencyWord(uint32_t word) {
+  return(setRfFrequency(word));
+}
+
 int16_t SX128x::setFrequencyDeviation(float freqDev) {
   // check active modem
   uint8_t modem = getPacketType();
@@ -1346,7 +1365,7 @@ RadioLibTime_t SX128x::calculateTimeOnAir(ModemType_t modem, DataRate_t dr, Pack
       return(((uint32_t(1) << sf) / dr.lora.bandwidth) * N_symbol * 1000.0f);
     }
     case (ModemType_t::RADIOLIB_MODEM_FSK):
-      return((((float)(pc.fsk.crcLength * 8) + pc.fsk.syncWordLength + pc.fsk.preambleLength + (uint32_t)len * 8) / (dr.fsk.bitRate / 1000.0f)));
+      return(rlb_toaFSK(dr.fsk.bitRate, pc.fsk.preambleLength, pc.fsk.syncWordLength, pc.fsk.crcLength, len));
 
     default:
       return(RADIOLIB_ERR_WRONG_MODEM);
@@ -1444,6 +1463,10 @@ int16_t SX128x::invertIQ(bool enable) {
   return(setPacketParamsLoRa(this->preambleLengthLoRa, this->headerType, this->payloadLen, this->crcLoRa, this->invertIQEnabled));
 }
 
+int16_t SX128x::setPacketCRC(bool enable) {
+  return(this->setCRC(enable ? 2 : 0));
+}
+
 int16_t SX128x::stageMode(RadioModeType_t mode, RadioModeConfig_t* cfg) {
   int16_t state;
 
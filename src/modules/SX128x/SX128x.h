@@ -8,6 +8,7 @@
 #include "../../Module.h"
 
 #include "../../protocols/PhysicalLayer/PhysicalLayer.h"
+#include "../../utils/TimeOnAir.h"
 
 // SX128X physical layer properties
 #define RADIOLIB_SX128X_FREQUENCY_STEP_SIZE                     198.3642578
@@ -630,6 +631,19 @@ class SX128x: public PhysicalLayer {
     */
     int16_t setFrequency(float freq) override;
 
+    /*!
+      \brief Check the carrier frequency is in range from 2400.0 to 2500.0 MHz.
+      \param freq Carrier frequency in MHz.
+      \returns \ref status_codes
+    */
+    int16_t checkFrequency(float freq) override;
+
+    /*! \copydoc PhysicalLayer::calculateFrequencyWord */
+    int16_t calculateFrequencyWord(float freq, uint32_t* word) override;
+
+    /*! \copydoc PhysicalLayer::setFrequencyWord */
+    int16_t setFrequencyWord(uint32_t word) override;
+
     /*!
       \brief Sets LoRa bandwidth. Allowed values are 203.125, 406.25, 812.5 and 1625.0 kHz.
       \param bw LoRa bandwidth to be set in kHz.
@@ -874,14 +888,14 @@ class SX128x: public PhysicalLayer {
       \brief Set implicit header mode for future reception/transmission.
       \returns \ref status_codes
     */
-    int16_t implicitHeader(size_t len);
+    int16_t implicitHeader(size_t len) override;
 
     /*!
       \brief Set explicit header mode for future reception/transmission.
       \param len Payload length in bytes.
       \returns \ref status_codes
     */
-    int16_t explicitHeader();
+    int16_t explicitHeader() override;
 
     /*!
       \brief Sets transmission encoding. Serves only as alias for PhysicalLayer compatibility.
@@ -908,6 +922,13 @@ class SX128x: public PhysicalLayer {
       \returns \ref status_codes
     */
     int16_t invertIQ(bool enable) override;
+
+    /*!
+      \brief Enable/disable the packet CRC, with the default CRC length of the active modem.
+      \param enable CRC enabled (true) or disabled (false).
+      \returns \ref status_codes
+    */
+    int16_t setPacketCRC(bool enable) override;
     
     /*! \copydoc PhysicalLayer::stageMode */
     int16_t stageMode(RadioModeType_t mode, RadioModeConfig_t* cfg) override;
@@ -3,6 +3,62 @@
 #if !RADIOLIB_EXCLUDE_ADSB
 
 #include <math.h>
+#include <string.h>
+
+// CRC-24 lookup table for the Mode S generator polynomial 0xFFF409 (x^24 term implied),
+// entry i is the remainder of byte i shifted MSB first through the 24-bit register
+static const uint32_t adsbCrcTable[256] RADIOLIB_NONVOLATILE = {
+  0x000000, 0xFFF409, 0x001C1B, 0xFFE812, 0x003836, 0xFFCC3F, 0x00242D, 0xFFD024,
+  0x00706C, 0xFF8465, 0x006C77, 0xFF987E, 0x00485A, 0xFFBC53, 0x005441, 0xFFA048,
+  0x00E0D8, 0xFF14D1, 0x00FCC3, 0xFF08CA, 0x00D8EE, 0xFF2CE7, 0x00C4F5, 0xFF30FC,
+  0x0090B4, 0xFF64BD, 0x008CAF, 0xFF78A6, 0x00A882, 0xFF5C8B, 0x00B499, 0xFF4090,
+  0x01C1B0, 0xFE35B9, 0x01DDAB, 0xFE29A2, 0x01F986, 0xFE0D8F, 0x01E59D, 0xFE1194,
+  0x01B1DC, 0xFE45D5, 0x01ADC7, 0xFE59CE, 0x0189EA, 0xFE7DE3, 0x0195F1, 0xFE61F8,
+  0x012168, 0xFED561, 0x013D73, 0xFEC97A, 0x01195E, 0xFEED57, 0x010545, 0xFEF14C,
+  0x015104, 0xFEA50D, 0x014D1F, 0xFEB916, 0x016932, 0xFE9D3B, 0x017529, 0xFE8120,
+  0x038360, 0xFC7769, 0x039F7B, 0xFC6B72, 0x03BB56, 0xFC4F5F, 0x03A74D, 0xFC5344,
+  0x03F30C, 0xFC0705, 0x03EF17, 0xFC1B1E, 0x03CB3A, 0xFC3F33, 0x03D721, 0xFC2328,
+  0x0363B8, 0xFC97B1, 0x037FA3, 0xFC8BAA, 0x035B8E, 0xFCAF87, 0x034795, 0xFCB39C,
+  0x0313D4, 0xFCE7DD, 0x030FCF, 0xFCFBC6, 0x032BE2, 0xFCDFEB, 0x0337F9, 0xFCC3F0,
+  0x0242D0, 0xFDB6D9, 0x025ECB, 0xFDAAC2, 0x027AE6, 0xFD8EEF, 0x0266FD, 0xFD92F4,
+  0x0232BC, 0xFDC6B5, 0x022EA7, 0xFDDAAE, 0x020A8A, 0xFDFE83, 0x021691, 0xFDE298,
+  0x02A208, 0xFD5601, 0x02BE13, 0xFD4A1A, 0x029A3E, 0xFD6E37, 0x028625, 0xFD722C,
+  0x02D264, 0xFD266D, 0x02CE7F, 0xFD3A76, 0x02EA52, 0xFD1E5B, 0x02F649, 0xFD0240,
+  0x0706C0, 0xF8F2C9, 0x071ADB, 0xF8EED2, 0x073EF6, 0xF8CAFF, 0x0722ED, 0xF8D6E4,
+  0x0776AC, 0xF882A5, 0x076AB7, 0xF89EBE, 0x074E9A, 0xF8BA93, 0x075281, 0xF8A688,
+  0x07E618, 0xF81211, 0x07FA03, 0xF80E0A, 0x07DE2E, 0xF82A27, 0x07C235, 0xF8363C,
+  0x079674, 0xF8627D, 0x078A6F, 0xF87E66, 0x07AE42, 0xF85A4B, 0x07B259, 0xF84650,
+  0x06C770, 0xF93379, 0x06DB6B, 0xF92F62, 0x06FF46, 0xF90B4F, 0x06E35D, 0xF91754,
+  0x06B71C, 0xF94315, 0x06AB07, 0xF95F0E, 0x068F2A, 0xF97B23, 0x069331, 0xF96738,
+  0x0627A8, 0xF9D3A1, 0x063BB3, 0xF9CFBA, 0x061F9E, 0xF9EB97, 0x060385, 0xF9F78C,
+  0x0657C4, 0xF9A3CD, 0x064BDF, 0xF9BFD6, 0x066FF2, 0xF99BFB, 0x0673E9, 0xF987E0,
+  0x0485A0, 0xFB71A9, 0x0499BB, 0xFB6DB2, 0x04BD96, 0xFB499F, 0x04A18D, 0xFB5584,
+  0x04F5CC, 0xFB01C5, 0x04E9D7, 0xFB1DDE, 0x04CDFA, 0xFB39F3, 0x04D1E1, 0xFB25E8,
+  0x046578, 0xFB9171, 0x047963, 0xFB8D6A, 0x045D4E, 0xFBA947, 0x044155, 0xFBB55C,
+  0x041514, 0xFBE11D, 0x04090F, 0xFBFD06, 0x042D22, 0xFBD92B, 0x043139, 0xFBC530,
+  0x054410, 0xFAB019, 0x05580B, 0xFAAC02, 0x057C26, 0xFA882F, 0x05603D, 0xFA9434,
+  0x05347C, 0xFAC075, 0x052867, 0xFADC6E, 0x050C4A, 0xFAF843, 0x051051, 0xFAE458,
+  0x05A4C8, 0xFA50C1, 0x05B8D3, 0xFA4CDA, 0x059CFE, 0xFA68F7, 0x0580E5, 0xFA74EC,
+  0x05D4A4, 0xFA20AD, 0x05C8BF, 0xFA3CB6, 0x05EC92, 0xFA189B, 0x05F089, 0xFA0480,
+};
+
+// syndromes of single bit errors sorted in ascending order, shifted up by 8 bits with the bit position in the lowest byte
+static const uint32_t adsbSyndromeTable[RADIOLIB_ADSB_FRAME_LEN_BITS] RADIOLIB_NONVOLATILE = {
+  0x0000016F, 0x0000026E, 0x0000046D, 0x0000086C, 0x0000106B, 0x0000206A, 0x00004069, 0x00008068,
+  0x00010067, 0x00020066, 0x00040065, 0x00080064, 0x00100063, 0x001C1B56, 0x00200062, 0x00383655,
+  0x00400061, 0x00706C54, 0x00800060, 0x00E0D853, 0x0100005F, 0x01856738, 0x01C1B052, 0x0200005E,
+  0x030ACE37, 0x03836051, 0x0400005D, 0x049C811D, 0x06159C36, 0x0706C050, 0x0800005C, 0x0939021C,
+  0x0B0E2F0A, 0x0C2B3835, 0x0DD44147, 0x0E0D804F, 0x1000005B, 0x1272041B, 0x15B82D2E, 0x161C5E09,
+  0x18567034, 0x1BA88246, 0x1C1B004E, 0x1C9AF501, 0x2000005A, 0x24E4081A, 0x2B705A2D, 0x2BFD533F,
+  0x2C38BC08, 0x30ACE033, 0x34170511, 0x37510445, 0x38132323, 0x3836004D, 0x3935EA00, 0x3E44094A,
+  0x3F6D1120, 0x40000059, 0x457C2942, 0x4701E726, 0x49C81019, 0x4E5C9B16, 0x56E0B42C, 0x57FAA63E,
+  0x58717807, 0x5F4C210E, 0x6159C032, 0x682E0A10, 0x6EA20844, 0x70264622, 0x706C004C, 0x72F8C313,
+  0x78DBBF03, 0x7A930930, 0x7C881249, 0x7EDA221F, 0x80000058, 0x80665F3A, 0x82C48D0C, 0x8AF85241,
+  0x8E03CE25, 0x91C77F28, 0x93902018, 0x9CB93615, 0x9E31E905, 0xA01E913C, 0xA476D92A, 0xADC1682B,
+  0xAFF54C3D, 0xB0E2F006, 0xB719BB29, 0xBE98420D, 0xBFC92B3B, 0xC2B38031, 0xC397DB04, 0xC6866514,
+  0xD05C140F, 0xD8D44917, 0xDC7AF727, 0xDD441043, 0xE04C8C21, 0xE0D8004B, 0xE3F39524, 0xE5F18612,
+  0xEA04AD40, 0xF1B77E02, 0xF526122F, 0xF9102448, 0xFA7D130B, 0xFDB4441E, 0xFF38B739, 0xFFF40957,
+};
 
 ADSBClient::ADSBClient(PhysicalLayer* phy) {
   phyLayer = phy;
@@ -26,6 +82,16 @@ int16_t ADSBClient::begin() {
 int16_t ADSBClient::decode(const uint8_t in[RADIOLIB_ADSB_FRAME_LEN_BYTES], ADSBFrame* out) {
   RADIOLIB_ASSERT_PTR(out);
 
+  // check the parity on a copy, so that errors can be corrected
+  uint8_t frame[RADIOLIB_ADSB_FRAME_LEN_BYTES];
+  out->numErrors = 0;
+  if(this->parityCheck) {
+    memcpy(frame, in, RADIOLIB_ADSB_FRAME_LEN_BYTES);
+    int16_t state = this->checkParity(frame, &out->numErrors);
+    RADIOLIB_ASSERT(state);
+    in = frame;
+  }
+
   // get the basic information
   out->downlinkFormat = (in[0] & 0xF8) >> 3;
   out->capability = in[0] & 0x07;
@@ -68,6 +134,108 @@ int16_t ADSBClient::decode(const uint8_t in[RADIOLIB_ADSB_FRAME_LEN_BYTES], ADSB
   return(RADIOLIB_ERR_NONE);
 }
 
+size_t ADSBClient::decode(const uint8_t* in, size_t numFrames, ADSBFrame* out) {
+  if(!in || !out) {
+    return(0);
+  }
+
+  size_t numValid = 0;
+  for(size_t i = 0; i < numFrames; i++) {
+    if(this->decode(&in[i*RADIOLIB_ADSB_FRAME_LEN_BYTES], &out[numValid]) == RADIOLIB_ERR_NONE) {
+      numValid++;
+    }
+  }
+  return(numValid);
+}
+
+int16_t ADSBClient::setParityCheck(bool enable, uint8_t maxErrors) {
+  if(maxErrors > 2) {
+    return(RADIOLIB_ERR_INVALID_CRC_CONFIGURATION);
+  }
+  this->parityCheck = enable;
+  this->parityMaxErrors = maxErrors;
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t ADSBClient::checkParity(uint8_t frame[RADIOLIB_ADSB_FRAME_LEN_BYTES], uint8_t* numErrors) {
+  RADIOLIB_ASSERT_PTR(frame);
+  if(numErrors) {
+    *numErrors = 0;
+  }
+
+  // the syndrome is zero for valid frames, and only depends on the error pattern otherwise
+  uint32_t syndrome = ADSBClient::crc24(frame, RADIOLIB_ADSB_FRAME_DATA_LEN_BYTES);
+  syndrome ^= ((uint32_t)frame[11] << 16) | ((uint32_t)frame[12] << 8) | (uint32_t)frame[13];
+  if(syndrome == 0) {
+    return(RADIOLIB_ERR_NONE);
+  }
+
+  // only extended squitter has parity that is not overlaid with the address
+  uint8_t df = (frame[0] & 0xF8) >> 3;
+  if((df != RADIOLIB_ADSB_DF_EXTENDED_SQUITTER) && (df != RADIOLIB_ADSB_DF_EXTENDED_SQUITTER_NON_TRANSPONDER)) {
+    return(RADIOLIB_ERR_CRC_MISMATCH);
+  }
+
+  // errors in the first 5 bits would change the downlink format, so those are never corrected
+  int pos1 = -1;
+  int pos2 = -1;
+  if(this->parityMaxErrors >= 1) {
+    pos1 = ADSBClient::findSyndrome(syndrome);
+  }
+  if((pos1 < 0) && (this->parityMaxErrors >= 2)) {
+    // two errors, the syndrome is the sum of two single-bit syndromes
+    for(size_t i = 0; i < RADIOLIB_ADSB_FRAME_LEN_BITS; i++) {
+      uint32_t entry = RADIOLIB_NONVOLATILE_READ_DWORD(const_cast<uint32_t*>(&adsbSyndromeTable[i]));
+      int pos = ADSBClient::findSyndrome(syndrome ^ (entry >> 8));
+      if((pos > (int)(entry & 0xFF)) && ((entry & 0xFF) >= 5)) {
+        pos1 = entry & 0xFF;
+        pos2 = pos;
+        break;
+      }
+    }
+  }
+  if((pos1 < 5) || ((pos2 >= 0) && (pos2 < 5))) {
+    return(RADIOLIB_ERR_CRC_MISMATCH);
+  }
+
+  frame[pos1 / 8] ^= 0x80 >> (pos1 % 8);
+  if(pos2 >= 0) {
+    frame[pos2 / 8] ^= 0x80 >> (pos2 % 8);
+  }
+  if(numErrors) {
+    *numErrors = (pos2 >= 0) ? 2 : 1;
+  }
+  return(RADIOLIB_ERR_NONE);
+}
+
+uint32_t ADSBClient::crc24(const uint8_t* in, size_t len) {
+  uint32_t crc = 0;
+  for(size_t i = 0; i < len; i++) {
+    uint8_t idx = ((crc >> 16) ^ in[i]) & 0xFF;
+    crc = ((crc << 8) ^ RADIOLIB_NONVOLATILE_READ_DWORD(const_cast<uint32_t*>(&adsbCrcTable[idx]))) & 0xFFFFFF;
+  }
+  return(crc);
+}
+
+int ADSBClient::findSyndrome(uint32_t syndrome) {
+  // binary search in the sorted table
+  size_t lo = 0;
+  size_t hi = RADIOLIB_ADSB_FRAME_LEN_BITS;
+  while(lo < hi) {
+    size_t mid = (lo + hi) / 2;
+    uint32_t entry = RADIOLIB_NONVOLATILE_READ_DWORD(const_cast<uint32_t*>(&adsbSyndromeTable[mid]));
+    uint32_t val = entry >> 8;
+    if(val == syndrome) {
+      return(entry & 0xFF);
+    } else if(val < syndrome) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return(-1);
+}
+
 int16_t ADSBClient::parseHexId(const ADSBFrame* in, char id[RADIOLIB_ADSB_HEX_ID_LEN]) {
   RADIOLIB_ASSERT_PTR(in);
 
@@ -208,49 +376,162 @@ int16_t ADSBClient::parseAirbornePosition(const ADSBFrame* in, int* alt, float*
     if(altGnss) { *altGnss = (in->messageType == ADSBMessageType::AIRBORNE_POS_ALT_GNSS); }
   }
 
-  // check if this is an even or odd frame
-  bool odd = in->message[2] & 0x04;
+  // position relative to the reference
+  if(lat || lon) {
+    uint32_t latCpr = 0;
+    uint32_t lonCpr = 0;
+    bool odd = false;
+    (void)ADSBClient::parseCpr(in, &latCpr, &lonCpr, &odd);
+    ADSBClient::decodeCprLocal(this->refPos[0], this->refPos[1], latCpr, lonCpr, odd, lat, lon);
+  }
 
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t ADSBClient::parseAirborneVelocity(const ADSBFrame* in, float* speed, float* heading, int* verticalRate, bool* airspeed) {
+  RADIOLIB_ASSERT_PTR(in);
+
+  if(in->messageType != ADSBMessageType::AIRBORNE_VEL) {
+    return(RADIOLIB_ERR_ADSB_INVALID_MSG_TYPE);
+  }
+
+  uint8_t subtype = in->message[0] & 0x07;
+  if((subtype < RADIOLIB_ADSB_VEL_GROUND_SPEED) || (subtype > RADIOLIB_ADSB_VEL_AIRSPEED_SUPERSONIC)) {
+    return(RADIOLIB_ERR_ADSB_NOT_AVAILABLE);
+  }
+  int scale = ((subtype == RADIOLIB_ADSB_VEL_GROUND_SPEED_SUPERSONIC) || (subtype == RADIOLIB_ADSB_VEL_AIRSPEED_SUPERSONIC)) ? 4 : 1;
+
+  // the two 10-bit fields are east-west and north-south speed, or heading and airspeed
+  bool sign1 = in->message[1] & 0x04;
+  uint16_t raw1 = ((uint16_t)(in->message[1] & 0x03) << 8) | in->message[2];
+  bool sign2 = in->message[3] & 0x80;
+  uint16_t raw2 = ((uint16_t)(in->message[3] & 0x7F) << 3) | ((in->message[4] & 0xE0) >> 5);
+
+  if(subtype <= RADIOLIB_ADSB_VEL_GROUND_SPEED_SUPERSONIC) {
+    // zero means no information
+    if((raw1 == 0) || (raw2 == 0)) {
+      return(RADIOLIB_ERR_ADSB_NOT_AVAILABLE);
+    }
+    float vEast = (float)((raw1 - 1)*scale) * (sign1 ? -1.0f : 1.0f);
+    float vNorth = (float)((raw2 - 1)*scale) * (sign2 ? -1.0f : 1.0f);
+    if(speed) { *speed = sqrtf(vEast*vEast + vNorth*vNorth); }
+    if(heading) {
+      *heading = atan2f(vEast, vNorth) * 180.0f / (float)M_PI;
+      if(*heading < 0) { *heading += 360.0f; }
+    }
+    if(airspeed) { *airspeed = false; }
+
+  } else {
+    // sign1 is the heading status bit here
+    if(!sign1 || (raw2 == 0)) {
+      return(RADIOLIB_ERR_ADSB_NOT_AVAILABLE);
+    }
+    if(speed) { *speed = (float)((raw2 - 1)*scale); }
+    if(heading) { *heading = (float)raw1 * 360.0f / 1024.0f; }
+    if(airspeed) { *airspeed = true; }
+
+  }
+
+  if(verticalRate) {
+    uint16_t vrRaw = ((uint16_t)(in->message[4] & 0x07) << 6) | ((in->message[5] & 0xFC) >> 2);
+    *verticalRate = vrRaw ? (int)(vrRaw - 1) * 64 * ((in->message[4] & 0x08) ? -1 : 1) : 0;
+  }
+
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t ADSBClient::parseCpr(const ADSBFrame* in, uint32_t* latCpr, uint32_t* lonCpr, bool* odd) {
+  RADIOLIB_ASSERT_PTR(in);
+
+  if((in->messageType != ADSBMessageType::AIRBORNE_POS_ALT_BARO) &&
+     (in->messageType != ADSBMessageType::AIRBORNE_POS_ALT_GNSS)) {
+    return(RADIOLIB_ERR_ADSB_INVALID_MSG_TYPE);
+  }
+
+  if(odd) { *odd = in->message[2] & 0x04; }
+  if(latCpr) { *latCpr = (((uint32_t)(in->message[2] & 0x03)) << 15) | ((uint32_t)in->message[3] << 7) | (uint32_t)((in->message[4] & 0xFE) >> 1); }
+  if(lonCpr) { *lonCpr = (((uint32_t)(in->message[4] & 0x01)) << 16) | ((uint32_t)in->message[5] << 8) | (uint32_t)in->message[6]; }
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t ADSBClient::decodeCprGlobal(const uint32_t latCpr[2], const uint32_t lonCpr[2], bool oddLast, float* lat, float* lon) {
+  RADIOLIB_ASSERT_PTR(lat);
+  RADIOLIB_ASSERT_PTR(lon);
+
+  // latitude zone index, then the latitude from both frames
+  const float res = (float)RADIOLIB_ADSB_CPR_RESOLUTION;
+  float latE = (float)latCpr[0] / res;
+  float latO = (float)latCpr[1] / res;
+  int j = (int)floorf((4*RADIOLIB_ADSB_CPR_NZ - 1)*latE - 4*RADIOLIB_ADSB_CPR_NZ*latO + 0.5f);
+  float rlat[2];
+  rlat[0] = (360.0f / (4*RADIOLIB_ADSB_CPR_NZ)) * ((float)(((j % (4*RADIOLIB_ADSB_CPR_NZ)) + 4*RADIOLIB_ADSB_CPR_NZ) % (4*RADIOLIB_ADSB_CPR_NZ)) + latE);
+  rlat[1] = (360.0f / (4*RADIOLIB_ADSB_CPR_NZ - 1)) * ((float)(((j % (4*RADIOLIB_ADSB_CPR_NZ - 1)) + 4*RADIOLIB_ADSB_CPR_NZ - 1) % (4*RADIOLIB_ADSB_CPR_NZ - 1)) + latO);
+  for(int i = 0; i < 2; i++) {
+    if(rlat[i] >= 270.0f) { rlat[i] -= 360.0f; }
+    if((rlat[i] < -90.0f) || (rlat[i] > 90.0f)) {
+      return(RADIOLIB_ERR_ADSB_NOT_AVAILABLE);
+    }
+  }
+
+  // both frames have to be from the same longitude zone band, otherwise the aircraft crossed it in between
+  int nl = ADSBClient::getLonZones(rlat[0]);
+  if(nl != ADSBClient::getLonZones(rlat[1])) {
+    return(RADIOLIB_ERR_ADSB_NOT_AVAILABLE);
+  }
+
+  // longitude from the more recent frame
+  int ni = RADIOLIB_MAX(nl - (int)oddLast, 1);
+  int m = (int)floorf(((float)lonCpr[0] * (nl - 1) - (float)lonCpr[1] * nl) / res + 0.5f);
+  float tmpLon = (360.0f / ni) * ((float)(((m % ni) + ni) % ni) + (float)lonCpr[oddLast] / res);
+  if(tmpLon >= 180.0f) { tmpLon -= 360.0f; }
+
+  *lat = rlat[oddLast];
+  *lon = tmpLon;
+  return(RADIOLIB_ERR_NONE);
+}
+
+void ADSBClient::decodeCprLocal(float refLat, float refLon, uint32_t latCpr, uint32_t lonCpr, bool odd, float* lat, float* lon) {
   // always calculate the latitude - it is needed to also calculate longitude
-  uint32_t latRaw = (((uint32_t)(in->message[2] & 0x03)) << 15) | ((uint32_t)in->message[3] << 7) | (uint32_t)((in->message[4] & 0xFE) >> 1);
-  float latCpr = (float)latRaw / (float)(1UL << 17);
+  float latCprF = (float)latCpr / (float)RADIOLIB_ADSB_CPR_RESOLUTION;
   float latZoneSize = odd ? 360.0f/59.0f : 6.0f;
-  int latZoneIdx = floor(this->refPos[0] / latZoneSize) + floor((fmod(this->refPos[0], latZoneSize) / latZoneSize) - latCpr + 0.5f);
-  float tmpLat = latZoneSize * (latZoneIdx + (float)latCpr);
+  int latZoneIdx = floor(refLat / latZoneSize) + floor((fmod(refLat, latZoneSize) / latZoneSize) - latCprF + 0.5f);
+  float tmpLat = latZoneSize * (latZoneIdx + (float)latCprF);
   if(lat) { *lat = tmpLat; }
-  RADIOLIB_DEBUG_PROTOCOL_PRINT("latRaw=%d\n", latRaw);
-  RADIOLIB_DEBUG_PROTOCOL_PRINT("latCpr=%f\n", (double)latCpr);
+  RADIOLIB_DEBUG_PROTOCOL_PRINT("latRaw=%d\n", latCpr);
+  RADIOLIB_DEBUG_PROTOCOL_PRINT("latCpr=%f\n", (double)latCprF);
   RADIOLIB_DEBUG_PROTOCOL_PRINT("latZoneSize=%f\n", (double)latZoneSize);
   RADIOLIB_DEBUG_PROTOCOL_PRINT("latZoneIdx=%d\n", latZoneIdx);
 
   // only calculate longitude if the user requested it
   if(lon) {
-    int lonZone = 1;
-    if(abs(tmpLat) < 87.0f) {
-      for(size_t i = 0; i < sizeof(lonZoneLut)/sizeof(lonZoneLut[0]); i++) {
-        if(abs(tmpLat) >= lonZoneLut[i]) {
-          lonZone = i + 1;
-          break;
-        }
-      }
-      if(lonZone == 1) {
-        lonZone = 59;
-      }
-    }
-    uint32_t lonRaw = (((uint32_t)(in->message[4] & 0x01)) << 16) | ((uint32_t)in->message[5] << 8) | (uint32_t)in->message[6];
-    float lonCpr = (float)lonRaw / (float)(1UL << 17);
+    int lonZone = ADSBClient::getLonZones(tmpLat);
+    float lonCprF = (float)lonCpr / (float)RADIOLIB_ADSB_CPR_RESOLUTION;
     float lonZoneSize = 360.0f / RADIOLIB_MAX(lonZone - (int)odd, 1);
-    int lonZoneIdx = floor(this->refPos[1] / lonZoneSize) + floor((fmod(this->refPos[1], lonZoneSize) / lonZoneSize) - lonCpr + 0.5f);
-    *lon = lonZoneSize * (lonZoneIdx + (float)lonCpr);
+    int lonZoneIdx = floor(refLon / lonZoneSize) + floor((fmod(refLon, lonZoneSize) / lonZoneSize) - lonCprF + 0.5f);
+    *lon = lonZoneSize * (lonZoneIdx + (float)lonCprF);
 
-    RADIOLIB_DEBUG_PROTOCOL_PRINT("lonRaw=%d\n", lonRaw);
-    RADIOLIB_DEBUG_PROTOCOL_PRINT("lonCpr=%f\n", (double)lonCpr);
+    RADIOLIB_DEBUG_PROTOCOL_PRINT("lonRaw=%d\n", lonCpr);
+    RADIOLIB_DEBUG_PROTOCOL_PRINT("lonCpr=%f\n", (double)lonCprF);
     RADIOLIB_DEBUG_PROTOCOL_PRINT("lonZone=%d\n", lonZone);
     RADIOLIB_DEBUG_PROTOCOL_PRINT("lonZoneSize=%f\n", (double)lonZoneSize);
     RADIOLIB_DEBUG_PROTOCOL_PRINT("lonZoneIdx=%d\n", lonZoneIdx);
   }
+}
 
-  return(RADIOLIB_ERR_NONE);
+int ADSBClient::getLonZones(float lat) {
+  int lonZone = 1;
+  if(fabsf(lat) < 87.0f) {
+    for(size_t i = 0; i < sizeof(lonZoneLut)/sizeof(lonZoneLut[0]); i++) {
+      if(fabsf(lat) >= lonZoneLut[i]) {
+        lonZone = i + 1;
+        break;
+      }
+    }
+    if(lonZone == 1) {
+      lonZone = 59;
+    }
+  }
+  return(lonZone);
 }
 
 #endif
@@ -19,6 +19,24 @@
 #define RADIOLIB_ADSB_FRAME_PARITY_INTERROGATOR_LEN_BYTES       (3)
 #define RADIOLIB_ADSB_FRAME_PARITY_INTERROGATOR_POS             (11)
 
+// Mode S parity, CRC-24 over the first 88 bits of the frame
+#define RADIOLIB_ADSB_FRAME_LEN_BITS                            (112)
+#define RADIOLIB_ADSB_FRAME_DATA_LEN_BYTES                      (11)
+
+// downlink formats of extended squitter frames
+#define RADIOLIB_ADSB_DF_EXTENDED_SQUITTER                      (17)
+#define RADIOLIB_ADSB_DF_EXTENDED_SQUITTER_NON_TRANSPONDER      (18)
+
+// compact position reporting (CPR) - number of latitude zones and resolution of the encoded values
+#define RADIOLIB_ADSB_CPR_NZ                                    (15)
+#define RADIOLIB_ADSB_CPR_RESOLUTION                            (1UL << 17)
+
+// airborne velocity subtypes
+#define RADIOLIB_ADSB_VEL_GROUND_SPEED                          (1)
+#define RADIOLIB_ADSB_VEL_GROUND_SPEED_SUPERSONIC               (2)
+#define RADIOLIB_ADSB_VEL_AIRSPEED                              (3)
+#define RADIOLIB_ADSB_VEL_AIRSPEED_SUPERSONIC                   (4)
+
 // length of the ICAO address, including a terminating null
 #define RADIOLIB_ADSB_HEX_ID_LEN                                (6 + 1)
 
@@ -86,6 +104,9 @@ struct ADSBFrame {
 
     /*! \brief Message buffer, interpretation is dependent on the value of messageType. */
     uint8_t message[RADIOLIB_ADSB_FRAME_MESSAGE_LEN_BYTES];
+
+    /*! \brief Number of bit errors corrected by parity check, 0 if parity check is disabled. */
+    uint8_t numErrors;
 };
 
 /*!
@@ -114,6 +135,42 @@ class ADSBClient {
     */
     int16_t decode(const uint8_t in[RADIOLIB_ADSB_FRAME_LEN_BYTES], ADSBFrame* out);
 
+    /*!
+      \brief Bulk frame decoding method, decodes an array of raw frames and keeps only the valid ones.
+      \param in Received raw frames, RADIOLIB_ADSB_FRAME_LEN_BYTES each.
+      \param numFrames Number of frames in the input array.
+      \param out Array of at least numFrames ADSBFrame structures. Valid frames are saved here in order.
+      \returns Number of valid frames saved to the output array.
+    */
+    size_t decode(const uint8_t* in, size_t numFrames, ADSBFrame* out);
+
+    /*!
+      \brief Enable or disable parity check in decode. Disabled by default, as some radios
+      check the CRC in hardware and only pass the first 11 bytes of the frame.
+      \param enable Whether to check the parity of full 14-byte frames.
+      \param maxErrors Maximum number of bit errors to correct in extended squitter frames, up to 2.
+      Correcting 2 errors increases the chance of accepting a corrupted frame. Defaults to 1.
+      \returns \ref status_codes
+    */
+    int16_t setParityCheck(bool enable, uint8_t maxErrors = 1);
+
+    /*!
+      \brief Check parity of a raw frame and correct bit errors, if enabled by setParityCheck.
+      The downlink format bits are never corrected.
+      \param frame Raw frame of RADIOLIB_ADSB_FRAME_LEN_BYTES. Corrected in place.
+      \param numErrors If set, the number of corrected bit errors will be saved here.
+      \returns \ref status_codes
+    */
+    int16_t checkParity(uint8_t frame[RADIOLIB_ADSB_FRAME_LEN_BYTES], uint8_t* numErrors = NULL);
+
+    /*!
+      \brief Calculate Mode S CRC-24.
+      \param in Data to calculate the CRC for.
+      \param len Length of the data in bytes.
+      \returns CRC-24 of the data.
+    */
+    static uint32_t crc24(const uint8_t* in, size_t len);
+
     /*!
       \brief Method to parse the transponder ICAO address (hex ID).
       \param in Pointer to ADSBFrame where decoded frame was saved.
@@ -150,6 +207,60 @@ class ADSBClient {
       \param altGnss If set, this variable will be set to true if the altitude source is GNSS, or false if the altitude is barometric.
     */
     int16_t parseAirbornePosition(const ADSBFrame* in, int* alt, float* lat, float* lon, bool* altGnss = NULL);
+
+    /*!
+      \brief Parse aircraft velocity from incoming frame.
+      \param in Pointer to ADSBFrame where decoded frame was saved.
+      \param speed Pointer to variable where the speed in knots will be saved. Can be set to null to skip speed calculation.
+      \param heading Pointer to variable where the track (for ground speed) or heading (for airspeed) in degrees will be saved.
+      Can be set to null to skip heading calculation.
+      \param verticalRate Pointer to variable where the vertical rate in feet per minute will be saved (climb positive).
+      Can be set to null to skip vertical rate calculation.
+      \param airspeed If set, this variable will be set to true if the speed is airspeed, or false if it is ground speed.
+      \returns \ref status_codes
+    */
+    int16_t parseAirborneVelocity(const ADSBFrame* in, float* speed, float* heading, int* verticalRate, bool* airspeed = NULL);
+
+    /*!
+      \brief Get the raw compact position reporting (CPR) values from an airborne position frame.
+      \param in Pointer to ADSBFrame where decoded frame was saved.
+      \param latCpr Pointer to variable where the 17-bit encoded latitude will be saved.
+      \param lonCpr Pointer to variable where the 17-bit encoded longitude will be saved.
+      \param odd Pointer to variable where the CPR format will be saved, true for odd frames.
+      \returns \ref status_codes
+    */
+    static int16_t parseCpr(const ADSBFrame* in, uint32_t* latCpr, uint32_t* lonCpr, bool* odd);
+
+    /*!
+      \brief Globally unambiguous position from a pair of even and odd airborne position frames.
+      The frames should be received no more than 10 seconds apart.
+      \param latCpr Encoded latitudes, even frame first.
+      \param lonCpr Encoded longitudes, even frame first.
+      \param oddLast Whether the odd frame is the more recent one, the position is calculated for that one.
+      \param lat Pointer to variable where the latitude in degrees will be saved.
+      \param lon Pointer to variable where the longitude in degrees will be saved.
+      \returns \ref status_codes
+    */
+    static int16_t decodeCprGlobal(const uint32_t latCpr[2], const uint32_t lonCpr[2], bool oddLast, float* lat, float* lon);
+
+    /*!
+      \brief Position from a single airborne position frame, relative to a reference position within 180 nautical miles.
+      \param refLat Reference latitude in degrees.
+      \param refLon Reference longitude in degrees.
+      \param latCpr Encoded latitude.
+      \param lonCpr Encoded longitude.
+      \param odd Whether this is an odd frame.
+      \param lat Pointer to variable where the latitude in degrees will be saved. Can be set to null to skip saving latitude.
+      \param lon Pointer to variable where the longitude in degrees will be saved. Can be set to null to skip longitude calculation.
+    */
+    static void decodeCprLocal(float refLat, float refLon, uint32_t latCpr, uint32_t lonCpr, bool odd, float* lat, float* lon);
+
+    /*!
+      \brief Get the number of longitude zones at a given latitude (the NL function of CPR).
+      \param lat Latitude in degrees.
+      \returns Number of longitude zones, from 1 to 59.
+    */
+    static int getLonZones(float lat);
   
 #if !RADIOLIB_GODMODE
   private:
@@ -158,6 +269,12 @@ class ADSBClient {
     
     // reference position
     float refPos[2] = { 0, 0 };
+
+    // parity check configuration
+    bool parityCheck = false;
+    uint8_t parityMaxErrors = 1;
+
+    static int findSyndrome(uint32_t syndrome);
 };
 
 #endif
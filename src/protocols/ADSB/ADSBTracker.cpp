@@ -0,0 +1,282 @@
+#include "ADSBTracker.h"
+#include <string.h>
+
+#if !RADIOLIB_EXCLUDE_ADSB
+
+ADSBTracker::ADSBTracker(ADSBClient* client, size_t capacity) {
+  this->client = client;
+
+  // indexes are 16-bit, and the slot table has to stay at most half full
+  #if RADIOLIB_STATIC_ONLY
+  capacity = RADIOLIB_MIN(capacity, (size_t)RADIOLIB_ADSB_TRACKER_MAX_AIRCRAFT);
+  #endif
+  this->capacity = RADIOLIB_MIN(RADIOLIB_MAX(capacity, (size_t)1), (size_t)0x3FFF);
+  uint8_t bits = 1;
+  while((1UL << bits) < 2*this->capacity) {
+    bits++;
+  }
+  this->slotMask = (uint16_t)((1UL << bits) - 1);
+  this->slotShift = 32 - bits;
+
+  #if !RADIOLIB_STATIC_ONLY
+  this->aircraft = new ADSBAircraft_t[this->capacity];
+  this->slots = new uint16_t[this->slotMask + 1];
+  #endif
+  this->clear();
+}
+
+ADSBTracker::ADSBTracker(const ADSBTracker& tracker) : ADSBTracker(tracker.client, tracker.capacity) {
+  *this = tracker;
+}
+
+ADSBTracker& ADSBTracker::operator=(const ADSBTracker& tracker) {
+  if(&tracker == this) {
+    return(*this);
+  }
+
+  // the slot table size follows from the capacity, so both are reallocated only if it differs
+  #if !RADIOLIB_STATIC_ONLY
+  if(this->capacity != tracker.capacity) {
+    delete[] this->aircraft;
+    delete[] this->slots;
+    this->aircraft = new ADSBAircraft_t[tracker.capacity];
+    this->slots = new uint16_t[tracker.slotMask + 1];
+  }
+  #endif
+  this->client = tracker.client;
+  this->capacity = tracker.capacity;
+  this->slotMask = tracker.slotMask;
+  this->slotShift = tracker.slotShift;
+
+  // entries refer to each other by index, so the pool and the list can be copied as they are
+  memcpy(this->aircraft, tracker.aircraft, this->capacity*sizeof(ADSBAircraft_t));
+  memcpy(this->slots, tracker.slots, (this->slotMask + 1)*sizeof(uint16_t));
+  this->numAircraft = tracker.numAircraft;
+  this->head = tracker.head;
+  this->tail = tracker.tail;
+  this->freeList = tracker.freeList;
+  return(*this);
+}
+
+ADSBTracker::~ADSBTracker() {
+  #if !RADIOLIB_STATIC_ONLY
+  delete[] this->aircraft;
+  delete[] this->slots;
+  #endif
+}
+
+int16_t ADSBTracker::update(const ADSBFrame* frame, RadioLibTime_t now, ADSBAircraft_t** aircraft) {
+  RADIOLIB_ASSERT_PTR(frame);
+
+  uint32_t icao = ((uint32_t)frame->icao[0] << 16) | ((uint32_t)frame->icao[1] << 8) | (uint32_t)frame->icao[2];
+  ADSBAircraft_t* ac = this->find(icao);
+  if(!ac) {
+    ac = this->add(icao);
+  } else {
+    // most recently seen aircraft goes to the front, so the one to drop is always at the back
+    uint16_t idx = ac - this->aircraft;
+    this->unlink(idx);
+    this->pushFront(idx);
+  }
+  ac->lastSeen = now;
+  ac->numMessages++;
+  if(aircraft) {
+    *aircraft = ac;
+  }
+
+  int16_t state = RADIOLIB_ERR_NONE;
+  switch(frame->messageType) {
+    case(ADSBMessageType::AIRCRAFT_ID):
+      state = this->client->parseCallsign(frame, ac->callsign, &ac->category);
+      break;
+
+    case(ADSBMessageType::AIRBORNE_POS_ALT_BARO):
+    case(ADSBMessageType::AIRBORNE_POS_ALT_GNSS):
+      state = this->client->parseAirbornePosition(frame, &ac->altitude, NULL, NULL, &ac->altGnss);
+      RADIOLIB_ASSERT(state);
+      this->updatePosition(ac, frame, now);
+      break;
+
+    case(ADSBMessageType::AIRBORNE_VEL): {
+      float speed = 0;
+      float heading = 0;
+      int verticalRate = 0;
+      bool airspeed = false;
+      state = this->client->parseAirborneVelocity(frame, &speed, &heading, &verticalRate, &airspeed);
+      RADIOLIB_ASSERT(state);
+      ac->speed = speed;
+      ac->heading = heading;
+      ac->verticalRate = verticalRate;
+      ac->airspeed = airspeed;
+      ac->velValid = true;
+    } break;
+
+    default:
+      break;
+  }
+
+  return(state);
+}
+
+ADSBAircraft_t* ADSBTracker::find(uint32_t icao) {
+  uint16_t slot = this->findSlot(icao);
+  if(this->slots[slot] == RADIOLIB_ADSB_TRACKER_NONE) {
+    return(NULL);
+  }
+  return(&this->aircraft[this->slots[slot]]);
+}
+
+size_t ADSBTracker::expire(RadioLibTime_t now, RadioLibTime_t timeout) {
+  size_t num = 0;
+  while((this->tail != RADIOLIB_ADSB_TRACKER_NONE) && (now - this->aircraft[this->tail].lastSeen > timeout)) {
+    this->remove(this->tail);
+    num++;
+  }
+  return(num);
+}
+
+void ADSBTracker::clear() {
+  for(size_t i = 0; i <= this->slotMask; i++) {
+    this->slots[i] = RADIOLIB_ADSB_TRACKER_NONE;
+  }
+  for(size_t i = 0; i < this->capacity; i++) {
+    this->aircraft[i].next = (i + 1 < this->capacity) ? i + 1 : RADIOLIB_ADSB_TRACKER_NONE;
+  }
+  this->freeList = 0;
+  this->head = RADIOLIB_ADSB_TRACKER_NONE;
+  this->tail = RADIOLIB_ADSB_TRACKER_NONE;
+  this->numAircraft = 0;
+}
+
+size_t ADSBTracker::getNumAircraft() const {
+  return(this->numAircraft);
+}
+
+ADSBAircraft_t* ADSBTracker::first() {
+  if(this->head == RADIOLIB_ADSB_TRACKER_NONE) {
+    return(NULL);
+  }
+  return(&this->aircraft[this->head]);
+}
+
+ADSBAircraft_t* ADSBTracker::next(const ADSBAircraft_t* aircraft) {
+  if(!aircraft || (aircraft->next == RADIOLIB_ADSB_TRACKER_NONE)) {
+    return(NULL);
+  }
+  return(&this->aircraft[aircraft->next]);
+}
+
+uint16_t ADSBTracker::getHomeSlot(uint32_t icao) const {
+  // multiplicative hash, ICAO addresses are often allocated in blocks
+  return((uint16_t)((uint32_t)(icao * 2654435761UL) >> this->slotShift));
+}
+
+uint16_t ADSBTracker::findSlot(uint32_t icao) {
+  // linear probing, ends at the aircraft or at the empty slot where it would be
+  uint16_t slot = this->getHomeSlot(icao);
+  while((this->slots[slot] != RADIOLIB_ADSB_TRACKER_NONE) && (this->aircraft[this->slots[slot]].icao != icao)) {
+    slot = (slot + 1) & this->slotMask;
+  }
+  return(slot);
+}
+
+ADSBAircraft_t* ADSBTracker::add(uint32_t icao) {
+  if(this->freeList == RADIOLIB_ADSB_TRACKER_NONE) {
+    this->remove(this->tail);
+  }
+
+  uint16_t idx = this->freeList;
+  ADSBAircraft_t* ac = &this->aircraft[idx];
+  this->freeList = ac->next;
+  memset(ac, 0, sizeof(ADSBAircraft_t));
+  ac->icao = icao;
+  this->slots[this->findSlot(icao)] = idx;
+  this->pushFront(idx);
+  this->numAircraft++;
+  return(ac);
+}
+
+void ADSBTracker::remove(uint16_t idx) {
+  // backward shift deletion, moves later entries of the same probe run into the gap
+  uint16_t gap = this->findSlot(this->aircraft[idx].icao);
+  uint16_t slot = gap;
+  while(true) {
+    slot = (slot + 1) & this->slotMask;
+    if(this->slots[slot] == RADIOLIB_ADSB_TRACKER_NONE) {
+      break;
+    }
+    uint16_t home = this->getHomeSlot(this->aircraft[this->slots[slot]].icao);
+    if(((slot - home) & this->slotMask) >= ((slot - gap) & this->slotMask)) {
+      this->slots[gap] = this->slots[slot];
+      gap = slot;
+    }
+  }
+  this->slots[gap] = RADIOLIB_ADSB_TRACKER_NONE;
+
+  this->unlink(idx);
+  this->aircraft[idx].next = this->freeList;
+  this->freeList = idx;
+  this->numAircraft--;
+}
+
+void ADSBTracker::unlink(uint16_t idx) {
+  ADSBAircraft_t* ac = &this->aircraft[idx];
+  if(ac->prev != RADIOLIB_ADSB_TRACKER_NONE) {
+    this->aircraft[ac->prev].next = ac->next;
+  } else {
+    this->head = ac->next;
+  }
+  if(ac->next != RADIOLIB_ADSB_TRACKER_NONE) {
+    this->aircraft[ac->next].prev = ac->prev;
+  } else {
+    this->tail = ac->prev;
+  }
+}
+
+void ADSBTracker::pushFront(uint16_t idx) {
+  ADSBAircraft_t* ac = &this->aircraft[idx];
+  ac->prev = RADIOLIB_ADSB_TRACKER_NONE;
+  ac->next = this->head;
+  if(this->head != RADIOLIB_ADSB_TRACKER_NONE) {
+    this->aircraft[this->head].prev = idx;
+  } else {
+    this->tail = idx;
+  }
+  this->head = idx;
+}
+
+void ADSBTracker::updatePosition(ADSBAircraft_t* ac, const ADSBFrame* frame, RadioLibTime_t now) {
+  uint32_t latCpr = 0;
+  uint32_t lonCpr = 0;
+  bool odd = false;
+  if(ADSBClient::parseCpr(frame, &latCpr, &lonCpr, &odd) != RADIOLIB_ERR_NONE) {
+    return;
+  }
+  ac->cprLat[odd] = latCpr;
+  ac->cprLon[odd] = lonCpr;
+  ac->cprTime[odd] = now;
+  ac->cprValid[odd] = true;
+
+  // recent pair of even and odd frames gives unambiguous position
+  float lat = 0;
+  float lon = 0;
+  if(ac->cprValid[!odd] && (now - ac->cprTime[!odd] <= RADIOLIB_ADSB_TRACKER_CPR_PAIR_MS)) {
+    if(ADSBClient::decodeCprGlobal(ac->cprLat, ac->cprLon, odd, &lat, &lon) == RADIOLIB_ERR_NONE) {
+      ac->lat = lat;
+      ac->lon = lon;
+      ac->posValid = true;
+      ac->posTime = now;
+      return;
+    }
+  }
+
+  // otherwise a single frame is enough, as long as the aircraft could not have moved far since the last fix
+  if(ac->posValid && (now - ac->posTime <= RADIOLIB_ADSB_TRACKER_CPR_LOCAL_MS)) {
+    ADSBClient::decodeCprLocal(ac->lat, ac->lon, latCpr, lonCpr, odd, &lat, &lon);
+    ac->lat = lat;
+    ac->lon = lon;
+    ac->posTime = now;
+  }
+}
+
+#endif
@@ -0,0 +1,211 @@
+#if !defined(_RADIOLIB_ADSB_TRACKER_H) && !RADIOLIB_EXCLUDE_ADSB
+#define _RADIOLIB_ADSB_TRACKER_H
+
+#include "../../TypeDef.h"
+#include "ADSB.h"
+
+// maximum number of tracked aircraft, this is the fixed memory budget when using static memory only
+#if !defined(RADIOLIB_ADSB_TRACKER_MAX_AIRCRAFT)
+  #define RADIOLIB_ADSB_TRACKER_MAX_AIRCRAFT                    (32)
+#endif
+
+// default time after which an aircraft that was not heard is dropped by expire()
+#if !defined(RADIOLIB_ADSB_TRACKER_TIMEOUT_MS)
+  #define RADIOLIB_ADSB_TRACKER_TIMEOUT_MS                      (60000UL)
+#endif
+
+// maximum age difference of an even and odd position frame to be used for global position decoding
+#define RADIOLIB_ADSB_TRACKER_CPR_PAIR_MS                       (10000UL)
+
+// maximum age of the last known position to be used as reference for local position decoding
+#define RADIOLIB_ADSB_TRACKER_CPR_LOCAL_MS                      (60000UL)
+
+// index of an unused entry or slot
+#define RADIOLIB_ADSB_TRACKER_NONE                              (0xFFFF)
+
+/*!
+  \struct ADSBAircraft_t
+  \brief Everything that is known about a single tracked aircraft.
+*/
+struct ADSBAircraft_t {
+  /*! \brief Transponder ICAO address. */
+  uint32_t icao;
+
+  /*! \brief Callsign as null-terminated string, empty until identification was received. */
+  char callsign[RADIOLIB_ADSB_CALLSIGN_LEN];
+
+  /*! \brief Aircraft category, from the identification message. */
+  ADSBAircraftCategory category;
+
+  /*! \brief Latitude in degrees, valid only when posValid is set. */
+  float lat;
+
+  /*! \brief Longitude in degrees, valid only when posValid is set. */
+  float lon;
+
+  /*! \brief Whether the position is known. */
+  bool posValid;
+
+  /*! \brief Timestamp of the last position update. */
+  RadioLibTime_t posTime;
+
+  /*! \brief Altitude, in feet for barometric altitude, in meters for GNSS altitude. */
+  int altitude;
+
+  /*! \brief Whether the altitude source is GNSS. */
+  bool altGnss;
+
+  /*! \brief Speed in knots, valid only when velValid is set. */
+  float speed;
+
+  /*! \brief Track or heading in degrees, valid only when velValid is set. */
+  float heading;
+
+  /*! \brief Vertical rate in feet per minute, valid only when velValid is set. */
+  int verticalRate;
+
+  /*! \brief Whether the speed is airspeed, otherwise it is ground speed. */
+  bool airspeed;
+
+  /*! \brief Whether the velocity is known. */
+  bool velValid;
+
+  /*! \brief Timestamp of the last received frame. */
+  RadioLibTime_t lastSeen;
+
+  /*! \brief Number of received frames. */
+  uint32_t numMessages;
+
+  /*! \brief Encoded latitudes of the last even and odd position frames. */
+  uint32_t cprLat[2];
+
+  /*! \brief Encoded longitudes of the last even and odd position frames. */
+  uint32_t cprLon[2];
+
+  /*! \brief Timestamps of the last even and odd position frames. */
+  RadioLibTime_t cprTime[2];
+
+  /*! \brief Whether the even and odd position frames were received. */
+  bool cprValid[2];
+
+  /*! \brief Links of the least-recently-seen list, used internally. */
+  uint16_t prev, next;
+};
+
+/*!
+  \class ADSBTracker
+  \brief Table of aircraft in range, updated from decoded ADS-B frames.
+  Aircraft are kept in a fixed-size pool and looked up by ICAO address in an open-addressing hash table,
+  so an update takes constant time regardless of how many aircraft are tracked.
+  When the table is full, the aircraft that was not heard for the longest time is dropped.
+  Position is decoded globally from a pair of even and odd frames, then locally from the last known position,
+  so no reference position is needed.
+*/
+class ADSBTracker {
+  public:
+    /*!
+      \brief Default constructor.
+      \param client Pointer to the ADS-B client used to parse frames.
+      \param capacity Maximum number of tracked aircraft. When using static memory only,
+      this is limited to RADIOLIB_ADSB_TRACKER_MAX_AIRCRAFT.
+    */
+    explicit ADSBTracker(ADSBClient* client, size_t capacity = RADIOLIB_ADSB_TRACKER_MAX_AIRCRAFT);
+
+    /*!
+      \brief Copy constructor.
+      \param tracker ADSBTracker instance to copy.
+    */
+    ADSBTracker(const ADSBTracker& tracker);
+
+    /*!
+      \brief Overload for assignment operator.
+      \param tracker rvalue ADSBTracker.
+    */
+    ADSBTracker& operator=(const ADSBTracker& tracker);
+
+    /*!
+      \brief Default destructor.
+    */
+    ~ADSBTracker();
+
+    /*!
+      \brief Update the table from a decoded frame.
+      \param frame Pointer to ADSBFrame where decoded frame was saved.
+      \param now Current timestamp, typically in milliseconds. Must use the same units as timeouts.
+      \param aircraft If set, pointer to the updated aircraft will be saved here.
+      \returns \ref status_codes
+    */
+    int16_t update(const ADSBFrame* frame, RadioLibTime_t now, ADSBAircraft_t** aircraft = NULL);
+
+    /*!
+      \brief Find an aircraft by its ICAO address.
+      \param icao Transponder ICAO address.
+      \returns Pointer to the aircraft, or null if it is not tracked.
+    */
+    ADSBAircraft_t* find(uint32_t icao);
+
+    /*!
+      \brief Drop aircraft that were not heard for some time.
+      \param now Current timestamp.
+      \param timeout Time after which an aircraft is dropped.
+      \returns Number of dropped aircraft.
+    */
+    size_t expire(RadioLibTime_t now, RadioLibTime_t timeout = RADIOLIB_ADSB_TRACKER_TIMEOUT_MS);
+
+    /*!
+      \brief Drop all aircraft.
+    */
+    void clear();
+
+    /*!
+      \brief Get the number of tracked aircraft.
+      \returns Number of tracked aircraft.
+    */
+    size_t getNumAircraft() const;
+
+    /*!
+      \brief Get the most recently seen aircraft, to iterate over the table together with next().
+      \returns Pointer to the aircraft, or null if the table is empty.
+    */
+    ADSBAircraft_t* first();
+
+    /*!
+      \brief Get the next aircraft, ordered from the most recently seen one.
+      \param aircraft Pointer to the current aircraft.
+      \returns Pointer to the next aircraft, or null at the end of the table.
+    */
+    ADSBAircraft_t* next(const ADSBAircraft_t* aircraft);
+
+#if !RADIOLIB_GODMODE
+  private:
+#endif
+    ADSBClient* client;
+
+    // aircraft pool, hash slots with indexes into the pool
+    size_t capacity = 0;
+    size_t numAircraft = 0;
+    uint16_t slotMask = 0;
+    uint8_t slotShift = 0;
+    #if RADIOLIB_STATIC_ONLY
+    ADSBAircraft_t aircraft[RADIOLIB_ADSB_TRACKER_MAX_AIRCRAFT];
+    uint16_t slots[4*RADIOLIB_ADSB_TRACKER_MAX_AIRCRAFT];
+    #else
+    ADSBAircraft_t* aircraft = NULL;
+    uint16_t* slots = NULL;
+    #endif
+
+    // least-recently-seen list and unused entries
+    uint16_t head = RADIOLIB_ADSB_TRACKER_NONE;
+    uint16_t tail = RADIOLIB_ADSB_TRACKER_NONE;
+    uint16_t freeList = RADIOLIB_ADSB_TRACKER_NONE;
+
+    uint16_t findSlot(uint32_t icao);
+    uint16_t getHomeSlot(uint32_t icao) const;
+    ADSBAircraft_t* add(uint32_t icao);
+    void remove(uint16_t idx);
+    void unlink(uint16_t idx);
+    void pushFront(uint16_t idx);
+    void updatePosition(ADSBAircraft_t* ac, const ADSBFrame* frame, RadioLibTime_t now);
+};
+
+#endif
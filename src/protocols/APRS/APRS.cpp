@@ -2,6 +2,7 @@
 #include <string.h>
 #include <stdio.h>
 #include <ctype.h>
+#include <math.h>
 #if !RADIOLIB_EXCLUDE_APRS
 
 APRSClient::APRSClient(AX25Client* ax) {
@@ -142,7 +143,7 @@ int16_t APRSClient::sendMicE(float lat, float lon, uint16_t heading, uint16_t sp
   if(type & 0x02) { destCallsign[1] += RADIOLIB_APRS_MIC_E_DEST_BIT_OFFSET; }
   if(type & 0x01) { destCallsign[2] += RADIOLIB_APRS_MIC_E_DEST_BIT_OFFSET; }
   if(lat >= 0) { destCallsign[3] += RADIOLIB_APRS_MIC_E_DEST_BIT_OFFSET; }
-  if(lon >= 100 || lon <= -100) { destCallsign[4] += RADIOLIB_APRS_MIC_E_DEST_BIT_OFFSET; }
+  if(RADIOLIB_ABS(lon) >= 100 || RADIOLIB_ABS(lon) < 10) { destCallsign[4] += RADIOLIB_APRS_MIC_E_DEST_BIT_OFFSET; }
   if(lon < 0) { destCallsign[5] += RADIOLIB_APRS_MIC_E_DEST_BIT_OFFSET; }
   destCallsign[6] = '\0';
 
@@ -191,7 +192,7 @@ int16_t APRSClient::sendMicE(float lat, float lon, uint16_t heading, uint16_t sp
   if(speed <= 199) {
     info[infoPos++] = speed_hun_ten + 'l';
   } else {
-    info[infoPos++] = speed_hun_ten + '0';
+    info[infoPos++] = speed_hun_ten + 28;
   }
 
   info[infoPos++] = speed_uni*10 + head_hun + 32;
@@ -294,4 +295,446 @@ void APRSClient::dropRepeaters() {
   this->numReps = 0;
 }
 
+int16_t APRSClient::decode(const AX25Frame* frame, APRSPacket_t* packet) {
+  if(!frame || !packet) {
+    return(RADIOLIB_ERR_NULL_POINTER);
+  }
+  return(APRSClient::decodeInfo(reinterpret_cast<const char*>(frame->info), frame->info ? frame->infoLen : 0,
+                                frame->destCallsign, strlen(frame->destCallsign), packet));
+}
+
+int16_t APRSClient::decode(const uint8_t* data, size_t len, APRSPacket_t* packet) {
+  if(!data || !packet) {
+    return(RADIOLIB_ERR_NULL_POINTER);
+  }
+
+  // skip the header, if it is there
+  const char* ptr = reinterpret_cast<const char*>(data);
+  if((len >= RADIOLIB_APRS_LORA_HEADER_LEN) && (memcmp(ptr, RADIOLIB_APRS_LORA_HEADER, RADIOLIB_APRS_LORA_HEADER_LEN) == 0)) {
+    ptr += RADIOLIB_APRS_LORA_HEADER_LEN;
+    len -= RADIOLIB_APRS_LORA_HEADER_LEN;
+  }
+
+  // "SRC>DEST,PATH:info"
+  const char* src = ptr;
+  const char* dest = reinterpret_cast<const char*>(memchr(ptr, '>', len));
+  const char* info = reinterpret_cast<const char*>(memchr(ptr, ':', len));
+  if(!dest || !info || (info < dest)) {
+    memset(packet, 0, sizeof(APRSPacket_t));
+    return(RADIOLIB_ERR_APRS_MALFORMED_PACKET);
+  }
+  dest++;
+  info++;
+
+  // destination without path and SSID, Mic-E needs just the callsign
+  size_t destLen = info - 1 - dest;
+  const char* end = reinterpret_cast<const char*>(memchr(dest, ',', destLen));
+  if(end) {
+    destLen = end - dest;
+  }
+  end = reinterpret_cast<const char*>(memchr(dest, '-', destLen));
+  if(end) {
+    destLen = end - dest;
+  }
+
+  int16_t state = APRSClient::decodeInfo(info, len - (info - ptr), dest, destLen, packet);
+  packet->src = src;
+  packet->srcLen = dest - 1 - src;
+  return(state);
+}
+
+int16_t APRSClient::decodeInfo(const char* info, size_t len, const char* dest, size_t destLen, APRSPacket_t* packet) {
+  memset(packet, 0, sizeof(APRSPacket_t));
+  if(!info || (len == 0)) {
+    return(RADIOLIB_ERR_APRS_MALFORMED_PACKET);
+  }
+
+  // everything after the data type is text, until decoded otherwise
+  char type = info[0];
+  packet->type = type;
+  packet->text = &info[1];
+  packet->textLen = len - 1;
+
+  if((type == RADIOLIB_APRS_DATA_TYPE_POSITION_NO_TIME_NO_MSG[0]) || (type == RADIOLIB_APRS_DATA_TYPE_POSITION_NO_TIME_MSG[0]) ||
+     (type == RADIOLIB_APRS_DATA_TYPE_POSITION_TIME_NO_MSG[0]) || (type == RADIOLIB_APRS_DATA_TYPE_POSITION_TIME_MSG[0])) {
+    return(APRSClient::decodePosition(info, len, packet));
+  
+  } else if((type == RADIOLIB_APRS_MIC_E_GPS_DATA_CURRENT) || (type == RADIOLIB_APRS_MIC_E_GPS_DATA_OLD) ||
+            (type == RADIOLIB_APRS_MIC_E_GPS_DATA_CURRENT_REV0) || (type == RADIOLIB_APRS_MIC_E_GPS_DATA_OLD_REV0)) {
+    return(APRSClient::decodeMicE(info, len, dest, destLen, packet));
+  
+  } else if(type == RADIOLIB_APRS_DATA_TYPE_MSG[0]) {
+    return(APRSClient::decodeMessage(info, len, packet));
+  
+  } else if(type == RADIOLIB_APRS_DATA_TYPE_TELEMETRY[0]) {
+    return(APRSClient::decodeTelemetry(info, len, packet));
+  
+  } else if(type == RADIOLIB_APRS_DATA_TYPE_STATUS[0]) {
+    // status is just text
+    return(RADIOLIB_ERR_NONE);
+  
+  }
+
+  return(RADIOLIB_ERR_APRS_UNSUPPORTED_TYPE);
+}
+
+int16_t APRSClient::decodePosition(const char* info, size_t len, APRSPacket_t* packet) {
+  const char* ptr = &info[1];
+  const char* end = info + len;
+  packet->messaging = (info[0] == RADIOLIB_APRS_DATA_TYPE_POSITION_NO_TIME_MSG[0]) || (info[0] == RADIOLIB_APRS_DATA_TYPE_POSITION_TIME_MSG[0]);
+
+  // timestamp is kept as it was sent, it can be in several formats
+  if((info[0] == RADIOLIB_APRS_DATA_TYPE_POSITION_TIME_NO_MSG[0]) || (info[0] == RADIOLIB_APRS_DATA_TYPE_POSITION_TIME_MSG[0])) {
+    if(end - ptr < RADIOLIB_APRS_TIMESTAMP_LEN) {
+      return(RADIOLIB_ERR_APRS_MALFORMED_PACKET);
+    }
+    packet->timestamp = ptr;
+    packet->fields |= RADIOLIB_APRS_FIELD_TIMESTAMP;
+    ptr += RADIOLIB_APRS_TIMESTAMP_LEN;
+  }
+
+  if(ptr >= end) {
+    return(RADIOLIB_ERR_APRS_MALFORMED_PACKET);
+  }
+
+  // uncompressed position starts with a digit (or a space when the position is ambiguous), compressed one with the symbol table
+  if(isdigit(ptr[0]) || (ptr[0] == ' ')) {
+    // "DDMM.hhN/DDDMM.hhW$"
+    uint32_t latDeg = 0, latMin = 0, latHun = 0, lonDeg = 0, lonMin = 0, lonHun = 0;
+    if((end - ptr < RADIOLIB_APRS_POSITION_LEN) || (ptr[4] != '.') || (ptr[14] != '.') ||
+       !APRSClient::parseDigits(&ptr[0], 2, &latDeg) || !APRSClient::parseDigits(&ptr[2], 2, &latMin) || !APRSClient::parseDigits(&ptr[5], 2, &latHun) ||
+       !APRSClient::parseDigits(&ptr[9], 3, &lonDeg) || !APRSClient::parseDigits(&ptr[12], 2, &lonMin) || !APRSClient::parseDigits(&ptr[15], 2, &lonHun)) {
+      return(RADIOLIB_ERR_APRS_MALFORMED_PACKET);
+    }
+    packet->lat = (float)latDeg + ((float)latMin + (float)latHun / 100.0f) / 60.0f;
+    packet->lon = (float)lonDeg + ((float)lonMin + (float)lonHun / 100.0f) / 60.0f;
+    if(ptr[7] == 'S') {
+      packet->lat = -packet->lat;
+    }
+    if(ptr[17] == 'W') {
+      packet->lon = -packet->lon;
+    }
+    packet->table = ptr[8];
+    packet->symbol = ptr[18];
+    ptr += RADIOLIB_APRS_POSITION_LEN;
+
+    // optional course and speed, "CSE/SPD"
+    uint32_t course = 0, speed = 0;
+    if((end - ptr >= 7) && (ptr[3] == '/') && APRSClient::parseDigits(&ptr[0], 3, &course) && APRSClient::parseDigits(&ptr[4], 3, &speed)) {
+      packet->course = course;
+      packet->speed = speed;
+      packet->fields |= RADIOLIB_APRS_FIELD_COURSE_SPEED;
+      ptr += 7;
+    }
+
+  } else {
+    // "/YYYYXXXX$csT", all values in base 91
+    if(end - ptr < RADIOLIB_APRS_POSITION_COMPRESSED_LEN) {
+      return(RADIOLIB_ERR_APRS_MALFORMED_PACKET);
+    }
+    uint32_t lat = 0;
+    uint32_t lon = 0;
+    for(uint8_t i = 0; i < 4; i++) {
+      if((ptr[1 + i] < '!') || (ptr[1 + i] > '{') || (ptr[5 + i] < '!') || (ptr[5 + i] > '{')) {
+        return(RADIOLIB_ERR_APRS_MALFORMED_PACKET);
+      }
+      lat = lat*91 + (ptr[1 + i] - 33);
+      lon = lon*91 + (ptr[5 + i] - 33);
+    }
+    packet->lat = 90.0f - (float)lat / 380926.0f;
+    packet->lon = -180.0f + (float)lon / 190463.0f;
+    packet->table = ptr[0];
+    packet->symbol = ptr[9];
+
+    // the "cs" bytes are either altitude, or course and speed, depending on the compression type byte
+    char c = ptr[10];
+    char s = ptr[11];
+    uint8_t t = ptr[12] - 33;
+    if((c != ' ') && (s >= '!') && (s <= '{')) {
+      if((t & 0x18) == 0x10) {
+        // altitude is in feet
+        packet->altitude = powf(1.002f, (float)((c - 33)*91 + (s - 33))) * 0.3048f;
+        packet->fields |= RADIOLIB_APRS_FIELD_ALTITUDE;
+      } else if((c >= '!') && (c <= 'z')) {
+        packet->course = (c - 33)*4;
+        packet->speed = powf(1.08f, (float)(s - 33)) - 1.0f;
+        packet->fields |= RADIOLIB_APRS_FIELD_COURSE_SPEED;
+      }
+    }
+    ptr += RADIOLIB_APRS_POSITION_COMPRESSED_LEN;
+  }
+  packet->fields |= RADIOLIB_APRS_FIELD_POSITION;
+  packet->text = ptr;
+  packet->textLen = end - ptr;
+
+  // altitude in the comment, "/A=aaaaaa" in feet
+  for(const char* alt = ptr; end - alt >= 9; alt++) {
+    alt = reinterpret_cast<const char*>(memchr(alt, '/', end - alt - 8));
+    if(!alt) {
+      break;
+    }
+    float val = 0;
+    if((alt[1] == 'A') && (alt[2] == '=') && APRSClient::parseNumber(&alt[3], 6, &val)) {
+      packet->altitude = val * 0.3048f;
+      packet->fields |= RADIOLIB_APRS_FIELD_ALTITUDE;
+      break;
+    }
+  }
+
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t APRSClient::decodeMicE(const char* info, size_t len, const char* dest, size_t destLen, APRSPacket_t* packet) {
+  if((destLen < RADIOLIB_APRS_MIC_E_DEST_LEN) || (len < RADIOLIB_APRS_MIC_E_INFO_LEN)) {
+    return(RADIOLIB_ERR_APRS_MALFORMED_PACKET);
+  }
+
+  // destination "callsign" holds the latitude digits, each with one extra bit
+  uint8_t digits[RADIOLIB_APRS_MIC_E_DEST_LEN];
+  uint8_t bits = 0;
+  for(uint8_t i = 0; i < RADIOLIB_APRS_MIC_E_DEST_LEN; i++) {
+    char c = dest[i];
+    uint8_t bit = 1;
+    if((c >= '0') && (c <= '9')) {
+      digits[i] = c - '0';
+      bit = 0;
+    } else if((c >= 'A') && (c <= 'J')) {
+      // custom message bits, decoded the same as the standard ones
+      digits[i] = c - 'A';
+    } else if((c >= 'P') && (c <= 'Y')) {
+      digits[i] = c - 'P';
+    } else if((c == 'K') || (c == 'Z')) {
+      // ambiguous digit
+      digits[i] = 0;
+    } else if(c == 'L') {
+      digits[i] = 0;
+      bit = 0;
+    } else {
+      return(RADIOLIB_ERR_APRS_MALFORMED_PACKET);
+    }
+    bits |= bit << i;
+  }
+  packet->micEType = ((bits & 0x01) << 2) | (bits & 0x02) | ((bits & 0x04) >> 2);
+  packet->lat = (float)(digits[0]*10 + digits[1]) + ((float)(digits[2]*10 + digits[3]) + (float)(digits[4]*10 + digits[5]) / 100.0f) / 60.0f;
+  if(!(bits & 0x08)) {
+    packet->lat = -packet->lat;
+  }
+
+  // longitude, reverse of the tables in sendMicE
+  int16_t lonDeg = info[1] - 28;
+  if(bits & 0x10) {
+    lonDeg += 100;
+  }
+  if((lonDeg >= 180) && (lonDeg <= 189)) {
+    lonDeg -= 80;
+  } else if((lonDeg >= 190) && (lonDeg <= 199)) {
+    lonDeg -= 190;
+  }
+  int16_t lonMin = info[2] - 28;
+  if(lonMin >= 60) {
+    lonMin -= 60;
+  }
+  int16_t lonHun = info[3] - 28;
+  packet->lon = (float)lonDeg + ((float)lonMin + (float)lonHun / 100.0f) / 60.0f;
+  if(bits & 0x20) {
+    packet->lon = -packet->lon;
+  }
+
+  // speed and course share the middle byte
+  int16_t sp = info[4] - 28;
+  int16_t dc = info[5] - 28;
+  int16_t se = info[6] - 28;
+  int16_t speed = sp*10 + dc/10;
+  if(speed >= 800) {
+    speed -= 800;
+  }
+  int16_t course = (dc % 10)*100 + se;
+  if(course >= 400) {
+    course -= 400;
+  }
+  packet->speed = speed;
+  packet->course = course;
+  packet->symbol = info[7];
+  packet->table = info[8];
+  packet->fields |= RADIOLIB_APRS_FIELD_POSITION | RADIOLIB_APRS_FIELD_COURSE_SPEED | RADIOLIB_APRS_FIELD_MIC_E;
+
+  const char* ptr = &info[RADIOLIB_APRS_MIC_E_INFO_LEN];
+  const char* end = info + len;
+  packet->text = ptr;
+  packet->textLen = end - ptr;
+
+  // telemetry, as sent by sendMicE
+  if((ptr < end) && ((ptr[0] == RADIOLIB_APRS_MIC_E_TELEMETRY_LEN_2) || (ptr[0] == RADIOLIB_APRS_MIC_E_TELEMETRY_LEN_5))) {
+    uint8_t num = (ptr[0] == RADIOLIB_APRS_MIC_E_TELEMETRY_LEN_2) ? 2 : 5;
+    bool valid = (end - ptr) >= 1 + 2*num;
+    for(uint8_t i = 0; valid && (i < 2*num); i++) {
+      valid = isxdigit(ptr[1 + i]);
+    }
+    if(valid) {
+      for(uint8_t i = 0; i < num; i++) {
+        uint8_t val = 0;
+        for(uint8_t j = 1; j <= 2; j++) {
+          char c = toupper(ptr[2*i + j]);
+          val = val*16 + (isdigit(c) ? (c - '0') : (c - 'A' + 10));
+        }
+        packet->telemAnalog[i] = val;
+      }
+      packet->telemNumAnalog = num;
+      packet->telemSeq = -1;
+      packet->fields |= RADIOLIB_APRS_FIELD_TELEMETRY;
+      packet->text += 1 + 2*num;
+      packet->textLen -= 1 + 2*num;
+      return(RADIOLIB_ERR_NONE);
+    }
+  }
+
+  // altitude "xxx}" in base 91, offset by -10 km, either at the start of the status or at its end as sent by sendMicE
+  const char* alt = NULL;
+  if((packet->textLen >= 4) && (ptr[3] == '}')) {
+    alt = ptr;
+    packet->text += 4;
+    packet->textLen -= 4;
+  } else if((packet->textLen >= 4) && (end[-1] == '}')) {
+    alt = end - 4;
+    packet->textLen -= 4;
+  }
+  if(alt && (alt[0] >= '!') && (alt[0] <= '{') && (alt[1] >= '!') && (alt[1] <= '{') && (alt[2] >= '!') && (alt[2] <= '{')) {
+    packet->altitude = (int32_t)((alt[0] - 33)*8281 + (alt[1] - 33)*91 + (alt[2] - 33)) - 10000;
+    packet->fields |= RADIOLIB_APRS_FIELD_ALTITUDE;
+  } else if(alt) {
+    // not an altitude after all
+    packet->text = ptr;
+    packet->textLen = end - ptr;
+  }
+
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t APRSClient::decodeMessage(const char* info, size_t len, APRSPacket_t* packet) {
+  // ":ADDRESSEE:text{id"
+  if((len < 2 + RADIOLIB_APRS_MSG_ADDRESSEE_LEN) || (info[1 + RADIOLIB_APRS_MSG_ADDRESSEE_LEN] != ':')) {
+    return(RADIOLIB_ERR_APRS_MALFORMED_PACKET);
+  }
+  packet->addressee = &info[1];
+  packet->addresseeLen = RADIOLIB_APRS_MSG_ADDRESSEE_LEN;
+  while((packet->addresseeLen > 0) && (packet->addressee[packet->addresseeLen - 1] == ' ')) {
+    packet->addresseeLen--;
+  }
+  packet->text = &info[2 + RADIOLIB_APRS_MSG_ADDRESSEE_LEN];
+  packet->textLen = len - (2 + RADIOLIB_APRS_MSG_ADDRESSEE_LEN);
+  packet->fields |= RADIOLIB_APRS_FIELD_MESSAGE;
+
+  // message ID is up to 5 characters at the end
+  for(size_t i = 1; (i <= 6) && (i <= packet->textLen); i++) {
+    if(packet->text[packet->textLen - i] == '{') {
+      packet->msgId = &packet->text[packet->textLen - i + 1];
+      packet->msgIdLen = i - 1;
+      packet->textLen -= i;
+      break;
+    }
+  }
+
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t APRSClient::decodeTelemetry(const char* info, size_t len, APRSPacket_t* packet) {
+  // "T#sss,aaa,aaa,aaa,aaa,aaa,bbbbbbbb"
+  if((len < 2) || (info[1] != '#')) {
+    return(RADIOLIB_ERR_APRS_MALFORMED_PACKET);
+  }
+  const char* ptr = &info[2];
+  const char* end = info + len;
+  packet->telemSeq = -1;
+  packet->textLen = 0;
+  for(uint8_t field = 0; ptr < end; field++) {
+    const char* sep = reinterpret_cast<const char*>(memchr(ptr, ',', end - ptr));
+    size_t fieldLen = sep ? (size_t)(sep - ptr) : (size_t)(end - ptr);
+    float val = 0;
+    if(field == 0) {
+      // sequence number may also be something else, e.g. "MIC"
+      if(APRSClient::parseNumber(ptr, fieldLen, &val)) {
+        packet->telemSeq = (int16_t)val;
+      }
+
+    } else if(field <= RADIOLIB_APRS_TELEMETRY_NUM_ANALOG) {
+      if(!APRSClient::parseNumber(ptr, fieldLen, &val)) {
+        return(RADIOLIB_ERR_APRS_MALFORMED_PACKET);
+      }
+      packet->telemAnalog[packet->telemNumAnalog++] = val;
+
+    } else {
+      // digital bits, anything after them is comment
+      if(end - ptr < 8) {
+        return(RADIOLIB_ERR_APRS_MALFORMED_PACKET);
+      }
+      for(uint8_t i = 0; i < 8; i++) {
+        if((ptr[i] != '0') && (ptr[i] != '1')) {
+          return(RADIOLIB_ERR_APRS_MALFORMED_PACKET);
+        }
+        packet->telemDigital = (packet->telemDigital << 1) | (ptr[i] - '0');
+      }
+      packet->text = &ptr[8];
+      packet->textLen = end - &ptr[8];
+      break;
+
+    }
+    ptr += fieldLen + 1;
+  }
+
+  if(packet->telemNumAnalog == 0) {
+    return(RADIOLIB_ERR_APRS_MALFORMED_PACKET);
+  }
+  packet->fields |= RADIOLIB_APRS_FIELD_TELEMETRY;
+  return(RADIOLIB_ERR_NONE);
+}
+
+bool APRSClient::parseNumber(const char* str, size_t len, float* val) {
+  size_t i = 0;
+  bool negative = false;
+  if((len > 0) && (str[0] == '-')) {
+    negative = true;
+    i++;
+  }
+
+  float num = 0;
+  float scale = 0;
+  bool digits = false;
+  for(; i < len; i++) {
+    if(isdigit(str[i])) {
+      num = num*10.0f + (float)(str[i] - '0');
+      scale *= 10.0f;
+      digits = true;
+    } else if((str[i] == '.') && (scale == 0)) {
+      scale = 1.0f;
+    } else {
+      return(false);
+    }
+  }
+  if(!digits) {
+    return(false);
+  }
+
+  if(scale > 0) {
+    num /= scale;
+  }
+  *val = negative ? -num : num;
+  return(true);
+}
+
+bool APRSClient::parseDigits(const char* str, size_t len, uint32_t* val) {
+  // spaces are used to reduce position precision, those are taken as zero
+  uint32_t num = 0;
+  for(size_t i = 0; i < len; i++) {
+    if(isdigit(str[i])) {
+      num = num*10 + (str[i] - '0');
+    } else if(str[i] == ' ') {
+      num *= 10;
+    } else {
+      return(false);
+    }
+  }
+  *val = num;
+  return(true);
+}
+
 #endif
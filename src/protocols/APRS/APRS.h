@@ -74,10 +74,134 @@
 // alias for unused altitude in Mic-E
 #define RADIOLIB_APRS_MIC_E_ALTITUDE_UNUSED                     -1000000
 
+// Mic-E data types used by older devices
+#define RADIOLIB_APRS_MIC_E_GPS_DATA_CURRENT_REV0               '\x1c'
+#define RADIOLIB_APRS_MIC_E_GPS_DATA_OLD_REV0                   '\x1d'
+
+// length of the fixed parts of APRS packets
+#define RADIOLIB_APRS_TIMESTAMP_LEN                             (7)
+#define RADIOLIB_APRS_POSITION_LEN                              (19)
+#define RADIOLIB_APRS_POSITION_COMPRESSED_LEN                   (13)
+#define RADIOLIB_APRS_MIC_E_INFO_LEN                            (9)
+#define RADIOLIB_APRS_MIC_E_DEST_LEN                            (6)
+#define RADIOLIB_APRS_MSG_ADDRESSEE_LEN                         (9)
+
+// maximum number of analog telemetry channels
+#define RADIOLIB_APRS_TELEMETRY_NUM_ANALOG                      (5)
+
+/*!
+  \defgroup aprs_fields Fields of a decoded APRS packet.
+  \{
+*/
+
+/*! \brief Latitude, longitude and symbol are valid. */
+#define RADIOLIB_APRS_FIELD_POSITION                            (0x01 << 0)
+
+/*! \brief Course and speed are valid. */
+#define RADIOLIB_APRS_FIELD_COURSE_SPEED                        (0x01 << 1)
+
+/*! \brief Altitude is valid. */
+#define RADIOLIB_APRS_FIELD_ALTITUDE                            (0x01 << 2)
+
+/*! \brief Timestamp is valid. */
+#define RADIOLIB_APRS_FIELD_TIMESTAMP                           (0x01 << 3)
+
+/*! \brief Message addressee (and possibly message ID) is valid. */
+#define RADIOLIB_APRS_FIELD_MESSAGE                             (0x01 << 4)
+
+/*! \brief Telemetry is valid. */
+#define RADIOLIB_APRS_FIELD_TELEMETRY                           (0x01 << 5)
+
+/*! \brief Position was Mic-E encoded, Mic-E message type is valid. */
+#define RADIOLIB_APRS_FIELD_MIC_E                               (0x01 << 6)
+
+/*!
+  \}
+*/
+
 // special header applied for APRS over LoRa
 #define RADIOLIB_APRS_LORA_HEADER                               "<\xff\x01"
 #define RADIOLIB_APRS_LORA_HEADER_LEN                           (3)
 
+/*!
+  \struct APRSPacket_t
+  \brief Structure to save a decoded APRS packet into. Text fields point into the buffer that was decoded
+  and are not null-terminated, so that buffer must be kept while the packet is used.
+*/
+struct APRSPacket_t {
+  /*! \brief Data type identifier, the first character of the info field. */
+  char type;
+
+  /*! \brief Which of the fields below are valid, see \ref aprs_fields. */
+  uint8_t fields;
+
+  /*! \brief Source callsign, only set for APRS over LoRa, AX.25 frames have it in the frame. */
+  const char* src;
+
+  /*! \brief Source callsign length, including SSID. */
+  size_t srcLen;
+
+  /*! \brief Latitude in degrees, positive for north. */
+  float lat;
+
+  /*! \brief Longitude in degrees, positive for east. */
+  float lon;
+
+  /*! \brief Symbol table identifier (or overlay character). */
+  char table;
+
+  /*! \brief Symbol code. */
+  char symbol;
+
+  /*! \brief Whether the station is capable of messaging. */
+  bool messaging;
+
+  /*! \brief Course in degrees, 0 if unknown. */
+  uint16_t course;
+
+  /*! \brief Speed in knots. */
+  float speed;
+
+  /*! \brief Altitude in meters. */
+  int32_t altitude;
+
+  /*! \brief Mic-E message type - see \ref mic_e_message_types. */
+  uint8_t micEType;
+
+  /*! \brief Timestamp as sent, 6 digits followed by 'z', '/' or 'h'. */
+  const char* timestamp;
+
+  /*! \brief Message addressee, with trailing spaces removed. */
+  const char* addressee;
+
+  /*! \brief Message addressee length. */
+  size_t addresseeLen;
+
+  /*! \brief Message ID, NULL if the message does not have one. */
+  const char* msgId;
+
+  /*! \brief Message ID length. */
+  size_t msgIdLen;
+
+  /*! \brief Telemetry sequence number, or -1 if the sequence was not a number (e.g. "MIC"). */
+  int16_t telemSeq;
+
+  /*! \brief Number of valid analog telemetry values. */
+  uint8_t telemNumAnalog;
+
+  /*! \brief Analog telemetry values. */
+  float telemAnalog[RADIOLIB_APRS_TELEMETRY_NUM_ANALOG];
+
+  /*! \brief Digital telemetry value, first bit in the MSB. */
+  uint8_t telemDigital;
+
+  /*! \brief Comment, status or message text. */
+  const char* text;
+
+  /*! \brief Text length. */
+  size_t textLen;
+};
+
 /*!
   \class APRSClient
   \brief Client for APRS communication.
@@ -144,6 +268,26 @@ class APRSClient {
     */
     int16_t sendFrame(char* destCallsign, uint8_t destSSID, char* info);
 
+    /*!
+      \brief Decode APRS packet received over AX.25. Positions (uncompressed, compressed and Mic-E),
+      messages, status reports and telemetry are decoded, for other types only the type and text are set.
+      Nothing is copied or allocated, text fields of the packet point into the info field of the frame.
+      \param frame Received AX.25 frame.
+      \param packet Pointer to structure to save the decoded packet into.
+      \returns \ref status_codes
+    */
+    static int16_t decode(const AX25Frame* frame, APRSPacket_t* packet);
+
+    /*!
+      \brief Decode APRS packet received over LoRa, in the "SRC>DEST,PATH:info" format used by sendFrame.
+      Nothing is copied or allocated, text fields of the packet point into the received buffer.
+      \param data Received packet, with or without the LoRa APRS header.
+      \param len Received packet length.
+      \param packet Pointer to structure to save the decoded packet into.
+      \returns \ref status_codes
+    */
+    static int16_t decode(const uint8_t* data, size_t len, APRSPacket_t* packet);
+
     /*!
       \brief Set the repeater callsigns and SSIDs to be used by the frames sent by sendPosition, sendMicE or sendFrame.
       \param repeaterCallsigns Array of repeater callsigns in the form of null-terminated C-strings.
@@ -177,6 +321,14 @@ class APRSClient {
     // source callsign when using APRS over LoRa
     char src[RADIOLIB_AX25_MAX_CALLSIGN_LEN + 1] = { 0 };
     uint8_t id = 0;
+
+    static int16_t decodeInfo(const char* info, size_t len, const char* dest, size_t destLen, APRSPacket_t* packet);
+    static int16_t decodePosition(const char* info, size_t len, APRSPacket_t* packet);
+    static int16_t decodeMicE(const char* info, size_t len, const char* dest, size_t destLen, APRSPacket_t* packet);
+    static int16_t decodeMessage(const char* info, size_t len, APRSPacket_t* packet);
+    static int16_t decodeTelemetry(const char* info, size_t len, APRSPacket_t* packet);
+    static bool parseNumber(const char* str, size_t len, float* val);
+    static bool parseDigits(const char* str, size_t len, uint32_t* val);
 };
 
 #endif
@@ -2,8 +2,27 @@
 
 #include <string.h>
 
+#if defined(ESP_PLATFORM)
+#include "esp_attr.h"
+#endif
+
 #if !RADIOLIB_EXCLUDE_AX25
 
+#if !RADIOLIB_EXCLUDE_DIRECT_RECEIVE
+// same as for the pager, the bit reading ISR needs global scope, so only one AX.25 receiver can run at a time
+static PhysicalLayer* readBitInstance = NULL;
+static uint32_t readBitPin = RADIOLIB_NC;
+
+#if defined(ESP8266) || defined(ESP32)
+  IRAM_ATTR
+#endif
+static void AX25ClientReadBit(void) {
+  if(readBitInstance) {
+    readBitInstance->readBit(readBitPin);
+  }
+}
+#endif
+
 AX25Frame::AX25Frame(const char* destCallsign, uint8_t destSSID, const char* srcCallsign, uint8_t srcSSID, uint8_t control)
 : AX25Frame(destCallsign, destSSID, srcCallsign, srcSSID, control, 0, NULL, 0) {
 
@@ -108,6 +127,10 @@ AX25Frame::~AX25Frame() {
 }
 
 AX25Frame& AX25Frame::operator=(const AX25Frame& frame) {
+  if(&frame == this) {
+    return(*this);
+  }
+
   // destination callsign/SSID
   memcpy(this->destCallsign, frame.destCallsign, strlen(frame.destCallsign));
   this->destCallsign[strlen(frame.destCallsign)] = '\0';
@@ -118,12 +141,33 @@ AX25Frame& AX25Frame::operator=(const AX25Frame& frame) {
   this->srcCallsign[strlen(frame.srcCallsign)] = '\0';
   this->srcSSID = frame.srcSSID;
 
-  // repeaters
+  // repeaters, the buffers are only reallocated when they are dynamic
+  #if !RADIOLIB_STATIC_ONLY
+    if(this->numRepeaters > 0) {
+      for(uint8_t i = 0; i < this->numRepeaters; i++) {
+        delete[] this->repeaterCallsigns[i];
+      }
+      delete[] this->repeaterCallsigns;
+      delete[] this->repeaterSSIDs;
+    }
+    this->repeaterCallsigns = NULL;
+    this->repeaterSSIDs = NULL;
+    if(frame.numRepeaters > 0) {
+      this->repeaterCallsigns = new char*[frame.numRepeaters];
+      for(uint8_t i = 0; i < frame.numRepeaters; i++) {
+        this->repeaterCallsigns[i] = new char[strlen(frame.repeaterCallsigns[i]) + 1];
+      }
+      this->repeaterSSIDs = new uint8_t[frame.numRepeaters];
+    }
+  #endif
   this->numRepeaters = frame.numRepeaters;
   for(uint8_t i = 0; i < this->numRepeaters; i++) {
     memcpy(this->repeaterCallsigns[i], frame.repeaterCallsigns[i], strlen(frame.repeaterCallsigns[i]));
+    this->repeaterCallsigns[i][strlen(frame.repeaterCallsigns[i])] = '\0';
+  }
+  if(this->numRepeaters > 0) {
+    memcpy(this->repeaterSSIDs, frame.repeaterSSIDs, this->numRepeaters);
   }
-  memcpy(this->repeaterSSIDs, frame.repeaterSSIDs, this->numRepeaters);
 
   // control field
   this->control = frame.control;
@@ -136,6 +180,14 @@ AX25Frame& AX25Frame::operator=(const AX25Frame& frame) {
   this->protocolID = frame.protocolID;
 
   // info field
+  #if !RADIOLIB_STATIC_ONLY
+    if(this->infoLen > 0) {
+      delete[] this->info;
+    }
+    if(frame.infoLen > 0) {
+      this->info = new uint8_t[frame.infoLen];
+    }
+  #endif
   this->infoLen = frame.infoLen;
   memcpy(this->info, frame.info, this->infoLen);
 
@@ -306,218 +358,452 @@ int16_t AX25Client::sendFrame(AX25Frame* frame) {
     }
   #endif
 
-  // calculate frame length without FCS (destination address, source address, repeater addresses, control, PID, info)
-  size_t frameBuffLen = ((2 + frame->numRepeaters)*(RADIOLIB_AX25_MAX_CALLSIGN_LEN + 1)) + 1 + 1 + frame->infoLen;
-  // create frame buffer without preamble, start or stop flags
+  // AFSK is modulated bit by bit, so the frame is encoded as it is sent, a few bytes at a time
+  uint8_t window[RADIOLIB_AX25_TX_WINDOW_LEN];
+  size_t len = 0;
+  #if !RADIOLIB_EXCLUDE_AFSK
+  if(bellModem != nullptr) {
+    bellModem->idle();
+    this->encodeStart(frame);
+    while((len = this->encode(window, sizeof(window))) > 0) {
+      for(size_t i = 0; i < len; i++) {
+        bellModem->write(window[i]);
+      }
+    }
+    bellModem->standby();
+    return(RADIOLIB_ERR_NONE);
+  }
+  #endif
+
+  // packet modems need the whole frame up front, get its length first so that it is encoded only into the final buffer
+  size_t n = 0;
+  this->encodeStart(frame);
+  while((n = this->encode(window, sizeof(window))) > 0) {
+    len += n;
+  }
+
   #if !RADIOLIB_STATIC_ONLY
-    uint8_t* frameBuff = new uint8_t[frameBuffLen + 2];
+    uint8_t* buff = new uint8_t[len];
   #else
-    uint8_t frameBuff[RADIOLIB_STATIC_ARRAY_SIZE + 2];
+    uint8_t buff[1 + (6*RADIOLIB_STATIC_ARRAY_SIZE)/5 + 2];
+    if(len > sizeof(buff)) {
+      return(RADIOLIB_ERR_PACKET_TOO_LONG);
+    }
   #endif
-  uint8_t* frameBuffPtr = frameBuff;
+  this->encodeStart(frame);
+  (void)this->encode(buff, len);
 
-  // set destination callsign - all address field bytes are shifted by one bit to make room for HDLC address extension bit
-  memset(frameBuffPtr, ' ' << 1, RADIOLIB_AX25_MAX_CALLSIGN_LEN);
-  for(size_t i = 0; i < strlen(frame->destCallsign); i++) {
-    *(frameBuffPtr + i) = frame->destCallsign[i] << 1;
-  }
-  frameBuffPtr += RADIOLIB_AX25_MAX_CALLSIGN_LEN;
+  // transmit
+  int16_t state = phyLayer->transmit(buff, len);
+
+  // deallocate memory
+  #if !RADIOLIB_STATIC_ONLY
+    delete[] buff;
+  #endif
 
-  // set destination SSID
-  *(frameBuffPtr++) = RADIOLIB_AX25_SSID_RESPONSE_DEST | RADIOLIB_AX25_SSID_RESERVED_BITS | (frame->destSSID & 0x0F) << 1 | RADIOLIB_AX25_SSID_HDLC_EXTENSION_CONTINUE;
+  return(state);
+}
 
-  // set source callsign - all address field bytes are shifted by one bit to make room for HDLC address extension bit
-  memset(frameBuffPtr, ' ' << 1, RADIOLIB_AX25_MAX_CALLSIGN_LEN);
-  for(size_t i = 0; i < strlen(frame->srcCallsign); i++) {
-    *(frameBuffPtr + i) = frame->srcCallsign[i] << 1;
-  }
-  frameBuffPtr += RADIOLIB_AX25_MAX_CALLSIGN_LEN;
+#if !RADIOLIB_EXCLUDE_DIRECT_RECEIVE
+int16_t AX25Client::startReceive(uint32_t pin) {
+  // start from a clean state, the scrambler has the same seed as the transmitter
+  this->rxScrambler = this->scramblerInit;
+  this->rxInFrame = false;
+  this->rxReady = false;
 
-  // set source SSID
-  *(frameBuffPtr++) = RADIOLIB_AX25_SSID_COMMAND_SOURCE | RADIOLIB_AX25_SSID_RESERVED_BITS | (frame->srcSSID & 0x0F) << 1 | RADIOLIB_AX25_SSID_HDLC_EXTENSION_CONTINUE;
+  // there is no sync word, frames are found by their flags
+  int16_t state = phyLayer->setDirectSyncWord(0, 0);
+  RADIOLIB_ASSERT(state);
+
+  Module* mod = phyLayer->getMod();
+  mod->hal->pinMode(pin, mod->hal->GpioModeInput);
+  readBitInstance = phyLayer;
+  readBitPin = pin;
+
+  phyLayer->setDirectAction(AX25ClientReadBit);
+  return(phyLayer->receiveDirect());
+}
+#endif
 
-  // set repeater callsigns
-  for(uint16_t i = 0; i < frame->numRepeaters; i++) {
-    memset(frameBuffPtr, ' ' << 1, RADIOLIB_AX25_MAX_CALLSIGN_LEN);
-    for(size_t j = 0; j < strlen(frame->repeaterCallsigns[i]); j++) {
-      *(frameBuffPtr + j) = frame->repeaterCallsigns[i][j] << 1;
+size_t AX25Client::decode(const uint8_t* data, size_t len) {
+  size_t i = 0;
+  while((i < len) && !this->rxReady) {
+    uint8_t b = data[i++];
+
+    // G3RUH scrambling was applied last, so it is removed first
+    if(this->scramblerPoly) {
+      this->rxScrambler = rlb_scrambler(&b, 1, this->scramblerPoly, this->rxScrambler, false);
     }
-    frameBuffPtr += RADIOLIB_AX25_MAX_CALLSIGN_LEN;
-    *(frameBuffPtr++) = RADIOLIB_AX25_SSID_HAS_NOT_BEEN_REPEATED | RADIOLIB_AX25_SSID_RESERVED_BITS | (frame->repeaterSSIDs[i] & 0x0F) << 1 | RADIOLIB_AX25_SSID_HDLC_EXTENSION_CONTINUE;
+
+    for(int8_t shift = 7; shift >= 0; shift--) {
+      this->decodeBit((b >> shift) & 0x01);
+    }
+  }
+  return(i);
+}
+
+int16_t AX25Client::readFrame(AX25Frame* frame) {
+  if(!frame) {
+    return(RADIOLIB_ERR_NULL_POINTER);
   }
 
-  // set HDLC extension end bit
-  *(frameBuffPtr - 1) |= RADIOLIB_AX25_SSID_HDLC_EXTENSION_END;
+  #if !RADIOLIB_EXCLUDE_DIRECT_RECEIVE
+  while(!this->rxReady && (phyLayer->available() > 0)) {
+    uint8_t b = phyLayer->read(false);
+    (void)this->decode(&b, 1);
+  }
+  #endif
 
-  // set sequence numbers of the frames that have it
-  uint8_t controlField = frame->control;
-  if((frame->control & 0x01) == 0) {
-    // information frame, set both sequence numbers
-    controlField |= frame->rcvSeqNumber << 5;
-    controlField |= frame->sendSeqNumber << 1;
-  } else if((frame->control & 0x02) == 0) {
-    // supervisory frame, set only receive sequence number
-    controlField |= frame->rcvSeqNumber << 5;
+  if(!this->rxReady) {
+    return(RADIOLIB_ERR_RX_TIMEOUT);
   }
+  this->rxReady = false;
+  return(this->parseFrame(this->rxBuff, this->rxFrameLen, frame));
+}
 
-  // set control field
-  *(frameBuffPtr++) = controlField;
+void AX25Client::getCallsign(char* buff) {
+  strncpy(buff, sourceCallsign, RADIOLIB_AX25_MAX_CALLSIGN_LEN + 1);
+}
+
+uint8_t AX25Client::getSSID() {
+  return(sourceSSID);
+}
 
-  // set PID field of the frames that have it
-  if(frame->protocolID != 0x00) {
-    *(frameBuffPtr++) = frame->protocolID;
+void AX25Client::decodeBit(uint8_t level) {
+  // NRZI: no transition is 1, transition is 0
+  uint8_t bit = (level == this->rxLevel) ? 1 : 0;
+  this->rxLevel = level;
+
+  // AX.25 is sent LSB first, so bits are shifted in from the top
+  this->rxShift = (this->rxShift >> 1) | (bit << 7);
+
+  // flag ends the frame being received and starts the next one
+  if(this->rxShift == RADIOLIB_AX25_FLAG) {
+    // the flag itself was already shifted in except for its last bit, so a complete frame has 7 bits pending
+    if(this->rxInFrame && (this->rxBits == 7) && (this->rxLen >= RADIOLIB_AX25_MIN_FRAME_LEN)) {
+      RadioLibCRCInstance.size = 16;
+      RadioLibCRCInstance.poly = RADIOLIB_CRC_CCITT_POLY;
+      RadioLibCRCInstance.init = RADIOLIB_CRC_CCITT_INIT;
+      RadioLibCRCInstance.out = RADIOLIB_CRC_CCITT_OUT;
+      RadioLibCRCInstance.refIn = true;
+      RadioLibCRCInstance.refOut = true;
+      uint16_t fcs = RadioLibCRCInstance.checksum(this->rxBuff, this->rxLen - 2);
+      if(fcs == ((uint16_t)this->rxBuff[this->rxLen - 2] | ((uint16_t)this->rxBuff[this->rxLen - 1] << 8))) {
+        this->rxFrameLen = this->rxLen;
+        this->rxReady = true;
+      } else {
+        RADIOLIB_DEBUG_PROTOCOL_PRINTLN("AX.25 FCS mismatch, %d bytes dropped", (int)this->rxLen);
+      }
+    }
+    this->rxInFrame = true;
+    this->rxLen = 0;
+    this->rxBits = 0;
+    return;
   }
 
-  // set info field of the frames that have it
-  if(frame->infoLen > 0) {
-    memcpy(frameBuffPtr, frame->info, frame->infoLen);
-    frameBuffPtr += frame->infoLen;
+  // seven ones in a row abort the frame
+  if((this->rxShift & 0xFE) == 0xFE) {
+    this->rxInFrame = false;
+    return;
   }
 
-  // flip bit order
-  for(size_t i = 0; i < frameBuffLen; i++) {
-    frameBuff[i] = rlb_reflect(frameBuff[i], 8);
+  // zero after five ones was stuffed by the transmitter
+  if((this->rxShift & 0xFC) == 0x7C) {
+    return;
   }
 
-  // calculate
-  RadioLibCRCInstance.size = 16;
-  RadioLibCRCInstance.poly = RADIOLIB_CRC_CCITT_POLY;
-  RadioLibCRCInstance.init = RADIOLIB_CRC_CCITT_INIT;
-  RadioLibCRCInstance.out = RADIOLIB_CRC_CCITT_OUT;
-  RadioLibCRCInstance.refIn = false;
-  RadioLibCRCInstance.refOut = false;
-  uint16_t fcs = RadioLibCRCInstance.checksum(frameBuff, frameBuffLen);
-  *(frameBuffPtr++) = (uint8_t)((fcs >> 8) & 0xFF);
-  *(frameBuffPtr++) = (uint8_t)(fcs & 0xFF);
+  if(!this->rxInFrame) {
+    return;
+  }
 
-  // prepare buffer for the final frame (stuffed, with added preamble + flags and NRZI-encoded)
-  #if !RADIOLIB_STATIC_ONLY
-    // worst-case scenario: sequence of 1s, will have 120% of the original length, stuffed frame also includes both flags
-    uint8_t* stuffedFrameBuff = new uint8_t[preambleLen + 1 + (6*frameBuffLen)/5 + 2];
-  #else
-    uint8_t stuffedFrameBuff[1 + (6*RADIOLIB_STATIC_ARRAY_SIZE)/5 + 2];
-  #endif
+  this->rxByte = (this->rxByte >> 1) | (bit << 7);
+  this->rxBits++;
+  if(this->rxBits < 8) {
+    return;
+  }
+  this->rxBits = 0;
 
-  // initialize buffer to all zeros
-  memset(stuffedFrameBuff, 0x00, preambleLen + 1 + (6*frameBuffLen)/5 + 2);
+  // too long to be valid, wait for the next flag
+  if(this->rxLen >= RADIOLIB_AX25_MAX_FRAME_LEN) {
+    this->rxInFrame = false;
+    return;
+  }
+  this->rxBuff[this->rxLen++] = this->rxByte;
+}
 
-  // stuff bits (skip preamble and both flags)
-  uint16_t stuffedFrameBuffLenBits = 8*(preambleLen + 1);
-  uint8_t count = 0;
-  for(size_t i = 0; i < frameBuffLen + 2; i++) {
-    for(int8_t shift = 7; shift >= 0; shift--) {
-      uint16_t stuffedFrameBuffPos = stuffedFrameBuffLenBits + 7 - 2*(stuffedFrameBuffLenBits%8);
-      if((frameBuff[i] >> shift) & 0x01) {
-        // copy 1 and increment counter
-        SET_BIT_IN_ARRAY_MSB(stuffedFrameBuff, stuffedFrameBuffPos);
-        stuffedFrameBuffLenBits++;
-        count++;
-
-        // check 5 consecutive 1s
-        if(count == 5) {
-          // get the new position in stuffed frame
-          stuffedFrameBuffPos = stuffedFrameBuffLenBits + 7 - 2*(stuffedFrameBuffLenBits%8);
-
-          // insert 0 and reset counter
-          CLEAR_BIT_IN_ARRAY_MSB(stuffedFrameBuff, stuffedFrameBuffPos);
-          stuffedFrameBuffLenBits++;
-          count = 0;
-        }
+int16_t AX25Client::parseFrame(const uint8_t* buff, size_t len, AX25Frame* frame) {
+  // FCS was already checked
+  len -= 2;
+
+  // address fields: destination, source and repeaters, the last one has the HDLC extension bit set
+  char callsigns[10][RADIOLIB_AX25_MAX_CALLSIGN_LEN + 1];
+  uint8_t ssids[10];
+  uint8_t numAddr = 0;
+  size_t pos = 0;
+  bool last = false;
+  while(!last) {
+    if(numAddr >= 10) {
+      return(RADIOLIB_ERR_INVALID_NUM_REPEATERS);
+    }
+    if(pos + RADIOLIB_AX25_MAX_CALLSIGN_LEN + 1 > len) {
+      return(RADIOLIB_ERR_PACKET_TOO_SHORT);
+    }
 
-      } else {
-        // copy 0 and reset counter
-        CLEAR_BIT_IN_ARRAY_MSB(stuffedFrameBuff, stuffedFrameBuffPos);
-        stuffedFrameBuffLenBits++;
-        count = 0;
-      }
+    // callsign characters are shifted by one bit and padded with spaces
+    char* callsign = callsigns[numAddr];
+    for(uint8_t i = 0; i < RADIOLIB_AX25_MAX_CALLSIGN_LEN; i++) {
+      callsign[i] = (char)(buff[pos + i] >> 1);
+    }
+    callsign[RADIOLIB_AX25_MAX_CALLSIGN_LEN] = '\0';
+    for(int8_t i = RADIOLIB_AX25_MAX_CALLSIGN_LEN - 1; (i >= 0) && (callsign[i] == ' '); i--) {
+      callsign[i] = '\0';
+    }
 
+    // keep the has-been-repeated bit for repeaters
+    uint8_t ssid = buff[pos + RADIOLIB_AX25_MAX_CALLSIGN_LEN];
+    ssids[numAddr] = (ssid >> 1) & 0x0F;
+    if(numAddr >= 2) {
+      ssids[numAddr] |= ssid & RADIOLIB_AX25_SSID_HAS_BEEN_REPEATED;
     }
+    last = ssid & RADIOLIB_AX25_SSID_HDLC_EXTENSION_END;
+    pos += RADIOLIB_AX25_MAX_CALLSIGN_LEN + 1;
+    numAddr++;
+  }
+  if(numAddr < 2) {
+    return(RADIOLIB_ERR_INVALID_NUM_REPEATERS);
   }
 
-  // deallocate memory
-  #if !RADIOLIB_STATIC_ONLY
-    delete[] frameBuff;
+  // control field, sequence numbers are kept separately the same way they are set for transmission
+  if(pos >= len) {
+    return(RADIOLIB_ERR_PACKET_TOO_SHORT);
+  }
+  uint8_t control = buff[pos++];
+  uint8_t rcvSeq = 0;
+  uint8_t sendSeq = 0;
+  bool hasPid = false;
+  if((control & 0x01) == 0) {
+    // information frame
+    rcvSeq = (control >> 5) & 0x07;
+    sendSeq = (control >> 1) & 0x07;
+    control &= 0x11;
+    hasPid = true;
+  } else if((control & 0x02) == 0) {
+    // supervisory frame
+    rcvSeq = (control >> 5) & 0x07;
+    control &= 0x1F;
+  } else {
+    // unnumbered frame, only UI has the PID field
+    hasPid = ((control & ~RADIOLIB_AX25_CONTROL_POLL_FINAL_ENABLED) == RADIOLIB_AX25_CONTROL_UNNUMBERED_FRAME);
+  }
+
+  uint8_t pid = 0;
+  if(hasPid && (pos < len)) {
+    pid = buff[pos++];
+  }
+
+  // whatever remains is the info field
+  uint16_t infoLen = len - pos;
+  #if RADIOLIB_STATIC_ONLY
+    if(infoLen > RADIOLIB_STATIC_ARRAY_SIZE) {
+      return(RADIOLIB_ERR_PACKET_TOO_LONG);
+    }
   #endif
 
-  // set preamble bytes and start flag field
-  for(uint16_t i = 0; i < preambleLen + 1; i++) {
-    stuffedFrameBuff[i] = RADIOLIB_AX25_FLAG;
+  AX25Frame rx(callsigns[0], ssids[0], callsigns[1], ssids[1], control, pid, &buff[pos], infoLen);
+  rx.setRecvSequence(rcvSeq);
+  rx.setSendSequence(sendSeq);
+  if(numAddr > 2) {
+    char* repeaters[8];
+    for(uint8_t i = 0; i < numAddr - 2; i++) {
+      repeaters[i] = callsigns[i + 2];
+    }
+    int16_t state = rx.setRepeaters(repeaters, &ssids[2], numAddr - 2);
+    RADIOLIB_ASSERT(state);
   }
+  *frame = rx;
+  return(RADIOLIB_ERR_NONE);
+}
 
-  // get stuffed frame length in bytes
-  size_t stuffedFrameBuffLen = stuffedFrameBuffLenBits/8 + 1;
-  uint8_t trailingLen = stuffedFrameBuffLenBits % 8;
+void AX25Client::encodeStart(const AX25Frame* frame) {
+  this->txFrame = frame;
+  this->txPhase = RADIOLIB_AX25_TX_PREAMBLE;
+  this->txPos = 0;
+  this->txFcs = RADIOLIB_CRC_CCITT_INIT;
+  this->txOnes = 0;
+  this->txLevel = 0;
+  this->txScrambler = this->scramblerInit;
+  this->txByte = 0;
+  this->txBits = 0;
+  this->txHoldLen = 0;
+  this->txHoldPos = 0;
+}
 
-  // set end flag field (may be split into two bytes due to misalignment caused by extra stuffing bits)
-  if(trailingLen != 0) {
-    stuffedFrameBuffLen++;
-    stuffedFrameBuff[stuffedFrameBuffLen - 2] |= RADIOLIB_AX25_FLAG >> trailingLen;
-    stuffedFrameBuff[stuffedFrameBuffLen - 1] = RADIOLIB_AX25_FLAG << (8 - trailingLen);
-  } else {
-    stuffedFrameBuff[stuffedFrameBuffLen - 1] = RADIOLIB_AX25_FLAG;
+size_t AX25Client::encode(uint8_t* out, size_t len) {
+  size_t n = 0;
+  while(n < len) {
+    // hand out what the last encoded byte produced first
+    if(this->txHoldPos < this->txHoldLen) {
+      out[n++] = this->txHold[this->txHoldPos++];
+      continue;
+    }
+    this->txHoldLen = 0;
+    this->txHoldPos = 0;
+    if(this->txPhase == RADIOLIB_AX25_TX_DONE) {
+      break;
+    }
+    this->encodeNext();
   }
+  return(n);
+}
 
-  // convert to NRZI
-  for(size_t i = preambleLen + 1; i < stuffedFrameBuffLen*8; i++) {
-    size_t currBitPos = i + 7 - 2*(i%8);
-    size_t prevBitPos = (i - 1) + 7 - 2*((i - 1)%8);
-    if(TEST_BIT_IN_ARRAY_MSB(stuffedFrameBuff, currBitPos)) {
-      // bit is 1, no change, copy previous bit
-      if(TEST_BIT_IN_ARRAY_MSB(stuffedFrameBuff, prevBitPos)) {
-        SET_BIT_IN_ARRAY_MSB(stuffedFrameBuff, currBitPos);
-      } else {
-        CLEAR_BIT_IN_ARRAY_MSB(stuffedFrameBuff, currBitPos);
+void AX25Client::encodeNext() {
+  const AX25Frame* frame = this->txFrame;
+  size_t numAddr = 2 + frame->numRepeaters;
+  uint8_t b = RADIOLIB_AX25_FLAG;
+  bool data = true;
+  bool crc = true;
+
+  switch(this->txPhase) {
+    case(RADIOLIB_AX25_TX_PREAMBLE): {
+      // preamble and the start flag
+      data = false;
+      if(++this->txPos > this->preambleLen) {
+        this->txPhase = RADIOLIB_AX25_TX_ADDRESS;
+        this->txPos = 0;
+      }
+    } break;
+
+    case(RADIOLIB_AX25_TX_ADDRESS): {
+      // address fields are generated on the fly: 6 callsign characters shifted by one bit, then SSID
+      size_t addr = this->txPos / (RADIOLIB_AX25_MAX_CALLSIGN_LEN + 1);
+      size_t pos = this->txPos % (RADIOLIB_AX25_MAX_CALLSIGN_LEN + 1);
+      const char* callsign = frame->destCallsign;
+      uint8_t ssid = RADIOLIB_AX25_SSID_RESPONSE_DEST | (frame->destSSID & 0x0F) << 1;
+      if(addr == 1) {
+        callsign = frame->srcCallsign;
+        ssid = RADIOLIB_AX25_SSID_COMMAND_SOURCE | (frame->srcSSID & 0x0F) << 1;
+      } else if(addr > 1) {
+        callsign = frame->repeaterCallsigns[addr - 2];
+        ssid = (frame->repeaterSSIDs[addr - 2] & RADIOLIB_AX25_SSID_HAS_BEEN_REPEATED) | (frame->repeaterSSIDs[addr - 2] & 0x0F) << 1;
       }
 
-    } else {
-      // bit is 0, transition, copy inversion of the previous bit
-      if(TEST_BIT_IN_ARRAY_MSB(stuffedFrameBuff, prevBitPos)) {
-        CLEAR_BIT_IN_ARRAY_MSB(stuffedFrameBuff, currBitPos);
+      if(pos < RADIOLIB_AX25_MAX_CALLSIGN_LEN) {
+        b = ' ' << 1;
+        if(pos < strlen(callsign)) {
+          b = callsign[pos] << 1;
+        }
       } else {
-        SET_BIT_IN_ARRAY_MSB(stuffedFrameBuff, currBitPos);
+        b = ssid | RADIOLIB_AX25_SSID_RESERVED_BITS;
+        b |= (addr == numAddr - 1) ? RADIOLIB_AX25_SSID_HDLC_EXTENSION_END : RADIOLIB_AX25_SSID_HDLC_EXTENSION_CONTINUE;
       }
-    }
-  }
 
-  // do the scrambling
-  if(scramblerPoly) {
-    rlb_scrambler(stuffedFrameBuff, stuffedFrameBuffLen, scramblerPoly, scramblerInit, true);
-  }
+      if(++this->txPos >= numAddr*(RADIOLIB_AX25_MAX_CALLSIGN_LEN + 1)) {
+        this->txPhase = RADIOLIB_AX25_TX_CONTROL;
+        this->txPos = 0;
+      }
+    } break;
+
+    case(RADIOLIB_AX25_TX_CONTROL): {
+      // set sequence numbers of the frames that have it
+      b = frame->control;
+      if((frame->control & 0x01) == 0) {
+        // information frame, set both sequence numbers
+        b |= frame->rcvSeqNumber << 5;
+        b |= frame->sendSeqNumber << 1;
+      } else if((frame->control & 0x02) == 0) {
+        // supervisory frame, set only receive sequence number
+        b |= frame->rcvSeqNumber << 5;
+      }
 
-  // transmit
-  int16_t state = RADIOLIB_ERR_NONE;
-  #if !RADIOLIB_EXCLUDE_AFSK
-  if(bellModem != nullptr) {
-    bellModem->idle();
+      // PID field only for the frames that have it
+      this->txPhase = (frame->protocolID != 0x00) ? RADIOLIB_AX25_TX_PID : RADIOLIB_AX25_TX_INFO;
+    } break;
 
-    // iterate over all bytes in the buffer
-    for(uint32_t i = 0; i < stuffedFrameBuffLen; i++) {
-      bellModem->write(stuffedFrameBuff[i]);
-    }
+    case(RADIOLIB_AX25_TX_PID): {
+      b = frame->protocolID;
+      this->txPhase = RADIOLIB_AX25_TX_INFO;
+    } break;
 
-    bellModem->standby();
+    case(RADIOLIB_AX25_TX_INFO): {
+      if(this->txPos < frame->infoLen) {
+        b = frame->info[this->txPos++];
+        break;
+      }
 
-  } else {
-  #endif
-    state = phyLayer->transmit(stuffedFrameBuff, stuffedFrameBuffLen);
-  #if !RADIOLIB_EXCLUDE_AFSK
+      // FCS is the complement of the CRC, sent low byte first, so it is just the next data byte
+      this->txFcs ^= RADIOLIB_CRC_CCITT_OUT;
+      this->txPhase = RADIOLIB_AX25_TX_FCS;
+      this->txPos = 0;
+    } // fall through
+
+    case(RADIOLIB_AX25_TX_FCS): {
+      crc = false;
+      b = (this->txFcs >> (8*this->txPos)) & 0xFF;
+      if(++this->txPos >= 2) {
+        this->txPhase = RADIOLIB_AX25_TX_END;
+      }
+    } break;
+
+    case(RADIOLIB_AX25_TX_END): {
+      // end flag, then pad the last byte with the start of another flag
+      data = false;
+      this->txPhase = RADIOLIB_AX25_TX_DONE;
+    } break;
+
+    default:
+      return;
   }
-  #endif
 
-  // deallocate memory
-  #if !RADIOLIB_STATIC_ONLY
-    delete[] stuffedFrameBuff;
-  #endif
+  // AX.25 is sent LSB first
+  for(uint8_t i = 0; i < 8; i++) {
+    uint8_t bit = (b >> i) & 0x01;
+    if(!data) {
+      this->encodeBit(bit);
+      continue;
+    }
 
-  return(state);
-}
+    // running CRC over the data, in the bit order it is sent
+    if(crc) {
+      this->txFcs = (this->txFcs >> 1) ^ (((this->txFcs ^ bit) & 0x01) ? RADIOLIB_AX25_CRC_CCITT_POLY_REFLECTED : 0);
+    }
 
-void AX25Client::getCallsign(char* buff) {
-  strncpy(buff, sourceCallsign, RADIOLIB_AX25_MAX_CALLSIGN_LEN + 1);
+    // zero is inserted after five ones so that data can not look like a flag
+    this->encodeBit(bit);
+    this->txOnes = bit ? this->txOnes + 1 : 0;
+    if(this->txOnes == 5) {
+      this->encodeBit(0);
+      this->txOnes = 0;
+    }
+  }
+  if(!data) {
+    this->txOnes = 0;
+  }
+
+  if(this->txPhase == RADIOLIB_AX25_TX_DONE) {
+    for(uint8_t i = 0; this->txBits != 0; i++) {
+      this->encodeBit((RADIOLIB_AX25_FLAG >> i) & 0x01);
+    }
+  }
 }
 
-uint8_t AX25Client::getSSID() {
-  return(sourceSSID);
+void AX25Client::encodeBit(uint8_t bit) {
+  // NRZI: 0 is a transition, 1 keeps the level
+  if(!bit) {
+    this->txLevel ^= 0x01;
+  }
+
+  // first bit on air is the MSB of the output
+  this->txByte = (this->txByte << 1) | this->txLevel;
+  if(++this->txBits < 8) {
+    return;
+  }
+  this->txBits = 0;
+
+  // scrambling is the last step
+  if(this->scramblerPoly) {
+    this->txScrambler = rlb_scrambler(&this->txByte, 1, this->scramblerPoly, this->txScrambler, true);
+  }
+  this->txHold[this->txHoldLen++] = this->txByte;
 }
 
 #endif
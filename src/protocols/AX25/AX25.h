@@ -14,6 +14,32 @@
 // maximum callsign length in bytes
 #define RADIOLIB_AX25_MAX_CALLSIGN_LEN                          6
 
+// maximum length of received frame without flags: 10 addresses, control, PID, 256 bytes of information and FCS
+#if !defined(RADIOLIB_AX25_MAX_FRAME_LEN)
+  #define RADIOLIB_AX25_MAX_FRAME_LEN                           (10*(RADIOLIB_AX25_MAX_CALLSIGN_LEN + 1) + 2 + 1 + 256 + 2)
+#endif
+
+// shortest valid frame: destination and source address, control and FCS
+#define RADIOLIB_AX25_MIN_FRAME_LEN                             (2*(RADIOLIB_AX25_MAX_CALLSIGN_LEN + 1) + 1 + 2)
+
+// number of encoded bytes handed to the AFSK modem at a time
+#if !defined(RADIOLIB_AX25_TX_WINDOW_LEN)
+  #define RADIOLIB_AX25_TX_WINDOW_LEN                           (8)
+#endif
+
+// FCS polynomial in reflected form, as the FCS is calculated over data sent LSB first
+#define RADIOLIB_AX25_CRC_CCITT_POLY_REFLECTED                  (0x8408)
+
+// encoder phases
+#define RADIOLIB_AX25_TX_PREAMBLE                               (0)
+#define RADIOLIB_AX25_TX_ADDRESS                                (1)
+#define RADIOLIB_AX25_TX_CONTROL                                (2)
+#define RADIOLIB_AX25_TX_PID                                    (3)
+#define RADIOLIB_AX25_TX_INFO                                   (4)
+#define RADIOLIB_AX25_TX_FCS                                    (5)
+#define RADIOLIB_AX25_TX_END                                    (6)
+#define RADIOLIB_AX25_TX_DONE                                   (7)
+
 // flag field                                                                 MSB   LSB   DESCRIPTION
 #define RADIOLIB_AX25_FLAG                                      0b01111110  //  7     0     AX.25 frame start/end flag
 
@@ -132,7 +158,8 @@ class AX25Frame {
       char** repeaterCallsigns;
 
       /*!
-        \brief Array of repeater SSIDs.
+        \brief Array of repeater SSIDs. In received frames, RADIOLIB_AX25_SSID_HAS_BEEN_REPEATED
+        is set for repeaters that already repeated the frame.
       */
       uint8_t* repeaterSSIDs;
     #else
@@ -147,7 +174,8 @@ class AX25Frame {
       char repeaterCallsigns[8][RADIOLIB_AX25_MAX_CALLSIGN_LEN + 1];
 
       /*!
-        \brief Array of repeater SSIDs.
+        \brief Array of repeater SSIDs. In received frames, RADIOLIB_AX25_SSID_HAS_BEEN_REPEATED
+        is set for repeaters that already repeated the frame.
       */
       uint8_t repeaterSSIDs[8];
     #endif
@@ -317,6 +345,35 @@ class AX25Client {
     */
     int16_t sendFrame(AX25Frame* frame);
 
+    #if !RADIOLIB_EXCLUDE_DIRECT_RECEIVE
+    /*!
+      \brief Start reception of AX.25 frames in direct mode. The radio has to be configured
+      for the bit rate of the channel, and scrambling set by setScrambler is removed as well.
+      \param pin Pin to receive digital data on (e.g., DIO2 for SX127x).
+      \returns \ref status_codes
+    */
+    int16_t startReceive(uint32_t pin);
+    #endif
+
+    /*!
+      \brief Feed raw received bits to the decoder, for example from an external demodulator.
+      Bits are processed as they come: descrambling, NRZI decoding, flag detection and bit unstuffing
+      are done in a single pass, so only the frame being received is kept. Decoding stops after the byte
+      that completes a valid frame, until that frame is retrieved by readFrame.
+      \param data Received bits, first bit in the MSB of the first byte.
+      \param len Number of bytes.
+      \returns Number of bytes consumed.
+    */
+    size_t decode(const uint8_t* data, size_t len);
+
+    /*!
+      \brief Get the next received frame. In direct mode, this decodes whatever is in the direct mode buffer.
+      Frames with invalid FCS are silently dropped.
+      \param frame Pointer to frame to save the received frame into.
+      \returns \ref status_codes, RADIOLIB_ERR_RX_TIMEOUT if no complete frame was received yet.
+    */
+    int16_t readFrame(AX25Frame* frame);
+
 #if !RADIOLIB_GODMODE
   private:
 #endif
@@ -334,8 +391,42 @@ class AX25Client {
     uint32_t scramblerInit = 0;
     uint32_t scramblerPoly = 0;
 
+    // receiver: descrambler state and last line level, the last 8 decoded bits (newest in MSB) for flag detection,
+    // the byte being assembled and the frame received so far
+    uint32_t rxScrambler = 0;
+    uint8_t rxLevel = 0;
+    uint8_t rxShift = 0;
+    uint8_t rxByte = 0;
+    uint8_t rxBits = 0;
+    bool rxInFrame = false;
+    bool rxReady = false;
+    size_t rxLen = 0;
+    size_t rxFrameLen = 0;
+    uint8_t rxBuff[RADIOLIB_AX25_MAX_FRAME_LEN] = { 0 };
+
+    // transmitter: frame being sent, current field and position in it, running FCS, number of consecutive ones,
+    // line level and scrambler state, the byte being assembled and up to two finished bytes not handed out yet
+    const AX25Frame* txFrame = NULL;
+    uint8_t txPhase = RADIOLIB_AX25_TX_DONE;
+    size_t txPos = 0;
+    uint16_t txFcs = 0;
+    uint8_t txOnes = 0;
+    uint8_t txLevel = 0;
+    uint32_t txScrambler = 0;
+    uint8_t txByte = 0;
+    uint8_t txBits = 0;
+    uint8_t txHold[2] = { 0 };
+    uint8_t txHoldLen = 0;
+    uint8_t txHoldPos = 0;
+
     void getCallsign(char* buff);
     uint8_t getSSID();
+    void decodeBit(uint8_t level);
+    int16_t parseFrame(const uint8_t* buff, size_t len, AX25Frame* frame);
+    void encodeStart(const AX25Frame* frame);
+    size_t encode(uint8_t* out, size_t len);
+    void encodeNext();
+    void encodeBit(uint8_t bit);
 };
 
 #endif
@@ -0,0 +1,213 @@
+#include "BellDemodulator.h"
+#include <string.h>
+#if !RADIOLIB_EXCLUDE_BELL
+
+// one period of sine, amplitude 127
+static const int8_t BellDemodulatorSine[256] RADIOLIB_NONVOLATILE = {
+     0,    3,    6,    9,   12,   16,   19,   22,   25,   28,   31,   34,   37,   40,   43,   46,
+    49,   51,   54,   57,   60,   63,   65,   68,   71,   73,   76,   78,   81,   83,   85,   88,
+    90,   92,   94,   96,   98,  100,  102,  104,  106,  107,  109,  111,  112,  113,  115,  116,
+   117,  118,  120,  121,  122,  122,  123,  124,  125,  125,  126,  126,  126,  127,  127,  127,
+   127,  127,  127,  127,  126,  126,  126,  125,  125,  124,  123,  122,  122,  121,  120,  118,
+   117,  116,  115,  113,  112,  111,  109,  107,  106,  104,  102,  100,   98,   96,   94,   92,
+    90,   88,   85,   83,   81,   78,   76,   73,   71,   68,   65,   63,   60,   57,   54,   51,
+    49,   46,   43,   40,   37,   34,   31,   28,   25,   22,   19,   16,   12,    9,    6,    3,
+     0,   -3,   -6,   -9,  -12,  -16,  -19,  -22,  -25,  -28,  -31,  -34,  -37,  -40,  -43,  -46,
+   -49,  -51,  -54,  -57,  -60,  -63,  -65,  -68,  -71,  -73,  -76,  -78,  -81,  -83,  -85,  -88,
+   -90,  -92,  -94,  -96,  -98, -100, -102, -104, -106, -107, -109, -111, -112, -113, -115, -116,
+  -117, -118, -120, -121, -122, -122, -123, -124, -125, -125, -126, -126, -126, -127, -127, -127,
+  -127, -127, -127, -127, -126, -126, -126, -125, -125, -124, -123, -122, -122, -121, -120, -118,
+  -117, -116, -115, -113, -112, -111, -109, -107, -106, -104, -102, -100,  -98,  -96,  -94,  -92,
+   -90,  -88,  -85,  -83,  -81,  -78,  -76,  -73,  -71,  -68,  -65,  -63,  -60,  -57,  -54,  -51,
+   -49,  -46,  -43,  -40,  -37,  -34,  -31,  -28,  -25,  -22,  -19,  -16,  -12,   -9,   -6,   -3
+};
+
+static inline int32_t BellDemodulatorSin(uint32_t phase) {
+  int8_t* ptr = const_cast<int8_t*>(&BellDemodulatorSine[phase >> 24]);
+  return((int8_t)RADIOLIB_NONVOLATILE_READ_BYTE(ptr));
+}
+
+static inline int32_t BellDemodulatorCos(uint32_t phase) {
+  return(BellDemodulatorSin(phase + 0x40000000UL));
+}
+
+BellDemodulator::BellDemodulator() {
+
+}
+
+BellDemodulator::BellDemodulator(const BellDemodulator& demod) {
+  *this = demod;
+}
+
+BellDemodulator& BellDemodulator::operator=(const BellDemodulator& demod) {
+  if(&demod == this) {
+    return(*this);
+  }
+
+  // the correlator window is owned by each instance
+  #if !RADIOLIB_STATIC_ONLY
+    if(demod.windowLen != this->windowLen) {
+      this->windowLen = 0;
+      delete[] this->window;
+      this->window = NULL;
+      if(demod.windowLen > 0) {
+        this->window = new int32_t[RADIOLIB_BELL_DEMOD_NUM_CHANNELS*demod.windowLen];
+        if(!this->window) {
+          return(*this);
+        }
+      }
+    }
+  #endif
+  this->windowLen = demod.windowLen;
+  this->windowPos = demod.windowPos;
+  if(this->windowLen > 0) {
+    memcpy(this->window, demod.window, RADIOLIB_BELL_DEMOD_NUM_CHANNELS*this->windowLen*sizeof(int32_t));
+  }
+  memcpy(this->sums, demod.sums, sizeof(this->sums));
+
+  this->phaseMark = demod.phaseMark;
+  this->phaseSpace = demod.phaseSpace;
+  this->stepMark = demod.stepMark;
+  this->stepSpace = demod.stepSpace;
+  this->pll = demod.pll;
+  this->pllStep = demod.pllStep;
+  this->level = demod.level;
+  this->byte = demod.byte;
+  this->bits = demod.bits;
+  memcpy(this->buff, demod.buff, sizeof(this->buff));
+  this->buffHead = demod.buffHead;
+  this->buffLen = demod.buffLen;
+  return(*this);
+}
+
+BellDemodulator::~BellDemodulator() {
+  #if !RADIOLIB_STATIC_ONLY
+    delete[] this->window;
+  #endif
+}
+
+int16_t BellDemodulator::begin(const BellModem_t& modem, uint32_t sampleRate, bool reply) {
+  int16_t freqMark = reply ? modem.freqMarkReply : modem.freqMark;
+  int16_t freqSpace = reply ? modem.freqSpaceReply : modem.freqSpace;
+  if((freqMark <= 0) || (freqSpace <= 0) || (2*(uint32_t)RADIOLIB_MAX(freqMark, freqSpace) >= sampleRate)) {
+    return(RADIOLIB_ERR_INVALID_FREQUENCY);
+  }
+
+  // correlators integrate over one bit
+  if(modem.baudRate <= 0) {
+    return(RADIOLIB_ERR_INVALID_BIT_RATE);
+  }
+  size_t len = (sampleRate + modem.baudRate/2) / modem.baudRate;
+  #if !RADIOLIB_STATIC_ONLY
+    if(len < RADIOLIB_BELL_DEMOD_MIN_WINDOW) {
+      return(RADIOLIB_ERR_INVALID_BIT_RATE);
+    }
+    this->windowLen = 0;
+    delete[] this->window;
+    this->window = new int32_t[RADIOLIB_BELL_DEMOD_NUM_CHANNELS*len];
+    RADIOLIB_ASSERT_PTR(this->window);
+  #else
+    if((len < RADIOLIB_BELL_DEMOD_MIN_WINDOW) || (len > RADIOLIB_BELL_DEMOD_MAX_WINDOW)) {
+      return(RADIOLIB_ERR_INVALID_BIT_RATE);
+    }
+  #endif
+  this->windowLen = len;
+
+  this->stepMark = ((uint64_t)freqMark << 32) / sampleRate;
+  this->stepSpace = ((uint64_t)freqSpace << 32) / sampleRate;
+  this->pllStep = ((uint64_t)modem.baudRate << 32) / sampleRate;
+  this->reset();
+  return(RADIOLIB_ERR_NONE);
+}
+
+size_t BellDemodulator::demodulate(const int16_t* samples, size_t numSamples) {
+  if(!samples || (this->windowLen == 0)) {
+    return(0);
+  }
+
+  int32_t* win = this->window;
+  size_t i = 0;
+  for(; i < numSamples; i++) {
+    // stop while there is no room for the next byte
+    if(this->buffLen >= RADIOLIB_BELL_DEMOD_BUFF_LEN) {
+      break;
+    }
+
+    // mix with both tones, and keep sums over the last bit period
+    int32_t s = samples[i];
+    int32_t mix[RADIOLIB_BELL_DEMOD_NUM_CHANNELS] = {
+      s * BellDemodulatorCos(this->phaseMark),
+      s * BellDemodulatorSin(this->phaseMark),
+      s * BellDemodulatorCos(this->phaseSpace),
+      s * BellDemodulatorSin(this->phaseSpace),
+    };
+    this->phaseMark += this->stepMark;
+    this->phaseSpace += this->stepSpace;
+    int32_t* old = &win[RADIOLIB_BELL_DEMOD_NUM_CHANNELS*this->windowPos];
+    for(uint8_t c = 0; c < RADIOLIB_BELL_DEMOD_NUM_CHANNELS; c++) {
+      this->sums[c] += mix[c] - old[c];
+      old[c] = mix[c];
+    }
+    if(++this->windowPos >= this->windowLen) {
+      this->windowPos = 0;
+    }
+
+    // the stronger tone wins
+    int64_t mark = (int64_t)this->sums[0]*this->sums[0] + (int64_t)this->sums[1]*this->sums[1];
+    int64_t space = (int64_t)this->sums[2]*this->sums[2] + (int64_t)this->sums[3]*this->sums[3];
+    uint8_t lvl = (mark > space) ? 1 : 0;
+
+    // tone changes are at bit edges, pull the clock towards them
+    if(lvl != this->level) {
+      int32_t p = (int32_t)this->pll;
+      this->pll = (uint32_t)(p - p/4);
+      this->level = lvl;
+    }
+
+    // the bit is sampled when the clock wraps, half a bit after the edges
+    int32_t prev = (int32_t)this->pll;
+    this->pll += this->pllStep;
+    if((prev >= 0) && ((int32_t)this->pll < 0)) {
+      this->byte = (this->byte << 1) | lvl;
+      if(++this->bits == 8) {
+        this->buff[(this->buffHead + this->buffLen) % RADIOLIB_BELL_DEMOD_BUFF_LEN] = this->byte;
+        this->buffLen++;
+        this->bits = 0;
+      }
+    }
+  }
+
+  return(i);
+}
+
+size_t BellDemodulator::available() {
+  return(this->buffLen);
+}
+
+size_t BellDemodulator::read(uint8_t* data, size_t len) {
+  size_t n = 0;
+  while((n < len) && (this->buffLen > 0)) {
+    data[n++] = this->buff[this->buffHead];
+    this->buffHead = (this->buffHead + 1) % RADIOLIB_BELL_DEMOD_BUFF_LEN;
+    this->buffLen--;
+  }
+  return(n);
+}
+
+void BellDemodulator::reset() {
+  this->phaseMark = 0;
+  this->phaseSpace = 0;
+  this->windowPos = 0;
+  if(this->windowLen) {
+    memset(this->window, 0, RADIOLIB_BELL_DEMOD_NUM_CHANNELS*this->windowLen*sizeof(int32_t));
+  }
+  memset(this->sums, 0, sizeof(this->sums));
+  this->pll = 0;
+  this->level = 0;
+  this->byte = 0;
+  this->bits = 0;
+  this->buffHead = 0;
+  this->buffLen = 0;
+}
+
+#endif
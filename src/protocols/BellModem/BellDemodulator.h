@@ -0,0 +1,128 @@
+#if !defined(_RADIOLIB_BELL_DEMODULATOR_H)
+#define _RADIOLIB_BELL_DEMODULATOR_H
+
+#include "../../TypeDef.h"
+
+#if !RADIOLIB_EXCLUDE_BELL
+
+#include "BellModem.h"
+
+// maximum number of samples per bit, only used in static mode
+#if !defined(RADIOLIB_BELL_DEMOD_MAX_WINDOW)
+  #define RADIOLIB_BELL_DEMOD_MAX_WINDOW                        (64)
+#endif
+
+// number of demodulated bytes kept until they are read
+#if !defined(RADIOLIB_BELL_DEMOD_BUFF_LEN)
+  #define RADIOLIB_BELL_DEMOD_BUFF_LEN                          (32)
+#endif
+
+// minimum number of samples per bit
+#define RADIOLIB_BELL_DEMOD_MIN_WINDOW                          (4)
+
+// number of correlator channels: in-phase and quadrature for mark and space
+#define RADIOLIB_BELL_DEMOD_NUM_CHANNELS                        (4)
+
+/*!
+  \class BellDemodulator
+  \brief Software demodulator for Bell modems, which turns audio samples (e.g., from an ADC,
+  or a recording) back into bits. Each tone is detected by a quadrature correlator over one bit period,
+  and the bit clock is recovered by a digital PLL that locks onto the tone transitions.
+  Everything is done in integer arithmetic, so it can run on devices without FPU.
+  The output can be passed directly to AX25Client::decode to receive 1200 baud packet radio.
+*/
+class BellDemodulator {
+  public:
+    /*!
+      \brief Default constructor.
+    */
+    BellDemodulator();
+
+    /*!
+      \brief Copy constructor.
+      \param demod BellDemodulator instance to copy.
+    */
+    BellDemodulator(const BellDemodulator& demod);
+
+    /*!
+      \brief Overload for assignment operator.
+      \param demod rvalue BellDemodulator.
+    */
+    BellDemodulator& operator=(const BellDemodulator& demod);
+
+    /*!
+      \brief Default destructor.
+    */
+    ~BellDemodulator();
+
+    /*!
+      \brief Initialization method.
+      \param modem Definition of the Bell modem to receive.
+      \param sampleRate Audio sample rate in Hz, must be more than twice the highest tone frequency.
+      \param reply Whether to receive the tones of the replying station.
+      \returns \ref status_codes
+    */
+    int16_t begin(const BellModem_t& modem, uint32_t sampleRate, bool reply = false);
+
+    /*!
+      \brief Process audio samples. Stops early if the output buffer is full, it has to be read out by read().
+      \param samples Signed 16-bit audio samples.
+      \param numSamples Number of samples.
+      \returns Number of samples processed.
+    */
+    size_t demodulate(const int16_t* samples, size_t numSamples);
+
+    /*!
+      \brief Get number of demodulated bytes that are ready to be read.
+      \returns Number of bytes.
+    */
+    size_t available();
+
+    /*!
+      \brief Read demodulated bits, mark as 1 and space as 0.
+      \param data Buffer to save the bits into, first bit in the MSB of the first byte.
+      \param len Size of the buffer.
+      \returns Number of bytes read.
+    */
+    size_t read(uint8_t* data, size_t len);
+
+    /*!
+      \brief Reset the demodulator, e.g. between unrelated recordings.
+    */
+    void reset();
+
+#if !RADIOLIB_GODMODE
+  private:
+#endif
+    // local oscillator phase accumulators and steps, upper 8 bits index the sine table
+    uint32_t phaseMark = 0;
+    uint32_t phaseSpace = 0;
+    uint32_t stepMark = 0;
+    uint32_t stepSpace = 0;
+
+    // last bit period of mixer outputs and their sums
+    #if !RADIOLIB_STATIC_ONLY
+      int32_t* window = NULL;
+    #else
+      int32_t window[RADIOLIB_BELL_DEMOD_NUM_CHANNELS*RADIOLIB_BELL_DEMOD_MAX_WINDOW];
+    #endif
+    size_t windowLen = 0;
+    size_t windowPos = 0;
+    int32_t sums[RADIOLIB_BELL_DEMOD_NUM_CHANNELS] = { 0 };
+
+    // bit clock, signed phase that wraps around in the middle of each bit
+    uint32_t pll = 0;
+    uint32_t pllStep = 0;
+    uint8_t level = 0;
+
+    // demodulated bytes
+    uint8_t byte = 0;
+    uint8_t bits = 0;
+    uint8_t buff[RADIOLIB_BELL_DEMOD_BUFF_LEN] = { 0 };
+    size_t buffHead = 0;
+    size_t buffLen = 0;
+};
+
+#endif
+
+#endif
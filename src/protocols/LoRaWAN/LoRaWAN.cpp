@@ -1,4 +1,5 @@
 #include "LoRaWAN.h"
+#include "../../utils/CRC.h"
 #include <string.h>
 #if defined(ESP_PLATFORM)
 #include "esp_attr.h"
@@ -14,6 +15,14 @@ LoRaWANNode::LoRaWANNode(PhysicalLayer* phy, const LoRaWANBand_t* band, uint8_t
   for(int i = 0; i < RADIOLIB_LORAWAN_NUM_SUPPORTED_PACKAGES; i++) {
     this->packages[i] = RADIOLIB_LORAWAN_PACKAGE_NONE;
   }
+  for(int i = 0; i < RADIOLIB_LORAWAN_TOA_CACHE_SIZE; i++) {
+    this->toaCache[i].dr = RADIOLIB_LORAWAN_DATA_RATE_UNUSED;
+  }
+  this->initChannelDrMasks();
+}
+
+LoRaWANNode::~LoRaWANNode() {
+  this->stopCycle();
 }
 
 #if defined(RADIOLIB_BUILD_ARDUINO)
@@ -67,6 +76,308 @@ int16_t LoRaWANNode::sendReceive(const uint8_t* dataUp, size_t lenUp, uint8_t fP
   if((lenUp > 0 && !dataUp) || !dataDown || !lenDown) {
     return(RADIOLIB_ERR_NULL_POINTER);
   }
+
+  // check whether the uplink can be sent at all
+  int16_t state = this->prepareUplink(lenUp, fPort);
+  RADIOLIB_ASSERT(state);
+
+  // the first 16 bytes are reserved for MIC calculation blocks
+  size_t uplinkMsgLen = RADIOLIB_LORAWAN_FRAME_LEN(lenUp, this->fOptsUpLen);
+  #if RADIOLIB_STATIC_ONLY
+  uint8_t uplinkMsg[RADIOLIB_STATIC_ARRAY_SIZE];
+  #else
+  uint8_t* uplinkMsg = new uint8_t[uplinkMsgLen];
+  #endif
+
+  // build the encrypted uplink message
+  this->buildUplink(dataUp, lenUp, uplinkMsg, fPort, isConfirmed);
+
+  // reset Time-on-Air as we are starting new uplink sequence
+  this->lastToA = 0;
+
+  // repeat uplink+downlink up to 'nbTrans' times (ADR)
+  uint8_t trans = 0;
+  for(; trans < this->nbTrans; trans++) {
+
+    // select a pair of Tx/Rx channels and generate the MIC
+    this->selectUplinkChannels(uplinkMsg, uplinkMsgLen);
+    
+    // send it (without the MIC calculation blocks)
+    state = this->transmitUplink(&this->channels[RADIOLIB_LORAWAN_UPLINK],
+                                &uplinkMsg[RADIOLIB_LORAWAN_FHDR_LEN_START_OFFS], 
+                                (uint8_t)(uplinkMsgLen - RADIOLIB_LORAWAN_FHDR_LEN_START_OFFS));
+    if(state != RADIOLIB_ERR_NONE) {
+      // sometimes, a spurious error can occur even though the uplink was transmitted
+      // therefore, just to be safe, increase frame counter by one for the next uplink
+      this->fCntUp += 1;
+
+      #if !RADIOLIB_STATIC_ONLY
+      delete[] uplinkMsg;
+      #endif
+      return(state);
+    }
+
+    // handle Rx windows - returns window > 0 if a downlink is received
+    state = this->receiveDownlink();
+
+    // if an error occured or a downlink was received, stop retransmission
+    if(state != RADIOLIB_ERR_NONE) {
+      break;
+    }
+    // if no downlink was received, go on
+
+    // When an end-device has requested an ACK from the Network but has not yet received it, 
+    // it SHALL wait RETRANSMIT_TIMEOUT seconds after RECEIVE_DELAY2 seconds have elapsed 
+    // after the end of the previous uplink transmission before sending a new uplink (repetition or new frame). 
+    // The RETRANSMIT_TIMEOUT delay is not required between unconfirmed uplinks, 
+    // or after the ACK has been successfully demodulated by the end-device.
+    if(isConfirmed) {
+      RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Retransmit timeout");
+      int min = RADIOLIB_LORAWAN_RETRANSMIT_TIMEOUT_MIN_MS;
+      int max = RADIOLIB_LORAWAN_RETRANSMIT_TIMEOUT_MAX_MS;
+      this->sleepDelay(min + rand() % (max - min));
+    }
+
+  } // end of transmission & reception
+
+  #if !RADIOLIB_STATIC_ONLY
+    delete[] uplinkMsg;
+  #endif
+
+  return(this->completeUplink(state, trans, fPort, isConfirmed, dataDown, lenDown, eventUp, eventDown));
+}
+
+int16_t LoRaWANNode::startSendReceive(const uint8_t* dataUp, size_t lenUp, uint8_t fPort, uint8_t* dataDown, size_t* lenDown, bool isConfirmed, LoRaWANEvent_t* eventUp, LoRaWANEvent_t* eventDown) {
+  if((lenUp > 0 && !dataUp) || !dataDown || !lenDown) {
+    return(RADIOLIB_ERR_NULL_POINTER);
+  }
+
+  // only one cycle can be in progress at a time
+  if(this->cycleState != RADIOLIB_LORAWAN_CYCLE_IDLE) {
+    return(RADIOLIB_ERR_UPLINK_UNAVAILABLE);
+  }
+
+  // the non-blocking cycle only handles Class A windows, which Class B devices open as well
+  if(this->lwClass == RADIOLIB_LORAWAN_CLASS_C || this->multicast == RADIOLIB_LORAWAN_CLASS_C) {
+    return(RADIOLIB_ERR_INVALID_MODE);
+  }
+
+  // check whether the uplink can be sent at all
+  int16_t state = this->prepareUplink(lenUp, fPort);
+  RADIOLIB_ASSERT(state);
+
+  // the message has to persist between calls to process()
+  this->cycleMsgLen = RADIOLIB_LORAWAN_FRAME_LEN(lenUp, this->fOptsUpLen);
+  #if RADIOLIB_STATIC_ONLY
+  if(this->cycleMsgLen > RADIOLIB_STATIC_ARRAY_SIZE) {
+    return(RADIOLIB_ERR_PACKET_TOO_LONG);
+  }
+  #else
+  this->cycleMsg = new uint8_t[this->cycleMsgLen];
+  RADIOLIB_ASSERT_PTR(this->cycleMsg);
+  #endif
+
+  // build the encrypted uplink message
+  this->buildUplink(dataUp, lenUp, this->cycleMsg, fPort, isConfirmed);
+
+  // reset Time-on-Air as we are starting new uplink sequence
+  this->lastToA = 0;
+
+  // save everything needed to finish the cycle
+  this->cycleFPort = fPort;
+  this->cycleConfirmed = isConfirmed;
+  this->cycleTrans = 0;
+  this->cycleDataDown = dataDown;
+  this->cycleLenDown = lenDown;
+  this->cycleEventUp = eventUp;
+  this->cycleEventDown = eventDown;
+
+  // the transmission itself is started at the scheduled uplink time
+  this->cycleState = RADIOLIB_LORAWAN_CYCLE_TX_PENDING;
+  this->cycleDeadline = this->tUplink - this->launchDuration;
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t LoRaWANNode::process() {
+  Module* mod = this->phyLayer->getMod();
+  int16_t state = RADIOLIB_ERR_NONE;
+  RadioLibTime_t tNow = mod->hal->millis();
+
+  switch(this->cycleState) {
+    case(RADIOLIB_LORAWAN_CYCLE_IDLE):
+      return(RADIOLIB_ERR_NONE);
+
+    case(RADIOLIB_LORAWAN_CYCLE_TX_PENDING): {
+      if(tNow < this->cycleDeadline) {
+        return(RADIOLIB_LORAWAN_CYCLE_PENDING);
+      }
+
+      // select a pair of Tx/Rx channels and generate the MIC
+      // note that if CSMA is enabled, the channel activity detection itself is still blocking
+      this->selectUplinkChannels(this->cycleMsg, this->cycleMsgLen);
+
+      // send it (without the MIC calculation blocks)
+      state = this->stageUplink(&this->channels[RADIOLIB_LORAWAN_UPLINK],
+                                &this->cycleMsg[RADIOLIB_LORAWAN_FHDR_LEN_START_OFFS],
+                                (uint8_t)(this->cycleMsgLen - RADIOLIB_LORAWAN_FHDR_LEN_START_OFFS),
+                                &this->cycleToA);
+      if(state == RADIOLIB_ERR_NONE) {
+        state = this->launchUplink();
+      }
+      if(state != RADIOLIB_ERR_NONE) {
+        // same as the blocking version, increase frame counter just to be safe
+        this->fCntUp += 1;
+        this->stopCycle();
+        return(state);
+      }
+
+      // wait for the transmission to finish, plus the same timeout period as the blocking version
+      this->cycleState = RADIOLIB_LORAWAN_CYCLE_TX_ACTIVE;
+      this->cycleDeadline = mod->hal->millis() + this->cycleToA + this->scanGuard;
+      return(RADIOLIB_LORAWAN_CYCLE_PENDING);
+    }
+
+    case(RADIOLIB_LORAWAN_CYCLE_TX_ACTIVE): {
+      if(!mod->hal->digitalRead(mod->getIrq())) {
+        if(tNow > this->cycleDeadline) {
+          this->fCntUp += 1;
+          this->stopCycle();
+          return(RADIOLIB_ERR_TX_TIMEOUT);
+        }
+        return(RADIOLIB_LORAWAN_CYCLE_PENDING);
+      }
+
+      state = this->finishUplink(this->cycleToA);
+      if(state != RADIOLIB_ERR_NONE) {
+        this->fCntUp += 1;
+        this->stopCycle();
+        return(state);
+      }
+
+      // configure the radio for Rx1 right away, the window is only opened at the deadline
+      return(this->stageCycleWindow(RADIOLIB_LORAWAN_RX1));
+    }
+
+    case(RADIOLIB_LORAWAN_CYCLE_RX1_PENDING):
+    case(RADIOLIB_LORAWAN_CYCLE_RX2_PENDING): {
+      if(tNow < this->cycleDeadline) {
+        return(RADIOLIB_LORAWAN_CYCLE_PENDING);
+      }
+
+      // the window is padded by scanGuard, so being a bit late is still fine
+      uint8_t window = (this->cycleState == RADIOLIB_LORAWAN_CYCLE_RX1_PENDING) ? RADIOLIB_LORAWAN_RX1 : RADIOLIB_LORAWAN_RX2;
+      if(tNow > this->cycleDeadline + this->scanGuard / 2) {
+        RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Window too late by %lu ms", (unsigned long)(tNow - this->cycleDeadline));
+        return(this->finishCycle(RADIOLIB_ERR_NO_RX_WINDOW));
+      }
+
+      state = this->launchRxWindow(window, &this->cycleRxOpen);
+      if(state != RADIOLIB_ERR_NONE) {
+        return(this->finishCycle(state));
+      }
+      RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Rx%d window open (%lu + %lu ms)", window, this->cycleRxTimeout, this->scanGuard);
+      this->cycleState++;
+      this->cycleRxBusy = false;
+      this->cycleDeadline = this->cycleRxOpen + this->cycleRxTimeout + this->scanGuard;
+      return(RADIOLIB_LORAWAN_CYCLE_PENDING);
+    }
+
+    case(RADIOLIB_LORAWAN_CYCLE_RX1_ACTIVE):
+    case(RADIOLIB_LORAWAN_CYCLE_RX2_ACTIVE): {
+      uint8_t window = (this->cycleState == RADIOLIB_LORAWAN_CYCLE_RX1_ACTIVE) ? RADIOLIB_LORAWAN_RX1 : RADIOLIB_LORAWAN_RX2;
+
+      // the IRQ pin is only mapped to RxDone, so a high pin means a downlink was received
+      // this is polled instead of using the shared interrupt flag, so that multiple nodes can run side by side
+      bool received = mod->hal->digitalRead(mod->getIrq());
+      if(!received) {
+        if(tNow <= this->cycleDeadline) {
+          return(RADIOLIB_LORAWAN_CYCLE_PENDING);
+        }
+
+        // the padded window has passed, check whether the radio timed out or is still receiving
+        if(!this->cycleRxBusy) {
+          int16_t timedOut = this->phyLayer->checkIrq(RADIOLIB_IRQ_TIMEOUT);
+          if(timedOut == RADIOLIB_ERR_UNSUPPORTED) {
+            this->stopCycle();
+            return(timedOut);
+          }
+
+          // something is being received, so keep listening for maximum ToA
+          if(!timedOut) {
+            this->cycleRxBusy = true;
+            this->cycleDeadline = this->cycleRxOpen + this->cycleRxMaxToA + this->scanGuard;
+            return(RADIOLIB_LORAWAN_CYCLE_PENDING);
+          }
+        } else {
+          // some modules finish reception without raising the pin in time, check the flag directly
+          received = (this->phyLayer->checkIrq(RADIOLIB_IRQ_RX_DONE) == 1);
+          if(!received) {
+            RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Downlink missing!");
+          }
+        }
+      }
+
+      state = this->closeRxWindow(window, this->cycleMaxPayLen, received);
+      if(state != 0) {
+        // downlink received, or an error occured
+        return(this->finishCycle(state));
+      }
+
+      // nothing in Rx1, go on to Rx2
+      if(window == RADIOLIB_LORAWAN_RX1) {
+        return(this->stageCycleWindow(RADIOLIB_LORAWAN_RX2));
+      }
+
+      // nothing in Rx2 either, check if retransmission should occur
+      this->cycleTrans++;
+      if(this->cycleTrans >= this->nbTrans) {
+        return(this->finishCycle(0));
+      }
+      this->cycleState = RADIOLIB_LORAWAN_CYCLE_TX_PENDING;
+      this->cycleDeadline = mod->hal->millis();
+      if(this->cycleConfirmed) {
+        // see sendReceive() for details about the retransmit timeout
+        RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Retransmit timeout");
+        int min = RADIOLIB_LORAWAN_RETRANSMIT_TIMEOUT_MIN_MS;
+        int max = RADIOLIB_LORAWAN_RETRANSMIT_TIMEOUT_MAX_MS;
+        this->cycleDeadline += min + rand() % (max - min);
+      }
+      return(RADIOLIB_LORAWAN_CYCLE_PENDING);
+    }
+
+    default:
+      break;
+  }
+
+  return(RADIOLIB_ERR_UNKNOWN);
+}
+
+RadioLibTime_t LoRaWANNode::getNextDeadline() {
+  if(this->cycleState == RADIOLIB_LORAWAN_CYCLE_IDLE) {
+    return(0);
+  }
+  return(this->cycleDeadline);
+}
+
+void LoRaWANNode::cancelSendReceive() {
+  if(this->cycleState == RADIOLIB_LORAWAN_CYCLE_IDLE) {
+    return;
+  }
+
+  // once the uplink was transmitted, its frame counter must not be used again
+  if((this->cycleState != RADIOLIB_LORAWAN_CYCLE_TX_PENDING) || (this->cycleTrans > 0)) {
+    this->fCntUp += 1;
+  }
+
+  // the radio may still be transmitting or listening
+  if(this->cycleState != RADIOLIB_LORAWAN_CYCLE_TX_PENDING) {
+    this->phyLayer->clearIrq(RADIOLIB_IRQ_RX_DEFAULT_FLAGS | (1UL << RADIOLIB_IRQ_TX_DONE));
+    this->phyLayer->standby();
+  }
+  this->stopCycle();
+}
+
+int16_t LoRaWANNode::prepareUplink(size_t lenUp, uint8_t fPort) {
   int16_t state = RADIOLIB_ERR_UNKNOWN;
   
   // if after (at) ADR_ACK_LIMIT frames no RekeyConf was received, revert to Join state
@@ -82,6 +393,14 @@ int16_t LoRaWANNode::sendReceive(const uint8_t* dataUp, size_t lenUp, uint8_t fP
     return(RADIOLIB_ERR_NETWORK_NOT_JOINED);
   }
 
+  // Class A takes priority over Class B, so release the radio if a beacon or ping slot window is using it
+  if(this->classBState == RADIOLIB_LORAWAN_CLASS_B_SEARCH) {
+    this->abortClassBWindow();
+    this->classBDeadline = 0;
+  } else if(this->classBState >= RADIOLIB_LORAWAN_CLASS_B_STAGED) {
+    this->abortClassBWindow();
+  }
+
   Module *mod = this->phyLayer->getMod();
   RadioLibTime_t tNow = mod->hal->millis();
   // if scheduled uplink time is in the past, reschedule to now
@@ -91,7 +410,7 @@ int16_t LoRaWANNode::sendReceive(const uint8_t* dataUp, size_t lenUp, uint8_t fP
 
   // if dutycycle is enabled and the time since last uplink + interval has not elapsed, return an error
   if(this->dutyCycleEnabled) {
-    if(this->tUplinkEnd + (RadioLibTime_t)dutyCycleInterval(this->dutyCycle, this->lastToA) > this->tUplink) {
+    if(this->getNextUplinkTime() > this->tUplink) {
       return(RADIOLIB_ERR_UPLINK_UNAVAILABLE);
     }
   }
@@ -108,13 +427,13 @@ int16_t LoRaWANNode::sendReceive(const uint8_t* dataUp, size_t lenUp, uint8_t fP
   memset(this->fOptsDown, 0, RADIOLIB_LORAWAN_FHDR_FOPTS_MAX_LEN);
   this->fOptsDownLen = 0;
 
-  // the first 16 bytes are reserved for MIC calculation blocks
-  size_t uplinkMsgLen = RADIOLIB_LORAWAN_FRAME_LEN(lenUp, this->fOptsUpLen);
+  return(RADIOLIB_ERR_NONE);
+}
+
+void LoRaWANNode::buildUplink(const uint8_t* dataUp, size_t lenUp, uint8_t* uplinkMsg, uint8_t fPort, bool isConfirmed) {
   #if RADIOLIB_STATIC_ONLY
-  uint8_t uplinkMsg[RADIOLIB_STATIC_ARRAY_SIZE];
   uint8_t frmPayload[RADIOLIB_STATIC_ARRAY_SIZE];
   #else
-  uint8_t* uplinkMsg = new uint8_t[uplinkMsgLen];
   uint8_t* frmPayload = new uint8_t[lenUp + this->fOptsUpLen];
   #endif
 
@@ -139,71 +458,33 @@ int16_t LoRaWANNode::sendReceive(const uint8_t* dataUp, size_t lenUp, uint8_t fP
   // build the encrypted uplink message
   this->composeUplink(frmPayload, frmLen, uplinkMsg, fPort, isConfirmed);
 
-  // reset Time-on-Air as we are starting new uplink sequence
-  this->lastToA = 0;
-
-  // repeat uplink+downlink up to 'nbTrans' times (ADR)
-  uint8_t trans = 0;
-  for(; trans < this->nbTrans; trans++) {
-
-    // keep track of number of hopped channels
-    uint8_t numHops = this->maxChanges;
-
-    // number of additional CAD tries
-    uint8_t numBackoff = 0;
-    if(this->backoffMax) {
-      numBackoff = 1 + rand() % this->backoffMax;
-    }
-
-    do {
-      // select a pair of Tx/Rx channels for uplink+downlink
-      this->selectChannels();
-
-      // generate and set uplink MIC (depends on selected channel)
-      this->micUplink(uplinkMsg, uplinkMsgLen);
-
-    // if CSMA is enabled, repeat channel selection & encryption up to numHops times
-    } while(this->csmaEnabled && numHops-- > 0 && !this->csmaChannelClear(this->difsSlots, numBackoff));
-    
-    // send it (without the MIC calculation blocks)
-    state = this->transmitUplink(&this->channels[RADIOLIB_LORAWAN_UPLINK],
-                                &uplinkMsg[RADIOLIB_LORAWAN_FHDR_LEN_START_OFFS], 
-                                (uint8_t)(uplinkMsgLen - RADIOLIB_LORAWAN_FHDR_LEN_START_OFFS));
-    if(state != RADIOLIB_ERR_NONE) {
-      // sometimes, a spurious error can occur even though the uplink was transmitted
-      // therefore, just to be safe, increase frame counter by one for the next uplink
-      this->fCntUp += 1;
+  #if !RADIOLIB_STATIC_ONLY
+  delete[] frmPayload;
+  #endif
+}
 
-      #if !RADIOLIB_STATIC_ONLY
-      delete[] uplinkMsg;
-      delete[] frmPayload;
-      #endif
-      return(state);
-    }
+void LoRaWANNode::selectUplinkChannels(uint8_t* uplinkMsg, size_t uplinkMsgLen) {
+  // keep track of number of hopped channels
+  uint8_t numHops = this->maxChanges;
 
-    // handle Rx windows - returns window > 0 if a downlink is received
-    state = this->receiveDownlink();
+  // number of additional CAD tries
+  uint8_t numBackoff = 0;
+  if(this->backoffMax) {
+    numBackoff = 1 + rand() % this->backoffMax;
+  }
 
-    // if an error occured or a downlink was received, stop retransmission
-    if(state != RADIOLIB_ERR_NONE) {
-      break;
-    }
-    // if no downlink was received, go on
+  do {
+    // select a pair of Tx/Rx channels for uplink+downlink
+    this->selectChannels();
 
-    // When an end-device has requested an ACK from the Network but has not yet received it, 
-    // it SHALL wait RETRANSMIT_TIMEOUT seconds after RECEIVE_DELAY2 seconds have elapsed 
-    // after the end of the previous uplink transmission before sending a new uplink (repetition or new frame). 
-    // The RETRANSMIT_TIMEOUT delay is not required between unconfirmed uplinks, 
-    // or after the ACK has been successfully demodulated by the end-device.
-    if(isConfirmed) {
-      RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Retransmit timeout");
-      int min = RADIOLIB_LORAWAN_RETRANSMIT_TIMEOUT_MIN_MS;
-      int max = RADIOLIB_LORAWAN_RETRANSMIT_TIMEOUT_MAX_MS;
-      this->sleepDelay(min + rand() % (max - min));
-    }
+    // generate and set uplink MIC (depends on selected channel)
+    this->micUplink(uplinkMsg, uplinkMsgLen);
 
-  } // end of transmission & reception
+  // if CSMA is enabled, repeat channel selection & encryption up to numHops times
+  } while(this->csmaEnabled && numHops-- > 0 && !this->csmaChannelClear(this->difsSlots, numBackoff));
+}
 
+int16_t LoRaWANNode::completeUplink(int16_t state, uint8_t trans, uint8_t fPort, bool isConfirmed, uint8_t* dataDown, size_t* lenDown, LoRaWANEvent_t* eventUp, LoRaWANEvent_t* eventDown) {
   // note: if an error occurred, it may still be the case that a transmission occurred
   // therefore, we act as if a transmission occurred before throwing the actual error
   // this feels to be the best way to comply to spec
@@ -222,17 +503,13 @@ int16_t LoRaWANNode::sendReceive(const uint8_t* dataUp, size_t lenUp, uint8_t fP
     eventUp->datarate = this->channels[RADIOLIB_LORAWAN_UPLINK].dr;
     eventUp->freq = this->channels[RADIOLIB_LORAWAN_UPLINK].freq / 10000.0;
     eventUp->power = this->txPowerMax - this->txPowerSteps * 2;
+    eventUp->snr = 0;
     eventUp->fCnt = this->fCntUp;
     eventUp->fPort = fPort;
     eventUp->nbTrans = trans;
     eventUp->multicast = false;
   }
 
-  #if !RADIOLIB_STATIC_ONLY
-    delete[] uplinkMsg;
-    delete[] frmPayload;
-  #endif
-
   // if a hardware error occurred, return
   if(state < RADIOLIB_ERR_NONE) {
     return(state);
@@ -263,6 +540,35 @@ int16_t LoRaWANNode::sendReceive(const uint8_t* dataUp, size_t lenUp, uint8_t fP
   return(rxWindow);
 }
 
+int16_t LoRaWANNode::stageCycleWindow(uint8_t window) {
+  int16_t state = this->stageRxWindow(RADIOLIB_LORAWAN_DOWNLINK, &this->channels[window], 
+                                      &this->cycleRxTimeout, &this->cycleRxMaxToA, &this->cycleMaxPayLen);
+  if(state != RADIOLIB_ERR_NONE) {
+    return(this->finishCycle(state));
+  }
+  this->cycleRxTimeout /= 1000;
+
+  // calculate time at which the window should open, same as the blocking version
+  this->cycleState = (window == RADIOLIB_LORAWAN_RX1) ? RADIOLIB_LORAWAN_CYCLE_RX1_PENDING : RADIOLIB_LORAWAN_CYCLE_RX2_PENDING;
+  this->cycleDeadline = this->tUplinkEnd + this->rxDelays[window] - this->launchDuration - this->scanGuard / 2;
+  return(RADIOLIB_LORAWAN_CYCLE_PENDING);
+}
+
+int16_t LoRaWANNode::finishCycle(int16_t state) {
+  uint8_t trans = this->cycleTrans;
+  this->stopCycle();
+  return(this->completeUplink(state, trans, this->cycleFPort, this->cycleConfirmed, 
+                              this->cycleDataDown, this->cycleLenDown, this->cycleEventUp, this->cycleEventDown));
+}
+
+void LoRaWANNode::stopCycle() {
+  #if !RADIOLIB_STATIC_ONLY
+  delete[] this->cycleMsg;
+  this->cycleMsg = NULL;
+  #endif
+  this->cycleState = RADIOLIB_LORAWAN_CYCLE_IDLE;
+}
+
 void LoRaWANNode::clearNonces() {
   // clear & set all the device credentials
   memset(this->bufferNonces, 0, RADIOLIB_LORAWAN_NONCES_BUF_SIZE);
@@ -352,6 +658,7 @@ void LoRaWANNode::clearSession() {
   // reset all channels
   memset(this->channels, 0, sizeof(this->channels));
   memset(this->dynamicChannels, 0, sizeof(this->dynamicChannels));
+  this->initChannelDrMasks();
 
   // reset the JoinRequest datarate
   this->channels[RADIOLIB_LORAWAN_UPLINK].dr = RADIOLIB_LORAWAN_DATA_RATE_UNUSED;
@@ -373,6 +680,7 @@ void LoRaWANNode::createSession() {
         // copy the channels from the current channel plan
         this->dynamicChannels[RADIOLIB_LORAWAN_UPLINK][num] = this->band->txFreqs[num];
         this->dynamicChannels[RADIOLIB_LORAWAN_DOWNLINK][num] = this->band->txFreqs[num];
+        this->updateChannelDrMask(num);
       }
     }
   }
@@ -400,7 +708,7 @@ void LoRaWANNode::createSession() {
   cOcts[0] |= txSteps;
   (void)execMacCommand(cid, cOcts, cLen);
 
-  // set maximum dutycycle
+  // set maximum dutycycle, the sub-band limits (if the band defines them) apply on top of it
   cid = RADIOLIB_LORAWAN_MAC_DUTY_CYCLE;
   this->getMacLen(cid, &cLen, RADIOLIB_LORAWAN_DOWNLINK);
   uint8_t maxDCyclePower = 0;
@@ -532,6 +840,7 @@ int16_t LoRaWANNode::setBufferSession(const uint8_t* persistentBuffer) {
         // copy the channels from the current channel plan
         this->dynamicChannels[RADIOLIB_LORAWAN_UPLINK][num] = this->band->txFreqs[num];
         this->dynamicChannels[RADIOLIB_LORAWAN_DOWNLINK][num] = this->band->txFreqs[num];
+        this->updateChannelDrMask(num);
       }
     }
   }
@@ -934,7 +1243,7 @@ int16_t LoRaWANNode::activateOTAA(LoRaWANJoinEvent_t *joinEvent) {
 
   // if dutycycle is enabled and the time since last uplink + interval has not elapsed, return an error
   if(this->dutyCycleEnabled) {
-    if(this->tUplinkEnd + (RadioLibTime_t)dutyCycleInterval(this->dutyCycle, this->lastToA) > this->tUplink) {
+    if(this->getNextUplinkTime() > this->tUplink) {
       return(RADIOLIB_ERR_UPLINK_UNAVAILABLE);
     }
   }
@@ -1112,9 +1421,20 @@ int16_t LoRaWANNode::setClass(uint8_t cls) {
     return(RADIOLIB_ERR_UNSUPPORTED);
   }
 
-  // Class B is not implemented
+  // Class B needs the beacon, and is switched to directly for both LoRaWAN versions
+  // the network learns about it from the Class B bit in the uplink FCtrl field
   if(cls == RADIOLIB_LORAWAN_CLASS_B) {
-    return(RADIOLIB_ERR_UNSUPPORTED);
+    if(!this->beaconLocked) {
+      return(RADIOLIB_ERR_NO_BEACON);
+    }
+    this->lwClass = cls;
+
+    // pick up the ping slots that are still ahead in the current beacon period
+    if(this->classBState == RADIOLIB_LORAWAN_CLASS_B_PENDING) {
+      Module* mod = this->phyLayer->getMod();
+      return(this->scheduleClassB(mod->hal->millis()));
+    }
+    return(RADIOLIB_ERR_NONE);
   }
 
   // for LoRaWAN v1.0.4, simply switch class
@@ -1287,10 +1607,7 @@ void LoRaWANNode::adrBackoff() {
 
     // check if dwelltime limitation allows a lower datarate
     if(this->dwellTimeUp) {
-      const ModemType_t modem = this->band->dataRates[currentDr - 1].modem;
-      const DataRate_t* dr = &this->band->dataRates[currentDr - 1].dr;
-      const PacketConfig_t* pc = &this->band->dataRates[currentDr - 1].pc;
-      if(this->phyLayer->calculateTimeOnAir(modem, *dr, *pc, 13) / 1000 > this->dwellTimeUp) {
+      if(this->calculateTimeOnAir(currentDr - 1, 13) / 1000 > this->dwellTimeUp) {
         return;
       }
     } 
@@ -1336,6 +1653,9 @@ void LoRaWANNode::composeUplink(const uint8_t* in, uint8_t lenIn, uint8_t* out,
   LoRaWANNode::hton<uint32_t>(&out[RADIOLIB_LORAWAN_FHDR_DEV_ADDR_POS], this->devAddr);
 
   out[RADIOLIB_LORAWAN_FHDR_FCTRL_POS] = 0x00;
+  if(this->lwClass == RADIOLIB_LORAWAN_CLASS_B) {
+    out[RADIOLIB_LORAWAN_FHDR_FCTRL_POS] |= RADIOLIB_LORAWAN_FCTRL_CLASS_B;
+  }
   if(this->adrEnabled) {
     out[RADIOLIB_LORAWAN_FHDR_FCTRL_POS] |= RADIOLIB_LORAWAN_FCTRL_ADR_ENABLED;
     
@@ -1433,33 +1753,11 @@ void LoRaWANNode::micUplink(uint8_t* inOut, size_t lenInOut) {
 }
 
 int16_t LoRaWANNode::transmitUplink(const LoRaWANChannel_t* chnl, uint8_t* in, uint8_t len) {
-  int16_t state = RADIOLIB_ERR_UNKNOWN;
   Module* mod = this->phyLayer->getMod();
 
-  const uint8_t currentDr = this->channels[RADIOLIB_LORAWAN_UPLINK].dr;
-  const ModemType_t modem = this->band->dataRates[currentDr].modem;
-  const DataRate_t* dr = &this->band->dataRates[currentDr].dr;
-  const PacketConfig_t* pc = &this->band->dataRates[currentDr].pc;
-  RadioLibTime_t toa = this->phyLayer->calculateTimeOnAir(modem, *dr, *pc, len) / 1000;
-
-  if(this->dwellTimeUp) {
-    if(toa > this->dwellTimeUp) {
-      RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Dwell time exceeded: ToA = %lu, max = %d", (unsigned long)toa, this->dwellTimeUp);
-      return(RADIOLIB_ERR_DWELL_TIME_EXCEEDED);
-    }
-  }
-
-  // set the physical layer configuration for uplink
-  state = this->setPhyProperties(chnl,
-                                 RADIOLIB_LORAWAN_UPLINK, 
-                                 this->txPowerMax - 2*this->txPowerSteps);
-  RADIOLIB_ASSERT(state);
-
-  RadioModeConfig_t modeCfg;
-  modeCfg.transmit.data = in;
-  modeCfg.transmit.len = len;
-  modeCfg.transmit.addr = 0;
-  state = this->phyLayer->stageMode(RADIOLIB_RADIO_MODE_TX, &modeCfg);
+  // configure the radio, but do not start transmitting yet
+  RadioLibTime_t toa = 0;
+  int16_t state = this->stageUplink(chnl, in, len, &toa);
   RADIOLIB_ASSERT(state);
   
   // if requested, wait until transmitting uplink
@@ -1472,15 +1770,7 @@ int16_t LoRaWANNode::transmitUplink(const LoRaWANChannel_t* chnl, uint8_t* in, u
     }
   }
 
-  if(this->ledPins[0] != RADIOLIB_NC) {
-    mod->hal->digitalWrite(this->ledPins[0], mod->hal->GpioLevelHigh);
-  }
-
-  // start transmission, and time the duration of launchMode() to offset window timing
-  RadioLibTime_t spiStart = mod->hal->millis();
-  state = this->phyLayer->launchMode();
-  RadioLibTime_t spiEnd = mod->hal->millis();
-  this->launchDuration = spiEnd - spiStart;
+  state = this->launchUplink();
   RADIOLIB_ASSERT(state);
 
   // sleep for the duration of the transmission
@@ -1496,7 +1786,55 @@ int16_t LoRaWANNode::transmitUplink(const LoRaWANChannel_t* chnl, uint8_t* in, u
       return(RADIOLIB_ERR_TX_TIMEOUT);
     }
   }
-  state = this->phyLayer->finishTransmit();
+
+  return(this->finishUplink(toa));
+}
+
+int16_t LoRaWANNode::stageUplink(const LoRaWANChannel_t* chnl, uint8_t* in, uint8_t len, RadioLibTime_t* toa) {
+  int16_t state = RADIOLIB_ERR_UNKNOWN;
+
+  const uint8_t currentDr = this->channels[RADIOLIB_LORAWAN_UPLINK].dr;
+  *toa = this->calculateTimeOnAir(currentDr, len) / 1000;
+
+  if(this->dwellTimeUp) {
+    if(*toa > this->dwellTimeUp) {
+      RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Dwell time exceeded: ToA = %lu, max = %d", (unsigned long)*toa, this->dwellTimeUp);
+      return(RADIOLIB_ERR_DWELL_TIME_EXCEEDED);
+    }
+  }
+
+  // set the physical layer configuration for uplink
+  state = this->setPhyProperties(chnl,
+                                 RADIOLIB_LORAWAN_UPLINK, 
+                                 this->txPowerMax - 2*this->txPowerSteps);
+  RADIOLIB_ASSERT(state);
+
+  RadioModeConfig_t modeCfg;
+  modeCfg.transmit.data = in;
+  modeCfg.transmit.len = len;
+  modeCfg.transmit.addr = 0;
+  state = this->phyLayer->stageMode(RADIOLIB_RADIO_MODE_TX, &modeCfg);
+  return(state);
+}
+
+int16_t LoRaWANNode::launchUplink() {
+  Module* mod = this->phyLayer->getMod();
+
+  if(this->ledPins[0] != RADIOLIB_NC) {
+    mod->hal->digitalWrite(this->ledPins[0], mod->hal->GpioLevelHigh);
+  }
+
+  // start transmission, and time the duration of launchMode() to offset window timing
+  RadioLibTime_t spiStart = mod->hal->millis();
+  int16_t state = this->phyLayer->launchMode();
+  RadioLibTime_t spiEnd = mod->hal->millis();
+  this->launchDuration = spiEnd - spiStart;
+  return(state);
+}
+
+int16_t LoRaWANNode::finishUplink(RadioLibTime_t toa) {
+  Module* mod = this->phyLayer->getMod();
+  int16_t state = this->phyLayer->finishTransmit();
 
   // set the timestamp so that we can measure when to start receiving
   this->tUplinkEnd = mod->hal->millis();
@@ -1509,6 +1847,7 @@ int16_t LoRaWANNode::transmitUplink(const LoRaWANChannel_t* chnl, uint8_t* in, u
 
   // increase Time on Air of the uplink sequence
   this->lastToA += toa;
+  this->recordDutyCycle(this->channels[RADIOLIB_LORAWAN_UPLINK].freq, this->tUplinkEnd, toa);
 
   return(state);
 }
@@ -1534,34 +1873,11 @@ int16_t LoRaWANNode::receiveClassA(uint8_t dir, const LoRaWANChannel_t* dlChanne
     return(RADIOLIB_ERR_NO_RX_WINDOW);
   }
 
-  const uint8_t currentDr = dlChannel->dr;
-  const ModemType_t modem = this->band->dataRates[currentDr].modem;
-  const DataRate_t* dr = &this->band->dataRates[currentDr].dr;
-  const PacketConfig_t* pc = &this->band->dataRates[currentDr].pc;
-  RadioLibTime_t toaMinUs = this->phyLayer->calculateTimeOnAir(modem, *dr, *pc, 0);
-
-  // get the maximum allowed Time-on-Air of a packet given the current datarate
-  uint8_t maxPayLen = this->band->payloadLenMax[dlChannel->dr];
-  if(this->packages[RADIOLIB_LORAWAN_PACKAGE_TS011].enabled) {
-    maxPayLen = RADIOLIB_MIN(maxPayLen, 222); // payload length is limited to 222 if under repeater
-  }
-  RadioLibTime_t toaMaxMs = this->phyLayer->calculateTimeOnAir(modem, *dr, *pc, maxPayLen + 13) / 1000;
-
-  // set the physical layer configuration for downlink
-  state = this->setPhyProperties(dlChannel, dir, this->txPowerMax - 2*this->txPowerSteps);
-  RADIOLIB_ASSERT(state);
-
-  // calculate the timeout of an empty packet plus scanGuard
-  RadioLibTime_t timeoutUs = toaMinUs + this->scanGuard*1000;
-
-  // set the radio Rx parameters
-  RadioModeConfig_t modeCfg;
-  modeCfg.receive.irqFlags = RADIOLIB_IRQ_RX_DEFAULT_FLAGS;
-  modeCfg.receive.irqMask = RADIOLIB_IRQ_RX_DEFAULT_MASK;
-  modeCfg.receive.len = 0;
-  modeCfg.receive.timeout = this->phyLayer->calculateRxTimeout(timeoutUs);
-
-  state = this->phyLayer->stageMode(RADIOLIB_RADIO_MODE_RX, &modeCfg);
+  // configure the radio, but do not open the window yet
+  RadioLibTime_t timeoutUs = 0;
+  RadioLibTime_t toaMaxMs = 0;
+  uint8_t maxPayLen = 0;
+  state = this->stageRxWindow(dir, dlChannel, &timeoutUs, &toaMaxMs, &maxPayLen);
   RADIOLIB_ASSERT(state);
 
   // setup interrupt
@@ -1582,13 +1898,9 @@ int16_t LoRaWANNode::receiveClassA(uint8_t dir, const LoRaWANChannel_t* dlChanne
     this->sleepDelay(tWindow - tNow);
   }
 
-  if(window < 4 && this->ledPins[window] != RADIOLIB_NC) {
-    mod->hal->digitalWrite(this->ledPins[window], mod->hal->GpioLevelHigh);
-  }
-
   // open Rx window by starting receive with specified timeout
-  state = this->phyLayer->launchMode();
-  RadioLibTime_t tOpen = mod->hal->millis();
+  RadioLibTime_t tOpen = 0;
+  state = this->launchRxWindow(window, &tOpen);
   RADIOLIB_ASSERT(state);
   RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Rx%d window open (%lu + %lu ms)", window, timeoutUs / 1000UL, this->scanGuard);
   
@@ -1610,13 +1922,7 @@ int16_t LoRaWANNode::receiveClassA(uint8_t dir, const LoRaWANChannel_t* dlChanne
 
   // if the IRQ bit for RxTimeout is set, put chip in standby and return
   if(timedOut) {
-    this->phyLayer->clearPacketReceivedAction();
-    this->phyLayer->clearIrq(1UL << RADIOLIB_IRQ_TIMEOUT);
-    this->phyLayer->standby();
-    if(window < 4 && this->ledPins[window] != RADIOLIB_NC) {
-      mod->hal->digitalWrite(this->ledPins[window], mod->hal->GpioLevelLow);
-    }
-    return(0);  // no downlink
+    return(this->closeRxWindow(window, maxPayLen, false));  // no downlink
   }
   
   // if the IRQ bit for RxTimeout is not set, something is being received, 
@@ -1637,24 +1943,85 @@ int16_t LoRaWANNode::receiveClassA(uint8_t dir, const LoRaWANChannel_t* dlChanne
     }
   }
 
+  // if all windows passed without receiving anything, return 0 for no window
+  bool received = downlinkAction;
+  downlinkAction = false;
+  if(!received) {
+    RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Downlink missing!");
+  }
+  return(this->closeRxWindow(window, maxPayLen, received));
+}
+
+int16_t LoRaWANNode::stageRxWindow(uint8_t dir, const LoRaWANChannel_t* dlChannel, RadioLibTime_t* timeoutUs, RadioLibTime_t* toaMaxMs, uint8_t* maxPayLen, RadioLibTime_t widenUs) {
+  const uint8_t currentDr = dlChannel->dr;
+  RadioLibTime_t toaMinUs = this->calculateTimeOnAir(currentDr, 0);
+
+  // get the maximum allowed Time-on-Air of a packet given the current datarate
+  *maxPayLen = this->band->payloadLenMax[dlChannel->dr];
+  if(this->packages[RADIOLIB_LORAWAN_PACKAGE_TS011].enabled) {
+    *maxPayLen = RADIOLIB_MIN(*maxPayLen, 222); // payload length is limited to 222 if under repeater
+  }
+  *toaMaxMs = this->calculateTimeOnAir(currentDr, *maxPayLen + 13) / 1000;
+
+  // set the physical layer configuration for downlink
+  int16_t state = this->setPhyProperties(dlChannel, dir, this->txPowerMax - 2*this->txPowerSteps);
+  RADIOLIB_ASSERT(state);
+
+  // Class B windows are widened for clock drift and, as they are only 30 ms apart, only wait for the LoRa preamble
+  if(widenUs > 0 && this->band->dataRates[currentDr].modem == RADIOLIB_MODEM_LORA) {
+    const DataRate_t* dr = &this->band->dataRates[currentDr].dr;
+    RadioLibTime_t symbolUs = ((uint32_t)1 << dr->lora.spreadingFactor) * 1000UL / dr->lora.bandwidth;
+    toaMinUs = symbolUs * (4*RADIOLIB_LORAWAN_LORA_PREAMBLE_LEN + 17) / 4;
+  }
+
+  // calculate the timeout of an empty packet plus scanGuard, widened on both sides
+  *timeoutUs = toaMinUs + this->scanGuard*1000 + 2*widenUs;
+
+  // set the radio Rx parameters
+  RadioModeConfig_t modeCfg;
+  modeCfg.receive.irqFlags = RADIOLIB_IRQ_RX_DEFAULT_FLAGS;
+  modeCfg.receive.irqMask = RADIOLIB_IRQ_RX_DEFAULT_MASK;
+  modeCfg.receive.len = 0;
+  modeCfg.receive.timeout = this->phyLayer->calculateRxTimeout(*timeoutUs);
+
+  state = this->phyLayer->stageMode(RADIOLIB_RADIO_MODE_RX, &modeCfg);
+  return(state);
+}
+
+int16_t LoRaWANNode::launchRxWindow(uint8_t window, RadioLibTime_t* tOpen) {
+  Module* mod = this->phyLayer->getMod();
+
+  if(window < 4 && this->ledPins[window] != RADIOLIB_NC) {
+    mod->hal->digitalWrite(this->ledPins[window], mod->hal->GpioLevelHigh);
+  }
+
+  // open Rx window by starting receive with specified timeout
+  int16_t state = this->phyLayer->launchMode();
+  *tOpen = mod->hal->millis();
+  return(state);
+}
+
+int16_t LoRaWANNode::closeRxWindow(uint8_t window, uint8_t maxPayLen, bool received) {
+  Module* mod = this->phyLayer->getMod();
+
   // update time of downlink reception
-  if(downlinkAction) {
+  if(received) {
     this->tDownlink = mod->hal->millis();
+  } else {
+    this->phyLayer->clearIrq(1UL << RADIOLIB_IRQ_TIMEOUT);
   }
 
-  // we have a message, clear actions, go to standby
+  // clear actions, go to standby
   this->phyLayer->clearPacketReceivedAction();
   this->phyLayer->standby();
   if(window < 4 && this->ledPins[window] != RADIOLIB_NC) {
     mod->hal->digitalWrite(this->ledPins[window], mod->hal->GpioLevelLow);
   }
 
-  // if all windows passed without receiving anything, return 0 for no window
-  if(!downlinkAction) {
-    RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Downlink missing!");
+  // nothing received, return 0 for no window
+  if(!received) {
     return(0);
   }
-  downlinkAction = false;
 
   // Any frame received by an end-device containing a MACPayload greater than 
   // the specified maximum length M over the data rate used to receive the frame 
@@ -2094,8 +2461,17 @@ int16_t LoRaWANNode::parseDownlink(uint8_t* data, size_t* len, uint8_t window, L
   if(fOptsLen > 0) {
     uint8_t* mPtr = fOptsPtr;
     uint8_t procLen = 0;
-    uint8_t fOptsRe[RADIOLIB_LORAWAN_MAX_PAYLOAD_SIZE] = { 0 };
+
+    // answers are written straight into the uplink queue, and only moved to a larger buffer
+    // if they do not fit into FOpts - in which case a MAC-only uplink will be sent
+    uint8_t fOptsSpill[RADIOLIB_LORAWAN_MAX_PAYLOAD_SIZE];
+    uint8_t* fOptsRe = this->fOptsUp;
+    uint8_t fOptsReMax = RADIOLIB_LORAWAN_FHDR_FOPTS_MAX_LEN;
     uint8_t fOptsReLen = 0;
+    this->fOptsUpLen = 0;
+
+    // user-accessible commands are kept for retrieval as they are walked, no second pass needed
+    this->fOptsDownLen = 0;
 
     // indication whether LinkAdr MAC command has been processed
     bool mAdr = false;
@@ -2110,7 +2486,6 @@ int16_t LoRaWANNode::parseDownlink(uint8_t* data, size_t* len, uint8_t window, L
       if(state != RADIOLIB_ERR_NONE) {
         RADIOLIB_DEBUG_PROTOCOL_PRINTLN("WARNING: Unknown MAC CID %02x", cid);
         RADIOLIB_DEBUG_PROTOCOL_PRINTLN("WARNING: Skipping remaining MAC payload");
-        fOptsLen = procLen; // truncate to last processed MAC command
         break;
       }
       (void)this->getMacLen(cid, &fLenRe, RADIOLIB_LORAWAN_UPLINK, true);
@@ -2119,36 +2494,43 @@ int16_t LoRaWANNode::parseDownlink(uint8_t* data, size_t* len, uint8_t window, L
       if(procLen + fLen > fOptsLen) {
         RADIOLIB_DEBUG_PROTOCOL_PRINTLN("WARNING: Incomplete MAC command %02x (%d bytes, expected %d)", cid, fOptsLen - procLen, fLen);
         RADIOLIB_DEBUG_PROTOCOL_PRINTLN("WARNING: Skipping remaining MAC payload");
-        fOptsLen = procLen; // truncate to last processed MAC command
         break;
       }
 
-      bool reply = false;
+      // if this is a LinkAdr MAC command, contiguous commands are processed as one atomic block
+      bool adrBlock = (cid == RADIOLIB_LORAWAN_MAC_LINK_ADR) && !mAdr;
+      if(adrBlock) {
+        while(procLen + fLen + 5 < fOptsLen + 1 && *(mPtr + fLen) == RADIOLIB_LORAWAN_MAC_LINK_ADR) {
+          fLen += 5;    // ADR command is 5 bytes
+          fLenRe += 2;  // ADR response is 2 bytes
+        }
+      }
+
+      // move the answers out of the uplink queue once they no longer fit
+      if((fOptsRe == this->fOptsUp) && (fOptsReLen + fLenRe > fOptsReMax)) {
+        memcpy(fOptsSpill, this->fOptsUp, fOptsReLen);
+        fOptsRe = fOptsSpill;
+        fOptsReMax = RADIOLIB_LORAWAN_MAX_PAYLOAD_SIZE;
+      }
 
-      // if this is a LinkAdr MAC command, pre-process contiguous commands into one atomic block
+      bool reply = false;
+      uint8_t* optOut = &fOptsRe[fOptsReLen + 1];
       if(cid == RADIOLIB_LORAWAN_MAC_LINK_ADR) {
         // if there was any LinkAdr command before, set NACK and continue without processing
-        if(mAdr) {
+        if(!adrBlock) {
           reply = true;
-          fOptsRe[fOptsReLen + 1] = 0x00;
+          *optOut = 0x00;
 
         // if this is the first LinkAdr command, do some special treatment:
         } else {
           mAdr = true;
-          uint8_t fAdrLen = 5;
           uint8_t mAdrOpt[14] = { 0 };
 
-          // retrieve all contiguous LinkAdr commands
-          while(procLen + fLen + fAdrLen < fOptsLen + 1 && *(mPtr + fLen) == RADIOLIB_LORAWAN_MAC_LINK_ADR) {
-            fLen += 5;    // ADR command is 5 bytes
-            fLenRe += 2;  // ADR response is 2 bytes
-          }
-
           // pre-process them into a single complete channel mask (stored in mAdrOpt)
           LoRaWANNode::preprocessMacLinkAdr(mPtr, fLen, mAdrOpt);
 
           // execute like a normal MAC command (but pointing to mAdrOpt instead)
-          reply = this->execMacCommand(cid, mAdrOpt, 14, &fOptsRe[fOptsReLen + 1]);
+          reply = this->execMacCommand(cid, mAdrOpt, 14, optOut);
 
           // in LoRaWAN v1.0.x, all ACK bytes should have equal status - fix in post-processing
           if(this->rev == 0) {
@@ -2162,27 +2544,31 @@ int16_t LoRaWANNode::parseDownlink(uint8_t* data, size_t* len, uint8_t window, L
 
       // MAC command other than LinkAdr, just process the payload
       } else {
-        reply = this->execMacCommand(cid, mPtr + 1, fLen - 1, &fOptsRe[fOptsReLen + 1]);
+        reply = this->execMacCommand(cid, mPtr + 1, fLen - 1, optOut);
       }
 
-      // if there is a reply, add it to the response payload
       if(reply) {
         fOptsRe[fOptsReLen] = cid;
         fOptsReLen += fLenRe;
+      } else if((fOptsRe == this->fOptsUp) && (this->fOptsUpLen > fOptsReLen)) {
+        // the command queued an uplink command by itself (e.g. ResetInd retransmission)
+        fOptsReLen = this->fOptsUpLen;
+      }
+      if(fOptsRe == this->fOptsUp) {
+        this->fOptsUpLen = fOptsReLen;
+      }
+
+      // keep the commands whose payload can be requested by the user (which are LinkCheck and DeviceTime)
+      if(this->isPersistentMacCommand(cid, RADIOLIB_LORAWAN_DOWNLINK) && 
+         (this->fOptsDownLen + fLen <= RADIOLIB_LORAWAN_FHDR_FOPTS_MAX_LEN)) {
+        memcpy(&this->fOptsDown[this->fOptsDownLen], mPtr, fLen);
+        this->fOptsDownLen += fLen;
       }
 
       procLen += fLen;
       mPtr += fLen;
     }
 
-    // remove all MAC commands except those whose payload can be requested by the user
-    // (which are LinkCheck and DeviceTime)  
-    LoRaWANNode::clearMacCommands(fOptsPtr, &fOptsLen, RADIOLIB_LORAWAN_DOWNLINK);
-
-    // copy over the remaining FOpts from the downlink to an internal buffer
-    this->fOptsDownLen = fOptsLen;
-    memcpy(this->fOptsDown, fOptsPtr, this->fOptsDownLen);
-
     // if fOptsLen for the next uplink is larger than can be piggybacked onto an uplink, send separate uplink
     if(fOptsReLen > RADIOLIB_LORAWAN_FHDR_FOPTS_MAX_LEN) {
       this->isMACPayload = true;
@@ -2216,83 +2602,620 @@ int16_t LoRaWANNode::parseDownlink(uint8_t* data, size_t* len, uint8_t window, L
       RADIOLIB_DEBUG_PROTOCOL_PRINTLN("! Sending MAC-only uplink (%d bytes):", fOptsReLen);
       RADIOLIB_DEBUG_PROTOCOL_HEXDUMP(fOptsRe, fOptsReLen);
 
-      // temporarily lift dutyCycle restrictions to allow immediate MAC response
-      bool prevDC = this->dutyCycleEnabled;
-      this->dutyCycleEnabled = false;
-      this->sendReceive(fOptsRe, fOptsReLen, RADIOLIB_LORAWAN_FPORT_MAC_COMMAND);
-      this->dutyCycleEnabled = prevDC;
+      // the answers go out as payload, so nothing may be piggy-backed
+      if(fOptsRe == this->fOptsUp) {
+        memcpy(fOptsSpill, this->fOptsUp, fOptsReLen);
+        fOptsRe = fOptsSpill;
+      }
+      this->fOptsUpLen = 0;
+
+      // temporarily lift dutyCycle restrictions to allow immediate MAC response
+      bool prevDC = this->dutyCycleEnabled;
+      this->dutyCycleEnabled = false;
+      this->sendReceive(fOptsRe, fOptsReLen, RADIOLIB_LORAWAN_FPORT_MAC_COMMAND);
+      this->dutyCycleEnabled = prevDC;
+    }
+  }
+
+  // by default, the data and length are user-accessible
+  *len = payLen;
+
+  // however, if this frame belongs to an application package, 
+  // redirect instead and 'hide' contents from the user
+  // just to be sure that it doesn't get re-interpreted...
+  for(int id = 0; id < RADIOLIB_LORAWAN_NUM_SUPPORTED_PACKAGES; id++) {
+    if(this->packages[id].enabled && this->packages[id].isAppPack && fPort == this->packages[id].packFPort) {
+      this->packages[id].callback(data, *len);
+      memset(data, 0, *len);
+      *len = 0;
+    }
+  }
+
+  // pass the event info if requested
+  if(event) {
+    event->dir = RADIOLIB_LORAWAN_DOWNLINK;
+    event->confirmed = isConfirmedDown;
+    event->confirming = isConfirmingUp;
+    event->frmPending = (downlinkMsg[RADIOLIB_LORAWAN_FHDR_FCTRL_POS] & RADIOLIB_LORAWAN_FCTRL_FRAME_PENDING) != 0;
+    event->datarate = this->channels[window].dr;
+    event->freq = this->channels[window].freq / 10000.0;
+    event->power = this->phyLayer->getRSSI();
+    event->snr = this->phyLayer->getSNR();
+    event->fCnt = devFCnt32;
+    event->fPort = fPort;
+    event->multicast = (bool)this->multicast;
+  }
+
+  #if !RADIOLIB_STATIC_ONLY
+    delete[] downlinkMsg;
+  #endif
+
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t LoRaWANNode::getDownlinkClassC(uint8_t* dataDown, size_t* lenDown, LoRaWANEvent_t* eventDown) {
+  // only allow if the device is Unicast-C or Multicast-C, otherwise ignore without error
+  if(this->lwClass != RADIOLIB_LORAWAN_CLASS_C && this->multicast != RADIOLIB_LORAWAN_CLASS_C) {
+    return(RADIOLIB_ERR_NONE);
+  }
+
+  int16_t state = RADIOLIB_ERR_NONE;
+
+  if(downlinkAction) {
+    state = this->parseDownlink(dataDown, lenDown, RADIOLIB_LORAWAN_RX_BC, eventDown);
+    downlinkAction = false;
+
+    // if downlink parsed successfully, set state to RxC window
+    if(state == RADIOLIB_ERR_NONE) {
+      state = RADIOLIB_LORAWAN_RX_BC;
+
+    // otherwise, if device is acting as Multicast on top of the same Unicast class,
+    // try decrypting it as a Unicast downlink by temporarily disabling Multicast
+    } else if(this->multicast == this->lwClass) {
+      this->multicast = false;
+      state = this->parseDownlink(dataDown, lenDown, RADIOLIB_LORAWAN_RX_BC, eventDown);
+      this->multicast = this->lwClass;
+      // if downlink parsed succesfully, set state to RxC window
+      if(state == RADIOLIB_ERR_NONE) {
+        state = RADIOLIB_LORAWAN_RX_BC;
+      }
+    }
+  }
+
+  return(state);
+}
+
+int16_t LoRaWANNode::acquireBeacon(RadioLibTime_t timeout) {
+  int16_t state = this->startBeaconAcquisition(timeout);
+  RADIOLIB_ASSERT(state);
+
+  // keep listening until the beacon is found or the search times out
+  Module* mod = this->phyLayer->getMod();
+  while(this->classBState == RADIOLIB_LORAWAN_CLASS_B_SEARCH) {
+    mod->hal->yield();
+    state = this->searchBeacon();
+  }
+  return(state);
+}
+
+int16_t LoRaWANNode::startBeaconAcquisition(RadioLibTime_t timeout) {
+  if(!this->isActivated()) {
+    return(RADIOLIB_ERR_NETWORK_NOT_JOINED);
+  }
+
+  // not all bands have a beacon
+  if(this->band->beacon.freqStart == 0) {
+    return(RADIOLIB_ERR_UNSUPPORTED);
+  }
+
+  // the radio is in use by an uplink/downlink cycle
+  if(this->cycleState != RADIOLIB_LORAWAN_CYCLE_IDLE) {
+    return(RADIOLIB_ERR_INVALID_MODE);
+  }
+
+  // drop any previous tracking, the search starts from scratch
+  this->stopBeaconTracking();
+
+  // the search listens on the first beacon channel only,
+  // so on hopping bands it may take a full sequence until the beacon appears there
+  if(timeout == 0) {
+    timeout = this->band->beacon.numChannels * RADIOLIB_LORAWAN_BEACON_PERIOD_MS + RADIOLIB_LORAWAN_BEACON_GUARD_MS;
+  }
+
+  this->beaconTime = 0;
+  int16_t state = this->stageBeaconWindow(0);
+  RADIOLIB_ASSERT(state);
+  state = this->phyLayer->launchMode();
+  RADIOLIB_ASSERT(state);
+
+  Module* mod = this->phyLayer->getMod();
+  this->classBState = RADIOLIB_LORAWAN_CLASS_B_SEARCH;
+  this->classBDeadline = mod->hal->millis() + timeout;
+  RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Beacon search started (%lu ms)", (unsigned long)timeout);
+  return(RADIOLIB_ERR_NONE);
+}
+
+void LoRaWANNode::stopBeaconTracking() {
+  if(this->classBState == RADIOLIB_LORAWAN_CLASS_B_SEARCH || this->classBState >= RADIOLIB_LORAWAN_CLASS_B_STAGED) {
+    this->abortClassBWindow();
+  }
+  this->classBState = RADIOLIB_LORAWAN_CLASS_B_IDLE;
+  this->beaconLocked = false;
+  this->beaconPeriodUs = RADIOLIB_LORAWAN_BEACON_PERIOD_MS*1000UL;
+  this->beaconMissed = 0;
+
+  // Class B cannot continue without the beacon
+  if(this->lwClass == RADIOLIB_LORAWAN_CLASS_B) {
+    RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Beacon lost, switching to Class A");
+    this->lwClass = RADIOLIB_LORAWAN_CLASS_A;
+  }
+}
+
+int16_t LoRaWANNode::processClassB(uint8_t* dataDown, size_t* lenDown, LoRaWANEvent_t* eventDown) {
+  Module* mod = this->phyLayer->getMod();
+  int16_t state = RADIOLIB_ERR_NONE;
+  RadioLibTime_t tNow = mod->hal->millis();
+
+  if(this->classBState == RADIOLIB_LORAWAN_CLASS_B_IDLE) {
+    return(RADIOLIB_ERR_NONE);
+  }
+
+  if(this->classBState == RADIOLIB_LORAWAN_CLASS_B_SEARCH) {
+    return(this->searchBeacon());
+  }
+
+  // the radio is only woken up shortly before the window, so that it can stay asleep in between
+  if(this->classBState == RADIOLIB_LORAWAN_CLASS_B_PENDING) {
+    if(tNow < this->classBDeadline) {
+      return(RADIOLIB_ERR_NONE);
+    }
+
+    // uplink/downlink cycles take priority, and the window padding only allows for a little lateness
+    // ping slots are also dropped once the device is no longer in Class B
+    if((this->cycleState != RADIOLIB_LORAWAN_CYCLE_IDLE) || (tNow > this->classBOpen + this->scanGuard / 2) ||
+       (!this->classBBeacon && (this->lwClass != RADIOLIB_LORAWAN_CLASS_B))) {
+      return(this->skipClassBWindow());
+    }
+
+    state = this->stageClassBWindow();
+    if(state != RADIOLIB_ERR_NONE) {
+      (void)this->skipClassBWindow();
+      return(state);
+    }
+    this->classBState = RADIOLIB_LORAWAN_CLASS_B_STAGED;
+    this->classBDeadline = this->classBOpen - this->launchDuration;
+  }
+
+  if(this->classBState == RADIOLIB_LORAWAN_CLASS_B_STAGED) {
+    if(tNow < this->classBDeadline) {
+      return(RADIOLIB_ERR_NONE);
+    }
+    if(tNow > this->classBOpen + this->scanGuard / 2) {
+      RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Window too late by %lu ms", (unsigned long)(tNow - this->classBOpen));
+      this->abortClassBWindow();
+      return(this->skipClassBWindow());
+    }
+
+    state = this->launchRxWindow(RADIOLIB_LORAWAN_RX_BC, &this->classBRxOpen);
+    if(state != RADIOLIB_ERR_NONE) {
+      this->abortClassBWindow();
+      (void)this->skipClassBWindow();
+      return(state);
+    }
+    RADIOLIB_DEBUG_PROTOCOL_PRINTLN("%s window open (%lu ms)", this->classBBeacon ? "Beacon" : "Ping slot", (unsigned long)this->classBRxTimeout);
+    this->classBState = RADIOLIB_LORAWAN_CLASS_B_ACTIVE;
+    this->classBRxBusy = false;
+    this->classBDeadline = this->classBRxOpen + this->classBRxTimeout + this->scanGuard;
+    return(RADIOLIB_ERR_NONE);
+  }
+
+  // same as the cycle, the IRQ pin is only mapped to RxDone
+  bool received = mod->hal->digitalRead(mod->getIrq());
+  if(!received) {
+    if(tNow <= this->classBDeadline) {
+      return(RADIOLIB_ERR_NONE);
+    }
+
+    // the padded window has passed, check whether the radio timed out or is still receiving
+    if(!this->classBRxBusy) {
+      int16_t timedOut = this->phyLayer->checkIrq(RADIOLIB_IRQ_TIMEOUT);
+      if(timedOut == RADIOLIB_ERR_UNSUPPORTED) {
+        this->abortClassBWindow();
+        (void)this->skipClassBWindow();
+        return(timedOut);
+      }
+      if(!timedOut) {
+        this->classBRxBusy = true;
+        this->classBDeadline = this->classBRxOpen + this->classBRxMaxToA + this->scanGuard;
+        return(RADIOLIB_ERR_NONE);
+      }
+    } else {
+      received = (this->phyLayer->checkIrq(RADIOLIB_IRQ_RX_DONE) == 1);
+    }
+  }
+
+  return(this->closeClassBWindow(received, dataDown, lenDown, eventDown));
+}
+
+RadioLibTime_t LoRaWANNode::getNextClassBDeadline() {
+  if(this->classBState == RADIOLIB_LORAWAN_CLASS_B_IDLE) {
+    return(0);
+  }
+  return(this->classBDeadline);
+}
+
+bool LoRaWANNode::isBeaconLocked() {
+  return(this->beaconLocked);
+}
+
+int16_t LoRaWANNode::getBeaconInfo(uint32_t* gpsTime, uint8_t* gwSpecific) {
+  if(!this->beaconLocked) {
+    return(RADIOLIB_ERR_NO_BEACON);
+  }
+  if(gpsTime) {
+    *gpsTime = this->beaconTime;
+  }
+  if(gwSpecific) {
+    memcpy(gwSpecific, this->beaconInfo, RADIOLIB_LORAWAN_BEACON_INFO_LEN);
+  }
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t LoRaWANNode::setPingSlotPeriodicity(uint8_t periodicity) {
+  if(periodicity > RADIOLIB_LORAWAN_PING_PERIODICITY_MAX) {
+    return(RADIOLIB_ERR_INVALID_PAYLOAD);
+  }
+
+  // the device keeps using the old periodicity until the network confirms the new one
+  this->pingPeriodicityReq = periodicity;
+  (void)this->deleteMacCommand(RADIOLIB_LORAWAN_MAC_PING_SLOT_INFO, this->fOptsUp, &this->fOptsUpLen, RADIOLIB_LORAWAN_UPLINK);
+  return(this->pushMacCommand(RADIOLIB_LORAWAN_MAC_PING_SLOT_INFO, &periodicity, this->fOptsUp, &this->fOptsUpLen, RADIOLIB_LORAWAN_UPLINK));
+}
+
+uint16_t LoRaWANNode::calculatePingOffset(uint32_t beaconTime, uint32_t devAddr, uint16_t pingPeriod) {
+  // Rand = aes128_encrypt(16 x 0x00, Beacon_Time | DevAddr | pad16)
+  uint8_t key[RADIOLIB_AES128_KEY_SIZE] = { 0 };
+  uint8_t block[RADIOLIB_AES128_BLOCK_SIZE] = { 0 };
+  uint8_t rand[RADIOLIB_AES128_BLOCK_SIZE] = { 0 };
+  LoRaWANNode::hton<uint32_t>(&block[0], beaconTime);
+  LoRaWANNode::hton<uint32_t>(&block[4], devAddr);
+  RadioLibAES128Instance.init(key);
+  RadioLibAES128Instance.encryptECB(block, RADIOLIB_AES128_BLOCK_SIZE, rand);
+  return((rand[0] + 256*(uint16_t)rand[1]) % pingPeriod);
+}
+
+int16_t LoRaWANNode::searchBeacon() {
+  Module* mod = this->phyLayer->getMod();
+  RadioLibTime_t tNow = mod->hal->millis();
+
+  // an uplink cancels the search, this is reported once the uplink/downlink cycle is done
+  if(this->cycleState != RADIOLIB_LORAWAN_CYCLE_IDLE) {
+    return(RADIOLIB_ERR_NONE);
+  }
+
+  bool received = (this->classBDeadline != 0) && mod->hal->digitalRead(mod->getIrq());
+  if(received) {
+    if(this->parseBeacon(tNow) == RADIOLIB_ERR_NONE) {
+      RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Beacon acquired, GPS time = %lu", (unsigned long)this->beaconTime);
+      this->abortClassBWindow();
+      return(this->scheduleClassB(tNow));
+    }
+  } else if(tNow >= this->classBDeadline) {
+    RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Beacon search timed out");
+    this->stopBeaconTracking();
+    return(RADIOLIB_ERR_NO_BEACON);
+
+  } else {
+    // still listening
+    return(RADIOLIB_ERR_NONE);
+  }
+
+  // not a beacon, or a corrupted one (there is no PHY CRC to catch it) - some modules stop listening after that, so restart
+  int16_t state = this->stageBeaconWindow(0);
+  if(state == RADIOLIB_ERR_NONE) {
+    state = this->phyLayer->launchMode();
+  }
+  if(state != RADIOLIB_ERR_NONE) {
+    this->stopBeaconTracking();
+  }
+  return(state);
+}
+
+int16_t LoRaWANNode::stageBeaconWindow(RadioLibTime_t timeoutUs) {
+  LoRaWANChannel_t chnl = RADIOLIB_LORAWAN_CHANNEL_NONE;
+  this->getBeaconChannel(&chnl);
+
+  // beacons use a longer preamble, the same IQ polarity as uplinks, and no header or PHY CRC
+  int16_t state = this->setPhyProperties(&chnl, RADIOLIB_LORAWAN_UPLINK, this->txPowerMax - 2*this->txPowerSteps, RADIOLIB_LORAWAN_BEACON_PREAMBLE_LEN);
+  RADIOLIB_ASSERT(state);
+  size_t len = RADIOLIB_LORAWAN_BEACON_LEN(this->band->beacon.rfu1, this->band->beacon.rfu2);
+  state = this->phyLayer->implicitHeader(len);
+  RADIOLIB_ASSERT(state);
+  state = this->phyLayer->setPacketCRC(false);
+  RADIOLIB_ASSERT(state);
+
+  RadioModeConfig_t modeCfg;
+  modeCfg.receive.irqFlags = RADIOLIB_IRQ_RX_DEFAULT_FLAGS;
+  modeCfg.receive.irqMask = RADIOLIB_IRQ_RX_DEFAULT_MASK;
+  modeCfg.receive.len = len;
+  if(timeoutUs) {
+    modeCfg.receive.timeout = this->phyLayer->calculateRxTimeout(timeoutUs);
+  } else {
+    modeCfg.receive.timeout = 0xFFFFFFFF; // max(uint32_t) is used for RxContinuous
+  }
+  return(this->phyLayer->stageMode(RADIOLIB_RADIO_MODE_RX, &modeCfg));
+}
+
+int16_t LoRaWANNode::stageClassBWindow() {
+  RadioLibTime_t widenUs = this->getBeaconWidening(this->classBOpen);
+
+  if(!this->classBBeacon) {
+    LoRaWANChannel_t chnl = RADIOLIB_LORAWAN_CHANNEL_NONE;
+    this->getPingChannel(&chnl);
+    int16_t state = this->stageRxWindow(RADIOLIB_LORAWAN_DOWNLINK, &chnl, &this->classBRxTimeout, 
+                                        &this->classBRxMaxToA, &this->classBMaxPayLen, widenUs);
+    this->classBRxTimeout /= 1000;
+    return(state);
+  }
+
+  // the beacon window only has to catch the preamble, which is 10 upchirps plus 4.25 symbols of sync
+  const DataRate_t* dr = &this->band->dataRates[this->band->beacon.dr].dr;
+  RadioLibTime_t symbolUs = ((uint32_t)1 << dr->lora.spreadingFactor) * 1000UL / dr->lora.bandwidth;
+  RadioLibTime_t timeoutUs = symbolUs * (4*RADIOLIB_LORAWAN_BEACON_PREAMBLE_LEN + 17) / 4 + 2*widenUs + this->scanGuard*1000;
+  size_t len = RADIOLIB_LORAWAN_BEACON_LEN(this->band->beacon.rfu1, this->band->beacon.rfu2);
+  this->classBRxTimeout = timeoutUs / 1000;
+  this->classBRxMaxToA = this->classBRxTimeout + this->calculateTimeOnAir(this->band->beacon.dr, len) / 1000;
+  return(this->stageBeaconWindow(timeoutUs));
+}
+
+int16_t LoRaWANNode::closeClassBWindow(bool received, uint8_t* dataDown, size_t* lenDown, LoRaWANEvent_t* eventDown) {
+  Module* mod = this->phyLayer->getMod();
+  RadioLibTime_t tNow = mod->hal->millis();
+
+  if(this->classBBeacon) {
+    bool valid = received && (this->parseBeacon(tNow) == RADIOLIB_ERR_NONE);
+    this->abortClassBWindow();
+    if(!valid) {
+      RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Beacon missing!");
+      this->advanceBeaconPeriod();
+    }
+    return(this->scheduleClassB(tNow));
+  }
+
+  // ping slot, handled the same way as the other Class B/C windows
+  int16_t state = this->closeRxWindow(RADIOLIB_LORAWAN_RX_BC, this->classBMaxPayLen, received);
+  if(state > 0) {
+    if(dataDown == NULL || lenDown == NULL) {
+      state = RADIOLIB_ERR_NULL_POINTER;
+    } else {
+      // ping slots are only used for unicast downlinks
+      uint8_t mc = this->multicast;
+      this->multicast = false;
+      state = this->parseDownlink(dataDown, lenDown, RADIOLIB_LORAWAN_RX_BC, eventDown);
+      this->multicast = mc;
+      if(state == RADIOLIB_ERR_NONE) {
+        state = RADIOLIB_LORAWAN_RX_BC;
+      }
+    }
+  }
+  this->phyLayer->sleep();
+
+  this->pingSlot++;
+  int16_t next = this->scheduleClassB(tNow);
+  if(next != RADIOLIB_ERR_NONE) {
+    return(next);
+  }
+  return(state);
+}
+
+int16_t LoRaWANNode::skipClassBWindow() {
+  Module* mod = this->phyLayer->getMod();
+  RADIOLIB_DEBUG_PROTOCOL_PRINTLN("%s window skipped", this->classBBeacon ? "Beacon" : "Ping slot");
+  if(this->classBBeacon) {
+    this->advanceBeaconPeriod();
+  } else {
+    this->pingSlot++;
+  }
+  return(this->scheduleClassB(mod->hal->millis()));
+}
+
+void LoRaWANNode::abortClassBWindow() {
+  Module* mod = this->phyLayer->getMod();
+
+  // only staged/active windows and the search have the radio configured
+  bool beacon = this->classBBeacon || (this->classBState == RADIOLIB_LORAWAN_CLASS_B_SEARCH);
+  this->phyLayer->clearIrq(RADIOLIB_IRQ_RX_DEFAULT_FLAGS);
+  this->phyLayer->standby();
+  if(beacon) {
+    (void)this->phyLayer->explicitHeader();
+    (void)this->phyLayer->setPacketCRC(true);
+  }
+  this->phyLayer->sleep();
+  if(this->ledPins[RADIOLIB_LORAWAN_RX_BC] != RADIOLIB_NC) {
+    mod->hal->digitalWrite(this->ledPins[RADIOLIB_LORAWAN_RX_BC], mod->hal->GpioLevelLow);
+  }
+  if(this->classBState != RADIOLIB_LORAWAN_CLASS_B_SEARCH) {
+    this->classBState = RADIOLIB_LORAWAN_CLASS_B_PENDING;
+  }
+}
+
+int16_t LoRaWANNode::scheduleClassB(RadioLibTime_t tNow) {
+  // a window can only be used if there is enough time left to wake up the radio
+  RadioLibTime_t tMin = tNow + this->launchDuration + RADIOLIB_LORAWAN_CLASS_B_WAKE_MS;
+  RadioLibTime_t tOpen = 0;
 
-    } else { // fOptsReLen <= 15
-      memcpy(this->fOptsUp, fOptsRe, fOptsReLen);
-      this->fOptsUpLen = fOptsReLen;
+  while(true) {
+    // give up once the beacon has not been received for too long
+    if(this->getBeaconPeriodTime(0) - this->beaconLastRx > RADIOLIB_LORAWAN_BEACON_LESS_PERIOD_MS) {
+      this->stopBeaconTracking();
+      return(RADIOLIB_ERR_NO_BEACON);
     }
-  }
 
-  // by default, the data and length are user-accessible
-  *len = payLen;
+    // the ping slots of the current beacon period
+    if(this->lwClass == RADIOLIB_LORAWAN_CLASS_B) {
+      uint16_t pingPeriod = (uint16_t)1 << (5 + this->pingPeriodicity);
+      uint16_t pingNb = (uint16_t)1 << (7 - this->pingPeriodicity);
+      for(; this->pingSlot < pingNb; this->pingSlot++) {
+        RadioLibTime_t offset = RADIOLIB_LORAWAN_BEACON_RESERVED_MS + 
+                                ((RadioLibTime_t)this->pingOffset + (RadioLibTime_t)this->pingSlot*pingPeriod) * RADIOLIB_LORAWAN_PING_SLOT_LEN_MS;
+        RadioLibTime_t tSlot = this->getBeaconPeriodTime(offset);
+        tOpen = tSlot - this->getBeaconWidening(tSlot) / 1000 - this->scanGuard / 2;
+        if(tOpen >= tMin) {
+          this->classBBeacon = false;
+          break;
+        }
+      }
+      if(this->pingSlot < pingNb) {
+        break;
+      }
+    }
 
-  // however, if this frame belongs to an application package, 
-  // redirect instead and 'hide' contents from the user
-  // just to be sure that it doesn't get re-interpreted...
-  for(int id = 0; id < RADIOLIB_LORAWAN_NUM_SUPPORTED_PACKAGES; id++) {
-    if(this->packages[id].enabled && this->packages[id].isAppPack && fPort == this->packages[id].packFPort) {
-      this->packages[id].callback(data, *len);
-      memset(data, 0, *len);
-      *len = 0;
+    // the beacon at the start of the next period
+    RadioLibTime_t tBeacon = this->getBeaconPeriodTime(RADIOLIB_LORAWAN_BEACON_PERIOD_MS) + RADIOLIB_LORAWAN_BEACON_DELAY_US / 1000;
+    tOpen = tBeacon - this->getBeaconWidening(tBeacon) / 1000 - this->scanGuard / 2;
+    if(tOpen >= tMin) {
+      this->classBBeacon = true;
+      break;
     }
+
+    // too late for this one as well, e.g. because of a long blocking call
+    this->advanceBeaconPeriod();
   }
 
-  // pass the event info if requested
-  if(event) {
-    event->dir = RADIOLIB_LORAWAN_DOWNLINK;
-    event->confirmed = isConfirmedDown;
-    event->confirming = isConfirmingUp;
-    event->frmPending = (downlinkMsg[RADIOLIB_LORAWAN_FHDR_FCTRL_POS] & RADIOLIB_LORAWAN_FCTRL_FRAME_PENDING) != 0;
-    event->datarate = this->channels[window].dr;
-    event->freq = this->channels[window].freq / 10000.0;
-    event->power = this->txPowerMax - this->txPowerSteps * 2;
-    event->fCnt = devFCnt32;
-    event->fPort = fPort;
-    event->multicast = (bool)this->multicast;
+  this->classBState = RADIOLIB_LORAWAN_CLASS_B_PENDING;
+  this->classBOpen = tOpen;
+  this->classBDeadline = tOpen - this->launchDuration - RADIOLIB_LORAWAN_CLASS_B_WAKE_MS;
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t LoRaWANNode::parseBeacon(RadioLibTime_t tRx) {
+  const LoRaWANBeacon_t* bcn = &this->band->beacon;
+  uint8_t frame[RADIOLIB_LORAWAN_BEACON_MAX_LEN] = { 0 };
+  size_t len = RADIOLIB_LORAWAN_BEACON_LEN(bcn->rfu1, bcn->rfu2);
+  if(len > RADIOLIB_LORAWAN_BEACON_MAX_LEN) {
+    return(RADIOLIB_ERR_PACKET_TOO_LONG);
   }
 
-  #if !RADIOLIB_STATIC_ONLY
-    delete[] downlinkMsg;
-  #endif
+  // the beacon is sent without the PHY CRC, it has its own
+  int16_t state = this->phyLayer->readData(frame, len);
+  RADIOLIB_ASSERT(state);
+
+  // | RFU | Time | CRC | GwSpecific | RFU | CRC |, both CRCs are CRC-16/XMODEM sent LSB first
+  RadioLibCRCInstance.size = 16;
+  RadioLibCRCInstance.poly = RADIOLIB_CRC_CCITT_POLY;
+  RadioLibCRCInstance.init = 0;
+  RadioLibCRCInstance.out = 0;
+  RadioLibCRCInstance.refIn = false;
+  RadioLibCRCInstance.refOut = false;
+  size_t pos = bcn->rfu1 + RADIOLIB_LORAWAN_BEACON_TIME_LEN;
+  if(RadioLibCRCInstance.checksum(frame, pos) != LoRaWANNode::ntoh<uint16_t>(&frame[pos])) {
+    RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Beacon CRC mismatch");
+    return(RADIOLIB_ERR_CRC_MISMATCH);
+  }
+  uint32_t time = LoRaWANNode::ntoh<uint32_t>(&frame[bcn->rfu1]);
+  if(time % (RADIOLIB_LORAWAN_BEACON_PERIOD_MS / 1000) != 0) {
+    return(RADIOLIB_ERR_DOWNLINK_MALFORMED);
+  }
 
+  // the gateway-specific part has a separate CRC, the timing is usable even if it fails
+  pos += RADIOLIB_LORAWAN_BEACON_CRC_LEN;
+  size_t infoLen = RADIOLIB_LORAWAN_BEACON_INFO_LEN + bcn->rfu2;
+  if(RadioLibCRCInstance.checksum(&frame[pos], infoLen) == LoRaWANNode::ntoh<uint16_t>(&frame[pos + infoLen])) {
+    memcpy(this->beaconInfo, &frame[pos], RADIOLIB_LORAWAN_BEACON_INFO_LEN);
+  }
+
+  // work back from the end of reception to the start of the beacon period
+  // prefer the module's own time-on-air, since it knows whether its CRC was enabled
+  RadioLibTime_t toaUs = this->phyLayer->getTimeOnAir(len);
+  if(toaUs == 0) {
+    const LoRaWANDataRate_t* dataRate = &this->band->dataRates[bcn->dr];
+    PacketConfig_t pc = dataRate->pc;
+    pc.lora.preambleLength = RADIOLIB_LORAWAN_BEACON_PREAMBLE_LEN;
+    pc.lora.implicitHeader = true;
+    pc.lora.crcEnabled = false;
+    toaUs = this->phyLayer->calculateTimeOnAir(dataRate->modem, dataRate->dr, pc, len);
+  }
+  uint64_t tRefUs = (uint64_t)tRx*1000UL - toaUs - RADIOLIB_LORAWAN_BEACON_DELAY_US;
+
+  // compare with the prediction to learn how fast the internal clock runs
+  // the error is spread over all the periods since the last beacon, and filtered
+  if(this->beaconLocked && (time > this->beaconTime)) {
+    uint32_t periods = (time - this->beaconTime) / (RADIOLIB_LORAWAN_BEACON_PERIOD_MS / 1000);
+    uint64_t tPredUs = (uint64_t)this->beaconRef*1000UL + this->beaconRefUs + (uint64_t)periods*this->beaconPeriodUs;
+    int32_t errUs = (int32_t)(int64_t)(tRefUs - tPredUs);
+    int32_t corr = errUs / (int32_t)(periods + this->beaconMissed) / 4;
+    uint32_t limit = RADIOLIB_LORAWAN_BEACON_PERIOD_MS;   // 1000 ppm
+    uint32_t nominal = RADIOLIB_LORAWAN_BEACON_PERIOD_MS*1000UL;
+    this->beaconPeriodUs = RADIOLIB_MIN(RADIOLIB_MAX(this->beaconPeriodUs + corr, nominal - limit), nominal + limit);
+    RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Beacon error = %ld us, period = %lu us", (long)errUs, (unsigned long)this->beaconPeriodUs);
+  }
+
+  this->beaconLocked = true;
+  this->beaconRef = tRefUs / 1000;
+  this->beaconRefUs = tRefUs % 1000;
+  this->beaconTime = time;
+  this->beaconLastRx = this->beaconRef;
+  this->beaconMissed = 0;
+  this->pingSlot = 0;
+  this->pingOffset = LoRaWANNode::calculatePingOffset(this->beaconTime, this->devAddr, (uint16_t)1 << (5 + this->pingPeriodicity));
   return(RADIOLIB_ERR_NONE);
 }
 
-int16_t LoRaWANNode::getDownlinkClassC(uint8_t* dataDown, size_t* lenDown, LoRaWANEvent_t* eventDown) {
-  // only allow if the device is Unicast-C or Multicast-C, otherwise ignore without error
-  if(this->lwClass != RADIOLIB_LORAWAN_CLASS_C && this->multicast != RADIOLIB_LORAWAN_CLASS_C) {
-    return(RADIOLIB_ERR_NONE);
+void LoRaWANNode::advanceBeaconPeriod() {
+  // assume the beacon was sent when predicted
+  uint32_t us = this->beaconRefUs + this->beaconPeriodUs;
+  this->beaconRef += us / 1000;
+  this->beaconRefUs = us % 1000;
+  this->beaconTime += RADIOLIB_LORAWAN_BEACON_PERIOD_MS / 1000;
+  this->beaconMissed++;
+  this->pingSlot = 0;
+  this->pingOffset = LoRaWANNode::calculatePingOffset(this->beaconTime, this->devAddr, (uint16_t)1 << (5 + this->pingPeriodicity));
+}
+
+void LoRaWANNode::getBeaconChannel(LoRaWANChannel_t* chnl) {
+  const LoRaWANBeacon_t* bcn = &this->band->beacon;
+  chnl->dr = bcn->dr;
+  chnl->drMin = bcn->dr;
+  chnl->drMax = bcn->dr;
+  if(this->beaconFreq) {
+    chnl->freq = this->beaconFreq;
+    return;
   }
 
-  int16_t state = RADIOLIB_ERR_NONE;
+  // on hopping bands, the channel is given by the time of the next beacon
+  // the search (before the time is known) always uses the first one
+  uint32_t ch = (this->beaconTime / (RADIOLIB_LORAWAN_BEACON_PERIOD_MS / 1000) + 1) % bcn->numChannels;
+  if(!this->beaconLocked) {
+    ch = 0;
+  }
+  chnl->freq = bcn->freqStart + ch*bcn->freqStep;
+}
 
-  if(downlinkAction) {
-    state = this->parseDownlink(dataDown, lenDown, RADIOLIB_LORAWAN_RX_BC, eventDown);
-    downlinkAction = false;
+void LoRaWANNode::getPingChannel(LoRaWANChannel_t* chnl) {
+  const LoRaWANBeacon_t* bcn = &this->band->beacon;
+  chnl->dr = (this->pingDr != RADIOLIB_LORAWAN_DATA_RATE_UNUSED) ? this->pingDr : bcn->dr;
+  chnl->drMin = chnl->dr;
+  chnl->drMax = chnl->dr;
+  if(this->pingFreq) {
+    chnl->freq = this->pingFreq;
+    return;
+  }
 
-    // if downlink parsed successfully, set state to RxC window
-    if(state == RADIOLIB_ERR_NONE) {
-      state = RADIOLIB_LORAWAN_RX_BC;
+  // same frequencies as the beacon, but the hopping sequence is offset by the device address
+  uint32_t ch = (this->beaconTime / (RADIOLIB_LORAWAN_BEACON_PERIOD_MS / 1000) + this->devAddr) % bcn->numChannels;
+  chnl->freq = bcn->freqStart + ch*bcn->freqStep;
+}
 
-    // otherwise, if device is acting as Multicast on top of the same Unicast class,
-    // try decrypting it as a Unicast downlink by temporarily disabling Multicast
-    } else if(this->multicast == this->lwClass) {
-      this->multicast = false;
-      state = this->parseDownlink(dataDown, lenDown, RADIOLIB_LORAWAN_RX_BC, eventDown);
-      this->multicast = this->lwClass;
-      // if downlink parsed succesfully, set state to RxC window
-      if(state == RADIOLIB_ERR_NONE) {
-        state = RADIOLIB_LORAWAN_RX_BC;
-      }
-    }
-  }
+RadioLibTime_t LoRaWANNode::getBeaconPeriodTime(RadioLibTime_t offset) {
+  // scale by the measured period length, so that clock drift is compensated within the period too
+  uint64_t us = this->beaconRefUs + (uint64_t)offset*this->beaconPeriodUs / RADIOLIB_LORAWAN_BEACON_PERIOD_MS;
+  return(this->beaconRef + (RadioLibTime_t)(us / 1000));
+}
 
-  return(state);
+RadioLibTime_t LoRaWANNode::getBeaconWidening(RadioLibTime_t t) {
+  // the residual clock error accumulates since the last beacon, plus one millisecond of timestamp resolution
+  RadioLibTime_t elapsed = (t > this->beaconLastRx) ? (t - this->beaconLastRx) : 0;
+  return(elapsed * RADIOLIB_LORAWAN_BEACON_CLOCK_PPM / 1000UL + 1000UL);
 }
 
 bool LoRaWANNode::execMacCommand(uint8_t cid, uint8_t* optIn, uint8_t lenIn) {
@@ -2606,6 +3529,7 @@ bool LoRaWANNode::execMacCommand(uint8_t cid, uint8_t* optIn, uint8_t lenIn, uin
         this->dynamicChannels[RADIOLIB_LORAWAN_UPLINK][macChIndex].drMax     = macDrMax;
         // downlink channel is identical to uplink channel
         this->dynamicChannels[RADIOLIB_LORAWAN_DOWNLINK][macChIndex] = this->dynamicChannels[RADIOLIB_LORAWAN_UPLINK][macChIndex];
+        this->updateChannelDrMask(macChIndex);
   
         // add the new channel
         this->channelMasks[0] |= (0x0001 << macChIndex);
@@ -2613,6 +3537,7 @@ bool LoRaWANNode::execMacCommand(uint8_t cid, uint8_t* optIn, uint8_t lenIn, uin
       } else {
         this->dynamicChannels[RADIOLIB_LORAWAN_UPLINK][macChIndex] = RADIOLIB_LORAWAN_CHANNEL_NONE;
         this->dynamicChannels[RADIOLIB_LORAWAN_DOWNLINK][macChIndex] = RADIOLIB_LORAWAN_CHANNEL_NONE;
+        this->updateChannelDrMask(macChIndex);
 
         // remove this channel
         this->channelMasks[0] &= ~(0x0001 << macChIndex);
@@ -2768,6 +3693,57 @@ bool LoRaWANNode::execMacCommand(uint8_t cid, uint8_t* optIn, uint8_t lenIn, uin
       return(true);
     } break;
 
+    case(RADIOLIB_LORAWAN_MAC_PING_SLOT_INFO): {
+      // the network acknowledged the new periodicity
+      RADIOLIB_DEBUG_PROTOCOL_PRINTLN("PingSlotInfoAns: periodicity = %d", this->pingPeriodicityReq);
+      this->pingPeriodicity = this->pingPeriodicityReq;
+      this->pingOffset = LoRaWANNode::calculatePingOffset(this->beaconTime, this->devAddr, (uint16_t)1 << (5 + this->pingPeriodicity));
+      this->pingSlot = 0;
+      if(this->classBState == RADIOLIB_LORAWAN_CLASS_B_PENDING) {
+        Module* mod = this->phyLayer->getMod();
+        (void)this->scheduleClassB(mod->hal->millis());
+      }
+      return(false);
+    } break;
+
+    case(RADIOLIB_LORAWAN_MAC_PING_SLOT_CHANNEL): {
+      uint32_t freqRaw = LoRaWANNode::ntoh<uint32_t>(&optIn[0], 3);
+      uint8_t dr = optIn[3] & 0x0F;
+      RADIOLIB_DEBUG_PROTOCOL_PRINTLN("PingSlotChannelReq: freq = %lu, dr = %d", (unsigned long)freqRaw, dr);
+
+      // frequency of 0 restores the default, otherwise it must be within the band
+      bool freqAck = (freqRaw == 0) || ((freqRaw >= this->band->freqMin) && (freqRaw <= this->band->freqMax));
+      // data rate is checked the same way as for RX2 in RxParamSetupReq
+      bool drAck = false;
+      if((dr < RADIOLIB_LORAWAN_CHANNEL_NUM_DATARATES) && (dr >= this->band->rx2.drMin) && (dr <= this->band->rx2.drMax)) {
+        if(this->band->dataRates[dr].modem != RADIOLIB_MODEM_NONE) {
+          int16_t state = this->phyLayer->checkDataRate(this->band->dataRates[dr].dr, 
+                                                        this->band->dataRates[dr].modem);
+          drAck = (state == RADIOLIB_ERR_NONE);
+        }
+      }
+      if(freqAck && drAck) {
+        this->pingFreq = freqRaw;
+        this->pingDr = dr;
+      }
+
+      optOut[0] = ((uint8_t)freqAck << 1) | (uint8_t)drAck;
+      return(true);
+    } break;
+
+    case(RADIOLIB_LORAWAN_MAC_BEACON_FREQ): {
+      uint32_t freqRaw = LoRaWANNode::ntoh<uint32_t>(&optIn[0], 3);
+      RADIOLIB_DEBUG_PROTOCOL_PRINTLN("BeaconFreqReq: freq = %lu", (unsigned long)freqRaw);
+
+      bool freqAck = (freqRaw == 0) || ((freqRaw >= this->band->freqMin) && (freqRaw <= this->band->freqMax));
+      if(freqAck) {
+        this->beaconFreq = freqRaw;
+      }
+
+      optOut[0] = (uint8_t)freqAck;
+      return(true);
+    } break;
+
     case(RADIOLIB_LORAWAN_MAC_DEVICE_MODE): {
       // only implemented on LoRaWAN v1.1
       if(this->rev == 0) {
@@ -2854,11 +3830,10 @@ void LoRaWANNode::preprocessMacLinkAdr(uint8_t* mPtr, uint8_t cLen, uint8_t* mAd
         break;
       case 6:
         // for dynamic bands: all channels ON (that are currently defined)
+        // every defined channel supports at least one datarate
         if(this->band->bandType == RADIOLIB_LORAWAN_BAND_DYNAMIC) {
-          for(int i = 0; i < RADIOLIB_LORAWAN_MAX_NUM_DYNAMIC_CHANNELS; i++) {
-            if(this->dynamicChannels[RADIOLIB_LORAWAN_UPLINK][i].freq > 0) {
-              adrMasks[0] |= (0x0001 << i);
-            }
+          for(int dr = 0; dr < RADIOLIB_LORAWAN_CHANNEL_NUM_DATARATES; dr++) {
+            adrMasks[0] |= this->channelDrMasks[dr][0];
           }
         }
         // for fixed bands:   all default 125kHz channels ON, channel mask similar to ChMaskCntl = 4
@@ -2901,12 +3876,35 @@ void LoRaWANNode::postprocessMacLinkAdr(uint8_t* ack, uint8_t cLen) {
   }
 }
 
+// the standard MAC commands are stored in MacTable in order of their CID, followed by DeviceMode and Proprietary,
+// so the table can be indexed directly instead of being searched (CID 0x12 is not assigned)
+static constexpr int8_t macTableIndex(uint8_t cid) {
+  return((cid >= RADIOLIB_LORAWAN_MAC_RESET && cid <= RADIOLIB_LORAWAN_MAC_PING_SLOT_CHANNEL) ? (cid - RADIOLIB_LORAWAN_MAC_RESET) :
+         (cid == RADIOLIB_LORAWAN_MAC_BEACON_FREQ) ? (RADIOLIB_LORAWAN_MAC_PING_SLOT_CHANNEL - RADIOLIB_LORAWAN_MAC_RESET + 1) :
+         (cid == RADIOLIB_LORAWAN_MAC_DEVICE_MODE) ? (RADIOLIB_LORAWAN_MAC_PING_SLOT_CHANNEL - RADIOLIB_LORAWAN_MAC_RESET + 2) :
+         (cid == RADIOLIB_LORAWAN_MAC_PROPRIETARY) ? (RADIOLIB_LORAWAN_MAC_PING_SLOT_CHANNEL - RADIOLIB_LORAWAN_MAC_RESET + 3) : -1);
+}
+
+static_assert(MacTable[macTableIndex(RADIOLIB_LORAWAN_MAC_RESET)].cid == RADIOLIB_LORAWAN_MAC_RESET, "MacTable order");
+static_assert(MacTable[macTableIndex(RADIOLIB_LORAWAN_MAC_REJOIN_PARAM_SETUP)].cid == RADIOLIB_LORAWAN_MAC_REJOIN_PARAM_SETUP, "MacTable order");
+static_assert(MacTable[macTableIndex(RADIOLIB_LORAWAN_MAC_PING_SLOT_CHANNEL)].cid == RADIOLIB_LORAWAN_MAC_PING_SLOT_CHANNEL, "MacTable order");
+static_assert(MacTable[macTableIndex(RADIOLIB_LORAWAN_MAC_BEACON_FREQ)].cid == RADIOLIB_LORAWAN_MAC_BEACON_FREQ, "MacTable order");
+static_assert(MacTable[macTableIndex(RADIOLIB_LORAWAN_MAC_DEVICE_MODE)].cid == RADIOLIB_LORAWAN_MAC_DEVICE_MODE, "MacTable order");
+static_assert(MacTable[macTableIndex(RADIOLIB_LORAWAN_MAC_PROPRIETARY)].cid == RADIOLIB_LORAWAN_MAC_PROPRIETARY, "MacTable order");
+
+const LoRaWANMacCommand_t* LoRaWANNode::findMacCommand(uint8_t cid) {
+  int8_t idx = macTableIndex(cid);
+  if(idx < 0) {
+    return(NULL);
+  }
+  return(&MacTable[idx]);
+}
+
 int16_t LoRaWANNode::getMacCommand(uint8_t cid, LoRaWANMacCommand_t* cmd) {
-  for(size_t i = 0; i < RADIOLIB_LORAWAN_NUM_MAC_COMMANDS; i++) {
-    if(MacTable[i].cid == cid) {
-      memcpy(reinterpret_cast<void*>(cmd), reinterpret_cast<void*>(const_cast<LoRaWANMacCommand_t*>(&MacTable[i])), sizeof(LoRaWANMacCommand_t));
-      return(RADIOLIB_ERR_NONE);
-    }
+  const LoRaWANMacCommand_t* entry = LoRaWANNode::findMacCommand(cid);
+  if(entry) {
+    memcpy(reinterpret_cast<void*>(cmd), reinterpret_cast<const void*>(entry), sizeof(LoRaWANMacCommand_t));
+    return(RADIOLIB_ERR_NONE);
   }
   // didn't find this CID, check if derived class can help (if any)
   int16_t state = this->derivedMacFinder(cid, cmd);
@@ -2988,32 +3986,39 @@ int16_t LoRaWANNode::getMacLen(uint8_t cid, uint8_t* len, uint8_t dir, bool incl
     *len += 1;    // add one byte for CID
   }
   
-  LoRaWANMacCommand_t cmd = RADIOLIB_LORAWAN_MAC_COMMAND_NONE;
-  int16_t state = this->getMacCommand(cid, &cmd);
-  RADIOLIB_ASSERT(state);
+  // standard commands are read straight from the table, others may be provided by a derived class
+  LoRaWANMacCommand_t derived = RADIOLIB_LORAWAN_MAC_COMMAND_NONE;
+  const LoRaWANMacCommand_t* cmd = LoRaWANNode::findMacCommand(cid);
+  if(!cmd) {
+    int16_t state = this->derivedMacFinder(cid, &derived);
+    RADIOLIB_ASSERT(state);
+    cmd = &derived;
+  }
   if(dir == RADIOLIB_LORAWAN_UPLINK) {
-    *len += cmd.lenUp;
+    *len += cmd->lenUp;
   } else {
-    *len += cmd.lenDn;
+    *len += cmd->lenDn;
   }
   return(RADIOLIB_ERR_NONE);
 }
 
 bool LoRaWANNode::isPersistentMacCommand(uint8_t cid, uint8_t dir) {
   // if this MAC command doesn't exist, it wouldn't even get into the queue, so don't care about outcome
-  LoRaWANMacCommand_t cmd = RADIOLIB_LORAWAN_MAC_COMMAND_NONE;
-  (void)this->getMacCommand(cid, &cmd);
+  LoRaWANMacCommand_t derived = RADIOLIB_LORAWAN_MAC_COMMAND_NONE;
+  const LoRaWANMacCommand_t* cmd = LoRaWANNode::findMacCommand(cid);
+  if(!cmd) {
+    (void)this->derivedMacFinder(cid, &derived);
+    cmd = &derived;
+  }
   
   // in the uplink direction, MAC payload should persist per spec
   if(dir == RADIOLIB_LORAWAN_UPLINK) {
-    return(cmd.persist);
+    return(cmd->persist);
+  }
 
   // in the downlink direction, MAC payload should persist if it is user-accessible
   // which is the case for LinkCheck and DeviceTime
-  } else {
-    return(cmd.user);
-  }
-  return(false);
+  return(cmd->user);
 }
 
 int16_t LoRaWANNode::pushMacCommand(uint8_t cid, const uint8_t* cOcts, uint8_t* out, uint8_t* lenOut, uint8_t dir) {
@@ -3066,7 +4071,7 @@ int16_t LoRaWANNode::deleteMacCommand(uint8_t cid, uint8_t* inOut, uint8_t* lenI
   while(i < *lenInOut) {
     uint8_t id = inOut[i];
     uint8_t fLen = 0;
-    int16_t state = this->getMacLen(id, &fLen, dir);
+    int16_t state = this->getMacLen(id, &fLen, dir, true, &inOut[i + 1]);
     RADIOLIB_ASSERT(state);
     if(*lenInOut < i + fLen) {
       return(RADIOLIB_ERR_INVALID_CID);
@@ -3077,8 +4082,8 @@ int16_t LoRaWANNode::deleteMacCommand(uint8_t cid, uint8_t* inOut, uint8_t* lenI
       // remove it by moving the rest of the payload forward
       memmove(&inOut[i], &inOut[i + fLen], *lenInOut - i - fLen);
 
-      // set the remainder of the queue to 0
-      memset(&inOut[i + fLen], 0, *lenInOut - i - fLen);
+      // set the now unused tail of the queue to 0
+      memset(&inOut[*lenInOut - fLen], 0, fLen);
 
       *lenInOut -= fLen;
       return(RADIOLIB_ERR_NONE);
@@ -3092,29 +4097,33 @@ int16_t LoRaWANNode::deleteMacCommand(uint8_t cid, uint8_t* inOut, uint8_t* lenI
 }
 
 void LoRaWANNode::clearMacCommands(uint8_t* inOut, uint8_t* lenInOut, uint8_t dir) {
+  // compact the queue in a single pass, commands that persist are moved forward over the deleted ones
   size_t i = 0;
-  uint8_t numDeleted = 0;
+  size_t kept = 0;
   while(i < *lenInOut) {
     uint8_t id = inOut[i];
     uint8_t fLen = 0;
     // include CID byte, so if command fails, we still move one byte forward
     (void)this->getMacLen(id, &fLen, dir, true, &inOut[i+1]);
+    if(i + fLen > *lenInOut) {
+      fLen = *lenInOut - i;
+    }
 
-    // only clear MAC command if it should not persist until a downlink is received
-    if(!this->isPersistentMacCommand(id, dir)) {
-      // remove it by moving the rest of the payload forward
-      memmove(&inOut[i], &inOut[i + fLen], *lenInOut - i - fLen);
-
-      // set the remainder of the queue to 0
-      memset(&inOut[i + fLen], 0, *lenInOut - i - fLen);
-
-      numDeleted += fLen;
+    // only keep MAC command if it should persist until a downlink is received
+    if(this->isPersistentMacCommand(id, dir)) {
+      if(kept != i) {
+        memmove(&inOut[kept], &inOut[i], fLen);
+      }
+      kept += fLen;
     }
 
     // move on to next MAC command
     i += fLen;
   }
-  *lenInOut -= numDeleted;
+
+  // set the now unused tail of the queue to 0
+  memset(&inOut[kept], 0, *lenInOut - kept);
+  *lenInOut = kept;
 }
 
 int16_t LoRaWANNode::setDatarate(uint8_t drUp) {
@@ -3139,6 +4148,22 @@ int16_t LoRaWANNode::setDatarate(uint8_t drUp) {
   return(RADIOLIB_ERR_NONE);
 }
 
+uint8_t LoRaWANNode::getDatarate() {
+  return(this->channels[RADIOLIB_LORAWAN_UPLINK].dr);
+}
+
+bool LoRaWANNode::isDatarateEnabled(uint8_t dr) {
+  if(dr >= RADIOLIB_LORAWAN_CHANNEL_NUM_DATARATES) {
+    return(false);
+  }
+  for(size_t i = 0; i < RADIOLIB_LORAWAN_MAX_NUM_FIXED_CHANNELS / 16; i++) {
+    if(this->channelMasks[i] & this->channelDrMasks[dr][i]) {
+      return(true);
+    }
+  }
+  return(false);
+}
+
 int16_t LoRaWANNode::setTxPower(int8_t txPower) {
   // if called before activation, already create a session
   if(this->sessionStatus == RADIOLIB_LORAWAN_SESSION_NONE) {
@@ -3169,6 +4194,14 @@ int16_t LoRaWANNode::setTxPower(int8_t txPower) {
   return(RADIOLIB_ERR_NONE);
 }
 
+int8_t LoRaWANNode::getTxPower() {
+  return(this->txPowerMax - 2*this->txPowerSteps);
+}
+
+int8_t LoRaWANNode::getTxPowerMax() {
+  return(this->txPowerMax);
+}
+
 int16_t LoRaWANNode::setRx2Dr(uint8_t dr) {
   // this can only be configured in ABP mode
   if(this->lwMode != RADIOLIB_LORAWAN_MODE_ABP) {
@@ -3205,6 +4238,10 @@ void LoRaWANNode::setADR(bool enable) {
   this->adrEnabled = enable;
 }
 
+bool LoRaWANNode::getADR() {
+  return(this->adrEnabled);
+}
+
 void LoRaWANNode::setDutyCycle(bool enable, RadioLibTime_t msPerHour) {
   this->dutyCycleEnabled = enable;
   if(!enable) {
@@ -3464,57 +4501,105 @@ void LoRaWANNode::enableDefaultChannels(bool addDynamic) {
   }
 }
 
-bool LoRaWANNode::calculateChannelFlags() {
-  // clear all flags
-  memset(this->channelFlags, 0, sizeof(this->channelFlags));
-  bool any = false;
-
-  uint8_t drUp = this->channels[RADIOLIB_LORAWAN_UPLINK].dr;
+void LoRaWANNode::initChannelDrMasks() {
+  memset(this->channelDrMasks, 0, sizeof(this->channelDrMasks));
+  memset(this->dcChannels, 0, sizeof(this->dcChannels));
 
+  // dynamic channels are added one by one as they are configured
   if(this->band->bandType == RADIOLIB_LORAWAN_BAND_DYNAMIC) {
-    for(size_t i = 0; i < RADIOLIB_LORAWAN_MAX_NUM_DYNAMIC_CHANNELS; i++) {
-      // skip channel if not available
-      if((this->channelMasks[0] & (0x0001 << i)) == 0) {
-        continue;
-      }
-      // check if datarate is allowed for this channel
-      if(drUp >= this->dynamicChannels[RADIOLIB_LORAWAN_UPLINK][i].drMin \
-          && drUp <= this->dynamicChannels[RADIOLIB_LORAWAN_UPLINK][i].drMax) {
-        this->channelFlags[0] |= (0x0001 << i);
-        any = true;
-      }
+    for(uint8_t i = 0; i < RADIOLIB_LORAWAN_MAX_NUM_DYNAMIC_CHANNELS; i++) {
+      this->updateChannelDrMask(i);
     }
+    return;
+  }
 
-  } else {                // RADIOLIB_LORAWAN_BAND_FIXED
-    // during activation of fixed bands, flag all available channels
-    // the datarate will be determined from there
-    if(!this->isActivated()) {
-      memcpy(this->channelFlags, this->channelMasks, sizeof(this->channelMasks));
-      return(true);
+  // fixed bands never change, the spans follow each other in the channel index
+  uint8_t offs = 0;
+  for(uint8_t span = 0; span < this->band->numTxSpans; span++) {
+    const LoRaWANChannelSpan_t* txSpan = &this->band->txSpans[span];
+    for(uint8_t dr = txSpan->drMin; (dr <= txSpan->drMax) && (dr < RADIOLIB_LORAWAN_CHANNEL_NUM_DATARATES); dr++) {
+      for(uint8_t i = offs; i < offs + txSpan->numChannels; i++) {
+        this->channelDrMasks[dr][i/16] |= (0x0001 << (i % 16));
+      }
     }
+    offs += txSpan->numChannels;
+  }
+}
 
-    // check first frequency span to see if the datarate is allowed and any channel is available
-    if(drUp >= this->band->txSpans[0].drMin && drUp <= this->band->txSpans[0].drMax) {
-      // if the datarate is OK, all channel in this span can be used
-      for(int i = 0; i < this->band->txSpans[0].numChannels / 16; i++) {
-        this->channelFlags[i] = this->channelMasks[i];
-        if(this->channelMasks[i]) {
-          any = true;
-        }
-      }
+void LoRaWANNode::updateChannelDrMask(uint8_t idx) {
+  const LoRaWANChannel_t* chnl = &this->dynamicChannels[RADIOLIB_LORAWAN_UPLINK][idx];
+  uint16_t bit = (0x0001 << idx);
+  for(uint8_t dr = 0; dr < RADIOLIB_LORAWAN_CHANNEL_NUM_DATARATES; dr++) {
+    this->channelDrMasks[dr][0] &= ~bit;
+    if(chnl->freq && (dr >= chnl->drMin) && (dr <= chnl->drMax)) {
+      this->channelDrMasks[dr][0] |= bit;
     }
+  }
 
-    // check second frequency span to see if the datarate is allowed and any channel is available
-    if(drUp >= this->band->txSpans[1].drMin && drUp <= this->band->txSpans[1].drMax) {
-      this->channelFlags[4] = this->channelMasks[4];
-      if(this->channelMasks[4]) {
-        any = true;
-      }
+  // also keep track of the duty-cycle sub-band this channel falls into
+  for(uint8_t b = 0; b <= RADIOLIB_LORAWAN_DC_BAND_OTHER; b++) {
+    this->dcChannels[b] &= ~bit;
+  }
+  int8_t b = chnl->freq ? this->getDutyCycleBand(chnl->freq) : -1;
+  if(b >= 0) {
+    this->dcChannels[b] |= bit;
+  }
+}
+
+bool LoRaWANNode::calculateChannelFlags() {
+  // during activation of fixed bands, flag all available channels
+  // the datarate will be determined from there
+  if((this->band->bandType == RADIOLIB_LORAWAN_BAND_FIXED) && !this->isActivated()) {
+    memcpy(this->channelFlags, this->channelMasks, sizeof(this->channelMasks));
+    return(true);
+  }
+
+  // clear all flags
+  memset(this->channelFlags, 0, sizeof(this->channelFlags));
+  uint8_t drUp = this->channels[RADIOLIB_LORAWAN_UPLINK].dr;
+  if(drUp >= RADIOLIB_LORAWAN_CHANNEL_NUM_DATARATES) {
+    return(false);
+  }
+
+  // the available channels are the enabled ones that allow the current datarate
+  bool any = false;
+  for(int i = 0; i < RADIOLIB_LORAWAN_MAX_NUM_FIXED_CHANNELS / 16; i++) {
+    this->channelFlags[i] = this->channelMasks[i] & this->channelDrMasks[drUp][i];
+    if(this->channelFlags[i]) {
+      any = true;
     }
   }
   return(any);
 }
 
+bool LoRaWANNode::selectRandomChannel(const uint16_t* mask, uint8_t* idx) {
+  uint8_t total = 0;
+  for(int i = 0; i < RADIOLIB_LORAWAN_MAX_NUM_FIXED_CHANNELS / 16; i++) {
+    total += rlb_popcount(mask[i]);
+  }
+  if(total == 0) {
+    return(false);
+  }
+
+  // find the word that contains the n-th set bit, then clear the lower set bits in it
+  uint8_t n = rand() % total;
+  for(int i = 0; i < RADIOLIB_LORAWAN_MAX_NUM_FIXED_CHANNELS / 16; i++) {
+    uint8_t cnt = rlb_popcount(mask[i]);
+    if(n >= cnt) {
+      n -= cnt;
+      continue;
+    }
+    uint16_t word = mask[i];
+    for(; n > 0; n--) {
+      word &= word - 1;
+    }
+    // number of zeros below the lowest set bit
+    *idx = i*16 + rlb_popcount((uint16_t)((word & -word) - 1));
+    break;
+  }
+  return(true);
+}
+
 int16_t LoRaWANNode::selectChannels() {
   // save the current uplink datarate
   uint8_t uplinkDr = this->channels[RADIOLIB_LORAWAN_UPLINK].dr;
@@ -3564,16 +4649,39 @@ int16_t LoRaWANNode::selectChannels() {
     }
   }
 
-  // select a random channel index using reservoir sampling
+  // mask of the channel indices between start and end
+  uint16_t range[RADIOLIB_LORAWAN_MAX_NUM_FIXED_CHANNELS / 16];
+  for(int i = 0; i < RADIOLIB_LORAWAN_MAX_NUM_FIXED_CHANNELS / 16; i++) {
+    int lo = start - i*16;
+    int hi = end - i*16;
+    lo = lo < 0 ? 0 : lo;
+    hi = hi > 16 ? 16 : hi;
+    range[i] = (hi > lo) ? (uint16_t)((0xFFFFUL >> (16 - (hi - lo))) << lo) : 0;
+  }
+
+  // select a random channel index from the available ones
+  // channels in duty-cycle sub-bands that are not free yet are skipped - if that leaves nothing,
+  // try again with all enabled channels, and if even that fails, ignore the sub-bands
   uint8_t idx = 0;
-  uint8_t seen = 0;
-  for(int i = start; i < end; i++) {
-    if(this->channelFlags[i/16] & (0x0001 << (i % 16))) {
-      seen++;
-      if(rand() % seen == 0) {
-        idx = i;
+  bool found = false;
+  bool perBand = this->isDutyCyclePerBand() && (this->band->bandType == RADIOLIB_LORAWAN_BAND_DYNAMIC);
+  uint16_t freeMask = perBand ? this->getFreeChannelMask(this->tUplink) : 0xFFFF;
+  uint16_t candidates[RADIOLIB_LORAWAN_MAX_NUM_FIXED_CHANNELS / 16];
+  for(int pass = 0; (pass < 3) && !found; pass++) {
+    if(pass == 1) {
+      if(!perBand) {
+        break;
       }
+      (void)this->calculateChannelFlags();
     }
+    for(int i = 0; i < RADIOLIB_LORAWAN_MAX_NUM_FIXED_CHANNELS / 16; i++) {
+      candidates[i] = this->channelFlags[i] & range[i];
+    }
+    // dynamic bands only use the first word
+    if(pass < 2) {
+      candidates[0] &= freeMask;
+    }
+    found = this->selectRandomChannel(candidates, &idx);
   }
 
   // remove the channel from the available channels
@@ -3675,49 +4783,166 @@ RadioLibTime_t LoRaWANNode::dutyCycleInterval(RadioLibTime_t msPerHour, RadioLib
 
 RadioLibTime_t LoRaWANNode::timeUntilUplink() {
   Module* mod = this->phyLayer->getMod();
-  RadioLibTime_t nextUplink = this->tUplinkEnd + dutyCycleInterval(this->dutyCycle, this->lastToA);
+  RadioLibTime_t nextUplink = this->getNextUplinkTime();
   if(mod->hal->millis() > nextUplink){
     return(0);
   }
   return(nextUplink - mod->hal->millis() + 1);
 }
 
-uint8_t LoRaWANNode::getMaxPayloadLen() {
-  uint8_t minLen = 0;
-  uint8_t maxLen = this->band->payloadLenMax[this->channels[RADIOLIB_LORAWAN_UPLINK].dr];
-  if(this->packages[RADIOLIB_LORAWAN_PACKAGE_TS011].enabled) {
-    maxLen = RADIOLIB_MIN(maxLen, 222); // payload length is limited to N=222 if under repeater
+bool LoRaWANNode::isDutyCyclePerBand() {
+  // the aggregate duty cycle imposed by the network or the user still applies to all sub-bands together
+  return(this->dutyCycleEnabled && (this->band->dcBands[0].dutyCycle > 0));
+}
+
+int8_t LoRaWANNode::getDutyCycleBand(uint32_t freq) {
+  int8_t i = 0;
+  for(; i < RADIOLIB_LORAWAN_MAX_NUM_DC_BANDS; i++) {
+    const LoRaWANDutyCycleBand_t* dcBand = &this->band->dcBands[i];
+    if(dcBand->dutyCycle == 0) {
+      break;
+    }
+    if((freq >= dcBand->freqStart) && (freq < dcBand->freqEnd)) {
+      return(i);
+    }
   }
-  maxLen += 13;                         // mandatory FHDR is 12/13 bytes
 
-  // if not limited by dwell-time, just return maximum
-  if(!this->dwellTimeUp) {
-    // subtract FHDR (13 bytes) as well as any FOpts
-    return(maxLen - 13 - this->fOptsUpLen);
+  // in a band with sub-bands, anything in between is still limited by the band-wide duty cycle
+  if((i > 0) && (this->band->dutyCycle > 0)) {
+    return(RADIOLIB_LORAWAN_DC_BAND_OTHER);
   }
+  return(-1);
+}
 
-  const uint8_t currentDr = this->channels[RADIOLIB_LORAWAN_UPLINK].dr;
-  const ModemType_t modem = this->band->dataRates[currentDr].modem;
-  const DataRate_t* dr = &this->band->dataRates[currentDr].dr;
-  const PacketConfig_t* pc = &this->band->dataRates[currentDr].pc;
+RadioLibTime_t LoRaWANNode::getDutyCycleLimit(uint8_t dcBand) {
+  if(dcBand == RADIOLIB_LORAWAN_DC_BAND_OTHER) {
+    return(this->band->dutyCycle);
+  }
+  return(this->band->dcBands[dcBand].dutyCycle);
+}
 
-  // fast exit in case upper limit is already good
-  if(this->phyLayer->calculateTimeOnAir(modem, *dr, *pc, maxLen) / 1000 <= this->dwellTimeUp) {
-    // subtract FHDR (13 bytes) as well as any FOpts
-    return(maxLen - 13 - this->fOptsUpLen);
+void LoRaWANNode::recordDutyCycle(uint32_t freq, RadioLibTime_t tEnd, RadioLibTime_t toa) {
+  int8_t b = this->getDutyCycleBand(freq);
+  if(b < 0) {
+    return;
   }
 
-  // do some binary search to find maximum allowed length
-  uint8_t curLen = (minLen + maxLen) / 2;
-  while(curLen != minLen && curLen != maxLen) {
-    if(this->phyLayer->calculateTimeOnAir(modem, *dr, *pc, curLen) / 1000 > this->dwellTimeUp) {
-      maxLen = curLen;
-    } else {
-      minLen = curLen;
+  // drop uplinks that already left the observation window
+  while((this->dcLen[b] > 0) && (this->dcEnd[b][this->dcHead[b]] + RADIOLIB_LORAWAN_DC_WINDOW_MS <= tEnd)) {
+    this->dcHead[b] = (this->dcHead[b] + 1) % RADIOLIB_LORAWAN_DC_HISTORY_SIZE;
+    this->dcLen[b]--;
+  }
+
+  // if the history is still full, merge the two oldest uplinks
+  // this may overestimate the used airtime, but it never underestimates it
+  if(this->dcLen[b] == RADIOLIB_LORAWAN_DC_HISTORY_SIZE) {
+    uint8_t next = (this->dcHead[b] + 1) % RADIOLIB_LORAWAN_DC_HISTORY_SIZE;
+    this->dcToA[b][next] += this->dcToA[b][this->dcHead[b]];
+    this->dcHead[b] = next;
+    this->dcLen[b]--;
+  }
+
+  uint8_t pos = (this->dcHead[b] + this->dcLen[b]) % RADIOLIB_LORAWAN_DC_HISTORY_SIZE;
+  this->dcEnd[b][pos] = tEnd;
+  this->dcToA[b][pos] = toa;
+  this->dcLen[b]++;
+
+  // update the cached time, assuming the next uplink will be as long as this one
+  this->dcFree[b] = this->getDutyCycleFree(b, toa);
+}
+
+RadioLibTime_t LoRaWANNode::getDutyCycleFree(uint8_t dcBand, RadioLibTime_t toa) {
+  RadioLibTime_t total = toa;
+  for(uint8_t i = 0; i < this->dcLen[dcBand]; i++) {
+    total += this->dcToA[dcBand][(this->dcHead[dcBand] + i) % RADIOLIB_LORAWAN_DC_HISTORY_SIZE];
+  }
+
+  // drop the oldest uplinks until the new one fits, the sub-band is free once the last dropped one leaves the window
+  RadioLibTime_t tFree = 0;
+  RadioLibTime_t limit = this->getDutyCycleLimit(dcBand);
+  for(uint8_t i = 0; (i < this->dcLen[dcBand]) && (total > limit); i++) {
+    uint8_t pos = (this->dcHead[dcBand] + i) % RADIOLIB_LORAWAN_DC_HISTORY_SIZE;
+    total -= this->dcToA[dcBand][pos];
+    tFree = this->dcEnd[dcBand][pos] + RADIOLIB_LORAWAN_DC_WINDOW_MS;
+  }
+  return(tFree);
+}
+
+bool LoRaWANNode::isChannelFree(uint32_t freq, RadioLibTime_t t) {
+  if(!this->isDutyCyclePerBand()) {
+    return(true);
+  }
+  int8_t b = this->getDutyCycleBand(freq);
+  if(b < 0) {
+    return(true);
+  }
+  return(this->dcFree[b] <= t);
+}
+
+uint16_t LoRaWANNode::getFreeChannelMask(RadioLibTime_t t) {
+  uint16_t mask = 0xFFFF;
+  for(uint8_t b = 0; b <= RADIOLIB_LORAWAN_DC_BAND_OTHER; b++) {
+    if(this->dcFree[b] > t) {
+      mask &= ~this->dcChannels[b];
+    }
+  }
+  return(mask);
+}
+
+RadioLibTime_t LoRaWANNode::getNextUplinkTime() {
+  // aggregate budget, based on the airtime of the last uplink sequence
+  RadioLibTime_t tAggregate = this->tUplinkEnd + dutyCycleInterval(this->dutyCycle, this->lastToA);
+  if(!this->isDutyCyclePerBand() || (this->band->bandType != RADIOLIB_LORAWAN_BAND_DYNAMIC)) {
+    return(tAggregate);
+  }
+
+  // on top of that, the earliest of the sub-bands that have an enabled channel
+  // channels outside of all sub-bands have their own entry, so every enabled channel is covered
+  bool found = false;
+  RadioLibTime_t tNext = 0;
+  for(uint8_t b = 0; b <= RADIOLIB_LORAWAN_DC_BAND_OTHER; b++) {
+    if((this->channelMasks[0] & this->dcChannels[b]) && (!found || (this->dcFree[b] < tNext))) {
+      tNext = this->dcFree[b];
+      found = true;
     }
+  }
+  return(RADIOLIB_MAX(tAggregate, tNext));
+}
+
+uint8_t LoRaWANNode::getMaxPayloadLen() {
+  return(this->getMaxPayloadLen(this->channels[RADIOLIB_LORAWAN_UPLINK].dr));
+}
+
+uint8_t LoRaWANNode::getMaxPayloadLen(uint8_t dr) {
+  if(dr >= RADIOLIB_LORAWAN_CHANNEL_NUM_DATARATES) {
+    return(0);
+  }
+  uint8_t minLen = 0;
+  uint8_t maxLen = this->band->payloadLenMax[dr];
+  if(this->packages[RADIOLIB_LORAWAN_PACKAGE_TS011].enabled) {
+    maxLen = RADIOLIB_MIN(maxLen, 222); // payload length is limited to N=222 if under repeater
+  }
+  maxLen += 13;                         // mandatory FHDR is 12/13 bytes
+
+  // if not limited by dwell-time, just return maximum
+  uint8_t curLen = maxLen;
+  if(this->dwellTimeUp && (this->calculateTimeOnAir(dr, maxLen) / 1000 > this->dwellTimeUp)) {
+    // do some binary search to find maximum allowed length
     curLen = (minLen + maxLen) / 2;
+    while(curLen != minLen && curLen != maxLen) {
+      if(this->calculateTimeOnAir(dr, curLen) / 1000 > this->dwellTimeUp) {
+        maxLen = curLen;
+      } else {
+        minLen = curLen;
+      }
+      curLen = (minLen + maxLen) / 2;
+    }
   }
+
   // subtract FHDR (13 bytes) as well as any FOpts
+  if(curLen < 13 + this->fOptsUpLen) {
+    return(0);
+  }
   return(curLen - 13 - this->fOptsUpLen);
 }
 
@@ -3818,6 +5043,22 @@ void LoRaWANNode::processAES(const uint8_t* in, size_t len, uint8_t* key, uint8_
   }
 }
 
+RadioLibTime_t LoRaWANNode::calculateTimeOnAir(uint8_t dr, size_t len) {
+  // the cache is direct-mapped, the slot is selected by payload length
+  // this works well because the typical queries are the same few lengths at the current datarate
+  LoRaWANTimeOnAir_t* entry = &this->toaCache[len % RADIOLIB_LORAWAN_TOA_CACHE_SIZE];
+  if((entry->dr == dr) && (entry->len == len)) {
+    return(entry->toa);
+  }
+
+  // cache miss, calculate and store the new value
+  const LoRaWANDataRate_t* dataRate = &this->band->dataRates[dr];
+  entry->dr = dr;
+  entry->len = len;
+  entry->toa = this->phyLayer->calculateTimeOnAir(dataRate->modem, dataRate->dr, dataRate->pc, len);
+  return(entry->toa);
+}
+
 void LoRaWANNode::sleepDelay(RadioLibTime_t ms, bool radioOff) {
   // if the duration is short, just call delay
   if(ms <= 2 || ms <= RADIOLIB_LORAWAN_DELAY_SLEEP_THRESHOLD) {
@@ -39,6 +39,7 @@
 #define RADIOLIB_LORAWAN_FCTRL_ADR_ACK_REQ                      (0x01 << 6) //  6     6     adaptive data rate ACK request
 #define RADIOLIB_LORAWAN_FCTRL_ACK                              (0x01 << 5) //  5     5     confirmed message acknowledge
 #define RADIOLIB_LORAWAN_FCTRL_FRAME_PENDING                    (0x01 << 4) //  4     4     downlink frame is pending
+#define RADIOLIB_LORAWAN_FCTRL_CLASS_B                          (0x01 << 4) //  4     4     uplink from Class B device
 
 // fPort field
 #define RADIOLIB_LORAWAN_FPORT_MAC_COMMAND                      (0x00 << 0) //  7     0     payload contains MAC commands only
@@ -173,6 +174,9 @@
 #define RADIOLIB_LORAWAN_MAC_DEVICE_TIME                        (0x0D)
 #define RADIOLIB_LORAWAN_MAC_FORCE_REJOIN                       (0x0E)
 #define RADIOLIB_LORAWAN_MAC_REJOIN_PARAM_SETUP                 (0x0F)
+#define RADIOLIB_LORAWAN_MAC_PING_SLOT_INFO                     (0x10)
+#define RADIOLIB_LORAWAN_MAC_PING_SLOT_CHANNEL                  (0x11)
+#define RADIOLIB_LORAWAN_MAC_BEACON_FREQ                        (0x13)
 #define RADIOLIB_LORAWAN_MAC_DEVICE_MODE                        (0x20)
 #define RADIOLIB_LORAWAN_MAC_PROPRIETARY                        (0x80)
 
@@ -209,12 +213,61 @@
 
 #define RADIOLIB_LORAWAN_MAX_PAYLOAD_SIZE                      (242)
 
+// number of cached time-on-air values
+#define RADIOLIB_LORAWAN_TOA_CACHE_SIZE                         (8)
+
+// regulatory duty-cycle sub-bands, number of tracked uplinks per sub-band and the observation window
+// channels outside of all sub-bands are tracked in one extra entry, against the band-wide duty cycle
+#define RADIOLIB_LORAWAN_MAX_NUM_DC_BANDS                       (6)
+#define RADIOLIB_LORAWAN_DC_BAND_OTHER                          (RADIOLIB_LORAWAN_MAX_NUM_DC_BANDS)
+#define RADIOLIB_LORAWAN_DC_HISTORY_SIZE                        (8)
+#define RADIOLIB_LORAWAN_DC_WINDOW_MS                           (3600000UL)
+
 // session states
 #define RADIOLIB_LORAWAN_SESSION_NONE                           (0x00)
 #define RADIOLIB_LORAWAN_SESSION_ACTIVATING                     (0x01)
 #define RADIOLIB_LORAWAN_SESSION_PENDING                        (0x02)
 #define RADIOLIB_LORAWAN_SESSION_ACTIVE                         (0x03)
 
+// non-blocking uplink/downlink cycle states, Rx states must be in pending/active order
+// these are a separate state machine, so they may overlap with the session states
+#define RADIOLIB_LORAWAN_CYCLE_IDLE                             (0x00)
+#define RADIOLIB_LORAWAN_CYCLE_TX_PENDING                       (0x01)
+#define RADIOLIB_LORAWAN_CYCLE_TX_ACTIVE                        (0x02)
+#define RADIOLIB_LORAWAN_CYCLE_RX1_PENDING                      (0x03)
+#define RADIOLIB_LORAWAN_CYCLE_RX1_ACTIVE                       (0x04)
+#define RADIOLIB_LORAWAN_CYCLE_RX2_PENDING                      (0x05)
+#define RADIOLIB_LORAWAN_CYCLE_RX2_ACTIVE                       (0x06)
+
+// Class B beacon and ping slot timing
+#define RADIOLIB_LORAWAN_BEACON_PERIOD_MS                       (128000UL)
+#define RADIOLIB_LORAWAN_BEACON_RESERVED_MS                     (2120)
+#define RADIOLIB_LORAWAN_BEACON_GUARD_MS                        (3000)
+#define RADIOLIB_LORAWAN_BEACON_DELAY_US                        (1500)      // beacon is sent this long after the start of the period
+#define RADIOLIB_LORAWAN_BEACON_PREAMBLE_LEN                    (10)
+#define RADIOLIB_LORAWAN_BEACON_LESS_PERIOD_MS                  (7200000UL) // Class B is abandoned after 2 hours without beacon
+#define RADIOLIB_LORAWAN_BEACON_CLOCK_PPM                       (40)        // residual clock error after drift compensation
+#define RADIOLIB_LORAWAN_PING_SLOT_LEN_MS                       (30)
+#define RADIOLIB_LORAWAN_PING_SLOTS                             (4096)
+#define RADIOLIB_LORAWAN_PING_PERIODICITY_MAX                   (7)
+
+// Class B beacon frame layout (without the RFU fields, which are band-specific)
+#define RADIOLIB_LORAWAN_BEACON_TIME_LEN                        (4)
+#define RADIOLIB_LORAWAN_BEACON_CRC_LEN                         (2)
+#define RADIOLIB_LORAWAN_BEACON_INFO_LEN                        (7)
+#define RADIOLIB_LORAWAN_BEACON_LEN(RFU1, RFU2)                 ((RFU1) + 4 + 2 + 7 + (RFU2) + 2)
+#define RADIOLIB_LORAWAN_BEACON_MAX_LEN                         RADIOLIB_LORAWAN_BEACON_LEN(5, 3)
+
+// Class B states, the window states must be in pending/staged/active order
+#define RADIOLIB_LORAWAN_CLASS_B_IDLE                           (0x00)
+#define RADIOLIB_LORAWAN_CLASS_B_SEARCH                         (0x01)
+#define RADIOLIB_LORAWAN_CLASS_B_PENDING                        (0x02)
+#define RADIOLIB_LORAWAN_CLASS_B_STAGED                         (0x03)
+#define RADIOLIB_LORAWAN_CLASS_B_ACTIVE                         (0x04)
+
+// time the radio is woken up before a Class B window is opened, in ms
+#define RADIOLIB_LORAWAN_CLASS_B_WAKE_MS                        (5)
+
 // threshold at which sleeping via user callback enabled, in ms
 #define RADIOLIB_LORAWAN_DELAY_SLEEP_THRESHOLD                  (50)
 
@@ -257,6 +310,9 @@ constexpr LoRaWANMacCommand_t MacTable[RADIOLIB_LORAWAN_NUM_MAC_COMMANDS] = {
   { RADIOLIB_LORAWAN_MAC_DEVICE_TIME,         5, 0, false, true  },
   { RADIOLIB_LORAWAN_MAC_FORCE_REJOIN,        2, 0, false, false },
   { RADIOLIB_LORAWAN_MAC_REJOIN_PARAM_SETUP,  1, 1, false, false },
+  { RADIOLIB_LORAWAN_MAC_PING_SLOT_INFO,      0, 1, true,  false },
+  { RADIOLIB_LORAWAN_MAC_PING_SLOT_CHANNEL,   4, 1, false, false },
+  { RADIOLIB_LORAWAN_MAC_BEACON_FREQ,         3, 1, false, false },
   { RADIOLIB_LORAWAN_MAC_DEVICE_MODE,         1, 1, true,  false },
   { RADIOLIB_LORAWAN_MAC_PROPRIETARY,         5, 0, false, true  },
 };
@@ -401,6 +457,51 @@ struct LoRaWANChannelSpan_t {
   uint8_t drJoinRequest;
 };
 
+/*!
+  \struct LoRaWANDutyCycleBand_t
+  \brief Structure to save information about a regulatory duty-cycle sub-band
+*/
+struct LoRaWANDutyCycleBand_t {
+  /*! \brief Lowest frequency of the sub-band (coded in 100 Hz steps) */
+  uint32_t freqStart;
+
+  /*! \brief End of the sub-band, exclusive (coded in 100 Hz steps) */
+  uint32_t freqEnd;
+
+  /*! \brief Number of milliseconds per hour of allowed Time-on-Air in this sub-band */
+  RadioLibTime_t dutyCycle;
+};
+
+/*!
+  \struct LoRaWANBeacon_t
+  \brief Structure to save the Class B beacon parameters of a band.
+*/
+struct LoRaWANBeacon_t {
+  /*! \brief Beacon frequency, or the first frequency of the hopping sequence (coded in 100 Hz steps). 0 if Class B is not supported */
+  uint32_t freqStart;
+
+  /*! \brief Frequency step of the hopping sequence (coded in 100 Hz steps) */
+  uint32_t freqStep;
+
+  /*! \brief Number of beacon channels, 1 if the beacon does not hop */
+  uint8_t numChannels;
+
+  /*! \brief Beacon datarate, also the default ping slot datarate */
+  uint8_t dr;
+
+  /*! \brief Length of the RFU field in front of the beacon time */
+  uint8_t rfu1;
+
+  /*! \brief Length of the RFU field after the gateway-specific field */
+  uint8_t rfu2;
+};
+
+// alias for bands without Class B
+#define RADIOLIB_LORAWAN_BEACON_NONE    { .freqStart = 0, .freqStep = 0, .numChannels = 0, .dr = 0, .rfu1 = 0, .rfu2 = 0 }
+
+// alias for unused duty-cycle sub-band
+#define RADIOLIB_LORAWAN_DC_BAND_NONE    { .freqStart = 0, .freqEnd = 0, .dutyCycle = 0 }
+
 // alias for unused channel span
 #define RADIOLIB_LORAWAN_CHANNEL_SPAN_NONE    { .numChannels = 0, .freqStart = 0, .freqStep = 0, .drMin = 0, .drMax = 0, .drJoinRequest = RADIOLIB_LORAWAN_DATA_RATE_UNUSED }
 
@@ -412,6 +513,21 @@ struct LoRaWANDataRate_t {
 
 #define RADIOLIB_DATARATE_NONE { .modem = RADIOLIB_MODEM_NONE, .dr = {.lora = {0, 0, 0}}, .pc = {.lora = { 8, 0, 0, 0}}}
 
+/*!
+  \struct LoRaWANTimeOnAir_t
+  \brief Structure to save a cached time-on-air value.
+*/
+struct LoRaWANTimeOnAir_t {
+  /*! \brief Datarate index the value was calculated for, RADIOLIB_LORAWAN_DATA_RATE_UNUSED for empty entry */
+  uint8_t dr;
+
+  /*! \brief Physical payload length in bytes */
+  uint16_t len;
+
+  /*! \brief Time-on-air in microseconds */
+  RadioLibTime_t toa;
+};
+
 /*!
   \struct LoRaWANBand_t
   \brief Structure to save information about LoRaWAN band
@@ -475,6 +591,13 @@ struct LoRaWANBand_t {
   
   /*! \brief The corresponding datarates, bandwidths and coding rates for DR index */
   LoRaWANDataRate_t dataRates[RADIOLIB_LORAWAN_CHANNEL_NUM_DATARATES];
+
+  /*! \brief Regulatory duty-cycle sub-bands, tracked separately. If none are set, only the aggregate duty cycle is used.
+  Channels outside of all sub-bands are tracked together against the band-wide dutyCycle. */
+  LoRaWANDutyCycleBand_t dcBands[RADIOLIB_LORAWAN_MAX_NUM_DC_BANDS];
+
+  /*! \brief Class B beacon and default ping slot channel */
+  LoRaWANBeacon_t beacon;
 };
 
 // supported bands
@@ -556,6 +679,9 @@ struct LoRaWANEvent_t {
   
   /*! \brief Transmit power in dBm for uplink, or RSSI for downlink */
   int16_t power;
+
+  /*! \brief SNR in dB for downlink, 0 for uplink */
+  float snr;
   
   /*! \brief The appropriate frame counter - for different events, different frame counters will be reported! */
   uint32_t fCnt;
@@ -572,7 +698,7 @@ struct LoRaWANEvent_t {
 
 /*!
   \class LoRaWANNode
-  \brief LoRaWAN-compatible node (class A device).
+  \brief LoRaWAN-compatible node (class A device, with optional class B and C support).
 */
 class LoRaWANNode {
   public:
@@ -585,6 +711,11 @@ class LoRaWANNode {
     */
     LoRaWANNode(PhysicalLayer* phy, const LoRaWANBand_t* band, uint8_t subBand = 0);
 
+    /*!
+      \brief Default destructor. Releases the message of a non-blocking cycle that was not finished.
+    */
+    virtual ~LoRaWANNode();
+
     /*!
       \brief Returns the pointer to the internal buffer that holds the LW base parameters
       \returns Pointer to uint8_t array of size RADIOLIB_LORAWAN_NONCES_BUF_SIZE
@@ -655,7 +786,11 @@ class LoRaWANNode {
     /*! \brief Whether there is an ongoing session active */
     bool isActivated();
 
-    /*! \brief Configure class (RADIOLIB_LORAWAN_CLASS_A or RADIOLIB_LORAWAN_CLASS_C) */
+    /*!
+      \brief Configure class (RADIOLIB_LORAWAN_CLASS_A, RADIOLIB_LORAWAN_CLASS_B or RADIOLIB_LORAWAN_CLASS_C).
+      Class B requires the beacon to be tracked, see acquireBeacon().
+      \returns \ref status_codes
+    */
     int16_t setClass(uint8_t cls);
 
     /*!
@@ -749,6 +884,47 @@ class LoRaWANNode {
     */
     virtual int16_t sendReceive(const uint8_t* dataUp, size_t lenUp, uint8_t fPort, uint8_t* dataDown, size_t* lenDown, bool isConfirmed = false, LoRaWANEvent_t* eventUp = NULL, LoRaWANEvent_t* eventDown = NULL);
 
+    /*!
+      \brief Non-blocking version of sendReceive. Prepares the uplink and returns immediately,
+      the uplink and Class A receive windows are then handled by repeatedly calling process().
+      Only available in Class A and B. All pointers must remain valid until the cycle is finished.
+      \param dataUp Data to send.
+      \param lenUp Length of the data.
+      \param fPort Port number to send the message to.
+      \param dataDown Buffer to save received data into.
+      \param lenDown Pointer to variable that will be used to save the number of received bytes.
+      \param isConfirmed Whether to send a confirmed uplink or not.
+      \param eventUp Pointer to a structure to store extra information about the uplink event
+      (fPort, frame counter, etc.). If set to NULL, no extra information will be passed to the user.
+      \param eventDown Pointer to a structure to store extra information about the downlink event
+      (fPort, frame counter, etc.). If set to NULL, no extra information will be passed to the user.
+      \returns \ref status_codes
+    */
+    int16_t startSendReceive(const uint8_t* dataUp, size_t lenUp, uint8_t fPort, uint8_t* dataDown, size_t* lenDown, bool isConfirmed = false, LoRaWANEvent_t* eventUp = NULL, LoRaWANEvent_t* eventDown = NULL);
+
+    /*!
+      \brief Advance the non-blocking uplink/downlink cycle started by startSendReceive.
+      Never waits for the radio, so it should be called when the deadline returned by getNextDeadline() is reached,
+      or when the radio IRQ pin fires, whichever comes first.
+      \returns RADIOLIB_LORAWAN_CYCLE_PENDING (positive, not an error) while the cycle is in progress,
+      otherwise the same as sendReceive: window number > 0 if downlink was received, 0 is no downlink was received
+      (or no cycle is in progress), or \ref status_codes. Check for RADIOLIB_LORAWAN_CYCLE_PENDING first,
+      as it is also greater than 0.
+    */
+    int16_t process();
+
+    /*!
+      \brief Get the time at which process() must be called next.
+      \returns Deadline in milliseconds based on internal clock, 0 if no cycle is in progress.
+    */
+    RadioLibTime_t getNextDeadline();
+
+    /*!
+      \brief Cancel the non-blocking uplink/downlink cycle started by startSendReceive, and put the radio to standby.
+      If the uplink was already transmitted, its frame counter is not used again. Does nothing if no cycle is in progress.
+    */
+    void cancelSendReceive();
+
     /*!
       \brief Check if there is an RxC downlink and parse it if available.
       \param dataDown Buffer to save received data into.
@@ -759,6 +935,78 @@ class LoRaWANNode {
     */
     int16_t getDownlinkClassC(uint8_t* dataDown, size_t* lenDown, LoRaWANEvent_t* eventDown = NULL);
 
+    /*!
+      \brief Search for the Class B beacon and wait until it is received (blocking).
+      The beacon must be tracked before switching to Class B. On bands where the beacon hops (e.g. US915),
+      the search stays on the first beacon channel, so it may take up to one full hopping sequence.
+      \param timeout Maximum search time in milliseconds. If set to 0, one full hopping sequence is used.
+      \returns \ref status_codes
+    */
+    int16_t acquireBeacon(RadioLibTime_t timeout = 0);
+
+    /*!
+      \brief Start searching for the Class B beacon without blocking.
+      The search and the subsequent beacon tracking are then handled by processClassB().
+      Sending an uplink cancels the search.
+      \param timeout Maximum search time in milliseconds. If set to 0, one full hopping sequence is used.
+      \returns \ref status_codes
+    */
+    int16_t startBeaconAcquisition(RadioLibTime_t timeout = 0);
+
+    /*!
+      \brief Stop beacon tracking. If the device is in Class B, it reverts to Class A.
+    */
+    void stopBeaconTracking();
+
+    /*!
+      \brief Track the Class B beacon and serve the ping slots, without blocking.
+      Must be called at the time returned by getNextClassBDeadline(), and as soon as possible once the radio
+      interrupt fires, as the reception time of the beacon keeps the ping slots in sync with the network.
+      Uplink/downlink cycles always take priority, any Class B window that collides with one is skipped.
+      \param dataDown Buffer to save received data into.
+      \param lenDown Pointer to variable that will be used to save the number of received bytes.
+      \param eventDown Pointer to a structure to store extra information about the downlink event
+      (fPort, frame counter, etc.). If set to NULL, no extra information will be passed to the user.
+      \returns RADIOLIB_LORAWAN_RX_BC if a ping slot downlink was received, 0 otherwise, or \ref status_codes.
+      RADIOLIB_ERR_NO_BEACON is returned when the search failed, or when the beacon was lost and the device reverted to Class A.
+    */
+    int16_t processClassB(uint8_t* dataDown, size_t* lenDown, LoRaWANEvent_t* eventDown = NULL);
+
+    /*!
+      \brief Get the time at which processClassB() must be called next.
+      \returns Deadline in milliseconds based on internal clock, 0 if the beacon is not searched for or tracked.
+    */
+    RadioLibTime_t getNextClassBDeadline();
+
+    /*! \brief Whether the Class B beacon is currently tracked */
+    bool isBeaconLocked();
+
+    /*!
+      \brief Get the contents of the last received beacon.
+      \param gpsTime Start of the current beacon period in seconds since GPS epoch (Jan. 6th 1980).
+      \param gwSpecific Buffer of RADIOLIB_LORAWAN_BEACON_INFO_LEN bytes to save the gateway-specific field into, may be NULL.
+      \returns \ref status_codes
+    */
+    int16_t getBeaconInfo(uint32_t* gpsTime, uint8_t* gwSpecific = NULL);
+
+    /*!
+      \brief Set the Class B ping slot periodicity. This queues a PingSlotInfoReq MAC command,
+      the new periodicity is used once the network has acknowledged it.
+      \param periodicity The device opens 2^(7 - periodicity) ping slots per beacon period, 
+      so 0 means every 0.96 seconds and 7 every 128 seconds.
+      \returns \ref status_codes
+    */
+    int16_t setPingSlotPeriodicity(uint8_t periodicity);
+
+    /*!
+      \brief Calculate the offset of the first ping slot in a beacon period.
+      \param beaconTime Start of the beacon period in seconds since GPS epoch.
+      \param devAddr Device address.
+      \param pingPeriod Number of slots between two ping slots of the device.
+      \returns Slot offset, lower than pingPeriod.
+    */
+    static uint16_t calculatePingOffset(uint32_t beaconTime, uint32_t devAddr, uint16_t pingPeriod);
+
     /*!
       \brief Add a MAC command to the uplink queue.
       Only LinkCheck and DeviceTime are available to the user. 
@@ -795,6 +1043,19 @@ class LoRaWANNode {
     */
     int16_t setDatarate(uint8_t drUp);
 
+    /*!
+      \brief Get uplink datarate.
+      \returns Datarate used for uplinks.
+    */
+    uint8_t getDatarate();
+
+    /*!
+      \brief Check whether any of the enabled channels allows a datarate for uplinks.
+      \param dr Datarate to check.
+      \returns Whether the datarate can be used.
+    */
+    bool isDatarateEnabled(uint8_t dr);
+
     /*!
       \brief Configure TX power of the radio module.
       \param txPower Output power during TX mode to be set in dBm.
@@ -802,6 +1063,18 @@ class LoRaWANNode {
     */
     int16_t setTxPower(int8_t txPower);
 
+    /*!
+      \brief Get TX power used for uplinks.
+      \returns Output power in dBm.
+    */
+    int8_t getTxPower();
+
+    /*!
+      \brief Get the maximum TX power, as limited by the band and the radio.
+      \returns Output power in dBm.
+    */
+    int8_t getTxPowerMax();
+
     /*! 
       \brief Configure the Rx2 datarate for ABP mode.
       This should not be needed for LoRaWAN 1.1 as it is configured through the first downlink.
@@ -816,6 +1089,12 @@ class LoRaWANNode {
     */
     void setADR(bool enable = true);
 
+    /*!
+      \brief Check whether ADR is enabled.
+      \returns Whether the network controls the datarate and TX power.
+    */
+    bool getADR();
+
     /*!
       \brief Toggle adherence to dutyCycle limits to on or off.
       \param enable Whether to adhere to dutyCycle limits or not (default true).
@@ -921,7 +1200,10 @@ class LoRaWANNode {
     */
     RadioLibTime_t dutyCycleInterval(RadioLibTime_t msPerHour, RadioLibTime_t airtime);
 
-    /*! \brief Returns time in milliseconds until next uplink is available under dutyCycle limits */
+    /*!
+      \brief Returns time in milliseconds until next uplink is available under dutyCycle limits.
+      In bands with duty-cycle sub-bands, this is the time until any of the sub-bands with an enabled channel is free.
+    */
     RadioLibTime_t timeUntilUplink();
 
     /*! 
@@ -930,6 +1212,38 @@ class LoRaWANNode {
     */
     uint8_t getMaxPayloadLen();
 
+    /*! 
+      \brief Returns the maximum allowed uplink payload size at a given datarate.
+      \param dr Datarate to check.
+    */
+    uint8_t getMaxPayloadLen(uint8_t dr);
+
+    /*!
+      \brief 16-bit checksum of a buffer of even length, as used to sign the Nonces and Session buffers.
+      \param key Buffer to calculate the checksum of.
+      \param keyLen Length of the buffer in bytes.
+      \returns Checksum.
+    */
+    static uint16_t checkSum16(const uint8_t *key, uint16_t keyLen);
+
+    /*!
+      \brief Network-to-host conversion, reads a value in the byte order used in LoRaWAN packets and buffers.
+      \param buff Buffer to read from.
+      \param size Number of bytes to read, 0 for the whole type.
+      \returns Value in host byte order.
+    */
+    template<typename T>
+    static T ntoh(const uint8_t* buff, size_t size = 0);
+
+    /*!
+      \brief Host-to-network conversion, writes a value in the byte order used in LoRaWAN packets and buffers.
+      \param buff Buffer to write to.
+      \param val Value in host byte order.
+      \param size Number of bytes to write, 0 for the whole type.
+    */
+    template<typename T>
+    static void hton(uint8_t* buff, T val, size_t size = 0);
+
     /*! \brief Callback to a user-provided sleep function. */
     typedef void (*SleepCb_t)(RadioLibTime_t ms);
 
@@ -1089,6 +1403,9 @@ class LoRaWANNode {
     uint16_t channelMasks[RADIOLIB_LORAWAN_MAX_NUM_FIXED_CHANNELS / 16] = { 0 };
     uint16_t channelFlags[RADIOLIB_LORAWAN_MAX_NUM_FIXED_CHANNELS / 16] = { 0 };
 
+    // per-datarate masks of the channels that allow that datarate, regardless of whether they are enabled
+    uint16_t channelDrMasks[RADIOLIB_LORAWAN_CHANNEL_NUM_DATARATES][RADIOLIB_LORAWAN_MAX_NUM_FIXED_CHANNELS / 16] = { { 0 } };
+
     // currently configured channels for Tx, Rx1, Rx2, RxBC
     LoRaWANChannel_t channels[4] = { RADIOLIB_LORAWAN_CHANNEL_NONE, RADIOLIB_LORAWAN_CHANNEL_NONE,
                                      RADIOLIB_LORAWAN_CHANNEL_NONE, RADIOLIB_LORAWAN_CHANNEL_NONE };
@@ -1111,6 +1428,21 @@ class LoRaWANNode {
     // Time on Air of last uplink
     RadioLibTime_t lastToA = 0;
 
+    // cached time-on-air values, the band (and therefore datarate table) does not change for the lifetime of the node
+    LoRaWANTimeOnAir_t toaCache[RADIOLIB_LORAWAN_TOA_CACHE_SIZE];
+
+    // per sub-band duty-cycle history: ring buffers of uplink end timestamps and their airtime (oldest at dcHead)
+    // dcFree caches the earliest time each sub-band can take another uplink as long as the last one
+    // the last entry is RADIOLIB_LORAWAN_DC_BAND_OTHER
+    RadioLibTime_t dcEnd[RADIOLIB_LORAWAN_MAX_NUM_DC_BANDS + 1][RADIOLIB_LORAWAN_DC_HISTORY_SIZE] = { { 0 } };
+    RadioLibTime_t dcToA[RADIOLIB_LORAWAN_MAX_NUM_DC_BANDS + 1][RADIOLIB_LORAWAN_DC_HISTORY_SIZE] = { { 0 } };
+    uint8_t dcHead[RADIOLIB_LORAWAN_MAX_NUM_DC_BANDS + 1] = { 0 };
+    uint8_t dcLen[RADIOLIB_LORAWAN_MAX_NUM_DC_BANDS + 1] = { 0 };
+    RadioLibTime_t dcFree[RADIOLIB_LORAWAN_MAX_NUM_DC_BANDS + 1] = { 0 };
+
+    // masks of the dynamic channels in each duty-cycle sub-band
+    uint16_t dcChannels[RADIOLIB_LORAWAN_MAX_NUM_DC_BANDS + 1] = { 0 };
+
     // timestamp to measure the Rx1/2 delay (from uplink end)
     RadioLibTime_t tUplinkEnd = 0;
 
@@ -1129,6 +1461,60 @@ class LoRaWANNode {
     // user-provided sleep callback
     SleepCb_t sleepCb = nullptr;
 
+    // state of the non-blocking uplink/downlink cycle
+    uint8_t cycleState = RADIOLIB_LORAWAN_CYCLE_IDLE;
+    RadioLibTime_t cycleDeadline = 0;
+    #if RADIOLIB_STATIC_ONLY
+    uint8_t cycleMsg[RADIOLIB_STATIC_ARRAY_SIZE];
+    #else
+    uint8_t* cycleMsg = NULL;
+    #endif
+    size_t cycleMsgLen = 0;
+    uint8_t cycleFPort = 0;
+    bool cycleConfirmed = false;
+    uint8_t cycleTrans = 0;
+    RadioLibTime_t cycleToA = 0;
+    RadioLibTime_t cycleRxOpen = 0;
+    RadioLibTime_t cycleRxTimeout = 0;
+    RadioLibTime_t cycleRxMaxToA = 0;
+    uint8_t cycleMaxPayLen = 0;
+    bool cycleRxBusy = false;
+    uint8_t* cycleDataDown = NULL;
+    size_t* cycleLenDown = NULL;
+    LoRaWANEvent_t* cycleEventUp = NULL;
+    LoRaWANEvent_t* cycleEventDown = NULL;
+
+    // state of Class B beacon tracking and ping slots
+    uint8_t classBState = RADIOLIB_LORAWAN_CLASS_B_IDLE;
+    bool classBBeacon = false;
+    RadioLibTime_t classBDeadline = 0;
+    RadioLibTime_t classBOpen = 0;
+    RadioLibTime_t classBRxOpen = 0;
+    RadioLibTime_t classBRxTimeout = 0;
+    RadioLibTime_t classBRxMaxToA = 0;
+    uint8_t classBMaxPayLen = 0;
+    bool classBRxBusy = false;
+
+    // beacon period as seen by the internal clock: start of the current period (ms + us),
+    // its GPS time, and the measured length of a period in microseconds
+    bool beaconLocked = false;
+    RadioLibTime_t beaconRef = 0;
+    uint16_t beaconRefUs = 0;
+    uint32_t beaconTime = 0;
+    uint32_t beaconPeriodUs = RADIOLIB_LORAWAN_BEACON_PERIOD_MS*1000UL;
+    RadioLibTime_t beaconLastRx = 0;
+    uint16_t beaconMissed = 0;
+    uint8_t beaconInfo[RADIOLIB_LORAWAN_BEACON_INFO_LEN] = { 0 };
+    uint32_t beaconFreq = 0;
+
+    // ping slots, frequency of 0 and unused datarate select the band defaults
+    uint8_t pingPeriodicity = RADIOLIB_LORAWAN_PING_PERIODICITY_MAX;
+    uint8_t pingPeriodicityReq = RADIOLIB_LORAWAN_PING_PERIODICITY_MAX;
+    uint16_t pingOffset = 0;
+    uint16_t pingSlot = 0;
+    uint32_t pingFreq = 0;
+    uint8_t pingDr = RADIOLIB_LORAWAN_DATA_RATE_UNUSED;
+
     // this will reset the device credentials, so the device starts completely new
     void clearNonces();
 
@@ -1146,6 +1532,18 @@ class LoRaWANNode {
 
     // check whether payload length and fport are allowed
     int16_t isValidUplink(size_t len, uint8_t fPort);
+
+    // check whether an uplink can be sent now, and prepare the MAC state for it
+    int16_t prepareUplink(size_t lenUp, uint8_t fPort);
+
+    // move user data or MAC commands into the FRMPayload and compose the encrypted uplink
+    void buildUplink(const uint8_t* dataUp, size_t lenUp, uint8_t* uplinkMsg, uint8_t fPort, bool isConfirmed);
+
+    // select uplink/downlink channels (with CSMA if enabled) and generate the MIC
+    void selectUplinkChannels(uint8_t* uplinkMsg, size_t uplinkMsgLen);
+
+    // update counters and process the downlink after the uplink/downlink cycle is done
+    int16_t completeUplink(int16_t state, uint8_t trans, uint8_t fPort, bool isConfirmed, uint8_t* dataDown, size_t* lenDown, LoRaWANEvent_t* eventUp, LoRaWANEvent_t* eventDown);
     
     // perform ADR backoff
     void adrBackoff();
@@ -1159,9 +1557,61 @@ class LoRaWANNode {
     // transmit uplink buffer on a specified channel
     int16_t transmitUplink(const LoRaWANChannel_t* chnl, uint8_t* in, uint8_t len);
 
+    // configure the radio for uplink, returns the time-on-air in ms
+    int16_t stageUplink(const LoRaWANChannel_t* chnl, uint8_t* in, uint8_t len, RadioLibTime_t* toa);
+
+    // start the staged uplink transmission
+    int16_t launchUplink();
+
+    // clean up after uplink transmission is done
+    int16_t finishUplink(RadioLibTime_t toa);
+
     // handle one of the Class A receive windows with a given channel and certain timestamps
     int16_t receiveClassA(uint8_t dir, const LoRaWANChannel_t* dlChannel, uint8_t window, const RadioLibTime_t dlDelay, RadioLibTime_t tReference);
 
+    // configure the radio for a receive window, without opening it
+    // the window is widened on both sides by the given amount (in us) to account for clock drift,
+    // widened (Class B) LoRa windows only wait for the preamble
+    int16_t stageRxWindow(uint8_t dir, const LoRaWANChannel_t* dlChannel, RadioLibTime_t* timeoutUs, RadioLibTime_t* toaMaxMs, uint8_t* maxPayLen, RadioLibTime_t widenUs = 0);
+
+    // open the staged receive window
+    int16_t launchRxWindow(uint8_t window, RadioLibTime_t* tOpen);
+
+    // close a receive window, returns the window number if a valid downlink was received, 0 otherwise
+    int16_t closeRxWindow(uint8_t window, uint8_t maxPayLen, bool received);
+
+    // non-blocking cycle helpers
+    int16_t stageCycleWindow(uint8_t window);
+    int16_t finishCycle(int16_t state);
+    void stopCycle();
+
+    // Class B helpers
+    int16_t searchBeacon();
+    int16_t stageBeaconWindow(RadioLibTime_t timeoutUs);
+    int16_t stageClassBWindow();
+    int16_t closeClassBWindow(bool received, uint8_t* dataDown, size_t* lenDown, LoRaWANEvent_t* eventDown);
+    int16_t skipClassBWindow();
+    void abortClassBWindow();
+
+    // schedule the next beacon or ping slot that can still be opened at the given time
+    int16_t scheduleClassB(RadioLibTime_t tNow);
+
+    // check a received beacon and synchronize to it, tRx is the time at which the reception ended
+    int16_t parseBeacon(RadioLibTime_t tRx);
+
+    // predict the next beacon period after a beacon was not received
+    void advanceBeaconPeriod();
+
+    // get the channel of the beacon or the ping slots in the current beacon period
+    void getBeaconChannel(LoRaWANChannel_t* chnl);
+    void getPingChannel(LoRaWANChannel_t* chnl);
+
+    // convert an offset from the start of the current beacon period to internal clock time
+    RadioLibTime_t getBeaconPeriodTime(RadioLibTime_t offset);
+
+    // receive window widening in us needed at a given time to account for clock drift since the last beacon
+    RadioLibTime_t getBeaconWidening(RadioLibTime_t t);
+
     // handle a Class C receive window with timeout (between Class A windows) or without (between uplinks)
     int16_t receiveClassC(RadioLibTime_t timeout = 0);
 
@@ -1191,6 +1641,9 @@ class LoRaWANNode {
     // get the properties of a MAC command given a certain command ID
     int16_t getMacCommand(uint8_t cid, LoRaWANMacCommand_t* cmd);
 
+    // constant-time lookup of a standard MAC command in MacTable, NULL if it is not in the base specification
+    static const LoRaWANMacCommand_t* findMacCommand(uint8_t cid);
+
     // possible override for additional MAC commands that are not in the base specification
     virtual int16_t derivedMacFinder(uint8_t cid, LoRaWANMacCommand_t* cmd);
 
@@ -1228,10 +1681,19 @@ class LoRaWANNode {
     // enable all default channels on top of the current channels
     void enableDefaultChannels(bool addDynamic = false);
 
+    // build the per-datarate channel masks from scratch
+    void initChannelDrMasks();
+
+    // update the per-datarate channel masks after a dynamic channel was changed
+    void updateChannelDrMask(uint8_t idx);
+
     // calculate which channels are available given the current datarate
     // returns true if there is any such channel, false otherwise
     bool calculateChannelFlags();
 
+    // pick a random channel index out of a channel mask, returns false if the mask is empty
+    static bool selectRandomChannel(const uint16_t* mask, uint8_t* idx);
+
     // select a set of random TX/RX channels for up- and downlink
     int16_t selectChannels();
 
@@ -1245,22 +1707,39 @@ class LoRaWANNode {
     // function to encrypt and decrypt payloads (regular uplink/downlink)
     void processAES(const uint8_t* in, size_t len, uint8_t* key, uint8_t* out, uint32_t addr, uint32_t fCnt, uint8_t dir, uint8_t ctrId, bool counter);
 
+    // get time-on-air in microseconds for a given datarate and physical payload length, using cached values if possible
+    RadioLibTime_t calculateTimeOnAir(uint8_t dr, size_t len);
+
+    // whether duty cycle is also tracked per sub-band, on top of the aggregate budget
+    bool isDutyCyclePerBand();
+
+    // get index of the duty-cycle sub-band a frequency falls into
+    // RADIOLIB_LORAWAN_DC_BAND_OTHER if it is outside of all of them, -1 if it is not limited per sub-band
+    int8_t getDutyCycleBand(uint32_t freq);
+
+    // get number of milliseconds per hour of allowed Time-on-Air in a duty-cycle sub-band, 0 if it is not used
+    RadioLibTime_t getDutyCycleLimit(uint8_t dcBand);
+
+    // add an uplink to the duty-cycle history of the sub-band it was sent in
+    void recordDutyCycle(uint32_t freq, RadioLibTime_t tEnd, RadioLibTime_t toa);
+
+    // earliest time an uplink with the given airtime fits into the duty-cycle budget of a sub-band
+    RadioLibTime_t getDutyCycleFree(uint8_t dcBand, RadioLibTime_t toa);
+
+    // check whether the sub-band of a channel is free at the given time
+    bool isChannelFree(uint32_t freq, RadioLibTime_t t);
+
+    // get mask of the dynamic channels whose sub-band is free at the given time
+    uint16_t getFreeChannelMask(RadioLibTime_t t);
+
+    // earliest time the next uplink can be sent under all duty-cycle limits
+    RadioLibTime_t getNextUplinkTime();
+
     // function that allows sleeping via user-provided callback
     void sleepDelay(RadioLibTime_t ms, bool radioOff = true);
 
-    // 16-bit checksum method that takes a uint8_t array of even length and calculates the checksum
-    static uint16_t checkSum16(const uint8_t *key, uint16_t keyLen);
-
     // check the integrity of a buffer using a 16-bit checksum located in the last two bytes of the buffer
     static int16_t checkBufferCommon(const uint8_t *buffer, uint16_t size);
-
-    // network-to-host conversion method - takes data from network packet and converts it to the host endians
-    template<typename T>
-    static T ntoh(const uint8_t* buff, size_t size = 0);
-
-    // host-to-network conversion method - takes data from host variable and and converts it to network packet endians
-    template<typename T>
-    static void hton(uint8_t* buff, T val, size_t size = 0);
 };
 
 template<typename T>
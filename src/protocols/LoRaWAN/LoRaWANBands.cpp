@@ -82,7 +82,16 @@ const LoRaWANBand_t EU868 = {
     RADIOLIB_DATARATE_NONE,
     RADIOLIB_DATARATE_NONE,
     RADIOLIB_DATARATE_NONE
-  }
+  },
+  .dcBands = {
+    { .freqStart = 8630000, .freqEnd = 8650000, .dutyCycle = 3600 },    // 0.1 %
+    { .freqStart = 8650000, .freqEnd = 8680000, .dutyCycle = 36000 },   // 1 %
+    { .freqStart = 8680000, .freqEnd = 8686000, .dutyCycle = 36000 },   // 1 %
+    { .freqStart = 8687000, .freqEnd = 8692000, .dutyCycle = 3600 },    // 0.1 %
+    { .freqStart = 8694000, .freqEnd = 8696500, .dutyCycle = 360000 },  // 10 %
+    { .freqStart = 8697000, .freqEnd = 8700000, .dutyCycle = 36000 },   // 1 %
+  },
+  .beacon = { .freqStart = 8695250, .freqStep = 0, .numChannels = 1, .dr = 3, .rfu1 = 2, .rfu2 = 0 }
 };
 
 const LoRaWANBand_t US915 = {
@@ -171,7 +180,11 @@ const LoRaWANBand_t US915 = {
     { .modem = RADIOLIB_MODEM_LORA,   .dr = {.lora = { 8, 500, 5}}, .pc = {.lora = {8, false, true, false}}},
     { .modem = RADIOLIB_MODEM_LORA,   .dr = {.lora = { 7, 500, 5}}, .pc = {.lora = {8, false, true, false}}},
     RADIOLIB_DATARATE_NONE
-  }
+  },
+  .dcBands = {
+    RADIOLIB_LORAWAN_DC_BAND_NONE
+  },
+  .beacon = { .freqStart = 9233000, .freqStep = 6000, .numChannels = 8, .dr = 8, .rfu1 = 5, .rfu2 = 3 }
 };
 
 const LoRaWANBand_t EU433 = {
@@ -239,7 +252,11 @@ const LoRaWANBand_t EU433 = {
     RADIOLIB_DATARATE_NONE,
     RADIOLIB_DATARATE_NONE,
     RADIOLIB_DATARATE_NONE
-  }
+  },
+  .dcBands = {
+    RADIOLIB_LORAWAN_DC_BAND_NONE
+  },
+  .beacon = { .freqStart = 4346650, .freqStep = 0, .numChannels = 1, .dr = 3, .rfu1 = 2, .rfu2 = 0 }
 };
 
 const LoRaWANBand_t AU915 = {
@@ -328,7 +345,11 @@ const LoRaWANBand_t AU915 = {
     { .modem = RADIOLIB_MODEM_LORA,   .dr = {.lora = { 8, 500, 5}}, .pc = {.lora = {8, false, true, false}}},
     { .modem = RADIOLIB_MODEM_LORA,   .dr = {.lora = { 7, 500, 5}}, .pc = {.lora = {8, false, true, false}}},
     RADIOLIB_DATARATE_NONE
-  }
+  },
+  .dcBands = {
+    RADIOLIB_LORAWAN_DC_BAND_NONE
+  },
+  .beacon = RADIOLIB_LORAWAN_BEACON_NONE
 };
 
 const LoRaWANBand_t CN470 = {
@@ -410,7 +431,11 @@ const LoRaWANBand_t CN470 = {
     RADIOLIB_DATARATE_NONE,
     RADIOLIB_DATARATE_NONE,
     RADIOLIB_DATARATE_NONE
-  }
+  },
+  .dcBands = {
+    RADIOLIB_LORAWAN_DC_BAND_NONE
+  },
+  .beacon = RADIOLIB_LORAWAN_BEACON_NONE
 };
 
 const LoRaWANBand_t AS923 = {
@@ -478,7 +503,11 @@ const LoRaWANBand_t AS923 = {
     RADIOLIB_DATARATE_NONE,
     RADIOLIB_DATARATE_NONE,
     RADIOLIB_DATARATE_NONE
-  }
+  },
+  .dcBands = {
+    RADIOLIB_LORAWAN_DC_BAND_NONE
+  },
+  .beacon = { .freqStart = 9234000, .freqStep = 0, .numChannels = 1, .dr = 3, .rfu1 = 2, .rfu2 = 0 }
 };
 
 const LoRaWANBand_t AS923_2 = {
@@ -546,7 +575,11 @@ const LoRaWANBand_t AS923_2 = {
     RADIOLIB_DATARATE_NONE,
     RADIOLIB_DATARATE_NONE,
     RADIOLIB_DATARATE_NONE
-  }
+  },
+  .dcBands = {
+    RADIOLIB_LORAWAN_DC_BAND_NONE
+  },
+  .beacon = { .freqStart = 9216000, .freqStep = 0, .numChannels = 1, .dr = 3, .rfu1 = 2, .rfu2 = 0 }
 };
 
 const LoRaWANBand_t AS923_3 = {
@@ -614,7 +647,11 @@ const LoRaWANBand_t AS923_3 = {
     RADIOLIB_DATARATE_NONE,
     RADIOLIB_DATARATE_NONE,
     RADIOLIB_DATARATE_NONE
-  }
+  },
+  .dcBands = {
+    RADIOLIB_LORAWAN_DC_BAND_NONE
+  },
+  .beacon = { .freqStart = 9168000, .freqStep = 0, .numChannels = 1, .dr = 3, .rfu1 = 2, .rfu2 = 0 }
 };
 
 const LoRaWANBand_t AS923_4 = {
@@ -682,7 +719,11 @@ const LoRaWANBand_t AS923_4 = {
     RADIOLIB_DATARATE_NONE,
     RADIOLIB_DATARATE_NONE,
     RADIOLIB_DATARATE_NONE
-  }
+  },
+  .dcBands = {
+    RADIOLIB_LORAWAN_DC_BAND_NONE
+  },
+  .beacon = { .freqStart = 9175000, .freqStep = 0, .numChannels = 1, .dr = 3, .rfu1 = 2, .rfu2 = 0 }
 };
 
 const LoRaWANBand_t KR920 = {
@@ -750,7 +791,11 @@ const LoRaWANBand_t KR920 = {
     RADIOLIB_DATARATE_NONE,
     RADIOLIB_DATARATE_NONE,
     RADIOLIB_DATARATE_NONE
-  }
+  },
+  .dcBands = {
+    RADIOLIB_LORAWAN_DC_BAND_NONE
+  },
+  .beacon = { .freqStart = 9231000, .freqStep = 0, .numChannels = 1, .dr = 3, .rfu1 = 2, .rfu2 = 0 }
 };
 
 const LoRaWANBand_t IN865 = {
@@ -818,7 +863,11 @@ const LoRaWANBand_t IN865 = {
     RADIOLIB_DATARATE_NONE,
     RADIOLIB_DATARATE_NONE,
     RADIOLIB_DATARATE_NONE
-  }
+  },
+  .dcBands = {
+    RADIOLIB_LORAWAN_DC_BAND_NONE
+  },
+  .beacon = RADIOLIB_LORAWAN_BEACON_NONE
 };
 
 #endif
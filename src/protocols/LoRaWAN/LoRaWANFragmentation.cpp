@@ -0,0 +1,391 @@
+#include "LoRaWANFragmentation.h"
+#include <string.h>
+
+#if !RADIOLIB_EXCLUDE_LORAWAN
+
+// pseudo-random generator used by the TS004 fragmentation matrix
+static uint32_t prbs23(uint32_t x) {
+  uint32_t b0 = x & 0x01;
+  uint32_t b1 = (x & 0x20) >> 5;
+  return((x >> 1) + ((b0 ^ b1) << 22));
+}
+
+LoRaWANFragmentation::LoRaWANFragmentation(LoRaWANFragStorage* storage) {
+  this->storage = storage;
+}
+
+int16_t LoRaWANFragmentation::handleDownlink(const uint8_t* dataDown, size_t lenDown) {
+  if(!dataDown) {
+    return(RADIOLIB_ERR_NULL_POINTER);
+  }
+
+  // a single downlink may carry multiple commands, except for data fragments
+  size_t pos = 0;
+  while(pos < lenDown) {
+    uint8_t cid = dataDown[pos++];
+    const uint8_t* req = &dataDown[pos];
+    size_t remaining = lenDown - pos;
+
+    switch(cid) {
+      case(RADIOLIB_LORAWAN_FRAG_CMD_PACKAGE_VERSION): {
+        uint8_t ans[] = { cid, RADIOLIB_LORAWAN_FRAG_PACKAGE_ID, RADIOLIB_LORAWAN_FRAG_PACKAGE_VERSION };
+        pushAnswer(ans, sizeof(ans));
+        pos += RADIOLIB_LORAWAN_FRAG_PACKAGE_VERSION_REQ_LEN;
+      } break;
+
+      case(RADIOLIB_LORAWAN_FRAG_CMD_SESSION_STATUS): {
+        if(remaining < RADIOLIB_LORAWAN_FRAG_SESSION_STATUS_REQ_LEN) {
+          return(RADIOLIB_ERR_INVALID_PAYLOAD);
+        }
+        bool allParticipants = req[0] & 0x01;
+        uint8_t index = (req[0] >> 1) & 0x03;
+        pos += RADIOLIB_LORAWAN_FRAG_SESSION_STATUS_REQ_LEN;
+
+        // only answer when the session exists, and either has not finished yet or everyone should answer
+        if(!this->active || (index != this->fragIndex) || (this->complete && !allParticipants)) {
+          break;
+        }
+        uint16_t missing = getMissing();
+        uint8_t ans[] = {
+          cid,
+          (uint8_t)(this->nbRx & 0xFF),
+          (uint8_t)(((this->nbRx >> 8) & 0x3F) | (index << 6)),
+          (uint8_t)(missing > 0xFF ? 0xFF : missing),
+          0x00,
+        };
+        pushAnswer(ans, sizeof(ans));
+      } break;
+
+      case(RADIOLIB_LORAWAN_FRAG_CMD_SESSION_SETUP): {
+        if(remaining < RADIOLIB_LORAWAN_FRAG_SESSION_SETUP_REQ_LEN) {
+          return(RADIOLIB_ERR_INVALID_PAYLOAD);
+        }
+        uint8_t index = (req[0] & RADIOLIB_LORAWAN_FRAG_SESSION_INDEX_MASK) >> 4;
+        uint16_t nb = (uint16_t)req[1] | ((uint16_t)req[2] << 8);
+        uint8_t size = req[3];
+        uint8_t algo = (req[4] & RADIOLIB_LORAWAN_FRAG_CONTROL_ALGO_MASK) >> 3;
+        uint8_t pad = req[5];
+        uint32_t desc = (uint32_t)req[6] | ((uint32_t)req[7] << 8) | ((uint32_t)req[8] << 16) | ((uint32_t)req[9] << 24);
+        pos += RADIOLIB_LORAWAN_FRAG_SESSION_SETUP_REQ_LEN;
+
+        // only a single session with the default matrix is supported
+        uint8_t status = index << 6;
+        if(algo != 0) {
+          status |= RADIOLIB_LORAWAN_FRAG_SETUP_ENCODING_UNSUPPORTED;
+        }
+        if((nb == 0) || (nb > RADIOLIB_LORAWAN_FRAG_MAX_NB) || (size == 0) || (size > RADIOLIB_LORAWAN_FRAG_MAX_SIZE)) {
+          status |= RADIOLIB_LORAWAN_FRAG_SETUP_NOT_ENOUGH_MEMORY;
+        }
+        if(this->active && (index != this->fragIndex)) {
+          status |= RADIOLIB_LORAWAN_FRAG_SETUP_INDEX_UNSUPPORTED;
+        }
+        if((status & 0x3F) == 0) {
+          beginSession(nb, size, pad);
+          this->fragIndex = index;
+          this->descriptor = desc;
+        }
+        uint8_t ans[] = { cid, status };
+        pushAnswer(ans, sizeof(ans));
+      } break;
+
+      case(RADIOLIB_LORAWAN_FRAG_CMD_SESSION_DELETE): {
+        if(remaining < RADIOLIB_LORAWAN_FRAG_SESSION_DELETE_REQ_LEN) {
+          return(RADIOLIB_ERR_INVALID_PAYLOAD);
+        }
+        uint8_t index = req[0] & 0x03;
+        pos += RADIOLIB_LORAWAN_FRAG_SESSION_DELETE_REQ_LEN;
+
+        uint8_t status = index;
+        if(!this->active || (index != this->fragIndex)) {
+          status |= RADIOLIB_LORAWAN_FRAG_DELETE_NO_SESSION;
+        } else {
+          this->active = false;
+        }
+        uint8_t ans[] = { cid, status };
+        pushAnswer(ans, sizeof(ans));
+      } break;
+
+      case(RADIOLIB_LORAWAN_FRAG_CMD_DATA_FRAGMENT): {
+        if(remaining < RADIOLIB_LORAWAN_FRAG_DATA_FRAGMENT_HDR_LEN) {
+          return(RADIOLIB_ERR_INVALID_PAYLOAD);
+        }
+        uint16_t indexAndN = (uint16_t)req[0] | ((uint16_t)req[1] << 8);
+        uint8_t index = indexAndN >> 14;
+        uint16_t n = indexAndN & 0x3FFF;
+
+        // data fragment always spans the rest of the frame
+        size_t fragLen = remaining - RADIOLIB_LORAWAN_FRAG_DATA_FRAGMENT_HDR_LEN;
+        pos = lenDown;
+        if(!this->active || (index != this->fragIndex) || (fragLen != this->fragSize)) {
+          RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Dropping fragment %d", n);
+          break;
+        }
+        int16_t state = addFragment(n, &req[RADIOLIB_LORAWAN_FRAG_DATA_FRAGMENT_HDR_LEN]);
+        RADIOLIB_ASSERT(state);
+      } break;
+
+      default:
+        // unknown command, the rest of the frame cannot be parsed
+        return(RADIOLIB_ERR_INVALID_CID);
+    }
+  }
+
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t LoRaWANFragmentation::getUplink(uint8_t* dataUp, size_t* lenUp) {
+  if(!dataUp || !lenUp) {
+    return(RADIOLIB_ERR_NULL_POINTER);
+  }
+  memcpy(dataUp, this->answer, this->answerLen);
+  *lenUp = this->answerLen;
+  this->answerLen = 0;
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t LoRaWANFragmentation::beginSession(uint16_t nbFrag, uint8_t fragSize, uint8_t padding) {
+  if(!this->storage) {
+    return(RADIOLIB_ERR_NULL_POINTER);
+  }
+  if((nbFrag == 0) || (nbFrag > RADIOLIB_LORAWAN_FRAG_MAX_NB) || (fragSize == 0) || (fragSize > RADIOLIB_LORAWAN_FRAG_MAX_SIZE)) {
+    return(RADIOLIB_ERR_INVALID_PAYLOAD);
+  }
+
+  this->active = true;
+  this->complete = false;
+  this->fragIndex = 0;
+  this->nbFrag = nbFrag;
+  this->fragSize = fragSize;
+  this->padding = padding;
+  this->descriptor = 0;
+  this->nbRx = 0;
+  this->frozen = false;
+  this->nbLost = 0;
+  this->nbPivots = 0;
+  memset(this->received, 0, sizeof(this->received));
+  memset(this->pivots, 0, sizeof(this->pivots));
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t LoRaWANFragmentation::addFragment(uint16_t n, const uint8_t* data) {
+  if(!data) {
+    return(RADIOLIB_ERR_NULL_POINTER);
+  }
+  if(!this->active || (n == 0)) {
+    return(RADIOLIB_ERR_INVALID_PAYLOAD);
+  }
+  if(this->complete) {
+    return(RADIOLIB_ERR_NONE);
+  }
+  this->nbRx++;
+
+  size_t rowLen = (this->nbFrag + 7) / 8;
+  if(n <= this->nbFrag) {
+    // uncoded fragment
+    uint16_t i = n - 1;
+    if(TEST_BIT_IN_ARRAY_MSB(this->received, i)) {
+      return(RADIOLIB_ERR_NONE);
+    }
+
+    if(!this->frozen) {
+      // still in the systematic phase, just store it in place
+      int16_t state = this->storage->write((uint32_t)i * this->fragSize, data, this->fragSize);
+      RADIOLIB_ASSERT(state);
+      SET_BIT_IN_ARRAY_MSB(this->received, i);
+      if(getMissing() == 0) {
+        this->complete = true;
+      }
+      return(RADIOLIB_ERR_NONE);
+    }
+
+    // late uncoded fragment, handle it as a row with a single coefficient
+    memset(this->rowFull, 0, rowLen);
+    SET_BIT_IN_ARRAY_MSB(this->rowFull, i);
+
+  } else {
+    // coded fragment
+    if(!this->frozen) {
+      // freeze the set of lost fragments, from now on only the lost ones are unknown
+      this->nbLost = getMissing();
+      this->frozen = true;
+      if(this->nbLost == 0) {
+        this->complete = true;
+        return(RADIOLIB_ERR_NONE);
+      }
+    }
+    getParityRow(n - this->nbFrag, this->nbFrag, this->rowFull);
+  }
+
+  return(addRow(data));
+}
+
+bool LoRaWANFragmentation::isComplete() {
+  return(this->active && this->complete);
+}
+
+size_t LoRaWANFragmentation::getSize() {
+  return((size_t)this->nbFrag * this->fragSize - this->padding);
+}
+
+uint32_t LoRaWANFragmentation::getDescriptor() {
+  return(this->descriptor);
+}
+
+uint16_t LoRaWANFragmentation::getMissing() {
+  if(this->complete) {
+    return(0);
+  }
+  if(this->frozen) {
+    return(this->nbLost - this->nbPivots);
+  }
+
+  uint16_t missing = this->nbFrag;
+  size_t rowLen = (this->nbFrag + 7) / 8;
+  for(size_t i = 0; i < rowLen; i++) {
+    missing -= rlb_popcount(this->received[i]);
+  }
+  return(missing);
+}
+
+void LoRaWANFragmentation::getParityRow(uint16_t n, uint16_t m, uint8_t* row) {
+  memset(row, 0, (m + 7) / 8);
+
+  // if m is a power of 2, one more value is allowed from the generator
+  uint16_t mTemp = ((m & (m - 1)) == 0) ? 1 : 0;
+  uint32_t x = 1 + 1001*(uint32_t)n;
+  for(uint16_t nbCoeff = 0; nbCoeff < m/2; nbCoeff++) {
+    uint32_t r = (uint32_t)1 << 16;
+    while(r >= m) {
+      x = prbs23(x);
+      r = x % (m + mTemp);
+    }
+    SET_BIT_IN_ARRAY_MSB(row, r);
+  }
+}
+
+void LoRaWANFragmentation::pushAnswer(const uint8_t* ans, size_t len) {
+  if(this->answerLen + len > RADIOLIB_LORAWAN_FRAG_MAX_ANS_LEN) {
+    return;
+  }
+  memcpy(&this->answer[this->answerLen], ans, len);
+  this->answerLen += len;
+}
+
+int16_t LoRaWANFragmentation::addRow(const uint8_t* coded) {
+  // project the full row onto the lost fragments, subtracting everything that is already known
+  int16_t state = RADIOLIB_ERR_NONE;
+  size_t lostLen = getRowLen();
+  memcpy(this->data, coded, this->fragSize);
+  memset(this->row, 0, lostLen);
+  uint16_t lost = 0;
+  for(uint16_t i = 0; i < this->nbFrag; i++) {
+    bool known = TEST_BIT_IN_ARRAY_MSB(this->received, i);
+    if(TEST_BIT_IN_ARRAY_MSB(this->rowFull, i)) {
+      if(known) {
+        state = xorFrom((uint32_t)i * this->fragSize, this->data);
+        RADIOLIB_ASSERT(state);
+      } else {
+        SET_BIT_IN_ARRAY_MSB(this->row, lost);
+      }
+    }
+    if(!known) {
+      lost++;
+    }
+  }
+
+  // forward elimination, each pivot row k has its leading coefficient at position k
+  for(uint16_t k = 0; k < this->nbLost; k++) {
+    if(!TEST_BIT_IN_ARRAY_MSB(this->row, k)) {
+      continue;
+    }
+
+    if(!TEST_BIT_IN_ARRAY_MSB(this->pivots, k)) {
+      // new pivot, save it
+      state = this->storage->write(getRowAddr(k), this->row, lostLen);
+      RADIOLIB_ASSERT(state);
+      state = this->storage->write(getSlotAddr(k), this->data, this->fragSize);
+      RADIOLIB_ASSERT(state);
+      SET_BIT_IN_ARRAY_MSB(this->pivots, k);
+      this->nbPivots++;
+      if(this->nbPivots == this->nbLost) {
+        return(solve());
+      }
+      return(RADIOLIB_ERR_NONE);
+    }
+
+    // eliminate the coefficient using the existing pivot
+    state = this->storage->read(getRowAddr(k), this->rowTmp, lostLen);
+    RADIOLIB_ASSERT(state);
+    for(size_t j = 0; j < lostLen; j++) {
+      this->row[j] ^= this->rowTmp[j];
+    }
+    state = xorFrom(getSlotAddr(k), this->data);
+    RADIOLIB_ASSERT(state);
+  }
+
+  // row was linearly dependent on the ones already received
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t LoRaWANFragmentation::solve() {
+  // back substitution, the last pivot row only has a single coefficient
+  int16_t state = RADIOLIB_ERR_NONE;
+  size_t lostLen = getRowLen();
+  for(int32_t k = this->nbLost - 1; k >= 0; k--) {
+    state = this->storage->read(getRowAddr(k), this->rowTmp, lostLen);
+    RADIOLIB_ASSERT(state);
+    state = this->storage->read(getSlotAddr(k), this->data, this->fragSize);
+    RADIOLIB_ASSERT(state);
+    bool changed = false;
+    for(uint16_t j = k + 1; j < this->nbLost; j++) {
+      if(TEST_BIT_IN_ARRAY_MSB(this->rowTmp, j)) {
+        state = xorFrom(getSlotAddr(j), this->data);
+        RADIOLIB_ASSERT(state);
+        changed = true;
+      }
+    }
+    if(changed) {
+      state = this->storage->write(getSlotAddr(k), this->data, this->fragSize);
+      RADIOLIB_ASSERT(state);
+    }
+  }
+
+  // move the recovered fragments into their places
+  uint16_t k = 0;
+  for(uint16_t i = 0; i < this->nbFrag; i++) {
+    if(TEST_BIT_IN_ARRAY_MSB(this->received, i)) {
+      continue;
+    }
+    state = this->storage->read(getSlotAddr(k), this->data, this->fragSize);
+    RADIOLIB_ASSERT(state);
+    state = this->storage->write((uint32_t)i * this->fragSize, this->data, this->fragSize);
+    RADIOLIB_ASSERT(state);
+    k++;
+  }
+
+  this->complete = true;
+  return(RADIOLIB_ERR_NONE);
+}
+
+uint32_t LoRaWANFragmentation::getSlotAddr(uint16_t slot) {
+  return(((uint32_t)this->nbFrag + slot) * this->fragSize);
+}
+
+uint32_t LoRaWANFragmentation::getRowAddr(uint16_t slot) {
+  return(((uint32_t)this->nbFrag + this->nbLost) * this->fragSize + (uint32_t)slot * getRowLen());
+}
+
+size_t LoRaWANFragmentation::getRowLen() {
+  return((this->nbLost + 7) / 8);
+}
+
+int16_t LoRaWANFragmentation::xorFrom(uint32_t addr, uint8_t* dst) {
+  int16_t state = this->storage->read(addr, this->dataTmp, this->fragSize);
+  RADIOLIB_ASSERT(state);
+  for(size_t i = 0; i < this->fragSize; i++) {
+    dst[i] ^= this->dataTmp[i];
+  }
+  return(RADIOLIB_ERR_NONE);
+}
+
+#endif
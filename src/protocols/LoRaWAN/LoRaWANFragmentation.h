@@ -0,0 +1,209 @@
+#if !defined(_RADIOLIB_LORAWAN_FRAGMENTATION_H) && !RADIOLIB_EXCLUDE_LORAWAN
+#define _RADIOLIB_LORAWAN_FRAGMENTATION_H
+
+#include "../../TypeDef.h"
+#include "LoRaWAN.h"
+
+// maximum number of fragments and fragment size, these define the RAM used by the decoder
+#if !defined(RADIOLIB_LORAWAN_FRAG_MAX_NB)
+  #define RADIOLIB_LORAWAN_FRAG_MAX_NB                          (2048)
+#endif
+
+#if !defined(RADIOLIB_LORAWAN_FRAG_MAX_SIZE)
+  #define RADIOLIB_LORAWAN_FRAG_MAX_SIZE                        (RADIOLIB_LORAWAN_MAX_PAYLOAD_SIZE - 3)
+#endif
+
+// TS004 package identification
+#define RADIOLIB_LORAWAN_FRAG_PACKAGE_ID                        (0x03)
+#define RADIOLIB_LORAWAN_FRAG_PACKAGE_VERSION                   (0x01)
+
+// TS004 command identifiers
+#define RADIOLIB_LORAWAN_FRAG_CMD_PACKAGE_VERSION               (0x00)
+#define RADIOLIB_LORAWAN_FRAG_CMD_SESSION_STATUS                (0x01)
+#define RADIOLIB_LORAWAN_FRAG_CMD_SESSION_SETUP                 (0x02)
+#define RADIOLIB_LORAWAN_FRAG_CMD_SESSION_DELETE                (0x03)
+#define RADIOLIB_LORAWAN_FRAG_CMD_DATA_FRAGMENT                 (0x08)
+
+// TS004 request lengths, excluding command identifier
+#define RADIOLIB_LORAWAN_FRAG_PACKAGE_VERSION_REQ_LEN           (0)
+#define RADIOLIB_LORAWAN_FRAG_SESSION_STATUS_REQ_LEN            (1)
+#define RADIOLIB_LORAWAN_FRAG_SESSION_SETUP_REQ_LEN             (10)
+#define RADIOLIB_LORAWAN_FRAG_SESSION_DELETE_REQ_LEN            (1)
+#define RADIOLIB_LORAWAN_FRAG_DATA_FRAGMENT_HDR_LEN             (2)
+
+// maximum length of all answers to a single downlink
+#define RADIOLIB_LORAWAN_FRAG_MAX_ANS_LEN                       (16)
+
+// FragSessionSetupReq field encoding                                            MSB   LSB   DESCRIPTION
+#define RADIOLIB_LORAWAN_FRAG_SESSION_INDEX_MASK                (0x03 << 4) //  5     4     FragSession: FragIndex
+#define RADIOLIB_LORAWAN_FRAG_SESSION_MC_GROUP_MASK             (0x0F << 0) //  3     0                  McGroupBitMask
+#define RADIOLIB_LORAWAN_FRAG_CONTROL_ALGO_MASK                 (0x07 << 3) //  5     3     Control: FragmentationMatrix
+#define RADIOLIB_LORAWAN_FRAG_CONTROL_ACK_DELAY_MASK            (0x07 << 0) //  2     0              BlockAckDelay
+
+// FragSessionSetupAns status bits
+#define RADIOLIB_LORAWAN_FRAG_SETUP_ENCODING_UNSUPPORTED        (0x01 << 0) //  0     0     fragmentation matrix not supported
+#define RADIOLIB_LORAWAN_FRAG_SETUP_NOT_ENOUGH_MEMORY           (0x01 << 1) //  1     1     not enough memory
+#define RADIOLIB_LORAWAN_FRAG_SETUP_INDEX_UNSUPPORTED           (0x01 << 2) //  2     2     FragIndex not supported
+
+// FragSessionDeleteAns status bits
+#define RADIOLIB_LORAWAN_FRAG_DELETE_NO_SESSION                 (0x01 << 2) //  2     2     session does not exist
+
+/*!
+  \class LoRaWANFragStorage
+  \brief Storage backend for fragmented data block reception.
+  The decoder stores all fragments as well as its intermediate state in the backend,
+  so that RAM usage only depends on RADIOLIB_LORAWAN_FRAG_MAX_NB and RADIOLIB_LORAWAN_FRAG_MAX_SIZE.
+  For a session with M fragments of size S, of which L are lost, the backend must be able to hold
+  (M + L)*S + L*ceil(L/8) bytes. The data block itself is at offset 0.
+  If the backend is flash memory, it must be erased before the session starts.
+*/
+class LoRaWANFragStorage {
+  public:
+    /*! \brief Default destructor. */
+    virtual ~LoRaWANFragStorage() = default;
+
+    /*!
+      \brief Read data from the backend.
+      \param addr Offset to read from.
+      \param data Buffer to read into.
+      \param len Number of bytes to read.
+      \returns \ref status_codes
+    */
+    virtual int16_t read(uint32_t addr, uint8_t* data, size_t len) = 0;
+
+    /*!
+      \brief Write data into the backend. The same address may be written multiple times.
+      \param addr Offset to write to.
+      \param data Data to write.
+      \param len Number of bytes to write.
+      \returns \ref status_codes
+    */
+    virtual int16_t write(uint32_t addr, const uint8_t* data, size_t len) = 0;
+};
+
+/*!
+  \class LoRaWANFragmentation
+  \brief LoRaWAN Fragmented Data Block Transport (TS004) package, using the low-density parity check
+  fragmentation matrix defined by the specification. Supports a single fragmentation session at a time.
+  To use it, enable the package in the node by calling LoRaWANNode::addAppPackage
+  with RADIOLIB_LORAWAN_PACKAGE_TS004 and a callback that passes the downlink to handleDownlink().
+  Any answers must then be sent by the user, see getUplink().
+*/
+class LoRaWANFragmentation {
+  public:
+    /*!
+      \brief Default constructor.
+      \param storage Pointer to the storage backend.
+    */
+    explicit LoRaWANFragmentation(LoRaWANFragStorage* storage);
+
+    /*!
+      \brief Process a downlink received on the TS004 port. Answers (if any) are available from getUplink().
+      \param dataDown Downlink payload.
+      \param lenDown Length of the downlink payload.
+      \returns \ref status_codes
+    */
+    int16_t handleDownlink(const uint8_t* dataDown, size_t lenDown);
+
+    /*!
+      \brief Get answers to the last processed downlink(s), and clear them.
+      \param dataUp Buffer to save the answer into, must be at least RADIOLIB_LORAWAN_FRAG_MAX_ANS_LEN bytes long.
+      \param lenUp Pointer to variable to save the answer length into, 0 if there is nothing to send.
+      \returns \ref status_codes
+    */
+    int16_t getUplink(uint8_t* dataUp, size_t* lenUp);
+
+    /*!
+      \brief Start a new fragmentation session, without FragSessionSetupReq. This can be used to reassemble
+      fragmented data received through other means than LoRaWAN.
+      \param nbFrag Number of uncoded fragments.
+      \param fragSize Size of each fragment in bytes.
+      \param padding Number of padding bytes at the end of the last fragment.
+      \returns \ref status_codes
+    */
+    int16_t beginSession(uint16_t nbFrag, uint8_t fragSize, uint8_t padding = 0);
+
+    /*!
+      \brief Add a single fragment to the current session.
+      \param n Fragment number, starting from 1. Values larger than the number of fragments are coded fragments.
+      \param data Fragment data, must be exactly as long as the fragment size of the session.
+      \returns \ref status_codes
+    */
+    int16_t addFragment(uint16_t n, const uint8_t* data);
+
+    /*!
+      \brief Check whether the data block has been reassembled.
+      \returns Whether the data block is complete and available in the storage backend at offset 0.
+    */
+    bool isComplete();
+
+    /*!
+      \brief Get the size of the reassembled data block (without padding).
+      \returns Size of the data block in bytes.
+    */
+    size_t getSize();
+
+    /*!
+      \brief Get the file descriptor sent by the server in FragSessionSetupReq.
+      \returns The descriptor.
+    */
+    uint32_t getDescriptor();
+
+    /*!
+      \brief Get the number of fragments that still need to be received to finish the session.
+      \returns Number of missing fragments.
+    */
+    uint16_t getMissing();
+
+    /*!
+      \brief Generate one line of the TS004 fragmentation matrix.
+      \param n Line number, starting from 1 (equals fragment number minus number of uncoded fragments).
+      \param m Number of uncoded fragments.
+      \param row Buffer to save the line as bitmap, must be at least (m + 7) / 8 bytes long.
+    */
+    static void getParityRow(uint16_t n, uint16_t m, uint8_t* row);
+
+#if !RADIOLIB_GODMODE
+  private:
+#endif
+    LoRaWANFragStorage* storage = NULL;
+
+    // session parameters
+    bool active = false;
+    bool complete = false;
+    uint8_t fragIndex = 0;
+    uint16_t nbFrag = 0;
+    uint8_t fragSize = 0;
+    uint8_t padding = 0;
+    uint32_t descriptor = 0;
+    uint16_t nbRx = 0;
+
+    // decoder state, once the first coded fragment arrives the set of lost fragments is frozen
+    // and all further fragments are handled as rows of a triangular system over the lost fragments
+    bool frozen = false;
+    uint16_t nbLost = 0;
+    uint16_t nbPivots = 0;
+    uint8_t received[(RADIOLIB_LORAWAN_FRAG_MAX_NB + 7) / 8] = { 0 };
+    uint8_t pivots[(RADIOLIB_LORAWAN_FRAG_MAX_NB + 7) / 8] = { 0 };
+
+    // working buffers
+    uint8_t rowFull[(RADIOLIB_LORAWAN_FRAG_MAX_NB + 7) / 8] = { 0 };
+    uint8_t row[(RADIOLIB_LORAWAN_FRAG_MAX_NB + 7) / 8] = { 0 };
+    uint8_t rowTmp[(RADIOLIB_LORAWAN_FRAG_MAX_NB + 7) / 8] = { 0 };
+    uint8_t data[RADIOLIB_LORAWAN_FRAG_MAX_SIZE] = { 0 };
+    uint8_t dataTmp[RADIOLIB_LORAWAN_FRAG_MAX_SIZE] = { 0 };
+
+    // pending answers
+    uint8_t answer[RADIOLIB_LORAWAN_FRAG_MAX_ANS_LEN] = { 0 };
+    size_t answerLen = 0;
+
+    void pushAnswer(const uint8_t* ans, size_t len);
+    int16_t addRow(const uint8_t* coded);
+    int16_t solve();
+    uint32_t getSlotAddr(uint16_t slot);
+    uint32_t getRowAddr(uint16_t slot);
+    size_t getRowLen();
+    int16_t xorFrom(uint32_t addr, uint8_t* dst);
+};
+
+#endif
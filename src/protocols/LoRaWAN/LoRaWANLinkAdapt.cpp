@@ -0,0 +1,233 @@
+#include "LoRaWANLinkAdapt.h"
+#include <math.h>
+
+#if !RADIOLIB_EXCLUDE_LORAWAN
+
+LoRaWANLinkAdapt::LoRaWANLinkAdapt(LoRaWANNode* node) {
+  this->node = node;
+  this->setTarget(RADIOLIB_LORAWAN_LINK_ADAPT_TARGET);
+}
+
+void LoRaWANLinkAdapt::setTarget(float reliability, float marginDb) {
+  reliability = RADIOLIB_MIN(RADIOLIB_MAX(reliability, 0.5f), 0.999f);
+
+  // quantile of the standard normal distribution, rational approximation from Abramowitz & Stegun 26.2.23
+  float t = sqrtf(-2.0f * logf(1.0f - reliability));
+  this->zTarget = t - (2.515517f + 0.802853f*t + 0.010328f*t*t) / (1.0f + 1.432788f*t + 0.189269f*t*t + 0.001308f*t*t*t);
+  if(this->zTarget < 0) {
+    this->zTarget = 0;
+  }
+  this->margin = marginDb;
+}
+
+int16_t LoRaWANLinkAdapt::setDatarateLimits(uint8_t drMin, uint8_t drMax) {
+  if((drMin > drMax) || (drMax >= RADIOLIB_LORAWAN_CHANNEL_NUM_DATARATES)) {
+    return(RADIOLIB_ERR_INVALID_DATA_RATE);
+  }
+  this->drMin = drMin;
+  this->drMax = drMax;
+  return(RADIOLIB_ERR_NONE);
+}
+
+void LoRaWANLinkAdapt::setDownlinkPower(int8_t power) {
+  this->dlPower = power;
+}
+
+void LoRaWANLinkAdapt::setLinkCheckPeriod(uint8_t period) {
+  this->linkCheckPeriod = period;
+}
+
+int16_t LoRaWANLinkAdapt::update(int16_t state, size_t lenUp, const LoRaWANEvent_t* eventUp, const LoRaWANEvent_t* eventDown) {
+  if(!this->node || !eventUp) {
+    return(RADIOLIB_ERR_NULL_POINTER);
+  }
+
+  // the network is in control
+  if(this->node->getADR()) {
+    return(RADIOLIB_ERR_INVALID_MODE);
+  }
+
+  // the cycle failed before anything was sent
+  if(state < RADIOLIB_ERR_NONE) {
+    return(RADIOLIB_ERR_NONE);
+  }
+
+  this->sinceLinkCheck++;
+  this->sinceSample++;
+
+  bool sampled = false;
+  if((state > 0) && eventDown) {
+    // the uplink as measured by the gateway, relative to the power it was sent with
+    uint8_t lcMargin = 0;
+    uint8_t gwCnt = 0;
+    float dlGain = eventDown->snr - (float)this->dlPower;
+    if(this->node->getMacLinkCheckAns(&lcMargin, &gwCnt) == RADIOLIB_ERR_NONE) {
+      float ulGain = (float)lcMargin + LoRaWANLinkAdapt::getRequiredSnr(eventUp->datarate, this->node->getBand()) - (float)eventUp->power;
+      this->push(ulGain);
+
+      // the same downlink gives the offset between uplink and downlink, smoothed as it is noisy
+      if(this->dlBiasValid) {
+        this->dlBias += (ulGain - dlGain - this->dlBias) / 4.0f;
+      } else {
+        this->dlBias = ulGain - dlGain;
+        this->dlBiasValid = true;
+      }
+      this->sinceLinkCheck = 0;
+
+    } else {
+      this->push(dlGain + this->dlBias);
+    }
+    sampled = true;
+  }
+
+  // request LinkCheck for the next uplink
+  if(this->linkCheckPeriod && (this->sinceLinkCheck >= this->linkCheckPeriod)) {
+    (void)this->node->sendMacCommandReq(RADIOLIB_LORAWAN_MAC_LINK_CHECK);
+  }
+
+  if(sampled) {
+    return(this->adapt(lenUp));
+  }
+
+  // no news for too long, the link may be gone - step back towards the most robust configuration
+  uint16_t limit = this->linkCheckPeriod ? 2*this->linkCheckPeriod : 2*RADIOLIB_LORAWAN_LINK_ADAPT_LINK_CHECK;
+  if(this->sinceSample >= limit) {
+    this->sinceSample = 0;
+    this->reset();
+    return(this->backoff());
+  }
+
+  return(RADIOLIB_ERR_NONE);
+}
+
+void LoRaWANLinkAdapt::addSample(float snr, int8_t txPower) {
+  this->push(snr - (float)txPower);
+}
+
+void LoRaWANLinkAdapt::reset() {
+  this->numSamples = 0;
+  this->samplePos = 0;
+}
+
+uint8_t LoRaWANLinkAdapt::getEstimate(float* mean, float* dev) {
+  float sum = 0;
+  float sumSq = 0;
+  for(uint8_t i = 0; i < this->numSamples; i++) {
+    sum += this->samples[i];
+    sumSq += this->samples[i] * this->samples[i];
+  }
+
+  float m = this->numSamples ? sum / this->numSamples : 0;
+  float var = 0;
+  if(this->numSamples > 1) {
+    var = (sumSq - sum*m) / (this->numSamples - 1);
+  }
+  if(mean) {
+    *mean = m;
+  }
+  if(dev) {
+    *dev = var > 0 ? sqrtf(var) : 0;
+  }
+  return(this->numSamples);
+}
+
+float LoRaWANLinkAdapt::getRequiredSnr(uint8_t dr, const LoRaWANBand_t* band) {
+  if(!band || (dr >= RADIOLIB_LORAWAN_CHANNEL_NUM_DATARATES) || (band->dataRates[dr].modem != RADIOLIB_MODEM_LORA)) {
+    return(0);
+  }
+  uint8_t sf = band->dataRates[dr].dr.lora.spreadingFactor;
+  return(RADIOLIB_LORAWAN_LINK_ADAPT_SNR_SF12 + (12 - sf)*RADIOLIB_LORAWAN_LINK_ADAPT_SNR_STEP);
+}
+
+void LoRaWANLinkAdapt::push(float gain) {
+  this->samples[this->samplePos] = gain;
+  this->samplePos = (this->samplePos + 1) % RADIOLIB_LORAWAN_LINK_ADAPT_WINDOW;
+  if(this->numSamples < RADIOLIB_LORAWAN_LINK_ADAPT_WINDOW) {
+    this->numSamples++;
+  }
+  this->sinceSample = 0;
+}
+
+int16_t LoRaWANLinkAdapt::adapt(size_t lenUp) {
+  float mean = 0;
+  float dev = 0;
+  if(this->getEstimate(&mean, &dev) < RADIOLIB_LORAWAN_LINK_ADAPT_MIN_SAMPLES) {
+    return(RADIOLIB_ERR_NONE);
+  }
+
+  // worst path gain that still has to be covered, and the configuration the node is using now
+  const LoRaWANBand_t* band = this->node->getBand();
+  float gain = mean - this->zTarget*dev - this->margin;
+  int8_t powerMax = this->node->getTxPowerMax();
+  uint8_t drNow = this->node->getDatarate();
+
+  // fastest datarate first as that saves the most airtime, moving up takes some extra margin
+  uint8_t dr = RADIOLIB_LORAWAN_DATA_RATE_UNUSED;
+  for(int16_t i = this->drMax; i >= this->drMin; i--) {
+    if(!this->isDatarateUsable(i, lenUp)) {
+      continue;
+    }
+    float needed = LoRaWANLinkAdapt::getRequiredSnr(i, band);
+    if(i > drNow) {
+      needed += RADIOLIB_LORAWAN_LINK_ADAPT_HYSTERESIS_DB;
+    }
+    dr = i;
+    if(gain + powerMax >= needed) {
+      break;
+    }
+  }
+  if(dr == RADIOLIB_LORAWAN_DATA_RATE_UNUSED) {
+    return(RADIOLIB_ERR_INVALID_DATA_RATE);
+  }
+
+  // then spend whatever margin is left on lowering the power, in the steps defined by LoRaWAN
+  float excess = gain + powerMax - LoRaWANLinkAdapt::getRequiredSnr(dr, band);
+  int8_t steps = 0;
+  if(excess > 0) {
+    steps = RADIOLIB_MIN((int8_t)(excess / -RADIOLIB_LORAWAN_POWER_STEP_SIZE_DBM), band->powerNumSteps);
+  }
+  int8_t power = powerMax + steps*RADIOLIB_LORAWAN_POWER_STEP_SIZE_DBM;
+
+  if(dr != drNow) {
+    RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Link adaptation: DR%d -> DR%d (gain %.1f dB, dev %.1f dB)", drNow, dr, (double)mean, (double)dev);
+    int16_t state = this->node->setDatarate(dr);
+    RADIOLIB_ASSERT(state);
+  }
+  if(power != this->node->getTxPower()) {
+    int16_t state = this->node->setTxPower(power);
+    RADIOLIB_ASSERT(state);
+  }
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t LoRaWANLinkAdapt::backoff() {
+  // full power first, as it costs no airtime
+  if(this->node->getTxPower() < this->node->getTxPowerMax()) {
+    return(this->node->setTxPower(this->node->getTxPowerMax()));
+  }
+
+  // then the next slower datarate that can be used
+  uint8_t drNow = this->node->getDatarate();
+  if(drNow == RADIOLIB_LORAWAN_DATA_RATE_UNUSED) {
+    return(RADIOLIB_ERR_NONE);
+  }
+  for(int16_t dr = drNow - 1; dr >= this->drMin; dr--) {
+    if(this->isDatarateUsable(dr, 0)) {
+      RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Link adaptation: no downlink, DR%d -> DR%d", drNow, dr);
+      return(this->node->setDatarate(dr));
+    }
+  }
+  return(RADIOLIB_ERR_NONE);
+}
+
+bool LoRaWANLinkAdapt::isDatarateUsable(uint8_t dr, size_t lenUp) {
+  const LoRaWANBand_t* band = this->node->getBand();
+  if((dr >= RADIOLIB_LORAWAN_CHANNEL_NUM_DATARATES) || (band->dataRates[dr].modem != RADIOLIB_MODEM_LORA)) {
+    return(false);
+  }
+
+  // some enabled channel has to allow it, and the frame has to fit the payload limit and the dwell time
+  return(this->node->isDatarateEnabled(dr) && (lenUp <= this->node->getMaxPayloadLen(dr)));
+}
+
+#endif
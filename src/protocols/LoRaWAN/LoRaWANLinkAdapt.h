@@ -0,0 +1,149 @@
+#if !defined(_RADIOLIB_LORAWAN_LINK_ADAPT_H) && !RADIOLIB_EXCLUDE_LORAWAN
+#define _RADIOLIB_LORAWAN_LINK_ADAPT_H
+
+#include "../../TypeDef.h"
+#include "LoRaWAN.h"
+
+// number of link samples kept, older samples are dropped
+#if !defined(RADIOLIB_LORAWAN_LINK_ADAPT_WINDOW)
+  #define RADIOLIB_LORAWAN_LINK_ADAPT_WINDOW                    (8)
+#endif
+
+// minimum number of samples before the datarate and power are changed
+#define RADIOLIB_LORAWAN_LINK_ADAPT_MIN_SAMPLES                 (3)
+
+// defaults: reliability target, fixed margin on top of it, assumed gateway downlink power
+#define RADIOLIB_LORAWAN_LINK_ADAPT_TARGET                      (0.9f)
+#define RADIOLIB_LORAWAN_LINK_ADAPT_MARGIN_DB                   (3.0f)
+#define RADIOLIB_LORAWAN_LINK_ADAPT_DL_POWER                    (14)
+
+// default number of uplinks between LinkCheck requests
+#define RADIOLIB_LORAWAN_LINK_ADAPT_LINK_CHECK                  (16)
+
+// extra margin needed to move to a faster datarate, prevents flapping between two datarates
+#define RADIOLIB_LORAWAN_LINK_ADAPT_HYSTERESIS_DB               (1.5f)
+
+// LoRa demodulation floor of SF12, each lower spreading factor needs 2.5 dB more
+#define RADIOLIB_LORAWAN_LINK_ADAPT_SNR_SF12                    (-20.0f)
+#define RADIOLIB_LORAWAN_LINK_ADAPT_SNR_STEP                    (2.5f)
+
+/*!
+  \class LoRaWANLinkAdapt
+  \brief Device-side rate adaptation, for devices that do not get (or do not want) network-controlled ADR,
+  for example mobile nodes. Downlink SNR and LinkCheck margins are kept in a rolling window,
+  each normalized to the path gain between the device and the gateway (SNR minus transmit power).
+  The engine then picks the fastest datarate, and after that the lowest power, for which the expected
+  uplink SNR stays above the demodulation floor with the configured probability.
+  Changes are applied through LoRaWANNode::setDatarate and LoRaWANNode::setTxPower, so the channel plan,
+  TxParamSetup and dwell time limits set by the network are respected.
+  Network ADR must be disabled using LoRaWANNode::setADR(false). Only LoRa datarates are considered.
+*/
+class LoRaWANLinkAdapt {
+  public:
+    /*!
+      \brief Default constructor.
+      \param node Pointer to the LoRaWAN node to control.
+    */
+    explicit LoRaWANLinkAdapt(LoRaWANNode* node);
+
+    /*!
+      \brief Set the reliability target.
+      \param reliability Probability with which an uplink should be above the demodulation floor,
+      clamped to 0.5 - 0.999.
+      \param marginDb Fixed margin in dB added on top of the statistical one, e.g. for antenna or body losses.
+    */
+    void setTarget(float reliability, float marginDb = RADIOLIB_LORAWAN_LINK_ADAPT_MARGIN_DB);
+
+    /*!
+      \brief Limit the datarates the engine may use, on top of the limits of the band and the network.
+      \param drMin Slowest allowed datarate.
+      \param drMax Fastest allowed datarate.
+      \returns \ref status_codes
+    */
+    int16_t setDatarateLimits(uint8_t drMin, uint8_t drMax);
+
+    /*!
+      \brief Set the transmit power the gateways use for downlinks. This is only a starting point,
+      the difference is learned from downlinks that carry a LinkCheckAns.
+      \param power Downlink power in dBm (EIRP).
+    */
+    void setDownlinkPower(int8_t power);
+
+    /*!
+      \brief Set how often the engine requests LinkCheck, which measures the uplink directly.
+      \param period Number of uplinks between requests, 0 to never request.
+    */
+    void setLinkCheckPeriod(uint8_t period);
+
+    /*!
+      \brief Feed the result of an uplink/downlink cycle to the engine. Call this after each
+      sendReceive, or once process() has finished the cycle, with the same events.
+      \param state Return value of the cycle, positive if a downlink was received.
+      \param lenUp Application payload length of the uplink, used for the dwell time limit.
+      \param eventUp Uplink event.
+      \param eventDown Downlink event, only used if a downlink was received.
+      \returns \ref status_codes
+    */
+    int16_t update(int16_t state, size_t lenUp, const LoRaWANEvent_t* eventUp, const LoRaWANEvent_t* eventDown);
+
+    /*!
+      \brief Add a link sample measured by other means, e.g. from a gateway that reports the uplink SNR.
+      \param snr Measured SNR in dB.
+      \param txPower Power the measured frame was sent with, in dBm.
+    */
+    void addSample(float snr, int8_t txPower);
+
+    /*!
+      \brief Drop all link samples, e.g. after the device moved somewhere else.
+    */
+    void reset();
+
+    /*!
+      \brief Get the path gain estimate as mean and standard deviation over the window.
+      \param mean Pointer to variable to save the mean into (SNR at 0 dBm transmit power).
+      \param dev Pointer to variable to save the standard deviation into.
+      \returns Number of samples in the window.
+    */
+    uint8_t getEstimate(float* mean, float* dev);
+
+    /*!
+      \brief Get the SNR needed to demodulate a datarate.
+      \param dr Datarate of the band.
+      \param band Pointer to the LoRaWAN band.
+      \returns Demodulation floor in dB, 0 for datarates other than LoRa.
+    */
+    static float getRequiredSnr(uint8_t dr, const LoRaWANBand_t* band);
+
+#if !RADIOLIB_GODMODE
+  private:
+#endif
+    LoRaWANNode* node = NULL;
+
+    // configuration
+    float margin = RADIOLIB_LORAWAN_LINK_ADAPT_MARGIN_DB;
+    float zTarget = 0;
+    uint8_t drMin = 0;
+    uint8_t drMax = RADIOLIB_LORAWAN_CHANNEL_NUM_DATARATES - 1;
+    int8_t dlPower = RADIOLIB_LORAWAN_LINK_ADAPT_DL_POWER;
+    uint8_t linkCheckPeriod = RADIOLIB_LORAWAN_LINK_ADAPT_LINK_CHECK;
+
+    // ring buffer of path gain samples
+    float samples[RADIOLIB_LORAWAN_LINK_ADAPT_WINDOW] = { 0 };
+    uint8_t numSamples = 0;
+    uint8_t samplePos = 0;
+
+    // learned difference between LinkCheck margins and downlink SNR, which also covers different noise figures
+    float dlBias = 0;
+    bool dlBiasValid = false;
+
+    // uplinks since the last LinkCheck request and since the last sample
+    uint16_t sinceLinkCheck = 0;
+    uint16_t sinceSample = 0;
+
+    void push(float gain);
+    int16_t adapt(size_t lenUp);
+    int16_t backoff();
+    bool isDatarateUsable(uint8_t dr, size_t lenUp);
+};
+
+#endif
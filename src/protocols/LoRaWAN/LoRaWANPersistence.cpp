@@ -0,0 +1,265 @@
+#include "LoRaWANPersistence.h"
+#include "../../utils/CRC.h"
+#include <string.h>
+
+#if !RADIOLIB_EXCLUDE_LORAWAN
+
+// location of each frame counter in the Session buffer and in the log record, in the same byte order
+static const uint16_t fCntLocs[RADIOLIB_LORAWAN_PERSIST_NUM_FCNTS][2] = {
+  { RADIOLIB_LORAWAN_SESSION_FCNT_UP,         RADIOLIB_LORAWAN_PERSIST_RECORD_FCNT_UP },
+  { RADIOLIB_LORAWAN_SESSION_N_FCNT_DOWN,     RADIOLIB_LORAWAN_PERSIST_RECORD_N_FCNT_DOWN },
+  { RADIOLIB_LORAWAN_SESSION_A_FCNT_DOWN,     RADIOLIB_LORAWAN_PERSIST_RECORD_A_FCNT_DOWN },
+  { RADIOLIB_LORAWAN_SESSION_ADR_FCNT,        RADIOLIB_LORAWAN_PERSIST_RECORD_ADR_FCNT },
+  { RADIOLIB_LORAWAN_SESSION_CONF_FCNT_UP,    RADIOLIB_LORAWAN_PERSIST_RECORD_CONF_FCNT_UP },
+  { RADIOLIB_LORAWAN_SESSION_CONF_FCNT_DOWN,  RADIOLIB_LORAWAN_PERSIST_RECORD_CONF_FCNT_DOWN },
+};
+
+LoRaWANPersistence::LoRaWANPersistence(LoRaWANNode* node, LoRaWANSessionStorage* storage, uint32_t pageSize, uint32_t logSize) {
+  this->node = node;
+  this->storage = storage;
+
+  // each slot takes up whole pages, so that it can be erased without affecting anything else
+  if(pageSize == 0) {
+    pageSize = 1;
+  }
+  this->slotSize = ((RADIOLIB_LORAWAN_PERSIST_SNAPSHOT_LEN + pageSize - 1) / pageSize) * pageSize;
+  this->logSize = logSize;
+}
+
+int16_t LoRaWANPersistence::restore() {
+  if(!this->node || !this->storage) {
+    return(RADIOLIB_ERR_NULL_POINTER);
+  }
+
+  uint8_t snapshot[RADIOLIB_LORAWAN_PERSIST_SNAPSHOT_LEN];
+  uint8_t record[RADIOLIB_LORAWAN_PERSIST_RECORD_LEN];
+  bool hasRecord = false;
+  int16_t state = scan(snapshot, record, &hasRecord);
+  RADIOLIB_ASSERT(state);
+  if(!this->valid) {
+    return(RADIOLIB_ERR_NETWORK_NOT_JOINED);
+  }
+
+  // apply the latest counters on top of the snapshot
+  uint8_t* session = &snapshot[RADIOLIB_LORAWAN_PERSIST_SNAPSHOT_SESSION];
+  if(hasRecord) {
+    for(uint8_t i = 0; i < RADIOLIB_LORAWAN_PERSIST_NUM_FCNTS; i++) {
+      memcpy(&session[fCntLocs[i][0]], &record[fCntLocs[i][1]], sizeof(uint32_t));
+    }
+
+    // the Session buffer signature has to be updated as well
+    uint16_t signature = LoRaWANNode::checkSum16(session, RADIOLIB_LORAWAN_SESSION_BUF_SIZE - 2);
+    LoRaWANNode::hton<uint16_t>(&session[RADIOLIB_LORAWAN_SESSION_SIGNATURE], signature);
+  }
+
+  state = this->node->setBufferNonces(&snapshot[RADIOLIB_LORAWAN_PERSIST_SNAPSHOT_NONCES]);
+  RADIOLIB_ASSERT(state);
+  return(this->node->setBufferSession(session));
+}
+
+int16_t LoRaWANPersistence::save() {
+  if(!this->node || !this->storage) {
+    return(RADIOLIB_ERR_NULL_POINTER);
+  }
+
+  // the scratch buffer is used for the stored snapshot, and later for the new one (if needed)
+  uint8_t snapshot[RADIOLIB_LORAWAN_PERSIST_SNAPSHOT_LEN];
+  int16_t state = RADIOLIB_ERR_NONE;
+  if(!this->scanned) {
+    uint8_t record[RADIOLIB_LORAWAN_PERSIST_RECORD_LEN];
+    bool hasRecord = false;
+    state = scan(snapshot, record, &hasRecord);
+  } else if(this->valid) {
+    uint32_t gen = 0;
+    state = readSlot(this->generation & 0x01, snapshot, &gen);
+  }
+  RADIOLIB_ASSERT(state);
+
+  const uint8_t* nonces = this->node->getBufferNonces();
+  const uint8_t* session = this->node->getBufferSession();
+
+  // a new snapshot is needed when something other than the counters changed, or when the log is full
+  if(!this->valid || (this->logHead >= getLogCapacity()) || !isSameState(snapshot, nonces, session)) {
+    return(writeSnapshot(snapshot, nonces, session));
+  }
+
+  // otherwise just append the counters
+  uint8_t record[RADIOLIB_LORAWAN_PERSIST_RECORD_LEN];
+  memset(record, RADIOLIB_LORAWAN_PERSIST_ERASED, RADIOLIB_LORAWAN_PERSIST_RECORD_LEN);
+  LoRaWANNode::hton<uint32_t>(&record[RADIOLIB_LORAWAN_PERSIST_RECORD_GEN], this->generation);
+  for(uint8_t i = 0; i < RADIOLIB_LORAWAN_PERSIST_NUM_FCNTS; i++) {
+    memcpy(&record[fCntLocs[i][1]], &session[fCntLocs[i][0]], sizeof(uint32_t));
+  }
+  uint16_t crc = LoRaWANPersistence::crc16(record, RADIOLIB_LORAWAN_PERSIST_RECORD_CRC);
+  LoRaWANNode::hton<uint16_t>(&record[RADIOLIB_LORAWAN_PERSIST_RECORD_CRC], crc);
+
+  state = this->storage->write(2*this->slotSize + this->logHead*RADIOLIB_LORAWAN_PERSIST_RECORD_LEN, record, RADIOLIB_LORAWAN_PERSIST_RECORD_LEN);
+  RADIOLIB_ASSERT(state);
+  this->logHead++;
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t LoRaWANPersistence::compact() {
+  if(!this->node || !this->storage) {
+    return(RADIOLIB_ERR_NULL_POINTER);
+  }
+
+  uint8_t snapshot[RADIOLIB_LORAWAN_PERSIST_SNAPSHOT_LEN];
+  if(!this->scanned) {
+    uint8_t record[RADIOLIB_LORAWAN_PERSIST_RECORD_LEN];
+    bool hasRecord = false;
+    int16_t state = scan(snapshot, record, &hasRecord);
+    RADIOLIB_ASSERT(state);
+  }
+  return(writeSnapshot(snapshot, this->node->getBufferNonces(), this->node->getBufferSession()));
+}
+
+uint32_t LoRaWANPersistence::getStorageSize() {
+  return(2*this->slotSize + this->logSize);
+}
+
+int16_t LoRaWANPersistence::scan(uint8_t* snapshot, uint8_t* record, bool* hasRecord) {
+  // find the newest valid snapshot
+  uint8_t other[RADIOLIB_LORAWAN_PERSIST_SNAPSHOT_LEN];
+  uint32_t gen0 = 0;
+  uint32_t gen1 = 0;
+  int16_t state0 = readSlot(0, snapshot, &gen0);
+  int16_t state1 = readSlot(1, other, &gen1);
+  this->scanned = true;
+  this->valid = (state0 == RADIOLIB_ERR_NONE) || (state1 == RADIOLIB_ERR_NONE);
+  *hasRecord = false;
+  if(!this->valid) {
+    return(RADIOLIB_ERR_NONE);
+  }
+  if((state0 != RADIOLIB_ERR_NONE) || ((state1 == RADIOLIB_ERR_NONE) && ((int32_t)(gen1 - gen0) > 0))) {
+    memcpy(snapshot, other, RADIOLIB_LORAWAN_PERSIST_SNAPSHOT_LEN);
+    this->generation = gen1;
+  } else {
+    this->generation = gen0;
+  }
+
+  // records are only ever appended, so the written ones form a prefix of the log - binary search for its end
+  uint32_t lo = 0;
+  uint32_t hi = getLogCapacity();
+  while(lo < hi) {
+    uint32_t mid = lo + (hi - lo) / 2;
+    bool written = false;
+    int16_t state = readRecord(mid, record, &written);
+    RADIOLIB_ASSERT(state);
+    if(written) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  this->logHead = lo;
+
+  // the last record may have been interrupted, in that case the one before it is used
+  for(uint32_t i = 0; (i < 2) && (i < this->logHead); i++) {
+    bool written = false;
+    int16_t state = readRecord(this->logHead - 1 - i, record, &written);
+    RADIOLIB_ASSERT(state);
+    uint16_t crc = LoRaWANNode::ntoh<uint16_t>(&record[RADIOLIB_LORAWAN_PERSIST_RECORD_CRC]);
+    uint32_t gen = LoRaWANNode::ntoh<uint32_t>(&record[RADIOLIB_LORAWAN_PERSIST_RECORD_GEN]);
+    if((crc == LoRaWANPersistence::crc16(record, RADIOLIB_LORAWAN_PERSIST_RECORD_CRC)) && (gen == this->generation)) {
+      *hasRecord = true;
+      break;
+    }
+  }
+
+  // log belongs to an older snapshot (e.g. power loss during compaction), force compaction on next save
+  if((this->logHead > 0) && !*hasRecord) {
+    RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Stale counter log, %lu records", (unsigned long)this->logHead);
+    this->logHead = getLogCapacity();
+  }
+
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t LoRaWANPersistence::readSlot(uint8_t slot, uint8_t* snapshot, uint32_t* gen) {
+  int16_t state = this->storage->read(slot*this->slotSize, snapshot, RADIOLIB_LORAWAN_PERSIST_SNAPSHOT_LEN);
+  RADIOLIB_ASSERT(state);
+
+  uint16_t magic = LoRaWANNode::ntoh<uint16_t>(&snapshot[RADIOLIB_LORAWAN_PERSIST_SNAPSHOT_MAGIC]);
+  uint16_t crc = LoRaWANNode::ntoh<uint16_t>(&snapshot[RADIOLIB_LORAWAN_PERSIST_SNAPSHOT_CRC]);
+  if((magic != RADIOLIB_LORAWAN_PERSIST_MAGIC) || (crc != LoRaWANPersistence::crc16(snapshot, RADIOLIB_LORAWAN_PERSIST_SNAPSHOT_CRC))) {
+    return(RADIOLIB_ERR_CHECKSUM_MISMATCH);
+  }
+
+  *gen = LoRaWANNode::ntoh<uint32_t>(&snapshot[RADIOLIB_LORAWAN_PERSIST_SNAPSHOT_GEN]);
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t LoRaWANPersistence::readRecord(uint32_t index, uint8_t* record, bool* written) {
+  int16_t state = this->storage->read(2*this->slotSize + index*RADIOLIB_LORAWAN_PERSIST_RECORD_LEN, record, RADIOLIB_LORAWAN_PERSIST_RECORD_LEN);
+  RADIOLIB_ASSERT(state);
+
+  // record counts as written if anything at all was programmed
+  *written = false;
+  for(size_t i = 0; i < RADIOLIB_LORAWAN_PERSIST_RECORD_LEN; i++) {
+    if(record[i] != RADIOLIB_LORAWAN_PERSIST_ERASED) {
+      *written = true;
+      break;
+    }
+  }
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t LoRaWANPersistence::writeSnapshot(uint8_t* snapshot, const uint8_t* nonces, const uint8_t* session) {
+  // the new snapshot always goes to the slot not holding the current one
+  uint32_t gen = this->valid ? this->generation + 1 : 0;
+  LoRaWANNode::hton<uint16_t>(&snapshot[RADIOLIB_LORAWAN_PERSIST_SNAPSHOT_MAGIC], RADIOLIB_LORAWAN_PERSIST_MAGIC);
+  LoRaWANNode::hton<uint32_t>(&snapshot[RADIOLIB_LORAWAN_PERSIST_SNAPSHOT_GEN], gen);
+  memcpy(&snapshot[RADIOLIB_LORAWAN_PERSIST_SNAPSHOT_NONCES], nonces, RADIOLIB_LORAWAN_NONCES_BUF_SIZE);
+  memcpy(&snapshot[RADIOLIB_LORAWAN_PERSIST_SNAPSHOT_SESSION], session, RADIOLIB_LORAWAN_SESSION_BUF_SIZE);
+  uint16_t crc = LoRaWANPersistence::crc16(snapshot, RADIOLIB_LORAWAN_PERSIST_SNAPSHOT_CRC);
+  LoRaWANNode::hton<uint16_t>(&snapshot[RADIOLIB_LORAWAN_PERSIST_SNAPSHOT_CRC], crc);
+
+  uint32_t addr = (gen & 0x01)*this->slotSize;
+  int16_t state = this->storage->erase(addr, this->slotSize);
+  RADIOLIB_ASSERT(state);
+  state = this->storage->write(addr, snapshot, RADIOLIB_LORAWAN_PERSIST_SNAPSHOT_LEN);
+  RADIOLIB_ASSERT(state);
+  this->generation = gen;
+  this->valid = true;
+
+  // the log is only erased once the new snapshot is in place,
+  // records left over from an interrupted erase are ignored thanks to the generation number
+  if(this->logHead > 0) {
+    state = this->storage->erase(2*this->slotSize, this->logSize);
+    RADIOLIB_ASSERT(state);
+  }
+  this->logHead = 0;
+  return(RADIOLIB_ERR_NONE);
+}
+
+bool LoRaWANPersistence::isSameState(const uint8_t* snapshot, const uint8_t* nonces, const uint8_t* session) {
+  if(memcmp(&snapshot[RADIOLIB_LORAWAN_PERSIST_SNAPSHOT_NONCES], nonces, RADIOLIB_LORAWAN_NONCES_BUF_SIZE) != 0) {
+    return(false);
+  }
+
+  // frame counters are stored next to each other, skip them and the signature that depends on them
+  const uint8_t* stored = &snapshot[RADIOLIB_LORAWAN_PERSIST_SNAPSHOT_SESSION];
+  const size_t cntStart = RADIOLIB_LORAWAN_SESSION_FCNT_UP;
+  const size_t cntEnd = RADIOLIB_LORAWAN_SESSION_CONF_FCNT_DOWN + sizeof(uint32_t);
+  if(memcmp(stored, session, cntStart) != 0) {
+    return(false);
+  }
+  return(memcmp(&stored[cntEnd], &session[cntEnd], RADIOLIB_LORAWAN_SESSION_SIGNATURE - cntEnd) == 0);
+}
+
+uint32_t LoRaWANPersistence::getLogCapacity() {
+  return(this->logSize / RADIOLIB_LORAWAN_PERSIST_RECORD_LEN);
+}
+
+uint16_t LoRaWANPersistence::crc16(const uint8_t* data, size_t len) {
+  RadioLibCRCInstance.size = 16;
+  RadioLibCRCInstance.poly = RADIOLIB_CRC_CCITT_POLY;
+  RadioLibCRCInstance.init = RADIOLIB_CRC_CCITT_INIT;
+  RadioLibCRCInstance.out = RADIOLIB_CRC_CCITT_OUT;
+  RadioLibCRCInstance.refIn = false;
+  RadioLibCRCInstance.refOut = false;
+  return((uint16_t)RadioLibCRCInstance.checksum(data, len));
+}
+
+#endif
@@ -0,0 +1,145 @@
+#if !defined(_RADIOLIB_LORAWAN_PERSISTENCE_H) && !RADIOLIB_EXCLUDE_LORAWAN
+#define _RADIOLIB_LORAWAN_PERSISTENCE_H
+
+#include "../../TypeDef.h"
+#include "LoRaWAN.h"
+
+// snapshot identification, change when the layout changes
+#define RADIOLIB_LORAWAN_PERSIST_MAGIC                          (0x4C01)
+
+// value of erased storage
+#define RADIOLIB_LORAWAN_PERSIST_ERASED                         (0xFF)
+
+// snapshot layout, the Nonces and Session buffers are stored as-is
+enum LoRaWANPersistSnapshot_t {
+  RADIOLIB_LORAWAN_PERSIST_SNAPSHOT_MAGIC        = 0x00,                                                               // 2 bytes
+  RADIOLIB_LORAWAN_PERSIST_SNAPSHOT_GEN          = RADIOLIB_LORAWAN_PERSIST_SNAPSHOT_MAGIC + sizeof(uint16_t),         // 4 bytes
+  RADIOLIB_LORAWAN_PERSIST_SNAPSHOT_NONCES       = RADIOLIB_LORAWAN_PERSIST_SNAPSHOT_GEN + sizeof(uint32_t),           // Nonces buffer
+  RADIOLIB_LORAWAN_PERSIST_SNAPSHOT_SESSION      = RADIOLIB_LORAWAN_PERSIST_SNAPSHOT_NONCES + RADIOLIB_LORAWAN_NONCES_BUF_SIZE, // Session buffer
+  RADIOLIB_LORAWAN_PERSIST_SNAPSHOT_CRC          = RADIOLIB_LORAWAN_PERSIST_SNAPSHOT_SESSION + RADIOLIB_LORAWAN_SESSION_BUF_SIZE, // 2 bytes
+  RADIOLIB_LORAWAN_PERSIST_SNAPSHOT_LEN          = RADIOLIB_LORAWAN_PERSIST_SNAPSHOT_CRC + sizeof(uint16_t)            // snapshot size
+};
+
+// number of frame counters in each log record
+#define RADIOLIB_LORAWAN_PERSIST_NUM_FCNTS                      (6)
+
+// counter log record layout
+enum LoRaWANPersistRecord_t {
+  RADIOLIB_LORAWAN_PERSIST_RECORD_GEN            = 0x00,                                                               // 4 bytes
+  RADIOLIB_LORAWAN_PERSIST_RECORD_FCNT_UP        = RADIOLIB_LORAWAN_PERSIST_RECORD_GEN + sizeof(uint32_t),             // 4 bytes
+  RADIOLIB_LORAWAN_PERSIST_RECORD_N_FCNT_DOWN    = RADIOLIB_LORAWAN_PERSIST_RECORD_FCNT_UP + sizeof(uint32_t),         // 4 bytes
+  RADIOLIB_LORAWAN_PERSIST_RECORD_A_FCNT_DOWN    = RADIOLIB_LORAWAN_PERSIST_RECORD_N_FCNT_DOWN + sizeof(uint32_t),     // 4 bytes
+  RADIOLIB_LORAWAN_PERSIST_RECORD_ADR_FCNT       = RADIOLIB_LORAWAN_PERSIST_RECORD_A_FCNT_DOWN + sizeof(uint32_t),     // 4 bytes
+  RADIOLIB_LORAWAN_PERSIST_RECORD_CONF_FCNT_UP   = RADIOLIB_LORAWAN_PERSIST_RECORD_ADR_FCNT + sizeof(uint32_t),        // 4 bytes
+  RADIOLIB_LORAWAN_PERSIST_RECORD_CONF_FCNT_DOWN = RADIOLIB_LORAWAN_PERSIST_RECORD_CONF_FCNT_UP + sizeof(uint32_t),    // 4 bytes
+  RADIOLIB_LORAWAN_PERSIST_RECORD_CRC            = RADIOLIB_LORAWAN_PERSIST_RECORD_CONF_FCNT_DOWN + sizeof(uint32_t),  // 2 bytes
+  RADIOLIB_LORAWAN_PERSIST_RECORD_LEN            = 32                                                                  // record size, padded to 32 bytes
+};
+
+/*!
+  \class LoRaWANSessionStorage
+  \brief Storage backend for LoRaWAN session persistence.
+  The backend is expected to behave like flash memory: erased bytes read as 0xFF,
+  and each byte is written at most once between erase operations.
+  EEPROM or file based backends can simply fill the erased range with 0xFF.
+*/
+class LoRaWANSessionStorage {
+  public:
+    /*! \brief Default destructor. */
+    virtual ~LoRaWANSessionStorage() = default;
+
+    /*!
+      \brief Read data from the backend.
+      \param addr Offset to read from.
+      \param data Buffer to read into.
+      \param len Number of bytes to read.
+      \returns \ref status_codes
+    */
+    virtual int16_t read(uint32_t addr, uint8_t* data, size_t len) = 0;
+
+    /*!
+      \brief Write data into previously erased area of the backend.
+      \param addr Offset to write to.
+      \param data Data to write.
+      \param len Number of bytes to write.
+      \returns \ref status_codes
+    */
+    virtual int16_t write(uint32_t addr, const uint8_t* data, size_t len) = 0;
+
+    /*!
+      \brief Erase area of the backend.
+      \param addr Offset to erase from, always aligned to page size.
+      \param len Number of bytes to erase, always a multiple of page size.
+      \returns \ref status_codes
+    */
+    virtual int16_t erase(uint32_t addr, size_t len) = 0;
+};
+
+/*!
+  \class LoRaWANPersistence
+  \brief Wear-aware persistence of LoRaWAN Nonces and Session buffers.
+  The rarely changing part of the session is stored as a snapshot in one of two alternating slots.
+  The frame counters, which change with every uplink, are appended as small records into a log,
+  so most calls to save() only write a single record. When the log is full,
+  it is compacted into a new snapshot. Storage layout is: slot 0, slot 1 (each rounded up to page size),
+  followed by the counter log.
+*/
+class LoRaWANPersistence {
+  public:
+    /*!
+      \brief Default constructor.
+      \param node Pointer to the LoRaWAN node whose state should be persisted.
+      \param storage Pointer to the storage backend.
+      \param pageSize Size of the smallest erasable unit of the backend in bytes.
+      \param logSize Size of the counter log in bytes, must be a multiple of page size.
+    */
+    LoRaWANPersistence(LoRaWANNode* node, LoRaWANSessionStorage* storage, uint32_t pageSize, uint32_t logSize);
+
+    /*!
+      \brief Restore the last saved state into the node. Must be called before LoRaWANNode::activateOTAA/activateABP.
+      \returns \ref status_codes, RADIOLIB_ERR_NETWORK_NOT_JOINED if nothing was saved yet.
+    */
+    int16_t restore();
+
+    /*!
+      \brief Save the current node state. Only the counters are written unless some other part of the state changed.
+      \returns \ref status_codes
+    */
+    int16_t save();
+
+    /*!
+      \brief Write a fresh snapshot of the current state and clear the counter log.
+      \returns \ref status_codes
+    */
+    int16_t compact();
+
+    /*!
+      \brief Get the total storage size needed.
+      \returns Size in bytes.
+    */
+    uint32_t getStorageSize();
+
+#if !RADIOLIB_GODMODE
+  private:
+#endif
+    LoRaWANNode* node = NULL;
+    LoRaWANSessionStorage* storage = NULL;
+    uint32_t slotSize = 0;
+    uint32_t logSize = 0;
+
+    // state of the storage, loaded on first access
+    bool scanned = false;
+    bool valid = false;
+    uint32_t generation = 0;
+    uint32_t logHead = 0;
+
+    int16_t scan(uint8_t* snapshot, uint8_t* record, bool* hasRecord);
+    int16_t readSlot(uint8_t slot, uint8_t* snapshot, uint32_t* gen);
+    int16_t readRecord(uint32_t index, uint8_t* record, bool* written);
+    int16_t writeSnapshot(uint8_t* snapshot, const uint8_t* nonces, const uint8_t* session);
+    bool isSameState(const uint8_t* snapshot, const uint8_t* nonces, const uint8_t* session);
+    uint32_t getLogCapacity();
+    static uint16_t crc16(const uint8_t* data, size_t len);
+};
+
+#endif
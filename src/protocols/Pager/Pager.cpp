@@ -9,7 +9,23 @@
 
 #if !RADIOLIB_EXCLUDE_PAGER
 
+// multiplicative hash of an address filter key into a table of 2^bits slots
+static inline size_t PagerClientFilterSlot(uint32_t key, uint8_t bits) {
+  return((uint32_t)(key * 2654435761UL) >> (32 - bits));
+}
+
 #if !RADIOLIB_EXCLUDE_DIRECT_RECEIVE
+// the 20 message bits of a code word in the order they were sent, the first one in the LSB
+// message symbols are sent LSB first, so this reverses the whole code word once instead of each symbol
+static inline uint32_t PagerClientMessageBits(uint32_t cw) {
+  cw = ((cw >> 1) & 0x55555555UL) | ((cw & 0x55555555UL) << 1);
+  cw = ((cw >> 2) & 0x33333333UL) | ((cw & 0x33333333UL) << 2);
+  cw = ((cw >> 4) & 0x0F0F0F0FUL) | ((cw & 0x0F0F0F0FUL) << 4);
+  cw = ((cw >> 8) & 0x00FF00FFUL) | ((cw & 0x00FF00FFUL) << 8);
+  cw = (cw >> 16) | (cw << 16);
+  return((cw >> 1) & 0xFFFFFUL);
+}
+
 // this is a massive hack, but we need a global-scope ISR to manage the bit reading
 // let's hope nobody ever tries running two POCSAG receivers at the same time
 static PhysicalLayer* readBitInstance = NULL;
@@ -32,10 +48,70 @@ PagerClient::PagerClient(PhysicalLayer* phy) {
   #endif
 }
 
+PagerClient::PagerClient(const PagerClient& pager) : PagerClient(pager.phyLayer) {
+  *this = pager;
+}
+
+PagerClient& PagerClient::operator=(const PagerClient& pager) {
+  if(&pager == this) {
+    return(*this);
+  }
+
+  this->phyLayer = pager.phyLayer;
+  this->baseFreq = pager.baseFreq;
+  this->dataRate = pager.dataRate;
+  this->baseFreqRaw = pager.baseFreqRaw;
+  this->shiftFreq = pager.shiftFreq;
+  this->shiftFreqHz = pager.shiftFreqHz;
+  this->bitDuration = pager.bitDuration;
+  this->inv = pager.inv;
+  this->rxSpeed = pager.rxSpeed;
+
+  // the address arrays belong to the user, but each instance has its own lookup table
+  this->filterAddr = pager.filterAddr;
+  this->filterMask = pager.filterMask;
+  this->filterAddresses = pager.filterAddresses;
+  this->filterMasks = pager.filterMasks;
+  this->filterNumAddresses = pager.filterNumAddresses;
+  this->buildFilter();
+
+  // multi-rate reception state, including the batches that were not read yet
+  this->multiRate = pager.multiRate;
+  #if !RADIOLIB_STATIC_ONLY
+    if(pager.streams && !this->streams) {
+      this->streams = new PagerStream_t[RADIOLIB_PAGER_MULTI_RATE_NUM_STREAMS];
+      this->queue = new PagerBatch_t[RADIOLIB_PAGER_MULTI_RATE_QUEUE_LEN];
+    }
+    if(pager.streams) {
+      memcpy(this->streams, pager.streams, RADIOLIB_PAGER_MULTI_RATE_NUM_STREAMS*sizeof(PagerStream_t));
+      memcpy(this->queue, pager.queue, RADIOLIB_PAGER_MULTI_RATE_QUEUE_LEN*sizeof(PagerBatch_t));
+    }
+  #else
+    memcpy(this->streams, pager.streams, sizeof(this->streams));
+    memcpy(this->queue, pager.queue, sizeof(this->queue));
+  #endif
+  this->queueHead = pager.queueHead;
+  this->queueLen = pager.queueLen;
+  this->queuePos = pager.queuePos;
+  this->queueSync = pager.queueSync;
+
+  return(*this);
+}
+
+PagerClient::~PagerClient() {
+  #if !RADIOLIB_STATIC_ONLY
+    delete[] this->filterTable;
+    delete[] this->filterTableMasks;
+    delete[] this->streams;
+    delete[] this->queue;
+  #endif
+}
+
 int16_t PagerClient::begin(float base, uint16_t speed, bool invert, uint16_t shift) {
   // calculate duration of 1 bit in us
   dataRate = (float)speed/1000.0f;
   bitDuration = (RadioLibTime_t)1000000/speed;
+  rxSpeed = speed;
 
   // calculate 24-bit frequency
   baseFreq = base;
@@ -246,6 +322,7 @@ int16_t PagerClient::startReceive(uint32_t pin, uint32_t addr, uint32_t mask) {
   filterAddresses = NULL;
   filterMasks = NULL;
   filterNumAddresses = 0;
+  buildFilter();
   return(startReceiveCommon());
 }
 
@@ -257,6 +334,7 @@ int16_t PagerClient::startReceive(uint32_t pin, uint32_t *addrs, uint32_t *masks
   filterAddresses = addrs;
   filterMasks = masks;
   filterNumAddresses = numAddresses;
+  buildFilter();
   return(startReceiveCommon());
 }
 
@@ -265,8 +343,12 @@ int16_t PagerClient::startReceiveCommon() {
   int16_t state = phyLayer->setFrequency(baseFreq);
   RADIOLIB_ASSERT(state);
 
-  // set bitrate
-  state = phyLayer->setBitRate(dataRate);
+  // set bitrate, in multi-rate reception fast enough to sample all the rates
+  if(this->multiRate) {
+    state = phyLayer->setBitRate((float)RADIOLIB_PAGER_MULTI_RATE_SAMPLE_RATE / 1000.0f);
+  } else {
+    state = phyLayer->setBitRate(dataRate);
+  }
   RADIOLIB_ASSERT(state);
 
   // set frequency deviation to 4.5 khz
@@ -280,7 +362,11 @@ int16_t PagerClient::startReceiveCommon() {
   // set direct sync word to the frame sync word
   // the logic here is inverted, because modules like SX1278
   // assume high frequency to be logic 1, which is opposite to POCSAG
-  if(!inv) {
+  if(this->multiRate) {
+    // every sample is needed, sync words are found in software for each rate
+    phyLayer->setDirectSyncWord(0, 0);
+    resetMultiRate();
+  } else if(!inv) {
     phyLayer->setDirectSyncWord(~RADIOLIB_PAGER_FRAME_SYNC_CODE_WORD, 32);
   } else {
     phyLayer->setDirectSyncWord(RADIOLIB_PAGER_FRAME_SYNC_CODE_WORD, 32);
@@ -292,7 +378,25 @@ int16_t PagerClient::startReceiveCommon() {
   return(state);
 }
 
+int16_t PagerClient::setMultiRate(bool enable) {
+  #if !RADIOLIB_STATIC_ONLY
+    if(enable && !this->streams) {
+      this->streams = new PagerStream_t[RADIOLIB_PAGER_MULTI_RATE_NUM_STREAMS];
+      this->queue = new PagerBatch_t[RADIOLIB_PAGER_MULTI_RATE_QUEUE_LEN];
+    }
+  #endif
+  this->multiRate = enable;
+  if(enable) {
+    resetMultiRate();
+  }
+  return(RADIOLIB_ERR_NONE);
+}
+
 size_t PagerClient::available() {
+  if(this->multiRate) {
+    processSamples();
+    return(this->queueLen);
+  }
   return(phyLayer->available() + sizeof(uint32_t))/(sizeof(uint32_t) * (RADIOLIB_PAGER_BATCH_LEN + 1));
 }
 
@@ -346,9 +450,15 @@ int16_t PagerClient::readData(uint8_t* data, size_t* len, uint32_t* addr) {
   bool match = false;
   uint8_t framePos = 0;
   uint8_t symbolLength = 0;
-  while(!match && phyLayer->available()) {
-    uint32_t cw = read();
-    framePos++;
+  while(!match && codeWordAvailable()) {
+    int8_t errors = 0;
+    uint32_t cw = read(&errors);
+    uint8_t cwPos = framePos++;
+
+    // the address can not be trusted if the code word could not be corrected
+    if(errors < 0) {
+      continue;
+    }
 
     // check if it's the idle code word
     if(cw == RADIOLIB_PAGER_IDLE_CODE_WORD) {
@@ -368,7 +478,7 @@ int16_t PagerClient::readData(uint8_t* data, size_t* len, uint32_t* addr) {
     }
 
     // should be an address code word, extract the address
-    uint32_t addr_found = ((cw & RADIOLIB_PAGER_ADDRESS_BITS_MASK) >> (RADIOLIB_PAGER_ADDRESS_POS - 3)) | (framePos/2);
+    uint32_t addr_found = ((cw & RADIOLIB_PAGER_ADDRESS_BITS_MASK) >> (RADIOLIB_PAGER_ADDRESS_POS - 3)) | (cwPos/2);
     if (addressMatched(addr_found)) {
       match = true;
       if(addr) {
@@ -390,12 +500,13 @@ int16_t PagerClient::readData(uint8_t* data, size_t* len, uint32_t* addr) {
   }
 
   // we have the address, start pulling out the message
+  size_t maxLen = (*len > 0) ? *len : (size_t)-1;
   size_t decodedBytes = 0;
-  uint32_t prevCw = 0;
-  bool overflow = false;
-  int8_t ovfBits = 0;
-  while(phyLayer->available()) {
-    uint32_t cw = read();
+  uint32_t symbols = 0;
+  uint8_t numBits = 0;
+  while(codeWordAvailable()) {
+    int8_t errors = 0;
+    uint32_t cw = read(&errors);
 
     // check if it's the idle code word
     if(cw == RADIOLIB_PAGER_IDLE_CODE_WORD) {
@@ -407,69 +518,289 @@ int16_t PagerClient::readData(uint8_t* data, size_t* len, uint32_t* addr) {
       continue;
     }
 
-    // check overflow from previous code word
-    uint8_t bitPos = RADIOLIB_PAGER_CODE_WORD_LEN - 1 - symbolLength;
-    if(overflow) {
-      overflow = false;
-
-      // this is a bit convoluted - first, build masks for both previous and current code word
-      uint8_t currPos = RADIOLIB_PAGER_CODE_WORD_LEN - 1 - symbolLength + ovfBits;
-      uint8_t prevPos = RADIOLIB_PAGER_MESSAGE_END_POS;
-      uint32_t prevMask = (0x7FUL << prevPos) & ~((uint32_t)0x7FUL << (RADIOLIB_PAGER_MESSAGE_END_POS + ovfBits));
-      uint32_t currMask = (0x7FUL << currPos) & ~((uint32_t)1 << (RADIOLIB_PAGER_CODE_WORD_LEN - 1));
+    // the next address code word ends the message as well
+    if((errors >= 0) && !(cw & (RADIOLIB_PAGER_MESSAGE_CODE_WORD << (RADIOLIB_PAGER_CODE_WORD_LEN - 1)))) {
+      break;
+    }
 
-      // next, get the two parts of the message symbol and stick them together
-      uint8_t prevSymbol = (prevCw & prevMask) >> prevPos;
-      uint8_t currSymbol = (cw & currMask) >> currPos;
-      uint32_t symbol = prevSymbol << (symbolLength - ovfBits) | currSymbol;
+    decodedBytes += decodeSymbols(cw, symbolLength, &symbols, &numBits, &data[decodedBytes], maxLen - decodedBytes);
+  }
 
-      // finally, we can flip the bits
-      symbol = rlb_reflect((uint8_t)symbol, 8);
-      symbol >>= (8 - symbolLength);
+  // save the number of decoded bytes
+  *len = decodedBytes;
+  return(RADIOLIB_ERR_NONE);
+}
 
-      // decode BCD and we're done
-      if(symbolLength == 4) {
-        symbol = decodeBCD(symbol);
-      }
-      data[decodedBytes++] = symbol;
+int16_t PagerClient::readBatch(PagerMessage_t* msgs, size_t* numMsgs, uint8_t* data, size_t len) {
+  if(!msgs || !numMsgs || (!data && (len > 0))) {
+    return(RADIOLIB_ERR_NULL_POINTER);
+  }
+  size_t maxMsgs = *numMsgs;
+  *numMsgs = 0;
 
-      // adjust the bit position of the next message symbol
-      bitPos += ovfBits;
-      bitPos -= symbolLength;
+  // in multi-rate reception, skip whatever readData left over from a batch, so that the framing starts over
+  if(this->multiRate) {
+    while(this->queuePos > 0) {
+      (void)read();
     }
+    this->queueSync = false;
+  }
 
-    // get the message symbols based on the encoding type
-    while(bitPos >= RADIOLIB_PAGER_MESSAGE_END_POS) {
-      // get the message symbol from the code word and reverse bits
-      uint32_t symbol = (cw & (0x7FUL << bitPos)) >> bitPos;
-      symbol = rlb_reflect((uint8_t)symbol, 8);
-      symbol >>= (8 - symbolLength);
+  // the sync word of the first batch was already consumed by the direct mode sync word detection
+  size_t numBatches = available();
+  if(numBatches == 0) {
+    return(RADIOLIB_ERR_ADDRESS_NOT_FOUND);
+  }
+  size_t numCodeWords = numBatches*(RADIOLIB_PAGER_BATCH_LEN + 1) - 1;
 
-      // decode BCD if needed
-      if(symbolLength == 4) {
-        symbol = decodeBCD(symbol);
+  PagerMessage_t* msg = NULL;
+  uint8_t symbolLength = 0;
+  uint32_t symbols = 0;
+  uint8_t numBits = 0;
+  size_t dataPos = 0;
+  for(size_t i = 0; i < numCodeWords; i++) {
+    int8_t errors = 0;
+    uint32_t cw = read(&errors);
+
+    // code words are framed by their position in the batch, so a damaged sync word does not shift the frames
+    size_t batchPos = (i + 1) % (RADIOLIB_PAGER_BATCH_LEN + 1);
+    if(batchPos == 0) {
+      continue;
+    }
+    batchPos--;
+
+    // idle and address code words end the current message
+    bool isMessage = cw & (RADIOLIB_PAGER_MESSAGE_CODE_WORD << (RADIOLIB_PAGER_CODE_WORD_LEN - 1));
+    if((errors >= 0) && ((cw == RADIOLIB_PAGER_IDLE_CODE_WORD) || !isMessage)) {
+      msg = NULL;
+      if(cw == RADIOLIB_PAGER_IDLE_CODE_WORD) {
+        continue;
       }
-      data[decodedBytes++] = symbol;
-
-      // now calculate if the next symbol is overflowing to the following code word
-      int8_t remBits = bitPos - RADIOLIB_PAGER_MESSAGE_END_POS;
-      if(remBits < symbolLength) {
-        // overflow!
-        prevCw = cw;
-        overflow = true;
-        ovfBits = remBits;
+
+      uint32_t addrFound = ((cw & RADIOLIB_PAGER_ADDRESS_BITS_MASK) >> (RADIOLIB_PAGER_ADDRESS_POS - 3)) | (batchPos/2);
+      if(!addressMatched(addrFound) || (*numMsgs >= maxMsgs)) {
+        continue;
       }
-      bitPos -= symbolLength;
+
+      // new message starts
+      msg = &msgs[(*numMsgs)++];
+      msg->addr = addrFound;
+      msg->function = (cw & RADIOLIB_PAGER_FUNCTION_BITS_MASK) >> RADIOLIB_PAGER_FUNC_BITS_POS;
+      msg->speed = this->rxSpeed;
+      msg->data = &data[dataPos];
+      msg->len = 0;
+      msg->errors = errors;
+      msg->uncorrectable = 0;
+      symbolLength = (msg->function == RADIOLIB_PAGER_FUNC_BITS_NUMERIC) ? 4 : 7;
+      symbols = 0;
+      numBits = 0;
+      continue;
     }
 
+    // message code word, or one that could not be corrected
+    if(!msg) {
+      continue;
+    }
+    if(errors < 0) {
+      if(msg->uncorrectable < 0xFF) {
+        msg->uncorrectable++;
+      }
+    } else {
+      msg->errors = RADIOLIB_MIN(msg->errors + errors, 0xFF);
+    }
+
+    size_t num = decodeSymbols(cw, symbolLength, &symbols, &numBits, &data[dataPos], len - dataPos);
+    dataPos += num;
+    msg->len += num;
   }
 
-  // save the number of decoded bytes
-  *len = decodedBytes;
+  if(*numMsgs == 0) {
+    return(RADIOLIB_ERR_ADDRESS_NOT_FOUND);
+  }
   return(RADIOLIB_ERR_NONE);
 }
+
+void PagerClient::resetMultiRate() {
+  const uint16_t speeds[RADIOLIB_PAGER_MULTI_RATE_NUM_STREAMS] = { 512, 1200, 2400 };
+  for(size_t i = 0; i < RADIOLIB_PAGER_MULTI_RATE_NUM_STREAMS; i++) {
+    memset(&this->streams[i], 0, sizeof(PagerStream_t));
+    this->streams[i].speed = speeds[i];
+    this->streams[i].pllStep = ((uint64_t)speeds[i] << 32) / RADIOLIB_PAGER_MULTI_RATE_SAMPLE_RATE;
+    this->streams[i].state = RADIOLIB_PAGER_STREAM_SEARCH;
+  }
+  this->queueHead = 0;
+  this->queueLen = 0;
+  this->queuePos = 0;
+  this->queueSync = false;
+}
+
+void PagerClient::processSamples() {
+  while(phyLayer->available() > 0) {
+    uint8_t samples = phyLayer->read(false);
+
+    // the logic here is inverted, because modules like SX1278
+    // assume high frequency to be logic 1, which is opposite to POCSAG
+    if(!inv) {
+      samples = ~samples;
+    }
+
+    // every stream sees every sample, so a batch at one rate is not lost while another one is being received
+    for(int8_t i = 7; i >= 0; i--) {
+      for(size_t j = 0; j < RADIOLIB_PAGER_MULTI_RATE_NUM_STREAMS; j++) {
+        processSample(&this->streams[j], (samples >> i) & 0x01);
+      }
+    }
+  }
+}
+
+void PagerClient::processSample(PagerStream_t* stream, uint8_t sample) {
+  // level changes are at bit edges, pull the clock towards them
+  if(sample != stream->prevSample) {
+    int32_t p = (int32_t)stream->pll;
+    stream->pll = (uint32_t)(p - p/4);
+    stream->prevSample = sample;
+  }
+
+  // the bit is sampled when the clock wraps, half a bit after the edges
+  int32_t prev = (int32_t)stream->pll;
+  stream->pll += stream->pllStep;
+  if(!((prev >= 0) && ((int32_t)stream->pll < 0))) {
+    return;
+  }
+  stream->bits = (stream->bits << 1) | sample;
+
+  if(stream->state == RADIOLIB_PAGER_STREAM_SEARCH) {
+    // look for the sync word at every bit
+    if(rlb_popcount(stream->bits ^ RADIOLIB_PAGER_FRAME_SYNC_CODE_WORD) <= RADIOLIB_PAGER_MULTI_RATE_SYNC_ERRORS) {
+      RADIOLIB_DEBUG_PROTOCOL_PRINTLN("POCSAG sync at %u bps", stream->speed);
+      stream->state = RADIOLIB_PAGER_STREAM_BATCH;
+      stream->numBits = 0;
+      stream->numCodeWords = 0;
+    }
+    return;
+  }
+
+  if(++stream->numBits < RADIOLIB_PAGER_CODE_WORD_LEN) {
+    return;
+  }
+  stream->numBits = 0;
+
+  if(stream->state == RADIOLIB_PAGER_STREAM_SYNC) {
+    // the next batch has to follow right away, otherwise the transmission is over
+    if(rlb_popcount(stream->bits ^ RADIOLIB_PAGER_FRAME_SYNC_CODE_WORD) <= RADIOLIB_PAGER_MULTI_RATE_SYNC_ERRORS) {
+      stream->state = RADIOLIB_PAGER_STREAM_BATCH;
+    } else {
+      stream->state = RADIOLIB_PAGER_STREAM_SEARCH;
+    }
+    return;
+  }
+
+  stream->batch[stream->numCodeWords++] = stream->bits;
+  if(stream->numCodeWords < RADIOLIB_PAGER_BATCH_LEN) {
+    return;
+  }
+  stream->numCodeWords = 0;
+  stream->state = RADIOLIB_PAGER_STREAM_SYNC;
+
+  // complete batch, queue it to be read
+  if(this->queueLen >= RADIOLIB_PAGER_MULTI_RATE_QUEUE_LEN) {
+    RADIOLIB_DEBUG_PROTOCOL_PRINTLN("POCSAG queue full, batch dropped");
+    return;
+  }
+  PagerBatch_t* batch = &this->queue[(this->queueHead + this->queueLen) % RADIOLIB_PAGER_MULTI_RATE_QUEUE_LEN];
+  batch->speed = stream->speed;
+  memcpy(batch->codeWords, stream->batch, sizeof(batch->codeWords));
+  this->queueLen++;
+}
+
+size_t PagerClient::decodeSymbols(uint32_t cw, uint8_t symbolLength, uint32_t* symbols, uint8_t* numBits, uint8_t* data, size_t len) {
+  // append the message bits to the ones left over from the previous code word
+  *symbols |= PagerClientMessageBits(cw) << *numBits;
+  *numBits += RADIOLIB_PAGER_MESSAGE_BITS_LENGTH;
+
+  // then shift out all the complete symbols
+  size_t num = 0;
+  while(*numBits >= symbolLength) {
+    uint8_t symbol = *symbols & ((1UL << symbolLength) - 1);
+    *symbols >>= symbolLength;
+    *numBits -= symbolLength;
+    if(num >= len) {
+      continue;
+    }
+
+    // decode BCD if needed
+    if(symbolLength == 4) {
+      symbol = decodeBCD(symbol);
+    }
+    data[num++] = symbol;
+  }
+  return(num);
+}
 #endif
 
+void PagerClient::buildFilter() {
+  #if !RADIOLIB_STATIC_ONLY
+    delete[] this->filterTable;
+    delete[] this->filterTableMasks;
+    this->filterTable = nullptr;
+    this->filterTableMasks = nullptr;
+  #endif
+  this->filterTableBits = 0;
+  this->filterTableNumMasks = 0;
+  if((filterAddresses == NULL) || (filterMasks == NULL) || (filterNumAddresses == 0)) {
+    return;
+  }
+
+  // at least twice as many slots as there are addresses, to keep the probe sequences short
+  uint8_t bits = 1;
+  while(((size_t)1 << bits) < 2*filterNumAddresses) {
+    bits++;
+  }
+  size_t tableLen = (size_t)1 << bits;
+
+  // if the table does not fit, addresses will be matched one by one
+  #if RADIOLIB_STATIC_ONLY
+    if(tableLen > RADIOLIB_PAGER_FILTER_TABLE_LEN) {
+      return;
+    }
+    size_t maxMasks = RADIOLIB_PAGER_FILTER_TABLE_MASKS;
+  #else
+    if(bits >= 32) {
+      return;
+    }
+    size_t maxMasks = RADIOLIB_MIN(filterNumAddresses, (size_t)RADIOLIB_PAGER_FILTER_MAX_MASKS);
+    this->filterTable = new uint32_t[tableLen];
+    this->filterTableMasks = new uint32_t[maxMasks];
+  #endif
+  memset(this->filterTable, 0xFF, tableLen*sizeof(uint32_t));
+
+  // addresses are grouped by their masks, the group index is stored above the address bits
+  for(size_t i = 0; i < filterNumAddresses; i++) {
+    uint32_t mask = filterMasks[i] & RADIOLIB_PAGER_ADDRESS_MAX;
+    size_t group = 0;
+    while((group < this->filterTableNumMasks) && (this->filterTableMasks[group] != mask)) {
+      group++;
+    }
+    if(group == this->filterTableNumMasks) {
+      if(group >= maxMasks) {
+        // too many distinct masks
+        this->filterTableNumMasks = 0;
+        return;
+      }
+      this->filterTableMasks[this->filterTableNumMasks++] = mask;
+    }
+
+    uint32_t key = (filterAddresses[i] & mask) | ((uint32_t)group << RADIOLIB_PAGER_FILTER_MASK_POS);
+    size_t slot = PagerClientFilterSlot(key, bits);
+    while((this->filterTable[slot] != RADIOLIB_PAGER_FILTER_EMPTY) && (this->filterTable[slot] != key)) {
+      slot = (slot + 1) & (tableLen - 1);
+    }
+    this->filterTable[slot] = key;
+  }
+
+  this->filterTableBits = bits;
+}
+
 bool PagerClient::addressMatched(uint32_t addr) {
   // check whether to match single or multiple addresses/masks
   if(filterNumAddresses == 0) {
@@ -481,6 +812,22 @@ bool PagerClient::addressMatched(uint32_t addr) {
     return(false);
   }
 
+  // one lookup per distinct mask
+  if(this->filterTableBits > 0) {
+    size_t tableMask = ((size_t)1 << this->filterTableBits) - 1;
+    for(size_t group = 0; group < this->filterTableNumMasks; group++) {
+      uint32_t key = (addr & this->filterTableMasks[group]) | ((uint32_t)group << RADIOLIB_PAGER_FILTER_MASK_POS);
+      size_t slot = PagerClientFilterSlot(key, this->filterTableBits);
+      while(this->filterTable[slot] != RADIOLIB_PAGER_FILTER_EMPTY) {
+        if(this->filterTable[slot] == key) {
+          return(true);
+        }
+        slot = (slot + 1) & tableMask;
+      }
+    }
+    return(false);
+  }
+
   for(size_t i = 0; i < filterNumAddresses; i++) {
     if((filterAddresses[i] & filterMasks[i]) == (addr & filterMasks[i])) {
       return(true);
@@ -532,24 +879,61 @@ void PagerClient::write(uint32_t codeWord) {
 }
 
 #if !RADIOLIB_EXCLUDE_DIRECT_RECEIVE
-uint32_t PagerClient::read() {
+uint32_t PagerClient::read(int8_t* errors) {
   uint32_t codeWord = 0;
-  codeWord |= (uint32_t)phyLayer->read() << 24;
-  codeWord |= (uint32_t)phyLayer->read() << 16;
-  codeWord |= (uint32_t)phyLayer->read() << 8;
-  codeWord |= (uint32_t)phyLayer->read();
+  if(this->multiRate) {
+    // queued batches are read as if they were received in one stream, separated by sync words
+    if(this->queueSync) {
+      this->queueSync = false;
+      codeWord = RADIOLIB_PAGER_FRAME_SYNC_CODE_WORD;
+
+    } else if(this->queueLen == 0) {
+      codeWord = RADIOLIB_PAGER_IDLE_CODE_WORD;
+
+    } else {
+      PagerBatch_t* batch = &this->queue[this->queueHead];
+      this->rxSpeed = batch->speed;
+      codeWord = batch->codeWords[this->queuePos++];
+      if(this->queuePos >= RADIOLIB_PAGER_BATCH_LEN) {
+        this->queuePos = 0;
+        this->queueHead = (this->queueHead + 1) % RADIOLIB_PAGER_MULTI_RATE_QUEUE_LEN;
+        this->queueLen--;
+        this->queueSync = (this->queueLen > 0);
+      }
+
+    }
+
+  } else {
+    codeWord |= (uint32_t)phyLayer->read() << 24;
+    codeWord |= (uint32_t)phyLayer->read() << 16;
+    codeWord |= (uint32_t)phyLayer->read() << 8;
+    codeWord |= (uint32_t)phyLayer->read();
+
+    // check if we need to invert bits
+    // the logic here is inverted, because modules like SX1278
+    // assume high frequency to be logic 1, which is opposite to POCSAG
+    if(!inv) {
+      codeWord = ~codeWord;
+    }
 
-  // check if we need to invert bits
-  // the logic here is inverted, because modules like SX1278
-  // assume high frequency to be logic 1, which is opposite to POCSAG
-  if(!inv) {
-    codeWord = ~codeWord;
   }
 
   RADIOLIB_DEBUG_PROTOCOL_PRINTLN("R\t%lX", (long unsigned int)codeWord);
-  // TODO BCH error correction here
+
+  // correct the code word before anything is parsed from it
+  int8_t numErrors = RadioLibBCHInstance.decode(&codeWord);
+  if(errors) {
+    *errors = numErrors;
+  }
   return(codeWord);
 }
+
+bool PagerClient::codeWordAvailable() {
+  if(this->multiRate) {
+    return(this->queueSync || (this->queueLen > 0));
+  }
+  return(phyLayer->available() > 0);
+}
 #endif
 
 uint8_t PagerClient::encodeBCD(char c) {
@@ -55,6 +55,114 @@
 // the maximum allowed address (2^22 - 1)
 #define RADIOLIB_PAGER_ADDRESS_MAX                              (2097151)
 
+// address filter hash table, used when receiving with multiple addresses/masks
+#define RADIOLIB_PAGER_FILTER_EMPTY                             (0xFFFFFFFFUL)
+#define RADIOLIB_PAGER_FILTER_MASK_POS                          (21)
+#define RADIOLIB_PAGER_FILTER_MAX_MASKS                         (2047)
+
+#if RADIOLIB_STATIC_ONLY
+// maximum number of table slots in static mode, must be a power of 2
+// with more than half of the slots used, filters are matched one by one instead
+#if !defined(RADIOLIB_PAGER_FILTER_TABLE_LEN)
+  #define RADIOLIB_PAGER_FILTER_TABLE_LEN                       (64)
+#endif
+
+// maximum number of distinct masks in static mode
+#if !defined(RADIOLIB_PAGER_FILTER_TABLE_MASKS)
+  #define RADIOLIB_PAGER_FILTER_TABLE_MASKS                     (8)
+#endif
+#endif
+
+// multi-rate reception - the radio samples the signal at a fixed rate, and bit timing is recovered in software
+// the default gives at least 4 samples per bit at 2400 bps
+#if !defined(RADIOLIB_PAGER_MULTI_RATE_SAMPLE_RATE)
+  #define RADIOLIB_PAGER_MULTI_RATE_SAMPLE_RATE                 (9600)
+#endif
+#define RADIOLIB_PAGER_MULTI_RATE_NUM_STREAMS                   (3)
+#define RADIOLIB_PAGER_MULTI_RATE_SYNC_ERRORS                   (2)
+
+// number of received batches that can be held until they are read
+#if !defined(RADIOLIB_PAGER_MULTI_RATE_QUEUE_LEN)
+  #define RADIOLIB_PAGER_MULTI_RATE_QUEUE_LEN                   (4)
+#endif
+
+// sync stream states
+#define RADIOLIB_PAGER_STREAM_SEARCH                            (0)
+#define RADIOLIB_PAGER_STREAM_BATCH                             (1)
+#define RADIOLIB_PAGER_STREAM_SYNC                              (2)
+
+/*!
+  \struct PagerStream_t
+  \brief Bit timing recovery and batch assembly for one of the rates in multi-rate reception.
+*/
+struct PagerStream_t {
+  /*! \brief Bit rate of this stream in bps. */
+  uint16_t speed;
+
+  /*! \brief Clock increment per sample, a full bit is 2^32. */
+  uint32_t pllStep;
+
+  /*! \brief Bit clock, wraps once per bit. */
+  uint32_t pll;
+
+  /*! \brief Previous sample, to find the transitions. */
+  uint8_t prevSample;
+
+  /*! \brief Last 32 received bits. */
+  uint32_t bits;
+
+  /*! \brief Current state, one of RADIOLIB_PAGER_STREAM_* values. */
+  uint8_t state;
+
+  /*! \brief Number of bits received since the last code word. */
+  uint8_t numBits;
+
+  /*! \brief Number of code words received in the current batch. */
+  uint8_t numCodeWords;
+
+  /*! \brief Code words of the current batch. */
+  uint32_t batch[RADIOLIB_PAGER_BATCH_LEN];
+};
+
+/*!
+  \struct PagerBatch_t
+  \brief Batch received in multi-rate reception, waiting to be read.
+*/
+struct PagerBatch_t {
+  /*! \brief Bit rate the batch was received at in bps. */
+  uint16_t speed;
+
+  /*! \brief Code words of the batch, without the sync word. */
+  uint32_t codeWords[RADIOLIB_PAGER_BATCH_LEN];
+};
+
+/*!
+  \struct PagerMessage_t
+  \brief Message received in a POCSAG batch, as returned by PagerClient::readBatch.
+*/
+struct PagerMessage_t {
+  /*! \brief Address of the message. */
+  uint32_t addr;
+
+  /*! \brief Function bits of the address code word. */
+  uint8_t function;
+
+  /*! \brief Bit rate the message was received at in bps. */
+  uint16_t speed;
+
+  /*! \brief Message contents, points into the buffer passed to readBatch. Not null-terminated. */
+  uint8_t* data;
+
+  /*! \brief Length of the message contents, 0 for tone-only messages. */
+  size_t len;
+
+  /*! \brief Number of bit errors corrected in the code words of this message. */
+  uint8_t errors;
+
+  /*! \brief Number of code words in this message that could not be corrected. */
+  uint8_t uncorrectable;
+};
+
 /*!
   \class PagerClient
   \brief Client for Pager communication.
@@ -67,6 +175,23 @@ class PagerClient {
     */
     explicit PagerClient(PhysicalLayer* phy);
 
+    /*!
+      \brief Copy constructor.
+      \param pager PagerClient instance to copy.
+    */
+    PagerClient(const PagerClient& pager);
+
+    /*!
+      \brief Overload for assignment operator.
+      \param pager rvalue PagerClient.
+    */
+    PagerClient& operator=(const PagerClient& pager);
+
+    /*!
+      \brief Default destructor.
+    */
+    ~PagerClient();
+
     // basic methods
 
     /*!
@@ -132,6 +257,8 @@ class PagerClient {
 
     /*!
       \brief Start reception of POCSAG packets for multiple addresses and masks.
+      Addresses are stored in a hash table, so matching takes the same time regardless of their number,
+      and only grows with the number of distinct masks.
       \param pin Pin to receive digital data on (e.g., DIO2 for SX127x).
       \param addrs Array of addresses to receive.
       \param masks Array of address masks to use for filtering. Masks will be applied to corresponding addresses in addr array.
@@ -140,8 +267,19 @@ class PagerClient {
     */
     int16_t startReceive(uint32_t pin, uint32_t *addrs, uint32_t *masks, size_t numAddress);
 
+    /*!
+      \brief Enable or disable multi-rate reception. When enabled, startReceive samples the signal
+      at RADIOLIB_PAGER_MULTI_RATE_SAMPLE_RATE and receives 512, 1200 and 2400 bps batches at the same time,
+      regardless of the speed passed to begin. Timing of each rate is recovered in software while
+      available is called, which has to be often enough to keep the direct mode buffer from overflowing.
+      \param enable Whether to enable multi-rate reception.
+      \returns \ref status_codes
+    */
+    int16_t setMultiRate(bool enable);
+
     /*!
       \brief Get the number of POCSAG batches available in buffer. Limited by the size of direct mode buffer!
+      In multi-rate reception, this also processes the samples received so far.
       \returns Number of available batches.
     */
     size_t available();
@@ -170,6 +308,19 @@ class PagerClient {
       \returns \ref status_codes
     */
     int16_t readData(uint8_t* data, size_t* len, uint32_t* addr = NULL);
+
+    /*!
+      \brief Reads all messages from the batches that were received after calling startReceive method.
+      Every code word is BCH-corrected and parity-checked before it is parsed. Messages that continue
+      past the last available batch are returned truncated, so wait for enough batches as with readData.
+      \param msgs Array of messages to save the matching messages to.
+      \param numMsgs Pointer to variable holding the size of msgs array. Upon completion,
+      the number of messages will be written to this variable.
+      \param data Buffer to save the contents of all messages, each message points into this buffer.
+      \param len Size of the data buffer. Messages that do not fit are truncated.
+      \returns \ref status_codes
+    */
+    int16_t readBatch(PagerMessage_t* msgs, size_t* numMsgs, uint8_t* data, size_t len);
 #endif
 
 #if !RADIOLIB_GODMODE
@@ -188,15 +339,44 @@ class PagerClient {
     uint32_t *filterAddresses = nullptr;
     uint32_t *filterMasks = nullptr;
     size_t filterNumAddresses = 0;
+    #if RADIOLIB_STATIC_ONLY
+    uint32_t filterTable[RADIOLIB_PAGER_FILTER_TABLE_LEN];
+    uint32_t filterTableMasks[RADIOLIB_PAGER_FILTER_TABLE_MASKS];
+    #else
+    uint32_t* filterTable = nullptr;
+    uint32_t* filterTableMasks = nullptr;
+    #endif
+    uint8_t filterTableBits = 0;
+    size_t filterTableNumMasks = 0;
     bool inv = false;
 
+    bool multiRate = false;
+    #if RADIOLIB_STATIC_ONLY
+    PagerStream_t streams[RADIOLIB_PAGER_MULTI_RATE_NUM_STREAMS];
+    PagerBatch_t queue[RADIOLIB_PAGER_MULTI_RATE_QUEUE_LEN];
+    #else
+    PagerStream_t* streams = nullptr;
+    PagerBatch_t* queue = nullptr;
+    #endif
+    size_t queueHead = 0;
+    size_t queueLen = 0;
+    size_t queuePos = 0;
+    bool queueSync = false;
+    uint16_t rxSpeed = 0;
+
     void write(const uint32_t* data, size_t len);
     void write(uint32_t codeWord);
     int16_t startReceiveCommon();
+    void buildFilter();
     bool addressMatched(uint32_t addr);
 
 #if !RADIOLIB_EXCLUDE_DIRECT_RECEIVE
-    uint32_t read();
+    uint32_t read(int8_t* errors = NULL);
+    bool codeWordAvailable();
+    void resetMultiRate();
+    void processSamples();
+    void processSample(PagerStream_t* stream, uint8_t sample);
+    size_t decodeSymbols(uint32_t cw, uint8_t symbolLength, uint32_t* symbols, uint8_t* numBits, uint8_t* data, size_t len);
 #endif
 
     uint8_t encodeBCD(char c);
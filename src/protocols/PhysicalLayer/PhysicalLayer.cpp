@@ -2,12 +2,23 @@
 
 #include <string.h>
 
+#if !RADIOLIB_EXCLUDE_DIRECT_RECEIVE
+// keeps the compiler from moving buffer accesses across direct mode index accesses
+// the bit interrupt preempts the main context on the same core, so a signal fence is enough
+#if defined(__GNUC__)
+  #define RADIOLIB_DIRECT_BARRIER()                             __atomic_signal_fence(__ATOMIC_SEQ_CST)
+#else
+  #define RADIOLIB_DIRECT_BARRIER()
+#endif
+#endif
+
 PhysicalLayer::PhysicalLayer() {
   this->freqStep = 1;
   this->maxPacketLength = 1;
   #if !RADIOLIB_EXCLUDE_DIRECT_RECEIVE
   this->bufferBitPos = 0;
-  this->bufferWritePos = 0;
+  storeDirectIndex(this->bufferWritePos, 0);
+  storeDirectIndex(this->bufferReadPos, 0);
   #endif
 }
 
@@ -242,6 +253,81 @@ int16_t PhysicalLayer::setFrequency(float freq) {
   return(RADIOLIB_ERR_UNSUPPORTED);
 }
 
+int16_t PhysicalLayer::checkFrequency(float freq) {
+  (void)freq;
+  return(RADIOLIB_ERR_UNSUPPORTED);
+}
+
+int16_t PhysicalLayer::calculateFrequencyWord(float freq, uint32_t* word) {
+  (void)freq;
+  (void)word;
+  return(RADIOLIB_ERR_UNSUPPORTED);
+}
+
+int16_t PhysicalLayer::setFrequencyWord(uint32_t word) {
+  (void)word;
+  return(RADIOLIB_ERR_UNSUPPORTED);
+}
+
+int16_t PhysicalLayer::setHoppingSequence(const float* channels, uint32_t* words, size_t numChannels, const uint8_t* sequence, size_t seqLen) {
+  if(!channels || !words) {
+    return(RADIOLIB_ERR_NULL_POINTER);
+  }
+  if(numChannels == 0) {
+    return(RADIOLIB_ERR_INVALID_FREQUENCY);
+  }
+
+  // without explicit sequence, hop through all channels in order
+  if(!sequence) {
+    seqLen = numChannels;
+  } else if(seqLen == 0) {
+    return(RADIOLIB_ERR_INVALID_FREQUENCY);
+  }
+
+  // check the sequence only references existing channels
+  for(size_t i = 0; (i < seqLen) && sequence; i++) {
+    if(sequence[i] >= numChannels) {
+      return(RADIOLIB_ERR_INVALID_FREQUENCY);
+    }
+  }
+
+  // validate all channels and precompute the raw words, without touching the radio
+  int16_t state;
+  for(size_t i = 0; i < numChannels; i++) {
+    state = checkFrequency(channels[i]);
+    RADIOLIB_ASSERT(state);
+    state = calculateFrequencyWord(channels[i], &words[i]);
+    RADIOLIB_ASSERT(state);
+  }
+
+  this->hopWords = words;
+  this->hopSequence = sequence;
+  this->hopSeqLen = seqLen;
+  this->hopIndex = 0;
+
+  // tune to the first channel of the sequence
+  return(setFrequencyWord(this->hopWords[getHoppingChannel()]));
+}
+
+int16_t PhysicalLayer::hopFrequency() {
+  if(!this->hopWords) {
+    return(RADIOLIB_ERR_INVALID_FREQUENCY);
+  }
+
+  this->hopIndex++;
+  if(this->hopIndex >= this->hopSeqLen) {
+    this->hopIndex = 0;
+  }
+  return(setFrequencyWord(this->hopWords[getHoppingChannel()]));
+}
+
+size_t PhysicalLayer::getHoppingChannel() {
+  if(!this->hopSequence) {
+    return(this->hopIndex);
+  }
+  return(this->hopSequence[this->hopIndex]);
+}
+
 int16_t PhysicalLayer::setBitRate(float br) {
   (void)br;
   return(RADIOLIB_ERR_UNSUPPORTED);
@@ -267,6 +353,11 @@ int16_t PhysicalLayer::invertIQ(bool enable) {
   return(RADIOLIB_ERR_UNSUPPORTED);
 }
 
+int16_t PhysicalLayer::setPacketCRC(bool enable) {
+  (void)enable;
+  return(RADIOLIB_ERR_UNSUPPORTED);
+}
+
 int16_t PhysicalLayer::setOutputPower(int8_t power) {
   (void)power;
   return(RADIOLIB_ERR_UNSUPPORTED);
@@ -289,6 +380,15 @@ int16_t PhysicalLayer::setPreambleLength(size_t len) {
   return(RADIOLIB_ERR_UNSUPPORTED);
 }
 
+int16_t PhysicalLayer::implicitHeader(size_t len) {
+  (void)len;
+  return(RADIOLIB_ERR_UNSUPPORTED);
+}
+
+int16_t PhysicalLayer::explicitHeader() {
+  return(RADIOLIB_ERR_UNSUPPORTED);
+}
+
 int16_t PhysicalLayer::setDataRate(DataRate_t dr, ModemType_t modem) {
   (void)dr;
   (void)modem;
@@ -396,6 +496,20 @@ int16_t PhysicalLayer::scanChannel(const ChannelScanConfig_t &config) {
   return(RADIOLIB_ERR_UNSUPPORTED); 
 }
 
+int16_t PhysicalLayer::scanChannels(const uint32_t* words, size_t numChannels, const ChannelScanConfig_t &config, int16_t* results) {
+  if(!words || !results) {
+    return(RADIOLIB_ERR_NULL_POINTER);
+  }
+
+  for(size_t i = 0; i < numChannels; i++) {
+    int16_t state = setFrequencyWord(words[i]);
+    RADIOLIB_ASSERT(state);
+    results[i] = scanChannel(config);
+  }
+
+  return(RADIOLIB_ERR_NONE);
+}
+
 int32_t PhysicalLayer::random(int32_t max) {
   if(max == 0) {
     return(0);
@@ -443,7 +557,12 @@ int16_t PhysicalLayer::startDirect() {
 
 #if !RADIOLIB_EXCLUDE_DIRECT_RECEIVE
 int16_t PhysicalLayer::available() {
-  return(this->bufferWritePos);
+  size_t writePos = loadDirectIndex(this->bufferWritePos);
+  size_t readPos = loadDirectIndex(this->bufferReadPos);
+  if(writePos >= readPos) {
+    return(writePos - readPos);
+  }
+  return(writePos + RADIOLIB_STATIC_ARRAY_SIZE - readPos);
 }
 
 void PhysicalLayer::dropSync() {
@@ -457,17 +576,37 @@ uint8_t PhysicalLayer::read(bool drop) {
   if(drop) {
     dropSync();
   }
-  this->bufferWritePos--;
-  return(this->buffer[this->bufferReadPos++]);
+
+  // check there is something to read
+  size_t readPos = loadDirectIndex(this->bufferReadPos);
+  if(readPos == loadDirectIndex(this->bufferWritePos)) {
+    return(0);
+  }
+
+  // get the byte first, only then release the slot back to the producer
+  uint8_t b = this->buffer[readPos];
+  readPos++;
+  if(readPos == RADIOLIB_STATIC_ARRAY_SIZE) {
+    readPos = 0;
+  }
+  storeDirectIndex(this->bufferReadPos, readPos);
+  return(b);
 }
 
-int16_t PhysicalLayer::setDirectSyncWord(uint32_t syncWord, uint8_t len) {
+int16_t PhysicalLayer::setDirectSyncWord(uint32_t syncWord, uint8_t len, uint8_t maxErrors) {
   if(len > 32) {
     return(RADIOLIB_ERR_INVALID_SYNC_WORD);
   }
-  this->directSyncWordMask = 0xFFFFFFFF >> (32 - len);
+
+  // allowing as many errors as there are bits would match anything
+  if((len > 0) && (maxErrors >= len)) {
+    return(RADIOLIB_ERR_INVALID_SYNC_WORD);
+  }
+
+  this->directSyncWordMask = (len == 0) ? 0 : (0xFFFFFFFF >> (32 - len));
   this->directSyncWordLen = len;
   this->directSyncWord = syncWord;
+  this->directSyncWordErrors = maxErrors;
 
   // override sync word matching when length is set to 0
   if(this->directSyncWordLen == 0) {
@@ -478,38 +617,63 @@ int16_t PhysicalLayer::setDirectSyncWord(uint32_t syncWord, uint8_t len) {
 }
 
 void PhysicalLayer::updateDirectBuffer(uint8_t bit) {
+  // shift in the new bit, the same register is used for sync word matching and for data
+  this->syncBuffer <<= 1;
+  this->syncBuffer |= (bit & 0x01);
+
   // check sync word
   if(!this->gotSync) {
-    this->syncBuffer <<= 1;
-    this->syncBuffer |= bit;
-
     RADIOLIB_DEBUG_PROTOCOL_PRINTLN("S\t%lu", (long unsigned int)this->syncBuffer);
 
-    if((this->syncBuffer & this->directSyncWordMask) == this->directSyncWord) {
+    // correlate with the expected sync word, up to the configured number of bit errors is tolerated
+    if(rlb_popcount((this->syncBuffer ^ this->directSyncWord) & this->directSyncWordMask) <= this->directSyncWordErrors) {
       this->gotSync = true;
-      this->bufferWritePos = 0;
-      this->bufferReadPos = 0;
       this->bufferBitPos = 0;
     }
+    return;
+  }
 
-  } else {
-    // save the bit
-    if(bit) {
-      this->buffer[this->bufferWritePos] |= 0x01 << this->bufferBitPos;
-    } else {
-      this->buffer[this->bufferWritePos] &= ~(0x01 << this->bufferBitPos);
-    }
-    this->bufferBitPos++;
-
-    // check complete byte
-    if(this->bufferBitPos == 8) {
-      this->buffer[this->bufferWritePos] = rlb_reflect(this->buffer[this->bufferWritePos], 8);
-      RADIOLIB_DEBUG_PROTOCOL_PRINTLN("R\t%X", this->buffer[this->bufferWritePos]);
+  // bits arrive MSB first, so once 8 of them were shifted in, the lowest byte is complete
+  this->bufferBitPos++;
+  if(this->bufferBitPos < 8) {
+    return;
+  }
+  this->bufferBitPos = 0;
 
-      this->bufferWritePos++;
-      this->bufferBitPos = 0;
-    }
+  // check there is space in the buffer, if not, the byte is dropped
+  size_t writePos = loadDirectIndex(this->bufferWritePos);
+  size_t nextPos = writePos + 1;
+  if(nextPos == RADIOLIB_STATIC_ARRAY_SIZE) {
+    nextPos = 0;
   }
+  if(nextPos == loadDirectIndex(this->bufferReadPos)) {
+    RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Direct buffer full, byte dropped");
+    return;
+  }
+
+  // save the byte first, only then publish it to the consumer
+  this->buffer[writePos] = (uint8_t)this->syncBuffer;
+  RADIOLIB_DEBUG_PROTOCOL_PRINTLN("R\t%X", this->buffer[writePos]);
+  storeDirectIndex(this->bufferWritePos, nextPos);
+}
+
+size_t PhysicalLayer::loadDirectIndex(const RadioLibDirectIndex_t& index) {
+  // the index may be wider than what the platform can read in one instruction,
+  // so read it until two consecutive values match to avoid torn reads
+  size_t val = 0;
+  do {
+    val = index;
+  } while(val != index);
+
+  // the buffer must not be accessed before the index is known (acquire)
+  RADIOLIB_DIRECT_BARRIER();
+  return(val);
+}
+
+void PhysicalLayer::storeDirectIndex(RadioLibDirectIndex_t& index, size_t val) {
+  // the buffer access must be finished before the index is published (release)
+  RADIOLIB_DIRECT_BARRIER();
+  index = val;
 }
 
 void PhysicalLayer::setDirectAction(void (*func)(void)) {
@@ -4,6 +4,13 @@
 #include "../../TypeDef.h"
 #include "../../Module.h"
 
+#if !RADIOLIB_EXCLUDE_DIRECT_RECEIVE
+// direct mode buffer indexes are shared between the bit interrupt (producer) and the main context (consumer)
+// these are plain volatile rather than std::atomic, which would make the radio classes non-copyable,
+// the ordering against the buffer itself is handled by loadDirectIndex and storeDirectIndex
+typedef volatile size_t RadioLibDirectIndex_t;
+#endif
+
 // common IRQ values - the IRQ flags in RadioLibIrqFlags_t arguments are offset by this value
 enum RadioLibIrqType_t {
   RADIOLIB_IRQ_TX_DONE = 0x00,
@@ -455,6 +462,62 @@ class PhysicalLayer {
     */
     virtual int16_t setFrequency(float freq);
 
+    /*!
+      \brief Check the carrier frequency can be configured by this module, without changing any settings.
+      Must be implemented in module class if the module supports it.
+      \param freq Carrier frequency in MHz.
+      \returns \ref status_codes
+    */
+    virtual int16_t checkFrequency(float freq);
+
+    /*!
+      \brief Calculate the raw frequency word for a given carrier frequency, the same way setFrequency does.
+      The result can be passed to setFrequencyWord or transmitDirect. Frequency range is not checked,
+      use checkFrequency for that. Must be implemented in module class if the module supports it.
+      \param freq Carrier frequency in MHz.
+      \param word Pointer to variable to save the raw frequency word into.
+      \returns \ref status_codes
+    */
+    virtual int16_t calculateFrequencyWord(float freq, uint32_t* word);
+
+    /*!
+      \brief Sets carrier frequency from a raw frequency word, as calculated by calculateFrequencyWord.
+      Performs the minimum amount of register writes, without any range checks or floating point math.
+      Image calibration and other frequency-dependent settings are not updated, so all words used this way
+      should be in the band that was last configured by setFrequency.
+      Must be implemented in module class if the module supports it.
+      \param word Raw frequency word.
+      \returns \ref status_codes
+    */
+    virtual int16_t setFrequencyWord(uint32_t word);
+
+    /*!
+      \brief Sets up generic frequency hopping. All channels are validated and converted to raw frequency
+      words once, so that hopping itself only performs the minimum amount of register writes.
+      The radio is only retuned once, to the first channel of the hopping sequence.
+      \param channels Array of channel frequencies in MHz.
+      \param words Array to save the raw frequency words into, must be numChannels long. Must remain valid while hopping.
+      \param numChannels Number of channels.
+      \param sequence Hopping sequence, as indexes into the array of channels. Must remain valid while hopping.
+      Set to NULL to hop through all channels in order.
+      \param seqLen Length of the hopping sequence. Ignored if sequence is NULL.
+      \returns \ref status_codes
+    */
+    int16_t setHoppingSequence(const float* channels, uint32_t* words, size_t numChannels, const uint8_t* sequence = NULL, size_t seqLen = 0);
+
+    /*!
+      \brief Retune to the next channel in the hopping sequence. Intended to be called from the interrupt
+      or timer that signals the hop, e.g. after packet transmission. setHoppingSequence must be called first.
+      \returns \ref status_codes
+    */
+    int16_t hopFrequency();
+
+    /*!
+      \brief Get the index of the channel the radio is currently tuned to by the hopping sequence.
+      \returns Channel index in the array of channels passed to setHoppingSequence.
+    */
+    size_t getHoppingChannel();
+
     /*!
       \brief Sets FSK bit rate. Only available in FSK mode. Must be implemented in module class.
       \param br Bit rate to be set (in kbps).
@@ -491,6 +554,13 @@ class PhysicalLayer {
     */
     virtual int16_t invertIQ(bool enable);
 
+    /*!
+      \brief Enable/disable the packet CRC. Must be implemented in module class if the module supports it.
+      \param enable CRC enabled (true) or disabled (false).
+      \returns \ref status_codes
+    */
+    virtual int16_t setPacketCRC(bool enable);
+
     /*!
       \brief Set output power. Must be implemented in module class if the module supports it.
       \param power Output power in dBm. The allowed range depends on the module used.
@@ -520,6 +590,21 @@ class PhysicalLayer {
       \returns \ref status_codes
     */
     virtual int16_t setPreambleLength(size_t len);
+
+    /*!
+      \brief Set implicit header mode for future reception/transmission.
+      Must be implemented in module class if the module supports it.
+      \param len Payload length in bytes.
+      \returns \ref status_codes
+    */
+    virtual int16_t implicitHeader(size_t len);
+
+    /*!
+      \brief Set explicit header mode for future reception/transmission.
+      Must be implemented in module class if the module supports it.
+      \returns \ref status_codes
+    */
+    virtual int16_t explicitHeader();
     
     /*!
       \brief Set data rate. Must be implemented in module class if the module supports it.
@@ -676,6 +761,19 @@ class PhysicalLayer {
     */
     virtual int16_t scanChannel(const ChannelScanConfig_t &config);
 
+    /*!
+      \brief Check multiple channels for activity. Performs CAD for LoRa modules, or RSSI measurement for FSK modules,
+      on each channel in turn. The radio is left tuned to the last channel of the list.
+      \param words Array of raw frequency words of the channels to scan, as calculated by calculateFrequencyWord.
+      \param numChannels Number of channels to scan.
+      \param config Scan configuration structure. Interpretation depends on currently active modem.
+      \param results Array to save per-channel results into, must be numChannels long. Each entry is
+      RADIOLIB_CHANNEL_FREE when the channel is free, RADIOLIB_LORA_DETECTED or RADIOLIB_PREAMBLE_DETECTED
+      when occupied, or other \ref status_codes when the scan of that channel failed.
+      \returns \ref status_codes
+    */
+    virtual int16_t scanChannels(const uint32_t* words, size_t numChannels, const ChannelScanConfig_t &config, int16_t* results);
+
     /*!
       \brief Get truly random number in range 0 - max.
       \param max The maximum value of the random number (non-inclusive).
@@ -709,9 +807,11 @@ class PhysicalLayer {
       \brief Set sync word to be used to determine start of packet in direct reception mode.
       \param syncWord Sync word bits.
       \param len Sync word length in bits. Set to zero to disable sync word matching.
+      \param maxErrors Maximum number of bit errors in the received sync word
+      for it to still be considered a match. Defaults to 0 (exact match).
       \returns \ref status_codes
     */
-    int16_t setDirectSyncWord(uint32_t syncWord, uint8_t len);
+    int16_t setDirectSyncWord(uint32_t syncWord, uint8_t len, uint8_t maxErrors = 0);
 
     /*!
       \brief Set interrupt service routine function to call when data bit is received in direct mode.
@@ -728,6 +828,8 @@ class PhysicalLayer {
 
     /*!
       \brief Get the number of direct mode bytes currently available in buffer.
+      The buffer is a lock-free single-producer/single-consumer ring,
+      so this can be safely called while bits are being received.
       \returns Number of available bytes.
     */
     int16_t available();
@@ -741,7 +843,7 @@ class PhysicalLayer {
       \brief Get data from direct mode buffer.
       \param drop Drop synchronization on read - next reading will require waiting for the sync word again.
       Defaults to true.
-      \returns Byte from direct mode buffer.
+      \returns Byte from direct mode buffer, 0 if the buffer is empty.
     */
     uint8_t read(bool drop = true);
     #endif
@@ -831,6 +933,12 @@ class PhysicalLayer {
     uint32_t irqMap[10] = { 0 };
     RadioModeType_t stagedMode = RADIOLIB_RADIO_MODE_NONE;
 
+    // generic frequency hopping
+    const uint32_t* hopWords = NULL;
+    const uint8_t* hopSequence = NULL;
+    size_t hopSeqLen = 0;
+    size_t hopIndex = 0;
+
 #if !RADIOLIB_EXCLUDE_DIRECT_RECEIVE
     void updateDirectBuffer(uint8_t bit);
 #endif
@@ -840,15 +948,23 @@ class PhysicalLayer {
 #endif
 
     #if !RADIOLIB_EXCLUDE_DIRECT_RECEIVE
-    uint8_t bufferBitPos = 0;
-    uint8_t bufferWritePos = 0;
-    uint8_t bufferReadPos = 0;
+    // ring buffer, write position is only changed by the producer (bit interrupt),
+    // read position only by the consumer (main context); one slot is always kept empty
     uint8_t buffer[RADIOLIB_STATIC_ARRAY_SIZE] = { 0 };
+    RadioLibDirectIndex_t bufferWritePos = 0;
+    RadioLibDirectIndex_t bufferReadPos = 0;
+    uint8_t bufferBitPos = 0;
+
+    // received bits are shifted into this register, both for sync word matching and data accumulation
     uint32_t syncBuffer = 0;
     uint32_t directSyncWord = 0;
     uint8_t directSyncWordLen = 0;
     uint32_t directSyncWordMask = 0;
-    bool gotSync = false;
+    uint8_t directSyncWordErrors = 0;
+    volatile bool gotSync = false;
+
+    size_t loadDirectIndex(const RadioLibDirectIndex_t& index);
+    void storeDirectIndex(RadioLibDirectIndex_t& index, size_t val);
     #endif
 
     virtual Module* getMod() = 0;
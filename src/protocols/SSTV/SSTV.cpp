@@ -1,4 +1,5 @@
 #include "SSTV.h"
+#include <string.h>
 #if !RADIOLIB_EXCLUDE_SSTV
 
 const SSTVMode_t Scottie1 {
@@ -203,6 +204,51 @@ SSTVClient::SSTVClient(AFSKClient* audio) {
 }
 #endif
 
+SSTVClient::SSTVClient(const SSTVClient& sstv) : SSTVClient(sstv.phyLayer) {
+  *this = sstv;
+}
+
+SSTVClient& SSTVClient::operator=(const SSTVClient& sstv) {
+  if(&sstv == this) {
+    return(*this);
+  }
+
+  phyLayer = sstv.phyLayer;
+  #if !RADIOLIB_EXCLUDE_AFSK
+  audioClient = sstv.audioClient;
+  #endif
+  baseFreq = sstv.baseFreq;
+  txMode = sstv.txMode;
+  lineCount = sstv.lineCount;
+  pixelLen = sstv.pixelLen;
+  memcpy(brightnessLut, sstv.brightnessLut, sizeof(brightnessLut));
+  lineFrac = sstv.lineFrac;
+  timerStart = sstv.timerStart;
+  timerTarget = sstv.timerTarget;
+  toneLen = sstv.toneLen;
+
+  // each instance renders lines into its own buffer
+  #if !RADIOLIB_STATIC_ONLY
+  if(sstv.lineTonesLen > lineTonesLen) {
+    lineTonesLen = 0;
+    delete[] lineTones;
+    lineTones = new SSTVLineTone_t[sstv.lineTonesLen];
+    if(!lineTones) {
+      return(*this);
+    }
+  }
+  #endif
+  lineTonesLen = sstv.lineTonesLen;
+  memcpy(lineTones, sstv.lineTones, lineTonesLen*sizeof(SSTVLineTone_t));
+  return(*this);
+}
+
+SSTVClient::~SSTVClient() {
+  #if !RADIOLIB_STATIC_ONLY
+  delete[] lineTones;
+  #endif
+}
+
 #if !RADIOLIB_EXCLUDE_AFSK
 int16_t SSTVClient::begin(const SSTVMode_t& mode) {
   if(audioClient == nullptr) {
@@ -217,10 +263,37 @@ int16_t SSTVClient::begin(const SSTVMode_t& mode) {
 int16_t SSTVClient::begin(float base, const SSTVMode_t& mode) {
   // save mode
   txMode = mode;
+  pixelLen = (uint32_t)txMode.scanPixelLen << 8;
+  lineCount = 0;
+  lineFrac = 0;
 
   // calculate 24-bit frequency
   baseFreq = (base * 1000000.0f) / phyLayer->freqStep;
 
+  // brightness to frequency table, linear from 1500 to 2300 Hz
+  for(uint16_t i = 0; i < 256; i++) {
+    brightnessLut[i] = getToneWord(RADIOLIB_SSTV_TONE_BRIGHTNESS_MIN + (i*(RADIOLIB_SSTV_TONE_BRIGHTNESS_MAX - RADIOLIB_SSTV_TONE_BRIGHTNESS_MIN) + 127) / 255);
+  }
+
+  // the longest line is the one with the start sync tone
+  size_t len = 1;
+  for(uint8_t i = 0; i < txMode.numTones; i++) {
+    len += (txMode.tones[i].type == tone_t::GENERIC) ? 1 : txMode.width;
+  }
+  #if RADIOLIB_STATIC_ONLY
+  if(len > RADIOLIB_SSTV_LINE_MAX_TONES) {
+    return(RADIOLIB_ERR_MEMORY_ALLOCATION_FAILED);
+  }
+  #else
+  if(len > lineTonesLen) {
+    lineTonesLen = 0;
+    delete[] lineTones;
+    lineTones = new SSTVLineTone_t[len];
+    RADIOLIB_ASSERT_PTR(lineTones);
+  }
+  #endif
+  lineTonesLen = len;
+
   // configure for direct mode
   return(phyLayer->startDirect());
 }
@@ -233,6 +306,7 @@ int16_t SSTVClient::setCorrection(float correction) {
 
   // apply correction factor to all timings
   txMode.scanPixelLen *= correction;
+  pixelLen *= correction;
   for(uint8_t i = 0; i < txMode.numTones; i++) {
     txMode.tones[i].len *= correction;
   }
@@ -241,13 +315,16 @@ int16_t SSTVClient::setCorrection(float correction) {
 
 void SSTVClient::idle() {
   phyLayer->transmitDirect();
+  this->startTimer();
   this->tone(RADIOLIB_SSTV_TONE_LEADER);
 }
 
 void SSTVClient::sendHeader() {
   // reset line counter
   lineCount = 0;
+  lineFrac = 0;
   phyLayer->transmitDirect();
+  this->startTimer();
 
   // send the first part of header (leader-break-leader)
   this->tone(RADIOLIB_SSTV_TONE_LEADER, RADIOLIB_SSTV_HEADER_LEADER_LENGTH);
@@ -282,13 +359,91 @@ void SSTVClient::sendHeader() {
 }
 
 void SSTVClient::sendLine(const uint32_t* imgLine) {
+  // the previous tone is still playing while the line is prepared
+  size_t num = this->renderLine(imgLine);
+  if(num == 0) {
+    return;
+  }
+
+  // if the previous line ended too long ago to catch up within the first tone, start over from now
+  Module* mod = phyLayer->getMod();
+  if(mod->hal->micros() - this->timerStart > this->timerTarget + this->lineTones[0].len) {
+    this->startTimer();
+  }
+
+  for(size_t i = 0; i < num; i++) {
+    this->playTone(this->lineTones[i].word, this->lineTones[i].len);
+  }
+
+  // increment line counter (needed for Robot36 mode)
+  lineCount++;
+}
+
+uint16_t SSTVClient::getPictureHeight() const {
+  return(txMode.height);
+}
+
+uint16_t SSTVClient::getToneWord(uint32_t freq) const {
+  #if !RADIOLIB_EXCLUDE_AFSK
+  if(audioClient != nullptr) {
+    return(freq);
+  }
+  #endif
+  return((uint16_t)((float)freq / phyLayer->freqStep + 0.5f));
+}
+
+void SSTVClient::startTimer() {
+  Module* mod = phyLayer->getMod();
+  this->timerStart = mod->hal->micros();
+  this->timerTarget = 0;
+  this->toneLen = 0;
+}
+
+void SSTVClient::tone(uint16_t freq, RadioLibTime_t len) {
+  this->playTone(this->getToneWord(freq), len);
+}
+
+void SSTVClient::playTone(uint16_t word, RadioLibTime_t len) {
+  // wait for the previous tone to end, measured from the start so that late tones are made up for
+  Module* mod = phyLayer->getMod();
+  #if RADIOLIB_INTERRUPT_TIMING
+  // the timing interrupt is periodic and keeps the pace by itself, it only needs the length of the playing tone
+  if(this->toneLen > 0) {
+    mod->waitForMicroseconds(0, this->toneLen);
+  }
+  #else
+  mod->waitForMicroseconds(this->timerStart, this->timerTarget);
+  #endif
+  #if !RADIOLIB_EXCLUDE_AFSK
+  if(audioClient != nullptr) {
+    audioClient->tone(word, false);
+  } else {
+    phyLayer->transmitDirect(baseFreq + word);
+  }
+  #else
+  phyLayer->transmitDirect(baseFreq + word);
+  #endif
+  this->timerTarget += len;
+  this->toneLen = len;
+}
+
+size_t SSTVClient::renderLine(const uint32_t* imgLine) {
+  if(this->lineTonesLen == 0) {
+    return(0);
+  }
+
+  // time is tracked in 1/256 us, each tone gets the whole microseconds that elapsed since the previous one
+  size_t num = 0;
+  uint32_t time = this->lineFrac;
+  bool robot = (txMode.visCode == RADIOLIB_SSTV_ROBOT_36) || (txMode.visCode == RADIOLIB_SSTV_ROBOT_72);
+
   // check first line in Scottie modes
   if((lineCount == 0) && ((txMode.visCode == RADIOLIB_SSTV_SCOTTIE_1) || (txMode.visCode == RADIOLIB_SSTV_SCOTTIE_2) || (txMode.visCode == RADIOLIB_SSTV_SCOTTIE_DX))) {
     // send start sync tone
-    this->tone(RADIOLIB_SSTV_TONE_BREAK, 9000);
+    this->addTone(&num, &time, this->getToneWord(RADIOLIB_SSTV_TONE_BREAK), 9000UL << 8);
   }
 
-  // send all tones in sequence
+  // all tones in sequence
   for(uint8_t i = 0; i < txMode.numTones; i++) {
     if((txMode.tones[i].type == tone_t::GENERIC) && (txMode.tones[i].len > 0)) {
       // Robot36 has different separator tones for even and odd lines
@@ -298,79 +453,67 @@ void SSTVClient::sendLine(const uint32_t* imgLine) {
       }
 
       // sync/porch tones
-      this->tone(freq, txMode.tones[i].len);
+      this->addTone(&num, &time, this->getToneWord(freq), txMode.tones[i].len << 8);
+      continue;
+    }
 
-    } else {
-      // scan lines
-      for(uint16_t j = 0; j < txMode.width; j++) {
-        uint32_t color = imgLine[j];
-        uint32_t len = txMode.scanPixelLen;
-
-        // Robot modes work in YCbCr
-        if((txMode.visCode == RADIOLIB_SSTV_ROBOT_36) || (txMode.visCode == RADIOLIB_SSTV_ROBOT_72)) {
-          uint8_t r = (color & 0x00FF0000) >> 16;
-          uint8_t g = (color & 0x0000FF00) >> 8;
-          uint8_t b = (color & 0x000000FF);
-          uint8_t y = 16.0 + (0.003906 * ((65.738 * r) + (129.057 * g) + (25.064 * b)));
-          uint8_t cb = 128.0 + (0.003906 * ((-37.945 * r) + (-74.494 * g) + (112.439 * b)));
-          uint8_t cr = 128.0 + (0.003906 * ((112.439 * r) + (-94.154 * g) + (-18.285 * b)));
-          color = ((uint32_t)y << 8);
-          if(txMode.visCode == RADIOLIB_SSTV_ROBOT_36) {
-            // odd lines carry Cb, even lines carry Cr
-            color |= (lineCount % 2) ? cb : cr; 
-          } else {
-            color |= ((uint32_t)cr << 16) | cb;
-          }
-          
-        }
+    // scan lines, Robot modes send chrominance at twice the speed
+    uint32_t len = this->pixelLen;
+    if(robot && (txMode.tones[i].type != tone_t::SCAN_GREEN_Y)) {
+      len /= 2;
+    }
 
-        switch(txMode.tones[i].type) {
-          case(tone_t::SCAN_RED_CR):
-            color &= 0x00FF0000;
-            color >>= 16;
-            if((txMode.visCode == RADIOLIB_SSTV_ROBOT_36) || (txMode.visCode == RADIOLIB_SSTV_ROBOT_72)) {
-              len /= 2;
-            }
-            break;
-          case(tone_t::SCAN_GREEN_Y):
-            color &= 0x0000FF00;
-            color >>= 8;
-            break;
-          case(tone_t::SCAN_BLUE_CB):
-            color &= 0x000000FF;
-            if((txMode.visCode == RADIOLIB_SSTV_ROBOT_36) || (txMode.visCode == RADIOLIB_SSTV_ROBOT_72)) {
-              len /= 2;
-            }
-            break;
-          case(tone_t::GENERIC):
-            break;
+    // which component to send, Robot36 sends Cr on even lines and Cb on odd lines in the same slot
+    uint8_t shift = 0;
+    bool cr = (txMode.tones[i].type == tone_t::SCAN_RED_CR) || ((txMode.visCode == RADIOLIB_SSTV_ROBOT_36) && !(lineCount % 2));
+    switch(txMode.tones[i].type) {
+      case(tone_t::SCAN_RED_CR):
+        shift = 16;
+        break;
+      case(tone_t::SCAN_GREEN_Y):
+        shift = 8;
+        break;
+      default:
+        shift = 0;
+        break;
+    }
+
+    for(uint16_t j = 0; j < txMode.width; j++) {
+      uint32_t color = imgLine[j];
+      uint8_t level = (color >> shift) & 0xFF;
+
+      // Robot modes work in YCbCr, ITU-R BT.601 in 8-bit fixed point
+      // the offsets are added before the shift, so that the sum is never negative
+      if(robot) {
+        int32_t r = (color & 0x00FF0000) >> 16;
+        int32_t g = (color & 0x0000FF00) >> 8;
+        int32_t b = (color & 0x000000FF);
+        if(txMode.tones[i].type == tone_t::SCAN_GREEN_Y) {
+          level = (66*r + 129*g + 25*b + (16 << 8) + 128) >> 8;
+        } else if(cr) {
+          level = (112*r - 94*g - 18*b + (128 << 8) + 128) >> 8;
+        } else {
+          level = (-38*r - 74*g + 112*b + (128 << 8) + 128) >> 8;
         }
-        this->tone(RADIOLIB_SSTV_TONE_BRIGHTNESS_MIN + ((float)color * 3.1372549f), len);
       }
+
+      this->addTone(&num, &time, this->brightnessLut[level], len);
     }
   }
 
-  // increment line counter (needed for Robot36 mode)
-  lineCount++;
+  this->lineFrac = time & 0xFF;
+  return(num);
 }
 
-uint16_t SSTVClient::getPictureHeight() const {
-  return(txMode.height);
-}
-
-void SSTVClient::tone(float freq, RadioLibTime_t len) {
-  Module* mod = phyLayer->getMod();
-  RadioLibTime_t start = mod->hal->micros();
-  #if !RADIOLIB_EXCLUDE_AFSK
-  if(audioClient != nullptr) {
-    audioClient->tone(freq, false);
-  } else {
-    phyLayer->transmitDirect(baseFreq + (freq / phyLayer->freqStep));
+void SSTVClient::addTone(size_t* num, uint32_t* time, uint16_t word, uint32_t len) {
+  if(*num >= this->lineTonesLen) {
+    return;
   }
-  #else
-  phyLayer->transmitDirect(baseFreq + (freq / phyLayer->freqStep));
-  #endif
-  mod->waitForMicroseconds(start, len);
+  uint32_t end = *time + len;
+  this->lineTones[*num].word = word;
+  this->lineTones[*num].len = (end >> 8) - (*time >> 8);
+  *time = end;
+  (*num)++;
 }
 
 #endif
@@ -37,6 +37,29 @@
 #define RADIOLIB_SSTV_HEADER_BREAK_LENGTH                       10000
 #define RADIOLIB_SSTV_HEADER_BIT_LENGTH                         30000
 
+// maximum number of tones in a single picture line when using static memory, the default fits all supported modes
+// each tone takes 4 bytes, so the default reserves about 7.7 kB per SSTVClient - the 320 pixel wide modes
+// need at most 967 tones (about 3.9 kB), and Robot36 only 645, so this can be reduced if Pasokon is not used
+#if !defined(RADIOLIB_SSTV_LINE_MAX_TONES)
+  #define RADIOLIB_SSTV_LINE_MAX_TONES                          (3*640 + 10)
+#endif
+
+/*!
+  \struct SSTVLineTone_t
+  \brief Single tone of a picture line, precomputed before the line is transmitted.
+*/
+struct SSTVLineTone_t {
+  /*!
+    \brief Raw frequency word relative to the base frequency, or audio frequency in Hz in AFSK mode.
+  */
+  uint16_t word;
+
+  /*!
+    \brief Length of tone in us.
+  */
+  uint16_t len;
+};
+
 /*!
   \struct tone_t
   \brief Structure to save data about tone.
@@ -134,6 +157,23 @@ class SSTVClient {
     explicit SSTVClient(AFSKClient* audio);
     #endif
 
+    /*!
+      \brief Copy constructor.
+      \param sstv SSTVClient instance to copy.
+    */
+    SSTVClient(const SSTVClient& sstv);
+
+    /*!
+      \brief Overload for assignment operator.
+      \param sstv rvalue SSTVClient.
+    */
+    SSTVClient& operator=(const SSTVClient& sstv);
+
+    /*!
+      \brief Default destructor.
+    */
+    ~SSTVClient();
+
     // basic methods
 
     /*!
@@ -172,11 +212,15 @@ class SSTVClient {
 
     /*!
       \brief Sends synchronization header for the SSTV mode set in begin method.
+      The method returns once the last tone of the header has started, picture lines should follow without delay.
     */
     void sendHeader();
 
     /*!
       \brief Sends single picture line in the currently configured SSTV mode.
+      The whole line is converted to tones first, which are then sent against a running timer,
+      so that the line timing does not depend on the speed of the platform.
+      The method returns once the last tone of the line has started, consecutive lines should be sent without delay.
       \param imgLine Image line to send, in 24-bit RGB. It is up to the user to ensure that
       imgLine has enough pixels to send it in the current SSTV mode.
     */
@@ -200,7 +244,34 @@ class SSTVClient {
     SSTVMode_t txMode = Scottie1;
     uint32_t lineCount = 0;
 
-    void tone(float freq, RadioLibTime_t len = 0);
+    // pixel scan length in 1/256 us, so that the timing correction does not get rounded off
+    uint32_t pixelLen = 0;
+
+    // raw frequency words for all brightness values
+    uint16_t brightnessLut[256] = { 0 };
+
+    // the current line as tones, and the remainder of its length to carry over to the next line
+    #if RADIOLIB_STATIC_ONLY
+    SSTVLineTone_t lineTones[RADIOLIB_SSTV_LINE_MAX_TONES];
+    #else
+    SSTVLineTone_t* lineTones = NULL;
+    #endif
+    size_t lineTonesLen = 0;
+    uint8_t lineFrac = 0;
+
+    // tones are timed from the start of the transmission, so timing errors do not accumulate
+    RadioLibTime_t timerStart = 0;
+    RadioLibTime_t timerTarget = 0;
+
+    // length of the tone that is playing, which is all that the periodic timing interrupt needs
+    RadioLibTime_t toneLen = 0;
+
+    uint16_t getToneWord(uint32_t freq) const;
+    void startTimer();
+    void tone(uint16_t freq, RadioLibTime_t len = 0);
+    void playTone(uint16_t word, RadioLibTime_t len);
+    size_t renderLine(const uint32_t* imgLine);
+    void addTone(size_t* num, uint32_t* time, uint16_t word, uint32_t len);
 };
 
 #endif
@@ -23,6 +23,9 @@ void RadioLibBCH::begin(uint8_t n, uint8_t k, uint32_t poly) {
   this->k = k;
   this->poly = poly;
   #if !RADIOLIB_STATIC_ONLY
+  delete[] this->alphaTo;
+  delete[] this->indexOf;
+  delete[] this->generator;
   this->alphaTo = new int32_t[n + 1];
   this->indexOf = new int32_t[n + 1];
   this->generator = new int32_t[n - k + 1];
@@ -190,6 +193,14 @@ void RadioLibBCH::begin(uint8_t n, uint8_t k, uint32_t poly) {
   #if !RADIOLIB_STATIC_ONLY
   delete[] zeros;
   #endif
+
+  // the same polynomial as a bit mask, used to calculate the syndrome during decoding
+  this->genPoly = 0;
+  for(ii = 0; ii <= rdncy; ii++) {
+    if(this->generator[ii]) {
+      this->genPoly |= ((uint32_t)1 << ii);
+    }
+  }
 }
 
 /*
@@ -306,6 +317,75 @@ uint32_t RadioLibBCH::encode(uint32_t dataword) {
 	return(res);
 }
 
+int8_t RadioLibBCH::decode(uint32_t* codeword) {
+  if(!codeword || (this->n - this->k != 2*this->m)) {
+    return(-1);
+  }
+
+  // bits n to 1 hold the code polynomial, the highest power first
+  // bit 0 is the even parity bit, which is not part of the BCH code
+  uint32_t cw = *codeword;
+  uint8_t r = this->n - this->k;
+  uint32_t rem = cw >> 1;
+  for(int8_t i = this->n - 1; i >= r; i--) {
+    if(rem & ((uint32_t)1 << i)) {
+      rem ^= this->genPoly << (i - r);
+    }
+  }
+
+  int8_t numErrors = 0;
+  if(rem) {
+    // the remainder has the same syndromes as the code word, as alpha and alpha^3 are the roots of the generator
+    int32_t s1 = 0;
+    int32_t s3 = 0;
+    for(uint8_t i = 0; i < r; i++) {
+      if(rem & ((uint32_t)1 << i)) {
+        s1 ^= this->alphaTo[i % this->n];
+        s3 ^= this->alphaTo[(3*i) % this->n];
+      }
+    }
+    if(s1 == 0) {
+      return(-1);
+    }
+
+    // a single error has s3 = s1^3
+    int32_t idx1 = this->indexOf[s1];
+    int32_t s1Cubed = this->alphaTo[(3*idx1) % this->n];
+    if(s1Cubed == s3) {
+      cw ^= (uint32_t)1 << (idx1 + 1);
+      numErrors = 1;
+
+    } else {
+      // two errors, error locator is 1 + s1*x + ((s3 + s1^3)/s1)*x^2, find its roots by Chien search
+      int32_t idx2 = (this->indexOf[s3 ^ s1Cubed] - idx1 + this->n) % this->n;
+      uint32_t flips = 0;
+      for(int32_t i = 0; i < this->n; i++) {
+        int32_t val = 1 ^ this->alphaTo[(idx1 - i + this->n) % this->n] ^ this->alphaTo[(idx2 + 2*(this->n - i)) % this->n];
+        if(val == 0) {
+          flips |= (uint32_t)1 << (i + 1);
+          numErrors++;
+        }
+      }
+      if(numErrors != 2) {
+        return(-1);
+      }
+      cw ^= flips;
+    }
+  }
+
+  // after correction, the parity has to be even - an error in the parity bit itself can still be fixed
+  if(rlb_popcount(cw) & 0x01) {
+    if(numErrors >= 2) {
+      return(-1);
+    }
+    cw ^= 0x01;
+    numErrors++;
+  }
+
+  *codeword = cw;
+  return(numErrors);
+}
+
 RadioLibBCH RadioLibBCHInstance;
 
 RadioLibConvCode::RadioLibConvCode() {
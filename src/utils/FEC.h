@@ -48,11 +48,20 @@ class RadioLibBCH {
     */
     uint32_t encode(uint32_t dataword);
 
+    /*!
+      \brief Decoding method - corrects up to two bit errors in a code word and checks its even parity bit.
+      Only codes that can correct two errors (n - k = 2m, e.g. BCH(31, 21)) are supported.
+      \param codeword Pointer to the code word in the format produced by encode. Corrected in place.
+      \returns Number of corrected bits, or -1 if the code word could not be corrected.
+    */
+    int8_t decode(uint32_t* codeword);
+
   private:
     uint8_t n = 0;
     uint8_t k = 0;
     uint32_t poly = 0;
     uint8_t m = 0;
+    uint32_t genPoly = 0;
     
     #if RADIOLIB_STATIC_ONLY
       int32_t alphaTo[RADIOLIB_BCH_MAX_N + 1] = { 0 };
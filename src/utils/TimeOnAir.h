@@ -0,0 +1,149 @@
+#if !defined(_RADIOLIB_TIME_ON_AIR_H)
+#define _RADIOLIB_TIME_ON_AIR_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "../TypeDef.h"
+
+// LR-FHSS packet bit widths, these are defined by the modulation and shared by all modules that support it
+#define RADIOLIB_TOA_LR_FHSS_HEADER_BITS                        (114)
+#define RADIOLIB_TOA_LR_FHSS_FRAG_BITS                          (48)
+#define RADIOLIB_TOA_LR_FHSS_BLOCK_BITS                         (RADIOLIB_TOA_LR_FHSS_FRAG_BITS + 2)
+#define RADIOLIB_TOA_LR_FHSS_BIT_RATE                           (488.28215f)
+
+/*
+  The functions below are the shared time-on-air core used by the module drivers.
+  They only use integer arithmetic where possible and are all constexpr,
+  so when the arguments are known at compile time, the result is known as well.
+  Everything is in microseconds, values with .25 fractions are multiplied by 4 (_x4 postfix).
+  The functions are written as single expressions, to keep them usable as constexpr in C++11.
+*/
+
+/*!
+  \brief Get the LoRa symbol length.
+  \param sf Spreading factor.
+  \param bw Bandwidth in kHz.
+  \returns Symbol length in microseconds.
+*/
+constexpr uint32_t rlb_toaLoRaSymbolUs(uint8_t sf, float bw) {
+  return(((uint32_t)(1000 * 10) << sf) / (bw * 10));
+}
+
+/*!
+  \brief Get the number of LoRa payload symbols before coding rate is applied,
+  as defined in section 6.1.4 of SX1268 datasheet v1.1.
+  \param sf Spreading factor.
+  \param crc Whether payload CRC is enabled.
+  \param implicit Whether implicit header mode is used.
+  \param ldro Whether low data rate optimization is enabled.
+  \param len Payload length in bytes.
+  \returns Number of pre-coded symbols.
+*/
+constexpr uint16_t rlb_toaLoRaPreCodedSymbols(uint8_t sf, bool crc, bool implicit, bool ldro, size_t len) {
+  // add (divisor - 1) to the numerator to give integer CEIL(...)
+  return(
+    ((int32_t)(8 * len) + crc*16 - 4*sf + ((sf < 7) ? 0 : 8) + (implicit ? 0 : 20)) <= 0 ? 0 :
+    (((int32_t)(8 * len) + crc*16 - 4*sf + ((sf < 7) ? 0 : 8) + (implicit ? 0 : 20)) + (4*(sf - 2*ldro) - 1)) / (4*(sf - 2*ldro))
+  );
+}
+
+/*!
+  \brief Get the total number of LoRa symbols, multiplied by 4.
+  \param sf Spreading factor.
+  \param cr Coding rate denominator (5 - 8).
+  \param preambleLength Preamble length in symbols.
+  \param crc Whether payload CRC is enabled.
+  \param implicit Whether implicit header mode is used.
+  \param ldro Whether low data rate optimization is enabled.
+  \param len Payload length in bytes.
+  \returns Number of symbols, multiplied by 4.
+*/
+constexpr uint32_t rlb_toaLoRaSymbols_x4(uint8_t sf, uint8_t cr, uint16_t preambleLength, bool crc, bool implicit, bool ldro, size_t len) {
+  // preamble can be 65k, therefore this needs to be 32 bit
+  return(((uint32_t)preambleLength + 8) * 4 + ((sf < 7) ? 25 : 17) + (uint32_t)rlb_toaLoRaPreCodedSymbols(sf, crc, implicit, ldro, len) * cr * 4);
+}
+
+/*!
+  \brief Get LoRa time-on-air.
+  \param sf Spreading factor.
+  \param bw Bandwidth in kHz.
+  \param cr Coding rate denominator (5 - 8).
+  \param preambleLength Preamble length in symbols.
+  \param crc Whether payload CRC is enabled.
+  \param implicit Whether implicit header mode is used.
+  \param ldro Whether low data rate optimization is enabled.
+  \param len Payload length in bytes.
+  \returns Time-on-air in microseconds.
+*/
+constexpr RadioLibTime_t rlb_toaLoRa(uint8_t sf, float bw, uint8_t cr, uint16_t preambleLength, bool crc, bool implicit, bool ldro, size_t len) {
+  return((rlb_toaLoRaSymbolUs(sf, bw) * rlb_toaLoRaSymbols_x4(sf, cr, preambleLength, crc, implicit, ldro, len)) / 4);
+}
+
+/*!
+  \brief Get time-on-air of a number of bits at a fixed bit rate (GFSK, FLRC etc.).
+  \param bits Total number of bits transmitted.
+  \param bitRate Bit rate in kbps.
+  \returns Time-on-air in microseconds.
+*/
+constexpr RadioLibTime_t rlb_toaBits(uint32_t bits, float bitRate) {
+  return(((float)bits * 1000.0f) / bitRate);
+}
+
+/*!
+  \brief Get GFSK time-on-air.
+  \param bitRate Bit rate in kbps.
+  \param preambleLength Preamble length in bits.
+  \param syncWordLength Sync word length in bits.
+  \param crcLength CRC length in bytes.
+  \param len Payload length in bytes.
+  \returns Time-on-air in microseconds.
+*/
+constexpr RadioLibTime_t rlb_toaFSK(float bitRate, uint16_t preambleLength, uint8_t syncWordLength, uint8_t crcLength, size_t len) {
+  return(rlb_toaBits((uint32_t)preambleLength + syncWordLength + (uint32_t)crcLength*8 + (uint32_t)len*8, bitRate));
+}
+
+/*!
+  \brief Get the number of coded LR-FHSS payload bits.
+  \param cr Coding rate index, 0 for 5/6, 1 for 2/3, 2 for 1/2 and 3 for 1/3.
+  \param len Payload length in bytes.
+  \returns Number of coded bits.
+*/
+constexpr uint32_t rlb_toaLrFhssCodedBits(uint8_t cr, size_t len) {
+  // the extra +4 for CR 5/6 is from the official LR11xx driver
+  return(
+    (cr == 0) ? ((len * 6) + 4) / 5 :
+    (cr == 1) ? (len * 3) / 2 :
+    (cr == 2) ? len * 2 :
+    len * 3
+  );
+}
+
+/*!
+  \brief Get the total number of LR-FHSS bits, accounting for unaligned last block and headers.
+  \param cr Coding rate index, 0 for 5/6, 1 for 2/3, 2 for 1/2 and 3 for 1/3.
+  \param hdrCount Number of headers (1 - 4).
+  \param len Payload length in bytes.
+  \returns Number of bits.
+*/
+constexpr uint32_t rlb_toaLrFhssBits(uint8_t cr, uint8_t hdrCount, size_t len) {
+  return(
+    (uint32_t)RADIOLIB_TOA_LR_FHSS_HEADER_BITS * hdrCount +
+    (rlb_toaLrFhssCodedBits(cr, len) / RADIOLIB_TOA_LR_FHSS_FRAG_BITS) * RADIOLIB_TOA_LR_FHSS_BLOCK_BITS +
+    ((rlb_toaLrFhssCodedBits(cr, len) % RADIOLIB_TOA_LR_FHSS_FRAG_BITS) ? (rlb_toaLrFhssCodedBits(cr, len) % RADIOLIB_TOA_LR_FHSS_FRAG_BITS) + 2 : 0)
+  );
+}
+
+/*!
+  \brief Get LR-FHSS time-on-air. Caller is responsible for checking the coding rate is valid.
+  \param cr Coding rate index, 0 for 5/6, 1 for 2/3, 2 for 1/2 and 3 for 1/3.
+  \param hdrCount Number of headers (1 - 4).
+  \param len Payload length in bytes.
+  \returns Time-on-air in microseconds.
+*/
+constexpr RadioLibTime_t rlb_toaLrFhss(uint8_t cr, uint8_t hdrCount, size_t len) {
+  // 64-bit product, as long packets overflow 32 bits
+  return(((uint64_t)rlb_toaLrFhssBits(cr, hdrCount, len) * 8 * 1000000UL) / RADIOLIB_TOA_LR_FHSS_BIT_RATE);
+}
+
+#endif
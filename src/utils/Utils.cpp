@@ -15,10 +15,9 @@ uint32_t rlb_reflect(uint32_t in, uint8_t bits) {
   return(res);
 }
 
-// fast-ish popcount function for use in calculating LFSR feedback value
-// without relying on __builtin_popcount() which may or may not be available
+// fast-ish popcount function, without relying on __builtin_popcount() which may or may not be available
 // from https://stackoverflow.com/a/51388846
-static uint8_t rlb_popcount(uint32_t in) {
+uint8_t rlb_popcount(uint32_t in) {
   in = (in & 0x55555555UL) + ((in >> 1) & 0x55555555UL);
   in = (in & 0x33333333UL) + ((in >> 2) & 0x33333333UL);
   in = (in & 0x0F0F0F0FUL) + ((in >> 4) & 0x0F0F0F0FUL);
@@ -27,9 +26,9 @@ static uint8_t rlb_popcount(uint32_t in) {
   return(in);
 }
 
-void rlb_scrambler(uint8_t* data, size_t len, const uint32_t poly, const uint32_t init, bool scramble) {
+uint32_t rlb_scrambler(uint8_t* data, size_t len, const uint32_t poly, const uint32_t init, bool scramble) {
   if(!poly) {
-    return;
+    return(init);
   }
 
   // set the inital feedback register state
@@ -62,6 +61,8 @@ void rlb_scrambler(uint8_t* data, size_t len, const uint32_t poly, const uint32_
     data[i] = out;
     out = 0;
   }
+
+  return(lsfr);
 }
 
 void rlb_hexdump(const char* level, const uint8_t* data, size_t len, uint32_t offset, uint8_t width, bool be) {
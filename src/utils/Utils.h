@@ -29,6 +29,13 @@
 */
 uint32_t rlb_reflect(uint32_t in, uint8_t bits);
 
+/*!
+  \brief Function to count the number of set bits.
+  \param in The input to count bits in.
+  \return Number of bits set to 1.
+*/
+uint8_t rlb_popcount(uint32_t in);
+
 /*!
   \brief Function to scramble or descramble input using a linear feedback shift register (LFSR).
   \param data The input data to (de)scramble.
@@ -36,8 +43,9 @@ uint32_t rlb_reflect(uint32_t in, uint8_t bits);
   \param poly Polynomial to use for scrambling.
   \param init Initial LFSR value, sometimes called seed.
   \param scramble Whether to perform scrambling (true) or de-scrambling (false).
+  \returns LFSR value after the last bit, pass it as init to continue on the next block of the same stream.
 */
-void rlb_scrambler(uint8_t* data, size_t len, const uint32_t poly, const uint32_t init, bool scramble);
+uint32_t rlb_scrambler(uint8_t* data, size_t len, const uint32_t poly, const uint32_t init, bool scramble);
 
 /*!
   \brief Function to dump data as hex into the debug port.